@@ -0,0 +1,92 @@
+//
+// @file ms2vis.cc : convert a measurement set into the native memory-mapped
+//                   visibility store (see MappedVisStore)
+//
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author agent <agent@local>
+///
+
+#include <askap_accessors.h>
+#include <askap/AskapError.h>
+#include <askap/AskapLogging.h>
+ASKAP_LOGGER(logger, "");
+
+#include <dataaccess/TableConstDataSource.h>
+#include <dataaccess/MappedVisStoreWriter.h>
+
+// casa
+#include <tables/Tables/Table.h>
+#include <measures/TableMeasures/ScalarMeasColumn.h>
+#include <measures/Measures/MPosition.h>
+#include <casa/OS/Timer.h>
+
+// std
+#include <stdexcept>
+#include <iostream>
+#include <string>
+
+using std::cerr;
+using std::endl;
+
+using namespace askap;
+using namespace accessors;
+
+int main(int argc, char **argv) {
+  try {
+     if ((argc != 3) && (argc != 4)) {
+         cerr<<"Usage "<<argv[0]<<" measurement_set output_store [data_column]"<<endl;
+         return -2;
+     }
+     const std::string dataColumn = argc == 4 ? argv[3] : "DATA";
+
+     casa::Timer timer;
+     timer.mark();
+     // the position of the first antenna is used for frame conversions, as in the table-based iterator
+     const casa::Table antTable = casa::Table(argv[1]).keywordSet().asTable("ANTENNA");
+     ASKAPCHECK(antTable.nrow() > 0, "ANTENNA subtable of "<<argv[1]<<" is empty");
+     const casa::ROScalarMeasColumn<casa::MPosition> posCol(antTable, "POSITION");
+
+     TableConstDataSource ds(argv[1], dataColumn);
+     MappedVisStoreWriter writer(argv[2], posCol(0));
+     IDataConverterPtr conv = ds.createConverter();
+     writer.setupConverter(*conv);
+     const boost::shared_ptr<IConstDataIterator> it = ds.createConstIterator(conv);
+     const size_t nChunks = writer.append(*it);
+     writer.close();
+     std::cerr<<"Converted "<<nChunks<<" chunks in "<<timer.real()<<" seconds"<<std::endl;
+  }
+  catch(const AskapError &ce) {
+     cerr<<"AskapError has been caught. "<<ce.what()<<endl;
+     return -1;
+  }
+  catch(const std::exception &ex) {
+     cerr<<"std::exception has been caught. "<<ex.what()<<endl;
+     return -1;
+  }
+  catch(...) {
+     cerr<<"An unexpected exception has been caught"<<endl;
+     return -1;
+  }
+  return 0;
+}
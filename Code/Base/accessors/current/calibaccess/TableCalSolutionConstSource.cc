@@ -33,6 +33,7 @@
 #include <calibaccess/TableCalSolutionConstSource.h>
 #include <calibaccess/TableCalSolutionFiller.h>
 #include <calibaccess/MemCalSolutionAccessor.h>
+#include <dataaccess/CasacoreLock.h>
 #include <measures/TableMeasures/ScalarMeasColumn.h>
 #include <measures/Measures/MEpoch.h>
 #include <measures/Measures/MCEpoch.h>
@@ -53,7 +54,7 @@ TableCalSolutionConstSource::TableCalSolutionConstSource(const casa::Table &tab)
 /// @details The table is opened for reading and an exception is thrown if the table doesn't exist
 /// @param[in] name table file name 
 TableCalSolutionConstSource::TableCalSolutionConstSource(const std::string &name) : 
-        TableHolder(casa::Table(name)) 
+        TableHolder(CasacoreLock::openTable(name)) 
 {
   ASKAPCHECK(table().nrow()>0, "The table "<<name<<" passed to TableCalSolutionConstSource is empty");
 }
@@ -63,6 +64,7 @@ TableCalSolutionConstSource::TableCalSolutionConstSource(const std::string &name
 /// @return ID for the most recent solution
 long TableCalSolutionConstSource::mostRecentSolution() const 
 {
+  const CasacoreLock lock;
   // derived classes may initialise the table for writing and, therefore, it could be empty by this point
   // despite the check in the constructor
   return table().nrow() > 0 ? long(table().nrow()) - 1 : -1;
@@ -76,6 +78,7 @@ long TableCalSolutionConstSource::mostRecentSolution() const
 /// @return solution ID
 long TableCalSolutionConstSource::solutionID(const double time) const
 {
+  const CasacoreLock lock;
   ASKAPASSERT(table().nrow()>0);
   casa::ROScalarMeasColumn<casa::MEpoch> bufCol(table(),"TIME");
   for (casa::uInt row = table().nrow(); row > 0; --row) {
@@ -96,6 +99,7 @@ long TableCalSolutionConstSource::solutionID(const double time) const
 /// @return shared pointer to an accessor object
 boost::shared_ptr<ICalSolutionConstAccessor> TableCalSolutionConstSource::roSolution(const long id) const
 {
+  const CasacoreLock lock;
   ASKAPCHECK((id >= 0) && (long(table().nrow()) > id), "Requested solution id="<<id<<" is not in the table");
   boost::shared_ptr<TableCalSolutionFiller> filler(new TableCalSolutionFiller(table(),id));
   ASKAPDEBUGASSERT(filler);
@@ -112,6 +116,7 @@ boost::shared_ptr<ICalSolutionConstAccessor> TableCalSolutionConstSource::roSolu
 /// @return true, if table exists and is useable, false otherwise
 bool TableCalSolutionConstSource::tableExists(const std::string &fname)
 {
+  const CasacoreLock lock;
   try {
      casa::Table testTab(fname,casa::Table::Old);
      testTab.throwIfNull();
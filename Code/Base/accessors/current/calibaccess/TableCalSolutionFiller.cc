@@ -37,6 +37,7 @@
 
 #include <map>
 #include <calibaccess/TableCalSolutionFiller.h>
+#include <dataaccess/CasacoreLock.h>
 
 namespace askap {
 
@@ -45,6 +46,7 @@ namespace accessors {
 /// @brief helper method to check whether we are creating a new row
 void TableCalSolutionFiller::checkForNewRow()
 {
+  const CasacoreLock lock;
   ASKAPDEBUGASSERT(itsRefRow <= long(table().nrow()));
   itsCreateNew = (itsRefRow + 1 == long(table().nrow()));
   if (itsCreateNew) {
@@ -96,6 +98,7 @@ TableCalSolutionFiller::TableCalSolutionFiller(const casa::Table& tab, const lon
 /// @return true if the given column exists
 bool TableCalSolutionFiller::columnExists(const std::string &name) const
 {
+  const CasacoreLock lock;
   const std::map<std::string, bool>::const_iterator it = itsColumnExistsCache.find(name);
   if (it != itsColumnExistsCache.end()) {
       return it->second;
@@ -133,6 +136,7 @@ bool TableCalSolutionFiller::noBandpass() const
 /// @param[in] gains pair of cubes with gains and validity flags (to be resised to 2 x nAnt x nBeam)
 void TableCalSolutionFiller::fillGains(std::pair<casa::Cube<casa::Complex>, casa::Cube<casa::Bool> > &gains) const
 {
+  const CasacoreLock lock;
   if (itsCreateNew || noGain()) {
       ASKAPDEBUGASSERT(itsGainsRow < 0);
       gains.first.resize(2, itsNAnt, itsNBeam);
@@ -158,6 +162,7 @@ void TableCalSolutionFiller::fillGains(std::pair<casa::Cube<casa::Complex>, casa
 /// @param[in] leakages pair of cubes with leakages and validity flags (to be resised to 2 x nAnt x nBeam)
 void TableCalSolutionFiller::fillLeakages(std::pair<casa::Cube<casa::Complex>, casa::Cube<casa::Bool> > &leakages) const
 {
+  const CasacoreLock lock;
   if (itsCreateNew || noLeakage()) {
       ASKAPDEBUGASSERT(itsLeakagesRow < 0);
       leakages.first.resize(2, itsNAnt, itsNBeam);
@@ -183,6 +188,7 @@ void TableCalSolutionFiller::fillLeakages(std::pair<casa::Cube<casa::Complex>, c
 /// @param[in] bp pair of cubes with bandpasses and validity flags (to be resised to (2*nChan) x nAnt x nBeam)
 void TableCalSolutionFiller::fillBandpasses(std::pair<casa::Cube<casa::Complex>, casa::Cube<casa::Bool> > &bp) const
 {
+  const CasacoreLock lock;
   if (itsCreateNew || noBandpass()) {
       ASKAPDEBUGASSERT(itsBandpassesRow < 0);
       bp.first.resize(2 * itsNChan, itsNAnt, itsNBeam);
@@ -208,6 +214,7 @@ void TableCalSolutionFiller::fillBandpasses(std::pair<casa::Cube<casa::Complex>,
 /// @param[in] gains pair of cubes with gains and validity flags (should be 2 x nAnt x nBeam)
 void TableCalSolutionFiller::writeGains(const std::pair<casa::Cube<casa::Complex>, casa::Cube<casa::Bool> > &gains) const
 {
+  const CasacoreLock lock;
   ASKAPASSERT(itsGainsRow>=0);
   ASKAPCHECK(gains.first.shape() == gains.second.shape(), "The cubes with gains and validity flags are expected to have the same shape");
   writeCube(gains.first, "GAIN", casa::uInt(itsGainsRow));
@@ -219,6 +226,7 @@ void TableCalSolutionFiller::writeGains(const std::pair<casa::Cube<casa::Complex
 /// @param[in] leakages pair of cubes with leakages and validity flags (should be 2 x nAnt x nBeam)
 void TableCalSolutionFiller::writeLeakages(const std::pair<casa::Cube<casa::Complex>, casa::Cube<casa::Bool> > &leakages) const
 {
+  const CasacoreLock lock;
   ASKAPASSERT(itsLeakagesRow>=0);
   ASKAPCHECK(leakages.first.shape() == leakages.second.shape(), "The cubes with leakages and validity flags are expected to have the same shape");
   writeCube(leakages.first, "LEAKAGE", casa::uInt(itsLeakagesRow));
@@ -230,6 +238,7 @@ void TableCalSolutionFiller::writeLeakages(const std::pair<casa::Cube<casa::Comp
 /// @param[in] bp pair of cubes with bandpasses and validity flags (should be (2*nChan) x nAnt x nBeam)
 void TableCalSolutionFiller::writeBandpasses(const std::pair<casa::Cube<casa::Complex>, casa::Cube<casa::Bool> > &bp) const
 {
+  const CasacoreLock lock;
   ASKAPASSERT(itsBandpassesRow>=0);
   ASKAPCHECK(bp.first.shape() == bp.second.shape(), "The cubes with bandpasses and validity flags are expected to have the same shape");
   writeCube(bp.first, "BANDPASS", casa::uInt(itsBandpassesRow));
@@ -245,6 +254,7 @@ void TableCalSolutionFiller::writeBandpasses(const std::pair<casa::Cube<casa::Co
 /// @note The code always returns non-negative number.
 long TableCalSolutionFiller::findDefinedCube(const std::string &name) const
 {
+  const CasacoreLock lock;
   for (long tempRow = itsRefRow; tempRow >= 0; --tempRow) {
        if (cellDefined<casa::Complex>(name, casa::uInt(tempRow))) {
            return tempRow;
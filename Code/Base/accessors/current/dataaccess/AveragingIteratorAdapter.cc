@@ -0,0 +1,577 @@
+/// @file
+/// @brief iterator adapter averaging visibilities in time and frequency
+/// @details Gridding cost is proportional to the number of visibilities, while
+/// for many observations the data are sampled much finer in time and frequency than
+/// required by the field of view being imaged. This adapter combines the consecutive
+/// chunks of the wrapped iterator and adjacent spectral channels before the data
+/// reach the gridder. The bin sizes can be limited automatically to keep the time
+/// and bandwidth smearing at the edge of the field below the given tolerance.
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author agent <agent@local>
+///
+
+
+#include <askap_accessors.h>
+
+#include <askap/AskapLogging.h>
+#include <askap/AskapError.h>
+
+#include <dataaccess/AveragingIteratorAdapter.h>
+#include <dataaccess/DataAccessError.h>
+#include <dataaccess/IDataAccessor.h>
+#include <dataaccess/UVWRotationHandler.h>
+
+// casa includes
+#include <casa/Arrays/Cube.h>
+#include <casa/Arrays/ArrayMath.h>
+#include <casa/BasicSL/Constants.h>
+
+// std includes
+#include <algorithm>
+#include <cmath>
+
+ASKAP_LOGGER(logger, ".dataaccess");
+
+namespace askap {
+
+namespace accessors {
+
+/// @brief averaged chunk
+/// @details All fields are filled by the adapter when the bin is complete. Rotated uvw and
+/// delays are computed from the averaged uvw on demand.
+class AveragingIteratorAdapter::Chunk : virtual public IDataAccessor {
+public:
+  /// @brief construct an empty chunk
+  /// @param[in] cacheSize a number of uvw machines in the cache
+  /// @param[in] tolerance pointing direction tolerance in radians for the uvw machine cache
+  Chunk(size_t cacheSize, double tolerance) : itsTime(0.), itsRotatedUVW(cacheSize, tolerance) {}
+
+  /// @return the number of rows in this chunk
+  virtual casa::uInt nRow() const throw() { return itsVisibility.nrow(); }
+
+  /// @return the number of spectral channels
+  virtual casa::uInt nChannel() const throw() { return itsVisibility.ncolumn(); }
+
+  /// @return the number of polarization products
+  virtual casa::uInt nPol() const throw() { return itsVisibility.nplane(); }
+
+  /// @return IDs of the first antenna for each row
+  virtual const casa::Vector<casa::uInt>& antenna1() const { return itsAntenna1; }
+
+  /// @return IDs of the second antenna for each row
+  virtual const casa::Vector<casa::uInt>& antenna2() const { return itsAntenna2; }
+
+  /// @return IDs of the first feed for each row
+  virtual const casa::Vector<casa::uInt>& feed1() const { return itsFeed1; }
+
+  /// @return IDs of the second feed for each row
+  virtual const casa::Vector<casa::uInt>& feed2() const { return itsFeed2; }
+
+  /// @return position angles of the first feed for each row
+  virtual const casa::Vector<casa::Float>& feed1PA() const { return itsFeed1PA; }
+
+  /// @return position angles of the second feed for each row
+  virtual const casa::Vector<casa::Float>& feed2PA() const { return itsFeed2PA; }
+
+  /// @return pointing centre directions of the first antenna/feed for each row
+  virtual const casa::Vector<casa::MVDirection>& pointingDir1() const { return itsPointingDir1; }
+
+  /// @return pointing centre directions of the second antenna/feed for each row
+  virtual const casa::Vector<casa::MVDirection>& pointingDir2() const { return itsPointingDir2; }
+
+  /// @return pointing directions of the centre of the first antenna for each row
+  virtual const casa::Vector<casa::MVDirection>& dishPointing1() const { return itsDishPointing1; }
+
+  /// @return pointing directions of the centre of the second antenna for each row
+  virtual const casa::Vector<casa::MVDirection>& dishPointing2() const { return itsDishPointing2; }
+
+  /// @return averaged visibilities (nRow x nChannel x nPol)
+  virtual const casa::Cube<casa::Complex>& visibility() const { return itsVisibility; }
+
+  /// @brief read-write access to visibilities
+  /// @details Changes are not propagated to the wrapped iterator
+  /// @return averaged visibilities (nRow x nChannel x nPol)
+  virtual casa::Cube<casa::Complex>& rwVisibility() { return itsVisibility; }
+
+  /// @return flags (nRow x nChannel x nPol)
+  virtual const casa::Cube<casa::Bool>& flag() const { return itsFlag; }
+
+  /// @return averaged uvw for each row
+  virtual const casa::Vector<casa::RigidVector<casa::Double, 3> >& uvw() const { return itsUVW; }
+
+  /// @brief uvw after rotation
+  /// @param[in] tangentPoint tangent point to rotate the coordinates to
+  /// @return uvw after rotation to the new coordinate system for each row
+  virtual const casa::Vector<casa::RigidVector<casa::Double, 3> >&
+           rotatedUVW(const casa::MDirection &tangentPoint) const
+  { return itsRotatedUVW.uvw(*this, tangentPoint); }
+
+  /// @brief delay associated with uvw rotation
+  /// @param[in] tangentPoint tangent point to rotate the coordinates to
+  /// @param[in] imageCentre image centre (additional translation is done if imageCentre!=tangentPoint)
+  /// @return delays corresponding to the uvw rotation for each row
+  virtual const casa::Vector<casa::Double>& uvwRotationDelay(
+           const casa::MDirection &tangentPoint, const casa::MDirection &imageCentre) const
+  { return itsRotatedUVW.delays(*this, tangentPoint, imageCentre); }
+
+  /// @return noise of the averaged visibilities (nRow x nChannel x nPol)
+  virtual const casa::Cube<casa::Complex>& noise() const { return itsNoise; }
+
+  /// @return mean time of the bin
+  virtual casa::Double time() const { return itsTime; }
+
+  /// @return mean frequency of each channel group
+  virtual const casa::Vector<casa::Double>& frequency() const { return itsFrequency; }
+
+  /// @brief velocity for each channel
+  /// @details Not supported, as velocities can't be averaged without the rest frequency
+  /// @return a reference to vector containing velocities for each spectral channel
+  virtual const casa::Vector<casa::Double>& velocity() const
+  { ASKAPTHROW(DataAccessError, "Velocities are not supported by AveragingIteratorAdapter"); }
+
+  /// @return polarisation type for each product
+  virtual const casa::Vector<casa::Stokes::StokesTypes>& stokes() const { return itsStokes; }
+
+  /// @brief first antenna IDs
+  casa::Vector<casa::uInt> itsAntenna1;
+  /// @brief second antenna IDs
+  casa::Vector<casa::uInt> itsAntenna2;
+  /// @brief first feed IDs
+  casa::Vector<casa::uInt> itsFeed1;
+  /// @brief second feed IDs
+  casa::Vector<casa::uInt> itsFeed2;
+  /// @brief position angles of the first feed
+  casa::Vector<casa::Float> itsFeed1PA;
+  /// @brief position angles of the second feed
+  casa::Vector<casa::Float> itsFeed2PA;
+  /// @brief pointing directions of the first antenna/feed
+  casa::Vector<casa::MVDirection> itsPointingDir1;
+  /// @brief pointing directions of the second antenna/feed
+  casa::Vector<casa::MVDirection> itsPointingDir2;
+  /// @brief pointing directions of the centre of the first antenna
+  casa::Vector<casa::MVDirection> itsDishPointing1;
+  /// @brief pointing directions of the centre of the second antenna
+  casa::Vector<casa::MVDirection> itsDishPointing2;
+  /// @brief visibilities
+  casa::Cube<casa::Complex> itsVisibility;
+  /// @brief flags
+  casa::Cube<casa::Bool> itsFlag;
+  /// @brief noise
+  casa::Cube<casa::Complex> itsNoise;
+  /// @brief uvw
+  casa::Vector<casa::RigidVector<casa::Double, 3> > itsUVW;
+  /// @brief time
+  casa::Double itsTime;
+  /// @brief frequencies
+  casa::Vector<casa::Double> itsFrequency;
+  /// @brief polarisation products
+  casa::Vector<casa::Stokes::StokesTypes> itsStokes;
+private:
+  /// @brief uvw rotation handler
+  UVWRotationHandler itsRotatedUVW;
+};
+
+/// @brief setup with the given iterator
+/// @param[in] iter shared pointer to iterator to be wrapped
+/// @param[in] interval maximum time span of the bin in seconds (0 means no averaging
+/// in time, negative value means no limit other than the smearing limit, if set)
+/// @param[in] nChanAvg number of adjacent channels to average (1 means no averaging
+/// in frequency)
+AveragingIteratorAdapter::AveragingIteratorAdapter(const boost::shared_ptr<IConstDataIterator> &iter,
+                           double interval, casa::uInt nChanAvg) : DataIteratorAdapter(iter),
+       itsInterval(interval), itsNChanAvg(nChanAvg), itsFieldRadius(-1.), itsSmearingTolerance(0.),
+       itsLimitApplied(false), itsUVWCacheSize(1), itsUVWCacheTolerance(1e-6),
+       itsPointingTolerance(1e-6), itsNChunks(0),
+       itsStartTime(0.), itsTimeSum(0.), itsNInputChunks(0), itsNOutputChunks(0)
+{
+  ASKAPCHECK(iter, "An attempt to initialise AveragingIteratorAdapter with empty shared pointer");
+  ASKAPCHECK(nChanAvg > 0, "Number of channels to average should be positive");
+}
+
+/// @brief limit the bins to keep the smearing below the tolerance
+/// @details The limits are derived for the longest baseline and the highest frequency
+/// of the first chunk: the phase change across the bin at the edge of the field should not
+/// reduce the amplitude by more than the given fraction (for a boxcar average the loss is
+/// approximately phase^2/24). The rotation of the Earth is used to estimate the
+/// rate of phase change in time. The limits replace the bins given in the constructor if
+/// they are smaller. They are computed at the start of the first pass.
+/// @param[in] fieldRadius largest angular distance from the tangent point to be imaged (in radians)
+/// @param[in] tolerance acceptable fractional amplitude loss (e.g. 0.01)
+void AveragingIteratorAdapter::setSmearingLimit(double fieldRadius, double tolerance)
+{
+  ASKAPCHECK(fieldRadius > 0, "Field radius should be positive, you have "<<fieldRadius);
+  ASKAPCHECK((tolerance > 0) && (tolerance < 1), "Smearing tolerance should be between 0 and 1, you have "<<
+             tolerance);
+  ASKAPCHECK(!itsLimitApplied, "Smearing limit should be set before the iteration starts");
+  itsFieldRadius = fieldRadius;
+  itsSmearingTolerance = tolerance;
+}
+
+/// @brief configure caching of the uvw machines
+/// @details The output accessor rotates uvw itself (see UVWRotationHandler), these
+/// parameters have the same meaning as those of the data source
+/// @param[in] cacheSize a number of uvw machines in the cache (default is 1)
+/// @param[in] tolerance pointing direction tolerance in radians, exceeding which leads
+/// to initialisation of a new UVW Machine
+void AveragingIteratorAdapter::configureUVWMachineCache(size_t cacheSize, double tolerance)
+{
+  itsUVWCacheSize = cacheSize;
+  itsUVWCacheTolerance = tolerance;
+}
+
+/// @brief set the tolerance for changes of the pointing direction within the bin
+/// @details A chunk is only added to the current bin if the pointing direction of each
+/// baseline already present in the bin has moved by no more than the given angle
+/// (default is 1e-6 radians).
+/// @param[in] tolerance maximum angular separation in radians
+void AveragingIteratorAdapter::setPointingTolerance(double tolerance)
+{
+  ASKAPCHECK(tolerance >= 0., "Pointing tolerance should not be negative, you have "<<tolerance);
+  itsPointingTolerance = tolerance;
+}
+
+/// @brief restart the iteration from the beginning
+void AveragingIteratorAdapter::init()
+{
+  DataIteratorAdapter::init();
+  itsNInputChunks = 0;
+  itsNOutputChunks = 0;
+  accumulate();
+}
+
+/// operator* delivers a reference to data accessor (current chunk)
+/// @return a reference to the current chunk
+IDataAccessor& AveragingIteratorAdapter::operator*() const
+{
+  ASKAPCHECK(itsCurrent, "AveragingIteratorAdapter has no more data");
+  return *itsCurrent;
+}
+
+/// Checks whether there are more data available.
+/// @return True if there are more data available
+casa::Bool AveragingIteratorAdapter::hasMore() const throw()
+{
+  return static_cast<bool>(itsCurrent);
+}
+
+/// advance the iterator one step further
+/// @return True if there are more data (so constructions like
+///         while(it.next()) {} are possible)
+casa::Bool AveragingIteratorAdapter::next()
+{
+  accumulate();
+  if (!hasMore()) {
+      ASKAPLOG_DEBUG_STR(logger, "AveragingIteratorAdapter: "<<itsNInputChunks<<" chunks averaged into "<<
+                         itsNOutputChunks);
+  }
+  return hasMore();
+}
+
+/// @brief switch the output of operator* to one of the buffers
+/// @details Buffers are not supported by this adapter, an exception is thrown
+/// @param[in] bufferID  the name of the buffer to choose
+void AveragingIteratorAdapter::chooseBuffer(const std::string &bufferID)
+{
+  ASKAPTHROW(DataAccessError, "Buffers are not supported by AveragingIteratorAdapter, requested buffer "<<
+             bufferID);
+}
+
+/// @brief switch the output of operator* to the original state
+/// @details This adapter always delivers the averaged visibilities, so nothing is done
+void AveragingIteratorAdapter::chooseOriginal()
+{
+}
+
+/// @brief return any associated buffer for read/write access
+/// @details Buffers are not supported by this adapter, an exception is thrown
+/// @param[in] bufferID the name of the buffer requested
+/// @return a reference to writable data accessor to the buffer requested
+IDataAccessor& AveragingIteratorAdapter::buffer(const std::string &bufferID) const
+{
+  ASKAPTHROW(DataAccessError, "Buffers are not supported by AveragingIteratorAdapter, requested buffer "<<
+             bufferID);
+}
+
+/// @brief read the chunks of the wrapped iterator which belong to the next bin
+/// @details The current chunk is empty after this call if there are no more data
+void AveragingIteratorAdapter::accumulate()
+{
+  itsCurrent.reset();
+  itsRows.clear();
+  itsRowIndices.clear();
+  itsNChunks = 0;
+  itsTimeSum = 0.;
+  // the wrapped iterator is left at the first chunk which doesn't fit into the bin
+  for (; DataIteratorAdapter::hasMore(); DataIteratorAdapter::next()) {
+       const IConstDataAccessor &acc = *roIterator();
+       if (!itsLimitApplied) {
+           applySmearingLimit(acc);
+       }
+       if ((itsNChunks > 0) && !fitsBin(acc)) {
+           break;
+       }
+       add(acc);
+  }
+  if (itsNChunks > 0) {
+      finishBin();
+  }
+}
+
+/// @brief check whether the given accessor can be added to the current bin
+/// @param[in] acc accessor of the wrapped iterator
+/// @return true, if the accessor can be added
+bool AveragingIteratorAdapter::fitsBin(const IConstDataAccessor &acc) const
+{
+  ASKAPDEBUGASSERT(itsNChunks > 0);
+  const casa::Double time = acc.time();
+  if ((time < itsStartTime) || ((itsInterval >= 0.) && (time - itsStartTime >= itsInterval))) {
+      return false;
+  }
+  const casa::Vector<casa::Stokes::StokesTypes> &stokes = acc.stokes();
+  if (stokes.nelements() != itsStokes.nelements()) {
+      return false;
+  }
+  for (casa::uInt pol = 0; pol < stokes.nelements(); ++pol) {
+       if (stokes[pol] != itsStokes[pol]) {
+           return false;
+       }
+  }
+  const casa::Vector<casa::Double> &freq = acc.frequency();
+  if ((freq.nelements() != itsFrequencies.nelements()) || !casa::allNear(freq, itsFrequencies, 1e-12)) {
+      return false;
+  }
+  // the phase centre of each baseline should stay the same within the bin
+  const casa::Vector<casa::uInt> &ant1 = acc.antenna1();
+  const casa::Vector<casa::uInt> &ant2 = acc.antenna2();
+  const casa::Vector<casa::uInt> &feed1 = acc.feed1();
+  const casa::Vector<casa::uInt> &feed2 = acc.feed2();
+  const casa::Vector<casa::MVDirection> &pointingDir1 = acc.pointingDir1();
+  for (casa::uInt row = 0; row < acc.nRow(); ++row) {
+       const std::map<BaselineKey, size_t>::const_iterator ci = itsRowIndices.find(
+             BaselineKey(std::make_pair(ant1[row], ant2[row]), std::make_pair(feed1[row], feed2[row])));
+       if (ci != itsRowIndices.end()) {
+           ASKAPDEBUGASSERT(ci->second < itsRows.size());
+           if (itsRows[ci->second].itsPointingDir1.separation(pointingDir1[row]) > itsPointingTolerance) {
+               return false;
+           }
+       }
+  }
+  return true;
+}
+
+/// @brief add the given accessor to the current bin
+/// @param[in] acc accessor of the wrapped iterator
+void AveragingIteratorAdapter::add(const IConstDataAccessor &acc)
+{
+  if (itsNChunks == 0) {
+      itsStartTime = acc.time();
+      itsFrequencies.resize(acc.nChannel());
+      itsFrequencies = acc.frequency();
+      itsStokes.resize(acc.nPol());
+      itsStokes = acc.stokes();
+  }
+  itsTimeSum += acc.time();
+  ++itsNChunks;
+  ++itsNInputChunks;
+
+  const casa::uInt nPol = acc.nPol();
+  const casa::uInt nChan = acc.nChannel();
+  const casa::uInt nChanOut = (nChan + itsNChanAvg - 1) / itsNChanAvg;
+  const casa::Vector<casa::uInt> &ant1 = acc.antenna1();
+  const casa::Vector<casa::uInt> &ant2 = acc.antenna2();
+  const casa::Vector<casa::uInt> &feed1 = acc.feed1();
+  const casa::Vector<casa::uInt> &feed2 = acc.feed2();
+  const casa::Cube<casa::Complex> &vis = acc.visibility();
+  const casa::Cube<casa::Bool> &flag = acc.flag();
+  const casa::Cube<casa::Complex> &noise = acc.noise();
+  const casa::Vector<casa::RigidVector<casa::Double, 3> > &uvw = acc.uvw();
+  for (casa::uInt row = 0; row < acc.nRow(); ++row) {
+       const BaselineKey key(std::make_pair(ant1[row], ant2[row]), std::make_pair(feed1[row], feed2[row]));
+       std::map<BaselineKey, size_t>::const_iterator ci = itsRowIndices.find(key);
+       if (ci == itsRowIndices.end()) {
+           // new baseline, the metadata are taken from its first sample
+           ci = itsRowIndices.insert(std::make_pair(key, itsRows.size())).first;
+           itsRows.push_back(Row());
+           Row &newRow = itsRows.back();
+           newRow.itsAntenna1 = ant1[row];
+           newRow.itsAntenna2 = ant2[row];
+           newRow.itsFeed1 = feed1[row];
+           newRow.itsFeed2 = feed2[row];
+           newRow.itsFeed1PA = acc.feed1PA()[row];
+           newRow.itsFeed2PA = acc.feed2PA()[row];
+           newRow.itsPointingDir1 = acc.pointingDir1()[row];
+           newRow.itsPointingDir2 = acc.pointingDir2()[row];
+           newRow.itsDishPointing1 = acc.dishPointing1()[row];
+           newRow.itsDishPointing2 = acc.dishPointing2()[row];
+           newRow.itsUVWSum = casa::RigidVector<casa::Double, 3>(0., 0., 0.);
+           newRow.itsNSamples = 0;
+           newRow.itsVisSum.assign(nChanOut * nPol, casa::Complex(0.,0.));
+           newRow.itsWeightSum.assign(nChanOut * nPol, 0.);
+       }
+       ASKAPDEBUGASSERT(ci->second < itsRows.size());
+       Row &thisRow = itsRows[ci->second];
+       thisRow.itsUVWSum += uvw[row];
+       ++thisRow.itsNSamples;
+       for (casa::uInt chan = 0; chan < nChan; ++chan) {
+            const casa::uInt offset = (chan / itsNChanAvg) * nPol;
+            for (casa::uInt pol = 0; pol < nPol; ++pol) {
+                 if (!flag(row, chan, pol)) {
+                     const casa::Float sigma = casa::real(noise(row, chan, pol));
+                     const casa::Float weight = sigma > 0 ? 1. / (sigma * sigma) : 1.;
+                     thisRow.itsVisSum[offset + pol] += weight * vis(row, chan, pol);
+                     thisRow.itsWeightSum[offset + pol] += weight;
+                 }
+            }
+       }
+  }
+}
+
+/// @brief form the current chunk from the accumulated sums
+void AveragingIteratorAdapter::finishBin()
+{
+  ASKAPDEBUGASSERT(itsNChunks > 0);
+  const casa::uInt nRow = itsRows.size();
+  const casa::uInt nPol = itsStokes.nelements();
+  const casa::uInt nChan = itsFrequencies.nelements();
+  const casa::uInt nChanOut = (nChan + itsNChanAvg - 1) / itsNChanAvg;
+  boost::shared_ptr<Chunk> chunk(new Chunk(itsUVWCacheSize, itsUVWCacheTolerance));
+  chunk->itsAntenna1.resize(nRow);
+  chunk->itsAntenna2.resize(nRow);
+  chunk->itsFeed1.resize(nRow);
+  chunk->itsFeed2.resize(nRow);
+  chunk->itsFeed1PA.resize(nRow);
+  chunk->itsFeed2PA.resize(nRow);
+  chunk->itsPointingDir1.resize(nRow);
+  chunk->itsPointingDir2.resize(nRow);
+  chunk->itsDishPointing1.resize(nRow);
+  chunk->itsDishPointing2.resize(nRow);
+  chunk->itsUVW.resize(nRow);
+  chunk->itsVisibility.resize(nRow, nChanOut, nPol);
+  chunk->itsFlag.resize(nRow, nChanOut, nPol);
+  chunk->itsNoise.resize(nRow, nChanOut, nPol);
+  for (casa::uInt row = 0; row < nRow; ++row) {
+       const Row &thisRow = itsRows[row];
+       chunk->itsAntenna1[row] = thisRow.itsAntenna1;
+       chunk->itsAntenna2[row] = thisRow.itsAntenna2;
+       chunk->itsFeed1[row] = thisRow.itsFeed1;
+       chunk->itsFeed2[row] = thisRow.itsFeed2;
+       chunk->itsFeed1PA[row] = thisRow.itsFeed1PA;
+       chunk->itsFeed2PA[row] = thisRow.itsFeed2PA;
+       chunk->itsPointingDir1[row] = thisRow.itsPointingDir1;
+       chunk->itsPointingDir2[row] = thisRow.itsPointingDir2;
+       chunk->itsDishPointing1[row] = thisRow.itsDishPointing1;
+       chunk->itsDishPointing2[row] = thisRow.itsDishPointing2;
+       ASKAPDEBUGASSERT(thisRow.itsNSamples > 0);
+       for (casa::uInt dim = 0; dim < 3; ++dim) {
+            chunk->itsUVW[row](dim) = thisRow.itsUVWSum(dim) / thisRow.itsNSamples;
+       }
+       for (casa::uInt chan = 0; chan < nChanOut; ++chan) {
+            for (casa::uInt pol = 0; pol < nPol; ++pol) {
+                 const casa::Float weight = thisRow.itsWeightSum[chan * nPol + pol];
+                 if (weight > 0) {
+                     const casa::Float sigma = 1. / std::sqrt(weight);
+                     chunk->itsVisibility(row, chan, pol) = thisRow.itsVisSum[chan * nPol + pol] / weight;
+                     chunk->itsNoise(row, chan, pol) = casa::Complex(sigma, sigma);
+                     chunk->itsFlag(row, chan, pol) = casa::False;
+                 } else {
+                     chunk->itsVisibility(row, chan, pol) = casa::Complex(0., 0.);
+                     chunk->itsNoise(row, chan, pol) = casa::Complex(1., 1.);
+                     chunk->itsFlag(row, chan, pol) = casa::True;
+                 }
+            }
+       }
+  }
+  chunk->itsFrequency.resize(nChanOut);
+  for (casa::uInt chan = 0; chan < nChanOut; ++chan) {
+       const casa::uInt start = chan * itsNChanAvg;
+       const casa::uInt stop = std::min(start + itsNChanAvg, nChan);
+       casa::Double freqSum = 0.;
+       for (casa::uInt inChan = start; inChan < stop; ++inChan) {
+            freqSum += itsFrequencies[inChan];
+       }
+       chunk->itsFrequency[chan] = freqSum / (stop - start);
+  }
+  chunk->itsTime = itsTimeSum / itsNChunks;
+  chunk->itsStokes.resize(nPol);
+  chunk->itsStokes = itsStokes;
+  itsCurrent = chunk;
+  ++itsNOutputChunks;
+}
+
+/// @brief compute the smearing limits for the given accessor and apply them
+/// @param[in] acc first accessor of the wrapped iterator
+void AveragingIteratorAdapter::applySmearingLimit(const IConstDataAccessor &acc)
+{
+  itsLimitApplied = true;
+  if (itsFieldRadius <= 0.) {
+      ASKAPLOG_INFO_STR(logger, "Visibilities will be averaged in bins of "<<itsNChanAvg<<
+                        " channel(s) and up to "<<itsInterval<<" s, no smearing limit is applied");
+      return;
+  }
+  double maxBaseline = 0.;
+  const casa::Vector<casa::RigidVector<casa::Double, 3> > &uvw = acc.uvw();
+  for (casa::uInt row = 0; row < uvw.nelements(); ++row) {
+       const double length = std::sqrt(uvw[row](0) * uvw[row](0) + uvw[row](1) * uvw[row](1) +
+                                       uvw[row](2) * uvw[row](2));
+       if (length > maxBaseline) {
+           maxBaseline = length;
+       }
+  }
+  if (maxBaseline <= 0.) {
+      ASKAPLOG_WARN_STR(logger, "Unable to determine the longest baseline, no smearing limit is applied");
+      return;
+  }
+  const casa::Vector<casa::Double> &freq = acc.frequency();
+  ASKAPCHECK(freq.nelements() > 0, "No spectral channels in the data");
+  // baseline length in wavelengths times the field radius, i.e. the number of turns of phase
+  // across the field for the longest baseline at the highest frequency
+  const double turns = itsFieldRadius * maxBaseline * casa::max(freq) / casa::C::c;
+  // maximum phase change across the bin giving the required amplitude loss (in radians)
+  const double maxPhase = std::sqrt(24. * itsSmearingTolerance);
+  // angular velocity of the Earth rotation in rad/s
+  const double earthRate = 7.2921150e-5;
+  const double maxInterval = maxPhase / (2. * casa::C::pi * earthRate * turns);
+  if ((itsInterval < 0.) || (itsInterval > maxInterval)) {
+      itsInterval = maxInterval;
+  }
+  if (freq.nelements() > 1) {
+      const double maxBandwidth = maxPhase * casa::C::c / (2. * casa::C::pi * itsFieldRadius * maxBaseline);
+      const double chanWidth = std::abs(freq[1] - freq[0]);
+      if (chanWidth > 0.) {
+          const casa::uInt maxNChanAvg = std::max(casa::uInt(1), casa::uInt(std::floor(maxBandwidth / chanWidth)));
+          if (itsNChanAvg > maxNChanAvg) {
+              itsNChanAvg = maxNChanAvg;
+          }
+      }
+  }
+  ASKAPLOG_INFO_STR(logger, "Visibilities will be averaged in bins of "<<itsNChanAvg<<
+                    " channel(s) and up to "<<itsInterval<<" s; longest baseline is "<<maxBaseline<<
+                    " m, field radius is "<<itsFieldRadius / casa::C::pi * 180.<<" deg, tolerance "<<
+                    itsSmearingTolerance);
+}
+
+} // namespace accessors
+
+} // namespace askap
@@ -0,0 +1,279 @@
+/// @file
+/// @brief iterator adapter averaging visibilities in time and frequency
+/// @details Gridding cost is proportional to the number of visibilities, while
+/// for many observations the data are sampled much finer in time and frequency than
+/// required by the field of view being imaged. This adapter combines the consecutive
+/// chunks of the wrapped iterator and adjacent spectral channels before the data
+/// reach the gridder. The bin sizes can be limited automatically to keep the time
+/// and bandwidth smearing at the edge of the field below the given tolerance.
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author agent <agent@local>
+///
+
+#ifndef ASKAP_ACCESSORS_AVERAGING_ITERATOR_ADAPTER_H
+#define ASKAP_ACCESSORS_AVERAGING_ITERATOR_ADAPTER_H
+
+// own includes
+#include <dataaccess/DataIteratorAdapter.h>
+
+// casa includes
+#include <casa/Arrays/Vector.h>
+#include <casa/BasicSL/Complex.h>
+#include <scimath/Mathematics/RigidVector.h>
+#include <casa/Quanta/MVDirection.h>
+#include <measures/Measures/Stokes.h>
+
+// boost includes
+#include <boost/shared_ptr.hpp>
+
+// std includes
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace askap {
+
+namespace accessors {
+
+/// @brief iterator adapter averaging visibilities in time and frequency
+/// @details Consecutive chunks of the wrapped iterator are combined into one chunk of this
+/// adapter until the time span of the bin reaches the given interval, the spectral or
+/// polarisation axis changes or the pointing direction of one of the baselines changes.
+/// Rows of the output chunk correspond to distinct baselines (antenna and feed pairs) in the
+/// order of their first appearance in the bin. A baseline present only in some of the input
+/// chunks is averaged over the samples available. Adjacent channels are averaged in groups of
+/// the given size (the last group may be partial), the output frequency is the mean
+/// frequency of the group.
+///
+/// Visibilities are averaged with the weights derived from the noise (1/sigma^2). Flagged
+/// samples are excluded; the output sample is flagged only if all input samples are flagged.
+/// The output noise is that of the weighted mean. The output time and uvw are the means over
+/// the input chunks; parallactic angles and pointing directions are taken from the first
+/// sample of each baseline. As uvw rotation is linear, rotatedUVW and uvwRotationDelay of the
+/// output chunk are consistent with averaging of the rotated input quantities.
+///
+/// The accessor has a single timestamp, so the bins are the same for all baselines,
+/// including the longest ones. Use the smearing limit to choose the bins appropriate for
+/// the longest baseline. Time is assumed to be in seconds and frequency in Hz (set up
+/// via the converter). Accessors returned by this adapter are writeable, but the changes
+/// are not propagated to the wrapped iterator. Buffers are not supported.
+/// @ingroup dataaccess_hlp
+class AveragingIteratorAdapter : virtual public DataIteratorAdapter
+{
+public:
+  /// @brief setup with the given iterator
+  /// @param[in] iter shared pointer to iterator to be wrapped
+  /// @param[in] interval maximum time span of the bin in seconds (0 means no averaging
+  /// in time, negative value means no limit other than the smearing limit, if set)
+  /// @param[in] nChanAvg number of adjacent channels to average (1 means no averaging
+  /// in frequency)
+  AveragingIteratorAdapter(const boost::shared_ptr<IConstDataIterator> &iter,
+                           double interval, casa::uInt nChanAvg);
+
+  /// @brief limit the bins to keep the smearing below the tolerance
+  /// @details The limits are derived for the longest baseline and the highest frequency
+  /// of the first chunk: the phase change across the bin at the edge of the field should not
+  /// reduce the amplitude by more than the given fraction (for a boxcar average the loss is
+  /// approximately phase^2/24). The rotation of the Earth is used to estimate the
+  /// rate of phase change in time. The limits replace the bins given in the constructor if
+  /// they are smaller. They are computed at the start of the first pass.
+  /// @param[in] fieldRadius largest angular distance from the tangent point to be imaged (in radians)
+  /// @param[in] tolerance acceptable fractional amplitude loss (e.g. 0.01)
+  void setSmearingLimit(double fieldRadius, double tolerance);
+
+  /// @brief configure caching of the uvw machines
+  /// @details The output accessor rotates uvw itself (see UVWRotationHandler), these
+  /// parameters have the same meaning as those of the data source
+  /// @param[in] cacheSize a number of uvw machines in the cache (default is 1)
+  /// @param[in] tolerance pointing direction tolerance in radians, exceeding which leads
+  /// to initialisation of a new UVW Machine
+  void configureUVWMachineCache(size_t cacheSize, double tolerance);
+
+  /// @brief set the tolerance for changes of the pointing direction within the bin
+  /// @details A chunk is only added to the current bin if the pointing direction of each
+  /// baseline already present in the bin has moved by no more than the given angle
+  /// (default is 1e-6 radians).
+  /// @param[in] tolerance maximum angular separation in radians
+  void setPointingTolerance(double tolerance);
+
+  /// @brief restart the iteration from the beginning
+  virtual void init();
+
+  /// operator* delivers a reference to data accessor (current chunk)
+  /// @return a reference to the current chunk
+  virtual IDataAccessor& operator*() const;
+
+  /// Checks whether there are more data available.
+  /// @return True if there are more data available
+  virtual casa::Bool hasMore() const throw();
+
+  /// advance the iterator one step further
+  /// @return True if there are more data (so constructions like
+  ///         while(it.next()) {} are possible)
+  virtual casa::Bool next();
+
+  /// @brief switch the output of operator* to one of the buffers
+  /// @details Buffers are not supported by this adapter, an exception is thrown
+  /// @param[in] bufferID  the name of the buffer to choose
+  virtual void chooseBuffer(const std::string &bufferID);
+
+  /// @brief switch the output of operator* to the original state
+  /// @details This adapter always delivers the averaged visibilities, so nothing is done
+  virtual void chooseOriginal();
+
+  /// @brief return any associated buffer for read/write access
+  /// @details Buffers are not supported by this adapter, an exception is thrown
+  /// @param[in] bufferID the name of the buffer requested
+  /// @return a reference to writable data accessor to the buffer requested
+  virtual IDataAccessor& buffer(const std::string &bufferID) const;
+
+  /// @return maximum time span of the bin in seconds after the smearing limit is applied
+  /// @note the result is only final after the first chunk has been read
+  inline double interval() const { return itsInterval; }
+
+  /// @return number of channels averaged after the smearing limit is applied
+  /// @note the result is only final after the first chunk has been read
+  inline casa::uInt nChanAvg() const { return itsNChanAvg; }
+
+private:
+  /// @brief averaged chunk
+  class Chunk;
+
+  /// @brief accumulated sums for one baseline
+  struct Row {
+    /// @brief first antenna
+    casa::uInt itsAntenna1;
+    /// @brief second antenna
+    casa::uInt itsAntenna2;
+    /// @brief first feed
+    casa::uInt itsFeed1;
+    /// @brief second feed
+    casa::uInt itsFeed2;
+    /// @brief position angle of the first feed for the first sample
+    casa::Float itsFeed1PA;
+    /// @brief position angle of the second feed for the first sample
+    casa::Float itsFeed2PA;
+    /// @brief pointing direction of the first antenna/feed for the first sample
+    casa::MVDirection itsPointingDir1;
+    /// @brief pointing direction of the second antenna/feed for the first sample
+    casa::MVDirection itsPointingDir2;
+    /// @brief pointing direction of the centre of the first antenna for the first sample
+    casa::MVDirection itsDishPointing1;
+    /// @brief pointing direction of the centre of the second antenna for the first sample
+    casa::MVDirection itsDishPointing2;
+    /// @brief sum of uvw over samples
+    casa::RigidVector<casa::Double, 3> itsUVWSum;
+    /// @brief number of samples
+    casa::uInt itsNSamples;
+    /// @brief weighted sums of visibilities (output channel x polarisation, polarisation varies fastest)
+    std::vector<casa::Complex> itsVisSum;
+    /// @brief sums of weights (same layout as itsVisSum)
+    std::vector<casa::Float> itsWeightSum;
+  };
+
+  /// @brief antenna and feed indices identifying the row
+  typedef std::pair<std::pair<casa::uInt, casa::uInt>, std::pair<casa::uInt, casa::uInt> > BaselineKey;
+
+  /// @brief read the chunks of the wrapped iterator which belong to the next bin
+  /// @details The current chunk is empty after this call if there are no more data
+  void accumulate();
+
+  /// @brief check whether the given accessor can be added to the current bin
+  /// @param[in] acc accessor of the wrapped iterator
+  /// @return true, if the accessor can be added
+  bool fitsBin(const IConstDataAccessor &acc) const;
+
+  /// @brief add the given accessor to the current bin
+  /// @param[in] acc accessor of the wrapped iterator
+  void add(const IConstDataAccessor &acc);
+
+  /// @brief form the current chunk from the accumulated sums
+  void finishBin();
+
+  /// @brief compute the smearing limits for the given accessor and apply them
+  /// @param[in] acc first accessor of the wrapped iterator
+  void applySmearingLimit(const IConstDataAccessor &acc);
+
+  /// @brief maximum time span of the bin in seconds
+  double itsInterval;
+
+  /// @brief number of channels averaged
+  casa::uInt itsNChanAvg;
+
+  /// @brief largest angular distance from the tangent point (negative if no smearing limit is set)
+  double itsFieldRadius;
+
+  /// @brief acceptable fractional amplitude loss due to smearing
+  double itsSmearingTolerance;
+
+  /// @brief true if the smearing limit has been applied
+  bool itsLimitApplied;
+
+  /// @brief size of the uvw machine cache for the output chunks
+  size_t itsUVWCacheSize;
+
+  /// @brief tolerance of the uvw machine cache for the output chunks
+  double itsUVWCacheTolerance;
+
+  /// @brief maximum change of the pointing direction within the bin (in radians)
+  double itsPointingTolerance;
+
+  /// @brief rows of the current bin in the order of their first appearance
+  std::vector<Row> itsRows;
+
+  /// @brief index into itsRows for each baseline of the current bin
+  std::map<BaselineKey, size_t> itsRowIndices;
+
+  /// @brief number of chunks in the current bin
+  casa::uInt itsNChunks;
+
+  /// @brief time of the first chunk of the current bin
+  double itsStartTime;
+
+  /// @brief sum of times of the chunks of the current bin
+  double itsTimeSum;
+
+  /// @brief input frequencies of the current bin
+  casa::Vector<casa::Double> itsFrequencies;
+
+  /// @brief polarisation products of the current bin
+  casa::Vector<casa::Stokes::StokesTypes> itsStokes;
+
+  /// @brief current chunk (empty if there are no more data)
+  boost::shared_ptr<Chunk> itsCurrent;
+
+  /// @brief number of input chunks read in this pass
+  size_t itsNInputChunks;
+
+  /// @brief number of output chunks formed in this pass
+  size_t itsNOutputChunks;
+};
+
+} // namespace accessors
+
+} // namespace askap
+
+#endif // #ifndef ASKAP_ACCESSORS_AVERAGING_ITERATOR_ADAPTER_H
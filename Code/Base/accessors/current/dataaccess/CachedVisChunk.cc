@@ -0,0 +1,539 @@
+/// @file
+/// @brief compact in-memory copy of one accessor chunk
+/// @details This class is a part of the visibility cache used to avoid re-reading the
+/// measurement set in every major cycle. It captures the selected and converted data of
+/// one iteration (visibilities, flags, noise and the basic metadata) at construction and
+/// acts as a read-write accessor afterwards. Flags are bit-packed and the noise is stored
+/// as a single number if it is the same for all visibilities, which is the usual case.
+/// Derived quantities which are expensive to compute (rotated uvw and delays, parallactic
+/// angles, etc) are recorded when they are requested from the accessor during the first pass.
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author agent <agent@local>
+///
+
+#include <dataaccess/CachedVisChunk.h>
+#include <dataaccess/DataAccessError.h>
+#include <askap/AskapError.h>
+
+// std includes
+#include <algorithm>
+
+namespace askap {
+
+namespace accessors {
+
+/// @brief number of flags packed into one element of the packed flag vector
+static const size_t theFlagsPerWord = sizeof(casa::uInt) * 8;
+
+/// @brief tolerance (in radians) used to match directions of the recorded rotations
+static const double theDirectionTolerance = 1e-9;
+
+/// @brief capture the given accessor
+/// @details The accessor is also set as the original (see setOriginal), so the lazy fields
+/// can be recorded until setOriginal(0) is called.
+/// @param[in] acc accessor to copy the data from
+CachedVisChunk::CachedVisChunk(const IConstDataAccessor &acc) : itsNRow(acc.nRow()),
+       itsNChannel(acc.nChannel()), itsNPol(acc.nPol()), itsVisibility(acc.visibility().copy()),
+       itsUVW(acc.uvw().copy()), itsAntenna1(acc.antenna1().copy()), itsAntenna2(acc.antenna2().copy()),
+       itsFeed1(acc.feed1().copy()), itsFeed2(acc.feed2().copy()), itsPointingDir1(acc.pointingDir1().copy()),
+       itsTime(acc.time()), itsFrequency(acc.frequency().copy()), itsStokes(acc.stokes().copy()),
+       itsOriginal(&acc), itsFeed1PARecorded(false), itsFeed2PARecorded(false),
+       itsPointingDir2Recorded(false), itsDishPointing1Recorded(false), itsDishPointing2Recorded(false),
+       itsVelocityRecorded(false), itsMemoryUsed(0)
+{
+  // pack flags, the order of elements is that of the cube storage
+  const casa::Cube<casa::Bool> &flags = acc.flag();
+  ASKAPDEBUGASSERT(flags.shape() == itsVisibility.shape());
+  itsPackedFlags.resize((flags.nelements() + theFlagsPerWord - 1) / theFlagsPerWord, 0u);
+  size_t index = 0;
+  for (casa::Cube<casa::Bool>::const_iterator ci = flags.begin(); ci != flags.end(); ++ci,++index) {
+       if (*ci) {
+           itsPackedFlags[index / theFlagsPerWord] |= (1u << (index % theFlagsPerWord));
+       }
+  }
+
+  // store noise as a single value if possible
+  const casa::Cube<casa::Complex> &noise = acc.noise();
+  ASKAPDEBUGASSERT(noise.shape() == itsVisibility.shape());
+  bool constNoise = true;
+  if (noise.nelements() > 0) {
+      const casa::Complex firstNoise = *noise.begin();
+      for (casa::Cube<casa::Complex>::const_iterator ci = noise.begin(); ci != noise.end(); ++ci) {
+           if (*ci != firstNoise) {
+               constNoise = false;
+               break;
+           }
+      }
+      if (constNoise) {
+          itsPackedNoise.resize(1);
+          itsPackedNoise[0] = firstNoise;
+      }
+  }
+  if (!constNoise) {
+      itsPackedNoise.resize(noise.nelements());
+      std::copy(noise.begin(), noise.end(), itsPackedNoise.begin());
+  }
+
+  itsMemoryUsed = sizeof(CachedVisChunk) + itsVisibility.nelements() * sizeof(casa::Complex) +
+       itsPackedFlags.size() * sizeof(casa::uInt) + itsPackedNoise.nelements() * sizeof(casa::Complex) +
+       itsUVW.nelements() * sizeof(casa::RigidVector<casa::Double, 3>) +
+       (itsAntenna1.nelements() + itsAntenna2.nelements() + itsFeed1.nelements() +
+        itsFeed2.nelements()) * sizeof(casa::uInt) + itsPointingDir1.nelements() * sizeof(casa::MVDirection) +
+       itsFrequency.nelements() * sizeof(casa::Double) + itsStokes.nelements() * sizeof(casa::Stokes::StokesTypes);
+}
+
+/// @brief set or reset the original accessor
+/// @details The original accessor is used to record fields which are not copied at the
+/// construction. It should be reset (by passing 0) before the original accessor becomes
+/// invalid (i.e. before the iterator advances).
+/// @param[in] acc pointer to the original accessor or 0
+void CachedVisChunk::setOriginal(const IConstDataAccessor *acc)
+{
+  #ifdef _OPENMP
+  boost::lock_guard<boost::mutex> lock(itsMutex);
+  #endif
+  itsOriginal = acc;
+}
+
+/// @brief release unpacked buffers
+/// @details Flags and noise are unpacked on demand. This method releases the unpacked
+/// copies (they are recreated on the next request). Any changes made via rwVisibility
+/// are discarded too, so the original visibilities are delivered again.
+void CachedVisChunk::releaseBuffers()
+{
+  #ifdef _OPENMP
+  boost::lock_guard<boost::mutex> lock(itsMutex);
+  #endif
+  itsFlagBuffer.resize(0,0,0);
+  itsNoiseBuffer.resize(0,0,0);
+  itsRWVisibility.resize(0,0,0);
+}
+
+/// @brief memory used by this chunk
+/// @details Unpacked buffers are not counted as they are released after use.
+/// @return approximate number of bytes used to store the chunk
+size_t CachedVisChunk::memoryUsed() const
+{
+  #ifdef _OPENMP
+  boost::lock_guard<boost::mutex> lock(itsMutex);
+  #endif
+  return itsMemoryUsed;
+}
+
+/// @brief check whether the visibilities have been requested for writing
+/// @return true, if rwVisibility has been called since the construction or the last releaseBuffers
+bool CachedVisChunk::visibilityChanged() const
+{
+  #ifdef _OPENMP
+  boost::lock_guard<boost::mutex> lock(itsMutex);
+  #endif
+  return itsRWVisibility.nelements() > 0;
+}
+
+/// @brief check whether rotated uvw are available for the given tangent point
+/// @param[in] tangentPoint tangent point
+/// @return true, if rotatedUVW doesn't need to compute or record anything for this tangent point
+bool CachedVisChunk::rotatedUVWRecorded(const casa::MDirection &tangentPoint) const
+{
+  #ifdef _OPENMP
+  boost::lock_guard<boost::mutex> lock(itsMutex);
+  #endif
+  for (std::list<std::pair<casa::MDirection, casa::Vector<casa::RigidVector<casa::Double, 3> > > >::const_iterator ci =
+       itsRotatedUVWs.begin(); ci != itsRotatedUVWs.end(); ++ci) {
+       if (UVWMachineCache::compare(ci->first, tangentPoint, theDirectionTolerance)) {
+           return true;
+       }
+  }
+  return false;
+}
+
+/// @brief check whether delays are available for the given pair of directions
+/// @param[in] tangentPoint tangent point
+/// @param[in] imageCentre image centre
+/// @return true, if uvwRotationDelay doesn't need to compute or record anything for these directions
+bool CachedVisChunk::uvwRotationDelayRecorded(const casa::MDirection &tangentPoint,
+                                              const casa::MDirection &imageCentre) const
+{
+  #ifdef _OPENMP
+  boost::lock_guard<boost::mutex> lock(itsMutex);
+  #endif
+  for (std::list<std::pair<std::pair<casa::MDirection, casa::MDirection>, casa::Vector<casa::Double> > >::const_iterator ci =
+       itsDelays.begin(); ci != itsDelays.end(); ++ci) {
+       if (UVWMachineCache::compare(ci->first.first, tangentPoint, theDirectionTolerance) &&
+           UVWMachineCache::compare(ci->first.second, imageCentre, theDirectionTolerance)) {
+           return true;
+       }
+  }
+  return false;
+}
+
+/// @brief make a copy of the direction which doesn't share the reference frame with the original
+/// @param[in] dir input direction
+/// @return new direction
+static casa::MDirection freshCopy(const casa::MDirection &dir)
+{
+  return casa::MDirection(dir.getValue(), casa::MDirection::castType(dir.getRef().getType()));
+}
+
+/// @brief directions used for uvw rotation so far
+/// @details This method returns fresh copies of the tangent points requested via rotatedUVW and
+/// of the direction pairs requested via uvwRotationDelay. Copies don't share the reference frame
+/// with the directions stored in the chunk, so they can be passed to another thread.
+/// @param[out] tangentPoints tangent points requested via rotatedUVW
+/// @param[out] delayDirections pairs of tangent point and image centre requested via uvwRotationDelay
+void CachedVisChunk::rotationDirections(std::vector<casa::MDirection> &tangentPoints,
+         std::vector<std::pair<casa::MDirection, casa::MDirection> > &delayDirections) const
+{
+  #ifdef _OPENMP
+  boost::lock_guard<boost::mutex> lock(itsMutex);
+  #endif
+  tangentPoints.clear();
+  delayDirections.clear();
+  for (std::list<std::pair<casa::MDirection, casa::Vector<casa::RigidVector<casa::Double, 3> > > >::const_iterator ci =
+       itsRotatedUVWs.begin(); ci != itsRotatedUVWs.end(); ++ci) {
+       tangentPoints.push_back(freshCopy(ci->first));
+  }
+  for (std::list<std::pair<std::pair<casa::MDirection, casa::MDirection>, casa::Vector<casa::Double> > >::const_iterator ci =
+       itsDelays.begin(); ci != itsDelays.end(); ++ci) {
+       delayDirections.push_back(std::make_pair(freshCopy(ci->first.first), freshCopy(ci->first.second)));
+  }
+}
+
+/// @brief update the memory estimate after recording a field
+/// @param[in] field field just recorded
+template<typename T>
+void CachedVisChunk::account(const casa::Vector<T> &field) const
+{
+  itsMemoryUsed += field.nelements() * sizeof(T);
+}
+
+/// @brief helper method to record a lazy vector field
+/// @details The field is copied from the original accessor if it hasn't been recorded
+/// yet. An exception is thrown if it is not possible. This method should be called
+/// under the lock.
+/// @param[in] field buffer for the field
+/// @param[in] recorded flag showing whether the field has been recorded
+/// @param[in] getter accessor method returning the field
+/// @param[in] name name of the field (for the error message)
+/// @return const reference to the field
+template<typename T>
+const casa::Vector<T>& CachedVisChunk::lazyField(casa::Vector<T> &field, bool &recorded,
+           const casa::Vector<T>& (IConstDataAccessor::*getter)() const, const char *name) const
+{
+  if (!recorded) {
+      if (itsOriginal == 0) {
+          ASKAPTHROW(DataAccessError, "Field "<<name<<
+                     " has not been requested during the first pass and is not available in the visibility cache");
+      }
+      field.assign((itsOriginal->*getter)().copy());
+      recorded = true;
+      account(field);
+  }
+  return field;
+}
+
+/// The number of rows in this chunk
+/// @return the number of rows in this chunk
+casa::uInt CachedVisChunk::nRow() const throw()
+{
+  return itsNRow;
+}
+
+/// The number of spectral channels (equal for all rows)
+/// @return the number of spectral channels
+casa::uInt CachedVisChunk::nChannel() const throw()
+{
+  return itsNChannel;
+}
+
+/// The number of polarization products (equal for all rows)
+/// @return the number of polarization products (can be 1,2 or 4)
+casa::uInt CachedVisChunk::nPol() const throw()
+{
+  return itsNPol;
+}
+
+/// First antenna IDs for all rows
+/// @return a vector with IDs of the first antenna corresponding
+/// to each visibility (one for each row)
+const casa::Vector<casa::uInt>& CachedVisChunk::antenna1() const
+{
+  return itsAntenna1;
+}
+
+/// Second antenna IDs for all rows
+/// @return a vector with IDs of the second antenna corresponding
+/// to each visibility (one for each row)
+const casa::Vector<casa::uInt>& CachedVisChunk::antenna2() const
+{
+  return itsAntenna2;
+}
+
+/// First feed IDs for all rows
+/// @return a vector with IDs of the first feed corresponding
+/// to each visibility (one for each row)
+const casa::Vector<casa::uInt>& CachedVisChunk::feed1() const
+{
+  return itsFeed1;
+}
+
+/// Second feed IDs for all rows
+/// @return a vector with IDs of the second feed corresponding
+/// to each visibility (one for each row)
+const casa::Vector<casa::uInt>& CachedVisChunk::feed2() const
+{
+  return itsFeed2;
+}
+
+/// Position angles of the first feed for all rows
+/// @return a vector with position angles (in radians) of the
+/// first feed corresponding to each visibility
+const casa::Vector<casa::Float>& CachedVisChunk::feed1PA() const
+{
+  #ifdef _OPENMP
+  boost::lock_guard<boost::mutex> lock(itsMutex);
+  #endif
+  return lazyField(itsFeed1PA, itsFeed1PARecorded, &IConstDataAccessor::feed1PA, "feed1PA");
+}
+
+/// Position angles of the second feed for all rows
+/// @return a vector with position angles (in radians) of the
+/// second feed corresponding to each visibility
+const casa::Vector<casa::Float>& CachedVisChunk::feed2PA() const
+{
+  #ifdef _OPENMP
+  boost::lock_guard<boost::mutex> lock(itsMutex);
+  #endif
+  return lazyField(itsFeed2PA, itsFeed2PARecorded, &IConstDataAccessor::feed2PA, "feed2PA");
+}
+
+/// Return pointing centre directions of the first antenna/feed
+/// @return a vector with direction measures (coordinate system
+/// is set via IDataConverter), one direction for each
+/// visibility/row
+const casa::Vector<casa::MVDirection>& CachedVisChunk::pointingDir1() const
+{
+  return itsPointingDir1;
+}
+
+/// Pointing centre directions of the second antenna/feed
+/// @return a vector with direction measures (coordinate system
+/// is is set via IDataConverter), one direction for each
+/// visibility/row
+const casa::Vector<casa::MVDirection>& CachedVisChunk::pointingDir2() const
+{
+  #ifdef _OPENMP
+  boost::lock_guard<boost::mutex> lock(itsMutex);
+  #endif
+  return lazyField(itsPointingDir2, itsPointingDir2Recorded, &IConstDataAccessor::pointingDir2, "pointingDir2");
+}
+
+/// pointing direction for the centre of the first antenna
+/// @return a vector with direction measures (coordinate system
+/// is is set via IDataConverter), one direction for each
+/// visibility/row
+const casa::Vector<casa::MVDirection>& CachedVisChunk::dishPointing1() const
+{
+  #ifdef _OPENMP
+  boost::lock_guard<boost::mutex> lock(itsMutex);
+  #endif
+  return lazyField(itsDishPointing1, itsDishPointing1Recorded, &IConstDataAccessor::dishPointing1, "dishPointing1");
+}
+
+/// pointing direction for the centre of the first antenna
+/// @return a vector with direction measures (coordinate system
+/// is is set via IDataConverter), one direction for each
+/// visibility/row
+const casa::Vector<casa::MVDirection>& CachedVisChunk::dishPointing2() const
+{
+  #ifdef _OPENMP
+  boost::lock_guard<boost::mutex> lock(itsMutex);
+  #endif
+  return lazyField(itsDishPointing2, itsDishPointing2Recorded, &IConstDataAccessor::dishPointing2, "dishPointing2");
+}
+
+/// Visibilities (a cube is nRow x nChannel x nPol; each element is
+/// a complex visibility)
+/// @return a reference to nRow x nChannel x nPol cube, containing
+/// all visibility data
+const casa::Cube<casa::Complex>& CachedVisChunk::visibility() const
+{
+  return itsRWVisibility.nelements() > 0 ? itsRWVisibility : itsVisibility;
+}
+
+/// Read-write access to visibilities (a cube is nRow x nChannel x nPol;
+/// each element is a complex visibility)
+/// @details The cached visibilities are not changed, the first call makes
+/// a private copy which lives until releaseBuffers is called.
+/// @return a reference to nRow x nChannel x nPol cube, containing
+/// all visibility data
+casa::Cube<casa::Complex>& CachedVisChunk::rwVisibility()
+{
+  #ifdef _OPENMP
+  boost::lock_guard<boost::mutex> lock(itsMutex);
+  #endif
+  if (itsRWVisibility.nelements() != itsVisibility.nelements()) {
+      itsRWVisibility.assign(itsVisibility.copy());
+  }
+  return itsRWVisibility;
+}
+
+/// Cube of flags corresponding to the output of visibility()
+/// @return a reference to nRow x nChannel x nPol cube with flag
+///         information. If True, the corresponding element is flagged.
+const casa::Cube<casa::Bool>& CachedVisChunk::flag() const
+{
+  #ifdef _OPENMP
+  boost::lock_guard<boost::mutex> lock(itsMutex);
+  #endif
+  if (itsFlagBuffer.nelements() != itsVisibility.nelements()) {
+      itsFlagBuffer.resize(itsVisibility.shape());
+      size_t index = 0;
+      for (casa::Cube<casa::Bool>::iterator it = itsFlagBuffer.begin(); it != itsFlagBuffer.end(); ++it,++index) {
+           *it = (itsPackedFlags[index / theFlagsPerWord] & (1u << (index % theFlagsPerWord))) != 0;
+      }
+  }
+  return itsFlagBuffer;
+}
+
+/// UVW
+/// @return a reference to vector containing uvw-coordinates
+/// packed into a 3-D rigid vector
+const casa::Vector<casa::RigidVector<casa::Double, 3> >& CachedVisChunk::uvw() const
+{
+  return itsUVW;
+}
+
+/// @brief uvw after rotation
+/// @details This method calls UVWMachine to rotate baseline coordinates
+/// for a new tangent point, unless the result has been recorded for this tangent point.
+/// @param[in] tangentPoint tangent point to rotate the coordinates to
+/// @return uvw after rotation to the new coordinate system for each row
+const casa::Vector<casa::RigidVector<casa::Double, 3> >&
+CachedVisChunk::rotatedUVW(const casa::MDirection &tangentPoint) const
+{
+  #ifdef _OPENMP
+  boost::lock_guard<boost::mutex> lock(itsMutex);
+  #endif
+  for (std::list<std::pair<casa::MDirection, casa::Vector<casa::RigidVector<casa::Double, 3> > > >::const_iterator ci =
+       itsRotatedUVWs.begin(); ci != itsRotatedUVWs.end(); ++ci) {
+       if (UVWMachineCache::compare(ci->first, tangentPoint, theDirectionTolerance)) {
+           return ci->second;
+       }
+  }
+  // this element has not been seen before, get it from the original accessor (first pass)
+  // or compute from cached uvws (replay)
+  const casa::Vector<casa::RigidVector<casa::Double, 3> > &result = itsOriginal != 0 ?
+        itsOriginal->rotatedUVW(tangentPoint) : itsRotationHandler.uvw(*this, tangentPoint);
+  itsRotatedUVWs.push_back(std::make_pair(tangentPoint, result.copy()));
+  account(itsRotatedUVWs.back().second);
+  return itsRotatedUVWs.back().second;
+}
+
+/// @brief delay associated with uvw rotation
+/// @details This is a companion method to rotatedUVW. It returns delays corresponding
+/// to the baseline coordinate rotation, computing them only if they have not been
+/// recorded for this pair of directions.
+/// @param[in] tangentPoint tangent point to rotate the coordinates to
+/// @param[in] imageCentre image centre (additional translation is done if imageCentre!=tangentPoint)
+/// @return delays corresponding to the uvw rotation for each row
+const casa::Vector<casa::Double>& CachedVisChunk::uvwRotationDelay(
+         const casa::MDirection &tangentPoint, const casa::MDirection &imageCentre) const
+{
+  #ifdef _OPENMP
+  boost::lock_guard<boost::mutex> lock(itsMutex);
+  #endif
+  for (std::list<std::pair<std::pair<casa::MDirection, casa::MDirection>, casa::Vector<casa::Double> > >::const_iterator ci =
+       itsDelays.begin(); ci != itsDelays.end(); ++ci) {
+       if (UVWMachineCache::compare(ci->first.first, tangentPoint, theDirectionTolerance) &&
+           UVWMachineCache::compare(ci->first.second, imageCentre, theDirectionTolerance)) {
+           return ci->second;
+       }
+  }
+  const casa::Vector<casa::Double> &result = itsOriginal != 0 ?
+        itsOriginal->uvwRotationDelay(tangentPoint, imageCentre) :
+        itsRotationHandler.delays(*this, tangentPoint, imageCentre);
+  itsDelays.push_back(std::make_pair(std::make_pair(tangentPoint, imageCentre), result.copy()));
+  account(itsDelays.back().second);
+  return itsDelays.back().second;
+}
+
+/// Noise level required for a proper weighting
+/// @return a reference to nRow x nChannel x nPol cube with
+///         complex noise estimates
+const casa::Cube<casa::Complex>& CachedVisChunk::noise() const
+{
+  #ifdef _OPENMP
+  boost::lock_guard<boost::mutex> lock(itsMutex);
+  #endif
+  if (itsNoiseBuffer.nelements() != itsVisibility.nelements()) {
+      itsNoiseBuffer.resize(itsVisibility.shape());
+      if (itsPackedNoise.nelements() == 1) {
+          itsNoiseBuffer.set(itsPackedNoise[0]);
+      } else {
+          ASKAPDEBUGASSERT(itsPackedNoise.nelements() == itsNoiseBuffer.nelements());
+          std::copy(itsPackedNoise.begin(), itsPackedNoise.end(), itsNoiseBuffer.begin());
+      }
+  }
+  return itsNoiseBuffer;
+}
+
+/// Timestamp for each row
+/// @return a timestamp for this buffer
+casa::Double CachedVisChunk::time() const
+{
+  return itsTime;
+}
+
+/// Frequency for each channel
+/// @return a reference to vector containing frequencies for each
+///         spectral channel (vector size is nChannel)
+const casa::Vector<casa::Double>& CachedVisChunk::frequency() const
+{
+  return itsFrequency;
+}
+
+/// Velocity for each channel
+/// @return a reference to vector containing velocities for each
+///         spectral channel (vector size is nChannel)
+const casa::Vector<casa::Double>& CachedVisChunk::velocity() const
+{
+  #ifdef _OPENMP
+  boost::lock_guard<boost::mutex> lock(itsMutex);
+  #endif
+  return lazyField(itsVelocity, itsVelocityRecorded, &IConstDataAccessor::velocity, "velocity");
+}
+
+/// @brief polarisation type for each product
+/// @return a reference to vector containing polarisation types for
+/// each product in the visibility cube (nPol() elements).
+const casa::Vector<casa::Stokes::StokesTypes>& CachedVisChunk::stokes() const
+{
+  return itsStokes;
+}
+
+} // namespace accessors
+
+} // namespace askap
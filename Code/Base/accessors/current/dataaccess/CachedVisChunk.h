@@ -0,0 +1,392 @@
+/// @file
+/// @brief compact in-memory copy of one accessor chunk
+/// @details This class is a part of the visibility cache used to avoid re-reading the
+/// measurement set in every major cycle. It captures the selected and converted data of
+/// one iteration (visibilities, flags, noise and the basic metadata) at construction and
+/// acts as a read-write accessor afterwards. Flags are bit-packed and the noise is stored
+/// as a single number if it is the same for all visibilities, which is the usual case.
+/// Derived quantities which are expensive to compute (rotated uvw and delays, parallactic
+/// angles, etc) are recorded when they are requested from the accessor during the first pass.
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author agent <agent@local>
+///
+
+#ifndef ASKAP_ACCESSORS_CACHED_VIS_CHUNK_H
+#define ASKAP_ACCESSORS_CACHED_VIS_CHUNK_H
+
+// own includes
+#include <dataaccess/IDataAccessor.h>
+#include <dataaccess/UVWRotationHandler.h>
+
+// casa includes
+#include <casa/Arrays/Vector.h>
+#include <casa/Arrays/Cube.h>
+#include <measures/Measures/MDirection.h>
+
+// boost includes
+#include <boost/shared_ptr.hpp>
+
+#ifdef _OPENMP
+//boost include
+#include <boost/thread/mutex.hpp>
+#endif
+
+// std includes
+#include <vector>
+#include <list>
+#include <utility>
+
+namespace askap {
+
+namespace accessors {
+
+/// @brief compact in-memory copy of one accessor chunk
+/// @details Visibilities, flags, noise, uvw, antenna and feed indices, time, frequencies,
+/// polarisation products and pointing directions of the first antenna are copied at the
+/// construction. The remaining fields (parallactic angles, pointing directions of the second
+/// antenna, dish pointings and velocities) as well as rotated uvw and delays are copied
+/// from the original accessor when they are requested for the first time, provided the
+/// original accessor is still available (i.e. setOriginal has been called and
+/// the iterator hasn't been advanced). During the replay, rotated uvw and delays for tangent
+/// points not seen during the first pass are computed from the cached uvw. Other fields which
+/// were not recorded cause an exception, because they can't be obtained without the table.
+/// Flags and the noise cube are unpacked on demand into buffers which can be released to
+/// keep the memory footprint small when the chunk is not in use.
+/// @ingroup dataaccess_hlp
+class CachedVisChunk : virtual public IDataAccessor
+{
+public:
+  /// @brief capture the given accessor
+  /// @details The accessor is also set as the original (see setOriginal), so the lazy fields
+  /// can be recorded until setOriginal(0) is called.
+  /// @param[in] acc accessor to copy the data from
+  explicit CachedVisChunk(const IConstDataAccessor &acc);
+
+  /// @brief set or reset the original accessor
+  /// @details The original accessor is used to record fields which are not copied at the
+  /// construction. It should be reset (by passing 0) before the original accessor becomes
+  /// invalid (i.e. before the iterator advances).
+  /// @param[in] acc pointer to the original accessor or 0
+  void setOriginal(const IConstDataAccessor *acc);
+
+  /// @brief release unpacked buffers
+  /// @details Flags and noise are unpacked on demand. This method releases the unpacked
+  /// copies (they are recreated on the next request). Any changes made via rwVisibility
+  /// are discarded too, so the original visibilities are delivered again.
+  void releaseBuffers();
+
+  /// @brief memory used by this chunk
+  /// @details Unpacked buffers are not counted as they are released after use.
+  /// @return approximate number of bytes used to store the chunk
+  size_t memoryUsed() const;
+
+  /// @brief check whether the visibilities have been requested for writing
+  /// @return true, if rwVisibility has been called since the construction or the last releaseBuffers
+  bool visibilityChanged() const;
+
+  /// @brief check whether rotated uvw are available for the given tangent point
+  /// @param[in] tangentPoint tangent point
+  /// @return true, if rotatedUVW doesn't need to compute or record anything for this tangent point
+  bool rotatedUVWRecorded(const casa::MDirection &tangentPoint) const;
+
+  /// @brief check whether delays are available for the given pair of directions
+  /// @param[in] tangentPoint tangent point
+  /// @param[in] imageCentre image centre
+  /// @return true, if uvwRotationDelay doesn't need to compute or record anything for these directions
+  bool uvwRotationDelayRecorded(const casa::MDirection &tangentPoint, const casa::MDirection &imageCentre) const;
+
+  /// @brief directions used for uvw rotation so far
+  /// @details This method returns fresh copies of the tangent points requested via rotatedUVW and
+  /// of the direction pairs requested via uvwRotationDelay. Copies don't share the reference frame
+  /// with the directions stored in the chunk, so they can be passed to another thread.
+  /// @param[out] tangentPoints tangent points requested via rotatedUVW
+  /// @param[out] delayDirections pairs of tangent point and image centre requested via uvwRotationDelay
+  void rotationDirections(std::vector<casa::MDirection> &tangentPoints,
+           std::vector<std::pair<casa::MDirection, casa::MDirection> > &delayDirections) const;
+
+  // IConstDataAccessor methods
+
+  /// The number of rows in this chunk
+  /// @return the number of rows in this chunk
+  virtual casa::uInt nRow() const throw();
+
+  /// The number of spectral channels (equal for all rows)
+  /// @return the number of spectral channels
+  virtual casa::uInt nChannel() const throw();
+
+  /// The number of polarization products (equal for all rows)
+  /// @return the number of polarization products (can be 1,2 or 4)
+  virtual casa::uInt nPol() const throw();
+
+  /// First antenna IDs for all rows
+  /// @return a vector with IDs of the first antenna corresponding
+  /// to each visibility (one for each row)
+  virtual const casa::Vector<casa::uInt>& antenna1() const;
+
+  /// Second antenna IDs for all rows
+  /// @return a vector with IDs of the second antenna corresponding
+  /// to each visibility (one for each row)
+  virtual const casa::Vector<casa::uInt>& antenna2() const;
+
+  /// First feed IDs for all rows
+  /// @return a vector with IDs of the first feed corresponding
+  /// to each visibility (one for each row)
+  virtual const casa::Vector<casa::uInt>& feed1() const;
+
+  /// Second feed IDs for all rows
+  /// @return a vector with IDs of the second feed corresponding
+  /// to each visibility (one for each row)
+  virtual const casa::Vector<casa::uInt>& feed2() const;
+
+  /// Position angles of the first feed for all rows
+  /// @return a vector with position angles (in radians) of the
+  /// first feed corresponding to each visibility
+  virtual const casa::Vector<casa::Float>& feed1PA() const;
+
+  /// Position angles of the second feed for all rows
+  /// @return a vector with position angles (in radians) of the
+  /// second feed corresponding to each visibility
+  virtual const casa::Vector<casa::Float>& feed2PA() const;
+
+  /// Return pointing centre directions of the first antenna/feed
+  /// @return a vector with direction measures (coordinate system
+  /// is set via IDataConverter), one direction for each
+  /// visibility/row
+  virtual const casa::Vector<casa::MVDirection>& pointingDir1() const;
+
+  /// Pointing centre directions of the second antenna/feed
+  /// @return a vector with direction measures (coordinate system
+  /// is is set via IDataConverter), one direction for each
+  /// visibility/row
+  virtual const casa::Vector<casa::MVDirection>& pointingDir2() const;
+
+  /// pointing direction for the centre of the first antenna
+  /// @return a vector with direction measures (coordinate system
+  /// is is set via IDataConverter), one direction for each
+  /// visibility/row
+  virtual const casa::Vector<casa::MVDirection>& dishPointing1() const;
+
+  /// pointing direction for the centre of the first antenna
+  /// @return a vector with direction measures (coordinate system
+  /// is is set via IDataConverter), one direction for each
+  /// visibility/row
+  virtual const casa::Vector<casa::MVDirection>& dishPointing2() const;
+
+  /// Visibilities (a cube is nRow x nChannel x nPol; each element is
+  /// a complex visibility)
+  /// @return a reference to nRow x nChannel x nPol cube, containing
+  /// all visibility data
+  virtual const casa::Cube<casa::Complex>& visibility() const;
+
+  /// Read-write access to visibilities (a cube is nRow x nChannel x nPol;
+  /// each element is a complex visibility)
+  /// @details The cached visibilities are not changed, the first call makes
+  /// a private copy which lives until releaseBuffers is called.
+  /// @return a reference to nRow x nChannel x nPol cube, containing
+  /// all visibility data
+  virtual casa::Cube<casa::Complex>& rwVisibility();
+
+  /// Cube of flags corresponding to the output of visibility()
+  /// @return a reference to nRow x nChannel x nPol cube with flag
+  ///         information. If True, the corresponding element is flagged.
+  virtual const casa::Cube<casa::Bool>& flag() const;
+
+  /// UVW
+  /// @return a reference to vector containing uvw-coordinates
+  /// packed into a 3-D rigid vector
+  virtual const casa::Vector<casa::RigidVector<casa::Double, 3> >& uvw() const;
+
+  /// @brief uvw after rotation
+  /// @details This method calls UVWMachine to rotate baseline coordinates
+  /// for a new tangent point, unless the result has been recorded for this tangent point.
+  /// @param[in] tangentPoint tangent point to rotate the coordinates to
+  /// @return uvw after rotation to the new coordinate system for each row
+  virtual const casa::Vector<casa::RigidVector<casa::Double, 3> >&
+           rotatedUVW(const casa::MDirection &tangentPoint) const;
+
+  /// @brief delay associated with uvw rotation
+  /// @details This is a companion method to rotatedUVW. It returns delays corresponding
+  /// to the baseline coordinate rotation, computing them only if they have not been
+  /// recorded for this pair of directions.
+  /// @param[in] tangentPoint tangent point to rotate the coordinates to
+  /// @param[in] imageCentre image centre (additional translation is done if imageCentre!=tangentPoint)
+  /// @return delays corresponding to the uvw rotation for each row
+  virtual const casa::Vector<casa::Double>& uvwRotationDelay(
+           const casa::MDirection &tangentPoint, const casa::MDirection &imageCentre) const;
+
+  /// Noise level required for a proper weighting
+  /// @return a reference to nRow x nChannel x nPol cube with
+  ///         complex noise estimates
+  virtual const casa::Cube<casa::Complex>& noise() const;
+
+  /// Timestamp for each row
+  /// @return a timestamp for this buffer
+  virtual casa::Double time() const;
+
+  /// Frequency for each channel
+  /// @return a reference to vector containing frequencies for each
+  ///         spectral channel (vector size is nChannel)
+  virtual const casa::Vector<casa::Double>& frequency() const;
+
+  /// Velocity for each channel
+  /// @return a reference to vector containing velocities for each
+  ///         spectral channel (vector size is nChannel)
+  virtual const casa::Vector<casa::Double>& velocity() const;
+
+  /// @brief polarisation type for each product
+  /// @return a reference to vector containing polarisation types for
+  /// each product in the visibility cube (nPol() elements).
+  virtual const casa::Vector<casa::Stokes::StokesTypes>& stokes() const;
+
+private:
+  /// @brief helper method to record a lazy vector field
+  /// @details The field is copied from the original accessor if it hasn't been recorded
+  /// yet. An exception is thrown if it is not possible. This method should be called
+  /// under the lock.
+  /// @param[in] field buffer for the field
+  /// @param[in] recorded flag showing whether the field has been recorded
+  /// @param[in] getter accessor method returning the field
+  /// @param[in] name name of the field (for the error message)
+  /// @return const reference to the field
+  template<typename T>
+  const casa::Vector<T>& lazyField(casa::Vector<T> &field, bool &recorded,
+           const casa::Vector<T>& (IConstDataAccessor::*getter)() const, const char *name) const;
+
+  /// @brief update the memory estimate after recording a field
+  /// @param[in] field field just recorded
+  template<typename T>
+  void account(const casa::Vector<T> &field) const;
+
+  /// @brief number of rows
+  casa::uInt itsNRow;
+
+  /// @brief number of channels
+  casa::uInt itsNChannel;
+
+  /// @brief number of polarisations
+  casa::uInt itsNPol;
+
+  /// @brief visibilities
+  casa::Cube<casa::Complex> itsVisibility;
+
+  /// @brief bit-packed flags in the same order as the elements of the visibility cube
+  std::vector<casa::uInt> itsPackedFlags;
+
+  /// @brief noise, a single element if the noise is the same for all visibilities
+  casa::Vector<casa::Complex> itsPackedNoise;
+
+  /// @brief uvw
+  casa::Vector<casa::RigidVector<casa::Double, 3> > itsUVW;
+
+  /// @brief first antenna IDs
+  casa::Vector<casa::uInt> itsAntenna1;
+
+  /// @brief second antenna IDs
+  casa::Vector<casa::uInt> itsAntenna2;
+
+  /// @brief first feed IDs
+  casa::Vector<casa::uInt> itsFeed1;
+
+  /// @brief second feed IDs
+  casa::Vector<casa::uInt> itsFeed2;
+
+  /// @brief pointing directions of the first antenna/feed
+  casa::Vector<casa::MVDirection> itsPointingDir1;
+
+  /// @brief time stamp
+  casa::Double itsTime;
+
+  /// @brief frequencies
+  casa::Vector<casa::Double> itsFrequency;
+
+  /// @brief polarisation products
+  casa::Vector<casa::Stokes::StokesTypes> itsStokes;
+
+  /// @brief original accessor used to record lazy fields, 0 if not available
+  const IConstDataAccessor *itsOriginal;
+
+  /// @brief position angles of the first feed (lazy)
+  mutable casa::Vector<casa::Float> itsFeed1PA;
+  /// @brief true if itsFeed1PA has been recorded
+  mutable bool itsFeed1PARecorded;
+
+  /// @brief position angles of the second feed (lazy)
+  mutable casa::Vector<casa::Float> itsFeed2PA;
+  /// @brief true if itsFeed2PA has been recorded
+  mutable bool itsFeed2PARecorded;
+
+  /// @brief pointing directions of the second antenna/feed (lazy)
+  mutable casa::Vector<casa::MVDirection> itsPointingDir2;
+  /// @brief true if itsPointingDir2 has been recorded
+  mutable bool itsPointingDir2Recorded;
+
+  /// @brief dish pointing directions of the first antenna (lazy)
+  mutable casa::Vector<casa::MVDirection> itsDishPointing1;
+  /// @brief true if itsDishPointing1 has been recorded
+  mutable bool itsDishPointing1Recorded;
+
+  /// @brief dish pointing directions of the second antenna (lazy)
+  mutable casa::Vector<casa::MVDirection> itsDishPointing2;
+  /// @brief true if itsDishPointing2 has been recorded
+  mutable bool itsDishPointing2Recorded;
+
+  /// @brief velocities (lazy)
+  mutable casa::Vector<casa::Double> itsVelocity;
+  /// @brief true if itsVelocity has been recorded
+  mutable bool itsVelocityRecorded;
+
+  /// @brief rotated uvw for each tangent point requested so far
+  /// @details std::list is used, because references to the elements stay valid
+  mutable std::list<std::pair<casa::MDirection, casa::Vector<casa::RigidVector<casa::Double, 3> > > > itsRotatedUVWs;
+
+  /// @brief delays for each pair of tangent point and image centre requested so far
+  mutable std::list<std::pair<std::pair<casa::MDirection, casa::MDirection>, casa::Vector<casa::Double> > > itsDelays;
+
+  /// @brief handler used to compute rotations not recorded during the first pass
+  UVWRotationHandler itsRotationHandler;
+
+  /// @brief unpacked flags (empty if not unpacked)
+  mutable casa::Cube<casa::Bool> itsFlagBuffer;
+
+  /// @brief expanded noise (empty if not expanded)
+  mutable casa::Cube<casa::Complex> itsNoiseBuffer;
+
+  /// @brief private copy of visibilities for rwVisibility (empty if not requested)
+  casa::Cube<casa::Complex> itsRWVisibility;
+
+  /// @brief estimate of the memory used (in bytes)
+  mutable size_t itsMemoryUsed;
+
+  #ifdef _OPENMP
+  /// @brief synchronisation lock for lazy operations
+  mutable boost::mutex itsMutex;
+  #endif
+};
+
+} // namespace accessors
+
+} // namespace askap
+
+#endif // #ifndef ASKAP_ACCESSORS_CACHED_VIS_CHUNK_H
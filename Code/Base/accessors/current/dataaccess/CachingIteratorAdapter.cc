@@ -0,0 +1,218 @@
+/// @file
+/// @brief iterator adapter serving data from the visibility cache
+///
+/// @details This adapter is derived from DataIteratorAdapter. During the first
+/// pass of the iteration it captures every accessor of the wrapped iterator into
+/// a VisChunkCache. The following passes (started by init) are served from the
+/// cache without touching the wrapped iterator, unless the memory limit has been
+/// reached. In this case the cached part of the data is served from memory and
+/// the rest is read through the wrapped iterator.
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author agent <agent@local>
+///
+
+#include <dataaccess/CachingIteratorAdapter.h>
+#include <dataaccess/DataAccessError.h>
+#include <askap/AskapError.h>
+
+namespace askap {
+
+namespace accessors {
+
+/// @brief setup with the given iterator and cache
+/// @param[in] iter shared pointer to iterator to be wrapped
+/// @param[in] cache shared pointer to the cache for the selection of this iterator
+CachingIteratorAdapter::CachingIteratorAdapter(const boost::shared_ptr<IConstDataIterator> &iter,
+                         const VisChunkCache::ShPtr &cache) : DataIteratorAdapter(iter), itsCache(cache),
+                         itsPosition(0), itsRecording(false), itsDirect(true)
+{
+  ASKAPCHECK(iter, "An attempt to initialise CachingIteratorAdapter with empty shared pointer");
+  ASKAPCHECK(cache, "CachingIteratorAdapter requires a valid visibility cache");
+}
+
+/// @brief restart the iteration from the beginning
+/// @details The first call starts filling the cache, the following calls
+/// start the replay (if the cache has been filled).
+void CachingIteratorAdapter::init()
+{
+  releaseCurrent();
+  itsPosition = 0;
+  itsRecording = false;
+  itsDirect = false;
+  if (!itsCache->isFilled()) {
+      // the previous pass (if any) could have been interrupted, start from scratch
+      itsCache->clear();
+      itsRecording = true;
+      DataIteratorAdapter::init();
+      record();
+  } else if (itsCache->nChunks() > 0) {
+      itsCurrent = itsCache->chunk(0);
+  } else {
+      // nothing has been cached (e.g. too small memory limit)
+      startDirect();
+  }
+}
+
+/// operator* delivers a reference to data accessor (current chunk)
+/// @return a reference to the current chunk
+IDataAccessor& CachingIteratorAdapter::operator*() const
+{
+  if (itsCurrent) {
+      return *itsCurrent;
+  }
+  return DataIteratorAdapter::operator*();
+}
+
+/// Checks whether there are more data available.
+/// @return True if there are more data available
+casa::Bool CachingIteratorAdapter::hasMore() const throw()
+{
+  if (itsCurrent) {
+      return true;
+  }
+  if (itsRecording || itsDirect) {
+      return DataIteratorAdapter::hasMore();
+  }
+  return false;
+}
+
+/// advance the iterator one step further
+/// @return True if there are more data (so constructions like
+///         while(it.next()) {} are possible)
+casa::Bool CachingIteratorAdapter::next()
+{
+  if (itsRecording) {
+      releaseCurrent();
+      DataIteratorAdapter::next();
+      record();
+  } else if (itsDirect) {
+      DataIteratorAdapter::next();
+      if (DataIteratorAdapter::hasMore()) {
+          if (itsCache->isFilled()) {
+              itsCache->registerMiss();
+          }
+      } else {
+          endOfPass();
+      }
+  } else {
+      releaseCurrent();
+      ++itsPosition;
+      if (itsPosition < itsCache->nChunks()) {
+          itsCurrent = itsCache->chunk(itsPosition);
+      } else {
+          if (itsCache->isTruncated()) {
+              startDirect();
+          }
+          if (!hasMore()) {
+              endOfPass();
+          }
+      }
+  }
+  return hasMore();
+}
+
+/// @brief switch the output of operator* to one of the buffers
+/// @details Buffers are not supported by this adapter, an exception is thrown
+/// @param[in] bufferID  the name of the buffer to choose
+void CachingIteratorAdapter::chooseBuffer(const std::string &bufferID)
+{
+  ASKAPTHROW(DataAccessError, "Buffers are not supported by CachingIteratorAdapter, requested buffer "<<
+             bufferID);
+}
+
+/// @brief switch the output of operator* to the original state
+/// @details This adapter always delivers the original visibilities, so nothing is done
+void CachingIteratorAdapter::chooseOriginal()
+{
+}
+
+/// @brief return any associated buffer for read/write access
+/// @details Buffers are not supported by this adapter, an exception is thrown
+/// @param[in] bufferID the name of the buffer requested
+/// @return a reference to writable data accessor to the buffer requested
+IDataAccessor& CachingIteratorAdapter::buffer(const std::string &bufferID) const
+{
+  ASKAPTHROW(DataAccessError, "Buffers are not supported by CachingIteratorAdapter, requested buffer "<<
+             bufferID);
+}
+
+/// @brief capture the current accessor of the wrapped iterator
+/// @details If the wrapped iterator has no more data, the cache is marked as filled.
+void CachingIteratorAdapter::record()
+{
+  ASKAPDEBUGASSERT(itsRecording);
+  if (DataIteratorAdapter::hasMore()) {
+      // an empty pointer is returned if the memory limit is reached, operator* will use
+      // the wrapped iterator in this case
+      itsCurrent = itsCache->add(*roIterator());
+  } else {
+      itsRecording = false;
+      itsCache->setFilled();
+      endOfPass();
+  }
+}
+
+/// @brief continue with the wrapped iterator after the cached chunks
+/// @details This method is used when the cache is truncated. The wrapped iterator
+/// is restarted and advanced past the chunks available from the cache. The cost of
+/// skipping depends on the wrapped iterator: a bare table-based iterator only steps
+/// through the table (visibilities are not read unless requested), but an averaging
+/// adapter has to read and average all skipped data and a read-ahead adapter reads them in
+/// the background. With such adapters a truncated cache saves the gridding of the cached
+/// chunks, but not the I/O.
+void CachingIteratorAdapter::startDirect()
+{
+  DataIteratorAdapter::init();
+  // see above on the cost of skipping, it is not negligible with averaging or read ahead
+  for (size_t chunk = 0; (chunk < itsCache->nChunks()) && DataIteratorAdapter::hasMore(); ++chunk) {
+       DataIteratorAdapter::next();
+  }
+  itsDirect = true;
+  if (DataIteratorAdapter::hasMore()) {
+      itsCache->registerMiss();
+  }
+}
+
+/// @brief finish work with the current chunk
+void CachingIteratorAdapter::releaseCurrent()
+{
+  if (itsCurrent) {
+      itsCurrent->setOriginal(0);
+      itsCurrent->releaseBuffers();
+      itsCurrent.reset();
+  }
+}
+
+/// @brief log statistics at the end of the pass
+void CachingIteratorAdapter::endOfPass()
+{
+  if (itsCache->isFilled()) {
+      itsCache->logStatistics();
+  }
+}
+
+} // namespace accessors
+
+} // namespace askap
@@ -0,0 +1,141 @@
+/// @file
+/// @brief iterator adapter serving data from the visibility cache
+///
+/// @details This adapter is derived from DataIteratorAdapter. During the first
+/// pass of the iteration it captures every accessor of the wrapped iterator into
+/// a VisChunkCache. The following passes (started by init) are served from the
+/// cache without touching the wrapped iterator, unless the memory limit has been
+/// reached. In this case the cached part of the data is served from memory and
+/// the rest is read through the wrapped iterator.
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author agent <agent@local>
+///
+
+#ifndef ASKAP_ACCESSORS_CACHING_ITERATOR_ADAPTER_H
+#define ASKAP_ACCESSORS_CACHING_ITERATOR_ADAPTER_H
+
+#include <dataaccess/DataIteratorAdapter.h>
+#include <dataaccess/VisChunkCache.h>
+#include <dataaccess/CachedVisChunk.h>
+
+namespace askap {
+
+namespace accessors {
+
+/// @brief iterator adapter serving data from the visibility cache
+/// @details The cache is filled when the iteration is started with init and the
+/// cache has not been filled yet. Until init is called for the first time, the adapter
+/// just passes everything through to the wrapped iterator. The cache is shared, so
+/// it can outlive this adapter and be used with a new adapter for the same selection.
+/// Accessors returned by this adapter are writeable, but the changes are not propagated
+/// to the wrapped iterator and are discarded when the adapter advances. Buffers are not
+/// supported.
+/// @ingroup dataaccess_hlp
+class CachingIteratorAdapter : virtual public DataIteratorAdapter
+{
+public:
+  /// @brief setup with the given iterator and cache
+  /// @param[in] iter shared pointer to iterator to be wrapped
+  /// @param[in] cache shared pointer to the cache for the selection of this iterator
+  CachingIteratorAdapter(const boost::shared_ptr<IConstDataIterator> &iter,
+                         const VisChunkCache::ShPtr &cache);
+
+  /// @brief restart the iteration from the beginning
+  /// @details The first call starts filling the cache, the following calls
+  /// start the replay (if the cache has been filled).
+  virtual void init();
+
+  /// operator* delivers a reference to data accessor (current chunk)
+  /// @return a reference to the current chunk
+  virtual IDataAccessor& operator*() const;
+
+  /// Checks whether there are more data available.
+  /// @return True if there are more data available
+  virtual casa::Bool hasMore() const throw();
+
+  /// advance the iterator one step further
+  /// @return True if there are more data (so constructions like
+  ///         while(it.next()) {} are possible)
+  virtual casa::Bool next();
+
+  /// @brief switch the output of operator* to one of the buffers
+  /// @details Buffers are not supported by this adapter, an exception is thrown
+  /// @param[in] bufferID  the name of the buffer to choose
+  virtual void chooseBuffer(const std::string &bufferID);
+
+  /// @brief switch the output of operator* to the original state
+  /// @details This adapter always delivers the original visibilities, so nothing is done
+  virtual void chooseOriginal();
+
+  /// @brief return any associated buffer for read/write access
+  /// @details Buffers are not supported by this adapter, an exception is thrown
+  /// @param[in] bufferID the name of the buffer requested
+  /// @return a reference to writable data accessor to the buffer requested
+  virtual IDataAccessor& buffer(const std::string &bufferID) const;
+
+private:
+  /// @brief capture the current accessor of the wrapped iterator
+  /// @details If the wrapped iterator has no more data, the cache is marked as filled.
+  void record();
+
+  /// @brief continue with the wrapped iterator after the cached chunks
+  /// @details This method is used when the cache is truncated. The wrapped iterator
+  /// is restarted and advanced past the chunks available from the cache. The cost of
+  /// skipping depends on the wrapped iterator: a bare table-based iterator only steps
+  /// through the table (visibilities are not read unless requested), but an averaging
+  /// adapter has to read and average all skipped data and a read-ahead adapter reads them in
+  /// the background. With such adapters a truncated cache saves the gridding of the cached
+  /// chunks, but not the I/O.
+  void startDirect();
+
+  /// @brief finish work with the current chunk
+  void releaseCurrent();
+
+  /// @brief log statistics at the end of the pass
+  void endOfPass();
+
+  /// @brief the cache
+  VisChunkCache::ShPtr itsCache;
+
+  /// @brief current chunk (empty if the data are served by the wrapped iterator)
+  boost::shared_ptr<CachedVisChunk> itsCurrent;
+
+  /// @brief index of the current chunk during the replay
+  size_t itsPosition;
+
+  /// @brief true during the first pass (cache is being filled)
+  bool itsRecording;
+
+  /// @brief true if the data are served by the wrapped iterator outside the first pass
+  /// @details This happens either before init is called for the first time or
+  /// beyond the truncation point of the cache
+  bool itsDirect;
+};
+
+} // namespace accessors
+
+} // namespace askap
+
+#endif // #ifndef ASKAP_ACCESSORS_CACHING_ITERATOR_ADAPTER_H
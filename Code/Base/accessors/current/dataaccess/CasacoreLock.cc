@@ -0,0 +1,76 @@
+/// @file
+/// @brief process-wide lock serialising access to casacore tables and measures
+/// @details Casacore tables (including the table cache shared by all Table objects) and
+/// measures conversions are not thread-safe. Code of this package which may run in a
+/// background thread (e.g. the read ahead) or in several threads of the same process takes
+/// this lock around table access and measures conversions. Other code working with casacore
+/// tables at the same time should take it too.
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author agent <agent@local>
+
+#include <dataaccess/CasacoreLock.h>
+
+namespace askap {
+
+namespace accessors {
+
+/// @brief take the lock
+/// @details The method waits until the lock is released by other threads
+CasacoreLock::CasacoreLock()
+{
+  mutex().lock();
+}
+
+/// @brief release the lock
+CasacoreLock::~CasacoreLock()
+{
+  mutex().unlock();
+}
+
+/// @brief mutex shared by all users of casacore in this process
+/// @details The mutex is created on the first use, which happens before any
+/// background thread of this package is started.
+/// @return reference to the mutex
+boost::recursive_mutex& CasacoreLock::mutex()
+{
+  static boost::recursive_mutex theMutex;
+  return theMutex;
+}
+
+/// @brief open the table under the lock
+/// @details Opening a table involves the table cache shared by all tables of the
+/// process. This helper is handy in the initialisation lists of constructors.
+/// @param[in] name file name of the table
+/// @param[in] option table option
+/// @return table object
+casa::Table CasacoreLock::openTable(const std::string &name, const casa::Table::TableOption option)
+{
+  const CasacoreLock lock;
+  return casa::Table(name, option);
+}
+
+} // namespace accessors
+
+} // namespace askap
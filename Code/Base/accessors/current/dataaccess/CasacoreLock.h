@@ -0,0 +1,81 @@
+/// @file
+/// @brief process-wide lock serialising access to casacore tables and measures
+/// @details Casacore tables (including the table cache shared by all Table objects) and
+/// measures conversions are not thread-safe. Code of this package which may run in a
+/// background thread (e.g. the read ahead) or in several threads of the same process takes
+/// this lock around table access and measures conversions. Other code working with casacore
+/// tables at the same time should take it too.
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author agent <agent@local>
+
+#ifndef ASKAP_ACCESSORS_CASACORE_LOCK_H
+#define ASKAP_ACCESSORS_CASACORE_LOCK_H
+
+// casa includes
+#include <tables/Tables/Table.h>
+
+// boost includes
+#include <boost/thread/recursive_mutex.hpp>
+#include <boost/utility.hpp>
+
+// std includes
+#include <string>
+
+namespace askap {
+
+namespace accessors {
+
+/// @brief process-wide lock serialising access to casacore tables and measures
+/// @details The lock is taken by the constructor and released by the destructor.
+/// The underlying mutex is recursive, so nested locks in the same thread (e.g. a table
+/// opened by a method already holding the lock) are allowed.
+/// @ingroup dataaccess_hlp
+class CasacoreLock : private boost::noncopyable {
+public:
+  /// @brief take the lock
+  /// @details The method waits until the lock is released by other threads
+  CasacoreLock();
+
+  /// @brief release the lock
+  ~CasacoreLock();
+
+  /// @brief mutex shared by all users of casacore in this process
+  /// @return reference to the mutex
+  static boost::recursive_mutex& mutex();
+
+  /// @brief open the table under the lock
+  /// @details Opening a table involves the table cache shared by all tables of the
+  /// process. This helper is handy in the initialisation lists of constructors.
+  /// @param[in] name file name of the table
+  /// @param[in] option table option
+  /// @return table object
+  static casa::Table openTable(const std::string &name, const casa::Table::TableOption option = casa::Table::Old);
+};
+
+} // namespace accessors
+
+} // namespace askap
+
+#endif // #ifndef ASKAP_ACCESSORS_CASACORE_LOCK_H
@@ -0,0 +1,268 @@
+/// @file
+/// @brief accessor for the native memory-mapped visibility store
+/// @details This accessor works with MappedConstDataIterator. Visibilities, flags, noise and
+/// integer metadata refer to the mapped memory if all rows of the chunk are selected, i.e.
+/// no copy is made. Otherwise, the selected rows are copied. All fields are filled on demand.
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author agent <agent@local>
+///
+
+#include <dataaccess/MappedConstDataAccessor.h>
+#include <dataaccess/MappedConstDataIterator.h>
+#include <askap/AskapError.h>
+
+using namespace askap;
+using namespace askap::accessors;
+
+/// construct an object linked with the given iterator
+/// @param[in] iter a reference to associated iterator
+MappedConstDataAccessor::MappedConstDataAccessor(const MappedConstDataIterator &iter) :
+      itsIterator(iter), itsRotatedUVW(iter.uvwMachineCacheSize(), iter.uvwMachineCacheTolerance()) {}
+
+/// The number of rows in this chunk
+/// @return the number of rows in this chunk
+casa::uInt MappedConstDataAccessor::nRow() const throw()
+{
+  return itsIterator.nRow();
+}
+
+/// The number of spectral channels (equal for all rows)
+/// @return the number of spectral channels
+casa::uInt MappedConstDataAccessor::nChannel() const throw()
+{
+  return itsIterator.nChannel();
+}
+
+/// The number of polarization products (equal for all rows)
+/// @return the number of polarization products (can be 1,2 or 4)
+casa::uInt MappedConstDataAccessor::nPol() const throw()
+{
+  return itsIterator.nPol();
+}
+
+/// Visibilities (a cube is nRow x nChannel x nPol; each element is
+/// a complex visibility)
+/// @return a reference to nRow x nChannel x nPol cube, containing
+/// all visibility data
+const casa::Cube<casa::Complex>& MappedConstDataAccessor::visibility() const
+{
+  return itsVisibility.value(itsIterator, &MappedConstDataIterator::fillVisibility);
+}
+
+/// Cube of flags corresponding to the output of visibility()
+/// @return a reference to nRow x nChannel x nPol cube with flag
+///         information. If True, the corresponding element is flagged.
+const casa::Cube<casa::Bool>& MappedConstDataAccessor::flag() const
+{
+  return itsFlag.value(itsIterator, &MappedConstDataIterator::fillFlag);
+}
+
+/// Noise level required for a proper weighting
+/// @return a reference to nRow x nChannel x nPol cube with
+///         complex noise estimates
+const casa::Cube<casa::Complex>& MappedConstDataAccessor::noise() const
+{
+  return itsNoise.value(itsIterator, &MappedConstDataIterator::fillNoise);
+}
+
+/// UVW
+/// @return a reference to vector containing uvw-coordinates
+/// packed into a 3-D rigid vector
+const casa::Vector<casa::RigidVector<casa::Double, 3> >& MappedConstDataAccessor::uvw() const
+{
+  return itsUVW.value(itsIterator, &MappedConstDataIterator::fillUVW);
+}
+
+/// Frequency for each channel
+/// @return a reference to vector containing frequencies for each
+///         spectral channel (vector size is nChannel). Frequencies
+///         are given as Doubles, the frame/units are specified by
+///         the DataSource object
+const casa::Vector<casa::Double>& MappedConstDataAccessor::frequency() const
+{
+  return itsFrequency.value(itsIterator, &MappedConstDataIterator::fillFrequency);
+}
+
+/// Timestamp for each row
+/// @return a timestamp for this buffer (it is always the same
+///         for all rows. The timestamp is returned as
+///         Double w.r.t. the origin specified by the
+///         DataSource object and in that reference frame
+casa::Double MappedConstDataAccessor::time() const
+{
+  return itsTime.value(itsIterator, &MappedConstDataIterator::fillTime);
+}
+
+/// First antenna IDs for all rows
+/// @return a vector with IDs of the first antenna corresponding
+/// to each visibility (one for each row)
+const casa::Vector<casa::uInt>& MappedConstDataAccessor::antenna1() const
+{
+  return itsAntenna1.value(itsIterator, &MappedConstDataIterator::fillAntenna1);
+}
+
+/// Second antenna IDs for all rows
+/// @return a vector with IDs of the second antenna corresponding
+/// to each visibility (one for each row)
+const casa::Vector<casa::uInt>& MappedConstDataAccessor::antenna2() const
+{
+  return itsAntenna2.value(itsIterator, &MappedConstDataIterator::fillAntenna2);
+}
+
+/// First feed IDs for all rows
+/// @return a vector with IDs of the first feed corresponding
+/// to each visibility (one for each row)
+const casa::Vector<casa::uInt>& MappedConstDataAccessor::feed1() const
+{
+  return itsFeed1.value(itsIterator, &MappedConstDataIterator::fillFeed1);
+}
+
+/// Second feed IDs for all rows
+/// @return a vector with IDs of the second feed corresponding
+/// to each visibility (one for each row)
+const casa::Vector<casa::uInt>& MappedConstDataAccessor::feed2() const
+{
+  return itsFeed2.value(itsIterator, &MappedConstDataIterator::fillFeed2);
+}
+
+/// Position angles of the first feed for all rows
+/// @return a vector with position angles (in radians) of the
+/// first feed corresponding to each visibility
+const casa::Vector<casa::Float>& MappedConstDataAccessor::feed1PA() const
+{
+  return itsFeed1PA.value(itsIterator, &MappedConstDataIterator::fillFeed1PA);
+}
+
+/// Position angles of the second feed for all rows
+/// @return a vector with position angles (in radians) of the
+/// second feed corresponding to each visibility
+const casa::Vector<casa::Float>& MappedConstDataAccessor::feed2PA() const
+{
+  return itsFeed2PA.value(itsIterator, &MappedConstDataIterator::fillFeed2PA);
+}
+
+/// Return pointing centre directions of the first antenna/feed
+/// @return a vector with direction measures (coordinate system
+/// is set via IDataConverter), one direction for each
+/// visibility/row
+const casa::Vector<casa::MVDirection>& MappedConstDataAccessor::pointingDir1() const
+{
+  return itsPointingDir1.value(itsIterator, &MappedConstDataIterator::fillPointingDir1);
+}
+
+/// Pointing centre directions of the second antenna/feed
+/// @return a vector with direction measures (coordinate system
+/// is set via IDataConverter), one direction for each
+/// visibility/row
+const casa::Vector<casa::MVDirection>& MappedConstDataAccessor::pointingDir2() const
+{
+  return itsPointingDir2.value(itsIterator, &MappedConstDataIterator::fillPointingDir2);
+}
+
+/// pointing direction for the centre of the first antenna
+/// @details The same as pointingDir1, if the feed offsets are zero
+/// @return a vector with direction measures (coordinate system
+/// is set via IDataConverter), one direction for each
+/// visibility/row
+const casa::Vector<casa::MVDirection>& MappedConstDataAccessor::dishPointing1() const
+{
+  return itsDishPointing1.value(itsIterator, &MappedConstDataIterator::fillDishPointing1);
+}
+
+/// pointing direction for the centre of the second antenna
+/// @details The same as pointingDir2, if the feed offsets are zero
+/// @return a vector with direction measures (coordinate system
+/// is set via IDataConverter), one direction for each
+/// visibility/row
+const casa::Vector<casa::MVDirection>& MappedConstDataAccessor::dishPointing2() const
+{
+  return itsDishPointing2.value(itsIterator, &MappedConstDataIterator::fillDishPointing2);
+}
+
+/// @brief uvw after rotation
+/// @details This method calls UVWMachine to rotate baseline coordinates
+/// for a new tangent point. Delays corresponding to this correction are
+/// returned by a separate method.
+/// @param[in] tangentPoint tangent point to rotate the coordinates to
+/// @return uvw after rotation to the new coordinate system for each row
+const casa::Vector<casa::RigidVector<casa::Double, 3> >&
+           MappedConstDataAccessor::rotatedUVW(const casa::MDirection &tangentPoint) const
+{
+  return itsRotatedUVW.uvw(*this, tangentPoint);
+}
+
+/// @brief delay associated with uvw rotation
+/// @details This is a companion method to rotatedUVW. It returns delays corresponding
+/// to the baseline coordinate rotation. An additional delay corresponding to the
+/// translation in the tangent plane can also be applied using the image
+/// centre parameter. Set it to tangent point to apply no extra translation.
+/// @param[in] tangentPoint tangent point to rotate the coordinates to
+/// @param[in] imageCentre image centre (additional translation is done if imageCentre!=tangentPoint)
+/// @return delays corresponding to the uvw rotation for each row
+const casa::Vector<casa::Double>& MappedConstDataAccessor::uvwRotationDelay(
+           const casa::MDirection &tangentPoint, const casa::MDirection &imageCentre) const
+{
+  return itsRotatedUVW.delays(*this, tangentPoint, imageCentre);
+}
+
+/// Velocity for each channel
+/// @details Not implemented, as for the table-based accessor
+/// @return a reference to vector containing velocities for each
+///         spectral channel (vector size is nChannel).
+const casa::Vector<casa::Double>& MappedConstDataAccessor::velocity() const
+{
+  throw AskapError("MappedConstDataAccessor::velocity has not been implemented.");
+}
+
+/// @brief polarisation type for each product
+/// @return a reference to vector containing polarisation types for
+/// each product in the visibility cube (nPol() elements).
+const casa::Vector<casa::Stokes::StokesTypes>& MappedConstDataAccessor::stokes() const
+{
+  return itsIterator.stokes();
+}
+
+/// @brief invalidate all fields
+/// @details This method is called by the iterator when it moves to a new chunk
+void MappedConstDataAccessor::invalidate() const throw()
+{
+  itsVisibility.invalidate();
+  itsFlag.invalidate();
+  itsNoise.invalidate();
+  itsUVW.invalidate();
+  itsFrequency.invalidate();
+  itsTime.invalidate();
+  itsAntenna1.invalidate();
+  itsAntenna2.invalidate();
+  itsFeed1.invalidate();
+  itsFeed2.invalidate();
+  itsFeed1PA.invalidate();
+  itsFeed2PA.invalidate();
+  itsPointingDir1.invalidate();
+  itsPointingDir2.invalidate();
+  itsDishPointing1.invalidate();
+  itsDishPointing2.invalidate();
+  itsRotatedUVW.invalidate();
+}
@@ -0,0 +1,399 @@
+/// @file
+/// @brief iterator over the native memory-mapped visibility store
+/// @details Each chunk of the store is one iteration. The selection is applied by
+/// rows and channels, and the data are converted to the frames requested via the
+/// converter. The data are not copied unless a subset of rows is selected.
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author agent <agent@local>
+///
+
+#include <dataaccess/MappedConstDataIterator.h>
+#include <dataaccess/DataAccessError.h>
+#include <askap/AskapError.h>
+
+// casa includes
+#include <casa/Arrays/IPosition.h>
+#include <casa/Quanta/MVEpoch.h>
+#include <casa/Quanta/Quantum.h>
+#include <casa/Quanta/MVFrequency.h>
+#include <casa/Quanta/Unit.h>
+#include <measures/Measures/MeasFrame.h>
+#include <measures/Measures/MFrequency.h>
+
+// std includes
+#include <algorithm>
+
+using namespace askap;
+using namespace askap::accessors;
+
+/// @brief construct the iterator
+/// @param[in] store shared pointer to the mapped store
+/// @param[in] sel shared pointer to the selector
+/// @param[in] conv shared pointer to the converter
+/// @param[in] cacheSize a number of uvw machines in the cache (default is 1)
+/// @param[in] tolerance pointing direction tolerance in radians, exceeding which leads
+/// to initialisation of a new UVW Machine
+MappedConstDataIterator::MappedConstDataIterator(const MappedVisStore::ShPtr &store,
+                          const boost::shared_ptr<MappedDataSelector const> &sel,
+                          const boost::shared_ptr<IDataConverterImpl const> &conv,
+                          size_t cacheSize, double tolerance) :
+      itsStore(store), itsSelector(sel), itsConverter(conv->clone()), itsCurrentChunk(0),
+      itsLayout(0, 0, 0), itsAllRows(true), itsUVWCacheSize(cacheSize), itsUVWCacheTolerance(tolerance),
+      itsAccessor(*this)
+{
+  ASKAPDEBUGASSERT(itsStore);
+  ASKAPDEBUGASSERT(itsSelector);
+  init();
+}
+
+/// Restart the iteration from the beginning
+void MappedConstDataIterator::init()
+{
+  if (itsSelector->channelsSelected() &&
+      (itsSelector->startChannel() + itsSelector->nChannel() > itsStore->nChannel())) {
+      ASKAPTHROW(DataAccessLogicError, "Selected channels "<<itsSelector->startChannel()<<" to "<<
+                 itsSelector->startChannel() + itsSelector->nChannel() - 1<<" are outside the "<<
+                 itsStore->nChannel()<<" channels of the visibility store "<<itsStore->name());
+  }
+  findChunk(0);
+}
+
+/// operator* delivers a reference to data accessor (current chunk)
+/// @return a reference to the current chunk
+const IConstDataAccessor& MappedConstDataIterator::operator*() const
+{
+  ASKAPDEBUGASSERT(hasMore());
+  return itsAccessor;
+}
+
+/// Checks whether there are more data available.
+/// @return True if there are more data available
+casa::Bool MappedConstDataIterator::hasMore() const throw()
+{
+  return itsCurrentChunk < itsStore->nChunks();
+}
+
+/// advance the iterator one step further
+/// @return True if there are more data (so constructions like
+///         while(it.next()) {} are possible)
+casa::Bool MappedConstDataIterator::next()
+{
+  if (hasMore()) {
+      findChunk(itsCurrentChunk + 1);
+  }
+  return hasMore();
+}
+
+/// @return the number of rows in the current chunk (after selection)
+casa::uInt MappedConstDataIterator::nRow() const throw()
+{
+  if (!hasMore()) {
+      return 0;
+  }
+  return itsAllRows ? itsStore->nRow(itsCurrentChunk) : casa::uInt(itsRows.size());
+}
+
+/// @return the number of channels (after selection)
+casa::uInt MappedConstDataIterator::nChannel() const throw()
+{
+  return itsSelector->channelsSelected() ? itsSelector->nChannel() : itsStore->nChannel();
+}
+
+/// @return the number of polarisation products
+casa::uInt MappedConstDataIterator::nPol() const throw()
+{
+  return itsStore->nPol();
+}
+
+/// @brief find the first chunk passing the selection starting from the given one
+/// @details Selected rows of the chunk found are determined
+/// @param[in] chunk the chunk to start the search from
+void MappedConstDataIterator::findChunk(size_t chunk)
+{
+  itsAccessor.invalidate();
+  const bool rowsSelected = itsSelector->rowsSelected();
+  for (itsCurrentChunk = chunk; itsCurrentChunk < itsStore->nChunks(); ++itsCurrentChunk) {
+       const double utcTime = itsStore->time(itsCurrentChunk);
+       if (!itsSelector->cycleSelected(itsCurrentChunk, utcTime, itsConverter->epoch(currentEpoch()))) {
+           continue;
+       }
+       const casa::uInt nRow = itsStore->nRow(itsCurrentChunk);
+       itsLayout = MappedVisStore::ChunkLayout(nRow, itsStore->nChannel(), itsStore->nPol());
+       itsAllRows = !rowsSelected;
+       if (rowsSelected) {
+           const casa::uInt *ant1 = chunkArray<casa::uInt>(itsLayout.antenna1);
+           const casa::uInt *ant2 = chunkArray<casa::uInt>(itsLayout.antenna2);
+           const casa::uInt *feed1 = chunkArray<casa::uInt>(itsLayout.feed1);
+           const casa::uInt *feed2 = chunkArray<casa::uInt>(itsLayout.feed2);
+           const double *uvw = chunkArray<double>(itsLayout.uvw);
+           itsRows.resize(0);
+           for (casa::uInt row = 0; row < nRow; ++row) {
+                if (itsSelector->rowSelected(ant1[row], ant2[row], feed1[row], feed2[row], uvw + 3 * row)) {
+                    itsRows.push_back(row);
+                }
+           }
+           // the view is still possible if all rows passed the selection
+           itsAllRows = (itsRows.size() == nRow);
+       }
+       if ((nRow > 0) && (itsAllRows || (itsRows.size() > 0))) {
+           return;
+       }
+  }
+}
+
+/// @brief epoch of the current chunk
+/// @return the epoch as a measure in UTC
+casa::MEpoch MappedConstDataIterator::currentEpoch() const
+{
+  return casa::MEpoch(casa::MVEpoch(casa::Quantity(itsStore->time(itsCurrentChunk), "s")),
+                      casa::MEpoch::Ref(casa::MEpoch::UTC));
+}
+
+/// @brief pointer to the array of the current chunk
+/// @param[in] offset offset of the array in the chunk
+/// @return pointer to the first element
+template<typename T>
+const T* MappedConstDataIterator::chunkArray(size_t offset) const
+{
+  ASKAPDEBUGASSERT(hasMore());
+  return reinterpret_cast<const T*>(itsStore->chunk(itsCurrentChunk) + offset);
+}
+
+/// @brief fill a cube with the selected rows and channels
+/// @details The data are copied from the mapped memory, as casa arrays can't keep the mapping
+/// alive and could otherwise outlive the store. The buffer of the cube is reused, unless it is
+/// still referenced elsewhere (e.g. by the consumer of the previous chunk). If all rows and
+/// channels are selected, the whole block is copied in one go.
+/// @param[in] cube cube to fill
+/// @param[in] offset offset of the array in the chunk
+template<typename T>
+void MappedConstDataIterator::fillCube(casa::Cube<T> &cube, size_t offset) const
+{
+  const casa::uInt nRowInChunk = itsStore->nRow(itsCurrentChunk);
+  const casa::uInt nChanInChunk = itsStore->nChannel();
+  const casa::uInt startChan = itsSelector->channelsSelected() ? itsSelector->startChannel() : 0;
+  const casa::uInt nChan = nChannel();
+  const casa::IPosition shape(3, nRow(), nChan, nPol());
+  if ((cube.nrefs() > 1) || !(cube.shape() == shape) || !cube.contiguousStorage()) {
+      cube.reference(casa::Cube<T>(shape));
+  }
+  const T* data = chunkArray<T>(offset);
+  T* out = cube.data();
+  if (itsAllRows) {
+      if (nChan == nChanInChunk) {
+          std::copy(data, data + shape.product(), out);
+      } else {
+          // each polarisation plane of the selected channel range is contiguous
+          const size_t planeSize = size_t(nChan) * nRowInChunk;
+          for (casa::uInt pol = 0; pol < nPol(); ++pol) {
+               const T* plane = data + (size_t(pol) * nChanInChunk + startChan) * nRowInChunk;
+               std::copy(plane, plane + planeSize, out + pol * planeSize);
+          }
+      }
+  } else {
+      for (casa::uInt pol = 0; pol < nPol(); ++pol) {
+           for (casa::uInt chan = 0; chan < nChan; ++chan) {
+                const T* plane = data + (size_t(pol) * nChanInChunk + startChan + chan) * nRowInChunk;
+                for (casa::uInt row = 0; row < itsRows.size(); ++row, ++out) {
+                     *out = plane[itsRows[row]];
+                }
+           }
+      }
+  }
+}
+
+/// @brief fill a vector with the selected rows
+/// @details The data are copied from the mapped memory (see fillCube)
+/// @param[in] vec vector to fill
+/// @param[in] offset offset of the array in the chunk
+template<typename T>
+void MappedConstDataIterator::fillVector(casa::Vector<T> &vec, size_t offset) const
+{
+  const casa::uInt nRow = this->nRow();
+  if ((vec.nrefs() > 1) || (vec.nelements() != nRow) || !vec.contiguousStorage()) {
+      vec.reference(casa::Vector<T>(nRow));
+  }
+  const T* data = chunkArray<T>(offset);
+  T* out = vec.data();
+  if (itsAllRows) {
+      std::copy(data, data + nRow, out);
+  } else {
+      for (casa::uInt row = 0; row < nRow; ++row) {
+           out[row] = data[itsRows[row]];
+      }
+  }
+}
+
+/// @brief fill directions for the selected rows
+/// @param[in] dirs vector to fill
+/// @param[in] offset offset of the array in the chunk
+void MappedConstDataIterator::fillDirections(casa::Vector<casa::MVDirection> &dirs, size_t offset) const
+{
+  const double *data = chunkArray<double>(offset);
+  const casa::uInt nRow = this->nRow();
+  dirs.resize(nRow);
+  itsConverter->setMeasFrame(casa::MeasFrame(currentEpoch(), itsStore->position()));
+  for (casa::uInt row = 0; row < nRow; ++row) {
+       const size_t storeRow = itsAllRows ? row : itsRows[row];
+       const casa::MDirection dir(casa::MVDirection(data[2 * storeRow], data[2 * storeRow + 1]),
+                                  casa::MDirection::Ref(casa::MDirection::J2000));
+       itsConverter->direction(dir, dirs[row]);
+  }
+}
+
+/// @brief populate the buffer with visibilities
+/// @param[in] vis a reference to the buffer to fill
+void MappedConstDataIterator::fillVisibility(casa::Cube<casa::Complex> &vis) const
+{
+  fillCube(vis, itsLayout.visibility);
+}
+
+/// @brief populate the buffer with flags
+/// @param[in] flag a reference to the buffer to fill
+void MappedConstDataIterator::fillFlag(casa::Cube<casa::Bool> &flag) const
+{
+  fillCube(flag, itsLayout.flag);
+}
+
+/// @brief populate the buffer with noise
+/// @param[in] noise a reference to the buffer to fill
+void MappedConstDataIterator::fillNoise(casa::Cube<casa::Complex> &noise) const
+{
+  fillCube(noise, itsLayout.noise);
+}
+
+/// @brief populate the buffer with uvw
+/// @param[in] uvw a reference to the buffer to fill
+void MappedConstDataIterator::fillUVW(casa::Vector<casa::RigidVector<casa::Double, 3> > &uvw) const
+{
+  const double *data = chunkArray<double>(itsLayout.uvw);
+  const casa::uInt nRow = this->nRow();
+  uvw.resize(nRow);
+  for (casa::uInt row = 0; row < nRow; ++row) {
+       const double *rowUVW = data + 3 * (itsAllRows ? row : itsRows[row]);
+       uvw[row] = casa::RigidVector<casa::Double, 3>(rowUVW[0], rowUVW[1], rowUVW[2]);
+  }
+}
+
+/// @brief populate the buffer with frequencies
+/// @param[in] freq a reference to the buffer to fill
+void MappedConstDataIterator::fillFrequency(casa::Vector<casa::Double> &freq) const
+{
+  const casa::uInt nChan = nChannel();
+  const casa::uInt startChan = itsSelector->channelsSelected() ? itsSelector->startChannel() : 0;
+  const casa::Vector<casa::Double> &storeFreq = itsStore->frequencies();
+  const casa::MFrequency::Ref frame = itsStore->frequencyFrame();
+  if (itsConverter->isVoid(frame, casa::Unit("Hz")) && !itsSelector->channelsSelected()) {
+      // the conversion is void, refer to the frequency axis of the store
+      freq.reference(storeFreq);
+  } else {
+      // same approach as in the table-based iterator: use the dish pointing centre of the
+      // first row for the frequency conversion
+      const double *dir = chunkArray<double>(itsLayout.dishPointing1);
+      itsConverter->setMeasFrame(casa::MeasFrame(currentEpoch(), itsStore->position(),
+                  casa::MDirection(casa::MVDirection(dir[0], dir[1]), casa::MDirection::Ref(casa::MDirection::J2000))));
+      freq.resize(nChan);
+      for (casa::uInt ch = 0; ch < nChan; ++ch) {
+           freq[ch] = itsConverter->frequency(casa::MFrequency(casa::MVFrequency(storeFreq[startChan + ch]), frame));
+      }
+  }
+}
+
+/// @brief populate the buffer with time
+/// @param[in] time a reference to the buffer to fill
+void MappedConstDataIterator::fillTime(casa::Double &time) const
+{
+  time = itsConverter->epoch(currentEpoch());
+}
+
+/// @brief populate the buffer with IDs of the first antenna
+/// @param[in] ids a reference to the buffer to fill
+void MappedConstDataIterator::fillAntenna1(casa::Vector<casa::uInt> &ids) const
+{
+  fillVector(ids, itsLayout.antenna1);
+}
+
+/// @brief populate the buffer with IDs of the second antenna
+/// @param[in] ids a reference to the buffer to fill
+void MappedConstDataIterator::fillAntenna2(casa::Vector<casa::uInt> &ids) const
+{
+  fillVector(ids, itsLayout.antenna2);
+}
+
+/// @brief populate the buffer with IDs of the first feed
+/// @param[in] ids a reference to the buffer to fill
+void MappedConstDataIterator::fillFeed1(casa::Vector<casa::uInt> &ids) const
+{
+  fillVector(ids, itsLayout.feed1);
+}
+
+/// @brief populate the buffer with IDs of the second feed
+/// @param[in] ids a reference to the buffer to fill
+void MappedConstDataIterator::fillFeed2(casa::Vector<casa::uInt> &ids) const
+{
+  fillVector(ids, itsLayout.feed2);
+}
+
+/// @brief populate the buffer with position angles of the first feed
+/// @param[in] angles a reference to the buffer to fill
+void MappedConstDataIterator::fillFeed1PA(casa::Vector<casa::Float> &angles) const
+{
+  fillVector(angles, itsLayout.feed1PA);
+}
+
+/// @brief populate the buffer with position angles of the second feed
+/// @param[in] angles a reference to the buffer to fill
+void MappedConstDataIterator::fillFeed2PA(casa::Vector<casa::Float> &angles) const
+{
+  fillVector(angles, itsLayout.feed2PA);
+}
+
+/// @brief populate the buffer with pointing directions of the first feed
+/// @param[in] dirs a reference to the buffer to fill
+void MappedConstDataIterator::fillPointingDir1(casa::Vector<casa::MVDirection> &dirs) const
+{
+  fillDirections(dirs, itsLayout.pointingDir1);
+}
+
+/// @brief populate the buffer with pointing directions of the second feed
+/// @param[in] dirs a reference to the buffer to fill
+void MappedConstDataIterator::fillPointingDir2(casa::Vector<casa::MVDirection> &dirs) const
+{
+  fillDirections(dirs, itsLayout.pointingDir2);
+}
+
+/// @brief populate the buffer with pointing directions of the first dish
+/// @param[in] dirs a reference to the buffer to fill
+void MappedConstDataIterator::fillDishPointing1(casa::Vector<casa::MVDirection> &dirs) const
+{
+  fillDirections(dirs, itsLayout.dishPointing1);
+}
+
+/// @brief populate the buffer with pointing directions of the second dish
+/// @param[in] dirs a reference to the buffer to fill
+void MappedConstDataIterator::fillDishPointing2(casa::Vector<casa::MVDirection> &dirs) const
+{
+  fillDirections(dirs, itsLayout.dishPointing2);
+}
@@ -0,0 +1,252 @@
+/// @file
+/// @brief iterator over the native memory-mapped visibility store
+/// @details Each chunk of the store is one iteration. The selection is applied by
+/// rows and channels, and the data are converted to the frames requested via the
+/// converter. The data are not copied unless a subset of rows is selected.
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author agent <agent@local>
+///
+
+#ifndef ASKAP_ACCESSORS_MAPPED_CONST_DATA_ITERATOR_H
+#define ASKAP_ACCESSORS_MAPPED_CONST_DATA_ITERATOR_H
+
+// own includes
+#include <dataaccess/IConstDataIterator.h>
+#include <dataaccess/IDataConverterImpl.h>
+#include <dataaccess/MappedVisStore.h>
+#include <dataaccess/MappedDataSelector.h>
+#include <dataaccess/MappedConstDataAccessor.h>
+
+// casa includes
+#include <measures/Measures/MEpoch.h>
+#include <measures/Measures/MDirection.h>
+
+// boost includes
+#include <boost/shared_ptr.hpp>
+
+// std includes
+#include <vector>
+
+namespace askap {
+
+namespace accessors {
+
+/// @brief iterator over the native memory-mapped visibility store
+/// @details Chunks which don't pass the selection by time or have no selected rows are
+/// skipped. Visibilities, noise, flags and integer metadata are copied from the mapped memory
+/// (in one block if all rows and channels are selected) into buffers which are reused from chunk
+/// to chunk unless the consumer still refers to them. Therefore, the arrays obtained from the
+/// accessor stay valid after the store is unmapped. Directions, time and frequencies are converted on demand as requested by
+/// the converter (the store keeps them in J2000, UTC and the native frequency frame).
+/// @ingroup dataaccess_hlp
+class MappedConstDataIterator : virtual public IConstDataIterator
+{
+public:
+  /// @brief construct the iterator
+  /// @param[in] store shared pointer to the mapped store
+  /// @param[in] sel shared pointer to the selector
+  /// @param[in] conv shared pointer to the converter
+  /// @param[in] cacheSize a number of uvw machines in the cache (default is 1)
+  /// @param[in] tolerance pointing direction tolerance in radians, exceeding which leads
+  /// to initialisation of a new UVW Machine
+  MappedConstDataIterator(const MappedVisStore::ShPtr &store,
+                          const boost::shared_ptr<MappedDataSelector const> &sel,
+                          const boost::shared_ptr<IDataConverterImpl const> &conv,
+                          size_t cacheSize = 1, double tolerance = 1e-6);
+
+  /// Restart the iteration from the beginning
+  virtual void init();
+
+  /// operator* delivers a reference to data accessor (current chunk)
+  /// @return a reference to the current chunk
+  virtual const IConstDataAccessor& operator*() const;
+
+  /// Checks whether there are more data available.
+  /// @return True if there are more data available
+  virtual casa::Bool hasMore() const throw();
+
+  /// advance the iterator one step further
+  /// @return True if there are more data (so constructions like
+  ///         while(it.next()) {} are possible)
+  virtual casa::Bool next();
+
+  /// @return the number of rows in the current chunk (after selection)
+  casa::uInt nRow() const throw();
+
+  /// @return the number of channels (after selection)
+  casa::uInt nChannel() const throw();
+
+  /// @return the number of polarisation products
+  casa::uInt nPol() const throw();
+
+  /// @return polarisation products
+  inline const casa::Vector<casa::Stokes::StokesTypes>& stokes() const { return itsStore->stokes(); }
+
+  /// @brief UVW machine cache size
+  /// @return size of the uvw machine cache
+  inline size_t uvwMachineCacheSize() const {return itsUVWCacheSize;}
+
+  /// @brief direction tolerance used for UVW machine cache
+  /// @return direction tolerance used for UVW machine cache (in radians)
+  inline double uvwMachineCacheTolerance() const {return itsUVWCacheTolerance;}
+
+  /// @brief populate the buffer with visibilities
+  /// @param[in] vis a reference to the buffer to fill
+  void fillVisibility(casa::Cube<casa::Complex> &vis) const;
+
+  /// @brief populate the buffer with flags
+  /// @param[in] flag a reference to the buffer to fill
+  void fillFlag(casa::Cube<casa::Bool> &flag) const;
+
+  /// @brief populate the buffer with noise
+  /// @param[in] noise a reference to the buffer to fill
+  void fillNoise(casa::Cube<casa::Complex> &noise) const;
+
+  /// @brief populate the buffer with uvw
+  /// @param[in] uvw a reference to the buffer to fill
+  void fillUVW(casa::Vector<casa::RigidVector<casa::Double, 3> > &uvw) const;
+
+  /// @brief populate the buffer with frequencies
+  /// @param[in] freq a reference to the buffer to fill
+  void fillFrequency(casa::Vector<casa::Double> &freq) const;
+
+  /// @brief populate the buffer with time
+  /// @param[in] time a reference to the buffer to fill
+  void fillTime(casa::Double &time) const;
+
+  /// @brief populate the buffer with IDs of the first antenna
+  /// @param[in] ids a reference to the buffer to fill
+  void fillAntenna1(casa::Vector<casa::uInt> &ids) const;
+
+  /// @brief populate the buffer with IDs of the second antenna
+  /// @param[in] ids a reference to the buffer to fill
+  void fillAntenna2(casa::Vector<casa::uInt> &ids) const;
+
+  /// @brief populate the buffer with IDs of the first feed
+  /// @param[in] ids a reference to the buffer to fill
+  void fillFeed1(casa::Vector<casa::uInt> &ids) const;
+
+  /// @brief populate the buffer with IDs of the second feed
+  /// @param[in] ids a reference to the buffer to fill
+  void fillFeed2(casa::Vector<casa::uInt> &ids) const;
+
+  /// @brief populate the buffer with position angles of the first feed
+  /// @param[in] angles a reference to the buffer to fill
+  void fillFeed1PA(casa::Vector<casa::Float> &angles) const;
+
+  /// @brief populate the buffer with position angles of the second feed
+  /// @param[in] angles a reference to the buffer to fill
+  void fillFeed2PA(casa::Vector<casa::Float> &angles) const;
+
+  /// @brief populate the buffer with pointing directions of the first feed
+  /// @param[in] dirs a reference to the buffer to fill
+  void fillPointingDir1(casa::Vector<casa::MVDirection> &dirs) const;
+
+  /// @brief populate the buffer with pointing directions of the second feed
+  /// @param[in] dirs a reference to the buffer to fill
+  void fillPointingDir2(casa::Vector<casa::MVDirection> &dirs) const;
+
+  /// @brief populate the buffer with pointing directions of the first dish
+  /// @param[in] dirs a reference to the buffer to fill
+  void fillDishPointing1(casa::Vector<casa::MVDirection> &dirs) const;
+
+  /// @brief populate the buffer with pointing directions of the second dish
+  /// @param[in] dirs a reference to the buffer to fill
+  void fillDishPointing2(casa::Vector<casa::MVDirection> &dirs) const;
+
+private:
+  /// @brief find the first chunk passing the selection starting from the given one
+  /// @details Selected rows of the chunk found are determined
+  /// @param[in] chunk the chunk to start the search from
+  void findChunk(size_t chunk);
+
+  /// @brief epoch of the current chunk
+  /// @return the epoch as a measure in UTC
+  casa::MEpoch currentEpoch() const;
+
+  /// @brief pointer to the array of the current chunk
+  /// @param[in] offset offset of the array in the chunk
+  /// @return pointer to the first element
+  template<typename T>
+  const T* chunkArray(size_t offset) const;
+
+  /// @brief fill a cube with the selected rows and channels
+  /// @details The data are copied from the mapped memory, as casa arrays can't keep the mapping
+  /// alive and could otherwise outlive the store. The buffer of the cube is reused, unless it is
+  /// still referenced elsewhere (e.g. by the consumer of the previous chunk). If all rows and
+  /// channels are selected, the whole block is copied in one go.
+  /// @param[in] cube cube to fill
+  /// @param[in] offset offset of the array in the chunk
+  template<typename T>
+  void fillCube(casa::Cube<T> &cube, size_t offset) const;
+
+  /// @brief fill a vector with the selected rows
+  /// @details The data are copied from the mapped memory (see fillCube)
+  /// @param[in] vec vector to fill
+  /// @param[in] offset offset of the array in the chunk
+  template<typename T>
+  void fillVector(casa::Vector<T> &vec, size_t offset) const;
+
+  /// @brief fill directions for the selected rows
+  /// @param[in] dirs vector to fill
+  /// @param[in] offset offset of the array in the chunk
+  void fillDirections(casa::Vector<casa::MVDirection> &dirs, size_t offset) const;
+
+  /// @brief mapped store
+  MappedVisStore::ShPtr itsStore;
+
+  /// @brief selector
+  boost::shared_ptr<MappedDataSelector const> itsSelector;
+
+  /// @brief converter
+  boost::shared_ptr<IDataConverterImpl> itsConverter;
+
+  /// @brief current chunk in the store (equal to the number of chunks if there are no more data)
+  size_t itsCurrentChunk;
+
+  /// @brief layout of the current chunk
+  MappedVisStore::ChunkLayout itsLayout;
+
+  /// @brief true if all rows of the current chunk are selected
+  bool itsAllRows;
+
+  /// @brief selected rows of the current chunk (used if not all rows are selected)
+  std::vector<casa::uInt> itsRows;
+
+  /// @brief a number of uvw machines in the cache
+  size_t itsUVWCacheSize;
+
+  /// @brief pointing direction tolerance in radians (for uvw machine cache)
+  double itsUVWCacheTolerance;
+
+  /// @brief accessor for the current chunk
+  MappedConstDataAccessor itsAccessor;
+};
+
+} // namespace accessors
+
+} // namespace askap
+
+#endif // #ifndef ASKAP_ACCESSORS_MAPPED_CONST_DATA_ITERATOR_H
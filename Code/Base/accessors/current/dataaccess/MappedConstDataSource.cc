@@ -0,0 +1,106 @@
+/// @file
+/// @brief data source for the native memory-mapped visibility store
+/// @details This is an alternative to TableConstDataSource which reads the data converted
+/// into the native store (see MappedVisStore and MappedVisStoreWriter). The data are used
+/// directly from the mapped memory, avoiding per-row and per-column overheads of casacore
+/// tables, and any number of iterators (e.g. in different threads) can read the store at the
+/// same time as they share the read-only mapping.
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author agent <agent@local>
+///
+
+#include <dataaccess/MappedConstDataSource.h>
+#include <dataaccess/MappedConstDataIterator.h>
+#include <dataaccess/MappedDataSelector.h>
+#include <dataaccess/BasicDataConverter.h>
+#include <dataaccess/DataAccessError.h>
+#include <askap/AskapError.h>
+
+using namespace askap;
+using namespace askap::accessors;
+
+/// @brief open the store
+/// @param[in] fname file name of the store
+MappedConstDataSource::MappedConstDataSource(const std::string &fname) :
+      itsStore(new MappedVisStore(fname)), itsUVWCacheSize(1), itsUVWCacheTolerance(1e-6) {}
+
+/// create a converter object corresponding to this type of the
+/// DataSource. The user can change converting policies (units,
+/// reference frames) by appropriate calls to this converter object
+/// and pass it back to createConstIterator(...). The data returned by
+/// the iterator will automatically be in the requested frame/units
+///
+/// @return a shared pointer to a new DataConverter object
+IDataConverterPtr MappedConstDataSource::createConverter() const
+{
+  return IDataConverterPtr(new BasicDataConverter);
+}
+
+/// get iterator over a selected part of the dataset represented
+/// by this DataSource object with an explicitly specified conversion
+/// policy.
+///
+/// @param[in] sel a shared pointer to the selector object defining
+///            which subset of the data is used
+/// @param[in] conv a shared pointer to the converter object defining
+///            reference frames and units to be used
+/// @return a shared pointer to DataIterator object
+boost::shared_ptr<IConstDataIterator>
+MappedConstDataSource::createConstIterator(const IDataSelectorConstPtr &sel,
+              const IDataConverterConstPtr &conv) const
+{
+   // cast input selector and converter to the implementation interfaces
+   boost::shared_ptr<MappedDataSelector const> implSel =
+           boost::dynamic_pointer_cast<MappedDataSelector const>(sel);
+   boost::shared_ptr<IDataConverterImpl const> implConv =
+           boost::dynamic_pointer_cast<IDataConverterImpl const>(conv);
+   if (!implSel || !implConv) {
+       ASKAPTHROW(DataAccessLogicError, "Incompatible selector and/or "<<
+                 "converter are received by the createConstIterator method");
+   }
+   return boost::shared_ptr<IConstDataIterator>(new MappedConstDataIterator(itsStore, implSel, implConv,
+                itsUVWCacheSize, itsUVWCacheTolerance));
+}
+
+/// create a selector object corresponding to this type of the
+/// DataSource
+///
+/// @return a shared pointer to the DataSelector corresponding to
+/// this type of DataSource.
+IDataSelectorPtr MappedConstDataSource::createSelector() const
+{
+  return IDataSelectorPtr(new MappedDataSelector);
+}
+
+/// @brief configure caching of the uvw-machines
+/// @details See TableConstDataSource::configureUVWMachineCache
+/// @param[in] cacheSize a number of uvw machines in the cache (default is 1)
+/// @param[in] tolerance pointing direction tolerance in radians, exceeding which leads
+/// to initialisation of a new UVW Machine
+void MappedConstDataSource::configureUVWMachineCache(size_t cacheSize, double tolerance)
+{
+  itsUVWCacheSize = cacheSize;
+  itsUVWCacheTolerance = tolerance;
+}
@@ -0,0 +1,113 @@
+/// @file
+/// @brief data source for the native memory-mapped visibility store
+/// @details This is an alternative to TableConstDataSource which reads the data converted
+/// into the native store (see MappedVisStore and MappedVisStoreWriter). The data are used
+/// directly from the mapped memory, avoiding per-row and per-column overheads of casacore
+/// tables, and any number of iterators (e.g. in different threads) can read the store at the
+/// same time as they share the read-only mapping.
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author agent <agent@local>
+///
+
+#ifndef ASKAP_ACCESSORS_MAPPED_CONST_DATA_SOURCE_H
+#define ASKAP_ACCESSORS_MAPPED_CONST_DATA_SOURCE_H
+
+// own includes
+#include <dataaccess/IConstDataSource.h>
+#include <dataaccess/MappedVisStore.h>
+
+// std includes
+#include <string>
+
+namespace askap {
+
+namespace accessors {
+
+/// @brief data source for the native memory-mapped visibility store
+/// @details Only read-only access is supported. See MappedDataSelector for the types of
+/// selection which are available.
+/// @ingroup dataaccess_hlp
+class MappedConstDataSource : virtual public IConstDataSource
+{
+public:
+  /// @brief open the store
+  /// @param[in] fname file name of the store
+  explicit MappedConstDataSource(const std::string &fname);
+
+  /// create a converter object corresponding to this type of the
+  /// DataSource. The user can change converting policies (units,
+  /// reference frames) by appropriate calls to this converter object
+  /// and pass it back to createConstIterator(...). The data returned by
+  /// the iterator will automatically be in the requested frame/units
+  ///
+  /// @return a shared pointer to a new DataConverter object
+  virtual IDataConverterPtr createConverter() const;
+
+  /// get iterator over a selected part of the dataset represented
+  /// by this DataSource object with an explicitly specified conversion
+  /// policy.
+  ///
+  /// @param[in] sel a shared pointer to the selector object defining
+  ///            which subset of the data is used
+  /// @param[in] conv a shared pointer to the converter object defining
+  ///            reference frames and units to be used
+  /// @return a shared pointer to DataIterator object
+  virtual boost::shared_ptr<IConstDataIterator> createConstIterator(const
+             IDataSelectorConstPtr &sel,
+             const IDataConverterConstPtr &conv) const;
+
+  // we need this to get access to the overloaded syntax in the base class
+  using IConstDataSource::createConstIterator;
+
+  /// create a selector object corresponding to this type of the
+  /// DataSource
+  ///
+  /// @return a shared pointer to the DataSelector corresponding to
+  /// this type of DataSource.
+  virtual IDataSelectorPtr createSelector() const;
+
+  /// @brief configure caching of the uvw-machines
+  /// @details See TableConstDataSource::configureUVWMachineCache
+  /// @param[in] cacheSize a number of uvw machines in the cache (default is 1)
+  /// @param[in] tolerance pointing direction tolerance in radians, exceeding which leads
+  /// to initialisation of a new UVW Machine
+  void configureUVWMachineCache(size_t cacheSize = 1, double tolerance = 1e-6);
+
+private:
+  /// @brief mapped store shared by all iterators
+  MappedVisStore::ShPtr itsStore;
+
+  /// @brief a number of uvw machines in the cache (default is 1)
+  size_t itsUVWCacheSize;
+
+  /// @brief pointing direction tolerance in radians (for uvw machine cache)
+  double itsUVWCacheTolerance;
+};
+
+} // namespace accessors
+
+} // namespace askap
+
+#endif // #ifndef ASKAP_ACCESSORS_MAPPED_CONST_DATA_SOURCE_H
@@ -0,0 +1,257 @@
+/// @file
+/// @brief selector for the native memory-mapped visibility store
+/// @details The selection is applied by MappedConstDataIterator chunk by chunk and row by row.
+/// Only the selections which can be done without touching the visibilities are supported.
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author agent <agent@local>
+///
+
+#include <dataaccess/MappedDataSelector.h>
+#include <dataaccess/DataAccessError.h>
+#include <askap/AskapError.h>
+
+// std includes
+#include <cmath>
+
+using namespace askap;
+using namespace askap::accessors;
+
+/// @brief construct an empty selection
+MappedDataSelector::MappedDataSelector() : itsFeed(-1), itsAnt1(-1), itsAnt2(-1), itsAutoOnly(false),
+      itsCrossOnly(false), itsMinUVDistance(-1.), itsMaxUVDistance(-1.), itsNChannel(0), itsStartChannel(0),
+      itsUTCRangeSelected(false), itsTimeRangeSelected(false), itsStartTime(0.), itsStopTime(0.),
+      itsCyclesSelected(false), itsStartCycle(0), itsStopCycle(0) {}
+
+/// Choose a single feed, the same for both antennae
+/// @param[in] feedID the sequence number of feed to choose
+void MappedDataSelector::chooseFeed(casa::uInt feedID)
+{
+  itsFeed = int(feedID);
+}
+
+/// Choose a single baseline
+/// @param[in] ant1 the sequence number of the first antenna
+/// @param[in] ant2 the sequence number of the second antenna
+/// Which one is the first and which is the second is not important
+void MappedDataSelector::chooseBaseline(casa::uInt ant1, casa::uInt ant2)
+{
+  itsAnt1 = int(ant1);
+  itsAnt2 = int(ant2);
+}
+
+/// @brief choose user-defined index
+/// @details Not supported by this selector
+/// @param[in] column column name in the measurement set for a user-defined index
+void MappedDataSelector::chooseUserDefinedIndex(const std::string &column, const casa::uInt)
+{
+  notSupported("Selection by user-defined index ("+column+")");
+}
+
+/// @brief Choose autocorrelations only
+void MappedDataSelector::chooseAutoCorrelations()
+{
+  itsAutoOnly = true;
+  itsCrossOnly = false;
+}
+
+/// @brief Choose crosscorrelations only
+void MappedDataSelector::chooseCrossCorrelations()
+{
+  itsCrossOnly = true;
+  itsAutoOnly = false;
+}
+
+/// @brief Choose samples corresponding to a uv-distance larger than threshold
+/// @param[in] uvDist threshold (in metres)
+void MappedDataSelector::chooseMinUVDistance(casa::Double uvDist)
+{
+  itsMinUVDistance = uvDist;
+}
+
+/// @brief Choose samples corresponding to a uv-distance smaller than threshold
+/// @param[in] uvDist threshold (in metres)
+void MappedDataSelector::chooseMaxUVDistance(casa::Double uvDist)
+{
+  itsMaxUVDistance = uvDist;
+}
+
+/// Choose a subset of spectral channels
+/// @param[in] nChan a number of spectral channels wanted in the output
+/// @param[in] start the number of the first spectral channel to choose
+/// @param[in] nAvg a number of adjacent spectral channels to average
+///             (only 1 is supported)
+void MappedDataSelector::chooseChannels(casa::uInt nChan, casa::uInt start, casa::uInt nAvg)
+{
+  if (nAvg != 1) {
+      notSupported("Averaging of channels");
+  }
+  ASKAPCHECK(nChan > 0, "At least one channel should be selected");
+  itsNChannel = nChan;
+  itsStartChannel = start;
+}
+
+/// Choose a subset of frequencies
+/// @details Not supported by this selector
+void MappedDataSelector::chooseFrequencies(casa::uInt, const casa::MVFrequency &, const casa::MVFrequency &)
+{
+  notSupported("Selection by frequency");
+}
+
+/// Choose a subset of radial velocities
+/// @details Not supported by this selector
+void MappedDataSelector::chooseVelocities(casa::uInt, const casa::MVRadialVelocity &,
+                                          const casa::MVRadialVelocity &)
+{
+  notSupported("Selection by velocity");
+}
+
+/// Choose a single spectral window (also known as IF).
+/// @details The store always has a single spectral window, so only 0 is allowed
+/// @param[in] spWinID the ID of the spectral window to choose
+void MappedDataSelector::chooseSpectralWindow(casa::uInt spWinID)
+{
+  if (spWinID != 0) {
+      ASKAPTHROW(DataAccessLogicError, "Memory-mapped visibility store has only one spectral window, "
+                 "you requested spectral window "<<spWinID);
+  }
+}
+
+/// Choose a time range given as absolute epochs (UTC)
+/// @param[in] start the beginning of the chosen time interval
+/// @param[in] stop  the end of the chosen time interval
+void MappedDataSelector::chooseTimeRange(const casa::MVEpoch &start, const casa::MVEpoch &stop)
+{
+  itsUTCRangeSelected = true;
+  itsTimeRangeSelected = false;
+  itsStartTime = start.getTime("s").getValue();
+  itsStopTime = stop.getTime("s").getValue();
+}
+
+/// Choose time range with respect to the origin defined by the converter
+/// @param[in] start the beginning of the chosen time interval
+/// @param[in] stop the end of the chosen time interval
+void MappedDataSelector::chooseTimeRange(casa::Double start, casa::Double stop)
+{
+  itsTimeRangeSelected = true;
+  itsUTCRangeSelected = false;
+  itsStartTime = start;
+  itsStopTime = stop;
+}
+
+/// Choose polarization.
+/// @details Not supported by this selector
+/// @param pols a string describing the wanted polarization
+void MappedDataSelector::choosePolarizations(const casa::String &pols)
+{
+  notSupported("Selection of polarisation products ("+pols+")");
+}
+
+/// Choose cycles, i.e. chunks of the store
+/// @param[in] start the number of the first cycle to choose
+/// @param[in] stop the number of the last cycle to choose
+void MappedDataSelector::chooseCycles(casa::uInt start, casa::uInt stop)
+{
+  itsCyclesSelected = true;
+  itsStartCycle = start;
+  itsStopCycle = stop;
+}
+
+/// Choose a single scan number
+/// @details Not supported by this selector
+void MappedDataSelector::chooseScanNumber(casa::uInt)
+{
+  notSupported("Selection by scan number");
+}
+
+/// @brief check whether the cycle is selected
+/// @param[in] cycle chunk number in the store
+/// @param[in] utcTime time of the chunk in seconds since MJD 0 UTC
+/// @param[in] time time of the chunk in the frame of the converter
+/// @return true if the chunk passes the selection by time and cycle
+bool MappedDataSelector::cycleSelected(size_t cycle, casa::Double utcTime, casa::Double time) const
+{
+  if (itsCyclesSelected && ((cycle < itsStartCycle) || (cycle > itsStopCycle))) {
+      return false;
+  }
+  if (itsUTCRangeSelected && ((utcTime < itsStartTime) || (utcTime > itsStopTime))) {
+      return false;
+  }
+  if (itsTimeRangeSelected && ((time < itsStartTime) || (time > itsStopTime))) {
+      return false;
+  }
+  return true;
+}
+
+/// @brief check whether any selection by rows is done
+/// @return true if rows may be rejected by rowSelected
+bool MappedDataSelector::rowsSelected() const
+{
+  return (itsFeed >= 0) || (itsAnt1 >= 0) || itsAutoOnly || itsCrossOnly || (itsMinUVDistance >= 0.) ||
+         (itsMaxUVDistance >= 0.);
+}
+
+/// @brief check whether the given row is selected
+/// @param[in] ant1 first antenna
+/// @param[in] ant2 second antenna
+/// @param[in] feed1 first feed
+/// @param[in] feed2 second feed
+/// @param[in] uvw pointer to u, v and w of the row (in metres)
+/// @return true if the row passes the selection
+bool MappedDataSelector::rowSelected(casa::uInt ant1, casa::uInt ant2, casa::uInt feed1, casa::uInt feed2,
+                                     const double *uvw) const
+{
+  if ((itsFeed >= 0) && ((int(feed1) != itsFeed) || (int(feed2) != itsFeed))) {
+      return false;
+  }
+  if (itsAnt1 >= 0) {
+      const bool sameOrder = (int(ant1) == itsAnt1) && (int(ant2) == itsAnt2);
+      const bool swapped = (int(ant1) == itsAnt2) && (int(ant2) == itsAnt1);
+      if (!sameOrder && !swapped) {
+          return false;
+      }
+  }
+  if ((itsAutoOnly && (ant1 != ant2)) || (itsCrossOnly && (ant1 == ant2))) {
+      return false;
+  }
+  if ((itsMinUVDistance >= 0.) || (itsMaxUVDistance >= 0.)) {
+      ASKAPDEBUGASSERT(uvw != NULL);
+      const double uvDist = std::sqrt(uvw[0] * uvw[0] + uvw[1] * uvw[1]);
+      if ((itsMinUVDistance >= 0.) && (uvDist < itsMinUVDistance)) {
+          return false;
+      }
+      if ((itsMaxUVDistance >= 0.) && (uvDist > itsMaxUVDistance)) {
+          return false;
+      }
+  }
+  return true;
+}
+
+/// @brief throw an exception about the unsupported selection
+/// @param[in] what type of selection
+void MappedDataSelector::notSupported(const std::string &what)
+{
+  ASKAPTHROW(DataAccessLogicError, what<<" is not supported by the memory-mapped visibility store, "
+             "use the measurement set instead");
+}
@@ -0,0 +1,234 @@
+/// @file
+/// @brief selector for the native memory-mapped visibility store
+/// @details The selection is applied by MappedConstDataIterator chunk by chunk and row by row.
+/// Only the selections which can be done without touching the visibilities are supported.
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author agent <agent@local>
+///
+
+#ifndef ASKAP_ACCESSORS_MAPPED_DATA_SELECTOR_H
+#define ASKAP_ACCESSORS_MAPPED_DATA_SELECTOR_H
+
+// own includes
+#include <dataaccess/IDataSelector.h>
+
+// casa includes
+#include <casa/aips.h>
+#include <casa/Quanta/MVEpoch.h>
+#include <casa/Quanta/MVFrequency.h>
+#include <casa/Quanta/MVRadialVelocity.h>
+
+// std includes
+#include <string>
+
+namespace askap {
+
+namespace accessors {
+
+/// @brief selector for the native memory-mapped visibility store
+/// @details Selection by feed, baseline, auto/cross-correlations, uv-distance, channel range,
+/// time range and cycles (i.e. chunks of the store) is supported. Other types of selection
+/// (as well as channel averaging) cause DataAccessLogicError, use the table-based data source
+/// if they are required. Time range given as MVEpoch is interpreted as UTC.
+/// @ingroup dataaccess_hlp
+class MappedDataSelector : virtual public IDataSelector
+{
+public:
+  /// @brief construct an empty selection
+  MappedDataSelector();
+
+  /// Choose a single feed, the same for both antennae
+  /// @param[in] feedID the sequence number of feed to choose
+  virtual void chooseFeed(casa::uInt feedID);
+
+  /// Choose a single baseline
+  /// @param[in] ant1 the sequence number of the first antenna
+  /// @param[in] ant2 the sequence number of the second antenna
+  /// Which one is the first and which is the second is not important
+  virtual void chooseBaseline(casa::uInt ant1, casa::uInt ant2);
+
+  /// @brief choose user-defined index
+  /// @details Not supported by this selector
+  /// @param[in] column column name in the measurement set for a user-defined index
+  /// @param[in] value index value
+  virtual void chooseUserDefinedIndex(const std::string &column, const casa::uInt value);
+
+  /// @brief Choose autocorrelations only
+  virtual void chooseAutoCorrelations();
+
+  /// @brief Choose crosscorrelations only
+  virtual void chooseCrossCorrelations();
+
+  /// @brief Choose samples corresponding to a uv-distance larger than threshold
+  /// @param[in] uvDist threshold (in metres)
+  virtual void chooseMinUVDistance(casa::Double uvDist);
+
+  /// @brief Choose samples corresponding to a uv-distance smaller than threshold
+  /// @param[in] uvDist threshold (in metres)
+  virtual void chooseMaxUVDistance(casa::Double uvDist);
+
+  /// Choose a subset of spectral channels
+  /// @param[in] nChan a number of spectral channels wanted in the output
+  /// @param[in] start the number of the first spectral channel to choose
+  /// @param[in] nAvg a number of adjacent spectral channels to average
+  ///             (only 1 is supported)
+  virtual void chooseChannels(casa::uInt nChan, casa::uInt start, casa::uInt nAvg = 1);
+
+  /// Choose a subset of frequencies
+  /// @details Not supported by this selector
+  /// @param[in] nChan a number of spectral channels wanted in the output
+  /// @param[in] start the frequency of the first spectral channel to choose
+  /// @param[in] freqInc an increment in terms of the frequency
+  virtual void chooseFrequencies(casa::uInt nChan, const casa::MVFrequency &start,
+                                 const casa::MVFrequency &freqInc);
+
+  /// Choose a subset of radial velocities
+  /// @details Not supported by this selector
+  /// @param[in] nChan a number of spectral channels wanted in the output
+  /// @param[in] start the velocity of the first spectral channel to choose
+  /// @param[in] velInc an increment in terms of the radial velocity
+  virtual void chooseVelocities(casa::uInt nChan, const casa::MVRadialVelocity &start,
+                                const casa::MVRadialVelocity &velInc);
+
+  /// Choose a single spectral window (also known as IF).
+  /// @details The store always has a single spectral window, so only 0 is allowed
+  /// @param[in] spWinID the ID of the spectral window to choose
+  virtual void chooseSpectralWindow(casa::uInt spWinID);
+
+  /// Choose a time range given as absolute epochs (UTC)
+  /// @param[in] start the beginning of the chosen time interval
+  /// @param[in] stop  the end of the chosen time interval
+  virtual void chooseTimeRange(const casa::MVEpoch &start, const casa::MVEpoch &stop);
+
+  /// Choose time range with respect to the origin defined by the converter
+  /// @param[in] start the beginning of the chosen time interval
+  /// @param[in] stop the end of the chosen time interval
+  virtual void chooseTimeRange(casa::Double start, casa::Double stop);
+
+  /// Choose polarization.
+  /// @details Not supported by this selector
+  /// @param pols a string describing the wanted polarization
+  virtual void choosePolarizations(const casa::String &pols);
+
+  /// Choose cycles, i.e. chunks of the store
+  /// @param[in] start the number of the first cycle to choose
+  /// @param[in] stop the number of the last cycle to choose
+  virtual void chooseCycles(casa::uInt start, casa::uInt stop);
+
+  /// Choose a single scan number
+  /// @details Not supported by this selector
+  /// @param[in] scanNumber the scan number to choose
+  virtual void chooseScanNumber(casa::uInt scanNumber);
+
+  /// @brief check whether the cycle is selected
+  /// @param[in] cycle chunk number in the store
+  /// @param[in] utcTime time of the chunk in seconds since MJD 0 UTC
+  /// @param[in] time time of the chunk in the frame of the converter
+  /// @return true if the chunk passes the selection by time and cycle
+  bool cycleSelected(size_t cycle, casa::Double utcTime, casa::Double time) const;
+
+  /// @brief check whether any selection by rows is done
+  /// @return true if rows may be rejected by rowSelected
+  bool rowsSelected() const;
+
+  /// @brief check whether the given row is selected
+  /// @param[in] ant1 first antenna
+  /// @param[in] ant2 second antenna
+  /// @param[in] feed1 first feed
+  /// @param[in] feed2 second feed
+  /// @param[in] uvw pointer to u, v and w of the row (in metres)
+  /// @return true if the row passes the selection
+  bool rowSelected(casa::uInt ant1, casa::uInt ant2, casa::uInt feed1, casa::uInt feed2,
+                   const double *uvw) const;
+
+  /// @brief check whether a subset of channels is selected
+  /// @return true if channels are selected
+  inline bool channelsSelected() const { return itsNChannel > 0; }
+
+  /// @return number of selected channels (zero means all)
+  inline casa::uInt nChannel() const { return itsNChannel; }
+
+  /// @return first selected channel
+  inline casa::uInt startChannel() const { return itsStartChannel; }
+
+private:
+  /// @brief throw an exception about the unsupported selection
+  /// @param[in] what type of selection
+  static void notSupported(const std::string &what);
+
+  /// @brief selected feed (negative value means no selection)
+  int itsFeed;
+
+  /// @brief first antenna of the selected baseline (negative value means no selection)
+  int itsAnt1;
+
+  /// @brief second antenna of the selected baseline (negative value means no selection)
+  int itsAnt2;
+
+  /// @brief true if only autocorrelations are selected
+  bool itsAutoOnly;
+
+  /// @brief true if only cross-correlations are selected
+  bool itsCrossOnly;
+
+  /// @brief minimum uv-distance (negative value means no selection)
+  casa::Double itsMinUVDistance;
+
+  /// @brief maximum uv-distance (negative value means no selection)
+  casa::Double itsMaxUVDistance;
+
+  /// @brief number of selected channels (zero means all)
+  casa::uInt itsNChannel;
+
+  /// @brief first selected channel
+  casa::uInt itsStartChannel;
+
+  /// @brief true if the time range is selected as absolute UTC epochs
+  bool itsUTCRangeSelected;
+
+  /// @brief true if the time range is selected in the frame of the converter
+  bool itsTimeRangeSelected;
+
+  /// @brief start of the selected time range
+  casa::Double itsStartTime;
+
+  /// @brief end of the selected time range
+  casa::Double itsStopTime;
+
+  /// @brief true if cycles are selected
+  bool itsCyclesSelected;
+
+  /// @brief first selected cycle
+  casa::uInt itsStartCycle;
+
+  /// @brief last selected cycle
+  casa::uInt itsStopCycle;
+};
+
+} // namespace accessors
+
+} // namespace askap
+
+#endif // #ifndef ASKAP_ACCESSORS_MAPPED_DATA_SELECTOR_H
@@ -0,0 +1,196 @@
+/// @file
+/// @brief native memory-mapped visibility store
+/// @details The store is a simple binary file with visibilities, flags, noise, uvw and the
+/// per-row metadata of consecutive accessor chunks (one chunk per integration). Each chunk is
+/// laid out exactly like the cubes of the accessor (row index changes fastest, then channel,
+/// then polarisation), so the data are obtained from the mapped memory by a block copy without
+/// the per-row overheads of casacore tables. This file defines the layout of the store
+/// and the read-only access to it. See MappedVisStoreWriter for the way to create the store.
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author agent <agent@local>
+///
+
+#include <dataaccess/MappedVisStore.h>
+#include <dataaccess/DataAccessError.h>
+#include <askap/AskapError.h>
+
+// casa includes
+#include <casa/Arrays/IPosition.h>
+#include <casa/Quanta/MVPosition.h>
+
+// system includes
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+
+using namespace askap;
+using namespace askap::accessors;
+
+/// @brief magic string identifying the format
+const char* MappedVisStore::theirMagic = "ASKAPVIS";
+
+/// @brief compute offsets for the given shape
+/// @param[in] nRow number of rows
+/// @param[in] nChannel number of spectral channels
+/// @param[in] nPol number of polarisation products
+MappedVisStore::ChunkLayout::ChunkLayout(size_t nRow, size_t nChannel, size_t nPol)
+{
+  const size_t nElements = nRow * nChannel * nPol;
+  visibility = 0;
+  noise = visibility + align(nElements * sizeof(casa::Complex));
+  flag = noise + align(nElements * sizeof(casa::Complex));
+  uvw = flag + align(nElements * sizeof(casa::Bool));
+  antenna1 = uvw + align(nRow * 3 * sizeof(double));
+  antenna2 = antenna1 + align(nRow * sizeof(uint32_t));
+  feed1 = antenna2 + align(nRow * sizeof(uint32_t));
+  feed2 = feed1 + align(nRow * sizeof(uint32_t));
+  feed1PA = feed2 + align(nRow * sizeof(uint32_t));
+  feed2PA = feed1PA + align(nRow * sizeof(float));
+  pointingDir1 = feed2PA + align(nRow * sizeof(float));
+  pointingDir2 = pointingDir1 + align(nRow * 2 * sizeof(double));
+  dishPointing1 = pointingDir2 + align(nRow * 2 * sizeof(double));
+  dishPointing2 = dishPointing1 + align(nRow * 2 * sizeof(double));
+  size = dishPointing2 + align(nRow * 2 * sizeof(double));
+}
+
+/// @brief map the given file
+/// @details An exception is thrown if the file can't be mapped or is not a valid store
+/// @param[in] fname file name
+MappedVisStore::MappedVisStore(const std::string &fname) : itsName(fname), itsData(NULL), itsSize(0),
+          itsIndex(NULL)
+{
+  // the layout relies on the representation of the casa types
+  ASKAPCHECK(sizeof(casa::Bool) == 1, "MappedVisStore requires one byte casa::Bool");
+  ASKAPCHECK(sizeof(casa::Complex) == 2 * sizeof(float), "MappedVisStore requires casa::Complex to be two floats");
+  ASKAPCHECK(sizeof(casa::uInt) == sizeof(uint32_t), "MappedVisStore requires 32-bit casa::uInt");
+
+  const int fd = open(fname.c_str(), O_RDONLY);
+  if (fd < 0) {
+      ASKAPTHROW(DataAccessError, "Unable to open visibility store "<<fname<<": "<<strerror(errno));
+  }
+  struct stat info;
+  if (fstat(fd, &info) != 0) {
+      const int err = errno;
+      close(fd);
+      ASKAPTHROW(DataAccessError, "Unable to stat visibility store "<<fname<<": "<<strerror(err));
+  }
+  itsSize = size_t(info.st_size);
+  if (itsSize < sizeof(Header)) {
+      close(fd);
+      ASKAPTHROW(DataAccessError, "File "<<fname<<" is too short to be a visibility store");
+  }
+  // the data are copied out of the mapping by the iterator, so it can be read-only
+  void *addr = mmap(NULL, itsSize, PROT_READ, MAP_PRIVATE, fd, 0);
+  const int err = errno;
+  close(fd);
+  if (addr == MAP_FAILED) {
+      ASKAPTHROW(DataAccessError, "Unable to map visibility store "<<fname<<": "<<strerror(err));
+  }
+  itsData = static_cast<char*>(addr);
+  // the data are usually accessed in order
+  madvise(addr, itsSize, MADV_SEQUENTIAL);
+
+  try {
+     const Header &hdr = header();
+     if (strncmp(hdr.magic, theirMagic, sizeof(hdr.magic)) != 0) {
+         ASKAPTHROW(DataAccessError, "File "<<fname<<" is not a visibility store");
+     }
+     if (hdr.byteOrder != 0x01020304) {
+         ASKAPTHROW(DataAccessError, "Visibility store "<<fname<<" has been written on a machine with a different byte order");
+     }
+     if (hdr.version != theirVersion) {
+         ASKAPTHROW(DataAccessError, "Visibility store "<<fname<<" has version "<<hdr.version<<
+                    ", only version "<<theirVersion<<" is supported");
+     }
+     if ((hdr.nPol == 0) || (hdr.nPol > 4) || (hdr.nChannel == 0)) {
+         ASKAPTHROW(DataAccessError, "Visibility store "<<fname<<" has bad shape: nChannel="<<hdr.nChannel<<
+                    " nPol="<<hdr.nPol);
+     }
+     if ((align(sizeof(Header)) + hdr.nChannel * sizeof(double) > itsSize) ||
+         (hdr.indexOffset + hdr.nChunks * sizeof(IndexEntry) > itsSize)) {
+         ASKAPTHROW(DataAccessError, "Visibility store "<<fname<<" is truncated");
+     }
+     // copy the frequency axis, so the vectors referring to it never outlive the mapping
+     itsFrequencies.takeStorage(casa::IPosition(1, hdr.nChannel), reinterpret_cast<const casa::Double*>(itsData +
+                    align(sizeof(Header))));
+     itsStokes.resize(hdr.nPol);
+     for (casa::uInt pol = 0; pol < hdr.nPol; ++pol) {
+          itsStokes[pol] = casa::Stokes::StokesTypes(hdr.stokes[pol]);
+     }
+     itsIndex = reinterpret_cast<const IndexEntry*>(itsData + hdr.indexOffset);
+     for (size_t ch = 0; ch < nChunks(); ++ch) {
+          const ChunkLayout layout(size_t(itsIndex[ch].nRow), hdr.nChannel, hdr.nPol);
+          if (itsIndex[ch].offset + layout.size > hdr.indexOffset) {
+              ASKAPTHROW(DataAccessError, "Visibility store "<<fname<<" has corrupted index (chunk "<<ch<<")");
+          }
+     }
+  }
+  catch (...) {
+     munmap(itsData, itsSize);
+     throw;
+  }
+}
+
+/// @brief unmap the file
+MappedVisStore::~MappedVisStore()
+{
+  ASKAPDEBUGASSERT(itsData != NULL);
+  munmap(itsData, itsSize);
+}
+
+/// @return reference frame of frequencies
+casa::MFrequency::Ref MappedVisStore::frequencyFrame() const
+{
+  return casa::MFrequency::Ref(casa::MFrequency::Types(header().frequencyFrame));
+}
+
+/// @return position of the array used for frame conversions
+casa::MPosition MappedVisStore::position() const
+{
+  const Header &hdr = header();
+  return casa::MPosition(casa::MVPosition(hdr.position[0], hdr.position[1], hdr.position[2]),
+                         casa::MPosition::ITRF);
+}
+
+/// @brief pointer to the start of the chunk
+/// @details Offsets of the individual arrays are given by ChunkLayout
+/// @param[in] chunk chunk number
+/// @return pointer to the first byte of the chunk
+const char* MappedVisStore::chunk(size_t chunk) const
+{
+  return itsData + index(chunk).offset;
+}
+
+/// @param[in] chunk chunk number
+/// @return index entry for the given chunk
+const MappedVisStore::IndexEntry& MappedVisStore::index(size_t chunk) const
+{
+  ASKAPDEBUGASSERT(chunk < nChunks());
+  ASKAPDEBUGASSERT(itsIndex != NULL);
+  return itsIndex[chunk];
+}
@@ -0,0 +1,253 @@
+/// @file
+/// @brief native memory-mapped visibility store
+/// @details The store is a simple binary file with visibilities, flags, noise, uvw and the
+/// per-row metadata of consecutive accessor chunks (one chunk per integration). Each chunk is
+/// laid out exactly like the cubes of the accessor (row index changes fastest, then channel,
+/// then polarisation), so the data can be used directly from the mapped memory without any
+/// copying or per-row overheads of casacore tables. This file defines the layout of the store
+/// and the read-only access to it. See MappedVisStoreWriter for the way to create the store.
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author agent <agent@local>
+///
+
+#ifndef ASKAP_ACCESSORS_MAPPED_VIS_STORE_H
+#define ASKAP_ACCESSORS_MAPPED_VIS_STORE_H
+
+// casa includes
+#include <casa/aips.h>
+#include <casa/BasicSL/Complex.h>
+#include <casa/Arrays/Vector.h>
+#include <measures/Measures/MPosition.h>
+#include <measures/Measures/MFrequency.h>
+#include <measures/Measures/Stokes.h>
+
+// boost includes
+#include <boost/shared_ptr.hpp>
+
+// std includes
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+namespace askap {
+
+namespace accessors {
+
+/// @brief native memory-mapped visibility store
+/// @details The file starts with a fixed size header followed by the frequency axis, chunks
+/// of data and the index of chunks (at the very end of the file). All blocks are aligned to
+/// 8 bytes. Each chunk contains the following arrays (see ChunkLayout for offsets):
+/// @li visibilities (nPol x nChannel x nRow complex numbers, row index changes fastest)
+/// @li noise (the same shape as visibilities)
+/// @li flags (the same shape as visibilities, one byte per flag)
+/// @li uvw (3 doubles per row)
+/// @li antenna and feed indices (4 unsigned integers per row)
+/// @li feed position angles (2 floats per row)
+/// @li pointing directions of both feeds and both dish centres in J2000 (8 doubles per row)
+///
+/// The time of each chunk (in seconds since MJD 0 UTC) and the number of rows are stored in
+/// the index, so the selection by time doesn't need to touch the data. All chunks share the
+/// same frequency axis and polarisation products. The store is a native format, i.e. the
+/// data are written in the byte order and representation of the machine that wrote them,
+/// which is checked when the file is opened.
+///
+/// The file is mapped read-only. The data are copied out of the mapping by the iterator
+/// (casa arrays can't keep the mapping alive), so the arrays given to the user never refer
+/// to the mapped memory.
+/// @ingroup dataaccess_hlp
+class MappedVisStore {
+public:
+  /// @brief file header
+  struct Header {
+     /// @brief magic string identifying the format
+     char magic[8];
+     /// @brief byte order marker (should be equal to 0x01020304)
+     uint32_t byteOrder;
+     /// @brief version of the format
+     uint32_t version;
+     /// @brief number of spectral channels
+     uint32_t nChannel;
+     /// @brief number of polarisation products
+     uint32_t nPol;
+     /// @brief frequency reference frame (casa::MFrequency::Types)
+     uint32_t frequencyFrame;
+     /// @brief polarisation products (casa::Stokes::StokesTypes, only nPol are used)
+     uint32_t stokes[4];
+     /// @brief padding to keep the following fields aligned
+     uint32_t reserved;
+     /// @brief number of chunks in the file
+     uint64_t nChunks;
+     /// @brief offset of the chunk index in bytes
+     uint64_t indexOffset;
+     /// @brief ITRF position of the array (x,y,z in metres) used in frame conversions
+     double position[3];
+  };
+
+  /// @brief entry of the chunk index
+  struct IndexEntry {
+     /// @brief offset of the chunk in bytes
+     uint64_t offset;
+     /// @brief time of the chunk in seconds since MJD 0 UTC
+     double time;
+     /// @brief number of rows in the chunk
+     uint64_t nRow;
+  };
+
+  /// @brief offsets of the individual arrays within a chunk
+  struct ChunkLayout {
+     /// @brief compute offsets for the given shape
+     /// @param[in] nRow number of rows
+     /// @param[in] nChannel number of spectral channels
+     /// @param[in] nPol number of polarisation products
+     ChunkLayout(size_t nRow, size_t nChannel, size_t nPol);
+
+     /// @brief offset of visibilities
+     size_t visibility;
+     /// @brief offset of noise
+     size_t noise;
+     /// @brief offset of flags
+     size_t flag;
+     /// @brief offset of uvw
+     size_t uvw;
+     /// @brief offset of the first antenna indices
+     size_t antenna1;
+     /// @brief offset of the second antenna indices
+     size_t antenna2;
+     /// @brief offset of the first feed indices
+     size_t feed1;
+     /// @brief offset of the second feed indices
+     size_t feed2;
+     /// @brief offset of the position angles of the first feed
+     size_t feed1PA;
+     /// @brief offset of the position angles of the second feed
+     size_t feed2PA;
+     /// @brief offset of the pointing directions of the first feed
+     size_t pointingDir1;
+     /// @brief offset of the pointing directions of the second feed
+     size_t pointingDir2;
+     /// @brief offset of the pointing directions of the first dish
+     size_t dishPointing1;
+     /// @brief offset of the pointing directions of the second dish
+     size_t dishPointing2;
+     /// @brief total size of the chunk in bytes
+     size_t size;
+  };
+
+  /// @brief shared pointer type
+  typedef boost::shared_ptr<const MappedVisStore> ShPtr;
+
+  /// @brief magic string identifying the format
+  static const char* theirMagic;
+
+  /// @brief current version of the format
+  static const uint32_t theirVersion = 1;
+
+  /// @brief round up the size to the alignment of blocks in the file
+  /// @param[in] size size in bytes
+  /// @return size rounded up to a multiple of 8 bytes
+  static inline size_t align(size_t size) { return (size + 7) & ~size_t(7); }
+
+  /// @brief map the given file
+  /// @details An exception is thrown if the file can't be mapped or is not a valid store
+  /// @param[in] fname file name
+  explicit MappedVisStore(const std::string &fname);
+
+  /// @brief unmap the file
+  ~MappedVisStore();
+
+  /// @return file name
+  inline const std::string& name() const { return itsName; }
+
+  /// @return number of chunks in the store
+  inline size_t nChunks() const { return size_t(header().nChunks); }
+
+  /// @return number of spectral channels
+  inline casa::uInt nChannel() const { return header().nChannel; }
+
+  /// @return number of polarisation products
+  inline casa::uInt nPol() const { return header().nPol; }
+
+  /// @param[in] chunk chunk number
+  /// @return number of rows in the given chunk
+  inline casa::uInt nRow(size_t chunk) const { return casa::uInt(index(chunk).nRow); }
+
+  /// @param[in] chunk chunk number
+  /// @return time of the given chunk in seconds since MJD 0 UTC
+  inline double time(size_t chunk) const { return index(chunk).time; }
+
+  /// @return frequencies of all channels (in Hz)
+  inline const casa::Vector<casa::Double>& frequencies() const { return itsFrequencies; }
+
+  /// @return reference frame of frequencies
+  casa::MFrequency::Ref frequencyFrame() const;
+
+  /// @return polarisation products
+  inline const casa::Vector<casa::Stokes::StokesTypes>& stokes() const { return itsStokes; }
+
+  /// @return position of the array used for frame conversions
+  casa::MPosition position() const;
+
+  /// @brief pointer to the start of the chunk
+  /// @details Offsets of the individual arrays are given by ChunkLayout
+  /// @param[in] chunk chunk number
+  /// @return pointer to the first byte of the chunk
+  const char* chunk(size_t chunk) const;
+
+private:
+  /// @return header of the mapped file
+  inline const Header& header() const { return *reinterpret_cast<const Header*>(itsData); }
+
+  /// @param[in] chunk chunk number
+  /// @return index entry for the given chunk
+  const IndexEntry& index(size_t chunk) const;
+
+  /// @brief file name
+  std::string itsName;
+
+  /// @brief start of the mapped memory
+  char *itsData;
+
+  /// @brief size of the mapped memory
+  size_t itsSize;
+
+  /// @brief chunk index (refers to the mapped memory)
+  const IndexEntry *itsIndex;
+
+  /// @brief frequency axis (copied from the mapped memory)
+  casa::Vector<casa::Double> itsFrequencies;
+
+  /// @brief polarisation products
+  casa::Vector<casa::Stokes::StokesTypes> itsStokes;
+
+  // no support for copy or assignment
+  MappedVisStore(const MappedVisStore&);
+  MappedVisStore& operator=(const MappedVisStore&);
+};
+
+} // namespace accessors
+
+} // namespace askap
+
+#endif // #ifndef ASKAP_ACCESSORS_MAPPED_VIS_STORE_H
@@ -0,0 +1,252 @@
+/// @file
+/// @brief writer of the native memory-mapped visibility store
+/// @details This class converts the data delivered by any accessor (e.g. from a measurement
+/// set via TableConstDataSource or directly from the ingest pipeline) into the native store
+/// described in MappedVisStore, which can be read back by MappedConstDataSource.
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author agent <agent@local>
+///
+
+#include <askap_accessors.h>
+#include <askap/AskapLogging.h>
+#include <askap/AskapError.h>
+
+#include <dataaccess/MappedVisStoreWriter.h>
+#include <dataaccess/DataAccessError.h>
+
+// casa includes
+#include <casa/Arrays/Array.h>
+#include <casa/Quanta/MVPosition.h>
+#include <casa/Quanta/Quantum.h>
+#include <measures/Measures/MCPosition.h>
+#include <measures/Measures/MEpoch.h>
+#include <measures/Measures/MDirection.h>
+
+// std includes
+#include <cstring>
+#include <cmath>
+#include <exception>
+
+ASKAP_LOGGER(logger, ".dataaccess");
+
+namespace askap {
+
+namespace accessors {
+
+/// @brief create the file
+/// @param[in] fname file name (an existing file is overwritten)
+/// @param[in] position position of the array used for frame conversions when the data are read
+/// @param[in] frame frequency reference frame of the data (default is TOPO)
+MappedVisStoreWriter::MappedVisStoreWriter(const std::string &fname, const casa::MPosition &position,
+                       const casa::MFrequency::Ref &frame) :
+          itsStream(fname.c_str(), std::ios::binary | std::ios::trunc), itsName(fname), itsOffset(0), itsClosed(false)
+{
+  if (!itsStream) {
+      ASKAPTHROW(DataAccessError, "Unable to create visibility store "<<fname);
+  }
+  memset(&itsHeader, 0, sizeof(itsHeader));
+  memcpy(itsHeader.magic, MappedVisStore::theirMagic, sizeof(itsHeader.magic));
+  itsHeader.byteOrder = 0x01020304;
+  itsHeader.version = MappedVisStore::theirVersion;
+  itsHeader.frequencyFrame = frame.getType();
+  const casa::Vector<casa::Double> xyz =
+        casa::MPosition::Convert(position, casa::MPosition::ITRF)().getValue().getValue();
+  ASKAPDEBUGASSERT(xyz.nelements() == 3);
+  for (casa::uInt dim = 0; dim < 3; ++dim) {
+       itsHeader.position[dim] = xyz[dim];
+  }
+}
+
+/// @brief close the file if it hasn't been closed
+/// @details Errors are reported to the log, call close explicitly to get an exception.
+MappedVisStoreWriter::~MappedVisStoreWriter()
+{
+  if (!itsClosed) {
+      try {
+         close();
+      }
+      catch (const std::exception &ex) {
+         ASKAPLOG_ERROR_STR(logger, "Unable to finalise visibility store "<<itsName<<": "<<ex.what());
+      }
+  }
+}
+
+/// @brief configure the converter to deliver data in the frames of the store
+/// @param[in] conv converter of the source to set up
+void MappedVisStoreWriter::setupConverter(IDataConverter &conv) const
+{
+  conv.setEpochFrame(casa::MEpoch(casa::Quantity(0.,"d"), casa::MEpoch::Ref(casa::MEpoch::UTC)), "s");
+  conv.setDirectionFrame(casa::MDirection::Ref(casa::MDirection::J2000));
+  conv.setFrequencyFrame(casa::MFrequency::Ref(casa::MFrequency::Types(itsHeader.frequencyFrame)), "Hz");
+}
+
+/// @brief append one chunk
+/// @param[in] acc accessor with the data to write
+void MappedVisStoreWriter::append(const IConstDataAccessor &acc)
+{
+  ASKAPCHECK(!itsClosed, "Visibility store "<<itsName<<" has already been closed");
+  if (itsIndex.size() == 0) {
+      // the first chunk defines the frequency axis and polarisation products
+      ASKAPCHECK((acc.nPol() > 0) && (acc.nPol() <= 4), "Unsupported number of polarisations: "<<acc.nPol());
+      ASKAPCHECK(acc.nChannel() > 0, "The first chunk written to "<<itsName<<" has no spectral channels");
+      itsHeader.nChannel = acc.nChannel();
+      itsHeader.nPol = acc.nPol();
+      const casa::Vector<casa::Stokes::StokesTypes> &stokes = acc.stokes();
+      ASKAPDEBUGASSERT(stokes.nelements() == acc.nPol());
+      for (casa::uInt pol = 0; pol < acc.nPol(); ++pol) {
+           itsHeader.stokes[pol] = stokes[pol];
+      }
+      itsFrequencies.resize(acc.nChannel());
+      itsFrequencies = acc.frequency();
+      // placeholder for the header, it is written again at the end
+      write(&itsHeader, sizeof(itsHeader));
+      writeArray(itsFrequencies);
+  } else {
+      if ((acc.nChannel() != itsHeader.nChannel) || (acc.nPol() != itsHeader.nPol)) {
+          ASKAPTHROW(DataAccessError, "Shape of chunk "<<itsIndex.size()<<" ("<<acc.nChannel()<<" channels, "<<
+                     acc.nPol()<<" polarisations) doesn't match that of the visibility store ("<<itsHeader.nChannel<<
+                     " channels, "<<itsHeader.nPol<<" polarisations)");
+      }
+      const casa::Vector<casa::Double> &freq = acc.frequency();
+      for (casa::uInt ch = 0; ch < freq.nelements(); ++ch) {
+           if (std::abs(freq[ch] - itsFrequencies[ch]) > 1e-3) {
+               ASKAPTHROW(DataAccessError, "Frequency axis changes at chunk "<<itsIndex.size()<<
+                          ", the visibility store should be written in the native frame of the data");
+           }
+      }
+      if (acc.time() < itsIndex.back().time) {
+          ASKAPTHROW(DataAccessError, "Chunks should be appended to the visibility store in the order of time");
+      }
+  }
+  MappedVisStore::IndexEntry entry;
+  entry.offset = itsOffset;
+  entry.time = acc.time();
+  entry.nRow = acc.nRow();
+  const casa::uInt nRow = acc.nRow();
+
+  writeArray(acc.visibility());
+  writeArray(acc.noise());
+  writeArray(acc.flag());
+  std::vector<double> uvw(3 * nRow);
+  const casa::Vector<casa::RigidVector<casa::Double, 3> > &accUVW = acc.uvw();
+  for (casa::uInt row = 0; row < nRow; ++row) {
+       for (casa::uInt dim = 0; dim < 3; ++dim) {
+            uvw[3 * row + dim] = accUVW[row](dim);
+       }
+  }
+  write(uvw.size() > 0 ? &uvw[0] : NULL, uvw.size() * sizeof(double));
+  writeArray(acc.antenna1());
+  writeArray(acc.antenna2());
+  writeArray(acc.feed1());
+  writeArray(acc.feed2());
+  writeArray(acc.feed1PA());
+  writeArray(acc.feed2PA());
+  writeDirections(acc.pointingDir1());
+  writeDirections(acc.pointingDir2());
+  writeDirections(acc.dishPointing1());
+  writeDirections(acc.dishPointing2());
+  ASKAPDEBUGASSERT(itsOffset - entry.offset ==
+                   MappedVisStore::ChunkLayout(nRow, itsHeader.nChannel, itsHeader.nPol).size);
+  itsIndex.push_back(entry);
+}
+
+/// @brief append all chunks from the given iterator
+/// @details The iterator is rewound first
+/// @param[in] it iterator with the data to write
+/// @return number of chunks appended
+size_t MappedVisStoreWriter::append(IConstDataIterator &it)
+{
+  size_t counter = 0;
+  for (it.init(); it.hasMore(); it.next(), ++counter) {
+       append(*it);
+  }
+  return counter;
+}
+
+/// @brief write the index and the header and close the file
+void MappedVisStoreWriter::close()
+{
+  ASKAPCHECK(!itsClosed, "Visibility store "<<itsName<<" has already been closed");
+  itsClosed = true;
+  if (itsIndex.size() == 0) {
+      ASKAPTHROW(DataAccessError, "No data have been written to the visibility store "<<itsName);
+  }
+  itsHeader.nChunks = itsIndex.size();
+  itsHeader.indexOffset = itsOffset;
+  write(&itsIndex[0], itsIndex.size() * sizeof(MappedVisStore::IndexEntry));
+  itsStream.seekp(0);
+  itsStream.write(reinterpret_cast<const char*>(&itsHeader), sizeof(itsHeader));
+  itsStream.close();
+  if (!itsStream) {
+      ASKAPTHROW(DataAccessError, "Error writing visibility store "<<itsName);
+  }
+  ASKAPLOG_INFO_STR(logger, "Written "<<itsIndex.size()<<" chunks ("<<itsOffset<<" bytes) to visibility store "<<itsName);
+}
+
+/// @brief write a block of data followed by padding to the alignment of the store
+/// @param[in] data pointer to the data
+/// @param[in] size size of the block in bytes
+void MappedVisStoreWriter::write(const void *data, size_t size)
+{
+  const size_t padding = MappedVisStore::align(size) - size;
+  if (size > 0) {
+      itsStream.write(static_cast<const char*>(data), size);
+  }
+  if (padding > 0) {
+      const char zeros[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+      itsStream.write(zeros, padding);
+  }
+  if (!itsStream) {
+      ASKAPTHROW(DataAccessError, "Error writing visibility store "<<itsName);
+  }
+  itsOffset += size + padding;
+}
+
+/// @brief write an array of the accessor
+/// @param[in] arr array to write (need not be contiguous)
+template<typename T>
+void MappedVisStoreWriter::writeArray(const casa::Array<T> &arr)
+{
+  casa::Bool deleteIt;
+  const T* data = arr.getStorage(deleteIt);
+  write(data, arr.nelements() * sizeof(T));
+  arr.freeStorage(data, deleteIt);
+}
+
+/// @brief write directions as pairs of longitude and latitude
+/// @param[in] dirs directions to write
+void MappedVisStoreWriter::writeDirections(const casa::Vector<casa::MVDirection> &dirs)
+{
+  std::vector<double> buf(2 * dirs.nelements());
+  for (casa::uInt row = 0; row < dirs.nelements(); ++row) {
+       buf[2 * row] = dirs[row].getLong();
+       buf[2 * row + 1] = dirs[row].getLat();
+  }
+  write(buf.size() > 0 ? &buf[0] : NULL, buf.size() * sizeof(double));
+}
+
+} // namespace accessors
+
+} // namespace askap
@@ -0,0 +1,140 @@
+/// @file
+/// @brief writer of the native memory-mapped visibility store
+/// @details This class converts the data delivered by any accessor (e.g. from a measurement
+/// set via TableConstDataSource or directly from the ingest pipeline) into the native store
+/// described in MappedVisStore, which can be read back by MappedConstDataSource.
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author agent <agent@local>
+///
+
+#ifndef ASKAP_ACCESSORS_MAPPED_VIS_STORE_WRITER_H
+#define ASKAP_ACCESSORS_MAPPED_VIS_STORE_WRITER_H
+
+// own includes
+#include <dataaccess/MappedVisStore.h>
+#include <dataaccess/IConstDataAccessor.h>
+#include <dataaccess/IConstDataIterator.h>
+#include <dataaccess/IDataConverter.h>
+
+// casa includes
+#include <measures/Measures/MPosition.h>
+#include <measures/Measures/MFrequency.h>
+
+// std includes
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace askap {
+
+namespace accessors {
+
+/// @brief writer of the native memory-mapped visibility store
+/// @details Chunks are appended to the file in the order of time (one chunk per accessor).
+/// The accessors should deliver the data in the frames of the store, i.e. time in seconds
+/// since MJD 0 UTC, directions in J2000 and frequencies in Hz in the frame given at construction.
+/// Use setupConverter to configure the converter of the source accordingly. All chunks should
+/// have the same frequency axis and polarisation products (i.e. the frame should be the native
+/// frame of the data, usually TOPO). The index and the header are written by close.
+/// @ingroup dataaccess_hlp
+class MappedVisStoreWriter {
+public:
+  /// @brief create the file
+  /// @param[in] fname file name (an existing file is overwritten)
+  /// @param[in] position position of the array used for frame conversions when the data are read
+  /// @param[in] frame frequency reference frame of the data (default is TOPO)
+  MappedVisStoreWriter(const std::string &fname, const casa::MPosition &position,
+                       const casa::MFrequency::Ref &frame = casa::MFrequency::Ref(casa::MFrequency::TOPO));
+
+  /// @brief close the file if it hasn't been closed
+  /// @details Errors are reported to the log, call close explicitly to get an exception.
+  ~MappedVisStoreWriter();
+
+  /// @brief configure the converter to deliver data in the frames of the store
+  /// @param[in] conv converter of the source to set up
+  void setupConverter(IDataConverter &conv) const;
+
+  /// @brief append one chunk
+  /// @param[in] acc accessor with the data to write
+  void append(const IConstDataAccessor &acc);
+
+  /// @brief append all chunks from the given iterator
+  /// @details The iterator is rewound first
+  /// @param[in] it iterator with the data to write
+  /// @return number of chunks appended
+  size_t append(IConstDataIterator &it);
+
+  /// @brief write the index and the header and close the file
+  void close();
+
+  /// @return number of chunks appended so far
+  inline size_t nChunks() const { return itsIndex.size(); }
+
+private:
+  /// @brief write a block of data followed by padding to the alignment of the store
+  /// @param[in] data pointer to the data
+  /// @param[in] size size of the block in bytes
+  void write(const void *data, size_t size);
+
+  /// @brief write an array of the accessor
+  /// @param[in] arr array to write (need not be contiguous)
+  template<typename T>
+  void writeArray(const casa::Array<T> &arr);
+
+  /// @brief write directions as pairs of longitude and latitude
+  /// @param[in] dirs directions to write
+  void writeDirections(const casa::Vector<casa::MVDirection> &dirs);
+
+  /// @brief output stream
+  std::ofstream itsStream;
+
+  /// @brief file name
+  std::string itsName;
+
+  /// @brief header (filled when the file is closed)
+  MappedVisStore::Header itsHeader;
+
+  /// @brief frequency axis of the first chunk
+  casa::Vector<casa::Double> itsFrequencies;
+
+  /// @brief index of the chunks appended so far
+  std::vector<MappedVisStore::IndexEntry> itsIndex;
+
+  /// @brief current offset in the file
+  size_t itsOffset;
+
+  /// @brief true if the file has been closed
+  bool itsClosed;
+
+  // no support for copy or assignment
+  MappedVisStoreWriter(const MappedVisStoreWriter&);
+  MappedVisStoreWriter& operator=(const MappedVisStoreWriter&);
+};
+
+} // namespace accessors
+
+} // namespace askap
+
+#endif // #ifndef ASKAP_ACCESSORS_MAPPED_VIS_STORE_WRITER_H
@@ -0,0 +1,483 @@
+/// @file
+/// @brief iterator adapter reading the data ahead in a background thread
+/// @details Consumers of the iterator interface alternate between the I/O done by
+/// the table-based iterator and the processing of the current chunk, so either the disk
+/// or the CPU is idle most of the time. This adapter reads the following chunks in a
+/// background thread into a bounded queue while the current chunk is being processed.
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author agent <agent@local>
+///
+
+#include <askap_accessors.h>
+
+#include <askap/AskapLogging.h>
+#include <askap/AskapError.h>
+
+#include <dataaccess/ReadAheadIteratorAdapter.h>
+#include <dataaccess/DataAccessError.h>
+#include <dataaccess/CasacoreLock.h>
+
+// boost includes
+#include <boost/bind.hpp>
+
+// std includes
+#include <exception>
+
+ASKAP_LOGGER(logger, ".dataaccess");
+
+namespace askap {
+
+namespace accessors {
+
+/// @brief chunk with uvw rotations for new directions done under the casacore lock
+/// @details Rotations for the directions known in advance are done by the background
+/// thread. If the consumer requests a new direction, the rotation is done in the consumer
+/// thread, but it is serialised with the background thread because measures
+/// conversions are not thread-safe.
+struct ReadAheadIteratorAdapter::Chunk : public CachedVisChunk {
+  /// @brief capture the given accessor
+  /// @param[in] acc accessor to copy the data from
+  explicit Chunk(const IConstDataAccessor &acc) : CachedVisChunk(acc) {}
+
+  /// @brief uvw after rotation
+  /// @param[in] tangentPoint tangent point to rotate the coordinates to
+  /// @return uvw after rotation to the new coordinate system for each row
+  virtual const casa::Vector<casa::RigidVector<casa::Double, 3> >&
+           rotatedUVW(const casa::MDirection &tangentPoint) const
+  {
+     if (rotatedUVWRecorded(tangentPoint)) {
+         return CachedVisChunk::rotatedUVW(tangentPoint);
+     }
+     const CasacoreLock lock;
+     return CachedVisChunk::rotatedUVW(tangentPoint);
+  }
+
+  /// @brief delay associated with uvw rotation
+  /// @param[in] tangentPoint tangent point to rotate the coordinates to
+  /// @param[in] imageCentre image centre (additional translation is done if imageCentre!=tangentPoint)
+  /// @return delays corresponding to the uvw rotation for each row
+  virtual const casa::Vector<casa::Double>& uvwRotationDelay(
+           const casa::MDirection &tangentPoint, const casa::MDirection &imageCentre) const
+  {
+     if (uvwRotationDelayRecorded(tangentPoint, imageCentre)) {
+         return CachedVisChunk::uvwRotationDelay(tangentPoint, imageCentre);
+     }
+     const CasacoreLock lock;
+     return CachedVisChunk::uvwRotationDelay(tangentPoint, imageCentre);
+  }
+};
+
+/// @brief make a copy of the direction which doesn't share the reference frame with the original
+/// @param[in] dir input direction
+/// @return new direction
+static casa::MDirection freshCopy(const casa::MDirection &dir)
+{
+  return casa::MDirection(dir.getValue(), casa::MDirection::castType(dir.getRef().getType()));
+}
+
+/// @brief record a field of the chunk if it is available from the original accessor
+/// @details Fields which can't be obtained (e.g. velocities without the rest frequency)
+/// are skipped, an exception is thrown if the consumer requests them.
+/// @param[in] chunk chunk with the original accessor set
+/// @param[in] getter accessor method returning the field
+template<typename T>
+static void recordIfAvailable(const CachedVisChunk &chunk,
+                const casa::Vector<T>& (IConstDataAccessor::*getter)() const)
+{
+  try {
+     (chunk.*getter)();
+  }
+  catch (const std::exception &) {
+  }
+}
+
+/// @brief setup with the given iterators
+/// @details The read ahead starts on the first access to the data.
+/// @param[in] reader iterator used by the background thread to read the data
+/// @param[in] iter iterator with the same selection used to write back the visibilities and
+/// to access buffers (if it is a const iterator, changes to visibilities are discarded)
+/// @param[in] nChunks maximum number of chunks read ahead of the current one
+ReadAheadIteratorAdapter::ReadAheadIteratorAdapter(const boost::shared_ptr<IConstDataIterator> &reader,
+                   const boost::shared_ptr<IConstDataIterator> &iter, size_t nChunks) :
+       DataIteratorAdapter(iter), itsTableIterator(boost::dynamic_pointer_cast<TableDataIterator>(iter)),
+       itsReader(reader), itsNChunks(nChunks), itsPosition(0), itsIteratorPosition(0),
+       itsDirect(false), itsBufferChosen(false), itsStarted(false), itsStopRequested(false),
+       itsReaderDone(false)
+{
+  ASKAPCHECK(reader, "An attempt to initialise ReadAheadIteratorAdapter with empty shared pointer");
+  ASKAPCHECK(iter, "An attempt to initialise ReadAheadIteratorAdapter with empty shared pointer");
+  ASKAPCHECK(reader != iter, "ReadAheadIteratorAdapter requires two different iterators");
+  ASKAPCHECK(nChunks > 0, "Number of chunks to read ahead should be positive");
+}
+
+/// @brief stop the background thread
+/// @details Visibilities changed in the current chunk are written back.
+ReadAheadIteratorAdapter::~ReadAheadIteratorAdapter()
+{
+  try {
+     finishCurrent();
+  }
+  catch (const std::exception &ex) {
+     ASKAPLOG_ERROR_STR(logger, "Unable to write back visibilities of the last chunk: "<<ex.what());
+  }
+  stopReading();
+}
+
+/// @brief restart the iteration from the beginning
+/// @details Visibilities changed in the current chunk are written back and the read
+/// ahead is restarted, unless the adapter is still at the first chunk.
+void ReadAheadIteratorAdapter::init()
+{
+  if (!itsStarted) {
+      ensureStarted();
+      return;
+  }
+  if (!itsDirect && (itsPosition == 0) && !(itsCurrent && itsCurrent->visibilityChanged())) {
+      // the read ahead has been started from the beginning and nothing has been changed
+      return;
+  }
+  finishCurrent();
+  stopReading();
+  itsRetired.reset();
+  itsPosition = 0;
+  if (itsDirect) {
+      DataIteratorAdapter::init();
+      itsIteratorPosition = 0;
+      if (itsBufferChosen) {
+          // buffers are only available via the second iterator
+          return;
+      }
+      itsDirect = false;
+  }
+  startReading();
+  fetchCurrent();
+}
+
+/// operator* delivers a reference to data accessor (current chunk)
+/// @return a reference to the current chunk
+IDataAccessor& ReadAheadIteratorAdapter::operator*() const
+{
+  // the visible state of the iteration is not changed by the start of the read ahead
+  const_cast<ReadAheadIteratorAdapter*>(this)->ensureStarted();
+  if (itsDirect) {
+      return DataIteratorAdapter::operator*();
+  }
+  if (!itsCurrent && (itsError != "")) {
+      // the error of the first read found by hasMore
+      ASKAPTHROW(DataAccessError, "Unable to read the data ahead: "<<itsError);
+  }
+  ASKAPCHECK(itsCurrent, "An attempt to access data beyond the end of the iteration");
+  return *itsCurrent;
+}
+
+/// Checks whether there are more data available.
+/// @return True if there are more data available
+casa::Bool ReadAheadIteratorAdapter::hasMore() const throw()
+{
+  if (!itsStarted) {
+      try {
+         const_cast<ReadAheadIteratorAdapter*>(this)->ensureStarted();
+      }
+      catch (const std::exception &) {
+         // this method can't throw, the error is reported by operator*
+         return true;
+      }
+  }
+  if (itsDirect) {
+      return DataIteratorAdapter::hasMore();
+  }
+  return itsCurrent;
+}
+
+/// advance the iterator one step further
+/// @details Visibilities changed in the current chunk are written back
+/// @return True if there are more data (so constructions like
+///         while(it.next()) {} are possible)
+casa::Bool ReadAheadIteratorAdapter::next()
+{
+  ensureStarted();
+  itsRetired.reset();
+  if (itsDirect) {
+      DataIteratorAdapter::next();
+      ++itsIteratorPosition;
+      ++itsPosition;
+  } else {
+      finishCurrent();
+      ++itsPosition;
+      fetchCurrent();
+  }
+  return hasMore();
+}
+
+/// @brief switch the output of operator* to one of the buffers
+/// @details The read ahead is stopped until the next init.
+/// @param[in] bufferID  the name of the buffer to choose
+void ReadAheadIteratorAdapter::chooseBuffer(const std::string &bufferID)
+{
+  startDirect();
+  DataIteratorAdapter::chooseBuffer(bufferID);
+  itsBufferChosen = true;
+}
+
+/// @brief switch the output of operator* to the original state
+void ReadAheadIteratorAdapter::chooseOriginal()
+{
+  if (itsDirect) {
+      DataIteratorAdapter::chooseOriginal();
+  }
+  itsBufferChosen = false;
+}
+
+/// @brief return any associated buffer for read/write access
+/// @details The read ahead is stopped until the next init.
+/// @param[in] bufferID the name of the buffer requested
+/// @return a reference to writable data accessor to the buffer requested
+IDataAccessor& ReadAheadIteratorAdapter::buffer(const std::string &bufferID) const
+{
+  // the interface method is const, but the read ahead has to be stopped to access the buffers
+  // via the second iterator. The visible state of the iteration is not changed by this.
+  const_cast<ReadAheadIteratorAdapter*>(this)->startDirect();
+  return DataIteratorAdapter::buffer(bufferID);
+}
+
+/// @brief start the read ahead if it hasn't been started yet
+/// @details This is done on the first access to the data. The first chunk is
+/// fetched, so an error of the background thread may be thrown here.
+void ReadAheadIteratorAdapter::ensureStarted()
+{
+  if (!itsStarted) {
+      itsStarted = true;
+      startReading();
+      fetchCurrent();
+  }
+}
+
+/// @brief start the background thread from the beginning of the data
+void ReadAheadIteratorAdapter::startReading()
+{
+  ASKAPDEBUGASSERT(!itsThread);
+  ASKAPDEBUGASSERT(itsQueue.empty());
+  itsStopRequested = false;
+  itsReaderDone = false;
+  itsError = "";
+  itsThread.reset(new boost::thread(boost::bind(&ReadAheadIteratorAdapter::readLoop, this)));
+}
+
+/// @brief stop the background thread and discard the chunks read so far
+void ReadAheadIteratorAdapter::stopReading()
+{
+  if (itsThread) {
+      {
+         boost::lock_guard<boost::mutex> lock(itsQueueMutex);
+         itsStopRequested = true;
+      }
+      itsSpaceAvailable.notify_all();
+      itsThread->join();
+      itsThread.reset();
+  }
+  itsQueue.clear();
+}
+
+/// @brief main loop of the background thread
+void ReadAheadIteratorAdapter::readLoop()
+{
+  try {
+     {
+        const CasacoreLock lock;
+        itsReader->init();
+     }
+     for (;;) {
+          // directions are copied, so the consumer can update its list while the chunk is read
+          std::vector<casa::MDirection> tangentPoints;
+          std::vector<std::pair<casa::MDirection, casa::MDirection> > delayDirections;
+          {
+             boost::unique_lock<boost::mutex> lock(itsQueueMutex);
+             while ((itsQueue.size() >= itsNChunks) && !itsStopRequested) {
+                    itsSpaceAvailable.wait(lock);
+             }
+             if (itsStopRequested) {
+                 break;
+             }
+             for (size_t i = 0; i < itsTangentPoints.size(); ++i) {
+                  tangentPoints.push_back(freshCopy(itsTangentPoints[i]));
+             }
+             for (size_t i = 0; i < itsDelayDirections.size(); ++i) {
+                  delayDirections.push_back(std::make_pair(freshCopy(itsDelayDirections[i].first),
+                                            freshCopy(itsDelayDirections[i].second)));
+             }
+          }
+          boost::shared_ptr<Chunk> chunk;
+          {
+             const CasacoreLock lock;
+             if (!itsReader->hasMore()) {
+                 break;
+             }
+             const IConstDataAccessor &acc = *(*itsReader);
+             chunk.reset(new Chunk(acc));
+             // unpack flags and noise, so they're ready for the consumer
+             chunk->flag();
+             chunk->noise();
+             // copy the fields which are not captured at the construction of the chunk
+             recordIfAvailable(*chunk, &IConstDataAccessor::feed1PA);
+             recordIfAvailable(*chunk, &IConstDataAccessor::feed2PA);
+             recordIfAvailable(*chunk, &IConstDataAccessor::pointingDir2);
+             recordIfAvailable(*chunk, &IConstDataAccessor::dishPointing1);
+             recordIfAvailable(*chunk, &IConstDataAccessor::dishPointing2);
+             recordIfAvailable(*chunk, &IConstDataAccessor::velocity);
+             // the lock is already held, so the methods of the base class are called directly
+             for (size_t i = 0; i < tangentPoints.size(); ++i) {
+                  chunk->CachedVisChunk::rotatedUVW(tangentPoints[i]);
+             }
+             for (size_t i = 0; i < delayDirections.size(); ++i) {
+                  chunk->CachedVisChunk::uvwRotationDelay(delayDirections[i].first, delayDirections[i].second);
+             }
+             chunk->setOriginal(0);
+             itsReader->next();
+          }
+          {
+             boost::lock_guard<boost::mutex> lock(itsQueueMutex);
+             itsQueue.push_back(chunk);
+          }
+          itsChunkReady.notify_all();
+     }
+  }
+  catch (const std::exception &ex) {
+     boost::lock_guard<boost::mutex> lock(itsQueueMutex);
+     itsError = ex.what();
+  }
+  catch (...) {
+     boost::lock_guard<boost::mutex> lock(itsQueueMutex);
+     itsError = "unknown exception";
+  }
+  {
+     boost::lock_guard<boost::mutex> lock(itsQueueMutex);
+     itsReaderDone = true;
+  }
+  itsChunkReady.notify_all();
+}
+
+/// @brief get the next chunk from the queue
+/// @details The method waits until the chunk is available. The current chunk is empty
+/// after this call if there are no more data. An error of the background thread
+/// is rethrown here.
+void ReadAheadIteratorAdapter::fetchCurrent()
+{
+  ASKAPDEBUGASSERT(!itsCurrent);
+  boost::unique_lock<boost::mutex> lock(itsQueueMutex);
+  while (itsQueue.empty() && !itsReaderDone) {
+         itsChunkReady.wait(lock);
+  }
+  if (!itsQueue.empty()) {
+      itsCurrent = itsQueue.front();
+      itsQueue.pop_front();
+      lock.unlock();
+      itsSpaceAvailable.notify_all();
+      return;
+  }
+  if (itsError != "") {
+      ASKAPTHROW(DataAccessError, "Unable to read the data ahead: "<<itsError);
+  }
+}
+
+/// @brief finish work with the current chunk
+/// @details Visibilities are written back if they have been changed and directions used
+/// for uvw rotation are passed to the background thread.
+void ReadAheadIteratorAdapter::finishCurrent()
+{
+  if (itsCurrent) {
+      boost::shared_ptr<Chunk> chunk = itsCurrent;
+      itsCurrent.reset();
+      if (chunk->visibilityChanged()) {
+          writeBack(chunk->visibility());
+      }
+      std::vector<casa::MDirection> tangentPoints;
+      std::vector<std::pair<casa::MDirection, casa::MDirection> > delayDirections;
+      chunk->rotationDirections(tangentPoints, delayDirections);
+      boost::lock_guard<boost::mutex> lock(itsQueueMutex);
+      itsTangentPoints.swap(tangentPoints);
+      itsDelayDirections.swap(delayDirections);
+  }
+}
+
+/// @brief write visibilities of the current chunk via the second iterator
+/// @param[in] vis visibility cube
+void ReadAheadIteratorAdapter::writeBack(const casa::Cube<casa::Complex> &vis)
+{
+  if (!canWrite()) {
+      // const iterator, changes are discarded
+      return;
+  }
+  const CasacoreLock lock;
+  synchroniseIterator();
+  if (itsTableIterator) {
+      if (!itsTableIterator->mainTableWritable()) {
+          throw DataAccessLogicError("rwVisibility() is used for original visibilities, "
+               "but the table is not writable");
+      }
+      itsTableIterator->writeOriginalVis(vis);
+  } else {
+      // the write is delayed by the iterator until it advances
+      rwIterator()->rwVisibility() = vis;
+  }
+}
+
+/// @brief advance the second iterator to the position of the consumer
+/// @details This method should be called under the casacore lock
+void ReadAheadIteratorAdapter::synchroniseIterator()
+{
+  if (itsIteratorPosition > itsPosition) {
+      DataIteratorAdapter::init();
+      itsIteratorPosition = 0;
+  }
+  // the second iterator is the table-based one created by the data source, it reads data
+  // columns only when they are requested, so skipping costs just the stepping through the table
+  for (; itsIteratorPosition < itsPosition; ++itsIteratorPosition) {
+       DataIteratorAdapter::next();
+  }
+}
+
+/// @brief stop the read ahead and pass all requests to the second iterator
+/// @details This is done when buffers are requested. The current chunk is kept until the
+/// adapter advances (the consumer may still have references to its data).
+void ReadAheadIteratorAdapter::startDirect()
+{
+  if (!itsDirect) {
+      boost::shared_ptr<Chunk> chunk = itsCurrent;
+      finishCurrent();
+      itsRetired = chunk;
+      stopReading();
+      {
+         const CasacoreLock lock;
+         synchroniseIterator();
+      }
+      itsDirect = true;
+      itsStarted = true;
+      ASKAPLOG_DEBUG_STR(logger, "Buffers are requested, read ahead is stopped until the iteration is restarted");
+  }
+}
+
+} // namespace accessors
+
+} // namespace askap
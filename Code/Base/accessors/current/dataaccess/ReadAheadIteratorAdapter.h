@@ -0,0 +1,242 @@
+/// @file
+/// @brief iterator adapter reading the data ahead in a background thread
+/// @details Consumers of the iterator interface alternate between the I/O done by
+/// the table-based iterator and the processing of the current chunk, so either the disk
+/// or the CPU is idle most of the time. This adapter reads the following chunks in a
+/// background thread into a bounded queue while the current chunk is being processed.
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author agent <agent@local>
+///
+
+#ifndef ASKAP_ACCESSORS_READ_AHEAD_ITERATOR_ADAPTER_H
+#define ASKAP_ACCESSORS_READ_AHEAD_ITERATOR_ADAPTER_H
+
+// own includes
+#include <dataaccess/DataIteratorAdapter.h>
+#include <dataaccess/CachedVisChunk.h>
+#include <dataaccess/TableDataIterator.h>
+
+// casa includes
+#include <measures/Measures/MDirection.h>
+
+// boost includes
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+// std includes
+#include <deque>
+#include <string>
+#include <vector>
+#include <utility>
+
+namespace askap {
+
+namespace accessors {
+
+/// @brief iterator adapter reading the data ahead in a background thread
+/// @details Two iterators with the same selection are required. The first one (reader) is
+/// used exclusively by the background thread which copies up to the given number of chunks
+/// ahead of the current one into CachedVisChunk objects. Visibilities, flags, noise, uvw and
+/// all metadata are copied, as well as rotated uvw and delays for the directions requested
+/// from the previous chunk, so the consumer doesn't need to touch the table. The second
+/// iterator is advanced in lock step with the consumer when necessary. It is used to
+/// write back visibilities changed via rwVisibility (this is done when the adapter advances)
+/// and to access buffers. As soon as a buffer is requested (via chooseBuffer or buffer),
+/// the read ahead stops and all further requests are passed to the second iterator until
+/// the iteration is restarted with init. The accessor obtained before the switch stays
+/// valid until the adapter advances.
+///
+/// Casacore tables and measures are not thread-safe, so the background thread only reads
+/// under the process-wide CasacoreLock, which is also taken by the table-based iterators,
+/// table calibration sources and uvw machines of this package in other threads. Rotation of
+/// uvw for a new direction (i.e. not seen in the previous chunk) is done in the consumer
+/// thread under the same lock. Fields which can't be obtained from the reader (e.g. velocities
+/// when the rest frequency is not defined) are skipped and cause an exception if requested
+/// by the consumer.
+///
+/// The background thread is started on the first access to the data rather than in the
+/// constructor, so the selector and the converter can still be adjusted after the adapter
+/// is created.
+/// @ingroup dataaccess_hlp
+class ReadAheadIteratorAdapter : virtual public DataIteratorAdapter
+{
+public:
+  /// @brief setup with the given iterators
+  /// @details The read ahead starts on the first access to the data.
+  /// @param[in] reader iterator used by the background thread to read the data
+  /// @param[in] iter iterator with the same selection used to write back the visibilities and
+  /// to access buffers (if it is a const iterator, changes to visibilities are discarded)
+  /// @param[in] nChunks maximum number of chunks read ahead of the current one
+  ReadAheadIteratorAdapter(const boost::shared_ptr<IConstDataIterator> &reader,
+                           const boost::shared_ptr<IConstDataIterator> &iter, size_t nChunks);
+
+  /// @brief stop the background thread
+  /// @details Visibilities changed in the current chunk are written back.
+  virtual ~ReadAheadIteratorAdapter();
+
+  /// @brief restart the iteration from the beginning
+  /// @details Visibilities changed in the current chunk are written back and the read
+  /// ahead is restarted, unless the adapter is still at the first chunk.
+  virtual void init();
+
+  /// operator* delivers a reference to data accessor (current chunk)
+  /// @return a reference to the current chunk
+  virtual IDataAccessor& operator*() const;
+
+  /// Checks whether there are more data available.
+  /// @return True if there are more data available
+  virtual casa::Bool hasMore() const throw();
+
+  /// advance the iterator one step further
+  /// @details Visibilities changed in the current chunk are written back
+  /// @return True if there are more data (so constructions like
+  ///         while(it.next()) {} are possible)
+  virtual casa::Bool next();
+
+  /// @brief switch the output of operator* to one of the buffers
+  /// @details The read ahead is stopped until the next init.
+  /// @param[in] bufferID  the name of the buffer to choose
+  virtual void chooseBuffer(const std::string &bufferID);
+
+  /// @brief switch the output of operator* to the original state
+  virtual void chooseOriginal();
+
+  /// @brief return any associated buffer for read/write access
+  /// @details The read ahead is stopped until the next init.
+  /// @param[in] bufferID the name of the buffer requested
+  /// @return a reference to writable data accessor to the buffer requested
+  virtual IDataAccessor& buffer(const std::string &bufferID) const;
+
+private:
+  /// @brief chunk with uvw rotations for new directions done under the casacore lock
+  struct Chunk;
+
+  /// @brief start the read ahead if it hasn't been started yet
+  /// @details This is done on the first access to the data. The first chunk is
+  /// fetched, so an error of the background thread may be thrown here.
+  void ensureStarted();
+
+  /// @brief start the background thread from the beginning of the data
+  void startReading();
+
+  /// @brief stop the background thread and discard the chunks read so far
+  void stopReading();
+
+  /// @brief main loop of the background thread
+  void readLoop();
+
+  /// @brief get the next chunk from the queue
+  /// @details The method waits until the chunk is available. The current chunk is empty
+  /// after this call if there are no more data. An error of the background thread
+  /// is rethrown here.
+  void fetchCurrent();
+
+  /// @brief finish work with the current chunk
+  /// @details Visibilities are written back if they have been changed and directions used
+  /// for uvw rotation are passed to the background thread.
+  void finishCurrent();
+
+  /// @brief write visibilities of the current chunk via the second iterator
+  /// @param[in] vis visibility cube
+  void writeBack(const casa::Cube<casa::Complex> &vis);
+
+  /// @brief advance the second iterator to the position of the consumer
+  /// @details This method should be called under the casacore lock
+  void synchroniseIterator();
+
+  /// @brief stop the read ahead and pass all requests to the second iterator
+  /// @details This is done when buffers are requested. The current chunk is kept until the
+  /// adapter advances (the consumer may still have references to its data).
+  void startDirect();
+
+  /// @brief second iterator cast to the table-based type (empty for other types)
+  /// @details It is used to write back the visibilities without reading them first
+  boost::shared_ptr<TableDataIterator> itsTableIterator;
+
+  /// @brief iterator used by the background thread
+  boost::shared_ptr<IConstDataIterator> itsReader;
+
+  /// @brief maximum number of chunks in the queue
+  size_t itsNChunks;
+
+  /// @brief chunks read ahead
+  std::deque<boost::shared_ptr<Chunk> > itsQueue;
+
+  /// @brief current chunk (empty if there are no more data or in the direct mode)
+  boost::shared_ptr<Chunk> itsCurrent;
+
+  /// @brief chunk which was current when the direct mode started
+  boost::shared_ptr<Chunk> itsRetired;
+
+  /// @brief number of the current chunk in this pass
+  size_t itsPosition;
+
+  /// @brief number of the chunk the second iterator points to
+  size_t itsIteratorPosition;
+
+  /// @brief true if the requests are passed to the second iterator
+  bool itsDirect;
+
+  /// @brief true if one of the buffers is chosen
+  bool itsBufferChosen;
+
+  /// @brief true if the read ahead has been started (or the direct mode entered)
+  bool itsStarted;
+
+  /// @brief true if the background thread should finish
+  bool itsStopRequested;
+
+  /// @brief true if the background thread has reached the end of the data (or failed)
+  bool itsReaderDone;
+
+  /// @brief error message of the background thread (empty if there was no error)
+  std::string itsError;
+
+  /// @brief tangent points requested from the previous chunk
+  std::vector<casa::MDirection> itsTangentPoints;
+
+  /// @brief pairs of tangent point and image centre requested from the previous chunk
+  std::vector<std::pair<casa::MDirection, casa::MDirection> > itsDelayDirections;
+
+  /// @brief background thread
+  boost::shared_ptr<boost::thread> itsThread;
+
+  /// @brief mutex protecting the queue and the state shared with the background thread
+  boost::mutex itsQueueMutex;
+
+  /// @brief signalled when a chunk is added to the queue or the background thread finishes
+  boost::condition_variable itsChunkReady;
+
+  /// @brief signalled when a chunk is taken from the queue or a stop is requested
+  boost::condition_variable itsSpaceAvailable;
+};
+
+} // namespace accessors
+
+} // namespace askap
+
+#endif // #ifndef ASKAP_ACCESSORS_READ_AHEAD_ITERATOR_ADAPTER_H
@@ -43,11 +43,18 @@
 #include <measures/Measures/MeasFrame.h>
 #include <casa/Arrays/Slicer.h>
 #include <casa/Arrays/IPosition.h>
+#include <casa/Arrays/Matrix.h>
+#include <casa/Arrays/Cube.h>
+#include <casa/Exceptions/Error.h>
+
+// std includes
+#include <algorithm>
 
 /// Local package
 #include <dataaccess/TableConstDataIterator.h>
 #include <dataaccess/DataAccessError.h>
 #include <dataaccess/DirectionConverter.h>
+#include <dataaccess/CasacoreLock.h>
 
 ASKAP_LOGGER(logger, "");
 
@@ -81,6 +88,10 @@ struct WholeRowFlagger
   /// If it can't do this, it returns true, which forces an element by element 
   /// processing. By default parameters are not used
   inline bool copyRequired(casa::uInt, casa::Cube<T> &) { return true;}
+
+  /// @brief apply whole row information to a cube filled in one go
+  /// @details By default parameters are not used
+  inline void applyToRows(casa::uInt, casa::Cube<T> &) {}
 };
 
 
@@ -104,6 +115,13 @@ struct WholeRowFlagger<casa::Bool>
   /// @param[in] row a row to work with 
   /// @param[in] cube cube to work with
   inline bool copyRequired(casa::uInt row, casa::Cube<casa::Bool> &cube);
+
+  /// @brief apply whole row information to a cube filled in one go
+  /// @details FLAG_ROW is read for all rows of the cube at once and rows
+  /// flagged there are flagged entirely in the cube.
+  /// @param[in] startRow row of the table corresponding to the first row of the cube
+  /// @param[in] cube cube to work with
+  inline void applyToRows(casa::uInt startRow, casa::Cube<casa::Bool> &cube);
 private:
   /// @brief accessor to the FLAG_ROW column
   ROScalarColumn<casa::Bool> itsFlagRowCol;
@@ -132,6 +150,97 @@ bool WholeRowFlagger<casa::Bool>::copyRequired(casa::uInt row,
   return true;
 }
 
+void WholeRowFlagger<casa::Bool>::applyToRows(casa::uInt startRow, 
+                 casa::Cube<casa::Bool> &cube)
+{
+  if (itsHasFlagRow && (cube.nrow() > 0)) {
+      const casa::Vector<casa::Bool> flagRow = itsFlagRowCol.getColumnRange(Slicer(IPosition(1, startRow),
+                           IPosition(1, cube.nrow()), Slicer::endIsLength));
+      for (casa::uInt row = 0; row < cube.nrow(); ++row) {
+           if (flagRow[row]) {
+               cube.yzPlane(row) = true;
+           }
+      }
+  }
+}
+
+/// @brief transpose (pol, chan, row) block into (row, chan, pol) cube
+/// @details This is a blocked transpose. A few rows are processed at a time, so
+/// the reads go through a small number of sequential streams and the writes
+/// are contiguous. The operation applied to each element allows to convert the type.
+/// @param[in] in input array ordered as (pol, chan, row)
+/// @param[in] cube output cube ordered as (row, chan, pol), should have the right shape
+/// @param[in] op operation converting an input element into the output element
+template<typename In, typename Out, typename Op>
+static void transposeBlock(const casa::Array<In> &in, casa::Cube<Out> &cube, Op op)
+{
+  const casa::uInt nRow = cube.nrow();
+  const casa::uInt nChan = cube.ncolumn();
+  const casa::uInt nPol = cube.nplane();
+  ASKAPDEBUGASSERT(in.nelements() == cube.nelements());
+  casa::Bool deleteIn, deleteOut;
+  const In *inData = in.getStorage(deleteIn);
+  Out *outData = cube.getStorage(deleteOut);
+  const size_t rowStride = size_t(nPol) * nChan;
+  const casa::uInt rowBlock = 16;
+  for (casa::uInt row0 = 0; row0 < nRow; row0 += rowBlock) {
+       const casa::uInt rowEnd = std::min(nRow, row0 + rowBlock);
+       for (casa::uInt pol = 0; pol < nPol; ++pol) {
+            for (casa::uInt chan = 0; chan < nChan; ++chan) {
+                 Out *dst = outData + (size_t(pol) * nChan + chan) * nRow;
+                 const In *src = inData + size_t(chan) * nPol + pol;
+                 for (casa::uInt row = row0; row < rowEnd; ++row) {
+                      dst[row] = op(src[row * rowStride]);
+                 }
+            }
+       }
+  }
+  in.freeStorage(inData, deleteIn);
+  cube.putStorage(outData, deleteOut);
+}
+
+/// @brief element operation for transposeBlock which copies the value
+/// @ingroup dataaccess_tab
+template<typename T>
+struct CopyElement {
+  /// @param[in] val input value
+  /// @return the same value
+  inline T operator()(const T &val) const { return val; }
+};
+
+/// @brief element operation for transposeBlock which converts sigma into noise
+/// @details Same value is used for both real and imaginary parts
+/// @ingroup dataaccess_tab
+struct NoiseFromSigma {
+  /// @param[in] val sigma
+  /// @return complex noise
+  inline casa::Complex operator()(const casa::Float &val) const { return casa::Complex(val, val); }
+};
+
+/// @brief reusable buffer for visibilities
+/// @return reference to the buffer
+template<>
+casa::Array<casa::Complex>& TableConstDataIterator::blockBuffer<casa::Complex>() const
+{
+  return itsComplexBlockBuffer;
+}
+
+/// @brief reusable buffer for flags
+/// @return reference to the buffer
+template<>
+casa::Array<casa::Bool>& TableConstDataIterator::blockBuffer<casa::Bool>() const
+{
+  return itsBoolBlockBuffer;
+}
+
+/// @brief reusable buffer for noise
+/// @return reference to the buffer
+template<>
+casa::Array<casa::Float>& TableConstDataIterator::blockBuffer<casa::Float>() const
+{
+  return itsFloatBlockBuffer;
+}
+
 
 } // namespace accessors
 
@@ -144,12 +253,13 @@ bool WholeRowFlagger<casa::Bool>::copyRequired(casa::uInt row,
 /// @param[in] tolerance pointing direction tolerance in radians, exceeding which leads 
 /// to initialisation of a new UVW Machine
 /// @param[in] maxChunkSize maximum number of rows per accessor
+/// @param[in] blockRead if true, array columns are read for all rows of the chunk at once
 TableConstDataIterator::TableConstDataIterator(
             const boost::shared_ptr<ITableManager const> &msManager,
             const boost::shared_ptr<ITableDataSelectorImpl const> &sel,
             const boost::shared_ptr<IDataConverterImpl const> &conv,
             size_t cacheSize, double tolerance,
-            casa::uInt maxChunkSize) : 
+            casa::uInt maxChunkSize, bool blockRead) : 
         TableInfoAccessor(msManager),
         // it is essential that accessor is initialised after cache parameters!
 	    itsUVWCacheSize(cacheSize), itsUVWCacheTolerance(tolerance),
@@ -158,7 +268,7 @@ TableConstDataIterator::TableConstDataIterator(
         itsSelector(sel->clone()), 
 	    itsConverter(conv->clone()),
 #endif 
-	    itsMaxChunkSize(maxChunkSize)
+	    itsMaxChunkSize(maxChunkSize), itsBlockRead(blockRead)
 	   
 { 
   ASKAPDEBUGASSERT(conv);
@@ -173,6 +283,7 @@ TableConstDataIterator::TableConstDataIterator(
 /// Restart the iteration from the beginning
 void TableConstDataIterator::init()
 { 
+  const CasacoreLock lock;
   itsCurrentTopRow=0;
   itsCurrentDataDescID=-100; // this value can't be in the table,
                              // therefore it is a flag of a new data descriptor
@@ -220,6 +331,7 @@ casa::Bool TableConstDataIterator::hasMore() const throw()
 ///         while(it.next()) {} are possible)
 casa::Bool TableConstDataIterator::next()
 {
+  const CasacoreLock lock;
   itsCurrentTopRow+=itsNumberOfRows;
   if (itsCurrentTopRow>=itsCurrentIteration.nrow()) {
       ASKAPDEBUGASSERT(!itsTabIterator.pastEnd());
@@ -415,6 +527,67 @@ void TableConstDataIterator::makeUniformFieldID()
 template<typename T>
 void TableConstDataIterator::fillCube(casa::Cube<T> &cube, 
                const std::string &columnName) const
+{
+  const CasacoreLock lock;
+  if (!itsBlockRead || !fillCubeByBlock(cube, columnName)) {
+      fillCubeByRow(cube, columnName);
+  }
+}
+
+/// @brief read an array column of the table into a cube in one go
+/// @details All rows of the current chunk are read with a single getColumnRange
+/// call into a reusable buffer ordered as (pol, chan, row) and then transposed into
+/// the (row, chan, pol) cube. 
+/// @param[in] cube a reference to the nRow x nChannel x nPol buffer
+///            cube to fill with the information from table
+/// @param[in] columnName a name of the column to read
+/// @return false, if the rows can't be read in one go (nothing is done to the cube then)
+template<typename T>
+bool TableConstDataIterator::fillCubeByBlock(casa::Cube<T> &cube, 
+               const std::string &columnName) const
+{
+  const casa::uInt nChan = nChannel();
+  const casa::uInt startChan = startChannel();
+  ROArrayColumn<T> tableCol(itsCurrentIteration,columnName);
+  if (itsNumberOfRows > 0) {
+      // all rows of the chunk have the same data description, so the shape
+      // of the first row is representative. Non-conformant rows cause an exception
+      // in casacore and are then diagnosed by reading row by row
+      const casa::IPosition shape = tableCol.shape(itsCurrentTopRow);
+      if ((shape.size() != 2) || (casa::uInt(shape[0]) != itsNumberOfPols) ||
+          (casa::uInt(shape[1]) != itsNumberOfChannels)) {
+          return false;
+      }
+  }
+  const Slicer rowSlicer(IPosition(1, itsCurrentTopRow), IPosition(1, itsNumberOfRows), Slicer::endIsLength);
+  const Slicer chanSlicer(IPosition(2, 0, startChan),
+                          IPosition(2, itsNumberOfPols, nChan),
+                          Slicer::endIsLength);
+  casa::Array<T> &buf = blockBuffer<T>();
+  try {
+     tableCol.getColumnRange(rowSlicer, chanSlicer, buf, True);
+  }
+  catch (const casa::AipsError &) {
+     return false;
+  }
+  cube.resize(itsNumberOfRows, nChan, itsNumberOfPols);
+  transposeBlock(buf, cube, CopyElement<T>());
+  // helper class, which does nothing for visibility cube, but checks
+  // FLAG_ROW for flagging
+  WholeRowFlagger<T> wrFlagger(itsCurrentIteration);
+  wrFlagger.applyToRows(itsCurrentTopRow, cube);
+  return true;
+}
+
+/// @brief read an array column of the table into a cube row by row
+/// @details This is the original way to read the data, which checks
+/// the shape of each row. It is used if the block read is switched off or fails.
+/// @param[in] cube a reference to the nRow x nChannel x nPol buffer
+///            cube to fill with the information from table
+/// @param[in] columnName a name of the column to read
+template<typename T>
+void TableConstDataIterator::fillCubeByRow(casa::Cube<T> &cube, 
+               const std::string &columnName) const
 {
   const casa::uInt nChan = nChannel();
   const casa::uInt startChan = startChannel();
@@ -495,6 +668,7 @@ void TableConstDataIterator::fillFlag(casa::Cube<casa::Bool> &flag) const
 ///            cube to be filled with the noise figures
 void TableConstDataIterator::fillNoise(casa::Cube<casa::Complex> &noise) const
 {
+  const CasacoreLock lock;
   ASKAPDEBUGASSERT(itsSelector);
   const casa::uInt nChan = nChannel();
   const casa::uInt startChan = startChannel();
@@ -506,6 +680,20 @@ void TableConstDataIterator::fillNoise(casa::Cube<casa::Complex> &noise) const
   if (table().actualTableDesc().isColumn("SIGMA_SPECTRUM")) {
       // noise is given per channel and polarisation
       ROArrayColumn<Float> sigmaCol(itsCurrentIteration,"SIGMA_SPECTRUM");
+      if (itsBlockRead && (itsNumberOfRows > 0)) {
+          const casa::IPosition shape = sigmaCol.shape(itsCurrentTopRow);
+          ASKAPASSERT(shape.size()==2);
+          ASKAPASSERT((shape[0] == casa::Int(itsNumberOfPols)) && 
+                      (shape[1] == casa::Int(itsNumberOfChannels)));
+          // SIGMA_SPECTRUM is ordered (row,pol,chan), transpose is done for all rows at once
+          const Slicer rowSlicer(IPosition(1, itsCurrentTopRow), IPosition(1, itsNumberOfRows), 
+                                 Slicer::endIsLength);
+          const Slicer chanSlicer(IPosition(2, 0, startChan), IPosition(2, itsNumberOfPols, nChan),
+                                  Slicer::endIsLength);
+          sigmaCol.getColumnRange(rowSlicer, chanSlicer, itsFloatBlockBuffer, True);
+          transposeBlock(itsFloatBlockBuffer, noise, NoiseFromSigma());
+          return;
+      }
       for (uInt row = 0; row<itsNumberOfRows; ++row) {
            const casa::IPosition shape = sigmaCol.shape(row);
            ASKAPASSERT(shape.size()==2);
@@ -534,6 +722,21 @@ void TableConstDataIterator::fillNoise(casa::Cube<casa::Complex> &noise) const
   } // if-statement checking that SIGMA_SPECTRUM column is present
   else if (table().actualTableDesc().isColumn("SIGMA")) {
       ROArrayColumn<Float> sigmaCol(itsCurrentIteration,"SIGMA");
+      if (itsBlockRead && (itsNumberOfRows > 0) && (sigmaCol.shape(itsCurrentTopRow).size() == 1)) {
+          // noise is given per polarisation, read all rows at once into (pol, row) matrix
+          ASKAPASSERT(sigmaCol.shape(itsCurrentTopRow)[0] == casa::Int(itsNumberOfPols));
+          const casa::Matrix<Float> sigmas = sigmaCol.getColumnRange(Slicer(IPosition(1, itsCurrentTopRow), 
+                            IPosition(1, itsNumberOfRows), Slicer::endIsLength));
+          ASKAPDEBUGASSERT(sigmas.nrow() == itsNumberOfPols);
+          for (uInt pol = 0; pol < itsNumberOfPols; ++pol) {
+               for (uInt row = 0; row < itsNumberOfRows; ++row) {
+                    // same polarisation for both real and imaginary parts
+                    const casa::Float val = sigmas(pol, row);
+                    noise.xyPlane(pol).row(row) = casa::Complex(val,val);
+               }
+          }
+          return;
+      }
       for (uInt row = 0; row<itsNumberOfRows; ++row) {
            const casa::IPosition shape = sigmaCol.shape(row);
            ASKAPASSERT((shape.size()<=2) && (shape.size()!=0));
@@ -589,9 +792,23 @@ void TableConstDataIterator::fillNoise(casa::Cube<casa::Complex> &noise) const
 ///            u,v and w for each row) to fill
 void TableConstDataIterator::fillUVW(casa::Vector<casa::RigidVector<casa::Double, 3> >&uvw) const
 {
+  const CasacoreLock lock;
   uvw.resize(itsNumberOfRows);
 
   ROArrayColumn<Double> uvwCol(itsCurrentIteration,"UVW");
+  if (itsBlockRead && (itsNumberOfRows > 0)) {
+      // read all rows at once into 3 x nRow matrix
+      const casa::Matrix<Double> buf = uvwCol.getColumnRange(Slicer(IPosition(1, itsCurrentTopRow), 
+                            IPosition(1, itsNumberOfRows), Slicer::endIsLength));
+      ASKAPASSERT(buf.nrow() == 3);
+      for (uInt row=0;row<itsNumberOfRows;++row) {
+           RigidVector<Double, 3> &thisRowUVW=uvw(row);
+           for (uInt dim=0; dim<3; ++dim) {
+                thisRowUVW(dim) = buf(dim,row);
+           }
+      }
+      return;
+  }
   // temporary buffer and position in it
   IPosition curPos(1,3);
   Array<Double> buf(curPos);
@@ -614,6 +831,7 @@ void TableConstDataIterator::fillUVW(casa::Vector<casa::RigidVector<casa::Double
 /// @return current spectral window ID
 casa::uInt TableConstDataIterator::currentSpWindowID() const
 {
+  const CasacoreLock lock;
   ASKAPDEBUGASSERT(itsCurrentDataDescID>=0);
   const int spWindowIndex = subtableInfo().getDataDescription().
                             getSpectralWindowID(itsCurrentDataDescID);
@@ -631,6 +849,7 @@ casa::uInt TableConstDataIterator::currentSpWindowID() const
 /// @return current polarisation ID
 casa::uInt TableConstDataIterator::currentPolID() const
 {
+  const CasacoreLock lock;
   ASKAPDEBUGASSERT(itsCurrentDataDescID>=0);
   const int polIndex = subtableInfo().getDataDescription().
                             getPolarizationID(itsCurrentDataDescID);
@@ -651,6 +870,7 @@ casa::uInt TableConstDataIterator::currentPolID() const
 /// @return a reference to direction measure
 const casa::MDirection& TableConstDataIterator::getCurrentReferenceDir() const
 {
+  const CasacoreLock lock;
   const IFieldSubtableHandler &fieldSubtable = subtableInfo().getField();
   if (itsUseFieldID) {
       ASKAPCHECK(itsCurrentFieldID>=0, "Elements of FIELD_ID column should be 0 or positive. You have "<<
@@ -682,6 +902,7 @@ std::pair<casa::uInt, casa::uInt> TableConstDataIterator::getChannelRange() cons
 /// @param[in] stokes a reference to a vector to be filled
 void TableConstDataIterator::fillStokes(casa::Vector<casa::Stokes::StokesTypes> &stokes) const
 {
+  const CasacoreLock lock;
   const ITablePolarisationHolder& polSubtable = subtableInfo().getPolarisation();
   
   ASKAPDEBUGASSERT(itsCurrentDataDescID>=0);
@@ -694,6 +915,7 @@ void TableConstDataIterator::fillStokes(casa::Vector<casa::Stokes::StokesTypes>
 /// @param[in] freq a reference to a vector to fill
 void TableConstDataIterator::fillFrequency(casa::Vector<casa::Double> &freq) const
 {  
+  const CasacoreLock lock;
   ASKAPDEBUGASSERT(itsConverter);
   const ITableSpWindowHolder& spWindowSubtable=subtableInfo().getSpWindow();
   ASKAPDEBUGASSERT(itsCurrentDataDescID>=0);
@@ -745,6 +967,7 @@ void TableConstDataIterator::fillFrequency(casa::Vector<casa::Double> &freq) con
 /// @return the time stamp  
 casa::Double TableConstDataIterator::getTime() const 
 { 
+  const CasacoreLock lock;
   // add additional checks in debug mode
   #ifdef ASKAP_DEBUG
    ROScalarColumn<Double> timeCol(itsCurrentIteration,"TIME");
@@ -802,6 +1025,7 @@ void TableConstDataIterator::fillFeed2(casa::Vector<casa::uInt> &ids) const
 void TableConstDataIterator::fillVectorOfIDs(casa::Vector<casa::uInt> &ids,
                      const casa::String &name) const
 {
+  const CasacoreLock lock;
   ROScalarColumn<Int> col(itsCurrentIteration,name);
   ids.resize(itsNumberOfRows);
   Vector<Int> buf=col.getColumnRange(Slicer(IPosition(1,
@@ -833,6 +1057,7 @@ casa::MEpoch TableConstDataIterator::currentEpoch() const
 /// @param[in] angles a reference to a vector to be filled
 void TableConstDataIterator::fillParallacticAngleCache(casa::Vector<casa::Double> &angles) const
 { 
+  const CasacoreLock lock;
   angles.resize(subtableInfo().getAntenna().getNumberOfAntennae());
   ASKAPDEBUGASSERT(angles.size());
   if (subtableInfo().getAntenna().allEquatorial()) {
@@ -887,6 +1112,7 @@ void TableConstDataIterator::fillParallacticAngleCache(casa::Vector<casa::Double
 /// @param[in] dirs a reference to a vector to fill
 void TableConstDataIterator::fillDirectionCache(casa::Vector<casa::MVDirection> &dirs) const
 {
+  const CasacoreLock lock;
   // the code fills both pointing directions and position angles. For ASKAP, it would
   // probably be a bit faster if we split these two operations between two methods, as
   // position angle will be fixed and will not need as much updating as the pointing.
@@ -1044,6 +1270,7 @@ void TableConstDataIterator::fillDishPointing2(casa::Vector<casa::MVDirection> &
 /// @param[in] dirs a reference to a vector to fill
 void TableConstDataIterator::fillDishPointingCache(casa::Vector<casa::MVDirection> &dirs) const
 {
+  const CasacoreLock lock;
   ASKAPDEBUGASSERT(itsConverter);
   const casa::MEpoch epoch = currentEpoch();
   
@@ -1078,6 +1305,7 @@ void TableConstDataIterator::fillVectorOfPointings(
                const casa::Vector<casa::uInt> &antIDs,
                const casa::Vector<casa::uInt> &feedIDs) const
 {
+  const CasacoreLock lock;
   ASKAPDEBUGASSERT(antIDs.nelements() == feedIDs.nelements());
   const casa::Vector<casa::MVDirection> &directionCache = 
       itsDirectionCache.value(*this,&TableConstDataIterator::fillDirectionCache);
@@ -1118,6 +1346,7 @@ void TableConstDataIterator::fillVectorOfPositionAngles(casa::Vector<casa::Float
               const casa::Vector<casa::uInt> &antIDs,
               const casa::Vector<casa::uInt> &feedIDs) const
 {
+  const CasacoreLock lock;
   ASKAPDEBUGASSERT(antIDs.nelements() == feedIDs.nelements());
   const casa::Vector<casa::Double> &parallacticAngles = itsParallacticAngleCache.value(*this,
                  &TableConstDataIterator::fillParallacticAngleCache);  
@@ -1156,6 +1385,7 @@ const std::string& TableConstDataIterator::getDataColumnName() const throw()
 /// @return current field ID
 casa::uInt TableConstDataIterator::currentFieldID() const
 {
+  const CasacoreLock lock;
   return itsUseFieldID ? itsCurrentFieldID : 0u;
 }  
 
@@ -1171,6 +1401,7 @@ casa::uInt TableConstDataIterator::currentFieldID() const
 /// @return current scan ID
 casa::uInt TableConstDataIterator::currentScanID() const
 {
+  const CasacoreLock lock;
   casa::Vector<casa::uInt> ids;
   fillVectorOfIDs(ids,"SCAN_NUMBER");
   ASKAPCHECK(ids.nelements()>0, "An attempt to extract scan ID for empty iteration");
@@ -42,6 +42,7 @@
 #include <boost/shared_ptr.hpp>
 
 // casa includes
+#include <casa/Arrays/Array.h>
 #include <tables/Tables/Table.h>
 #include <tables/Tables/TableIter.h>
 #include <measures/Measures/Stokes.h>
@@ -78,12 +79,13 @@ public:
   /// @param[in] tolerance pointing direction tolerance in radians, exceeding which leads 
   /// to initialisation of a new UVW Machine
   /// @param[in] maxChunkSize maximum number of rows per accessor
+  /// @param[in] blockRead if true, array columns are read for all rows of the chunk at once
   TableConstDataIterator(const boost::shared_ptr<ITableManager const>
               &msManager,
               const boost::shared_ptr<ITableDataSelectorImpl const> &sel,
 	      const boost::shared_ptr<IDataConverterImpl const> &conv,
 	      size_t cacheSize = 1, double tolerance = 1e-6,
-	      casa::uInt maxChunkSize = INT_MAX);
+	      casa::uInt maxChunkSize = INT_MAX, bool blockRead = true);
 
   /// Restart the iteration from the beginning
   virtual void init();
@@ -251,6 +253,32 @@ protected:
   template<typename T>
   void fillCube(casa::Cube<T> &cube, const std::string &columnName) const;
 
+  /// @brief read an array column of the table into a cube row by row
+  /// @details This is the original (slow) way to read the data, which checks
+  /// the shape of each row. It is used if the block read is switched off or fails.
+  /// @param[in] cube a reference to the nRow x nChannel x nPol buffer
+  ///            cube to fill with the information from table
+  /// @param[in] columnName a name of the column to read
+  template<typename T>
+  void fillCubeByRow(casa::Cube<T> &cube, const std::string &columnName) const;
+
+  /// @brief read an array column of the table into a cube in one go
+  /// @details All rows of the current chunk are read with a single getColumnRange
+  /// call into a reusable buffer ordered as (pol, chan, row) and then transposed into
+  /// the (row, chan, pol) cube. The shape is only checked for the first row, all rows
+  /// of a chunk belong to the same data description.
+  /// @param[in] cube a reference to the nRow x nChannel x nPol buffer
+  ///            cube to fill with the information from table
+  /// @param[in] columnName a name of the column to read
+  /// @return false, if the rows can't be read in one go (nothing is done to the cube then)
+  template<typename T>
+  bool fillCubeByBlock(casa::Cube<T> &cube, const std::string &columnName) const;
+
+  /// @brief reusable buffer for block reads of the given type
+  /// @return reference to the buffer
+  template<typename T>
+  casa::Array<T>& blockBuffer() const;
+
   /// @brief A helper method to fill a given vector with pointing directions.
   /// @details fillPointingDir1 and fillPointingDir2 methods do very similar
   /// operations, which differ only by the feedIDs and antennaIDs used.
@@ -423,6 +451,15 @@ private:
   boost::shared_ptr<IDataConverterImpl>  itsConverter;
   /// the maximum allowed number of rows in the accessor.
   casa::uInt itsMaxChunkSize;
+  /// @brief true if array columns are read for all rows of the chunk at once
+  bool itsBlockRead;
+  /// @brief reusable buffers for block reads (visibility, flag and noise)
+  /// @details These buffers are only resized if the shape of the chunk changes
+  mutable casa::Array<casa::Complex> itsComplexBlockBuffer;
+  /// @brief see above
+  mutable casa::Array<casa::Bool> itsBoolBlockBuffer;
+  /// @brief see above
+  mutable casa::Array<casa::Float> itsFloatBlockBuffer;
   casa::TableIterator itsTabIterator;
   /// current group of data returned by itsTabIterator
   casa::Table itsCurrentIteration;
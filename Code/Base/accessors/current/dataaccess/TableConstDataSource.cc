@@ -35,9 +35,11 @@
 /// own includes
 #include <dataaccess/TableConstDataSource.h>
 #include <dataaccess/TableConstDataIterator.h>
+#include <dataaccess/ReadAheadIteratorAdapter.h>
 #include <dataaccess/TableDataSelector.h>
 #include <dataaccess/BasicDataConverter.h>
 #include <dataaccess/DataAccessError.h>
+#include <dataaccess/CasacoreLock.h>
 
 using namespace askap;
 using namespace askap::accessors;
@@ -51,8 +53,9 @@ using namespace casa;
 ///                       (default is DATA)
 TableConstDataSource::TableConstDataSource(const std::string &fname,
                const std::string &dataColumn) :
-         TableInfoAccessor(casa::Table(fname), false, dataColumn),
-         itsUVWCacheSize(1), itsUVWCacheTolerance(1e-6) {}
+         TableInfoAccessor(CasacoreLock::openTable(fname), false, dataColumn),
+         itsUVWCacheSize(1), itsUVWCacheTolerance(1e-6), itsBlockRead(true),
+         itsReadAheadChunks(0) {}
 
 /// @brief configure caching of the uvw-machines
 /// @details A number of uvw machines can be cached at the same time. This can
@@ -71,6 +74,28 @@ void TableConstDataSource::configureUVWMachineCache(size_t cacheSize, double tol
   itsUVWCacheTolerance = tolerance;
 }
 
+/// @brief configure the way array columns are read
+/// @details By default, visibilities, flags, noise and uvw are read for all rows of
+/// the chunk at once with a single getColumnRange call, which avoids per-row overheads
+/// of casacore. The row by row reading can be requested with this method (e.g. for
+/// benchmarking). All subsequent iterators will be created with this setting.
+/// @param[in] blockRead true to read all rows at once, false to read row by row
+void TableConstDataSource::configureBlockRead(bool blockRead)
+{
+  itsBlockRead = blockRead;
+}
+
+/// @brief configure reading of the data ahead
+/// @details If a positive number of chunks is given, the following chunks are read
+/// in a background thread while the current chunk is being processed (see
+/// ReadAheadIteratorAdapter). By default, the data are read in the thread of the
+/// consumer when requested. All subsequent iterators will be created with this setting.
+/// @param[in] nChunks maximum number of chunks read ahead, zero switches the read ahead off
+void TableConstDataSource::configureReadAhead(casa::uInt nChunks)
+{
+  itsReadAheadChunks = nChunks;
+}
+
 /// construct a part of the read only object for use in the
 /// derived classes
 /// @note Due to virtual inheritance, TableInfoAccessor will be initialized
@@ -78,7 +103,8 @@ void TableConstDataSource::configureUVWMachineCache(size_t cacheSize, double tol
 /// the compiler happy
 TableConstDataSource::TableConstDataSource() :
          TableInfoAccessor(boost::shared_ptr<ITableManager const>()),
-         itsUVWCacheSize(1), itsUVWCacheTolerance(1e-6) {} 
+         itsUVWCacheSize(1), itsUVWCacheTolerance(1e-6), itsBlockRead(true),
+         itsReadAheadChunks(0) {} 
 
 /// create a converter object corresponding to this type of the
 /// DataSource. The user can change converting policies (units,
@@ -131,8 +157,18 @@ TableConstDataSource::createConstIterator(const IDataSelectorConstPtr &sel,
        ASKAPTHROW(DataAccessLogicError, "Incompatible selector and/or "<<
                  "converter are received by the createConstIterator method");
    }
-   return boost::shared_ptr<IConstDataIterator>(new TableConstDataIterator(
-                getTableManager(),implSel,implConv,uvwMachineCacheSize(), uvwMachineCacheTolerance()));
+   boost::shared_ptr<IConstDataIterator> iter(new TableConstDataIterator(
+                getTableManager(),implSel,implConv,uvwMachineCacheSize(), uvwMachineCacheTolerance(),
+                INT_MAX, blockRead()));
+   if (readAheadChunks() > 0) {
+       // the second iterator is only used by the background thread
+       boost::shared_ptr<IConstDataIterator> reader(new TableConstDataIterator(
+                getTableManager(),implSel,implConv,uvwMachineCacheSize(), uvwMachineCacheTolerance(),
+                INT_MAX, blockRead()));
+       return boost::shared_ptr<IConstDataIterator>(new ReadAheadIteratorAdapter(reader, iter,
+                readAheadChunks()));
+   }
+   return iter;
 }
 
 /// create a selector object corresponding to this type of the
@@ -137,6 +137,26 @@ public:
   /// @param[in] tolerance pointing direction tolerance in radians, exceeding which leads 
   /// to initialisation of a new UVW Machine
   void configureUVWMachineCache(size_t cacheSize = 1, double tolerance = 1e-6);
+
+  /// @brief configure the way array columns are read
+  /// @details By default, visibilities, flags, noise and uvw are read for all rows of
+  /// the chunk at once with a single getColumnRange call, which avoids per-row overheads
+  /// of casacore. The row by row reading can be requested with this method (e.g. for
+  /// benchmarking). All subsequent iterators will be created with this setting.
+  /// @note This method is a feature of this implementation and is not available via the 
+  /// general interface (intentionally)
+  /// @param[in] blockRead true to read all rows at once, false to read row by row
+  void configureBlockRead(bool blockRead = true);
+
+  /// @brief configure reading of the data ahead
+  /// @details If a positive number of chunks is given, the following chunks are read
+  /// in a background thread while the current chunk is being processed (see
+  /// ReadAheadIteratorAdapter). By default, the data are read in the thread of the
+  /// consumer when requested. All subsequent iterators will be created with this setting.
+  /// @note This method is a feature of this implementation and is not available via the 
+  /// general interface (intentionally)
+  /// @param[in] nChunks maximum number of chunks read ahead, zero switches the read ahead off
+  void configureReadAhead(casa::uInt nChunks = 0);
   
 protected:
   /// construct a part of the read only object for use in the
@@ -150,6 +170,14 @@ protected:
   /// @brief direction tolerance used for UVW machine cache
   /// @return direction tolerance used for UVW machine cache (in radians)
   inline double uvwMachineCacheTolerance() const {return itsUVWCacheTolerance;}   
+
+  /// @brief check whether array columns are read for all rows at once
+  /// @return true, if the block read is enabled
+  inline bool blockRead() const {return itsBlockRead;}
+
+  /// @brief number of chunks read ahead in a background thread
+  /// @return maximum number of chunks read ahead, zero means no read ahead
+  inline casa::uInt readAheadChunks() const {return itsReadAheadChunks;}
   
 private:
   /// @brief a number of uvw machines in the cache (default is 1)
@@ -161,6 +189,12 @@ private:
   /// @brief pointing direction tolerance in radians (for uvw machine cache)
   /// @details Exceeding this tolerance leads to initialisation of a new UVW Machine in the cache
   double itsUVWCacheTolerance;
+
+  /// @brief true if array columns are read for all rows of the chunk at once
+  bool itsBlockRead;
+
+  /// @brief maximum number of chunks read ahead in a background thread (0 means no read ahead)
+  casa::uInt itsReadAheadChunks;
 };
  
 } // namespace accessors
@@ -45,6 +45,7 @@
 #include <dataaccess/TableInfoAccessor.h>
 #include <dataaccess/IBufferManager.h>
 #include <dataaccess/DataAccessError.h>
+#include <dataaccess/CasacoreLock.h>
 
 // casa includes
 #include <tables/Tables/ArrayColumn.h>
@@ -97,14 +98,15 @@ using namespace askap::accessors;
 /// @param[in] sel shared pointer to selector
 /// @param[in] conv shared pointer to converter
 /// @param[in] maxChunkSize maximum number of rows per accessor
+/// @param[in] blockRead if true, array columns are read for all rows of the chunk at once
 TableDataIterator::TableDataIterator(
             const boost::shared_ptr<ITableManager const> &msManager,
             const boost::shared_ptr<ITableDataSelectorImpl const> &sel,
             const boost::shared_ptr<IDataConverterImpl const> &conv,
             size_t cacheSize, double tolerance,   
-            casa::uInt maxChunkSize) : 
+            casa::uInt maxChunkSize, bool blockRead) : 
          TableInfoAccessor(msManager),
-           TableConstDataIterator(msManager,sel,conv,cacheSize, tolerance, maxChunkSize),
+           TableConstDataIterator(msManager,sel,conv,cacheSize, tolerance, maxChunkSize, blockRead),
 	      itsOriginalVisAccessor(new TableDataAccessor(*this)),
 	      itsIterationCounter(0)
 {
@@ -139,6 +141,7 @@ IDataAccessor& TableDataIterator::operator*() const
 /// @param[in] bufferID  the name of the buffer to choose
 void TableDataIterator::chooseBuffer(const std::string &bufferID)
 {
+  const CasacoreLock lock;
   std::map<std::string,
       boost::shared_ptr<TableBufferDataAccessor> >::const_iterator bufferIt =
                       itsBuffers.find(bufferID);
@@ -171,6 +174,7 @@ void TableDataIterator::chooseOriginal()
 ///         buffer requested
 IDataAccessor& TableDataIterator::buffer(const std::string &bufferID) const
 {
+  const CasacoreLock lock;
   std::map<std::string,
       boost::shared_ptr<TableBufferDataAccessor> >::const_iterator bufferIt =
                       itsBuffers.find(bufferID);
@@ -187,6 +191,7 @@ IDataAccessor& TableDataIterator::buffer(const std::string &bufferID) const
 /// Restart the iteration from the beginning
 void TableDataIterator::init()
 {
+  const CasacoreLock lock;
   // call sync() member function for all accessors in itsBuffers
   std::for_each(itsBuffers.begin(),itsBuffers.end(),
            mapMemFun(&TableBufferDataAccessor::sync));
@@ -210,6 +215,7 @@ void TableDataIterator::init()
 ///         while(it.next()) {} are possible)
 casa::Bool TableDataIterator::next()
 {
+  const CasacoreLock lock;
   // call sync() member function for all accessors in itsBuffers
   std::for_each(itsBuffers.begin(),itsBuffers.end(),
            mapMemFun(&TableBufferDataAccessor::sync));
@@ -235,6 +241,7 @@ casa::Bool TableDataIterator::next()
 void TableDataIterator::readBuffer(casa::Cube<casa::Complex> &vis,
                         const std::string &name) const
 {
+  const CasacoreLock lock;
   const IBufferManager &bufManager=subtableInfo().getBufferManager();
   const TableConstDataAccessor &accessor=getAccessor();
   const casa::IPosition requiredShape(3, accessor.nRow(),
@@ -257,12 +264,14 @@ void TableDataIterator::readBuffer(casa::Cube<casa::Complex> &vis,
 void TableDataIterator::writeBuffer(const casa::Cube<casa::Complex> &vis,
                          const std::string &name) const
 {
+  const CasacoreLock lock;
   subtableInfo().getBufferManager().writeBuffer(vis,name,itsIterationCounter);
 }
 
 /// destructor required to sync buffers on the last iteration
 TableDataIterator::~TableDataIterator()
 {
+  const CasacoreLock lock;
   // call sync() member function for all accessors in itsBuffers
   std::for_each(itsBuffers.begin(),itsBuffers.end(),
            mapMemFun(&TableBufferDataAccessor::sync));
@@ -280,8 +289,17 @@ TableDataIterator::~TableDataIterator()
 /// visibility cube (hence no parameters). 
 void TableDataIterator::writeOriginalVis() const
 {
-  const casa::Cube<casa::Complex> &originalVis=getAccessor().visibility();
-  
+  writeOriginalVis(getAccessor().visibility());
+}
+
+/// @brief write the given cube as the original visibilities of the current chunk
+/// @details This version is used when the visibilities are held outside of the 
+/// accessor of this iterator (e.g. by an adapter reading ahead). The shape
+/// should match that of the current chunk.
+/// @param[in] originalVis nRow x nChannel x nPol cube to write
+void TableDataIterator::writeOriginalVis(const casa::Cube<casa::Complex> &originalVis) const
+{
+  const CasacoreLock lock;
   const casa::uInt nChan = nChannel();
   const casa::uInt startChan = startChannel();
   
@@ -78,12 +78,13 @@ public:
   /// @param[in] tolerance pointing direction tolerance in radians, exceeding which leads 
   /// to initialisation of a new UVW Machine
   /// @param[in] maxChunkSize maximum number of rows per accessor
+  /// @param[in] blockRead if true, array columns are read for all rows of the chunk at once
   TableDataIterator(const boost::shared_ptr<ITableManager const>
               &msManager,
               const boost::shared_ptr<ITableDataSelectorImpl const> &sel,
 	      const boost::shared_ptr<IDataConverterImpl const> &conv,
 	      size_t cacheSize = 1, double tolerance = 1e-6,
-	      casa::uInt maxChunkSize = INT_MAX);
+	      casa::uInt maxChunkSize = INT_MAX, bool blockRead = true);
 
   /// destructor required to sync buffers on the last iteration
   virtual ~TableDataIterator();
@@ -159,6 +160,13 @@ public:
   /// table. The method uses DataAccessor to obtain a reference to the
   /// visibility cube (hence no parameters). 
   void writeOriginalVis() const;
+
+  /// @brief write the given cube as the original visibilities of the current chunk
+  /// @details This version is used when the visibilities are held outside of the 
+  /// accessor of this iterator (e.g. by an adapter reading ahead). The shape
+  /// should match that of the current chunk.
+  /// @param[in] originalVis nRow x nChannel x nPol cube to write
+  void writeOriginalVis(const casa::Cube<casa::Complex> &originalVis) const;
   
   /// @brief check whether one can write to the main table
   /// @details Buffers held in subtables are not covered by this method.
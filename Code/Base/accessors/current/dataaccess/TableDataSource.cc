@@ -35,10 +35,13 @@
 // own includes
 #include <dataaccess/TableDataSource.h>
 #include <dataaccess/TableDataIterator.h>
+#include <dataaccess/TableConstDataIterator.h>
+#include <dataaccess/ReadAheadIteratorAdapter.h>
 #include <dataaccess/DataAccessError.h>
 #include <dataaccess/IDataConverterImpl.h>
 #include <dataaccess/ITableDataSelectorImpl.h>
 #include <dataaccess/SubtableInfoHolder.h>
+#include <dataaccess/CasacoreLock.h>
 
 using namespace askap;
 using namespace askap::accessors;
@@ -51,12 +54,13 @@ using namespace askap::accessors;
 ///                       (default is DATA)
 TableDataSource::TableDataSource(const std::string &fname,
                 int opt, const std::string &dataColumn) :
-         TableInfoAccessor(casa::Table(fname, (opt & MEMORY_BUFFERS) && 
+         TableInfoAccessor(CasacoreLock::openTable(fname, (opt & MEMORY_BUFFERS) && 
 				  !(opt & REMOVE_BUFFERS) && !(opt & WRITE_PERMITTED) ? 
 				      casa::Table::Old : casa::Table::Update),
 						opt & MEMORY_BUFFERS, dataColumn)
 {
   if (opt & REMOVE_BUFFERS) {
+      const CasacoreLock lock;
       if (table().keywordSet().isDefined("BUFFERS")) {
           try {
             table().rwKeywordSet().asTable("BUFFERS").markForDelete();
@@ -101,7 +105,17 @@ boost::shared_ptr<IDataIterator> TableDataSource::createIterator(const
        ASKAPTHROW(DataAccessLogicError, "Incompatible selector and/or "<<
                  "converter are received by the createIterator method");
    }
-   return boost::shared_ptr<IDataIterator>(new TableDataIterator(
+   boost::shared_ptr<IDataIterator> iter(new TableDataIterator(
                 getTableManager(),implSel,implConv,uvwMachineCacheSize(),
-                uvwMachineCacheTolerance())); 
+                uvwMachineCacheTolerance(), INT_MAX, blockRead())); 
+   if (readAheadChunks() > 0) {
+       // the read-only iterator is used by the background thread, the read-write
+       // one writes back the visibilities and gives access to buffers
+       boost::shared_ptr<IConstDataIterator> reader(new TableConstDataIterator(
+                getTableManager(),implSel,implConv,uvwMachineCacheSize(),
+                uvwMachineCacheTolerance(), INT_MAX, blockRead()));
+       return boost::shared_ptr<IDataIterator>(new ReadAheadIteratorAdapter(reader, iter,
+                readAheadChunks()));
+   }
+   return iter;
 }
@@ -30,6 +30,7 @@
 ///
 
 #include <dataaccess/UVWMachineCache.h>
+#include <dataaccess/CasacoreLock.h>
 #include <askap/AskapError.h>
 
 // for logging
@@ -95,7 +96,8 @@ const UVWMachineCache::machineType& UVWMachineCache::machine(const casa::MDirect
        boost::upgrade_to_unique_lock<boost::shared_mutex> uniqueLock(lock);
        ASKAPDEBUGASSERT(!machinePtr);
 #endif
-       // need to set up a new machine here
+       // need to set up a new machine here, the construction involves measures conversions
+       const CasacoreLock casaLock;
        machinePtr.reset(new machineType(tangent, phaseCentre, false, true));
        // swap the arguments in the uvw machine call. It gives the correct result on real data
        // although the casacore manual clearly says that the first argument is "out" and the second is "in".
@@ -0,0 +1,150 @@
+/// @file
+/// @brief in-memory cache of accessor chunks for one selection
+/// @details This class holds CachedVisChunk objects captured during the first pass of
+/// the iteration, so the following passes (e.g. major cycles) can be served from memory
+/// without touching the measurement set. The total memory can be limited. If the limit is
+/// reached, the cache keeps the chunks captured so far and the rest of the data are read
+/// from the table in every pass.
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author agent <agent@local>
+///
+
+#include <askap_accessors.h>
+
+#include <askap/AskapLogging.h>
+#include <askap/AskapError.h>
+
+#include <dataaccess/VisChunkCache.h>
+
+ASKAP_LOGGER(logger, ".dataaccess");
+
+namespace askap {
+
+namespace accessors {
+
+/// @brief construct an empty cache
+/// @param[in] name name of the cache used in the log (e.g. dataset name)
+/// @param[in] memoryLimit maximum memory in bytes, zero means no limit
+VisChunkCache::VisChunkCache(const std::string &name, const size_t memoryLimit) : itsName(name),
+     itsMemoryLimit(memoryLimit), itsFilled(false), itsTruncated(false), itsHits(0), itsMisses(0) {}
+
+/// @brief set the memory limit
+/// @details The limit only affects chunks added afterwards.
+/// @param[in] memoryLimit maximum memory in bytes, zero means no limit
+void VisChunkCache::setMemoryLimit(const size_t memoryLimit)
+{
+  itsMemoryLimit = memoryLimit;
+}
+
+/// @brief add a chunk captured from the given accessor
+/// @details Nothing is added if the cache is full. Either way, the miss counter is
+/// incremented as the accessor has been obtained from the table.
+/// @param[in] acc accessor to capture
+/// @return shared pointer to the new chunk or an empty pointer if the memory limit has been reached
+boost::shared_ptr<CachedVisChunk> VisChunkCache::add(const IConstDataAccessor &acc)
+{
+  ASKAPCHECK(!itsFilled, "An attempt to add a chunk to the visibility cache which has already been filled");
+  ++itsMisses;
+  if (itsTruncated) {
+      return boost::shared_ptr<CachedVisChunk>();
+  }
+  boost::shared_ptr<CachedVisChunk> result(new CachedVisChunk(acc));
+  if ((itsMemoryLimit > 0) && (memoryUsed() + result->memoryUsed() > itsMemoryLimit)) {
+      itsTruncated = true;
+      ASKAPLOG_WARN_STR(logger, "Visibility cache for "<<itsName<<" reached the memory limit of "<<
+                        itsMemoryLimit / 1048576<<" MB after "<<itsChunks.size()<<
+                        " iteration(s), the remaining data will be read from disk in every pass");
+      return boost::shared_ptr<CachedVisChunk>();
+  }
+  itsChunks.push_back(result);
+  return result;
+}
+
+/// @brief mark the end of the first pass
+/// @details After this call, the cache is considered filled, i.e. it contains either
+/// all chunks or the leading part of them (if it is truncated).
+void VisChunkCache::setFilled()
+{
+  if (!itsFilled) {
+      itsFilled = true;
+      ASKAPLOG_INFO_STR(logger, "Visibility cache for "<<itsName<<" has been filled: "<<itsChunks.size()<<
+                        " iteration(s), "<<memoryUsed() / 1048576<<" MB"<<(itsTruncated ? " (truncated)" : ""));
+  }
+}
+
+/// @brief obtain the chunk
+/// @details The hit counter is incremented.
+/// @param[in] index chunk index (0..nChunks()-1)
+/// @return shared pointer to the chunk
+boost::shared_ptr<CachedVisChunk> VisChunkCache::chunk(const size_t index)
+{
+  ASKAPCHECK(index < itsChunks.size(), "Chunk index "<<index<<" exceeds the number of cached chunks ("<<
+             itsChunks.size()<<")");
+  ++itsHits;
+  return itsChunks[index];
+}
+
+/// @brief register an iteration served from the table
+/// @details This method is used for the iterations beyond the truncation point.
+void VisChunkCache::registerMiss()
+{
+  ++itsMisses;
+}
+
+/// @brief total memory used by the cached chunks
+/// @return approximate number of bytes
+size_t VisChunkCache::memoryUsed() const
+{
+  size_t result = 0;
+  for (std::vector<boost::shared_ptr<CachedVisChunk> >::const_iterator ci = itsChunks.begin();
+       ci != itsChunks.end(); ++ci) {
+       ASKAPDEBUGASSERT(*ci);
+       result += (*ci)->memoryUsed();
+  }
+  return result;
+}
+
+/// @brief remove all chunks and reset counters
+void VisChunkCache::clear()
+{
+  itsChunks.clear();
+  itsFilled = false;
+  itsTruncated = false;
+  itsHits = 0;
+  itsMisses = 0;
+}
+
+/// @brief log hit and miss counters for the last pass and reset them
+void VisChunkCache::logStatistics()
+{
+  ASKAPLOG_INFO_STR(logger, "Visibility cache for "<<itsName<<": "<<itsHits<<" hit(s), "<<itsMisses<<
+                    " miss(es), "<<memoryUsed() / 1048576<<" MB in use");
+  itsHits = 0;
+  itsMisses = 0;
+}
+
+} // namespace accessors
+
+} // namespace askap
@@ -0,0 +1,144 @@
+/// @file
+/// @brief in-memory cache of accessor chunks for one selection
+/// @details This class holds CachedVisChunk objects captured during the first pass of
+/// the iteration, so the following passes (e.g. major cycles) can be served from memory
+/// without touching the measurement set. The total memory can be limited. If the limit is
+/// reached, the cache keeps the chunks captured so far and the rest of the data are read
+/// from the table in every pass.
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author agent <agent@local>
+///
+
+#ifndef ASKAP_ACCESSORS_VIS_CHUNK_CACHE_H
+#define ASKAP_ACCESSORS_VIS_CHUNK_CACHE_H
+
+// own includes
+#include <dataaccess/CachedVisChunk.h>
+#include <dataaccess/IConstDataAccessor.h>
+
+// boost includes
+#include <boost/shared_ptr.hpp>
+
+// std includes
+#include <vector>
+#include <string>
+
+namespace askap {
+
+namespace accessors {
+
+/// @brief in-memory cache of accessor chunks for one selection
+/// @details The cache is filled sequentially by CachingIteratorAdapter during the first
+/// pass and replayed in the following passes. A cache is only valid for the selection and
+/// conversion it was filled with, it is the responsibility of the user to keep one cache per
+/// selection. The cache also counts hits (iterations served from memory) and misses
+/// (iterations read from the table) for the log.
+/// @ingroup dataaccess_hlp
+class VisChunkCache {
+public:
+  /// @brief shared pointer type
+  typedef boost::shared_ptr<VisChunkCache> ShPtr;
+
+  /// @brief construct an empty cache
+  /// @param[in] name name of the cache used in the log (e.g. dataset name)
+  /// @param[in] memoryLimit maximum memory in bytes, zero means no limit
+  explicit VisChunkCache(const std::string &name = "", const size_t memoryLimit = 0);
+
+  /// @brief set the memory limit
+  /// @details The limit only affects chunks added afterwards.
+  /// @param[in] memoryLimit maximum memory in bytes, zero means no limit
+  void setMemoryLimit(const size_t memoryLimit);
+
+  /// @brief add a chunk captured from the given accessor
+  /// @details Nothing is added if the cache is full. Either way, the miss counter is
+  /// incremented as the accessor has been obtained from the table.
+  /// @param[in] acc accessor to capture
+  /// @return shared pointer to the new chunk or an empty pointer if the memory limit has been reached
+  boost::shared_ptr<CachedVisChunk> add(const IConstDataAccessor &acc);
+
+  /// @brief mark the end of the first pass
+  /// @details After this call, the cache is considered filled, i.e. it contains either
+  /// all chunks or the leading part of them (if it is truncated).
+  void setFilled();
+
+  /// @brief check whether the cache has been filled
+  /// @return true, if the first pass has been completed
+  inline bool isFilled() const { return itsFilled; }
+
+  /// @brief check whether the cache has only the leading part of the data
+  /// @return true, if the memory limit has been reached during the first pass
+  inline bool isTruncated() const { return itsTruncated; }
+
+  /// @brief number of chunks in the cache
+  inline size_t nChunks() const { return itsChunks.size(); }
+
+  /// @brief obtain the chunk
+  /// @details The hit counter is incremented.
+  /// @param[in] index chunk index (0..nChunks()-1)
+  /// @return shared pointer to the chunk
+  boost::shared_ptr<CachedVisChunk> chunk(const size_t index);
+
+  /// @brief register an iteration served from the table
+  /// @details This method is used for the iterations beyond the truncation point.
+  void registerMiss();
+
+  /// @brief total memory used by the cached chunks
+  /// @return approximate number of bytes
+  size_t memoryUsed() const;
+
+  /// @brief remove all chunks and reset counters
+  void clear();
+
+  /// @brief log hit and miss counters for the last pass and reset them
+  void logStatistics();
+
+private:
+  /// @brief name of the cache for the log
+  std::string itsName;
+
+  /// @brief memory limit in bytes, zero means no limit
+  size_t itsMemoryLimit;
+
+  /// @brief cached chunks
+  std::vector<boost::shared_ptr<CachedVisChunk> > itsChunks;
+
+  /// @brief true, if the first pass has been completed
+  bool itsFilled;
+
+  /// @brief true, if the memory limit has been reached
+  bool itsTruncated;
+
+  /// @brief number of iterations served from memory since the last logStatistics
+  size_t itsHits;
+
+  /// @brief number of iterations served from the table since the last logStatistics
+  size_t itsMisses;
+};
+
+} // namespace accessors
+
+} // namespace askap
+
+#endif // #ifndef ASKAP_ACCESSORS_VIS_CHUNK_CACHE_H
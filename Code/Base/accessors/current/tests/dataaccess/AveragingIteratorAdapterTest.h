@@ -0,0 +1,275 @@
+/// @file
+///
+/// @brief Tests of the iterator adapter averaging visibilities in time and frequency
+/// @details The weighted sum of visibilities and the sum of weights over the whole
+/// dataset should not depend on the averaging bins.
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author agent <agent@local>
+///
+
+#ifndef AVERAGING_ITERATOR_ADAPTER_TEST_H
+#define AVERAGING_ITERATOR_ADAPTER_TEST_H
+
+// boost includes
+#include <boost/shared_ptr.hpp>
+
+// cppunit includes
+#include <cppunit/extensions/HelperMacros.h>
+// own includes
+#include <dataaccess/TableDataSource.h>
+#include <dataaccess/IConstDataSource.h>
+#include <dataaccess/AveragingIteratorAdapter.h>
+#include <dataaccess/DataAccessError.h>
+#include <askap/AskapError.h>
+#include "TableTestRunner.h"
+
+// casa includes
+#include <casa/Arrays/ArrayMath.h>
+#include <casa/Arrays/ArrayLogical.h>
+#include <casa/BasicSL/Constants.h>
+
+// std includes
+#include <algorithm>
+#include <cmath>
+
+namespace askap {
+
+namespace accessors {
+
+class AveragingIteratorAdapterTest : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(AveragingIteratorAdapterTest);
+  CPPUNIT_TEST(testNoAveraging);
+  CPPUNIT_TEST(testTimeAveraging);
+  CPPUNIT_TEST(testChannelAveraging);
+  CPPUNIT_TEST(testSmearingLimit);
+  CPPUNIT_TEST_EXCEPTION(testBuffers,DataAccessError);
+  CPPUNIT_TEST_EXCEPTION(testNegativePointingTolerance,AskapError);
+  CPPUNIT_TEST_SUITE_END();
+protected:
+  /// @brief make an iterator for the test dataset
+  static boost::shared_ptr<IConstDataIterator> makeIterator() {
+     TableConstDataSource ds(TableTestRunner::msName());
+     IDataConverterPtr conv=ds.createConverter();
+     conv->setEpochFrame(); // ensures seconds since 0 MJD
+     conv->setFrequencyFrame(casa::MFrequency::Ref(casa::MFrequency::TOPO), "Hz");
+     conv->setDirectionFrame(casa::MDirection::Ref(casa::MDirection::J2000));
+     return ds.createConstIterator(conv);
+  }
+
+  /// @brief make an adapter for the test dataset
+  static boost::shared_ptr<AveragingIteratorAdapter> makeAdapter(double interval, casa::uInt nChanAvg) {
+     return boost::shared_ptr<AveragingIteratorAdapter>(new AveragingIteratorAdapter(makeIterator(),
+                        interval, nChanAvg));
+  }
+
+  /// @brief iterate over the whole dataset and accumulate the weighted sum of visibilities
+  /// @param[in] it iterator
+  /// @param[out] visSum sum of visibilities weighted with 1/sigma^2 over unflagged samples
+  /// @param[out] weightSum sum of weights
+  /// @return number of chunks
+  static size_t doPass(IConstDataIterator &it, casa::DComplex &visSum, double &weightSum) {
+     visSum = casa::DComplex(0., 0.);
+     weightSum = 0.;
+     size_t counter = 0;
+     for (it.init(); it.hasMore(); it.next(), ++counter) {
+          const casa::Cube<casa::Complex> &vis = it->visibility();
+          const casa::Cube<casa::Bool> &flag = it->flag();
+          const casa::Cube<casa::Complex> &noise = it->noise();
+          CPPUNIT_ASSERT(it->nRow() > 0);
+          CPPUNIT_ASSERT_EQUAL(it->nRow(), casa::uInt(it->uvw().nelements()));
+          for (casa::uInt row = 0; row < vis.nrow(); ++row) {
+               for (casa::uInt chan = 0; chan < vis.ncolumn(); ++chan) {
+                    for (casa::uInt pol = 0; pol < vis.nplane(); ++pol) {
+                         if (!flag(row, chan, pol)) {
+                             const double sigma = casa::real(noise(row, chan, pol));
+                             const double weight = sigma > 0 ? 1. / (sigma * sigma) : 1.;
+                             visSum += weight * casa::DComplex(vis(row, chan, pol));
+                             weightSum += weight;
+                         }
+                    }
+               }
+          }
+     }
+     return counter;
+  }
+
+  /// @brief check that the sums are the same
+  static void compareSums(const casa::DComplex &visSum1, double weightSum1,
+                          const casa::DComplex &visSum2, double weightSum2) {
+     CPPUNIT_ASSERT(weightSum1 > 0.);
+     CPPUNIT_ASSERT_DOUBLES_EQUAL(1., weightSum2 / weightSum1, 1e-4);
+     CPPUNIT_ASSERT(std::abs(visSum1 - visSum2) <= 1e-4 * std::abs(visSum1) + 1e-6 * weightSum1);
+  }
+
+public:
+  void testNoAveraging() {
+     boost::shared_ptr<IConstDataIterator> tableIt = makeIterator();
+     boost::shared_ptr<AveragingIteratorAdapter> it = makeAdapter(0., 1);
+     size_t counter = 0;
+     for (tableIt->init(), it->init(); tableIt->hasMore(); tableIt->next(), it->next(), ++counter) {
+          CPPUNIT_ASSERT(it->hasMore());
+          const IConstDataAccessor &acc = *(*tableIt);
+          CPPUNIT_ASSERT_DOUBLES_EQUAL(acc.time(), (*it)->time(), 1e-6);
+          CPPUNIT_ASSERT_EQUAL(acc.nRow(), (*it)->nRow());
+          CPPUNIT_ASSERT_EQUAL(acc.nChannel(), (*it)->nChannel());
+          CPPUNIT_ASSERT_EQUAL(acc.nPol(), (*it)->nPol());
+          CPPUNIT_ASSERT(casa::allEQ(acc.antenna1(), (*it)->antenna1()));
+          CPPUNIT_ASSERT(casa::allEQ(acc.antenna2(), (*it)->antenna2()));
+          CPPUNIT_ASSERT(casa::allEQ(acc.flag(), (*it)->flag()));
+          CPPUNIT_ASSERT(casa::allNear(acc.frequency(), (*it)->frequency(), 1e-12));
+          for (casa::uInt row = 0; row < acc.nRow(); ++row) {
+               for (casa::uInt dim = 0; dim < 3; ++dim) {
+                    CPPUNIT_ASSERT_DOUBLES_EQUAL(acc.uvw()[row](dim), (*it)->uvw()[row](dim), 1e-6);
+               }
+               for (casa::uInt chan = 0; chan < acc.nChannel(); ++chan) {
+                    for (casa::uInt pol = 0; pol < acc.nPol(); ++pol) {
+                         if (!acc.flag()(row, chan, pol)) {
+                             CPPUNIT_ASSERT_DOUBLES_EQUAL(0., casa::abs(acc.visibility()(row, chan, pol) -
+                                         (*it)->visibility()(row, chan, pol)), 1e-5);
+                         }
+                    }
+               }
+          }
+          // rotation of uvw is done by the adapter itself
+          const casa::MDirection tangent(acc.pointingDir1()[0], casa::MDirection::J2000);
+          CPPUNIT_ASSERT_DOUBLES_EQUAL(acc.rotatedUVW(tangent)[0](2), (*it)->rotatedUVW(tangent)[0](2), 1e-6);
+     }
+     CPPUNIT_ASSERT(!it->hasMore());
+     CPPUNIT_ASSERT_EQUAL(size_t(420), counter);
+  }
+
+  void testTimeAveraging() {
+     boost::shared_ptr<IConstDataIterator> tableIt = makeIterator();
+     casa::DComplex visSum1, visSum2;
+     double weightSum1, weightSum2;
+     CPPUNIT_ASSERT_EQUAL(size_t(420), doPass(*tableIt, visSum1, weightSum1));
+     // time step of the dataset
+     tableIt->init();
+     const double startTime = (*tableIt)->time();
+     tableIt->next();
+     CPPUNIT_ASSERT(tableIt->hasMore());
+     const double timeStep = (*tableIt)->time() - startTime;
+     CPPUNIT_ASSERT(timeStep > 0.);
+     // bins of up to 4 integrations
+     boost::shared_ptr<AveragingIteratorAdapter> it = makeAdapter(3.5 * timeStep, 1);
+     const size_t nChunks = doPass(*it, visSum2, weightSum2);
+     CPPUNIT_ASSERT(nChunks >= 105);
+     CPPUNIT_ASSERT(nChunks < 420);
+     compareSums(visSum1, weightSum1, visSum2, weightSum2);
+     // the first bin
+     it->init();
+     CPPUNIT_ASSERT(it->hasMore());
+     CPPUNIT_ASSERT_DOUBLES_EQUAL(startTime + 1.5 * timeStep, (*it)->time(), 1e-3);
+     // second pass should give the same result
+     CPPUNIT_ASSERT_EQUAL(nChunks, doPass(*it, visSum1, weightSum1));
+     compareSums(visSum1, weightSum1, visSum2, weightSum2);
+  }
+
+  void testChannelAveraging() {
+     boost::shared_ptr<IConstDataIterator> tableIt = makeIterator();
+     casa::DComplex visSum1, visSum2;
+     double weightSum1, weightSum2;
+     CPPUNIT_ASSERT_EQUAL(size_t(420), doPass(*tableIt, visSum1, weightSum1));
+     tableIt->init();
+     const casa::Vector<casa::Double> freq = (*tableIt)->frequency().copy();
+     const casa::uInt nChan = freq.nelements();
+     CPPUNIT_ASSERT(nChan > 1);
+     boost::shared_ptr<AveragingIteratorAdapter> it = makeAdapter(0., 2);
+     CPPUNIT_ASSERT_EQUAL(size_t(420), doPass(*it, visSum2, weightSum2));
+     compareSums(visSum1, weightSum1, visSum2, weightSum2);
+     it->init();
+     CPPUNIT_ASSERT(it->hasMore());
+     CPPUNIT_ASSERT_EQUAL((nChan + 1) / 2, (*it)->nChannel());
+     CPPUNIT_ASSERT_DOUBLES_EQUAL((freq[0] + freq[1]) / 2, (*it)->frequency()[0], 1.);
+     if (nChan % 2 == 1) {
+         // the last group is partial
+         CPPUNIT_ASSERT_DOUBLES_EQUAL(freq[nChan - 1], (*it)->frequency()[nChan / 2], 1.);
+     }
+  }
+
+  void testSmearingLimit() {
+     boost::shared_ptr<IConstDataIterator> tableIt = makeIterator();
+     tableIt->init();
+     double maxBaseline = 0.;
+     for (casa::uInt row = 0; row < (*tableIt)->nRow(); ++row) {
+          const casa::RigidVector<casa::Double, 3> &uvw = (*tableIt)->uvw()[row];
+          maxBaseline = std::max(maxBaseline, std::sqrt(uvw(0) * uvw(0) + uvw(1) * uvw(1) + uvw(2) * uvw(2)));
+     }
+     CPPUNIT_ASSERT(maxBaseline > 0.);
+     const double maxFreq = casa::max((*tableIt)->frequency());
+     const double chanWidth = std::abs((*tableIt)->frequency()[1] - (*tableIt)->frequency()[0]);
+     // 1 deg field radius, 1% amplitude loss
+     const double fieldRadius = casa::C::pi / 180.;
+     const double maxPhase = std::sqrt(0.24);
+     const double maxInterval = maxPhase * casa::C::c / (2. * casa::C::pi * 7.2921150e-5 * fieldRadius *
+                                maxBaseline * maxFreq);
+     const double maxBandwidth = maxPhase * casa::C::c / (2. * casa::C::pi * fieldRadius * maxBaseline);
+     const casa::uInt maxNChanAvg = std::max(casa::uInt(1), casa::uInt(std::floor(maxBandwidth / chanWidth)));
+
+     // the limit replaces infinite bins
+     boost::shared_ptr<AveragingIteratorAdapter> it = makeAdapter(-1., 100000);
+     it->setSmearingLimit(fieldRadius, 0.01);
+     it->init();
+     CPPUNIT_ASSERT(it->hasMore());
+     CPPUNIT_ASSERT_DOUBLES_EQUAL(maxInterval, it->interval(), 1e-6 * maxInterval);
+     CPPUNIT_ASSERT_EQUAL(maxNChanAvg, it->nChanAvg());
+     // smaller bins are not changed
+     it = makeAdapter(0., 1);
+     it->setSmearingLimit(fieldRadius, 0.01);
+     it->init();
+     CPPUNIT_ASSERT_DOUBLES_EQUAL(0., it->interval(), 1e-10);
+     CPPUNIT_ASSERT_EQUAL(casa::uInt(1), it->nChanAvg());
+  }
+
+  void testBuffers() {
+     boost::shared_ptr<AveragingIteratorAdapter> it = makeAdapter(0., 1);
+     it->init();
+     CPPUNIT_ASSERT(it->hasMore());
+     // changes to visibilities are allowed, but stay in the adapter
+     (*it)->rwVisibility().set(casa::Complex(1., 0.));
+     CPPUNIT_ASSERT(casa::allEQ((*it)->visibility(), casa::Complex(1., 0.)));
+     // this should throw an exception as buffers are not supported
+     it->buffer("TEST");
+  }
+
+  void testNegativePointingTolerance() {
+     boost::shared_ptr<AveragingIteratorAdapter> it = makeAdapter(0., 1);
+     casa::DComplex visSum1, visSum2;
+     double weightSum1, weightSum2;
+     const size_t nDefault = doPass(*it, visSum1, weightSum1);
+     // the pointing of the test dataset is fixed, so zero tolerance gives the same bins
+     it->setPointingTolerance(0.);
+     CPPUNIT_ASSERT_EQUAL(nDefault, doPass(*it, visSum2, weightSum2));
+     compareSums(visSum1, weightSum1, visSum2, weightSum2);
+     // this should throw an exception
+     it->setPointingTolerance(-1e-6);
+  }
+};
+
+} // namespace accessors
+
+} // namespace askap
+
+#endif // #ifndef AVERAGING_ITERATOR_ADAPTER_TEST_H
@@ -0,0 +1,176 @@
+/// @file
+///
+/// @brief Tests of the iterator adapter serving data from the visibility cache
+/// @details The first pass through the test measurement set fills the cache,
+/// the following passes should deliver exactly the same data from memory.
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author agent <agent@local>
+///
+
+#ifndef CACHING_ITERATOR_ADAPTER_TEST_H
+#define CACHING_ITERATOR_ADAPTER_TEST_H
+
+// boost includes
+#include <boost/shared_ptr.hpp>
+
+// cppunit includes
+#include <cppunit/extensions/HelperMacros.h>
+// own includes
+#include <dataaccess/TableDataSource.h>
+#include <dataaccess/IConstDataSource.h>
+#include <dataaccess/CachingIteratorAdapter.h>
+#include <dataaccess/VisChunkCache.h>
+#include <dataaccess/DataAccessError.h>
+#include <askap/AskapError.h>
+#include "TableTestRunner.h"
+
+// casa includes
+#include <casa/Arrays/ArrayMath.h>
+#include <casa/Arrays/ArrayLogical.h>
+#include <measures/Measures/MDirection.h>
+
+// std includes
+#include <vector>
+
+namespace askap {
+
+namespace accessors {
+
+class CachingIteratorAdapterTest : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(CachingIteratorAdapterTest);
+  CPPUNIT_TEST(testReplay);
+  CPPUNIT_TEST(testMemoryLimit);
+  CPPUNIT_TEST_EXCEPTION(testUnrecordedField,DataAccessError);
+  CPPUNIT_TEST_SUITE_END();
+protected:
+  /// @brief make an adapter for the test dataset
+  static boost::shared_ptr<CachingIteratorAdapter> makeAdapter(const VisChunkCache::ShPtr &cache) {
+     TableConstDataSource ds(TableTestRunner::msName());
+     IDataConverterPtr conv=ds.createConverter();
+     conv->setEpochFrame(); // ensures seconds since 0 MJD
+     conv->setDirectionFrame(casa::MDirection::Ref(casa::MDirection::J2000));
+     return boost::shared_ptr<CachingIteratorAdapter>(new CachingIteratorAdapter(ds.createConstIterator(conv), cache));
+  }
+
+  /// @brief iterate over the whole dataset and store time, visibility sum and rotated w
+  static size_t doPass(IDataIterator &it, std::vector<double> &times, std::vector<casa::Complex> &visSums,
+                       std::vector<double> &ws, std::vector<size_t> &nFlagged) {
+     times.resize(0);
+     visSums.resize(0);
+     ws.resize(0);
+     nFlagged.resize(0);
+     for (it.init(); it.hasMore(); it.next()) {
+          times.push_back(it->time());
+          visSums.push_back(casa::sum(it->visibility()));
+          nFlagged.push_back(casa::ntrue(it->flag()));
+          CPPUNIT_ASSERT(it->nRow() > 0);
+          const casa::MDirection tangent(it->pointingDir1()[0], casa::MDirection::J2000);
+          ws.push_back(it->rotatedUVW(tangent)[0](2));
+     }
+     return times.size();
+  }
+public:
+  void testReplay() {
+     VisChunkCache::ShPtr cache(new VisChunkCache("test"));
+     boost::shared_ptr<CachingIteratorAdapter> it = makeAdapter(cache);
+     std::vector<double> times1, times2, ws1, ws2;
+     std::vector<casa::Complex> vis1, vis2;
+     std::vector<size_t> flags1, flags2;
+     CPPUNIT_ASSERT_EQUAL(size_t(420), doPass(*it, times1, vis1, ws1, flags1));
+     CPPUNIT_ASSERT(cache->isFilled());
+     CPPUNIT_ASSERT(!cache->isTruncated());
+     CPPUNIT_ASSERT_EQUAL(size_t(420), cache->nChunks());
+     // a few replays, including one with a new adapter sharing the same cache
+     for (int pass = 0; pass < 3; ++pass) {
+          if (pass == 2) {
+              it = makeAdapter(cache);
+          }
+          CPPUNIT_ASSERT_EQUAL(size_t(420), doPass(*it, times2, vis2, ws2, flags2));
+          for (size_t step = 0; step < times1.size(); ++step) {
+               CPPUNIT_ASSERT_DOUBLES_EQUAL(times1[step], times2[step], 1e-6);
+               CPPUNIT_ASSERT_DOUBLES_EQUAL(0., casa::abs(vis1[step] - vis2[step]), 1e-5);
+               CPPUNIT_ASSERT_DOUBLES_EQUAL(ws1[step], ws2[step], 1e-6);
+               CPPUNIT_ASSERT_EQUAL(flags1[step], flags2[step]);
+          }
+     }
+  }
+
+  void testMemoryLimit() {
+     VisChunkCache::ShPtr cache(new VisChunkCache("test"));
+     boost::shared_ptr<CachingIteratorAdapter> it = makeAdapter(cache);
+     std::vector<double> times1, times2, ws1, ws2;
+     std::vector<casa::Complex> vis1, vis2;
+     std::vector<size_t> flags1, flags2;
+     CPPUNIT_ASSERT_EQUAL(size_t(420), doPass(*it, times1, vis1, ws1, flags1));
+     // now allow roughly 10% of the data
+     const size_t limit = cache->memoryUsed() / 10;
+     cache.reset(new VisChunkCache("test", limit));
+     it = makeAdapter(cache);
+     CPPUNIT_ASSERT_EQUAL(size_t(420), doPass(*it, times2, vis2, ws2, flags2));
+     CPPUNIT_ASSERT(cache->isFilled());
+     CPPUNIT_ASSERT(cache->isTruncated());
+     CPPUNIT_ASSERT(cache->nChunks() > 0);
+     CPPUNIT_ASSERT(cache->nChunks() < 420);
+     CPPUNIT_ASSERT(cache->memoryUsed() <= limit);
+     // replay, part of the data is read from the table
+     CPPUNIT_ASSERT_EQUAL(size_t(420), doPass(*it, times2, vis2, ws2, flags2));
+     for (size_t step = 0; step < times1.size(); ++step) {
+          CPPUNIT_ASSERT_DOUBLES_EQUAL(times1[step], times2[step], 1e-6);
+          CPPUNIT_ASSERT_DOUBLES_EQUAL(0., casa::abs(vis1[step] - vis2[step]), 1e-5);
+          CPPUNIT_ASSERT_DOUBLES_EQUAL(ws1[step], ws2[step], 1e-6);
+          CPPUNIT_ASSERT_EQUAL(flags1[step], flags2[step]);
+     }
+  }
+
+  void testUnrecordedField() {
+     VisChunkCache::ShPtr cache(new VisChunkCache("test"));
+     boost::shared_ptr<CachingIteratorAdapter> it = makeAdapter(cache);
+     try {
+        // fill the cache without requesting parallactic angles
+        size_t counter = 0;
+        for (it->init(); it->hasMore(); it->next(),++counter) {
+             (*it)->visibility();
+        }
+        CPPUNIT_ASSERT_EQUAL(size_t(420), counter);
+        it->init();
+        CPPUNIT_ASSERT(it->hasMore());
+        // uvw rotation can be computed without the table
+        const casa::MDirection tangent((*it)->pointingDir1()[0], casa::MDirection::J2000);
+        CPPUNIT_ASSERT_EQUAL((*it)->nRow(), (*it)->rotatedUVW(tangent).nelements());
+     }
+     catch (const AskapError &) {
+        CPPUNIT_ASSERT(false);
+     }
+     // this should throw an exception as the field hasn't been recorded
+     (*it)->feed1PA();
+  }
+
+};
+
+} // namespace accessors
+
+} // namespace askap
+
+#endif // #ifndef CACHING_ITERATOR_ADAPTER_TEST_H
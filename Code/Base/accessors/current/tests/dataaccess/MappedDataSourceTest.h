@@ -0,0 +1,210 @@
+/// @file
+///
+/// @brief Tests of the native memory-mapped visibility store
+/// @details The test measurement set is converted into the store and the data delivered
+/// by the mapped data source are compared with those read from the measurement set.
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author agent <agent@local>
+///
+
+
+#ifndef MAPPED_DATA_SOURCE_TEST_H
+#define MAPPED_DATA_SOURCE_TEST_H
+
+// boost includes
+#include <boost/shared_ptr.hpp>
+
+// cppunit includes
+#include <cppunit/extensions/HelperMacros.h>
+// own includes
+#include <dataaccess/TableConstDataSource.h>
+#include <dataaccess/MappedConstDataSource.h>
+#include <dataaccess/MappedVisStoreWriter.h>
+#include <dataaccess/DataAccessError.h>
+#include <dataaccess/SharedIter.h>
+#include "TableTestRunner.h"
+
+// casa includes
+#include <casa/Arrays/ArrayMath.h>
+#include <casa/Arrays/ArrayLogical.h>
+#include <tables/Tables/Table.h>
+#include <measures/TableMeasures/ScalarMeasColumn.h>
+#include <measures/Measures/MPosition.h>
+
+// std includes
+#include <cstdio>
+#include <string>
+
+namespace askap {
+
+namespace accessors {
+
+class MappedDataSourceTest : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(MappedDataSourceTest);
+  CPPUNIT_TEST(testConversion);
+  CPPUNIT_TEST(testSelection);
+  CPPUNIT_TEST(testCycles);
+  CPPUNIT_TEST(testLifetime);
+  CPPUNIT_TEST_EXCEPTION(testUnsupportedSelection, DataAccessLogicError);
+  CPPUNIT_TEST_SUITE_END();
+protected:
+  /// @brief name of the store created from the test measurement set
+  static const char* storeName() { return "mapped_test.vis"; }
+
+  /// @brief compare all fields of the table and mapped iterators
+  /// @param[in] tabIt iterator over the measurement set
+  /// @param[in] mapIt iterator over the store
+  /// @return number of chunks compared
+  static size_t compare(const IConstDataSharedIter &tabIt, const IConstDataSharedIter &mapIt) {
+     size_t counter = 0;
+     for (; tabIt != tabIt.end(); ++tabIt, ++mapIt, ++counter) {
+          CPPUNIT_ASSERT(mapIt != mapIt.end());
+          CPPUNIT_ASSERT_EQUAL(tabIt->nRow(), mapIt->nRow());
+          CPPUNIT_ASSERT_EQUAL(tabIt->nChannel(), mapIt->nChannel());
+          CPPUNIT_ASSERT_EQUAL(tabIt->nPol(), mapIt->nPol());
+          CPPUNIT_ASSERT_DOUBLES_EQUAL(tabIt->time(), mapIt->time(), 1e-6);
+          CPPUNIT_ASSERT(casa::max(casa::amplitude(tabIt->visibility() - mapIt->visibility())) < 1e-7);
+          CPPUNIT_ASSERT(casa::max(casa::amplitude(tabIt->noise() - mapIt->noise())) < 1e-7);
+          CPPUNIT_ASSERT(casa::allEQ(tabIt->flag(), mapIt->flag()));
+          CPPUNIT_ASSERT(casa::allEQ(tabIt->antenna1(), mapIt->antenna1()));
+          CPPUNIT_ASSERT(casa::allEQ(tabIt->antenna2(), mapIt->antenna2()));
+          CPPUNIT_ASSERT(casa::allEQ(tabIt->feed1(), mapIt->feed1()));
+          CPPUNIT_ASSERT(casa::allEQ(tabIt->feed2(), mapIt->feed2()));
+          CPPUNIT_ASSERT(casa::allNear(tabIt->feed1PA(), mapIt->feed1PA(), 1e-6));
+          CPPUNIT_ASSERT(casa::allNear(tabIt->frequency(), mapIt->frequency(), 1e-6));
+          for (casa::uInt row = 0; row < tabIt->nRow(); ++row) {
+               for (casa::uInt dim = 0; dim < 3; ++dim) {
+                    CPPUNIT_ASSERT_DOUBLES_EQUAL(tabIt->uvw()[row](dim), mapIt->uvw()[row](dim), 1e-6);
+               }
+               CPPUNIT_ASSERT(tabIt->pointingDir1()[row].separation(mapIt->pointingDir1()[row]) < 1e-9);
+               CPPUNIT_ASSERT(tabIt->dishPointing2()[row].separation(mapIt->dishPointing2()[row]) < 1e-9);
+          }
+          // uvw rotation is done by the same code for both sources
+          const casa::MDirection tangent(tabIt->pointingDir1()[0], casa::MDirection::J2000);
+          CPPUNIT_ASSERT_DOUBLES_EQUAL(tabIt->rotatedUVW(tangent)[0](2), mapIt->rotatedUVW(tangent)[0](2), 1e-6);
+     }
+     CPPUNIT_ASSERT(mapIt == mapIt.end());
+     return counter;
+  }
+public:
+  void setUp() {
+     const casa::Table antTable = casa::Table(TableTestRunner::msName()).keywordSet().asTable("ANTENNA");
+     const casa::ROScalarMeasColumn<casa::MPosition> posCol(antTable, "POSITION");
+     TableConstDataSource ds(TableTestRunner::msName());
+     MappedVisStoreWriter writer(storeName(), posCol(0));
+     IDataConverterPtr conv = ds.createConverter();
+     writer.setupConverter(*conv);
+     const boost::shared_ptr<IConstDataIterator> it = ds.createConstIterator(conv);
+     CPPUNIT_ASSERT_EQUAL(size_t(420), writer.append(*it));
+     writer.close();
+  }
+
+  void tearDown() {
+     std::remove(storeName());
+  }
+
+  void testConversion() {
+     TableConstDataSource tds(TableTestRunner::msName());
+     MappedConstDataSource mds(storeName());
+     // conversion of frequencies to the default frame is done on the fly
+     CPPUNIT_ASSERT_EQUAL(size_t(420), compare(tds.createConstIterator(), mds.createConstIterator()));
+  }
+
+  void testSelection() {
+     TableConstDataSource tds(TableTestRunner::msName());
+     MappedConstDataSource mds(storeName());
+     IDataSelectorPtr tabSel = tds.createSelector();
+     IDataSelectorPtr mapSel = mds.createSelector();
+     tabSel->chooseFeed(1);
+     mapSel->chooseFeed(1);
+     tabSel->chooseChannels(5, 3);
+     mapSel->chooseChannels(5, 3);
+     IDataConverterPtr tabConv = tds.createConverter();
+     IDataConverterPtr mapConv = mds.createConverter();
+     tabConv->setFrequencyFrame(casa::MFrequency::Ref(casa::MFrequency::TOPO), "Hz");
+     mapConv->setFrequencyFrame(casa::MFrequency::Ref(casa::MFrequency::TOPO), "Hz");
+     const size_t nChunks = compare(tds.createConstIterator(tabSel, tabConv), mds.createConstIterator(mapSel, mapConv));
+     CPPUNIT_ASSERT(nChunks > 0);
+     // a channel range of a chunk with all rows selected
+     mapSel = mds.createSelector();
+     mapSel->chooseChannels(5, 3);
+     IConstDataSharedIter it = mds.createConstIterator(mapSel);
+     IConstDataSharedIter allIt = mds.createConstIterator();
+     CPPUNIT_ASSERT(it != it.end());
+     CPPUNIT_ASSERT_EQUAL(casa::uInt(5), it->nChannel());
+     casa::Cube<casa::Complex> allVis(allIt->visibility().copy());
+     CPPUNIT_ASSERT(casa::allEQ(allVis(casa::IPosition(3, 0, 3, 0),
+                    casa::IPosition(3, it->nRow() - 1, 7, it->nPol() - 1)), it->visibility()));
+  }
+
+  void testLifetime() {
+     casa::Cube<casa::Complex> vis;
+     casa::Cube<casa::Complex> expected;
+     casa::Vector<casa::uInt> ant1;
+     casa::Vector<casa::uInt> expectedAnt1;
+     casa::Vector<casa::Double> freq;
+     {
+        MappedConstDataSource mds(storeName());
+        IConstDataSharedIter it = mds.createConstIterator();
+        CPPUNIT_ASSERT(it != it.end());
+        vis.reference(it->visibility());
+        expected = it->visibility().copy();
+        ant1.reference(it->antenna1());
+        expectedAnt1 = it->antenna1().copy();
+        freq.reference(it->frequency());
+        // the arrays referenced above are not reused for the next chunk
+        ++it;
+        CPPUNIT_ASSERT(it != it.end());
+        CPPUNIT_ASSERT(&it->visibility()(0,0,0) != &vis(0,0,0));
+     }
+     // the store is unmapped now, but the arrays obtained from the accessor are still valid
+     CPPUNIT_ASSERT(casa::allEQ(vis, expected));
+     CPPUNIT_ASSERT(casa::allEQ(ant1, expectedAnt1));
+     CPPUNIT_ASSERT(freq.nelements() > 0);
+     CPPUNIT_ASSERT(casa::allGT(freq, 0.));
+  }
+
+  void testCycles() {
+     MappedConstDataSource mds(storeName());
+     IDataSelectorPtr sel = mds.createSelector();
+     sel->chooseCycles(2, 5);
+     size_t counter = 0;
+     for (IConstDataSharedIter it = mds.createConstIterator(sel); it != it.end(); ++it, ++counter) {}
+     CPPUNIT_ASSERT_EQUAL(size_t(4), counter);
+  }
+
+  void testUnsupportedSelection() {
+     MappedConstDataSource mds(storeName());
+     IDataSelectorPtr sel = mds.createSelector();
+     // this should throw DataAccessLogicError
+     sel->chooseChannels(4, 0, 2);
+  }
+};
+
+} // namespace accessors
+
+} // namespace askap
+
+#endif // #ifndef MAPPED_DATA_SOURCE_TEST_H
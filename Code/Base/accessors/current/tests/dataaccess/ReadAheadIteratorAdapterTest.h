@@ -0,0 +1,236 @@
+/// @file
+///
+/// @brief Tests of the iterator adapter reading the data ahead in a background thread
+/// @details The data delivered with the read ahead should be exactly the same as those
+/// read directly. Visibilities written via the adapter should end up in the table.
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author agent <agent@local>
+///
+
+
+#ifndef READ_AHEAD_ITERATOR_ADAPTER_TEST_H
+#define READ_AHEAD_ITERATOR_ADAPTER_TEST_H
+
+// boost includes
+#include <boost/shared_ptr.hpp>
+
+// cppunit includes
+#include <cppunit/extensions/HelperMacros.h>
+// own includes
+#include <dataaccess/TableDataSource.h>
+#include <dataaccess/IConstDataSource.h>
+#include <dataaccess/IDataSource.h>
+#include <dataaccess/ReadAheadIteratorAdapter.h>
+#include <dataaccess/SharedIter.h>
+#include "TableTestRunner.h"
+
+// casa includes
+#include <casa/Arrays/ArrayMath.h>
+#include <casa/Arrays/ArrayLogical.h>
+#include <measures/Measures/MDirection.h>
+
+// std includes
+#include <vector>
+
+namespace askap {
+
+namespace accessors {
+
+class ReadAheadIteratorAdapterTest : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(ReadAheadIteratorAdapterTest);
+  CPPUNIT_TEST(testReadAhead);
+  CPPUNIT_TEST(testWriteBack);
+  CPPUNIT_TEST(testBuffers);
+  CPPUNIT_TEST(testLazyStart);
+  CPPUNIT_TEST(testOtherTableUsers);
+  CPPUNIT_TEST_SUITE_END();
+protected:
+  /// @brief iterate over the whole dataset and store time, visibility sum and rotated w
+  static size_t doPass(IConstDataIterator &it, std::vector<double> &times, std::vector<casa::Complex> &visSums,
+                       std::vector<double> &ws, std::vector<size_t> &nFlagged) {
+     times.resize(0);
+     visSums.resize(0);
+     ws.resize(0);
+     nFlagged.resize(0);
+     for (it.init(); it.hasMore(); it.next()) {
+          times.push_back(it->time());
+          visSums.push_back(casa::sum(it->visibility()));
+          nFlagged.push_back(casa::ntrue(it->flag()));
+          CPPUNIT_ASSERT(it->nRow() > 0);
+          CPPUNIT_ASSERT(it->noise().shape() == it->visibility().shape());
+          const casa::MDirection tangent(it->pointingDir1()[0], casa::MDirection::J2000);
+          ws.push_back(it->rotatedUVW(tangent)[0](2));
+     }
+     return times.size();
+  }
+
+  /// @brief make an iterator over the test dataset
+  /// @param[in] nChunks number of chunks to read ahead (0 means no read ahead)
+  static boost::shared_ptr<IConstDataIterator> makeIterator(casa::uInt nChunks) {
+     TableConstDataSource ds(TableTestRunner::msName());
+     ds.configureReadAhead(nChunks);
+     IDataConverterPtr conv=ds.createConverter();
+     conv->setEpochFrame(); // ensures seconds since 0 MJD
+     conv->setDirectionFrame(casa::MDirection::Ref(casa::MDirection::J2000));
+     return ds.createConstIterator(conv);
+  }
+
+  /// @brief check that two cubes are the same within the tolerance
+  static bool sameCubes(const casa::Cube<casa::Complex> &cube1, const casa::Cube<casa::Complex> &cube2) {
+     return (cube1.shape() == cube2.shape()) && (casa::max(casa::amplitude(cube1 - cube2)) < 1e-5);
+  }
+public:
+  void testReadAhead() {
+     boost::shared_ptr<IConstDataIterator> it = makeIterator(0);
+     std::vector<double> times1, times2, ws1, ws2;
+     std::vector<casa::Complex> vis1, vis2;
+     std::vector<size_t> flags1, flags2;
+     CPPUNIT_ASSERT_EQUAL(size_t(420), doPass(*it, times1, vis1, ws1, flags1));
+     it = makeIterator(3);
+     CPPUNIT_ASSERT(boost::dynamic_pointer_cast<ReadAheadIteratorAdapter>(it));
+     // the second pass restarts the read ahead
+     for (int pass = 0; pass < 2; ++pass) {
+          CPPUNIT_ASSERT_EQUAL(size_t(420), doPass(*it, times2, vis2, ws2, flags2));
+          for (size_t step = 0; step < times1.size(); ++step) {
+               CPPUNIT_ASSERT_DOUBLES_EQUAL(times1[step], times2[step], 1e-6);
+               CPPUNIT_ASSERT_DOUBLES_EQUAL(0., casa::abs(vis1[step] - vis2[step]), 1e-5);
+               CPPUNIT_ASSERT_DOUBLES_EQUAL(ws1[step], ws2[step], 1e-6);
+               CPPUNIT_ASSERT_EQUAL(flags1[step], flags2[step]);
+          }
+     }
+  }
+
+  void testWriteBack() {
+     TableDataSource tds(TableTestRunner::msName(), TableDataSource::WRITE_PERMITTED);
+     IDataSource &ds = tds;
+     // keep the original visibilities in memory
+     std::vector<casa::Cube<casa::Complex> > original;
+     for (IDataSharedIter it=ds.createIterator(); it!=it.end(); ++it) {
+          original.push_back(it->visibility().copy());
+     }
+     tds.configureReadAhead(2);
+     size_t counter = 0;
+     for (IDataSharedIter it=ds.createIterator(); it!=it.end(); ++it,++counter) {
+          it->rwVisibility().set(casa::Complex(1.,0.5));
+     }
+     CPPUNIT_ASSERT_EQUAL(original.size(), counter);
+     // check without the read ahead
+     tds.configureReadAhead(0);
+     for (IConstDataSharedIter cit = ds.createConstIterator(); cit != cit.end(); ++cit) {
+          CPPUNIT_ASSERT(casa::max(casa::amplitude(cit->visibility() - casa::Complex(1.,0.5))) < 1e-7);
+     }
+     // restore the original values with the read ahead
+     tds.configureReadAhead(2);
+     counter = 0;
+     for (IDataSharedIter it=ds.createIterator(); it!=it.end(); ++it,++counter) {
+          it->rwVisibility() = original[counter];
+     }
+     tds.configureReadAhead(0);
+     counter = 0;
+     for (IConstDataSharedIter cit = ds.createConstIterator(); cit != cit.end(); ++cit,++counter) {
+          CPPUNIT_ASSERT(sameCubes(cit->visibility(), original[counter]));
+     }
+  }
+
+  void testBuffers() {
+     TableDataSource tds(TableTestRunner::msName(), TableDataSource::MEMORY_BUFFERS);
+     IDataSource &ds = tds;
+     tds.configureReadAhead(2);
+     IDataSharedIter it = ds.createIterator();
+     std::vector<casa::Cube<casa::Complex> > original;
+     // a few steps with the read ahead before the buffer is requested
+     for (; (it != it.end()) && (original.size() < 5); ++it) {
+          original.push_back(it->visibility().copy());
+     }
+     for (; it != it.end(); ++it) {
+          original.push_back(it->visibility().copy());
+          it.buffer("TEST").rwVisibility() = it->visibility();
+          it.buffer("TEST").rwVisibility() *= casa::Complex(2.,0.);
+     }
+     CPPUNIT_ASSERT_EQUAL(size_t(420), original.size());
+     // the buffer is chosen, so the second pass goes through the second iterator
+     it.chooseBuffer("TEST");
+     size_t counter = 0;
+     for (it.init(); it != it.end(); ++it,++counter) {
+          if (counter >= 5) {
+              CPPUNIT_ASSERT(sameCubes(it->visibility(), original[counter] * casa::Complex(2.,0.)));
+          }
+     }
+     CPPUNIT_ASSERT_EQUAL(size_t(420), counter);
+     // the read ahead resumes when the original visibilities are chosen again
+     it.chooseOriginal();
+     const boost::shared_ptr<IDataIterator> iter = it;
+     std::vector<double> times, ws;
+     std::vector<casa::Complex> vis;
+     std::vector<size_t> flags;
+     CPPUNIT_ASSERT_EQUAL(size_t(420), doPass(*iter, times, vis, ws, flags));
+     for (size_t step = 0; step < vis.size(); ++step) {
+          CPPUNIT_ASSERT_DOUBLES_EQUAL(0., casa::abs(vis[step] - casa::sum(original[step])), 1e-5);
+     }
+  }
+
+  void testLazyStart() {
+     TableConstDataSource ds(TableTestRunner::msName());
+     ds.configureReadAhead(2);
+     IDataSelectorPtr sel = ds.createSelector();
+     IDataConverterPtr conv = ds.createConverter();
+     boost::shared_ptr<IConstDataIterator> it = ds.createConstIterator(sel, conv);
+     CPPUNIT_ASSERT(boost::dynamic_pointer_cast<ReadAheadIteratorAdapter>(it));
+     // nothing is read until the first access, so the selection can still be changed
+     sel->chooseChannels(2, 1);
+     size_t counter = 0;
+     for (; it->hasMore(); it->next(), ++counter) {
+          CPPUNIT_ASSERT_EQUAL(casa::uInt(2), (*it)->nChannel());
+          CPPUNIT_ASSERT_EQUAL(casa::uInt(2), (*it)->visibility().ncolumn());
+     }
+     CPPUNIT_ASSERT_EQUAL(size_t(420), counter);
+  }
+
+  void testOtherTableUsers() {
+     // the main thread reads the same dataset while two background threads read ahead
+     boost::shared_ptr<IConstDataIterator> it1 = makeIterator(2);
+     boost::shared_ptr<IConstDataIterator> it2 = makeIterator(3);
+     boost::shared_ptr<IConstDataIterator> plainIt = makeIterator(0);
+     size_t counter = 0;
+     for (it1->init(), it2->init(), plainIt->init(); plainIt->hasMore(); 
+          it1->next(), it2->next(), plainIt->next(), ++counter) {
+          CPPUNIT_ASSERT(it1->hasMore());
+          CPPUNIT_ASSERT(it2->hasMore());
+          const casa::Complex sum = casa::sum((*plainIt)->visibility());
+          CPPUNIT_ASSERT_DOUBLES_EQUAL(0., casa::abs(sum - casa::sum((*it1)->visibility())), 1e-5);
+          CPPUNIT_ASSERT_DOUBLES_EQUAL(0., casa::abs(sum - casa::sum((*it2)->visibility())), 1e-5);
+          CPPUNIT_ASSERT_DOUBLES_EQUAL((*plainIt)->time(), (*it1)->time(), 1e-6);
+     }
+     CPPUNIT_ASSERT_EQUAL(size_t(420), counter);
+     CPPUNIT_ASSERT(!it1->hasMore());
+     CPPUNIT_ASSERT(!it2->hasMore());
+  }
+};
+
+} // namespace accessors
+
+} // namespace askap
+
+#endif // #ifndef READ_AHEAD_ITERATOR_ADAPTER_TEST_H
@@ -72,6 +72,7 @@ class TableDataAccessTest : public CppUnit::TestFixture {
   CPPUNIT_TEST(originalVisRewriteTest);
   CPPUNIT_TEST(readOnlyTest);
   CPPUNIT_TEST(channelSelectionTest);
+  CPPUNIT_TEST(blockReadTest);
   CPPUNIT_TEST_SUITE_END();
 public:
   
@@ -107,8 +108,11 @@ public:
   void originalVisRewriteTest();
   /// test read/write with channel selection
   void channelSelectionTest();
+  /// test that block-oriented and row-by-row reads give the same result
+  void blockReadTest();
 protected:
   void doBufferTest() const;
+  void doBlockReadTest(const IDataSelectorPtr &sel) const;
 private:
   boost::shared_ptr<ITableInfoAccessor> itsTableInfoAccessor;  
 }; // class TableDataAccessTest
@@ -561,6 +565,65 @@ void TableDataAccessTest::originalVisRewriteTest()
   }
 }
 
+
+/// test that block-oriented and row-by-row reads give the same result
+void TableDataAccessTest::blockReadTest()
+{
+  // whole spectrum
+  doBlockReadTest(IDataSelectorPtr());
+  // subset of channels
+  TableConstDataSource ds(TableTestRunner::msName());
+  IDataSelectorPtr sel = ds.createSelector();
+  ASKAPASSERT(sel);
+  sel->chooseChannels(3, 5);
+  doBlockReadTest(sel);
+}
+
+/// @brief helper method to compare block and row reads for the given selection
+/// @param[in] sel selector (an empty pointer means no selection)
+void TableDataAccessTest::doBlockReadTest(const IDataSelectorPtr &sel) const
+{
+  TableConstDataSource blockDS(TableTestRunner::msName());
+  blockDS.configureBlockRead(true);
+  TableConstDataSource rowDS(TableTestRunner::msName());
+  rowDS.configureBlockRead(false);
+  const IConstDataSource &ds1 = blockDS;
+  const IConstDataSource &ds2 = rowDS;
+  IConstDataSharedIter it1 = sel ? ds1.createConstIterator(sel) : ds1.createConstIterator();
+  IConstDataSharedIter it2 = sel ? ds2.createConstIterator(sel) : ds2.createConstIterator();
+  for (; it1 != it1.end(); ++it1,++it2) {
+       CPPUNIT_ASSERT(it2 != it2.end());
+       CPPUNIT_ASSERT(it1->nRow() == it2->nRow());
+       CPPUNIT_ASSERT(it1->visibility().shape() == it2->visibility().shape());
+       CPPUNIT_ASSERT(it1->flag().shape() == it2->flag().shape());
+       CPPUNIT_ASSERT(it1->noise().shape() == it2->noise().shape());
+       const casa::Cube<casa::Complex> &vis1 = it1->visibility();
+       const casa::Cube<casa::Complex> &vis2 = it2->visibility();
+       const casa::Cube<casa::Bool> &flag1 = it1->flag();
+       const casa::Cube<casa::Bool> &flag2 = it2->flag();
+       const casa::Cube<casa::Complex> &noise1 = it1->noise();
+       const casa::Cube<casa::Complex> &noise2 = it2->noise();
+       for (casa::uInt row = 0; row < vis1.nrow(); ++row) {
+            for (casa::uInt column = 0; column < vis1.ncolumn(); ++column) {
+                 for (casa::uInt plane = 0; plane < vis1.nplane(); ++plane) {
+                      CPPUNIT_ASSERT(abs(vis1(row,column,plane) - vis2(row,column,plane))<1e-7);
+                      CPPUNIT_ASSERT(flag1(row,column,plane) == flag2(row,column,plane));
+                      CPPUNIT_ASSERT(abs(noise1(row,column,plane) - noise2(row,column,plane))<1e-7);
+                 }
+            }
+       }
+       const casa::Vector<casa::RigidVector<casa::Double, 3> > &uvw1 = it1->uvw();
+       const casa::Vector<casa::RigidVector<casa::Double, 3> > &uvw2 = it2->uvw();
+       CPPUNIT_ASSERT(uvw1.nelements() == uvw2.nelements());
+       for (casa::uInt row = 0; row < uvw1.nelements(); ++row) {
+            for (casa::uInt dim = 0; dim < 3; ++dim) {
+                 CPPUNIT_ASSERT(fabs(uvw1[row](dim) - uvw2[row](dim))<1e-7);
+            }
+       }
+  }
+  CPPUNIT_ASSERT(it2 == it2.end());
+}
+
 } // namespace accessors
 
 } // namespace askap
@@ -37,6 +37,10 @@
 #include "DataAccessorAdapterTest.h"
 #include "CachedAccessorFieldTest.h"
 #include "TimeChunkIteratorAdapterTest.h"
+#include "CachingIteratorAdapterTest.h"
+#include "ReadAheadIteratorAdapterTest.h"
+#include "MappedDataSourceTest.h"
+#include "AveragingIteratorAdapterTest.h"
 
 #include "TableTestRunner.h"
 
@@ -52,6 +56,10 @@ int main(int argc, char *argv[])
    runner.addTest(askap::accessors::DataAccessorAdapterTest::suite());
    runner.addTest(askap::accessors::CachedAccessorFieldTest::suite());
    runner.addTest(askap::accessors::TimeChunkIteratorAdapterTest::suite());
+   runner.addTest(askap::accessors::CachingIteratorAdapterTest::suite());
+   runner.addTest(askap::accessors::ReadAheadIteratorAdapterTest::suite());
+   runner.addTest(askap::accessors::MappedDataSourceTest::suite());
+   runner.addTest(askap::accessors::AveragingIteratorAdapterTest::suite());
    runner.run();
    return 0;
  }
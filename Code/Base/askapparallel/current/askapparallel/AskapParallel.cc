@@ -63,7 +63,8 @@ ASKAP_LOGGER(logger, ".askapparallel");
 
 AskapParallel::AskapParallel(int argc, const char** argv)
         : MPIComms(argc, const_cast<char**>(argv)), itsCommIndex(0),
-          itsNGroups(1)
+          itsNGroups(1), itsNodeCommsDefined(false), itsNodeCommIndex(0),
+          itsNodeLeadersCommIndex(0), itsIsNodeLeader(true)
 {
     // Logging may have already been configured, for example by
     // askap::Application so first check
@@ -293,6 +294,83 @@ size_t AskapParallel::nGroups() const
    return itsNGroups;
 }
 
+/// @brief define communicators for node-local operations
+/// @details This is a collective call for all ranks. Two communicators are
+/// created: one with all ranks on the same node (i.e. ranks which can share
+/// memory) and one with node leaders (the lowest rank on each node, so the
+/// master is always a leader and has rank 0 there). It is safe to call this
+/// method more than once, communicators are only created at the first call.
+/// This functionality requires MPI-3.
+/// @note Communicators for groups of workers (if any) should be defined first
+void AskapParallel::defineNodeComms()
+{
+  if (itsNodeCommsDefined) {
+      return;
+  }
+  ASKAPCHECK(isParallel(), "AskapParallel::defineNodeComms is only supposed to be used in the parallel mode");
+  itsNodeCommIndex = createNodeComm();
+  itsIsNodeLeader = (MPIComms::rank(itsNodeCommIndex) == 0);
+  itsNodeLeadersCommIndex = splitComm(itsIsNodeLeader ? 0 : -1);
+  itsNodeCommsDefined = true;
+  ASKAPLOG_INFO_STR(logger, "Rank "<<rank()<<" is "<<(itsIsNodeLeader ? "the leader" : "a follower")<<
+                    " of "<<MPIComms::nProcs(itsNodeCommIndex)<<" ranks on "<<nodeName());
+  if (isMaster()) {
+      ASKAPLOG_INFO_STR(logger, "Ranks are spread across "<<MPIComms::nProcs(itsNodeLeadersCommIndex)<<" nodes");
+  }
+}
+
+/// @return true if defineNodeComms has been called
+bool AskapParallel::nodeCommsDefined() const
+{
+  return itsNodeCommsDefined;
+}
+
+/// @brief check whether this rank is the node leader
+/// @return true, if this process has the lowest rank on this node
+bool AskapParallel::isNodeLeader() const
+{
+  ASKAPCHECK(itsNodeCommsDefined, "AskapParallel::defineNodeComms should be called first");
+  return itsIsNodeLeader;
+}
+
+/// @brief configure to communicate with node leaders
+/// @details This method selects the communicator with one rank per node (the
+/// master is rank 0). Use useAllWorkers to get back to the default state.
+/// @note This method should only be used in the node leaders
+void AskapParallel::useNodeLeaders()
+{
+  ASKAPCHECK(isNodeLeader(), "AskapParallel::useNodeLeaders should only be used in the node leaders");
+  itsCommIndex = itsNodeLeadersCommIndex;
+}
+
+/// @brief configure to communicate with all ranks on this node
+/// @details This method selects the communicator with all ranks on this node
+/// (the node leader is rank 0). Use useAllWorkers to get back to the default state.
+void AskapParallel::useNode()
+{
+  ASKAPCHECK(itsNodeCommsDefined, "AskapParallel::defineNodeComms should be called first");
+  itsCommIndex = itsNodeCommIndex;
+}
+
+/// @brief allocate memory shared between all ranks on this node
+/// @details This is a collective call for all ranks on the node. The memory
+/// is allocated by the node leader, all ranks get the pointer to the same buffer.
+/// Use freeShared to release the buffer.
+/// @param[in] size number of bytes to allocate (only used in the node leader)
+/// @return pointer to the shared buffer
+void* AskapParallel::allocateNodeShared(size_t size)
+{
+  ASKAPCHECK(itsNodeCommsDefined, "AskapParallel::defineNodeComms should be called first");
+  return allocateShared(size, itsNodeCommIndex);
+}
+
+/// @brief barrier across all ranks on this node
+void AskapParallel::nodeBarrier()
+{
+  ASKAPCHECK(itsNodeCommsDefined, "AskapParallel::defineNodeComms should be called first");
+  barrier(itsNodeCommIndex);
+}
+
 // this is a special tag for messages used in notifyMaster/waitForNotification communication pattern
 // can be anything, but it provides extra protection if this tag is different from the tag used for data. 
 #define ASKAPPARALLEL_NOTIFYMSG_TAG 1
@@ -365,6 +443,27 @@ void AskapParallel::broadcastBlob(LOFAR::BlobString& buf, int root)
     broadcast(buf.data(), size, root, itsCommIndex);
 }
 
+void AskapParallel::sendSegments(const MemorySegments& segments, int dest)
+{
+    for (MemorySegments::const_iterator ci = segments.begin(); ci != segments.end(); ++ci) {
+         send(ci->first, ci->second, dest);
+    }
+}
+
+void AskapParallel::receiveSegments(const MemorySegments& segments, int source)
+{
+    for (MemorySegments::const_iterator ci = segments.begin(); ci != segments.end(); ++ci) {
+         receive(ci->first, ci->second, source);
+    }
+}
+
+void AskapParallel::broadcastSegments(const MemorySegments& segments, int root)
+{
+    for (MemorySegments::const_iterator ci = segments.begin(); ci != segments.end(); ++ci) {
+         broadcast(ci->first, ci->second, root, itsCommIndex);
+    }
+}
+
 std::string AskapParallel::substitute(const std::string& s) const
 {
     casa::String cs(s);
@@ -32,6 +32,7 @@
 // System includes
 #include <string>
 #include <utility>
+#include <vector>
 
 // AskapSoft includes
 #include "Blob/BlobString.h"
@@ -100,6 +101,35 @@ class AskapParallel : public MPIComms {
         /// @param[in,out] buf    BlobString.
         /// @param[in] root       id of the root process.
         virtual void broadcastBlob(LOFAR::BlobString& buf, int root);
+
+        /// @brief list of contiguous memory segments
+        /// @details Each element is a pointer to the first byte and the number of bytes.
+        /// Large arrays are sent this way directly from their storage to avoid copying
+        /// them into a blob stream.
+        typedef std::vector<std::pair<void*, size_t> > MemorySegments;
+
+        /// @brief Send memory segments to the specified destination process.
+        /// @details Each segment is sent as a separate message (large segments are
+        /// split further by MPIComms::send). The world communicator is used, so this
+        /// method can follow a blob stream sent via BlobOBufMW.
+        /// @param[in] segments list of segments to send
+        /// @param[in] dest    the id of the process to send to.
+        virtual void sendSegments(const MemorySegments& segments, int dest);
+
+        /// @brief Receive memory segments from the specified source process.
+        /// @details The storage must be allocated by the caller, sizes of the segments
+        /// must match those given to sendSegments on the sending side.
+        /// @param[in] segments list of segments to receive data into.
+        /// @param[in] source  the id of the process to receive from.
+        virtual void receiveSegments(const MemorySegments& segments, int source);
+
+        /// @brief Broadcast memory segments to all ranks.
+        /// @details The storage must be allocated on all ranks with the same sizes
+        /// of the segments as on the root rank. Like broadcastBlob, this method
+        /// uses the communicator of the current group of workers.
+        /// @param[in] segments list of segments (sent on root, received on other ranks)
+        /// @param[in] root       id of the root process.
+        virtual void broadcastSegments(const MemorySegments& segments, int root);
         
         /// @brief notify master that the worker is ready for some operation
         /// @detais It is sometimes convenient to wait for a response from workers
@@ -170,6 +200,45 @@ class AskapParallel : public MPIComms {
         /// @return number of groups of workers
         size_t nGroups() const;
 
+        /// @brief define communicators for node-local operations
+        /// @details This is a collective call for all ranks. Two communicators are
+        /// created: one with all ranks on the same node (i.e. ranks which can share
+        /// memory) and one with node leaders (the lowest rank on each node, so the
+        /// master is always a leader and has rank 0 there). It is safe to call this
+        /// method more than once, communicators are only created at the first call.
+        /// This functionality requires MPI-3.
+        /// @note Communicators for groups of workers (if any) should be defined first
+        void defineNodeComms();
+
+        /// @return true if defineNodeComms has been called
+        bool nodeCommsDefined() const;
+
+        /// @brief check whether this rank is the node leader
+        /// @return true, if this process has the lowest rank on this node
+        bool isNodeLeader() const;
+
+        /// @brief configure to communicate with node leaders
+        /// @details This method selects the communicator with one rank per node (the
+        /// master is rank 0). Use useAllWorkers to get back to the default state.
+        /// @note This method should only be used in the node leaders
+        void useNodeLeaders();
+
+        /// @brief configure to communicate with all ranks on this node
+        /// @details This method selects the communicator with all ranks on this node
+        /// (the node leader is rank 0). Use useAllWorkers to get back to the default state.
+        void useNode();
+
+        /// @brief allocate memory shared between all ranks on this node
+        /// @details This is a collective call for all ranks on the node. The memory
+        /// is allocated by the node leader, all ranks get the pointer to the same buffer.
+        /// Use freeShared to release the buffer.
+        /// @param[in] size number of bytes to allocate (only used in the node leader)
+        /// @return pointer to the shared buffer
+        void* allocateNodeShared(size_t size);
+
+        /// @brief barrier across all ranks on this node
+        void nodeBarrier();
+
         /// Return the program name, i.e basename(argv[0])
         ///
         /// @param[in] argc argument count, from main()
@@ -204,6 +273,19 @@ class AskapParallel : public MPIComms {
         /// like broadcasts can then happen within the group. In particular, we can
         /// partition the model between workers.
         size_t itsNGroups;
+
+        /// @brief true, if node-local communicators have been defined
+        bool itsNodeCommsDefined;
+
+        /// @brief index of the communicator with all ranks on this node
+        size_t itsNodeCommIndex;
+
+        /// @brief index of the communicator with node leaders
+        /// @details This communicator is not valid on ranks which are not leaders
+        size_t itsNodeLeadersCommIndex;
+
+        /// @brief true, if this rank is the leader on this node
+        bool itsIsNodeLeader;
 };
 
 }
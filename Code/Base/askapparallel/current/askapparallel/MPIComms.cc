@@ -56,7 +56,7 @@ using namespace askap::askapparallel;
 ASKAP_LOGGER(logger, ".MPIComms");
 
 #ifdef HAVE_MPI
-MPIComms::MPIComms(int argc, char *argv[]) : itsCommunicators(1, MPI_COMM_NULL)
+MPIComms::MPIComms(int argc, char *argv[]) : itsCommunicators(1, MPI_COMM_NULL), itsNextRequest(0)
 {
     int rc = MPI_Init(&argc, &argv);
 
@@ -74,6 +74,10 @@ MPIComms::MPIComms(int argc, char *argv[]) : itsCommunicators(1, MPI_COMM_NULL)
 
 MPIComms::~MPIComms()
 {
+    for (std::map<void*, MPI_Win>::iterator it = itsSharedWindows.begin(); 
+         it != itsSharedWindows.end(); ++it) {
+         MPI_Win_free(&(it->second));
+    }
     for (size_t comm = itsCommunicators.size(); comm>0; --comm) {
          if (itsCommunicators[comm-1] != MPI_COMM_NULL) {
              MPI_Comm_free(&itsCommunicators[comm-1]);
@@ -302,6 +306,81 @@ void MPIComms::sumAndBroadcast(float *buf, size_t size, size_t comm)
    checkError(result,"MPI_Allreduce");
 }
 
+/// @brief sum raw double buffers across all ranks of the communicator via MPI_Reduce
+/// @details On the root rank this method does an in place operation, i.e. the buffer
+/// is replaced by the element-wise sum of buffers of all ranks. Buffers of other ranks
+/// are not modified. Large buffers are reduced in chunks of at most MAXINT elements.
+/// @param[in,out] buf data buffer (double type is assumed)
+/// @param[in] size number of elements in the buffer (double type is assumed)
+/// @param[in] root rank receiving the sum
+/// @param[in] comm communicator index
+void MPIComms::sumToRoot(double *buf, size_t size, int root, size_t comm)
+{
+   ASKAPDEBUGASSERT(comm < itsCommunicators.size());
+   ASKAPDEBUGASSERT(itsCommunicators[comm] != MPI_COMM_NULL);
+   const size_t c_maxint = std::numeric_limits<int>::max();
+   const bool isRoot = (rank(comm) == root);
+   for (size_t offset = 0; offset < size; offset += c_maxint) {
+        const int count = int(std::min(size - offset, c_maxint));
+        const int result = isRoot ? MPI_Reduce(MPI_IN_PLACE, (void*)(buf + offset), count, MPI_DOUBLE,
+                                               MPI_SUM, root, itsCommunicators[comm]) :
+                                    MPI_Reduce((void*)(buf + offset), 0, count, MPI_DOUBLE,
+                                               MPI_SUM, root, itsCommunicators[comm]);
+        checkError(result,"MPI_Reduce");
+   }
+}
+
+/// @brief start summing raw double buffers to the root rank without waiting
+/// @details This is the non-blocking version of sumToRoot (via MPI_Ireduce). The buffer
+/// must not be accessed on the root rank or modified on other ranks until waitRequest
+/// returns for this request. As for other collective calls, all ranks of the communicator
+/// should start reductions in the same order. Without MPI-3 the reduction is done
+/// immediately and waitRequest returns straight away.
+/// @param[in,out] buf data buffer (double type is assumed)
+/// @param[in] size number of elements in the buffer (double type is assumed)
+/// @param[in] root rank receiving the sum
+/// @param[in] comm communicator index
+/// @return request index to be passed to waitRequest
+size_t MPIComms::startSumToRoot(double *buf, size_t size, int root, size_t comm)
+{
+   ASKAPDEBUGASSERT(comm < itsCommunicators.size());
+   ASKAPDEBUGASSERT(itsCommunicators[comm] != MPI_COMM_NULL);
+   const size_t request = itsNextRequest++;
+#if MPI_VERSION >= 3
+   std::vector<MPI_Request> &requests = itsRequests[request];
+   const size_t c_maxint = std::numeric_limits<int>::max();
+   const bool isRoot = (rank(comm) == root);
+   for (size_t offset = 0; offset < size; offset += c_maxint) {
+        const int count = int(std::min(size - offset, c_maxint));
+        MPI_Request req = MPI_REQUEST_NULL;
+        const int result = isRoot ? MPI_Ireduce(MPI_IN_PLACE, (void*)(buf + offset), count, MPI_DOUBLE,
+                                                MPI_SUM, root, itsCommunicators[comm], &req) :
+                                    MPI_Ireduce((void*)(buf + offset), 0, count, MPI_DOUBLE,
+                                                MPI_SUM, root, itsCommunicators[comm], &req);
+        checkError(result,"MPI_Ireduce");
+        requests.push_back(req);
+   }
+#else
+   sumToRoot(buf, size, root, comm);
+#endif
+   return request;
+}
+
+/// @brief wait until the non-blocking operation is complete
+/// @param[in] request index returned by the method which started the operation
+void MPIComms::waitRequest(size_t request)
+{
+   ASKAPDEBUGASSERT(request < itsNextRequest);
+   std::map<size_t, std::vector<MPI_Request> >::iterator it = itsRequests.find(request);
+   if (it != itsRequests.end()) {
+       if (it->second.size() > 0) {
+           const int result = MPI_Waitall(int(it->second.size()), &(it->second[0]), MPI_STATUSES_IGNORE);
+           checkError(result, "MPI_Waitall");
+       }
+       itsRequests.erase(it);
+   }
+}
+
 /// @brief reduce a boolean flag across the number of ranks
 /// @details This method aggregates a flag (i.e. single boolean variable) across
 /// a number of ranks with the logical or operation. All ranks will have the same
@@ -320,6 +399,111 @@ void MPIComms::aggregateFlag(bool &flag, size_t comm)
    flag = bool(buf);
 }
 
+/// @brief split a communicator
+/// @details This method is a wrapper around MPI_Comm_split. It is a collective
+/// call for all ranks of the given communicator. Ranks passing the same
+/// non-negative colour end up in the same new communicator, the order is
+/// preserved. Ranks passing a negative colour are not included in any
+/// new communicator (the index is still returned, but it shouldn't be used).
+/// @param[in] colour colour of this rank, negative to exclude this rank
+/// @param[in] comm communicator index to split
+/// @return new communicator index
+size_t MPIComms::splitComm(int colour, size_t comm)
+{
+  ASKAPDEBUGASSERT(comm < itsCommunicators.size());
+  ASKAPDEBUGASSERT(itsCommunicators[comm] != MPI_COMM_NULL);
+  MPI_Comm newComm = MPI_COMM_NULL;
+  const int result = MPI_Comm_split(itsCommunicators[comm], colour < 0 ? MPI_UNDEFINED : colour,
+                                    rank(comm), &newComm);
+  checkError(result, "MPI_Comm_split");
+  const size_t newIndex = itsCommunicators.size();
+  itsCommunicators.push_back(newComm);
+  return newIndex;
+}
+
+/// @brief create a communicator of ranks sharing memory
+/// @details This is a collective call for all ranks of the given communicator.
+/// The new communicator contains all ranks running on the same node (i.e. ranks
+/// which can share memory). The order of ranks is preserved, so the rank with
+/// the lowest index on each node gets rank 0 in the new communicator. This method
+/// requires MPI-3.
+/// @param[in] comm communicator index to split
+/// @return new communicator index
+size_t MPIComms::createNodeComm(size_t comm)
+{
+  ASKAPDEBUGASSERT(comm < itsCommunicators.size());
+  ASKAPDEBUGASSERT(itsCommunicators[comm] != MPI_COMM_NULL);
+#if MPI_VERSION >= 3
+  MPI_Comm newComm = MPI_COMM_NULL;
+  const int result = MPI_Comm_split_type(itsCommunicators[comm], MPI_COMM_TYPE_SHARED, 
+                                         rank(comm), MPI_INFO_NULL, &newComm);
+  checkError(result, "MPI_Comm_split_type");
+  const size_t newIndex = itsCommunicators.size();
+  itsCommunicators.push_back(newComm);
+  return newIndex;
+#else
+  ASKAPTHROW(AskapError, "MPIComms::createNodeComm() requires MPI-3, this library supports MPI-"<<MPI_VERSION);
+#endif
+}
+
+/// @brief MPI_Barrier across all ranks of the communicator
+/// @param[in] comm communicator index
+void MPIComms::barrier(size_t comm)
+{
+  ASKAPDEBUGASSERT(comm < itsCommunicators.size());
+  ASKAPDEBUGASSERT(itsCommunicators[comm] != MPI_COMM_NULL);
+  const int result = MPI_Barrier(itsCommunicators[comm]);
+  checkError(result, "MPI_Barrier");
+}
+
+/// @brief allocate memory shared between all ranks of the communicator
+/// @details This is a collective call for all ranks of the given communicator,
+/// which must be created by createNodeComm. The memory is allocated by rank 0,
+/// all ranks receive the pointer to the same buffer which they can access
+/// directly. Synchronisation is the responsibility of the caller (e.g. a barrier
+/// after the data are written). This method requires MPI-3.
+/// @param[in] size number of bytes to allocate (only used on rank 0)
+/// @param[in] comm communicator index
+/// @return pointer to the shared buffer
+void* MPIComms::allocateShared(size_t size, size_t comm)
+{
+  ASKAPDEBUGASSERT(comm < itsCommunicators.size());
+  ASKAPDEBUGASSERT(itsCommunicators[comm] != MPI_COMM_NULL);
+#if MPI_VERSION >= 3
+  // allocate at least one element, so the pointer is unique and can be used as a key
+  const MPI_Aint localSize = rank(comm) == 0 ? MPI_Aint(std::max(size, sizeof(double))) : 0;
+  void *localBuf = 0;
+  MPI_Win win;
+  int result = MPI_Win_allocate_shared(localSize, 1, MPI_INFO_NULL, itsCommunicators[comm], 
+                                       &localBuf, &win);
+  checkError(result, "MPI_Win_allocate_shared");
+  MPI_Aint sharedSize = 0;
+  int dispUnit = 1;
+  void *buf = 0;
+  result = MPI_Win_shared_query(win, 0, &sharedSize, &dispUnit, &buf);
+  checkError(result, "MPI_Win_shared_query");
+  ASKAPDEBUGASSERT(buf != 0);
+  ASKAPDEBUGASSERT(itsSharedWindows.find(buf) == itsSharedWindows.end());
+  itsSharedWindows[buf] = win;
+  return buf;
+#else
+  ASKAPTHROW(AskapError, "MPIComms::allocateShared() requires MPI-3, this library supports MPI-"<<MPI_VERSION);
+#endif
+}
+
+/// @brief release memory allocated by allocateShared
+/// @details This is a collective call for all ranks of the communicator
+/// used to allocate the buffer.
+/// @param[in] buf pointer returned by allocateShared
+void MPIComms::freeShared(void *buf)
+{
+  std::map<void*, MPI_Win>::iterator it = itsSharedWindows.find(buf);
+  ASKAPCHECK(it != itsSharedWindows.end(), "MPIComms::freeShared() - the buffer has not been allocated by allocateShared");
+  const int result = MPI_Win_free(&(it->second));
+  checkError(result, "MPI_Win_free");
+  itsSharedWindows.erase(it);
+}
+
 void MPIComms::checkError(const int error, const std::string location) const
 {
     if (error == MPI_SUCCESS) {
@@ -392,6 +576,29 @@ void MPIComms::sumAndBroadcast(float *, size_t, size_t)
     ASKAPTHROW(AskapError, "MPIComms::sumAndBroadcast() cannot be used - configured without MPI");
 }
 
+/// @brief sum raw double buffers across all ranks of the communicator via MPI_Reduce
+/// @details On the root rank this method does an in place operation, i.e. the buffer
+/// is replaced by the element-wise sum of buffers of all ranks. Buffers of other ranks
+/// are not modified. Large buffers are reduced in chunks of at most MAXINT elements.
+/// @param[in,out] buf data buffer (double type is assumed)
+/// @param[in] size number of elements in the buffer (double type is assumed)
+/// @param[in] root rank receiving the sum
+/// @param[in] comm communicator index
+void MPIComms::sumToRoot(double *, size_t, int, size_t)
+{
+    ASKAPTHROW(AskapError, "MPIComms::sumToRoot() cannot be used - configured without MPI");
+}
+
+size_t MPIComms::startSumToRoot(double *, size_t, int, size_t)
+{
+    ASKAPTHROW(AskapError, "MPIComms::startSumToRoot() cannot be used - configured without MPI");
+}
+
+void MPIComms::waitRequest(size_t)
+{
+    ASKAPTHROW(AskapError, "MPIComms::waitRequest() cannot be used - configured without MPI");
+}
+
 /// @brief reduce a boolean flag across the number of ranks
 /// @details This method aggregates a flag (i.e. single boolean variable) across
 /// a number of ranks with the logical or operation. All ranks will have the same
@@ -417,6 +624,30 @@ size_t MPIComms::createComm(const std::vector<int> &, size_t)
     ASKAPTHROW(AskapError, "MPIComms::createComm() cannot be used - configured without MPI");
 }
 
+size_t MPIComms::splitComm(int, size_t)
+{
+    ASKAPTHROW(AskapError, "MPIComms::splitComm() cannot be used - configured without MPI");
+}
+
+size_t MPIComms::createNodeComm(size_t)
+{
+    ASKAPTHROW(AskapError, "MPIComms::createNodeComm() cannot be used - configured without MPI");
+}
+
+void MPIComms::barrier(size_t)
+{
+}
+
+void* MPIComms::allocateShared(size_t, size_t)
+{
+    ASKAPTHROW(AskapError, "MPIComms::allocateShared() cannot be used - configured without MPI");
+}
+
+void MPIComms::freeShared(void *)
+{
+    ASKAPTHROW(AskapError, "MPIComms::freeShared() cannot be used - configured without MPI");
+}
+
 void MPIComms::send(const void* buf, size_t size, int dest, int tag, size_t)
 {
     ASKAPTHROW(AskapError, "MPIComms::send() cannot be used - configured without MPI");
@@ -30,6 +30,7 @@
 // System includes
 #include <string>
 #include <vector>
+#include <map>
 
 // MPI-specific includes
 #ifdef HAVE_MPI
@@ -121,6 +122,35 @@ class MPIComms {
         /// @param[in] comm communicator index
         virtual void sumAndBroadcast(float *buf, size_t size, size_t comm);
         
+        /// @brief sum raw double buffers across all ranks of the communicator via MPI_Reduce
+        /// @details On the root rank this method does an in place operation, i.e. the buffer
+        /// is replaced by the element-wise sum of buffers of all ranks. Buffers of other ranks
+        /// are not modified. Large buffers are reduced in chunks of at most MAXINT elements.
+        /// @param[in,out] buf data buffer (double type is assumed)
+        /// @param[in] size number of elements in the buffer (double type is assumed)
+        /// @param[in] root rank receiving the sum
+        /// @param[in] comm communicator index, defaults to 0 (copy of the default 
+        /// world communicator)
+        virtual void sumToRoot(double *buf, size_t size, int root, size_t comm = 0);
+
+        /// @brief start summing raw double buffers to the root rank without waiting
+        /// @details This is the non-blocking version of sumToRoot (via MPI_Ireduce). The buffer
+        /// must not be accessed on the root rank or modified on other ranks until waitRequest
+        /// returns for this request. As for other collective calls, all ranks of the communicator
+        /// should start reductions in the same order. Without MPI-3 the reduction is done
+        /// immediately and waitRequest returns straight away.
+        /// @param[in,out] buf data buffer (double type is assumed)
+        /// @param[in] size number of elements in the buffer (double type is assumed)
+        /// @param[in] root rank receiving the sum
+        /// @param[in] comm communicator index, defaults to 0 (copy of the default 
+        /// world communicator)
+        /// @return request index to be passed to waitRequest
+        virtual size_t startSumToRoot(double *buf, size_t size, int root, size_t comm = 0);
+
+        /// @brief wait until the non-blocking operation is complete
+        /// @param[in] request index returned by the method which started the operation
+        virtual void waitRequest(size_t request);
+        
         /// @brief reduce a boolean flag across the number of ranks
         /// @details This method aggregates a flag (i.e. single boolean variable) across
         /// a number of ranks with the logical or operation. All ranks will have the same
@@ -140,6 +170,51 @@ class MPIComms {
         /// @return new communicator index
         virtual size_t createComm(const std::vector<int> &group, size_t comm = 0);
 
+        /// @brief split a communicator
+        /// @details This method is a wrapper around MPI_Comm_split. It is a collective
+        /// call for all ranks of the given communicator. Ranks passing the same
+        /// non-negative colour end up in the same new communicator, the order is
+        /// preserved. Ranks passing a negative colour are not included in any
+        /// new communicator (the index is still returned, but it shouldn't be used).
+        /// @param[in] colour colour of this rank, negative to exclude this rank
+        /// @param[in] comm communicator index to split, defaults to 0 (copy of the default 
+        ///            world communicator)
+        /// @return new communicator index
+        virtual size_t splitComm(int colour, size_t comm = 0);
+
+        /// @brief create a communicator of ranks sharing memory
+        /// @details This is a collective call for all ranks of the given communicator.
+        /// The new communicator contains all ranks running on the same node (i.e. ranks
+        /// which can share memory). The order of ranks is preserved, so the rank with
+        /// the lowest index on each node gets rank 0 in the new communicator. This method
+        /// requires MPI-3.
+        /// @param[in] comm communicator index to split, defaults to 0 (copy of the default 
+        ///            world communicator)
+        /// @return new communicator index
+        virtual size_t createNodeComm(size_t comm = 0);
+
+        /// @brief MPI_Barrier across all ranks of the communicator
+        /// @param[in] comm communicator index, defaults to 0 (copy of the default 
+        /// world communicator)
+        virtual void barrier(size_t comm = 0);
+
+        /// @brief allocate memory shared between all ranks of the communicator
+        /// @details This is a collective call for all ranks of the given communicator,
+        /// which must be created by createNodeComm. The memory is allocated by rank 0,
+        /// all ranks receive the pointer to the same buffer which they can access
+        /// directly. Synchronisation is the responsibility of the caller (e.g. a barrier
+        /// after the data are written). This method requires MPI-3.
+        /// @param[in] size number of bytes to allocate (only used on rank 0)
+        /// @param[in] comm communicator index
+        /// @return pointer to the shared buffer
+        virtual void* allocateShared(size_t size, size_t comm);
+
+        /// @brief release memory allocated by allocateShared
+        /// @details This is a collective call for all ranks of the communicator
+        /// used to allocate the buffer.
+        /// @param[in] buf pointer returned by allocateShared
+        virtual void freeShared(void *buf);
+
     private:
         // Check for error status and handle accordingly
         void checkError(const int error, const std::string location) const;
@@ -157,6 +232,15 @@ class MPIComms {
 
         // Specific MPI Communicator for this class
         std::vector<MPI_Comm> itsCommunicators;
+
+        // MPI windows of the buffers created by allocateShared
+        std::map<void*, MPI_Win> itsSharedWindows;
+
+        // outstanding non-blocking operations (large buffers need more than one MPI request)
+        std::map<size_t, std::vector<MPI_Request> > itsRequests;
+
+        // index of the next non-blocking operation
+        size_t itsNextRequest;
 #endif
 
         // No support for assignment
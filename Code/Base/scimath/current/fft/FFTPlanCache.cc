@@ -0,0 +1,301 @@
+/// @file FFTPlanCache.cc
+///
+/// FFTPlanCache: process-wide cache of FFTW plans used by the FFT wrapper
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author agent <agent@local>
+
+// Include own header file first
+#include "fft/FFTPlanCache.h"
+
+// ASKAPsoft includes
+#include "askap/AskapError.h"
+
+// boost includes
+#include <boost/thread/locks.hpp>
+
+// std includes
+#include <cstdio>
+#include <sstream>
+#include <unistd.h>
+
+namespace askap {
+    namespace scimath {
+
+        FFTPlanCache::PlanKey::PlanKey(const int nx, const int ny, const int howMany,
+                                       const bool forward, const int alignment) :
+            itsNX(nx), itsNY(ny), itsHowMany(howMany), itsForward(forward), itsAlignment(alignment) {}
+
+        bool FFTPlanCache::PlanKey::operator<(const PlanKey &other) const
+        {
+            if (itsNX != other.itsNX) {
+                return itsNX < other.itsNX;
+            }
+            if (itsNY != other.itsNY) {
+                return itsNY < other.itsNY;
+            }
+            if (itsHowMany != other.itsHowMany) {
+                return itsHowMany < other.itsHowMany;
+            }
+            if (itsForward != other.itsForward) {
+                return !itsForward;
+            }
+            return itsAlignment < other.itsAlignment;
+        }
+
+        /// @details Function-local static ensures the cache is created on first use
+        /// and that the wisdom is saved at the exit from the program.
+        FFTPlanCache& FFTPlanCache::instance()
+        {
+            static FFTPlanCache theCache;
+            return theCache;
+        }
+
+        FFTPlanCache::FFTPlanCache() : itsNThreads(1), itsPlanner("estimate"), itsSaveWisdom(false),
+                                       itsNPlansInUse(0)
+        {
+            // threaded FFTW has to be initialised before any other call to FFTW
+            ASKAPCHECK(fftw_init_threads() != 0, "Unable to initialise double precision threaded FFTW");
+            ASKAPCHECK(fftwf_init_threads() != 0, "Unable to initialise single precision threaded FFTW");
+        }
+
+        FFTPlanCache::~FFTPlanCache()
+        {
+            // no exceptions should escape the destructor
+            try {
+                saveWisdom();
+            } catch (const AskapError &) {}
+            clear();
+        }
+
+        /// @details A wisdom file which can't be imported (e.g. written by another version
+        /// of FFTW) is not fatal, the plans are then created from scratch and the file is
+        /// overwritten if this process saves the wisdom.
+        bool FFTPlanCache::configure(const int nThreads, const std::string &planner,
+                                     const std::string &wisdomFile, const bool saveWisdom)
+        {
+            ASKAPCHECK(nThreads > 0, "Number of FFTW threads should be positive, you have "<<nThreads);
+            ASKAPCHECK((planner == "estimate") || (planner == "measure") || (planner == "patient") ||
+                       (planner == "exhaustive"), "Unknown FFTW planner effort "<<planner<<
+                       ", it should be one of estimate, measure, patient or exhaustive");
+            boost::unique_lock<boost::mutex> lock(itsMutex);
+            if ((nThreads != itsNThreads) || (planner != itsPlanner)) {
+                destroyPlans(lock);
+            }
+            itsNThreads = nThreads;
+            itsPlanner = planner;
+            itsWisdomFile = wisdomFile;
+            itsSaveWisdom = saveWisdom;
+            bool success = true;
+            if (itsWisdomFile != "") {
+                // a missing file is not an error, wisdom will be accumulated and saved later
+                const std::string singleName = itsWisdomFile + ".single";
+                const std::string doubleName = itsWisdomFile + ".double";
+                FILE *fp = fopen(singleName.c_str(), "r");
+                if (fp != NULL) {
+                    success = (fftwf_import_wisdom_from_file(fp) != 0);
+                    fclose(fp);
+                }
+                fp = fopen(doubleName.c_str(), "r");
+                if (fp != NULL) {
+                    success = (fftw_import_wisdom_from_file(fp) != 0) && success;
+                    fclose(fp);
+                }
+            }
+            return success;
+        }
+
+        void FFTPlanCache::saveWisdom() const
+        {
+            boost::lock_guard<boost::mutex> lock(itsMutex);
+            if ((itsWisdomFile == "") || !itsSaveWisdom) {
+                return;
+            }
+            exportWisdom(itsWisdomFile + ".single", fftwf_export_wisdom_to_file);
+            exportWisdom(itsWisdomFile + ".double", fftw_export_wisdom_to_file);
+        }
+
+        /// @details The temporary file name includes the process id, so concurrent writers
+        /// never share it. The rename is atomic, i.e. readers either get the old or the new file.
+        void FFTPlanCache::exportWisdom(const std::string &name, void (*exporter)(FILE *))
+        {
+            std::ostringstream tmpName;
+            tmpName << name << ".tmp" << getpid();
+            FILE *fp = fopen(tmpName.str().c_str(), "w");
+            ASKAPCHECK(fp != NULL, "Unable to open "<<tmpName.str()<<" to save FFTW wisdom");
+            exporter(fp);
+            const bool written = (ferror(fp) == 0);
+            if ((fclose(fp) != 0) || !written || (std::rename(tmpName.str().c_str(), name.c_str()) != 0)) {
+                std::remove(tmpName.str().c_str());
+                ASKAPTHROW(AskapError, "Unable to save FFTW wisdom into "<<name);
+            }
+        }
+
+        void FFTPlanCache::clear()
+        {
+            boost::unique_lock<boost::mutex> lock(itsMutex);
+            destroyPlans(lock);
+        }
+
+        void FFTPlanCache::destroyPlans(boost::unique_lock<boost::mutex> &lock)
+        {
+            ASKAPDEBUGASSERT(lock.owns_lock());
+            while (itsNPlansInUse > 0) {
+                itsPlansReleased.wait(lock);
+            }
+            for (std::map<PlanKey, fftwf_plan>::iterator it = itsSinglePlans.begin();
+                 it != itsSinglePlans.end(); ++it) {
+                 fftwf_destroy_plan(it->second);
+            }
+            itsSinglePlans.clear();
+            for (std::map<PlanKey, fftw_plan>::iterator it = itsDoublePlans.begin();
+                 it != itsDoublePlans.end(); ++it) {
+                 fftw_destroy_plan(it->second);
+            }
+            itsDoublePlans.clear();
+        }
+
+        void FFTPlanCache::releasePlan()
+        {
+            boost::lock_guard<boost::mutex> lock(itsMutex);
+            ASKAPDEBUGASSERT(itsNPlansInUse > 0);
+            if (--itsNPlansInUse == 0) {
+                itsPlansReleased.notify_all();
+            }
+        }
+
+        size_t FFTPlanCache::size() const
+        {
+            boost::lock_guard<boost::mutex> lock(itsMutex);
+            return itsSinglePlans.size() + itsDoublePlans.size();
+        }
+
+        unsigned FFTPlanCache::plannerFlags() const
+        {
+            if (itsPlanner == "measure") {
+                return FFTW_MEASURE;
+            } else if (itsPlanner == "patient") {
+                return FFTW_PATIENT;
+            } else if (itsPlanner == "exhaustive") {
+                return FFTW_EXHAUSTIVE;
+            }
+            return FFTW_ESTIMATE;
+        }
+
+        /// @details FFTW_ESTIMATE doesn't touch the arrays during planning, so the plan is created
+        /// directly for the given data. More expensive planners overwrite the arrays, so a scratch
+        /// buffer is used instead. Data which are not SIMD-aligned get a plan created with FFTW_UNALIGNED.
+        /// Note, FFTW expects the slowest varying dimension first.
+        fftwf_plan FFTPlanCache::getPlan(casa::Complex *data, const int nx, const int ny,
+                                         const int howMany, const bool forward)
+        {
+            const int alignment = fftwf_alignment_of(reinterpret_cast<float*>(data));
+            const PlanKey key(nx, ny, howMany, forward, alignment);
+            boost::lock_guard<boost::mutex> lock(itsMutex);
+            const std::map<PlanKey, fftwf_plan>::const_iterator ci = itsSinglePlans.find(key);
+            if (ci != itsSinglePlans.end()) {
+                ++itsNPlansInUse;
+                return ci->second;
+            }
+            const int rank = ny > 1 ? 2 : 1;
+            const int n[2] = {ny > 1 ? ny : nx, nx};
+            const int dist = nx * ny;
+            const unsigned flags = plannerFlags() | (alignment != 0 ? FFTW_UNALIGNED : 0);
+            fftwf_plan_with_nthreads(itsNThreads);
+            fftwf_complex *buf = reinterpret_cast<fftwf_complex*>(data);
+            if (flags & FFTW_ESTIMATE) {
+                const fftwf_plan p = fftwf_plan_many_dft(rank, n, howMany, buf, NULL, 1, dist, buf, NULL, 1, dist,
+                                         forward ? FFTW_FORWARD : FFTW_BACKWARD, flags);
+                ASKAPCHECK(p != NULL, "Unable to create single precision FFTW plan for "<<nx<<" x "<<ny);
+                itsSinglePlans[key] = p;
+                ++itsNPlansInUse;
+                return p;
+            }
+            buf = reinterpret_cast<fftwf_complex*>(fftwf_malloc(sizeof(fftwf_complex) * size_t(dist) * size_t(howMany)));
+            ASKAPCHECK(buf != NULL, "Unable to allocate scratch buffer to create FFTW plan for "<<nx<<" x "<<ny);
+            const fftwf_plan p = fftwf_plan_many_dft(rank, n, howMany, buf, NULL, 1, dist, buf, NULL, 1, dist,
+                                     forward ? FFTW_FORWARD : FFTW_BACKWARD, flags);
+            fftwf_free(buf);
+            ASKAPCHECK(p != NULL, "Unable to create single precision FFTW plan for "<<nx<<" x "<<ny);
+            itsSinglePlans[key] = p;
+            ++itsNPlansInUse;
+            return p;
+        }
+
+        /// @details See the single precision version
+        fftw_plan FFTPlanCache::getPlan(casa::DComplex *data, const int nx, const int ny,
+                                        const int howMany, const bool forward)
+        {
+            const int alignment = fftw_alignment_of(reinterpret_cast<double*>(data));
+            const PlanKey key(nx, ny, howMany, forward, alignment);
+            boost::lock_guard<boost::mutex> lock(itsMutex);
+            const std::map<PlanKey, fftw_plan>::const_iterator ci = itsDoublePlans.find(key);
+            if (ci != itsDoublePlans.end()) {
+                ++itsNPlansInUse;
+                return ci->second;
+            }
+            const int rank = ny > 1 ? 2 : 1;
+            const int n[2] = {ny > 1 ? ny : nx, nx};
+            const int dist = nx * ny;
+            const unsigned flags = plannerFlags() | (alignment != 0 ? FFTW_UNALIGNED : 0);
+            fftw_plan_with_nthreads(itsNThreads);
+            fftw_complex *buf = reinterpret_cast<fftw_complex*>(data);
+            if (flags & FFTW_ESTIMATE) {
+                const fftw_plan p = fftw_plan_many_dft(rank, n, howMany, buf, NULL, 1, dist, buf, NULL, 1, dist,
+                                        forward ? FFTW_FORWARD : FFTW_BACKWARD, flags);
+                ASKAPCHECK(p != NULL, "Unable to create double precision FFTW plan for "<<nx<<" x "<<ny);
+                itsDoublePlans[key] = p;
+                ++itsNPlansInUse;
+                return p;
+            }
+            buf = reinterpret_cast<fftw_complex*>(fftw_malloc(sizeof(fftw_complex) * size_t(dist) * size_t(howMany)));
+            ASKAPCHECK(buf != NULL, "Unable to allocate scratch buffer to create FFTW plan for "<<nx<<" x "<<ny);
+            const fftw_plan p = fftw_plan_many_dft(rank, n, howMany, buf, NULL, 1, dist, buf, NULL, 1, dist,
+                                    forward ? FFTW_FORWARD : FFTW_BACKWARD, flags);
+            fftw_free(buf);
+            ASKAPCHECK(p != NULL, "Unable to create double precision FFTW plan for "<<nx<<" x "<<ny);
+            itsDoublePlans[key] = p;
+            ++itsNPlansInUse;
+            return p;
+        }
+
+        void FFTPlanCache::execute(casa::Complex *data, const int nx, const int ny, const int howMany,
+                                   const bool forward)
+        {
+            const fftwf_plan p = getPlan(data, nx, ny, howMany, forward);
+            // new-array execute is thread-safe, no need to hold the lock here
+            fftwf_execute_dft(p, reinterpret_cast<fftwf_complex*>(data), reinterpret_cast<fftwf_complex*>(data));
+            releasePlan();
+        }
+
+        void FFTPlanCache::execute(casa::DComplex *data, const int nx, const int ny, const int howMany,
+                                   const bool forward)
+        {
+            const fftw_plan p = getPlan(data, nx, ny, howMany, forward);
+            // new-array execute is thread-safe, no need to hold the lock here
+            fftw_execute_dft(p, reinterpret_cast<fftw_complex*>(data), reinterpret_cast<fftw_complex*>(data));
+            releasePlan();
+        }
+    }
+}
@@ -0,0 +1,212 @@
+/// @file FFTPlanCache.h
+///
+/// FFTPlanCache: process-wide cache of FFTW plans used by the FFT wrapper
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author agent <agent@local>
+///
+
+#ifndef ASKAP_SCIMATH_FFTPLANCACHE_H
+#define ASKAP_SCIMATH_FFTPLANCACHE_H
+
+// ASKAPsoft includes
+#include <casa/BasicSL/Complex.h>
+#include <fftw3.h>
+
+// boost include
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/locks.hpp>
+
+// std includes
+#include <cstdio>
+#include <map>
+#include <string>
+
+namespace askap
+{
+    namespace scimath
+    {
+        /// @brief process-wide cache of FFTW plans
+        /// @details Creating an FFTW plan is expensive and, unlike the execution of a plan,
+        /// is not thread-safe. This class keeps all plans created by the FFT wrapper, so
+        /// repeated transforms of the same shape (e.g. grids in every major cycle) reuse
+        /// the plan. Plans are keyed by shape, number of transforms, precision, direction
+        /// and alignment of the data. Only planning (i.e. lookup of the cache) is serialised,
+        /// the transforms themselves run concurrently if called from different threads.
+        ///
+        /// The planner effort, the number of threads used by FFTW for every transform and
+        /// the wisdom file are configured once per process via the configure method. The
+        /// default is FFTW_ESTIMATE without threads or wisdom, i.e. the same plans as created
+        /// by earlier versions of the wrapper. All plans are created in-place, the transform
+        /// of the actual data is done with the new-array execute interface.
+        ///
+        /// Plans never leave this class, they are only used for the duration of execute. The
+        /// number of transforms in progress is counted, and clear or configure wait until all
+        /// of them are finished before any plan is destroyed.
+        /// @ingroup fft
+        class FFTPlanCache {
+        public:
+            /// @brief obtain the process-wide instance
+            /// @return reference to the cache
+            static FFTPlanCache& instance();
+
+            /// @brief destructor, saves wisdom (if configured) and destroys all plans
+            ~FFTPlanCache();
+
+            /// @brief configure the planner
+            /// @details All cached plans are destroyed if the configuration changes (after
+            /// the transforms in progress are finished). If the wisdom file name is not empty,
+            /// wisdom is imported from <name>.single and <name>.double for single and double
+            /// precision, respectively (if these files exist). A file which can't be imported
+            /// is ignored (the return value is false then), the wisdom is accumulated from
+            /// scratch. If requested, the wisdom is exported to the same files when saveWisdom
+            /// is called or the cache is destroyed. Only one process should save the wisdom to
+            /// any given file.
+            /// @param[in] nThreads number of threads FFTW uses for each transform (1 means no threads)
+            /// @param[in] planner planner effort, one of "estimate", "measure", "patient" or "exhaustive"
+            /// @param[in] wisdomFile base name of the wisdom files (empty string disables wisdom)
+            /// @param[in] saveWisdom if true, the wisdom is saved to the files at the end
+            /// @return false if an existing wisdom file couldn't be imported, true otherwise
+            bool configure(const int nThreads, const std::string &planner = "estimate",
+                           const std::string &wisdomFile = "", const bool saveWisdom = true);
+
+            /// @brief export accumulated wisdom to the files given in configure
+            /// @details Does nothing if wisdom is not used or not supposed to be saved by
+            /// this process. Each file is written under a temporary name first and then
+            /// renamed, so other processes never import a partially written file.
+            void saveWisdom() const;
+
+            /// @brief destroy all cached plans
+            /// @details Waits until the transforms in progress are finished.
+            void clear();
+
+            /// @brief number of plans in the cache
+            /// @return total number of single and double precision plans
+            size_t size() const;
+
+            /// @brief number of threads used by FFTW for each transform
+            int nThreads() const { return itsNThreads; }
+
+            /// @brief in-place single precision transform of a number of contiguous planes
+            /// @details No shift of the origin or normalisation is done here, this is the job of the wrapper.
+            /// @param[in] data pointer to the first element of the first plane
+            /// @param[in] nx length of the first (fastest varying) axis
+            /// @param[in] ny length of the second axis (1 for 1-D transforms)
+            /// @param[in] howMany number of planes of nx*ny elements, stored one after another
+            /// @param[in] forward true for the forward transform
+            void execute(casa::Complex *data, const int nx, const int ny, const int howMany,
+                         const bool forward);
+
+            /// @brief in-place double precision transform of a number of contiguous planes
+            /// @details No shift of the origin or normalisation is done here, this is the job of the wrapper.
+            /// @param[in] data pointer to the first element of the first plane
+            /// @param[in] nx length of the first (fastest varying) axis
+            /// @param[in] ny length of the second axis (1 for 1-D transforms)
+            /// @param[in] howMany number of planes of nx*ny elements, stored one after another
+            /// @param[in] forward true for the forward transform
+            void execute(casa::DComplex *data, const int nx, const int ny, const int howMany,
+                         const bool forward);
+
+        private:
+            /// @brief key of the plan cache
+            struct PlanKey {
+                /// @brief construct the key
+                PlanKey(const int nx, const int ny, const int howMany, const bool forward,
+                        const int alignment);
+
+                /// @brief ordering required for std::map
+                bool operator<(const PlanKey &other) const;
+
+                int itsNX;
+                int itsNY;
+                int itsHowMany;
+                bool itsForward;
+                int itsAlignment;
+            };
+
+            /// @brief constructor, initialises threaded FFTW
+            FFTPlanCache();
+
+            // not copyable
+            FFTPlanCache(const FFTPlanCache &);
+            FFTPlanCache& operator=(const FFTPlanCache &);
+
+            /// @brief FFTW planner flags corresponding to the configured effort
+            unsigned plannerFlags() const;
+
+            /// @brief obtain single precision plan, creating it if necessary
+            /// @details The plan is counted as in use until releasePlan is called
+            fftwf_plan getPlan(casa::Complex *data, const int nx, const int ny, const int howMany,
+                               const bool forward);
+
+            /// @brief obtain double precision plan, creating it if necessary
+            /// @details The plan is counted as in use until releasePlan is called
+            fftw_plan getPlan(casa::DComplex *data, const int nx, const int ny, const int howMany,
+                              const bool forward);
+
+            /// @brief notify that the plan obtained via getPlan is no longer used
+            void releasePlan();
+
+            /// @brief wait until no plan is in use and destroy all plans
+            /// @param[in] lock lock of itsMutex held by the caller
+            void destroyPlans(boost::unique_lock<boost::mutex> &lock);
+
+            /// @brief export wisdom to the given file via a temporary file
+            /// @param[in] name file name
+            /// @param[in] exporter FFTW function exporting the wisdom (single or double precision)
+            static void exportWisdom(const std::string &name, void (*exporter)(FILE *));
+
+            /// @brief single precision plans
+            std::map<PlanKey, fftwf_plan> itsSinglePlans;
+
+            /// @brief double precision plans
+            std::map<PlanKey, fftw_plan> itsDoublePlans;
+
+            /// @brief number of threads used by FFTW for each transform
+            int itsNThreads;
+
+            /// @brief planner effort
+            std::string itsPlanner;
+
+            /// @brief base name of the wisdom files (empty if wisdom is not used)
+            std::string itsWisdomFile;
+
+            /// @brief true if this process saves the wisdom
+            bool itsSaveWisdom;
+
+            /// @brief number of plans obtained via getPlan and not released yet
+            size_t itsNPlansInUse;
+
+            /// @brief condition signalled when the last plan in use is released
+            boost::condition_variable itsPlansReleased;
+
+            /// @brief mutex protecting the cache and FFTW planner
+            /// @details FFTW planning is not thread-safe, so the lock is taken whatever the
+            /// threading model of the caller (OpenMP or boost threads)
+            mutable boost::mutex itsMutex;
+        };
+    }
+}
+#endif
@@ -34,262 +34,187 @@
 // ASKAPsoft includes
 #include "askap/AskapError.h"
 #include "profile/AskapProfiler.h"
+#include "fft/FFTPlanCache.h"
 #include "casa/Arrays/Vector.h"
 #include "casa/Arrays/Matrix.h"
 #include "casa/Arrays/ArrayIter.h"
-#include "fftw3.h"
 
-#ifdef _OPENMP
-// boost include
-#include "boost/thread/mutex.hpp"
-#endif
+// std includes
+#include <algorithm>
 
 using namespace casa;
 
 namespace askap {
     namespace scimath {
 
-#ifdef _OPENMP
-        /// @brief mutex to ensure thread safety in the calls to fft
-        static boost::mutex fftWrapperMutex;
-#endif
+        /// @brief move the origin of a plane between the centre and the first element
+        /// @details The origin for FFTW is at 0, not at n/2 as in casa fft. This method
+        /// rotates each axis of the plane in place by n/2 elements. It is its own inverse
+        /// for even lengths and is applied to both input and output of the transform.
+        /// @param[in] data pointer to the first element of the plane
+        /// @param[in] nx length of the first axis
+        /// @param[in] ny length of the second axis
+        template<typename T>
+        static void rotatePlane(T* data, const size_t nx, const size_t ny)
+        {
+            if (nx > 1) {
+                for (size_t col = 0; col < ny; ++col) {
+                     T* colPtr = data + col * nx;
+                     std::rotate(colPtr, colPtr + (nx / 2), colPtr + nx);
+                }
+            }
+            // rotation of the whole plane moves complete columns
+            std::rotate(data, data + (ny / 2) * nx, data + nx * ny);
+        }
 
-        /**
-         * Scale the array by 1/N were N is the total number of elements in
-         * the array
-         */
+        /// @brief multiply the plane by a checkerboard of +/- factor
+        /// @details For even lengths, rotation of an axis by n/2 is equivalent to
+        /// multiplication by (-1)^i in the other domain. Therefore, instead of moving the
+        /// data around, the input can be multiplied by (-1)^(x+y) and the output by
+        /// (-1)^(u+v+nx/2+ny/2). This is done in a single pass together with the normalisation.
+        /// @param[in] data pointer to the first element of the plane
+        /// @param[in] nx length of the first axis (should be even)
+        /// @param[in] ny length of the second axis
+        /// @param[in] factor factor for the first element
         template<typename T>
-        static inline void scaleResult(T* data, const size_t nElements)
+        static void checkerboard(T* data, const size_t nx, const size_t ny,
+                                 const typename T::value_type factor)
+        {
+            ASKAPDEBUGASSERT(nx % 2 == 0);
+            for (size_t col = 0; col < ny; ++col) {
+                 T* colPtr = data + col * nx;
+                 const typename T::value_type colFactor = col % 2 == 0 ? factor : -factor;
+                 for (size_t row = 0; row < nx; row += 2) {
+                      colPtr[row] *= colFactor;
+                      colPtr[row + 1] *= -colFactor;
+                 }
+            }
+        }
+
+        /// @brief scale the array by the given factor
+        template<typename T>
+        static inline void scaleResult(T* data, const size_t nElements,
+                                       const typename T::value_type scale)
         {
-            const T scale = T(1) / T(nElements);
             for (size_t i = 0; i < nElements; i++) {
                 data[i] *= scale;
             }
         }
 
-        /*
-         * Execute a Double-precision FFT plan.
-         */
-        static inline void fftExec(casa::Vector<casa::DComplex>& vec, const bool forward,
-                            fftw_plan& p, fftw_complex* buf, size_t bufsz)
+        /// @brief in-place transform of a number of contiguous planes with the casa origin convention
+        /// @details A 1-D transform is a 2-D transform with ny=1. The plan is taken from the
+        /// process-wide cache. The backward transform is normalised by the number of elements in the plane.
+        /// @param[in] data pointer to the first element of the first plane
+        /// @param[in] nx length of the first axis
+        /// @param[in] ny length of the second axis
+        /// @param[in] howMany number of planes
+        /// @param[in] forward true for the forward transform
+        template<typename T>
+        static void fftPlanes(T* data, const size_t nx, const size_t ny, const size_t howMany,
+                              const bool forward)
         {
-            const size_t nElements = vec.nelements();
-            ASKAPDEBUGASSERT(nElements == bufsz);
+            const size_t planeSize = nx * ny;
+            const typename T::value_type scale = forward ? 1. : 1. / double(planeSize);
+            // checkerboard is only applicable to 2-D transforms with even lengths of both axes
+            const bool useCheckerboard = (nx % 2 == 0) && (ny % 2 == 0) && (ny > 1);
+            for (size_t plane = 0; plane < howMany; ++plane) {
+                 if (useCheckerboard) {
+                     checkerboard(data + plane * planeSize, nx, ny, typename T::value_type(1.));
+                 } else {
+                     rotatePlane(data + plane * planeSize, nx, ny);
+                 }
+            }
+            FFTPlanCache::instance().execute(data, int(nx), int(ny), int(howMany), forward);
+            for (size_t plane = 0; plane < howMany; ++plane) {
+                 if (useCheckerboard) {
+                     const bool negate = ((nx / 2 + ny / 2) % 2) == 1;
+                     checkerboard(data + plane * planeSize, nx, ny, negate ? -scale : scale);
+                 } else {
+                     rotatePlane(data + plane * planeSize, nx, ny);
+                     if (!forward) {
+                         scaleResult(data + plane * planeSize, planeSize, scale);
+                     }
+                 }
+            }
+        }
 
+        /// @brief 1-D transform of a vector
+        /// @details Non-contiguous vectors (e.g. rows of a matrix) are copied by getStorage.
+        template<typename T>
+        static void fftVector(casa::Vector<T>& vec, const bool forward)
+        {
+            if (vec.nelements() == 0) {
+                return;
+            }
             Bool deleteIt;
-            DComplex *dataPtr = vec.getStorage(deleteIt);
-
-            // rotate input because the origin for FFTW is at 0, not n/2 (casa fft).
-            std::rotate_copy(dataPtr, dataPtr + (nElements / 2), dataPtr + nElements,
-                             reinterpret_cast<casa::DComplex*>(buf));
-
-            fftw_execute(p);
-
-            // rotate output and copy back to the vectors storage
-            std::rotate_copy(reinterpret_cast<casa::DComplex*>(buf),
-                             reinterpret_cast<casa::DComplex*>(buf) + (nElements / 2),
-                             reinterpret_cast<casa::DComplex*>(buf) + nElements,
-                             dataPtr);
-
-            if (!forward) {
-                scaleResult(dataPtr, nElements);
+            T *dataPtr = vec.getStorage(deleteIt);
+            try {
+                fftPlanes(dataPtr, vec.nelements(), 1, 1, forward);
+            } catch (...) {
+                vec.putStorage(dataPtr, deleteIt);
+                throw;
             }
-
             vec.putStorage(dataPtr, deleteIt);
         }
 
-        /**
-         * Execute a Single-precision FFT plan.
-         */
-        static inline void fftExec(casa::Vector<casa::Complex>& vec, const bool forward,
-                            fftwf_plan& p, fftwf_complex* buf, size_t bufsz)
+        /// @brief 2-D transform of the first two axes of an array
+        /// @details Contiguous arrays are transformed with a single plan for all planes.
+        /// Otherwise, the array is iterated plane by plane and non-contiguous planes are copied.
+        template<typename T>
+        static void fftArray2D(casa::Array<T>& arr, const bool forward)
         {
-            const size_t nElements = vec.nelements();
-            ASKAPDEBUGASSERT(nElements == bufsz);
-
-            Bool deleteIt;
-            Complex *dataPtr = vec.getStorage(deleteIt);
-
-            // rotate input because the origin for FFTW is at 0, not n/2 (casa fft)
-            std::rotate_copy(dataPtr, dataPtr + (nElements / 2), dataPtr + nElements,
-                    reinterpret_cast<casa::Complex*>(buf));
-
-            fftwf_execute(p);
-
-            // rotate output
-            std::rotate_copy(reinterpret_cast<casa::Complex*>(buf),
-                             reinterpret_cast<casa::Complex*>(buf) + (nElements / 2),
-                             reinterpret_cast<casa::Complex*>(buf) + nElements,
-                             dataPtr);
-
-            if (!forward) {
-                scaleResult(dataPtr, nElements);
+            if (arr.nelements() == 0) {
+                return;
+            }
+            ASKAPCHECK(arr.ndim() >= 2, "fft2d requires at least 2-dimensional array, you have "<<arr.ndim());
+            const size_t nx = arr.shape()(0);
+            const size_t ny = arr.shape()(1);
+            if (arr.contiguousStorage()) {
+                fftPlanes(arr.data(), nx, ny, arr.nelements() / (nx * ny), forward);
+                return;
+            }
+            casa::ArrayIterator<T> it(arr, 2);
+            while (!it.pastEnd()) {
+                casa::Array<T> &plane = it.array();
+                if (plane.contiguousStorage()) {
+                    fftPlanes(plane.data(), nx, ny, 1, forward);
+                } else {
+                    casa::Array<T> buffer = plane.copy();
+                    fftPlanes(buffer.data(), nx, ny, 1, forward);
+                    plane = buffer;
+                }
+                it.next();
             }
-
-            vec.putStorage(dataPtr, deleteIt);
         }
 
         void fft(casa::Vector<casa::DComplex>& vec, const bool forward)
         {
             ASKAPTRACE("fft<casa::DComplex>");
-#ifdef _OPENMP
-            boost::unique_lock<boost::mutex> lock(fftWrapperMutex);
-#endif
-
-            Bool deleteIt;
-            DComplex *dataPtr = vec.getStorage(deleteIt);
-            const size_t nElements = vec.nelements();
-
-            // rotate input because the origin for FFTW is at 0, not n/2 (casa fft)
-            std::rotate(dataPtr, dataPtr + (nElements / 2), dataPtr + nElements);
-
-            fftw_plan p = fftw_plan_dft_1d(nElements, reinterpret_cast<fftw_complex*>(dataPtr),
-                                           reinterpret_cast<fftw_complex*>(dataPtr),
-                                           (forward) ? FFTW_FORWARD : FFTW_BACKWARD, FFTW_ESTIMATE);
-
-            fftw_execute(p);
-
-            if (!forward) {
-                scaleResult(dataPtr, nElements);
-            }
-
-            // rotate output
-            std::rotate(dataPtr, dataPtr + (nElements / 2), dataPtr + nElements);
-
-            vec.putStorage(dataPtr, deleteIt);
-            fftw_destroy_plan(p);
+            fftVector(vec, forward);
         }
 
         void fft(casa::Vector<casa::Complex>& vec, const bool forward)
         {
             ASKAPTRACE("fft<casa::Complex>");
-#ifdef _OPENMP
-            boost::unique_lock<boost::mutex> lock(fftWrapperMutex);
-#endif
-
-            Bool deleteIt;
-            Complex *dataPtr = vec.getStorage(deleteIt);
-            const size_t nElements = vec.nelements();
-
-            // rotate input because the origin for FFTW is at 0, not n/2 (casa fft)
-            std::rotate(dataPtr, dataPtr + (nElements / 2), dataPtr + nElements);
-
-            fftwf_plan p = fftwf_plan_dft_1d(nElements, reinterpret_cast<fftwf_complex*>(dataPtr),
-                                             reinterpret_cast<fftwf_complex*>(dataPtr),
-                                             (forward) ? FFTW_FORWARD : FFTW_BACKWARD, FFTW_ESTIMATE);
-            fftwf_execute(p);
-
-            if (!forward) {
-                scaleResult(dataPtr, nElements);
-            }
-
-            // rotate output
-            std::rotate(dataPtr, dataPtr + (nElements / 2), dataPtr + nElements);
-
-            vec.putStorage(dataPtr, deleteIt);
-            fftwf_destroy_plan(p);
+            fftVector(vec, forward);
         }
 
         void fft2d(casa::Array<casa::Complex>& arr, const bool forward)
         {
             ASKAPTRACE("fft2d<casa::Complex>");
-#ifdef _OPENMP
-            boost::unique_lock<boost::mutex> lock(fftWrapperMutex);
-#endif
-
-            // 1: Make an iterator that returns plane by plane
-            casa::ArrayIterator<casa::Complex> it(arr, 2);
-
-            while (!it.pastEnd()) {
-                casa::Matrix<casa::Complex> mat(it.array());
-                ASKAPDEBUGASSERT(mat.ncolumn() > 0 && mat.nrow() > 0);
-
-                // 2: Setup a buffer and fft plan based on the size of the first column
-                size_t bufsz = mat.nrow();
-                fftwf_complex* buf = (fftwf_complex*) fftw_malloc(sizeof(fftwf_complex) * bufsz);
-                fftwf_plan p = fftwf_plan_dft_1d(bufsz, buf, buf,
-                                                 (forward) ? FFTW_FORWARD : FFTW_BACKWARD, FFTW_ESTIMATE);
-
-                // 3: FFT each column
-                for (uInt col = 0; col < mat.ncolumn(); col++) {
-                    casa::Vector<casa::Complex> vec(mat.column(col));
-                    fftExec(vec, forward, p, buf, bufsz);
-                }
-
-                // 4: If the row are of different length to the rows then
-                // re-allocate buffer and regen the plan
-                if (mat.ncolumn() != mat.nrow()) {
-                    fftwf_destroy_plan(p);
-                    fftwf_free(buf);
-                    bufsz = mat.ncolumn();
-                    fftwf_complex* buf = (fftwf_complex*) fftwf_malloc(sizeof(fftwf_complex) * bufsz);
-                    p = fftwf_plan_dft_1d(bufsz, buf, buf,
-                                          (forward) ? FFTW_FORWARD : FFTW_BACKWARD, FFTW_MEASURE);
-                }
-
-                // 5: FFT each row
-                for (uInt row = 0; row < mat.nrow(); row++) {
-                    casa::Vector<casa::Complex> vec(mat.row(row));
-                    fftExec(vec, forward, p, buf, bufsz);
-                }
-
-                // 6: Delete the plan and temporary buffer
-                fftwf_destroy_plan(p);
-                fftwf_free(buf);
-
-                it.next();
-            }
+            fftArray2D(arr, forward);
         }
 
         void fft2d(casa::Array<casa::DComplex>& arr, const bool forward)
         {
             ASKAPTRACE("fft2d<casa::DComplex>");
-#ifdef _OPENMP
-            boost::unique_lock<boost::mutex> lock(fftWrapperMutex);
-#endif
-
-            /// 1: Make an iterator that returns plane by plane
-            casa::ArrayIterator<casa::DComplex> it(arr, 2);
-
-            while (!it.pastEnd()) {
-                casa::Matrix<casa::DComplex> mat(it.array());
-                ASKAPDEBUGASSERT(mat.ncolumn() > 0 && mat.nrow() > 0);
-
-                // 2: Setup a buffer and fft plan based on the size of the first column
-                size_t bufsz = mat.nrow();
-                fftw_complex* buf = (fftw_complex*) fftw_malloc(sizeof(fftw_complex) * bufsz);
-                fftw_plan p = fftw_plan_dft_1d(bufsz, buf, buf,
-                                               (forward) ? FFTW_FORWARD : FFTW_BACKWARD, FFTW_ESTIMATE);
-
-                // 3: FFT each column
-                for (uInt col = 0; col < mat.ncolumn(); col++) {
-                    casa::Vector<casa::DComplex> vec(mat.column(col));
-                    fftExec(vec, forward, p, buf, bufsz);
-                }
-
-                // 4: If the rows are of different length to the columns then
-                // re-allocate buffer and regen the plan
-                if (mat.ncolumn() != mat.nrow()) {
-                    fftw_destroy_plan(p);
-                    fftw_free(buf);
-                    bufsz = mat.ncolumn();
-                    fftw_complex* buf = (fftw_complex*) fftw_malloc(sizeof(fftw_complex) * bufsz);
-                    p = fftw_plan_dft_1d(bufsz, buf, buf,
-                                         (forward) ? FFTW_FORWARD : FFTW_BACKWARD, FFTW_MEASURE);
-                }
-
-                // 5: FFT each row
-                for (uInt row = 0; row < mat.nrow(); row++) {
-                    casa::Vector<casa::DComplex> vec(mat.row(row));
-                    fftExec(vec, forward, p, buf, bufsz);
-                }
-
-                // 6: Delete the plan and temporary buffer
-                fftw_destroy_plan(p);
-                fftw_free(buf);
+            fftArray2D(arr, forward);
+        }
 
-                it.next();
-            }
+        bool configureFFT(const int nThreads, const std::string &planner,
+                          const std::string &wisdomFile, const bool saveWisdom)
+        {
+            return FFTPlanCache::instance().configure(nThreads, planner, wisdomFile, saveWisdom);
         }
     }
 }
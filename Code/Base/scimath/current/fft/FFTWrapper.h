@@ -35,6 +35,9 @@
 #include <casa/Arrays/Vector.h>
 #include <casa/Arrays/Array.h>
 
+// std includes
+#include <string>
+
 namespace askap
 {
     namespace scimath
@@ -62,6 +65,19 @@ namespace askap
         /// @param forward Forward transform?
         /// @ingroup fft
         void fft2d(casa::Array<casa::DComplex>& arr, const bool forward);
+
+        /// @brief configure the FFTW planner used by all transforms
+        /// @details Plans are cached per process (see FFTPlanCache), this method is
+        /// intended to be called once at the start of the application.
+        /// @param nThreads number of threads used by FFTW for each transform
+        /// @param planner planner effort: estimate (default), measure, patient or exhaustive
+        /// @param wisdomFile base name of the wisdom files (empty string disables wisdom)
+        /// @param saveWisdom if true, the wisdom is saved at the end (only one process should
+        /// save the wisdom to any given file)
+        /// @return false if an existing wisdom file couldn't be imported and has been ignored
+        /// @ingroup fft
+        bool configureFFT(const int nThreads, const std::string &planner = "estimate",
+                          const std::string &wisdomFile = "", const bool saveWisdom = true);
     }
 }
 #endif
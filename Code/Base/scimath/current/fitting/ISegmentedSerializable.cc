@@ -0,0 +1,95 @@
+/// @file
+/// @brief An interface for serialization with large arrays kept out of the blob stream
+/// @details Objects holding large arrays (images, normal equations) are expensive to
+/// serialize into a blob stream, because all data are copied into the stream buffer on
+/// the sending side and out of it on the receiving side. Classes implementing this
+/// interface write only the metadata and small arrays into the blob stream. Large arrays
+/// are described by a list of memory segments (pointer and length) which the transport
+/// layer sends directly from (or receives directly into) the storage of the arrays.
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author agent <agent@local>
+///
+
+// own includes
+#include <fitting/ISegmentedSerializable.h>
+#include <askap/AskapError.h>
+
+#include <Blob/BlobArray.h>
+#include <casa/Arrays/IPosition.h>
+
+namespace askap {
+
+/// @brief an empty virtual destructor to keep the compiler happy
+ISegmentedSerializable::~ISegmentedSerializable() {}
+
+/// @brief minimum size of an array (in bytes) sent as a separate segment
+const size_t ISegmentedSerializable::theMinSegmentSize;
+
+/// @brief write an array to the blob stream or to the segment list
+/// @details The shape is always written to the stream. Arrays smaller than
+/// theMinSegmentSize bytes or arrays without contiguous storage are written into the
+/// stream, other arrays are added to the segment list.
+/// @param[in] os the output stream
+/// @param[in] arr array to write
+/// @param[out] segments list of segments to update
+void ISegmentedSerializable::writeArray(LOFAR::BlobOStream& os, const casa::Array<double> &arr,
+                                        MemorySegments &segments)
+{
+  const size_t nBytes = arr.nelements() * sizeof(double);
+  const bool inStream = (nBytes < theMinSegmentSize) || !arr.contiguousStorage();
+  os << arr.shape() << inStream;
+  if (inStream) {
+      os << arr;
+  } else {
+      // the transport layer doesn't modify the data, although it needs a non-const pointer
+      segments.push_back(std::make_pair(const_cast<void*>(static_cast<const void*>(arr.data())), nBytes));
+  }
+}
+
+/// @brief read an array written by writeArray
+/// @details If the array has been sent as a segment, new storage is allocated and
+/// the segment pointing to it is added to the list.
+/// @param[in] is the input stream
+/// @param[out] segments list of segments to update
+/// @return array (with reference semantics to the storage given in the segment)
+casa::Array<double> ISegmentedSerializable::readArray(LOFAR::BlobIStream& is, MemorySegments &segments)
+{
+  casa::IPosition shape;
+  bool inStream = true;
+  is >> shape >> inStream;
+  casa::Array<double> result;
+  if (inStream) {
+      is >> result;
+      ASKAPCHECK(result.shape() == shape, "Shape of the array read from the blob stream "<<result.shape()<<
+                 " doesn't match the expected shape "<<shape);
+  } else {
+      result.resize(shape);
+      ASKAPDEBUGASSERT(result.contiguousStorage());
+      segments.push_back(std::make_pair(static_cast<void*>(result.data()), result.nelements() * sizeof(double)));
+  }
+  return result;
+}
+
+} // namespace askap
@@ -0,0 +1,103 @@
+/// @file
+/// @brief An interface for serialization with large arrays kept out of the blob stream
+/// @details Objects holding large arrays (images, normal equations) are expensive to
+/// serialize into a blob stream, because all data are copied into the stream buffer on
+/// the sending side and out of it on the receiving side. Classes implementing this
+/// interface write only the metadata and small arrays into the blob stream. Large arrays
+/// are described by a list of memory segments (pointer and length) which the transport
+/// layer sends directly from (or receives directly into) the storage of the arrays.
+/// @note Like ISerializable, this interface is declared outside the scimath namespace.
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author agent <agent@local>
+///
+
+#ifndef I_SEGMENTED_SERIALIZABLE_H
+#define I_SEGMENTED_SERIALIZABLE_H
+
+#include <Blob/BlobOStream.h>
+#include <Blob/BlobIStream.h>
+
+#include <casa/Arrays/Array.h>
+
+#include <vector>
+#include <utility>
+
+namespace askap {
+
+/// @brief list of contiguous memory segments
+/// @details Each element is a pointer to the first byte and the number of bytes.
+/// The same type is used by the transport layer (askapparallel), which doesn't
+/// depend on this package.
+typedef std::vector<std::pair<void*, size_t> > MemorySegments;
+
+/// @brief An interface for serialization with large arrays kept out of the blob stream
+/// @details The writing side calls writeToBlob, sends the blob stream and then the
+/// content of all segments in the order they were added. The reading side receives the
+/// blob stream, calls readFromBlob (which allocates the storage for large arrays and
+/// returns the segments pointing to it) and then receives the content of all segments
+/// in the same order. The segments given by the writing side are only valid while the
+/// object is not modified.
+/// @ingroup fitting
+struct ISegmentedSerializable {
+
+  /// @brief an empty virtual destructor to keep the compiler happy
+  virtual ~ISegmentedSerializable();
+
+  /// @brief write the object to a blob stream except for large arrays
+  /// @param[in] os the output stream
+  /// @param[out] segments memory segments with large arrays are appended to this list
+  virtual void writeToBlob(LOFAR::BlobOStream& os, MemorySegments &segments) const = 0;
+
+  /// @brief read the object from a blob stream and set up storage for large arrays
+  /// @details The content of the segments is undefined until filled by the transport layer.
+  /// @param[in] is the input stream
+  /// @param[out] segments memory segments to receive large arrays are appended to this list
+  virtual void readFromBlob(LOFAR::BlobIStream& is, MemorySegments &segments) = 0;
+
+  /// @brief write an array to the blob stream or to the segment list
+  /// @details The shape is always written to the stream. Arrays smaller than
+  /// theMinSegmentSize bytes or arrays without contiguous storage are written into the
+  /// stream, other arrays are added to the segment list.
+  /// @param[in] os the output stream
+  /// @param[in] arr array to write
+  /// @param[out] segments list of segments to update
+  static void writeArray(LOFAR::BlobOStream& os, const casa::Array<double> &arr, MemorySegments &segments);
+
+  /// @brief read an array written by writeArray
+  /// @details If the array has been sent as a segment, new storage is allocated and
+  /// the segment pointing to it is added to the list.
+  /// @param[in] is the input stream
+  /// @param[out] segments list of segments to update
+  /// @return array (with reference semantics to the storage given in the segment)
+  static casa::Array<double> readArray(LOFAR::BlobIStream& is, MemorySegments &segments);
+
+  /// @brief minimum size of an array (in bytes) sent as a separate segment
+  /// @details Small arrays are not worth a separate message
+  static const size_t theMinSegmentSize = 65536;
+};
+
+} // namespace askap
+
+#endif // #ifndef I_SEGMENTED_SERIALIZABLE_H
@@ -71,9 +71,9 @@ namespace askap
   {
 
 
-    ImagingNormalEquations::ImagingNormalEquations() {};
+    ImagingNormalEquations::ImagingNormalEquations() : itsSinglePrecisionTransport(false) {};
     
-    ImagingNormalEquations::ImagingNormalEquations(const Params& ip)
+    ImagingNormalEquations::ImagingNormalEquations(const Params& ip) : itsSinglePrecisionTransport(false)
     {
       vector<string> names=ip.freeNames();
       vector<string>::iterator iterRow;
@@ -95,7 +95,8 @@ namespace askap
     /// therefore, need this copy constructor to achieve proper copying.
     /// @param[in] src input measurement equations to copy from
     ImagingNormalEquations::ImagingNormalEquations(const ImagingNormalEquations &src) :
-         INormalEquations(src),itsShape(src.itsShape), itsReference(src.itsReference)
+         INormalEquations(src),itsShape(src.itsShape), itsReference(src.itsReference),
+         itsSinglePrecisionTransport(src.itsSinglePrecisionTransport)
     {
       deepCopyOfSTDMap(src.itsNormalMatrixSlice, itsNormalMatrixSlice);
       deepCopyOfSTDMap(src.itsNormalMatrixDiagonal, itsNormalMatrixDiagonal);
@@ -113,6 +114,7 @@ namespace askap
       if (&src != this) {
           itsShape = src.itsShape;
           itsReference = src.itsReference;
+          itsSinglePrecisionTransport = src.itsSinglePrecisionTransport;
           deepCopyOfSTDMap(src.itsNormalMatrixSlice, itsNormalMatrixSlice);
           deepCopyOfSTDMap(src.itsNormalMatrixDiagonal, itsNormalMatrixDiagonal);
           deepCopyOfSTDMap(src.itsDataVector, itsDataVector);      
@@ -397,12 +399,53 @@ const std::map<std::string, casa::Vector<double> >& ImagingNormalEquations::data
       return INormalEquations::ShPtr(new ImagingNormalEquations(*this));
     }
 
+    /// @brief write a map of vectors to a blob stream in single precision
+    /// @param[in] os the output stream
+    /// @param[in] data map to write
+    static void writeSinglePrecision(LOFAR::BlobOStream& os, const std::map<std::string, casa::Vector<double> > &data)
+    {
+      os << static_cast<casa::uInt>(data.size());
+      for (std::map<std::string, casa::Vector<double> >::const_iterator ci = data.begin(); ci != data.end(); ++ci) {
+           casa::Vector<float> buf(ci->second.nelements());
+           casa::convertArray<float, double>(buf, ci->second);
+           os << ci->first << buf;
+      }
+    }
+
+    /// @brief read a map of vectors written by writeSinglePrecision
+    /// @param[in] is the input stream
+    /// @param[out] data map to fill (values are converted back to double)
+    static void readSinglePrecision(LOFAR::BlobIStream& is, std::map<std::string, casa::Vector<double> > &data)
+    {
+      data.clear();
+      casa::uInt size = 0;
+      is >> size;
+      for (casa::uInt item = 0; item < size; ++item) {
+           std::string name;
+           casa::Vector<float> buf;
+           is >> name >> buf;
+           casa::Vector<double> &vec = data[name];
+           vec.resize(buf.nelements());
+           casa::convertArray<double, float>(vec, buf);
+      }
+    }
+
     /// @brief write the object to a blob stream
     /// @param[in] os the output stream
     void ImagingNormalEquations::writeToBlob(LOFAR::BlobOStream& os) const
     {
-      os << itsNormalMatrixSlice 
-        << itsNormalMatrixDiagonal << itsShape << itsReference << itsDataVector; 
+      os.putStart("ImagingNormalEquations",1);
+      os << itsSinglePrecisionTransport;
+      if (itsSinglePrecisionTransport) {
+          writeSinglePrecision(os, itsNormalMatrixSlice);
+          writeSinglePrecision(os, itsNormalMatrixDiagonal);
+          os << itsShape << itsReference;
+          writeSinglePrecision(os, itsDataVector);
+      } else {
+          os << itsNormalMatrixSlice 
+             << itsNormalMatrixDiagonal << itsShape << itsReference << itsDataVector; 
+      }
+      os.putEnd();
     }
     
     /// @brief read the object from a blob stream
@@ -410,9 +453,96 @@ const std::map<std::string, casa::Vector<double> >& ImagingNormalEquations::data
     /// @note Not sure whether the parameter should be made const or not 
     void ImagingNormalEquations::readFromBlob(LOFAR::BlobIStream& is) 
     {
-      is >> itsNormalMatrixSlice 
-         >> itsNormalMatrixDiagonal >> itsShape >> itsReference 
-         >> itsDataVector;
+      const int version = is.getStart("ImagingNormalEquations");
+      ASKAPCHECK(version == 1, "Attempting to read from a blob stream an object of the wrong version: expect version 1, found version "<<version);
+      is >> itsSinglePrecisionTransport;
+      if (itsSinglePrecisionTransport) {
+          readSinglePrecision(is, itsNormalMatrixSlice);
+          readSinglePrecision(is, itsNormalMatrixDiagonal);
+          is >> itsShape >> itsReference;
+          readSinglePrecision(is, itsDataVector);
+      } else {
+          is >> itsNormalMatrixSlice 
+             >> itsNormalMatrixDiagonal >> itsShape >> itsReference 
+             >> itsDataVector;
+      }
+      is.getEnd();
+    }
+    
+    /// @brief write a map of vectors to a blob stream, large vectors are added to the segment list
+    /// @param[in] os the output stream
+    /// @param[in] data map to write
+    /// @param[out] segments list of segments to update
+    static void writeSegmented(LOFAR::BlobOStream& os, const std::map<std::string, casa::Vector<double> > &data,
+                               MemorySegments &segments)
+    {
+      os << static_cast<casa::uInt>(data.size());
+      for (std::map<std::string, casa::Vector<double> >::const_iterator ci = data.begin(); ci != data.end(); ++ci) {
+           os << ci->first;
+           ISegmentedSerializable::writeArray(os, ci->second, segments);
+      }
+    }
+
+    /// @brief read a map of vectors written by writeSegmented
+    /// @param[in] is the input stream
+    /// @param[out] data map to fill
+    /// @param[out] segments list of segments to update
+    static void readSegmented(LOFAR::BlobIStream& is, std::map<std::string, casa::Vector<double> > &data,
+                              MemorySegments &segments)
+    {
+      data.clear();
+      casa::uInt size = 0;
+      is >> size;
+      for (casa::uInt item = 0; item < size; ++item) {
+           std::string name;
+           is >> name;
+           const casa::Array<double> buf = ISegmentedSerializable::readArray(is, segments);
+           ASKAPCHECK(buf.ndim() == 1, "Expected a vector for "<<name<<", received an array of shape "<<buf.shape());
+           data[name].reference(buf);
+      }
+    }
+
+    /// @brief write the object to a blob stream except for large buffers
+    /// @details Large slices, diagonals and data vectors are added to the segment list
+    /// instead of being copied into the stream (see ISegmentedSerializable). If single
+    /// precision transport is selected, everything is written into the stream as the
+    /// buffers have to be converted anyway.
+    /// @param[in] os the output stream
+    /// @param[out] segments memory segments with large buffers are appended to this list
+    void ImagingNormalEquations::writeToBlob(LOFAR::BlobOStream& os, MemorySegments &segments) const
+    {
+      os.putStart("SegmentedImagingNormalEquations",1);
+      os << itsSinglePrecisionTransport;
+      if (itsSinglePrecisionTransport) {
+          writeToBlob(os);
+      } else {
+          os << itsShape << itsReference;
+          writeSegmented(os, itsNormalMatrixSlice, segments);
+          writeSegmented(os, itsNormalMatrixDiagonal, segments);
+          writeSegmented(os, itsDataVector, segments);
+      }
+      os.putEnd();
+    }
+
+    /// @brief read the object from a blob stream and set up storage for large buffers
+    /// @param[in] is the input stream
+    /// @param[out] segments memory segments to receive large buffers are appended to this list
+    void ImagingNormalEquations::readFromBlob(LOFAR::BlobIStream& is, MemorySegments &segments)
+    {
+      const int version = is.getStart("SegmentedImagingNormalEquations");
+      ASKAPCHECK(version == 1, "Attempting to read from a blob stream an object of the wrong version: expect version 1, found version "<<version);
+      bool singlePrecision = false;
+      is >> singlePrecision;
+      if (singlePrecision) {
+          readFromBlob(is);
+      } else {
+          itsSinglePrecisionTransport = false;
+          is >> itsShape >> itsReference;
+          readSegmented(is, itsNormalMatrixSlice, segments);
+          readSegmented(is, itsNormalMatrixDiagonal, segments);
+          readSegmented(is, itsDataVector, segments);
+      }
+      is.getEnd();
     }
     
     /// @brief obtain all parameters dealt with by these normal equations
@@ -37,6 +37,7 @@
 
 #include <fitting/Params.h>
 #include <fitting/INormalEquations.h>
+#include <fitting/ISegmentedSerializable.h>
 
 #include <casa/aips.h>
 #include <casa/Arrays/Vector.h>
@@ -66,7 +67,8 @@ namespace askap
 /// This class represents the approximated case, and is used with imaging 
 /// algorithms.
 /// @ingroup fitting
-    class ImagingNormalEquations : public INormalEquations
+    class ImagingNormalEquations : public INormalEquations,
+                                   public ISegmentedSerializable
     {
     public:
       
@@ -221,6 +223,19 @@ namespace askap
       /// Clone this into a shared pointer
       virtual INormalEquations::ShPtr clone() const;
       
+      /// @brief set precision used to transfer the normal equations
+      /// @details Normal equations are always accumulated in double precision. If single precision
+      /// transport is selected, slices, diagonals and data vectors are converted to float when the
+      /// object is written to a blob stream (i.e. sent to another rank), which halves the amount of
+      /// data to be transferred and reduced. The precision is stored in the stream, so the receiving
+      /// side doesn't need to be configured and will forward the equations with the same precision.
+      /// @param[in] single true to transfer the normal equations in single precision
+      void setSinglePrecisionTransport(const bool single) { itsSinglePrecisionTransport = single; }
+
+      /// @brief check whether the normal equations are transferred in single precision
+      /// @return true, if single precision is used in writeToBlob
+      bool singlePrecisionTransport() const { return itsSinglePrecisionTransport; }
+
       /// @brief write the object to a blob stream
       /// @param[in] os the output stream
       virtual void writeToBlob(LOFAR::BlobOStream& os) const;
@@ -229,6 +244,20 @@ namespace askap
       /// @param[in] is the input stream
       /// @note Not sure whether the parameter should be made const or not 
       virtual void readFromBlob(LOFAR::BlobIStream& is); 
+
+      /// @brief write the object to a blob stream except for large buffers
+      /// @details Large slices, diagonals and data vectors are added to the segment list
+      /// instead of being copied into the stream (see ISegmentedSerializable). If single
+      /// precision transport is selected, everything is written into the stream as the
+      /// buffers have to be converted anyway.
+      /// @param[in] os the output stream
+      /// @param[out] segments memory segments with large buffers are appended to this list
+      virtual void writeToBlob(LOFAR::BlobOStream& os, MemorySegments &segments) const;
+
+      /// @brief read the object from a blob stream and set up storage for large buffers
+      /// @param[in] is the input stream
+      /// @param[out] segments memory segments to receive large buffers are appended to this list
+      virtual void readFromBlob(LOFAR::BlobIStream& is, MemorySegments &segments);
               
     private:
       /// A slice through a specified plane
@@ -241,6 +270,8 @@ namespace askap
       std::map<std::string, casa::IPosition> itsReference;
       /// The data vectors
       std::map<std::string, casa::Vector<double> > itsDataVector;
+      /// @brief true if the normal equations are written to blob streams in single precision
+      bool itsSinglePrecisionTransport;
     };
     
   }  // namespace scimath
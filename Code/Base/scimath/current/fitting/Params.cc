@@ -638,6 +638,45 @@ bool Params::isChanged(const std::string &name, const ChangeMonitor &cm) const
             return is;
 		}
 
+/// @brief write the object to a blob stream except for large arrays
+/// @details Large parameter values are added to the segment list instead of
+/// being copied into the stream (see ISegmentedSerializable).
+/// @param[in] os the output stream
+/// @param[out] segments memory segments with large arrays are appended to this list
+void Params::writeToBlob(LOFAR::BlobOStream& os, MemorySegments &segments) const
+{
+  os.putStart("SegmentedParams", 1);
+  os << itsAxes << itsFree << static_cast<casa::uInt>(itsArrays.size());
+  for (std::map<std::string, casa::Array<double> >::const_iterator ci = itsArrays.begin();
+       ci != itsArrays.end(); ++ci) {
+       os << ci->first;
+       writeArray(os, ci->second, segments);
+  }
+  os.putEnd();
+}
+
+/// @brief read the object from a blob stream and set up storage for large arrays
+/// @param[in] is the input stream
+/// @param[out] segments memory segments to receive large arrays are appended to this list
+void Params::readFromBlob(LOFAR::BlobIStream& is, MemorySegments &segments)
+{
+  const int version = is.getStart("SegmentedParams");
+  ASKAPCHECK(version == 1, "Attempting to read from a blob stream a segmented Params object of the wrong version, expect 1 got "<<
+             version);
+  casa::uInt nArrays = 0;
+  is >> itsAxes >> itsFree >> nArrays;
+  itsArrays.clear();
+  for (casa::uInt item = 0; item < nArrays; ++item) {
+       std::string name;
+       is >> name;
+       // reference semantics, the storage is filled later via the segment
+       itsArrays[name].reference(readArray(is, segments));
+  }
+  is.getEnd();
+  // as the object has been updated one needs to obtain new change monitor
+  itsChangeMonitors.clear();
+}
+
 	} // namespace scimath
 	
     /// @brief populate scimath parameters from a LOFAR Parset object
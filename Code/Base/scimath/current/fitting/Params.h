@@ -36,6 +36,7 @@
 #define SCIMATHPARAMS_H_
 
 #include <fitting/Axes.h>
+#include <fitting/ISegmentedSerializable.h>
 
 #include <casa/aips.h>
 #include <casa/Arrays/Array.h>
@@ -61,7 +62,7 @@ namespace askap
   {
     /// @brief Represent parameters for an Equation
     /// @ingroup fitting
-    class Params
+    class Params : public ISegmentedSerializable
     {
       public:
 
@@ -296,6 +297,18 @@ casa::Vector<casa::Complex> complexVectorValue(const std::string &name) const;
         /// @param[in] par Parameters to be processed
         friend LOFAR::BlobIStream& operator>>(LOFAR::BlobIStream& is, 
                                               Params& par); 
+
+        /// @brief write the object to a blob stream except for large arrays
+        /// @details Large parameter values are added to the segment list instead of
+        /// being copied into the stream (see ISegmentedSerializable).
+        /// @param[in] os the output stream
+        /// @param[out] segments memory segments with large arrays are appended to this list
+        virtual void writeToBlob(LOFAR::BlobOStream& os, MemorySegments &segments) const;
+
+        /// @brief read the object from a blob stream and set up storage for large arrays
+        /// @param[in] is the input stream
+        /// @param[out] segments memory segments to receive large arrays are appended to this list
+        virtual void readFromBlob(LOFAR::BlobIStream& is, MemorySegments &segments);
          
         /// @brief make a slice of another params class
         /// @details This method extracts one or more parameters 
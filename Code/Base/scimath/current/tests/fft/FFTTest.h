@@ -25,12 +25,19 @@
 #include <fftw3.h>
 #include <casa/Arrays/Vector.h>
 #include <casa/Arrays/Matrix.h>
+#include <casa/Arrays/Cube.h>
 #include <fft/FFTWrapper.h>
+#include <fft/FFTPlanCache.h>
 
 #include <askap/AskapError.h>
 #include <cppunit/extensions/HelperMacros.h>
 
 #include <stdexcept>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <unistd.h>
 
 #define FFT true
 #define IFFT false
@@ -150,6 +157,10 @@ namespace askap
       CPPUNIT_TEST_SUITE(FFTTest);
       CPPUNIT_TEST(testForwardBackwardSinglePrecision);
       CPPUNIT_TEST(testForwardBackwardDoublePrecision);      
+      CPPUNIT_TEST(test2DTransformSinglePrecision);
+      CPPUNIT_TEST(test2DTransformDoublePrecision);
+      CPPUNIT_TEST(testPlanCache);
+      CPPUNIT_TEST(testWisdom);
       CPPUNIT_TEST_SUITE_END();
 
       private:
@@ -194,6 +205,112 @@ namespace askap
                 CPPUNIT_ASSERT(forward_backward_test(N, dp_mat, NRMSE, dp_precision) == true);
             }
         }
+
+        void test2DTransformSinglePrecision()
+        {
+            // even and odd sizes take different code paths, the tolerance allows for
+            // a different order of operations (the error is normalised per element)
+            const int sizes[][2] = {{64, 64}, {32, 16}, {15, 15}, {12, 9}};
+            for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); ++i) {
+                 casa::Cube<casa::Complex> cube(sizes[i][0], sizes[i][1], 2);
+                 CPPUNIT_ASSERT(compare_with_1d_transforms(cube, 1e-4));
+            }
+        }
+
+        void test2DTransformDoublePrecision()
+        {
+            const int sizes[][2] = {{64, 64}, {32, 16}, {15, 15}, {12, 9}};
+            for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); ++i) {
+                 casa::Cube<casa::DComplex> cube(sizes[i][0], sizes[i][1], 2);
+                 CPPUNIT_ASSERT(compare_with_1d_transforms(cube, 1e-10));
+            }
+        }
+
+        void testPlanCache()
+        {
+            FFTPlanCache &cache = FFTPlanCache::instance();
+            cache.clear();
+            CPPUNIT_ASSERT_EQUAL(size_t(0), cache.size());
+            casa::Matrix<casa::Complex> mat(128, 128, casa::Complex(1., 0.));
+            fft2d(mat, FFT);
+            const size_t nPlans = cache.size();
+            CPPUNIT_ASSERT(nPlans > 0);
+            // the same transform reuses the plan
+            fft2d(mat, FFT);
+            CPPUNIT_ASSERT_EQUAL(nPlans, cache.size());
+            fft2d(mat, IFFT);
+            CPPUNIT_ASSERT(cache.size() > nPlans);
+            cache.clear();
+            CPPUNIT_ASSERT_EQUAL(size_t(0), cache.size());
+        }
+
+        void testWisdom()
+        {
+            const std::string name = "tFFTWisdom";
+            // a broken wisdom file is ignored rather than being fatal
+            {
+                std::ofstream os((name + ".single").c_str());
+                os << "not a wisdom file" << std::endl;
+            }
+            std::remove((name + ".double").c_str());
+            FFTPlanCache &cache = FFTPlanCache::instance();
+            CPPUNIT_ASSERT(!cache.configure(1, "estimate", name));
+            casa::Matrix<casa::Complex> mat(64, 64, casa::Complex(1., 0.));
+            fft2d(mat, FFT);
+            // the wisdom is saved via a temporary file, which doesn't stay behind
+            cache.saveWisdom();
+            std::ostringstream tmpName;
+            tmpName << name << ".single.tmp" << getpid();
+            std::ifstream tmpFile(tmpName.str().c_str());
+            CPPUNIT_ASSERT(!tmpFile);
+            CPPUNIT_ASSERT(cache.configure(1, "estimate", name));
+            // a process which doesn't save the wisdom leaves the files intact
+            CPPUNIT_ASSERT_EQUAL(0, std::remove((name + ".double").c_str()));
+            CPPUNIT_ASSERT(cache.configure(1, "estimate", name, false));
+            cache.saveWisdom();
+            std::ifstream doubleFile((name + ".double").c_str());
+            CPPUNIT_ASSERT(!doubleFile);
+            // restore the default configuration
+            CPPUNIT_ASSERT(cache.configure(1));
+            CPPUNIT_ASSERT_EQUAL(0, std::remove((name + ".single").c_str()));
+        }
+
+      protected:
+        /// @brief compare fft2d with 1-D transforms of all columns and rows
+        /// @param[in] cube cube to use, the first two axes are transformed
+        /// @param[in] precision tolerance for the normalised rms error
+        /// @return true, if both forward and backward transforms match
+        template<typename T>
+        static bool compare_with_1d_transforms(casa::Cube<T> &cube, const double precision)
+        {
+            for (casa::uInt z = 0; z < cube.nplane(); ++z) {
+                 for (casa::uInt y = 0; y < cube.ncolumn(); ++y) {
+                      for (casa::uInt x = 0; x < cube.nrow(); ++x) {
+                           cube(x, y, z) = T(myRand(-0.5,0.5), myRand(-0.5,0.5));
+                      }
+                 }
+            }
+            bool result = true;
+            for (int pass = 0; pass < 2; ++pass) {
+                 const bool forward = (pass == 0);
+                 casa::Cube<T> expected = cube.copy();
+                 for (casa::uInt z = 0; z < expected.nplane(); ++z) {
+                      casa::Matrix<T> mat = expected.xyPlane(z);
+                      for (casa::uInt c = 0; c < mat.ncolumn(); ++c) {
+                           casa::Vector<T> y = mat.column(c);
+                           askap::scimath::fft(y, forward);
+                      }
+                      for (casa::uInt r = 0; r < mat.nrow(); ++r) {
+                           casa::Vector<T> y = mat.row(r);
+                           askap::scimath::fft(y, forward);
+                      }
+                 }
+                 askap::scimath::fft2d(cube, forward);
+                 double diff = 0.;
+                 result = result && test_for_equality(cube, expected, NRMSE, precision, diff);
+            }
+            return result;
+        }
         
     };
     
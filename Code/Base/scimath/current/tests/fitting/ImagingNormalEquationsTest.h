@@ -30,12 +30,14 @@
 #include <Blob/BlobIBufString.h>
 #include <Blob/BlobOStream.h>
 #include <Blob/BlobIStream.h>
+#include <fitting/ISegmentedSerializable.h>
 
 
 #include <askap/AskapError.h>
 #include <boost/shared_ptr.hpp>
 
 #include <algorithm>
+#include <cstring>
 
 namespace askap
 {
@@ -58,6 +60,8 @@ namespace askap
       CPPUNIT_TEST_EXCEPTION(testAddWrongDimension, askap::AskapError);
 #endif // #ifdef ASKAP_DEBUG
       CPPUNIT_TEST(testBlobStream);
+      CPPUNIT_TEST(testBlobStreamSinglePrecision);
+      CPPUNIT_TEST(testSegmentedBlobStream);
       CPPUNIT_TEST_SUITE_END();
 
       private:
@@ -383,6 +387,97 @@ namespace askap
           CPPUNIT_ASSERT(std::find(params.begin(),params.end(),"Value1") != params.end());
           CPPUNIT_ASSERT(std::find(params.begin(),params.end(),"Image2") != params.end());                                                            
         }
+
+        void testBlobStreamSinglePrecision() {
+          p1.reset(new ImagingNormalEquations());
+          CPPUNIT_ASSERT(!p1->singlePrecisionTransport());
+          // values which can't be represented exactly in single precision
+          casa::Vector<double> slice(100), diagonal(100), data(100);
+          for (casa::uInt i=0; i<slice.nelements(); ++i) {
+               slice[i] = 1./double(i+3);
+               diagonal[i] = 1e6/3. + double(i);
+               data[i] = -2./7. * double(i+1);
+          }
+          p1->addSlice("Image", slice, diagonal, data, casa::IPosition(2,10,10), casa::IPosition(2,5,5));
+          p1->setSinglePrecisionTransport(true);
+          LOFAR::BlobString b1(false);
+          LOFAR::BlobOBufString bob(b1);
+          LOFAR::BlobOStream bos(bob);
+          bos << *p1;
+          LOFAR::BlobIBufString bib(b1);
+          LOFAR::BlobIStream bis(bib);
+          p2.reset(new ImagingNormalEquations());
+          bis >> *p2;
+          // precision is passed with the data
+          CPPUNIT_ASSERT(p2->singlePrecisionTransport());
+          CPPUNIT_ASSERT(p2->shape().find("Image")->second == casa::IPosition(2,10,10));
+          CPPUNIT_ASSERT(p2->reference().find("Image")->second == casa::IPosition(2,5,5));
+          // the relative error is determined by the float mantissa
+          const casa::Vector<double> newSlice = extractVector(p2->normalMatrixSlice(), "Image");
+          const casa::Vector<double> newDiagonal = extractVector(p2->normalMatrixDiagonal(), "Image");
+          const casa::Vector<double> newData = p2->dataVector("Image");
+          CPPUNIT_ASSERT(newSlice.nelements() == slice.nelements());
+          CPPUNIT_ASSERT(newDiagonal.nelements() == diagonal.nelements());
+          CPPUNIT_ASSERT(newData.nelements() == data.nelements());
+          for (casa::uInt i=0; i<slice.nelements(); ++i) {
+               CPPUNIT_ASSERT_DOUBLES_EQUAL(slice[i], newSlice[i], 1e-7 * fabs(slice[i]));
+               CPPUNIT_ASSERT_DOUBLES_EQUAL(diagonal[i], newDiagonal[i], 1e-7 * fabs(diagonal[i]));
+               CPPUNIT_ASSERT_DOUBLES_EQUAL(data[i], newData[i], 1e-7 * fabs(data[i]));
+          }
+          // but the values are not the same as the originals
+          CPPUNIT_ASSERT(newSlice[0] != slice[0]);
+        }
+
+        void testSegmentedBlobStream() {
+          p1.reset(new ImagingNormalEquations());
+          // 100x100 image is large enough to be sent as a separate segment
+          const casa::uInt bigSize = 10000;
+          casa::Vector<double> slice(bigSize), diagonal(bigSize), data(bigSize);
+          for (casa::uInt i=0; i<bigSize; ++i) {
+               slice[i] = 1./double(i+3);
+               diagonal[i] = 1e6/3. + double(i);
+               data[i] = -2./7. * double(i+1);
+          }
+          p1->addSlice("Image", slice, diagonal, data, casa::IPosition(2,100,100), casa::IPosition(2,50,50));
+          p1->addSlice("Small", casa::Vector<double>(10,1.), casa::Vector<double>(10,2.),
+                       casa::Vector<double>(10,3.), casa::IPosition(1,10), casa::IPosition(1,5));
+          LOFAR::BlobString b1(false);
+          LOFAR::BlobOBufString bob(b1);
+          LOFAR::BlobOStream bos(bob);
+          MemorySegments outSegments;
+          p1->writeToBlob(bos, outSegments);
+          // slice, diagonal and data vector of the large image
+          CPPUNIT_ASSERT_EQUAL(size_t(3), outSegments.size());
+          // the blob stream shouldn't contain the large buffers
+          CPPUNIT_ASSERT(b1.size() < bigSize * sizeof(double));
+          LOFAR::BlobIBufString bib(b1);
+          LOFAR::BlobIStream bis(bib);
+          p2.reset(new ImagingNormalEquations());
+          MemorySegments inSegments;
+          p2->readFromBlob(bis, inSegments);
+          CPPUNIT_ASSERT_EQUAL(outSegments.size(), inSegments.size());
+          // simulate the transport layer
+          for (size_t seg = 0; seg < inSegments.size(); ++seg) {
+               CPPUNIT_ASSERT_EQUAL(outSegments[seg].second, inSegments[seg].second);
+               memcpy(inSegments[seg].first, outSegments[seg].first, inSegments[seg].second);
+          }
+          CPPUNIT_ASSERT(p2->shape().find("Image")->second == casa::IPosition(2,100,100));
+          CPPUNIT_ASSERT(p2->reference().find("Image")->second == casa::IPosition(2,50,50));
+          const casa::Vector<double> newSlice = extractVector(p2->normalMatrixSlice(), "Image");
+          const casa::Vector<double> newDiagonal = extractVector(p2->normalMatrixDiagonal(), "Image");
+          const casa::Vector<double> newData = p2->dataVector("Image");
+          CPPUNIT_ASSERT(newSlice.nelements() == bigSize);
+          CPPUNIT_ASSERT(newDiagonal.nelements() == bigSize);
+          CPPUNIT_ASSERT(newData.nelements() == bigSize);
+          for (casa::uInt i=0; i<bigSize; ++i) {
+               CPPUNIT_ASSERT_EQUAL(slice[i], newSlice[i]);
+               CPPUNIT_ASSERT_EQUAL(diagonal[i], newDiagonal[i]);
+               CPPUNIT_ASSERT_EQUAL(data[i], newData[i]);
+          }
+          testAllElements(extractVector(p2->normalMatrixSlice(), "Small"), 10, 1.);
+          testAllElements(extractVector(p2->normalMatrixDiagonal(), "Small"), 10, 2.);
+          testAllElements(p2->dataVector("Small"), 10, 3.);
+        }
     protected:
         /// @brief a helper method to access map elements
         /// @details This method extracts a casa::Vector out of the map
@@ -31,9 +31,12 @@
 #include <Blob/BlobIStream.h>
 
 #include <casa/Arrays/Matrix.h>
+#include <casa/Arrays/ArrayLogical.h>
 
 #include <askap/AskapError.h>
 
+#include <cstring>
+
 #include <cppunit/extensions/HelperMacros.h>
 
 namespace askap
@@ -55,6 +58,7 @@ namespace askap
       CPPUNIT_TEST(testArraySlice);
       CPPUNIT_TEST(testComplexVector);
       CPPUNIT_TEST(testBlobStream);
+      CPPUNIT_TEST(testSegmentedBlobStream);
       CPPUNIT_TEST_EXCEPTION(testDuplicate, askap::CheckError);
       CPPUNIT_TEST_EXCEPTION(testNotScalar, askap::CheckError);
       CPPUNIT_TEST(testChangeMonitor);
@@ -255,6 +259,42 @@ namespace askap
           
         }
         
+        void testSegmentedBlobStream() {
+          p1->add("Scalar", 1.5);
+          casa::Matrix<double> image(128,128);
+          for (casa::uInt x=0; x<image.nrow(); ++x) {
+               for (casa::uInt y=0; y<image.ncolumn(); ++y) {
+                    image(x,y) = double(x) - 0.5 * double(y);
+               }
+          }
+          p1->add("Image", image);
+          p1->fix("Scalar");
+          LOFAR::BlobString b1(false);
+          LOFAR::BlobOBufString bob(b1);
+          LOFAR::BlobOStream bos(bob);
+          MemorySegments outSegments;
+          p1->writeToBlob(bos, outSegments);
+          // only the image is large enough to be sent separately
+          CPPUNIT_ASSERT_EQUAL(size_t(1), outSegments.size());
+          CPPUNIT_ASSERT_EQUAL(image.nelements() * sizeof(double), outSegments[0].second);
+          Params pnew;
+          LOFAR::BlobIBufString bib(b1);
+          LOFAR::BlobIStream bis(bib);
+          MemorySegments inSegments;
+          pnew.readFromBlob(bis, inSegments);
+          CPPUNIT_ASSERT_EQUAL(size_t(1), inSegments.size());
+          CPPUNIT_ASSERT_EQUAL(outSegments[0].second, inSegments[0].second);
+          // simulate the transport layer
+          memcpy(inSegments[0].first, outSegments[0].first, inSegments[0].second);
+          CPPUNIT_ASSERT(pnew.has("Scalar"));
+          CPPUNIT_ASSERT(!pnew.isFree("Scalar"));
+          CPPUNIT_ASSERT(pnew.scalarValue("Scalar")==1.5);
+          CPPUNIT_ASSERT(pnew.isFree("Image"));
+          const casa::Array<double> newImage = pnew.value("Image");
+          CPPUNIT_ASSERT(newImage.shape() == image.shape());
+          CPPUNIT_ASSERT(casa::allEQ(newImage, image));
+        }
+
         void testChangeMonitor() {
           p1->add("Par1", 0.1);
           p1->add("Par2", casa::Vector<double>(5,1.));
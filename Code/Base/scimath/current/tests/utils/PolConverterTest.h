@@ -53,6 +53,7 @@ class PolConverterTest : public CppUnit::TestFixture {
   CPPUNIT_TEST(circular2stokesTest);
   CPPUNIT_TEST(sparseTransformTest);
   CPPUNIT_TEST(canonicOrderTest);
+  CPPUNIT_TEST(stridedConversionTest);
   CPPUNIT_TEST_SUITE_END();
 public:
   void dimensionTest() {
@@ -393,6 +394,36 @@ public:
   
   
   
+  void stridedConversionTest() {
+     // input products are interleaved with junk to check that the stride is respected
+     const casa::uInt stride = 3;
+     casa::Vector<casa::Complex> inBuf(4 * stride, casa::Complex(-100.,-100.));
+     casa::Vector<casa::Complex> inVec(4);
+     for (casa::uInt pol = 0; pol < inVec.nelements(); ++pol) {
+          inVec[pol] = casa::Complex(0.1 * (2 * pol + 1), 0.1 * (2 * pol + 2));
+          inBuf[pol * stride] = inVec[pol];
+     }
+     casa::Vector<casa::Complex> outBuf(4);
+     // linear to stokes and the void conversion
+     const PolConverter converters[2] = {PolConverter(PolConverter::canonicLinear(), PolConverter::canonicStokes()),
+                                         PolConverter(PolConverter::canonicStokes(), PolConverter::canonicStokes())};
+     for (int test = 0; test < 2; ++test) {
+          const PolConverter &pc = converters[test];
+          CPPUNIT_ASSERT_EQUAL(test == 1, pc.isVoid());
+          pc.convert(outBuf.data(), inBuf.data(), stride);
+          const casa::Vector<casa::Complex> outVec = pc(inVec);
+          CPPUNIT_ASSERT_EQUAL(outVec.nelements(), outBuf.nelements());
+          for (casa::uInt pol = 0; pol < outVec.nelements(); ++pol) {
+               CPPUNIT_ASSERT(abs(outVec[pol] - outBuf[pol]) < 1e-6);
+          }
+          pc.noise(outBuf.data(), inBuf.data(), stride);
+          const casa::Vector<casa::Complex> noiseVec = pc.noise(inVec);
+          CPPUNIT_ASSERT_EQUAL(noiseVec.nelements(), outBuf.nelements());
+          for (casa::uInt pol = 0; pol < noiseVec.nelements(); ++pol) {
+               CPPUNIT_ASSERT(abs(noiseVec[pol] - outBuf[pol]) < 1e-6);
+          }
+     }
+  }
 };
 
 } // namespace scimath
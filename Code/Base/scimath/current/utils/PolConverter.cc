@@ -148,6 +148,67 @@ casa::Vector<casa::Complex> PolConverter::noise(casa::Vector<casa::Complex> visN
   return res;
 }
 
+/// @brief conversion into a preallocated buffer
+/// @details This version of the conversion method doesn't create temporary vectors and
+/// is intended to be used in tight loops (e.g. in gridders) directly with the data of a
+/// visibility cube, where polarisation products are not adjacent in memory.
+/// @param[out] out pointer to the output buffer (nOutputDim() elements are written)
+/// @param[in] vis pointer to the first polarisation product of the input visibility vector
+/// @param[in] stride distance (in elements) between adjacent polarisation products in the input
+/// @note The conversion must be set up with explicit frames (for a void conversion
+/// nInputDim() elements are copied).
+void PolConverter::convert(casa::Complex *out, const casa::Complex *vis, const casa::uInt stride) const
+{
+  ASKAPDEBUGASSERT(out != 0);
+  ASKAPDEBUGASSERT(vis != 0);
+  if (itsVoid) {
+      for (casa::uInt pol = 0; pol<nInputDim(); ++pol) {
+           out[pol] = vis[pol * stride];
+      }
+      return;
+  }
+  for (casa::uInt row = 0; row<itsTransform.nrow(); ++row) {
+       casa::Complex res(0.,0.);
+       for (casa::uInt col = 0; col<itsTransform.ncolumn(); ++col) {
+            res += itsTransform(row,col)*vis[col * stride];
+       }
+       out[row] = res;
+  }
+}
+
+/// @brief propagate noise into a preallocated buffer
+/// @details This is the version of noise method without temporary vectors. See convert
+/// for the meaning of parameters.
+/// @param[out] out pointer to the output buffer (nOutputDim() elements are written)
+/// @param[in] visNoise pointer to the noise of the first polarisation product
+/// @param[in] stride distance (in elements) between adjacent polarisation products in the input
+void PolConverter::noise(casa::Complex *out, const casa::Complex *visNoise, const casa::uInt stride) const
+{
+  ASKAPDEBUGASSERT(out != 0);
+  ASKAPDEBUGASSERT(visNoise != 0);
+  if (itsVoid) {
+      for (casa::uInt pol = 0; pol<nInputDim(); ++pol) {
+           out[pol] = visNoise[pol * stride];
+      }
+      return;
+  }
+  for (casa::uInt row = 0; row<itsTransform.nrow(); ++row) {
+       float reNoise = 0.;
+       float imNoise = 0.;
+       for (casa::uInt col = 0; col<itsTransform.ncolumn(); ++col) {
+            const casa::Complex coeff = itsTransform(row,col);
+            const casa::Complex val = visNoise[col * stride];
+            reNoise += casa::square(casa::real(coeff)*casa::real(val)) +
+                       casa::square(casa::imag(coeff)*casa::imag(val));
+            imNoise += casa::square(casa::imag(coeff)*casa::real(val)) +
+                       casa::square(casa::real(coeff)*casa::imag(val));
+       }
+       ASKAPDEBUGASSERT(reNoise >= 0.);
+       ASKAPDEBUGASSERT(imNoise >= 0.);
+       out[row] = casa::Complex(sqrt(reNoise),sqrt(imNoise));
+  }
+}
+
 /// @brief build transformation matrix
 /// @details This is the core of the algorithm, this method builds the transformation matrix
 /// given the two frames .
@@ -91,6 +91,25 @@ struct PolConverter {
   /// levels of real and imaginary parts of the visibility.
   casa::Vector<casa::Complex> noise(casa::Vector<casa::Complex> visNoise) const;
 
+  /// @brief conversion into a preallocated buffer
+  /// @details This version of the conversion method doesn't create temporary vectors and
+  /// is intended to be used in tight loops (e.g. in gridders) directly with the data of a
+  /// visibility cube, where polarisation products are not adjacent in memory.
+  /// @param[out] out pointer to the output buffer (nOutputDim() elements are written)
+  /// @param[in] vis pointer to the first polarisation product of the input visibility vector
+  /// @param[in] stride distance (in elements) between adjacent polarisation products in the input
+  /// @note The conversion must be set up with explicit frames (for a void conversion
+  /// nInputDim() elements are copied).
+  void convert(casa::Complex *out, const casa::Complex *vis, const casa::uInt stride = 1) const;
+
+  /// @brief propagate noise into a preallocated buffer
+  /// @details This is the version of noise method without temporary vectors. See convert
+  /// for the meaning of parameters.
+  /// @param[out] out pointer to the output buffer (nOutputDim() elements are written)
+  /// @param[in] visNoise pointer to the noise of the first polarisation product
+  /// @param[in] stride distance (in elements) between adjacent polarisation products in the input
+  void noise(casa::Complex *out, const casa::Complex *visNoise, const casa::uInt stride = 1) const;
+
   /// @brief check whether this conversion is void
   /// @return true if conversion is void, false otherwise
   inline bool isVoid() const throw() {return itsVoid;}
@@ -37,6 +37,9 @@
 #include "CommandLineParser.h"
 #include "Common/ParameterSet.h"
 #include "casa/OS/Timer.h"
+#include "dataaccess/TableConstDataSource.h"
+#include "dataaccess/IConstDataSource.h"
+#include "dataaccess/SharedIter.h"
 
 // Local includes
 #include "writers/DataSet.h"
@@ -63,6 +66,51 @@ static ParameterSet getParameterSet(int argc, char *argv[])
     return parset;
 }
 
+/// Read the dataset back through the table-based accessor and return the
+/// number of bytes delivered to the caller (visibilities, flags, noise, uvw)
+static double readBack(const std::string& filename, const bool blockRead)
+{
+    askap::accessors::TableConstDataSource tds(filename);
+    tds.configureBlockRead(blockRead);
+    const askap::accessors::IConstDataSource& ds = tds;
+    double bytes = 0.;
+    for (askap::accessors::IConstDataSharedIter it = ds.createConstIterator();
+            it != it.end(); ++it) {
+        const double nElements = static_cast<double>(it->visibility().nelements());
+        // flags, noise and uvw are read on demand, so request them explicitly
+        it->flag();
+        it->noise();
+        it->uvw();
+        bytes += nElements * (2 * sizeof(casa::Complex) + sizeof(casa::Bool)) +
+            3. * sizeof(casa::Double) * it->nRow();
+    }
+    return bytes;
+}
+
+/// Time the read of the dataset in either mode and report the aggregate
+/// throughput over all ranks
+static double timeReadBack(const std::string& filename, const bool blockRead, const int rank)
+{
+    casa::Timer timer;
+    MPI_Barrier(MPI_COMM_WORLD);
+    timer.mark();
+    double bytes = readBack(filename, blockRead);
+    double realtime = timer.real();
+
+    double totalBytes = 0.;
+    double maxTime = 0.;
+    MPI_Reduce(&bytes, &totalBytes, 1, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+    MPI_Reduce(&realtime, &maxTime, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+
+    const double rate = maxTime > 0. ? totalBytes / maxTime / 1048576. : 0.;
+    if (rank == 0) {
+        std::cout << "Read back " << totalBytes / 1048576. << " MB "
+            << (blockRead ? "(block reads)" : "(row by row reads)")
+            << " in " << maxTime << " seconds (" << rate << " MB/s)" << std::endl;
+    }
+    return rate;
+}
+
 static std::string itostr(const int i)
 {
     std::stringstream ss;
@@ -91,33 +139,45 @@ int main(int argc, char *argv[])
     int intTime = subset.getInt32("integrationTime");
     int integrations = subset.getInt32("nIntegrations");
 
-    DataSet data(filename, subset);
+    {
+        DataSet data(filename, subset);
+
+        casa::Timer timer;
+        casa::Timer total;
+        total.mark();
+        for (int i = 0; i < integrations; ++i) {
+            timer.mark();
+            data.add();
+            MPI_Barrier(MPI_COMM_WORLD);
+
+            // Report progress
+            if (rank == 0) {
+                const float realtime = timer.real();
+                const float perf = static_cast<float>(intTime) / realtime;
+                std::cout << "Wrote integration " << i <<
+                " in " << realtime << " seconds"
+                << " (" << perf << "x requirement)" << std::endl;
+            }
+        }
 
-    casa::Timer timer;
-    casa::Timer total;
-    total.mark();
-    for (int i = 0; i < integrations; ++i) {
-        timer.mark();
-        data.add();
-        MPI_Barrier(MPI_COMM_WORLD);
-
-        // Report progress
+        // Report totals
         if (rank == 0) {
-            const float realtime = timer.real();
-            const float perf = static_cast<float>(intTime) / realtime;
-            std::cout << "Wrote integration " << i <<
-            " in " << realtime << " seconds"
-            << " (" << perf << "x requirement)" << std::endl;
+            const float realtime = total.real();
+            const float perf = static_cast<float>(intTime * integrations) / realtime;
+            std::cout << "Wrote " << integrations << " integrations "
+                " in " << realtime << " seconds"
+                << " (" << perf << "x requirement)" << std::endl;
+        }
+    } // the dataset is flushed and closed here
+
+    // Optionally read the dataset back and compare block and row-wise reads
+    if (subset.getBool("readback", false)) {
+        const double rowRate = timeReadBack(filename, false, rank);
+        const double blockRate = timeReadBack(filename, true, rank);
+        if (rank == 0 && rowRate > 0.) {
+            std::cout << "Block reads are " << blockRate / rowRate
+                << " times faster than row by row reads" << std::endl;
         }
-    }
-
-    // Report totals
-    if (rank == 0) {
-        const float realtime = total.real();
-        const float perf = static_cast<float>(intTime * integrations) / realtime;
-        std::cout << "Wrote " << integrations << " integrations "
-            " in " << realtime << " seconds"
-            << " (" << perf << "x requirement)" << std::endl;
     }
 
     MPI_Finalize();
@@ -31,7 +31,7 @@
 #include "askap_cpingest.h"
 
 // CASA includes
-#include "casa/Arrays/MatrixMath.h"
+#include "casa/Arrays/Cube.h"
 #include "casa/Arrays/Vector.h"
 
 // ASKAPsoft includes
@@ -119,40 +119,19 @@ void CalTask::process(VisChunk::ShPtr chunk)
         ASKAPDEBUGASSERT(polIndices[pol] >= 0);
     }
 
-    //
-
-    casa::Matrix<casa::Complex> matr(4, 4);
-    casa::Matrix<casa::Complex> reciprocal;
-    casa::Vector<casa::Complex> calibratedVector(polIndices.nelements());
+    casa::Vector<casa::Complex> factors(4);
+    casa::Cube<casa::Complex> &vis = chunk->visibility();
 
     for (casa::uInt row = 0; row < chunk->nRow(); ++row) {
-        fillMuellerMatrix(matr, chunk->antenna1()[row], chunk->antenna2()[row],
-                          chunk->beam1()[row], chunk->beam2()[row]);
-        casa::Complex det = 0.;
-        casa::invertSymPosDef(reciprocal, det, matr);
-        const float tolerance = 1e-5;
-
-        if (casa::abs(det) < tolerance)  {
-            // throw an exception for now, but will probably do an intelligent flagging in the future
-            ASKAPTHROW(AskapError, "Unable to apply gains, determinate too close to 0. D=" << casa::abs(det));
-        }
-
-        casa::Matrix<casa::Complex> thisRow = chunk->visibility().yzPlane(row);
-
-        // current gains are not frequency-dependent. Same matrix can be applied to all channels
-        for (casa::uInt chan = 0; chan < chunk->nChannel(); ++chan) {
-            ASKAPDEBUGASSERT(chan < thisRow.nrow());
-            casa::Vector<casa::Complex> polVector = thisRow.row(chan);
-            ASKAPDEBUGASSERT(polVector.nelements() == polIndices.nelements());
-            calibratedVector.set(0.);
-
-            for (casa::uInt pol1 = 0; pol1 < polIndices.nelements(); ++pol1) {
-                for (casa::uInt pol2 = 0; pol2 < polIndices.nelements(); ++pol2) {
-                    calibratedVector[pol1] += reciprocal(polIndices[pol1], polIndices[pol2]) * polVector[pol2];
-                }
+        fillCorrectionFactors(factors, chunk->antenna1()[row], chunk->antenna2()[row],
+                              chunk->beam1()[row], chunk->beam2()[row]);
+
+        // current gains are not frequency-dependent. Same factor can be applied to all channels
+        for (casa::uInt pol = 0; pol < polIndices.nelements(); ++pol) {
+            const casa::Complex factor = factors[polIndices[pol]];
+            for (casa::uInt chan = 0; chan < chunk->nChannel(); ++chan) {
+                vis(row, chan, pol) *= factor;
             }
-
-            polVector = calibratedVector;
         }
     }
 }
@@ -183,29 +162,42 @@ casa::Complex CalTask::getGain(casa::uInt ant, casa::uInt beam, casa::uInt pol)
     return value;
 }
 
-/// @brief fill Mueller matrix
-/// @details This method forms the measurement equation
-/// defined by Mueller matrix for a given baseline and beams.
-/// The method is implemented in a general way, so it supports
+/// @brief fill correction factors
+/// @details The gains are diagonal, so the Mueller matrix of the measurement
+/// equation is diagonal too and its inverse is just the reciprocal of each diagonal
+/// element. The method is implemented in a general way, so it supports
 /// correlations corresponding to a different beam. However, in
 /// practice beam1 and beam2 are likely to be the same most of
 /// the time.
-/// @param[in] matr Mueler matrix to fill (must already be resized to 4x4)
+/// @param[in] factors vector of correction factors to fill (must already be resized to 4),
+/// indexed by the polarisation product index (see PolConverter::getIndex)
 /// @param[in] ant1 first antenna id (0-based)
 /// @param[in] ant2 second antenna id (0-based)
 /// @param[in] beam1 beam id at the first antenna (0-based)
 /// @param[in] beam2 beam id at the second antenna (0-based)
-void CalTask::fillMuellerMatrix(casa::Matrix<casa::Complex> &matr, casa::uInt ant1,
-                                casa::uInt ant2, casa::uInt beam1, casa::uInt beam2) const
+void CalTask::fillCorrectionFactors(casa::Vector<casa::Complex> &factors, casa::uInt ant1,
+                                    casa::uInt ant2, casa::uInt beam1, casa::uInt beam2) const
 {
-    ASKAPDEBUGASSERT((matr.nrow() == 4) && (matr.ncolumn() == 4));
-    matr.set(0.);
+    ASKAPDEBUGASSERT(factors.nelements() == 4);
+    const casa::Complex gains1[2] = {getGain(ant1, beam1, 0), getGain(ant1, beam1, 1)};
+    const casa::Complex gains2[2] = {getGain(ant2, beam2, 0), getGain(ant2, beam2, 1)};
 
-    // without cross-pols Mueller matrix is just diagonal
+    // determinant of the diagonal Mueller matrix
+    casa::Complex det = 1.;
     for (casa::uInt pol1 = 0, cnt = 0; pol1 < 2; ++pol1) {
         for (casa::uInt pol2 = 0; pol2 < 2; ++pol2, ++cnt) {
             ASKAPDEBUGASSERT(cnt < 4);
-            matr(cnt, cnt) = getGain(ant1, beam1, pol1) * conj(getGain(ant2, beam2, pol2));
+            factors[cnt] = gains1[pol1] * conj(gains2[pol2]);
+            det *= factors[cnt];
         }
     }
+    const float tolerance = 1e-5;
+
+    if (casa::abs(det) < tolerance)  {
+        // throw an exception for now, but will probably do an intelligent flagging in the future
+        ASKAPTHROW(AskapError, "Unable to apply gains, determinate too close to 0. D=" << casa::abs(det));
+    }
+    for (casa::uInt cnt = 0; cnt < 4; ++cnt) {
+        factors[cnt] = casa::Complex(1., 0.) / factors[cnt];
+    }
 }
@@ -33,7 +33,7 @@
 
 // CASA includes
 #include "casa/complex.h"
-#include "casa/Arrays/Matrix.h"
+#include "casa/Arrays/Vector.h"
 
 // Local package includes
 #include "ingestpipeline/ITask.h"
@@ -75,20 +75,21 @@ class CalTask : public askap::cp::ingest::ITask {
         /// @param[in] pol Either 0 for XX or 1 for YY
         casa::Complex getGain(casa::uInt ant, casa::uInt beam, casa::uInt pol) const;
 
-        /// @brief fill Mueller matrix
-        /// @details This method forms the measurement equation
-        /// defined by Mueller matrix for a given baseline and beams.
-        /// The method is implemented in a general way, so it supports
+        /// @brief fill correction factors
+        /// @details The gains are diagonal, so the Mueller matrix of the measurement
+        /// equation is diagonal too and its inverse is just the reciprocal of each diagonal
+        /// element. The method is implemented in a general way, so it supports
         /// correlations corresponding to a different beam. However, in
         /// practice beam1 and beam2 are likely to be the same most of
         /// the time.
-        /// @param[in] matr Mueler matrix to fill (must already be resized to 4x4)
+        /// @param[in] factors vector of correction factors to fill (must already be resized to 4),
+        /// indexed by the polarisation product index (see PolConverter::getIndex)
         /// @param[in] ant1 first antenna id (0-based)
         /// @param[in] ant2 second antenna id (0-based)
         /// @param[in] beam1 beam id at the first antenna (0-based)
         /// @param[in] beam2 beam id at the second antenna (0-based)
-        void fillMuellerMatrix(casa::Matrix<casa::Complex> &matr, casa::uInt ant1,
-                               casa::uInt ant2, casa::uInt beam1, casa::uInt beam2) const;
+        void fillCorrectionFactors(casa::Vector<casa::Complex> &factors, casa::uInt ant1,
+                                   casa::uInt ant2, casa::uInt beam1, casa::uInt beam2) const;
 
     private:
         /// @brief parset file with configuration parameters
@@ -142,13 +142,19 @@ class CimagerApp : public askap::Application
                         SignalCounter sigcount;
                         SignalManagerSingleton::instance()->registerHandler(SIGUSR1, &sigcount);
 
-                        /// Perform multiple major cycles
-                        for (int cycle = 0; cycle < nCycles; ++cycle) {
+                        /// Perform multiple major cycles (possibly resuming an interrupted run)
+                        const int firstCycle = imager.resumeFromCheckpoint();
+                        if (firstCycle >= nCycles) {
+                            ASKAPLOG_INFO_STR(logger, "All " << nCycles <<
+                                " major cycle(s) have been done before the checkpoint, only the final step is left");
+                        }
+                        for (int cycle = firstCycle; cycle < nCycles; ++cycle) {
                             imager.broadcastModel();
                             imager.receiveModel();
                             ASKAPLOG_INFO_STR(logger, "*** Starting major cycle " << cycle << " ***");
                             imager.calcNE();
                             imager.solveNE();
+                            imager.checkpoint(cycle);
 
                             stats.logSummary();
 
@@ -187,6 +193,9 @@ class CimagerApp : public askap::Application
                             }
                         }
 
+                        // report the failure of the last checkpoint (if any)
+                        imager.waitForCheckpoint();
+
                         imager.broadcastModel();
                         imager.receiveModel();
                         ASKAPLOG_INFO_STR(logger, "*** Finished major cycles ***");
@@ -42,6 +42,9 @@
 #include <complex>
 #include <vector>
 #include <algorithm>
+#include <string>
+
+#include <gridding/GridKernel.h>
 
 #ifdef USEBLAS
 
@@ -169,6 +172,86 @@ void degridKernel(const std::vector<Value>& grid, const int gSize, const int sup
 }
 /////////////////////////////////////////////////////////////////////////////////
 
+// Run all gridding kernels of the synthesis library on the same data
+// and compare them against the generic kernel (which is numerically
+// equivalent to the reference element loop) in speed and accuracy.
+// Note, library kernels grid 2*support x 2*support pixels.
+void benchmarkGridKernels(const std::vector<Value>& data, const int support,
+    const std::vector<Value>& C, const std::vector<int>& cOffset,
+    const std::vector<int>& iu, const std::vector<int>& iv, const int gSize)
+{
+  using askap::synthesis::GridKernel;
+
+  const int sSize=2*support+1;
+  const std::vector<std::string> kernels = GridKernel::availableKernels();
+  std::vector<Value> refGrid;
+  std::vector<Value> refData;
+  double refGridTime=0.0;
+  double refDegridTime=0.0;
+
+  for (size_t k=0; k<kernels.size(); ++k)
+  {
+    if (kernels[k] == "reference")
+    {
+      // not optimised at all, speed ups are given w.r.t. the generic kernel
+      continue;
+    }
+    const GridKernel kernel(kernels[k]);
+    cout << "+++++ " << kernel.info() << " +++++" << endl;
+
+    std::vector<Value> grid(gSize*gSize, Value(0.0));
+    clock_t start = clock();
+    for (int dind=0; dind<int(data.size()); ++dind)
+    {
+      kernel.grid(&grid[iu[dind]+gSize*iv[dind]-support], gSize,
+          &C[cOffset[dind]], sSize, data[dind], support);
+    }
+    const double gridTime = (double(clock())-double(start))/CLOCKS_PER_SEC;
+
+    std::vector<Value> outdata(data.size());
+    start = clock();
+    for (int dind=0; dind<int(data.size()); ++dind)
+    {
+      outdata[dind]=kernel.degrid(&grid[iu[dind]+gSize*iv[dind]-support], gSize,
+          &C[cOffset[dind]], sSize, support);
+    }
+    const double degridTime = (double(clock())-double(start))/CLOCKS_PER_SEC;
+
+    const double nPoints = double(data.size())*double(4*support*support);
+    cout << "    Time per gridding   " << 1e9*gridTime/nPoints << " (ns)" << endl;
+    cout << "    Time per degridding " << 1e9*degridTime/nPoints << " (ns)" << endl;
+
+    if (refGrid.size() == 0)
+    {
+      refGrid = grid;
+      refData = outdata;
+      refGridTime = gridTime;
+      refDegridTime = degridTime;
+      continue;
+    }
+    // maximum deviations normalised by the peak of the reference result
+    Real gridPeak=0.0, gridDiff=0.0, dataPeak=0.0, dataDiff=0.0;
+    for (size_t i=0; i<grid.size(); ++i)
+    {
+      gridPeak=std::max(gridPeak, abs(refGrid[i]));
+      gridDiff=std::max(gridDiff, abs(grid[i]-refGrid[i]));
+    }
+    for (size_t i=0; i<outdata.size(); ++i)
+    {
+      dataPeak=std::max(dataPeak, abs(refData[i]));
+      dataDiff=std::max(dataDiff, abs(outdata[i]-refData[i]));
+    }
+    cout << "    Speed up w.r.t. generic: gridding " << refGridTime/gridTime
+        << ", degridding " << refDegridTime/degridTime << endl;
+    cout << "    Max relative difference: grid " << gridDiff/gridPeak
+        << ", degridded data " << dataDiff/dataPeak << endl;
+    if ((gridDiff > 1e-5*gridPeak) || (dataDiff > 1e-5*dataPeak))
+    {
+      cout << "    ERROR: " << kernels[k] << " kernel does not agree with the reference" << endl;
+    }
+  }
+}
+
 // Initialize W project convolution function 
 // - This is application specific and should not need any changes.
 //
@@ -397,6 +480,8 @@ int main()
   cout << "    Time per visibility spectral sample " << 1e6*time/double(data.size()) << " (us) " << endl;
   cout << "    Time per degridding " << 1e9*time/(double(data.size())* double((sSize)*(sSize))) << " (ns) " << endl;
 
+  benchmarkGridKernels(data, support, C, cOffset, iu, iv, gSize);
+
   cout << "Done" << endl;
 
   return 0;
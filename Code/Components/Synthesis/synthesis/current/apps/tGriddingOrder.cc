@@ -0,0 +1,214 @@
+/// @file
+///
+/// @brief benchmark of the sample ordering in gridders
+///
+/// Grids the same dataset with a number of copies of the gridder which differ only in the
+/// ordering of samples (see gridder.sorttile). The first tile size in the list is treated as
+/// the reference, time spent in gridding and the difference of the resulting images with
+/// respect to the reference are reported for every tile size. Zero tile size corresponds to the
+/// accessor order. A dataset with realistic uv-coverage (e.g. simulated with csimulator for the
+/// full ASKAP array) should be used to get meaningful numbers.
+///
+/// Control parameters are passed in from a LOFAR ParameterSet file (the same as for tGridding
+/// with an additional sorttiles parameter).
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author agent <agent@local>
+
+// Package level header file
+#include "askap_synthesis.h"
+
+// ASKAPsoft includes
+#include "askap/AskapLogging.h"
+#include "askap/AskapError.h"
+#include <fitting/Params.h>
+#include "askap/StatReporter.h"
+#include <casa/Logging/LogIO.h>
+#include <casa/OS/Timer.h>
+#include <casa/Arrays/ArrayMath.h>
+#include <askap/Log4cxxLogSink.h>
+#include <CommandLineParser.h>
+#include <askapparallel/AskapParallel.h>
+#include <Common/ParameterSet.h>
+#include <gridding/VisGridderFactory.h>
+#include <gridding/TableVisGridder.h>
+#include <measurementequation/SynthesisParamsHelper.h>
+#include <askap/AskapUtil.h>
+#include <dataaccess/TableDataSource.h>
+#include <dataaccess/ParsetInterface.h>
+#include <dataaccess/MemBufferDataAccessor.h>
+
+// std includes
+#include <vector>
+
+ASKAP_LOGGER(logger, ".tGriddingOrder");
+
+using namespace askap;
+using namespace askap::synthesis;
+using namespace askap::scimath;
+using namespace askap::accessors;
+
+// Main function
+int main(int argc, const char** argv)
+{
+    // This class must have scope outside the main try/catch block
+    askap::askapparallel::AskapParallel comms(argc, argv);
+
+    try {
+        // Ensure that CASA log messages are captured
+        casa::LogSinkInterface* globalSink = new Log4cxxLogSink();
+        casa::LogSink::globalSink(globalSink);
+
+        StatReporter stats;
+
+        // Put everything in scope to ensure that all destructors are called
+        // before the final message
+        {
+            cmdlineparser::Parser parser; // a command line parser
+            // command line parameter
+            cmdlineparser::FlaggedParameter<std::string> inputsPar("-inputs",
+                    "tgridding.in");
+            // this parameter is optional
+            parser.add(inputsPar, cmdlineparser::Parser::return_default);
+
+            parser.process(argc, argv);
+
+            const std::string parsetFile = inputsPar;
+
+            LOFAR::ParameterSet parset(parsetFile);
+            LOFAR::ParameterSet subset(parset.isDefined("Cimager.gridder") ? parset.makeSubset("Cimager.") : parset);
+
+            ASKAPLOG_INFO_STR(logger, "Setting up the gridder to test and the model");
+            IVisGridder::ShPtr gridder = VisGridderFactory::make(subset);
+            ASKAPCHECK(gridder, "Gridder is not defined");
+            ASKAPCHECK(boost::dynamic_pointer_cast<TableVisGridder>(gridder),
+                       "Sample ordering is only supported by gridders derived from TableVisGridder");
+            scimath::Params model;
+            boost::shared_ptr<scimath::Params> modelPtr(&model, utility::NullDeleter());
+            SynthesisParamsHelper::setUpImages(modelPtr,subset.makeSubset("Images."));
+            ASKAPLOG_INFO_STR(logger, "Model contains the following elements: "<<model);
+
+            const int nCycles = subset.getInt32("ncycles", 1);
+            ASKAPCHECK(nCycles > 0, "Number of iterations over the dataset is supposed to be positive, you have "<<nCycles);
+            const std::string dataset = subset.getString("dataset");
+            ASKAPLOG_INFO_STR(logger, "Dataset "<<dataset<<" will be used");
+            const int cacheSize = subset.getInt32("nUVWMachines",1);
+            ASKAPCHECK(cacheSize > 0, "uvw-machine cache size should be positive");
+            const double cacheTolerance = SynthesisParamsHelper::convertQuantity(subset.getString("uvwMachineDirTolerance",
+                                                   "1e-6rad"),"rad");
+            const std::vector<int> tileSizes = subset.getInt32Vector("sorttiles", std::vector<int>(1,0));
+            ASKAPCHECK(tileSizes.size() > 0, "At least one tile size is expected in sorttiles");
+            ASKAPLOG_INFO_STR(logger, "Will compare gridding with the following tile sizes: "<<tileSizes<<
+                              " (0 means the accessor order)");
+
+            accessors::TableDataSource ds(dataset, accessors::TableDataSource::MEMORY_BUFFERS, "DATA");
+            ds.configureUVWMachineCache(size_t(cacheSize),cacheTolerance);
+            accessors::IDataSelectorPtr sel=ds.createSelector();
+            sel << subset;
+            accessors::IDataConverterPtr conv=ds.createConverter();
+            conv->setFrequencyFrame(casa::MFrequency::Ref(casa::MFrequency::TOPO), "Hz");
+            conv->setDirectionFrame(casa::MDirection::Ref(casa::MDirection::J2000));
+            // ensure that time is counted in seconds since 0 MJD
+            conv->setEpochFrame();
+
+            ASKAPLOG_INFO_STR(logger, "Instantiating and initialising gridders");
+            const size_t nImages = model.names().size();
+            // gridders for the same tile size are adjacent
+            std::vector<IVisGridder::ShPtr> gridderList(nImages * tileSizes.size());
+            for (size_t i=0; i<gridderList.size(); ++i) {
+                 gridderList[i] = gridder->clone();
+                 boost::shared_ptr<TableVisGridder> tvg = boost::dynamic_pointer_cast<TableVisGridder>(gridderList[i]);
+                 ASKAPDEBUGASSERT(tvg);
+                 tvg->setSampleSortingTileSize(tileSizes[i / nImages]);
+                 const size_t modelIndex = i % nImages;
+                 const std::string imageName = model.names()[modelIndex];
+                 const Axes axes(model.axes(imageName));
+                 gridderList[i]->initialiseGrid(axes,model.value(imageName).shape(), false);
+                 gridderList[i]->customiseForContext(imageName);
+            }
+
+            // time spent in gridding for each tile size
+            std::vector<double> gridTime(tileSizes.size(), 0.);
+            casa::Timer timer;
+            for (int cycle = 0; cycle < nCycles; ++cycle) {
+                 ASKAPLOG_INFO_STR(logger, "-------------- 'Major cycle' number "<<(cycle + 1)<< " -----------------");
+                 accessors::IDataSharedIter it=ds.createIterator(sel, conv);
+                 size_t counterGrid = 0;
+                 for (it.init();it.hasMore();it.next()) {
+                      accessors::MemBufferDataAccessor accBuffer(*it);
+                      accBuffer.rwVisibility() = it->visibility();
+                      // gridders with different tile sizes process the same chunk one after another,
+                      // so they see the same state of the data cache
+                      for (size_t i = 0; i<gridderList.size(); ++i) {
+                           timer.mark();
+                           gridderList[i]->grid(accBuffer);
+                           gridTime[i / nImages] += timer.real();
+                      }
+                      counterGrid += accBuffer.nRow();
+                 }
+                 ASKAPLOG_INFO_STR(logger, "Finished gridding pass, number of rows gridded is "<<counterGrid);
+            }
+
+            ASKAPLOG_INFO_STR(logger, "Comparing images obtained with different tile sizes");
+            std::vector<casa::Array<double> > reference(nImages);
+            for (size_t i=0; i<gridderList.size(); ++i) {
+                 const size_t modelIndex = i % nImages;
+                 const std::string imageName = model.names()[modelIndex];
+                 casa::Array<double> result(model.value(imageName).shape());
+                 gridderList[i]->finaliseGrid(result);
+                 if (i < nImages) {
+                     reference[modelIndex] = result;
+                 } else {
+                     const double peak = casa::max(casa::abs(reference[modelIndex]));
+                     const double diff = casa::max(casa::abs(result - reference[modelIndex]));
+                     ASKAPLOG_INFO_STR(logger, "Image "<<imageName<<", tile size "<<tileSizes[i / nImages]<<
+                                       ": max difference "<<diff<<" (reference peak "<<peak<<")");
+                 }
+            }
+            for (size_t tile = 0; tile < tileSizes.size(); ++tile) {
+                 ASKAPLOG_INFO_STR(logger, "Tile size "<<tileSizes[tile]<<": gridding time "<<gridTime[tile]<<
+                                   " s, speed up w.r.t. tile size "<<tileSizes[0]<<" is "<<
+                                   (gridTime[tile] > 0. ? gridTime[0] / gridTime[tile] : 0.));
+            }
+        }
+        stats.logSummary();
+        ///==============================================================================
+    } catch (const cmdlineparser::XParser &ex) {
+        ASKAPLOG_FATAL_STR(logger, "Command line parser error, wrong arguments " << argv[0]);
+        std::cerr << "Usage: " << argv[0] << " [-inputs parsetFile]"
+                      << std::endl;
+    } catch (const askap::AskapError& x) {
+        ASKAPLOG_FATAL_STR(logger, "Askap error in " << argv[0] << ": " << x.what());
+        std::cerr << "Askap error in " << argv[0] << ": " << x.what()
+                      << std::endl;
+        exit(1);
+    } catch (const std::exception& x) {
+        ASKAPLOG_FATAL_STR(logger, "Unexpected exception in " << argv[0] << ": " << x.what());
+        std::cerr << "Unexpected exception in " << argv[0] << ": " << x.what()
+                      << std::endl;
+        exit(1);
+    }
+
+    return 0;
+}
@@ -34,6 +34,8 @@
 #define ASKAP_SYNTHESIS_DECONVOLVERHOGBOM_H
 
 #include <string>
+#include <vector>
+#include <utility>
 
 #include <boost/shared_ptr.hpp>
 #include <casa/aips.h>
@@ -42,6 +44,7 @@
 #include <deconvolution/DeconvolverState.h>
 #include <deconvolution/DeconvolverControl.h>
 #include <deconvolution/DeconvolverMonitor.h>
+#include <deconvolution/IPatchComms.h>
 
 namespace askap {
 
@@ -93,11 +96,202 @@ namespace askap {
                 /// @param[in] parset parset
                 virtual void configure(const LOFAR::ParameterSet &parset);
 
+                /// @brief set up the decomposition into patches
+                /// @details With more than one patch, minor cycles are done in parallel
+                /// for spatial patches of the residual image (see deconvolvePatches). This
+                /// setting is normally given by the patches and patches.fraction parameters.
+                /// @param[in] nx number of patches along the first axis
+                /// @param[in] ny number of patches along the second axis
+                /// @param[in] fraction fraction of the current peak residual down to which
+                /// each patch is cleaned before the patches are synchronised
+                void setPatches(casa::uInt nx, casa::uInt ny, casa::Float fraction = 0.8);
+
+                /// @brief share the patches with other ranks
+                /// @details If set, the patches are distributed between the ranks given by
+                /// the communicator in a round-robin fashion. This deconvolver should run on the
+                /// master (rank 0), while all other ranks call servePatches until it returns false.
+                /// The result is the same as for the deconvolution without a communicator.
+                /// An empty shared pointer switches the distribution off.
+                /// @param[in] comms communicator to use
+                void setPatchComms(const boost::shared_ptr<IPatchComms> &comms);
+
+                /// @brief serve patches on behalf of the master
+                /// @details This method is intended for ranks other than the master, which run
+                /// the deconvolver with the communicator set by setPatchComms. It receives the
+                /// residual image and the PSF, cleans the patches assigned to this rank and exchanges
+                /// components with the master until the master finishes the plane.
+                /// @param[in] comms communicator to use
+                /// @return true if a plane has been processed, false if the master has called
+                /// stopPatchServers and no more planes will follow
+                static bool servePatches(IPatchComms &comms);
+
+                /// @brief release ranks serving patches
+                /// @details This method should be called on the master after all planes are
+                /// deconvolved to terminate the servePatches loops on other ranks.
+                /// @param[in] comms communicator to use
+                static void stopPatchServers(IPatchComms &comms);
+
             private:
 
+                /// @brief components found in a patch (position in the full image and flux)
+                typedef std::vector<std::pair<casa::IPosition, T> > ComponentList;
+
+                /// @brief size of the header sent to other ranks for every plane
+                enum { PATCH_HEADER_SIZE = 13 };
+
+                /// @brief decomposition of the image into patches
+                /// @details Every patch is extended by a guard zone of half the (sub-)PSF size
+                /// which covers the part of the PSF used to clean the patch locally.
+                struct PatchLayout {
+                    /// @brief set up the patches
+                    /// @param[in] shape shape of the image
+                    /// @param[in] nx number of patches along the first axis
+                    /// @param[in] ny number of patches along the second axis
+                    /// @param[in] subPsfShape shape of the part of the PSF used in minor cycles
+                    PatchLayout(const casa::IPosition &shape, casa::uInt nx, casa::uInt ny,
+                                const casa::IPosition &subPsfShape);
+
+                    /// @brief shape of the part of the PSF used in minor cycles
+                    casa::IPosition itsSubPsfShape;
+
+                    /// @brief bottom left corners of the patches
+                    std::vector<casa::IPosition> itsPatchBlc;
+
+                    /// @brief top right corners of the patches
+                    std::vector<casa::IPosition> itsPatchTrc;
+
+                    /// @brief bottom left corners of the patches extended by the guard zone
+                    std::vector<casa::IPosition> itsGuardBlc;
+
+                    /// @brief top right corners of the patches extended by the guard zone
+                    std::vector<casa::IPosition> itsGuardTrc;
+                };
+
                 /// @brief Perform the deconvolution
                 /// @detail This is the main deconvolution method.
                 bool oneIteration();
+
+                /// @brief deconvolve with minor cycles done in parallel for patches
+                /// @details The residual image is split into rectangular patches.
+                /// Each round, every patch is cleaned independently (in a separate
+                /// thread if OpenMP is available and on a separate rank if the communicator
+                /// is set) down to a fraction of the current global peak. A patch works with
+                /// a local copy of the residual extended by a guard zone of half the (sub-)PSF
+                /// size, so the sidelobes of components found near the patch boundary are
+                /// accounted for locally. The components found are then merged, the model is
+                /// updated and the full PSF is subtracted from the global residual, exactly
+                /// as the serial algorithm would do it. The result matches the serial Hogbom
+                /// clean within the tolerance given by the clean threshold.
+                void deconvolvePatches();
+
+                /// @brief clean the patches assigned to the given rank
+                /// @details Patch p is assigned to rank p % nProcs. Components found for
+                /// other patches are left intact.
+                /// @param[in] residual pointer to the residual buffer (full image)
+                /// @param[in] mask pointer to the mask buffer of the same shape (or 0)
+                /// @param[in] shape shape of the image
+                /// @param[in] layout decomposition into patches
+                /// @param[in] psf pointer to the PSF buffer
+                /// @param[in] psfShape shape of the PSF
+                /// @param[in] peakPSFPos position of the PSF peak
+                /// @param[in] gain loop gain
+                /// @param[in] threshold patches are cleaned down to this absolute value
+                /// @param[in] remaining maximum number of components per patch
+                /// @param[in] rank rank cleaning the patches
+                /// @param[in] nProcs number of ranks sharing the patches
+                /// @param[out] components components found for every patch
+                static void cleanPatches(const T* residual, const T* mask, const casa::IPosition &shape,
+                                         const PatchLayout &layout, const T* psf,
+                                         const casa::IPosition &psfShape, const casa::IPosition &peakPSFPos,
+                                         const T gain, const T threshold, const int remaining,
+                                         const int rank, const int nProcs,
+                                         std::vector<ComponentList> &components);
+
+                /// @brief subtract components from the residual image
+                /// @details Every patch updates its own area for all components (in a separate
+                /// thread if OpenMP is available), so the result doesn't depend on the
+                /// number of threads.
+                /// @param[in] residual pointer to the residual buffer (full image)
+                /// @param[in] shape shape of the image
+                /// @param[in] layout decomposition into patches
+                /// @param[in] psf pointer to the PSF buffer
+                /// @param[in] psfShape shape of the PSF
+                /// @param[in] peakPSFPos position of the PSF peak
+                /// @param[in] components components to subtract
+                static void subtractComponents(T* residual, const casa::IPosition &shape,
+                                               const PatchLayout &layout, const T* psf,
+                                               const casa::IPosition &psfShape,
+                                               const casa::IPosition &peakPSFPos,
+                                               const ComponentList &components);
+
+                /// @brief collect the components of all patches on the master
+                /// @details Every rank contributes the components of the patches assigned to it.
+                /// This method is collective.
+                /// @param[in] comms communicator to use
+                /// @param[in] components components found for every patch (the master receives
+                /// the components of the patches cleaned by other ranks)
+                static void gatherComponents(IPatchComms &comms, std::vector<ComponentList> &components);
+
+                /// @brief broadcast the merged components from the master
+                /// @details This method is collective.
+                /// @param[in] comms communicator to use
+                /// @param[in] components components (input on the master, output on other ranks)
+                static void broadcastComponents(IPatchComms &comms, ComponentList &components);
+
+                /// @brief broadcast the control of the next round from the master
+                /// @details This method is collective.
+                /// @param[in] comms communicator to use
+                /// @param[in] proceed true if another round follows, false if the plane is done
+                /// @param[in] threshold patches are cleaned down to this absolute value (in/out)
+                /// @param[in] remaining maximum number of components per patch (in/out)
+                /// @return true if another round follows
+                static bool broadcastRound(IPatchComms &comms, bool proceed, T &threshold, int &remaining);
+
+                /// @brief find the peak of a region of the residual image
+                /// @details Mimics the peak search of oneIteration: if the mask is given,
+                /// the extrema of the residual multiplied by the mask are searched for,
+                /// but the unmasked value is returned.
+                /// @param[in] residual pointer to the residual buffer
+                /// @param[in] mask pointer to the mask buffer of the same shape (or 0)
+                /// @param[in] shape shape of the buffer
+                /// @param[in] blc bottom left corner of the region (inclusive) in buffer pixels
+                /// @param[in] trc top right corner of the region (inclusive) in buffer pixels
+                /// @param[out] pos position of the peak in buffer pixels
+                /// @return value of the peak
+                static T findPeak(const T* residual, const T* mask, const casa::IPosition &shape,
+                                  const casa::IPosition &blc, const casa::IPosition &trc,
+                                  casa::IPosition &pos);
+
+                /// @brief subtract the scaled PSF from a part of the residual image
+                /// @details The extent of the PSF used is the same as in oneIteration.
+                /// @param[in] residual pointer to the residual buffer
+                /// @param[in] origin position of the first pixel of the buffer in the full image
+                /// @param[in] shape shape of the buffer
+                /// @param[in] blc bottom left corner (inclusive, full image pixels) of the area to update
+                /// @param[in] trc top right corner (inclusive, full image pixels) of the area to update
+                /// @param[in] psf pointer to the PSF buffer
+                /// @param[in] psfShape shape of the PSF
+                /// @param[in] peakPSFPos position of the PSF peak
+                /// @param[in] pos position of the component in the full image
+                /// @param[in] flux flux of the component
+                static void subtractComponent(T* residual, const casa::IPosition &origin,
+                                              const casa::IPosition &shape, const casa::IPosition &blc,
+                                              const casa::IPosition &trc, const T* psf,
+                                              const casa::IPosition &psfShape,
+                                              const casa::IPosition &peakPSFPos,
+                                              const casa::IPosition &pos, const T flux);
+
+                /// @brief number of patches along the first axis
+                casa::uInt itsNPatchesX;
+
+                /// @brief number of patches along the second axis
+                casa::uInt itsNPatchesY;
+
+                /// @brief fraction of the peak residual to clean down to in each round
+                casa::Float itsPatchFraction;
+
+                /// @brief communicator to share the patches with other ranks (may be empty)
+                boost::shared_ptr<IPatchComms> itsPatchComms;
         };
 
     } // namespace synthesis
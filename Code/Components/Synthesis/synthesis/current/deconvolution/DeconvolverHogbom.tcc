@@ -31,6 +31,10 @@
 ///
 
 #include <string>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <functional>
 
 #include <casa/aips.h>
 #include <boost/shared_ptr.hpp>
@@ -58,7 +62,8 @@ namespace askap {
 
         template<class T, class FT>
         DeconvolverHogbom<T, FT>::DeconvolverHogbom(Vector<Array<T> >& dirty, Vector<Array<T> >& psf)
-                : DeconvolverBase<T, FT>::DeconvolverBase(dirty, psf)
+                : DeconvolverBase<T, FT>::DeconvolverBase(dirty, psf), itsNPatchesX(1),
+                itsNPatchesY(1), itsPatchFraction(0.8)
         {
             if (this->itsNumberDirtyTerms > 1) {
                 throw(AskapError("Hogbom CLEAN cannot perform multi-term deconvolutions"));
@@ -67,7 +72,8 @@ namespace askap {
 
         template<class T, class FT>
         DeconvolverHogbom<T, FT>::DeconvolverHogbom(Array<T>& dirty, Array<T>& psf)
-                : DeconvolverBase<T, FT>::DeconvolverBase(dirty, psf)
+                : DeconvolverBase<T, FT>::DeconvolverBase(dirty, psf), itsNPatchesX(1),
+                itsNPatchesY(1), itsPatchFraction(0.8)
         {
         };
 
@@ -83,11 +89,15 @@ namespace askap {
             this->initialise();
 
             ASKAPLOG_INFO_STR(dechogbomlogger, "Performing Hogbom CLEAN for " << this->control()->targetIter() << " iterations");
-            do {
-                this->oneIteration();
-                this->monitor()->monitor(*(this->state()));
-                this->state()->incIter();
-            } while (!this->control()->terminate(*(this->state())));
+            if (itsNPatchesX * itsNPatchesY > 1) {
+                deconvolvePatches();
+            } else {
+                do {
+                    this->oneIteration();
+                    this->monitor()->monitor(*(this->state()));
+                    this->state()->incIter();
+                } while (!this->control()->terminate(*(this->state())));
+            }
 
             ASKAPLOG_INFO_STR(dechogbomlogger, "Performed Hogbom CLEAN for " << this->state()->currentIter() << " iterations");
 
@@ -102,6 +112,24 @@ namespace askap {
         void DeconvolverHogbom<T, FT>::configure(const LOFAR::ParameterSet& parset)
         {
             DeconvolverBase<T, FT>::configure(parset);
+            const std::vector<int> patches = parset.getInt32Vector("patches", std::vector<int>(2, 1));
+            ASKAPCHECK(patches.size() == 2, "patches parameter should have exactly 2 elements, you have "
+                       << patches.size());
+            ASKAPCHECK((patches[0] > 0) && (patches[1] > 0), "Number of patches should be positive, you have "
+                       << patches[0] << "x" << patches[1]);
+            setPatches(casa::uInt(patches[0]), casa::uInt(patches[1]), parset.getFloat("patches.fraction", 0.8));
+        }
+
+        template<class T, class FT>
+        void DeconvolverHogbom<T, FT>::setPatches(casa::uInt nx, casa::uInt ny, casa::Float fraction)
+        {
+            ASKAPCHECK((nx > 0) && (ny > 0), "Number of patches should be positive, you have "
+                       << nx << "x" << ny);
+            ASKAPCHECK((fraction > 0.) && (fraction <= 1.), "patches.fraction should be within (0,1], you have "
+                       << fraction);
+            itsNPatchesX = nx;
+            itsNPatchesY = ny;
+            itsPatchFraction = fraction;
         }
 
         // This contains the heart of the Hogbom Clean algorithm
@@ -204,6 +232,432 @@ namespace askap {
             return True;
         }
 
+        template<class T, class FT>
+        void DeconvolverHogbom<T, FT>::setPatchComms(const boost::shared_ptr<IPatchComms> &comms)
+        {
+            ASKAPCHECK(!comms || (comms->rank() == 0), "Patch-based Hogbom CLEAN should run on the master, "
+                       "other ranks should serve patches");
+            itsPatchComms = comms;
+        }
+
+        template<class T, class FT>
+        DeconvolverHogbom<T, FT>::PatchLayout::PatchLayout(const casa::IPosition &shape, casa::uInt nx,
+                casa::uInt ny, const casa::IPosition &subPsfShape) : itsSubPsfShape(subPsfShape),
+                itsPatchBlc(nx * ny), itsPatchTrc(nx * ny), itsGuardBlc(nx * ny), itsGuardTrc(nx * ny)
+        {
+            ASKAPDEBUGASSERT(shape.nelements() == 2);
+            for (casa::uInt iy = 0; iy < ny; ++iy) {
+                for (casa::uInt ix = 0; ix < nx; ++ix) {
+                    const casa::uInt patch = ix + nx * iy;
+                    itsPatchBlc[patch] = casa::IPosition(2, ix * shape(0) / nx, iy * shape(1) / ny);
+                    itsPatchTrc[patch] = casa::IPosition(2, (ix + 1) * shape(0) / nx - 1, (iy + 1) * shape(1) / ny - 1);
+                    itsGuardBlc[patch] = casa::IPosition(2, 0);
+                    itsGuardTrc[patch] = casa::IPosition(2, 0);
+                    for (casa::uInt dim = 0; dim < 2; ++dim) {
+                        itsGuardBlc[patch](dim) = std::max(0, Int(itsPatchBlc[patch](dim) - subPsfShape(dim) / 2));
+                        itsGuardTrc[patch](dim) = std::min(Int(shape(dim) - 1), Int(itsPatchTrc[patch](dim) + subPsfShape(dim) / 2));
+                    }
+                }
+            }
+        }
+
+        template<class T, class FT>
+        void DeconvolverHogbom<T, FT>::deconvolvePatches()
+        {
+            const bool isMasked(this->weight(0).shape().conform(this->dirty(0).shape()));
+            const casa::IPosition shape(this->dirty(0).shape());
+            ASKAPCHECK(shape.nelements() == 2, "Patch-based Hogbom CLEAN requires 2D images, you have "
+                       << shape);
+            ASKAPCHECK(this->psf(0).shape().conform(shape), "PSF shape " << this->psf(0).shape()
+                       << " doesn't match the residual image shape " << shape);
+            ASKAPDEBUGASSERT(this->dirty(0).contiguousStorage());
+            ASKAPDEBUGASSERT(this->psf(0).contiguousStorage());
+            ASKAPDEBUGASSERT(!isMasked || this->weight(0).contiguousStorage());
+            ASKAPDEBUGASSERT(this->model(0).shape() == shape);
+
+            const casa::uInt nx = std::min(itsNPatchesX, casa::uInt(shape(0)));
+            const casa::uInt ny = std::min(itsNPatchesY, casa::uInt(shape(1)));
+            const PatchLayout layout(shape, nx, ny, this->findSubPsfShape());
+            const int nProcs = itsPatchComms ? itsPatchComms->nProcs() : 1;
+            ASKAPLOG_INFO_STR(dechogbomlogger, "Cleaning " << nx << "x" << ny << " patches in parallel on "
+                              << nProcs << " rank(s), guard zone is " << layout.itsSubPsfShape(0) / 2 << "x"
+                              << layout.itsSubPsfShape(1) / 2 << " pixels, patches are synchronised at "
+                              << itsPatchFraction << " of the peak residual");
+
+            // raw buffers are used inside the parallel sections, casa arrays
+            // are reference-counted without locking
+            T* residual = this->dirty(0).data();
+            T* mask = isMasked ? this->weight(0).data() : 0;
+            T* psf = this->psf(0).data();
+            const casa::IPosition psfShape(this->psf(0).shape());
+            const T gain(this->control()->gain());
+            const casa::IPosition origin(2, 0);
+
+            if (itsPatchComms) {
+                // other ranks get their own copy of the residual image, they keep it
+                // up to date by subtracting the merged components every round
+                std::vector<double> header(PATCH_HEADER_SIZE);
+                header[0] = 1.;
+                for (casa::uInt dim = 0; dim < 2; ++dim) {
+                     header[1 + dim] = shape(dim);
+                     header[3 + dim] = psfShape(dim);
+                     header[5 + dim] = this->itsPeakPSFPos(dim);
+                     header[10 + dim] = layout.itsSubPsfShape(dim);
+                }
+                header[7] = isMasked ? 1. : 0.;
+                header[8] = nx;
+                header[9] = ny;
+                header[12] = gain;
+                itsPatchComms->broadcast(&header[0], header.size() * sizeof(double));
+                itsPatchComms->broadcast(psf, psfShape.product() * sizeof(T));
+                itsPatchComms->broadcast(residual, shape.product() * sizeof(T));
+                if (isMasked) {
+                    itsPatchComms->broadcast(mask, shape.product() * sizeof(T));
+                }
+            }
+
+            // components found in the current round for each patch
+            std::vector<ComponentList> components(layout.itsPatchBlc.size());
+
+            for (casa::uInt round = 0; ; ++round) {
+                // the global peak defines the state, exactly as for the serial algorithm
+                casa::IPosition absPeakPos;
+                const T absPeakVal = findPeak(residual, mask, shape, origin, shape - 1, absPeakPos);
+                this->state()->setPeakResidual(absPeakVal);
+                this->state()->setObjectiveFunction(absPeakVal);
+                this->state()->setTotalFlux(sum(this->model()));
+                if (this->control()->terminate(*(this->state()))) {
+                    break;
+                }
+
+                int remaining = this->control()->targetIter() - this->state()->currentIter();
+                ASKAPDEBUGASSERT(remaining > 0);
+                T threshold = std::max(std::max(this->control()->targetObjectiveFunction(),
+                                       T(this->control()->fractionalThreshold() *
+                                         this->state()->initialObjectiveFunction())),
+                                       T(itsPatchFraction * abs(absPeakVal)));
+                ASKAPLOG_INFO_STR(dechogbomlogger, "Round " << round << ": peak residual = " << absPeakVal << " at "
+                                  << absPeakPos << ", cleaning patches down to " << threshold);
+
+                // clean patches independently using local copies of the residual
+                if (itsPatchComms) {
+                    broadcastRound(*itsPatchComms, true, threshold, remaining);
+                }
+                cleanPatches(residual, mask, shape, layout, psf, psfShape, this->itsPeakPSFPos, gain,
+                             threshold, remaining, 0, nProcs, components);
+                if (itsPatchComms) {
+                    gatherComponents(*itsPatchComms, components);
+                }
+
+                // merge the components, the strongest are taken if there are more than
+                // the remaining number of iterations
+                std::vector<std::pair<T, size_t> > order;
+                ComponentList merged;
+                for (size_t patch = 0; patch < components.size(); ++patch) {
+                    for (size_t comp = 0; comp < components[patch].size(); ++comp) {
+                         order.push_back(std::make_pair(abs(components[patch][comp].second), merged.size()));
+                         merged.push_back(components[patch][comp]);
+                    }
+                }
+                if (int(merged.size()) > remaining) {
+                    std::sort(order.begin(), order.end(), std::greater<std::pair<T, size_t> >());
+                    order.resize(remaining);
+                    ComponentList selected;
+                    selected.reserve(order.size());
+                    for (size_t comp = 0; comp < order.size(); ++comp) {
+                         selected.push_back(merged[order[comp].second]);
+                    }
+                    merged.swap(selected);
+                }
+                if (itsPatchComms) {
+                    broadcastComponents(*itsPatchComms, merged);
+                }
+                if (merged.size() == 0) {
+                    // the peaks are searched for in the masked residual, so none of the patches
+                    // may have a component above the threshold even if the global peak is
+                    ASKAPLOG_INFO_STR(dechogbomlogger, "Round " << round
+                                      << ": no components above the threshold are found, stopping");
+                    break;
+                }
+                for (size_t comp = 0; comp < merged.size(); ++comp) {
+                     this->model(0)(merged[comp].first) += merged[comp].second;
+                     this->state()->incIter();
+                }
+
+                // synchronise the residual
+                subtractComponents(residual, shape, layout, psf, psfShape, this->itsPeakPSFPos, merged);
+                ASKAPLOG_INFO_STR(dechogbomlogger, "Round " << round << ": " << merged.size()
+                                  << " components subtracted");
+                this->monitor()->monitor(*(this->state()));
+            }
+
+            if (itsPatchComms) {
+                // release other ranks, they wait for the next plane after that
+                T threshold(0.);
+                int remaining = 0;
+                broadcastRound(*itsPatchComms, false, threshold, remaining);
+            }
+        }
+
+        template<class T, class FT>
+        bool DeconvolverHogbom<T, FT>::servePatches(IPatchComms &comms)
+        {
+            ASKAPCHECK(comms.rank() != 0, "The master should run the deconvolver rather than serve patches");
+            std::vector<double> header(PATCH_HEADER_SIZE);
+            comms.broadcast(&header[0], header.size() * sizeof(double));
+            if (header[0] == 0.) {
+                return false;
+            }
+            const casa::IPosition shape(2, casa::Int(header[1]), casa::Int(header[2]));
+            const casa::IPosition psfShape(2, casa::Int(header[3]), casa::Int(header[4]));
+            const casa::IPosition peakPSFPos(2, casa::Int(header[5]), casa::Int(header[6]));
+            const bool isMasked = (header[7] != 0.);
+            const PatchLayout layout(shape, casa::uInt(header[8]), casa::uInt(header[9]),
+                                     casa::IPosition(2, casa::Int(header[10]), casa::Int(header[11])));
+            const T gain(header[12]);
+
+            std::vector<T> psf(psfShape.product());
+            std::vector<T> residual(shape.product());
+            std::vector<T> mask(isMasked ? residual.size() : 0);
+            comms.broadcast(&psf[0], psf.size() * sizeof(T));
+            comms.broadcast(&residual[0], residual.size() * sizeof(T));
+            if (isMasked) {
+                comms.broadcast(&mask[0], mask.size() * sizeof(T));
+            }
+
+            std::vector<ComponentList> components(layout.itsPatchBlc.size());
+            T threshold(0.);
+            int remaining = 0;
+            size_t nComponents = 0;
+            while (broadcastRound(comms, true, threshold, remaining)) {
+                cleanPatches(&residual[0], isMasked ? &mask[0] : 0, shape, layout, &psf[0], psfShape,
+                             peakPSFPos, gain, threshold, remaining, comms.rank(), comms.nProcs(), components);
+                gatherComponents(comms, components);
+                ComponentList merged;
+                broadcastComponents(comms, merged);
+                subtractComponents(&residual[0], shape, layout, &psf[0], psfShape, peakPSFPos, merged);
+                nComponents += merged.size();
+            }
+            ASKAPLOG_INFO_STR(dechogbomlogger, "Served patches of a " << shape << " plane, "
+                              << nComponents << " components subtracted in total");
+            return true;
+        }
+
+        template<class T, class FT>
+        void DeconvolverHogbom<T, FT>::stopPatchServers(IPatchComms &comms)
+        {
+            ASKAPCHECK(comms.rank() == 0, "Only the master can stop ranks serving patches");
+            std::vector<double> header(PATCH_HEADER_SIZE, 0.);
+            comms.broadcast(&header[0], header.size() * sizeof(double));
+        }
+
+        template<class T, class FT>
+        void DeconvolverHogbom<T, FT>::cleanPatches(const T* residual, const T* mask, const casa::IPosition &shape,
+                const PatchLayout &layout, const T* psf, const casa::IPosition &psfShape,
+                const casa::IPosition &peakPSFPos, const T gain, const T threshold, const int remaining,
+                const int rank, const int nProcs, std::vector<ComponentList> &components)
+        {
+            const int nPatches = int(layout.itsPatchBlc.size());
+            ASKAPDEBUGASSERT(int(components.size()) == nPatches);
+            const casa::IPosition &subPsfShape = layout.itsSubPsfShape;
+            #pragma omp parallel for schedule(dynamic)
+            for (int patch = 0; patch < nPatches; ++patch) {
+                if (patch % nProcs != rank) {
+                    continue;
+                }
+                components[patch].resize(0);
+                const casa::IPosition &guardBlc = layout.itsGuardBlc[patch];
+                const casa::IPosition localShape = layout.itsGuardTrc[patch] - guardBlc + 1;
+                std::vector<T> local(localShape.product());
+                std::vector<T> localMask(mask ? local.size() : 0);
+                for (Int y = 0; y < localShape(1); ++y) {
+                    const size_t offset = guardBlc(0) + (guardBlc(1) + y) * shape(0);
+                    std::copy(residual + offset, residual + offset + localShape(0), local.begin() + y * localShape(0));
+                    if (mask) {
+                        std::copy(mask + offset, mask + offset + localShape(0), localMask.begin() + y * localShape(0));
+                    }
+                }
+                // peaks are only searched for within the patch itself
+                const casa::IPosition localBlc = layout.itsPatchBlc[patch] - guardBlc;
+                const casa::IPosition localTrc = layout.itsPatchTrc[patch] - guardBlc;
+                casa::IPosition peakPos;
+                for (int iter = 0; iter < remaining; ++iter) {
+                    const T peakVal = findPeak(&local[0], mask ? &localMask[0] : 0, localShape,
+                                               localBlc, localTrc, peakPos);
+                    if (abs(peakVal) < threshold) {
+                        break;
+                    }
+                    const casa::IPosition pos = peakPos + guardBlc;
+                    components[patch].push_back(std::make_pair(pos, gain * peakVal));
+                    subtractComponent(&local[0], guardBlc, localShape,
+                                      pos - subPsfShape / 2, pos + subPsfShape / 2 - 1,
+                                      psf, psfShape, peakPSFPos, pos, gain * peakVal);
+                }
+            }
+        }
+
+        template<class T, class FT>
+        void DeconvolverHogbom<T, FT>::subtractComponents(T* residual, const casa::IPosition &shape,
+                const PatchLayout &layout, const T* psf, const casa::IPosition &psfShape,
+                const casa::IPosition &peakPSFPos, const ComponentList &components)
+        {
+            const int nPatches = int(layout.itsPatchBlc.size());
+            const casa::IPosition origin(2, 0);
+            #pragma omp parallel for schedule(dynamic)
+            for (int patch = 0; patch < nPatches; ++patch) {
+                for (size_t comp = 0; comp < components.size(); ++comp) {
+                     subtractComponent(residual, origin, shape, layout.itsPatchBlc[patch], layout.itsPatchTrc[patch],
+                                       psf, psfShape, peakPSFPos, components[comp].first, components[comp].second);
+                }
+            }
+        }
+
+        template<class T, class FT>
+        void DeconvolverHogbom<T, FT>::gatherComponents(IPatchComms &comms, std::vector<ComponentList> &components)
+        {
+            const int rank = comms.rank();
+            const int nProcs = comms.nProcs();
+            const size_t nPatches = components.size();
+            // the number of components per patch is needed to place them in the buffer
+            std::vector<double> counts(nPatches, 0.);
+            for (size_t patch = 0; patch < nPatches; ++patch) {
+                 if (int(patch) % nProcs == rank) {
+                     counts[patch] = components[patch].size();
+                 }
+            }
+            comms.sumToMaster(&counts[0], counts.size());
+            comms.broadcast(&counts[0], counts.size() * sizeof(double));
+            std::vector<size_t> offsets(nPatches + 1, 0);
+            for (size_t patch = 0; patch < nPatches; ++patch) {
+                 offsets[patch + 1] = offsets[patch] + size_t(counts[patch]);
+                 if ((rank == 0) && (int(patch) % nProcs != rank)) {
+                     components[patch].resize(0);
+                 }
+            }
+            if (offsets[nPatches] == 0) {
+                return;
+            }
+            // each component is represented by its position and flux
+            std::vector<double> buf(3 * offsets[nPatches], 0.);
+            for (size_t patch = 0; patch < nPatches; ++patch) {
+                 if (int(patch) % nProcs == rank) {
+                     for (size_t comp = 0; comp < components[patch].size(); ++comp) {
+                          double* compPtr = &buf[3 * (offsets[patch] + comp)];
+                          compPtr[0] = components[patch][comp].first(0);
+                          compPtr[1] = components[patch][comp].first(1);
+                          compPtr[2] = components[patch][comp].second;
+                     }
+                 }
+            }
+            comms.sumToMaster(&buf[0], buf.size());
+            if (rank == 0) {
+                for (size_t patch = 0; patch < nPatches; ++patch) {
+                     if (int(patch) % nProcs != rank) {
+                         for (size_t index = offsets[patch]; index < offsets[patch + 1]; ++index) {
+                              const double* compPtr = &buf[3 * index];
+                              components[patch].push_back(std::make_pair(casa::IPosition(2,
+                                      casa::Int(compPtr[0]), casa::Int(compPtr[1])), T(compPtr[2])));
+                         }
+                     }
+                }
+            }
+        }
+
+        template<class T, class FT>
+        void DeconvolverHogbom<T, FT>::broadcastComponents(IPatchComms &comms, ComponentList &components)
+        {
+            double nComponents = components.size();
+            comms.broadcast(&nComponents, sizeof(double));
+            if (nComponents == 0.) {
+                components.resize(0);
+                return;
+            }
+            std::vector<double> buf(3 * size_t(nComponents));
+            if (comms.rank() == 0) {
+                for (size_t comp = 0; comp < components.size(); ++comp) {
+                     buf[3 * comp] = components[comp].first(0);
+                     buf[3 * comp + 1] = components[comp].first(1);
+                     buf[3 * comp + 2] = components[comp].second;
+                }
+            }
+            comms.broadcast(&buf[0], buf.size() * sizeof(double));
+            if (comms.rank() != 0) {
+                components.resize(0);
+                for (size_t comp = 0; comp < size_t(nComponents); ++comp) {
+                     components.push_back(std::make_pair(casa::IPosition(2, casa::Int(buf[3 * comp]),
+                                          casa::Int(buf[3 * comp + 1])), T(buf[3 * comp + 2])));
+                }
+            }
+        }
+
+        template<class T, class FT>
+        bool DeconvolverHogbom<T, FT>::broadcastRound(IPatchComms &comms, bool proceed, T &threshold, int &remaining)
+        {
+            double control[3] = {proceed ? 1. : 0., double(threshold), double(remaining)};
+            comms.broadcast(control, sizeof(control));
+            threshold = T(control[1]);
+            remaining = int(control[2]);
+            return control[0] != 0.;
+        }
+
+        template<class T, class FT>
+        T DeconvolverHogbom<T, FT>::findPeak(const T* residual, const T* mask, const casa::IPosition &shape,
+                                             const casa::IPosition &blc, const casa::IPosition &trc,
+                                             casa::IPosition &pos)
+        {
+            ASKAPDEBUGASSERT(shape.nelements() == 2);
+            size_t minIndex = blc(0) + blc(1) * shape(0);
+            size_t maxIndex = minIndex;
+            T minVal = mask ? residual[minIndex] * mask[minIndex] : residual[minIndex];
+            T maxVal = minVal;
+            for (Int y = blc(1); y <= trc(1); ++y) {
+                for (Int x = blc(0); x <= trc(0); ++x) {
+                    const size_t index = x + y * shape(0);
+                    const T val = mask ? residual[index] * mask[index] : residual[index];
+                    if (val < minVal) {
+                        minVal = val;
+                        minIndex = index;
+                    }
+                    if (val > maxVal) {
+                        maxVal = val;
+                        maxIndex = index;
+                    }
+                }
+            }
+            const size_t index = abs(residual[minIndex]) < abs(residual[maxIndex]) ? maxIndex : minIndex;
+            pos = casa::IPosition(2, index % shape(0), index / shape(0));
+            return residual[index];
+        }
+
+        template<class T, class FT>
+        void DeconvolverHogbom<T, FT>::subtractComponent(T* residual, const casa::IPosition &origin,
+                const casa::IPosition &shape, const casa::IPosition &blc, const casa::IPosition &trc,
+                const T* psf, const casa::IPosition &psfShape, const casa::IPosition &peakPSFPos,
+                const casa::IPosition &pos, const T flux)
+        {
+            casa::IPosition start(2, 0), end(2, 0);
+            for (casa::uInt dim = 0; dim < 2; ++dim) {
+                // the same extent of the PSF as in oneIteration
+                start(dim) = std::max(pos(dim) - psfShape(dim) / 2, pos(dim) - peakPSFPos(dim));
+                end(dim) = std::min(pos(dim) + psfShape(dim) / 2 - 1,
+                                    pos(dim) - peakPSFPos(dim) + psfShape(dim) - 1);
+                // restrict to the buffer and to the requested area
+                start(dim) = std::max(std::max(start(dim), origin(dim)), blc(dim));
+                end(dim) = std::min(std::min(end(dim), origin(dim) + shape(dim) - 1), trc(dim));
+                if (start(dim) > end(dim)) {
+                    return;
+                }
+            }
+            for (Int y = start(1); y <= end(1); ++y) {
+                T* resPtr = residual + (start(0) - origin(0)) + (y - origin(1)) * shape(0);
+                const T* psfPtr = psf + (start(0) - pos(0) + peakPSFPos(0)) +
+                                  (y - pos(1) + peakPSFPos(1)) * psfShape(0);
+                for (Int x = start(0); x <= end(0); ++x, ++resPtr, ++psfPtr) {
+                    *resPtr -= flux * (*psfPtr);
+                }
+            }
+        }
+
     } // namespace synthesis
 
 } // namespace askap
@@ -0,0 +1,43 @@
+/// @file IPatchComms.cc
+/// @brief Interface for the communication used by the patch-based Hogbom CLEAN
+/// @details The patch-based Hogbom CLEAN can share the patches of a residual image
+/// between a number of ranks. This interface encapsulates the few collective operations
+/// it needs, so the deconvolution code does not depend on MPI.
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author agent <agent@local>
+///
+
+#include <deconvolution/IPatchComms.h>
+
+namespace askap {
+
+    namespace synthesis {
+
+        /// @brief virtual destructor (does nothing in this class)
+        IPatchComms::~IPatchComms() {}
+
+    } // namespace synthesis
+
+} // namespace askap
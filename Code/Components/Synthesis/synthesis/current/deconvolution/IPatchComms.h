@@ -0,0 +1,77 @@
+/// @file IPatchComms.h
+/// @brief Interface for the communication used by the patch-based Hogbom CLEAN
+/// @details The patch-based Hogbom CLEAN can share the patches of a residual image
+/// between a number of ranks. This interface encapsulates the few collective operations
+/// it needs, so the deconvolution code does not depend on MPI.
+/// @ingroup Deconvolver
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author agent <agent@local>
+///
+
+#ifndef ASKAP_SYNTHESIS_IPATCHCOMMS_H
+#define ASKAP_SYNTHESIS_IPATCHCOMMS_H
+
+#include <cstddef>
+
+namespace askap {
+
+    namespace synthesis {
+
+        /// @brief Interface for the communication used by the patch-based Hogbom CLEAN
+        /// @details All methods are collective, i.e. every rank should call them in the same
+        /// order. Rank 0 is the master, which runs the deconvolver. Other ranks serve the
+        /// patches assigned to them (see DeconvolverHogbom::servePatches).
+        /// @ingroup Deconvolver
+        struct IPatchComms {
+
+            /// @brief virtual destructor (does nothing in this class)
+            virtual ~IPatchComms();
+
+            /// @brief rank of this process
+            /// @return rank in the range [0, nProcs()), 0 is the master
+            virtual int rank() const = 0;
+
+            /// @brief number of ranks sharing the patches
+            /// @return number of ranks including the master
+            virtual int nProcs() const = 0;
+
+            /// @brief broadcast a buffer from the master to all other ranks
+            /// @param[in] buf pointer to the buffer (input on the master, output on other ranks)
+            /// @param[in] size size of the buffer in bytes
+            virtual void broadcast(void* buf, size_t size) = 0;
+
+            /// @brief sum a buffer across all ranks, the result is received by the master
+            /// @details The content of the buffer on ranks other than the master is undefined
+            /// after the call.
+            /// @param[in] buf pointer to the buffer (in/out)
+            /// @param[in] n number of elements in the buffer
+            virtual void sumToMaster(double* buf, size_t n) = 0;
+        };
+
+    } // namespace synthesis
+
+} // namespace askap
+
+#endif // #ifndef ASKAP_SYNTHESIS_IPATCHCOMMS_H
@@ -234,7 +234,7 @@ void AProjectWStackVisGridder::initConvolutionFunction(const accessors::IConstDa
     if(itsSupport==0) {
         ASKAPLOG_INFO_STR(logger, "Resizing convolution function to "
                 << itsOverSample << "*" << itsOverSample << "*" << itsMaxFeeds << "*" << itsMaxFields << "*" << nChan << " entries");
-        itsConvFunc.resize(itsOverSample*itsOverSample*itsMaxFeeds*itsMaxFields*nChan);
+        itsConvFunc.init(itsMaxFeeds*itsMaxFields*nChan, itsOverSample);
 
         ASKAPLOG_INFO_STR(logger, "Resizing sum of weights to " << itsMaxFeeds << "*" << itsMaxFields << "*" << nChan << " entries");
         resizeSumOfWeights(itsMaxFeeds*itsMaxFields*nChan);
@@ -324,25 +324,24 @@ void AProjectWStackVisGridder::initConvolutionFunction(const accessors::IConstDa
                 // Since we are decimating, we need to rescale by the
                 // decimation factor
                 const double rescale=double(itsOverSample*itsOverSample);
-                const int cSize=2*itsSupport+1;
+                itsConvFunc.allocate(zIndex, itsSupport);
                 for (int fracu=0; fracu<itsOverSample; fracu++) {
                     for (int fracv=0; fracv<itsOverSample; fracv++) {
                         int plane=fracu+itsOverSample*(fracv+itsOverSample*zIndex);
                         ASKAPDEBUGASSERT(plane>=0 && plane<int(itsConvFunc.size()));
-                        itsConvFunc[plane].resize(cSize, cSize);
-                        itsConvFunc[plane].set(0.0);
+                        casa::Matrix<casa::Complex> thisCF = itsConvFunc.matrix(plane);
                         // Now cut out the inner part of the convolution function and
                         // insert it into the cache
                         for (int iy=-itsSupport; iy<itsSupport; iy++) {
                             for (int ix=-itsSupport; ix<itsSupport; ix++) {
-                                itsConvFunc[plane](ix+itsSupport, iy+itsSupport)
+                                thisCF(ix+itsSupport, iy+itsSupport)
                                     = rescale * pattern(itsOverSample*ix+fracu+nx/2,
                                             itsOverSample*iy+fracv+ny/2);
                             } // for ix
                         } // for iy
                         //
                         //ASKAPLOG_DEBUG_STR(logger, "convolution function for channel "<<chan<<
-                        //   " plane="<<plane<<" has an integral of "<<sum(itsConvFunc[plane]));						
+                        //   " plane="<<plane<<" has an integral of "<<sum(thisCF));						
                         //
                     } // for fracv
                 } // for fracu								
@@ -412,9 +411,10 @@ void AProjectWStackVisGridder::finaliseWeights(casa::Array<double>& out) {
             thisPlane.set(0.0);
             const std::pair<int,int> cfOffset = getConvFuncOffset(iz);
             
-            ASKAPDEBUGASSERT((int(itsConvFunc[plane].nrow()) - 1) / 2 == itsSupport);
-            ASKAPDEBUGASSERT(itsConvFunc[plane].nrow() % 2 == 1);
-            ASKAPDEBUGASSERT(itsConvFunc[plane].nrow() == itsConvFunc[plane].ncolumn());
+            const casa::Matrix<casa::Complex> thisCF = itsConvFunc.copyOf(plane);
+            ASKAPDEBUGASSERT((int(thisCF.nrow()) - 1) / 2 == itsSupport);
+            ASKAPDEBUGASSERT(thisCF.nrow() % 2 == 1);
+            ASKAPDEBUGASSERT(thisCF.nrow() == thisCF.ncolumn());
 
             for (int iy=-itsSupport; iy<+itsSupport; ++iy) {
                 for (int ix=-itsSupport; ix<+itsSupport; ++ix) {
@@ -423,7 +423,7 @@ void AProjectWStackVisGridder::finaliseWeights(casa::Array<double>& out) {
 	                 if ((xPos<0) || (yPos<0) || (xPos>=int(thisPlane.nrow())) || (yPos>=int(thisPlane.ncolumn()))) {
 	                     continue;
 	                 }                
-                     thisPlane(xPos, yPos)=itsConvFunc[plane](ix+itsSupport, iy+itsSupport);
+                     thisPlane(xPos, yPos)=thisCF(ix+itsSupport, iy+itsSupport);
                 }
             }
 
@@ -242,7 +242,7 @@ void AWProjectVisGridder::initConvolutionFunction(const accessors::IConstDataAcc
     const int nChan = itsFreqDep ? acc.nChannel() : 1;
 
     if (itsSupport == 0) {
-        itsConvFunc.resize(itsOverSample*itsOverSample*nWPlanes()*itsMaxFeeds*itsMaxFields*nChan);
+        itsConvFunc.init(nWPlanes()*itsMaxFeeds*itsMaxFields*nChan, itsOverSample);
         resizeSumOfWeights(nWPlanes()*itsMaxFeeds*itsMaxFields*nChan);
         zeroSumOfWeights();
 
@@ -407,29 +407,28 @@ void AWProjectVisGridder::initConvolutionFunction(const accessors::IConstDataAcc
                     // Since we are decimating, we need to rescale by the
                     // decimation factor
                     const double rescale = double(itsOverSample * itsOverSample);
-                    const int cSize = 2 * support + 1;
+                    itsConvFunc.allocate(zIndex, support);
 
                     for (int fracu = 0; fracu < itsOverSample; fracu++) {
                         for (int fracv = 0; fracv < itsOverSample; fracv++) {
                             const int plane = fracu + itsOverSample * (fracv + itsOverSample
                                               * zIndex);
                             ASKAPDEBUGASSERT(plane >= 0 && plane < int(itsConvFunc.size()));
-                            itsConvFunc[plane].resize(cSize, cSize);
-                            itsConvFunc[plane].set(0.0);
+                            casa::Matrix<casa::Complex> thisCF = itsConvFunc.matrix(plane);
 
                             // Now cut out the inner part of the convolution function and
                             // insert it into the convolution function
                             for (int iy = -support; iy < support; iy++) {
                                 for (int ix = -support; ix < support; ix++) {
                                     ASKAPDEBUGASSERT((ix + support >= 0) && (iy + support >= 0));
-                                    ASKAPDEBUGASSERT(ix + support < int(itsConvFunc[plane].nrow()));
-                                    ASKAPDEBUGASSERT(iy + support < int(itsConvFunc[plane].ncolumn()));
+                                    ASKAPDEBUGASSERT(ix + support < int(thisCF.nrow()));
+                                    ASKAPDEBUGASSERT(iy + support < int(thisCF.ncolumn()));
                                     ASKAPDEBUGASSERT((ix + cfSupport.itsOffsetU)*itsOverSample + fracu + int(nx) / 2 >= 0);
                                     ASKAPDEBUGASSERT((iy + cfSupport.itsOffsetV)*itsOverSample + fracv + int(ny) / 2 >= 0);
                                     ASKAPDEBUGASSERT((ix + cfSupport.itsOffsetU)*itsOverSample + fracu + int(nx) / 2 < int(thisPlane.nrow()));
                                     ASKAPDEBUGASSERT((iy + cfSupport.itsOffsetV)*itsOverSample + fracv + int(ny) / 2 < int(thisPlane.ncolumn()));
 
-                                    itsConvFunc[plane](ix + support, iy + support)
+                                    thisCF(ix + support, iy + support)
                                     = rescale * thisPlane((ix + cfSupport.itsOffsetU) * itsOverSample + fracu + nx / 2,
                                                           (iy + cfSupport.itsOffsetV) * itsOverSample + fracv + ny / 2);
                                 } // for ix
@@ -438,12 +437,12 @@ void AWProjectVisGridder::initConvolutionFunction(const accessors::IConstDataAcc
 
                             /*
                             // force normalization for all fractional offsets (or planes)
-                            const double norm = sum(real(itsConvFunc[plane]));
+                            const double norm = sum(real(thisCF));
                             //    ASKAPLOG_INFO_STR(logger, "Sum of convolution function = " << norm<<" for plane "<<plane<<
                             //       " full buffer has sum="<<thisPlaneNorm<<" ratio="<<norm/thisPlaneNorm);
                             ASKAPDEBUGASSERT(norm>0.);
                             if (norm>0.) {
-                                //itsConvFunc[plane]*=casa::Complex(norm/thisPlaneNorm);
+                                //thisCF*=casa::Complex(norm/thisPlaneNorm);
                             }
                             */
 
@@ -465,11 +464,12 @@ void AWProjectVisGridder::initConvolutionFunction(const accessors::IConstDataAcc
 
             for (size_t plane = 0; plane < itsConvFunc.size(); plane += step * itsOverSample * itsOverSample) {
                 ASKAPLOG_DEBUG_STR(logger, "CF cache plane " << plane << " (" << plane / itsOverSample / itsOverSample <<
-                                   " prior to oversampling) shape is " << itsConvFunc[plane].shape());
+                                   " prior to oversampling) support is " <<
+                                   itsConvFunc.support(plane / itsOverSample / itsOverSample));
             }
         } else {
-            ASKAPLOG_INFO_STR(logger, "Shape of convolution function = "
-                                  << itsConvFunc[0].shape() << " by " << itsConvFunc.size() << " planes");
+            ASKAPLOG_INFO_STR(logger, "Support of convolution function = "
+                                  << itsConvFunc.support(0) << " by " << itsConvFunc.size() << " planes");
         }
     }
 
@@ -557,9 +557,10 @@ void AWProjectVisGridder::finaliseWeights(casa::Array<double>& out)
 
             // use either support determined for this particular plane or a generic one,
             // determined from the first plane (largest support as we have the largest w-term)
-            const int support = (int(itsConvFunc[plane].nrow()) - 1) / 2;
-            ASKAPDEBUGASSERT(itsConvFunc[plane].nrow() % 2 == 1);
-            ASKAPDEBUGASSERT(itsConvFunc[plane].nrow() == itsConvFunc[plane].ncolumn());
+            const casa::Matrix<casa::Complex> thisCF = itsConvFunc.copyOf(plane);
+            const int support = (int(thisCF.nrow()) - 1) / 2;
+            ASKAPDEBUGASSERT(thisCF.nrow() % 2 == 1);
+            ASKAPDEBUGASSERT(thisCF.nrow() == thisCF.ncolumn());
 
             const std::pair<int, int> cfOffset = getConvFuncOffset(iz);
 
@@ -572,7 +573,7 @@ void AWProjectVisGridder::finaliseWeights(casa::Array<double>& out)
                         continue;
                     }
 
-                    thisPlane(xPos, yPos) = itsConvFunc[plane](ix + support, iy + support);
+                    thisPlane(xPos, yPos) = thisCF(ix + support, iy + support);
                 }
             }
 
@@ -0,0 +1,264 @@
+/// @file
+/// @brief Contiguous storage of oversampled convolution functions
+/// @details Gridders used to keep convolution functions as a vector of casa matrices,
+/// one per plane and oversampling offset. Each of them is a separate heap allocation
+/// with its own reference counting, and the whole cache had to be deep copied every
+/// time a gridder was cloned. This class keeps all convolution functions in a single
+/// aligned buffer and hands out raw pointers to the gridding kernels.
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author agent <agent@local>
+
+#include <gridding/ConvFuncStore.h>
+
+// std includes
+#include <algorithm>
+#include <cstdlib>
+
+namespace askap {
+
+namespace synthesis {
+
+/// @brief alignment of each convolution function in bytes
+static const size_t cfAlignment = 64;
+
+/// @brief allocate the buffer
+/// @param[in] size number of elements
+ConvFuncStore::Buffer::Buffer(const size_t size) : itsData(NULL), itsSize(size)
+{
+   void *ptr = NULL;
+   ASKAPCHECK(posix_memalign(&ptr, cfAlignment, size * sizeof(casa::Complex)) == 0,
+              "Unable to allocate "<<size * sizeof(casa::Complex)<<" bytes for convolution functions");
+   itsData = static_cast<casa::Complex*>(ptr);
+}
+
+/// @brief release the memory
+ConvFuncStore::Buffer::~Buffer()
+{
+   free(itsData);
+}
+
+/// @brief construct an empty store
+ConvFuncStore::ConvFuncStore() : itsUsed(0), itsOverSample(1) {}
+
+/// @brief initialise the store
+/// @details All planes and offsets are dropped, no plane is allocated after this call.
+/// @param[in] nPlanes number of planes (before oversampling)
+/// @param[in] overSample oversampling factor
+void ConvFuncStore::init(const casa::uInt nPlanes, const int overSample)
+{
+   ASKAPCHECK(overSample > 0, "Oversampling factor should be positive, you have "<<overSample);
+   itsBuffer.reset();
+   itsUsed = 0;
+   itsOverSample = overSample;
+   itsSupport.assign(nPlanes, -1);
+   itsStart.assign(nPlanes, 0);
+   itsCFStride.assign(nPlanes, 0);
+   itsOffsets.clear();
+}
+
+/// @brief largest support across all allocated planes
+/// @return maximum support (zero if nothing is allocated)
+int ConvFuncStore::maxSupport() const
+{
+   int result = 0;
+   for (std::vector<int>::const_iterator ci = itsSupport.begin(); ci != itsSupport.end(); ++ci) {
+        if (*ci > result) {
+            result = *ci;
+        }
+   }
+   return result;
+}
+
+/// @brief distance between adjacent CFs of a plane with the given support
+/// @param[in] support support size
+/// @return number of elements (a multiple of the alignment)
+size_t ConvFuncStore::cfStride(const int support)
+{
+   const size_t cSize = size_t(2 * support + 1);
+   const size_t elementsPerBlock = cfAlignment / sizeof(casa::Complex);
+   return (cSize * cSize + elementsPerBlock - 1) / elementsPerBlock * elementsPerBlock;
+}
+
+/// @brief allocate CFs for the given plane
+/// @details All overSample^2 CFs of the plane are sized for the given support and
+/// set to zero. The block is reused if the plane is already allocated with the same support.
+/// @param[in] plane plane (before oversampling)
+/// @param[in] support support of the CFs (the size is 2*support+1)
+void ConvFuncStore::allocate(const casa::uInt plane, const int support)
+{
+   ASKAPCHECK(plane < nPlanes(), "Plane "<<plane<<" is outside the CF store with "<<nPlanes()<<" planes");
+   ASKAPCHECK(support >= 0, "Support should be non-negative, you have "<<support);
+   const size_t blockSize = cfStride(support) * size_t(itsOverSample * itsOverSample);
+   if (itsSupport[plane] != support) {
+       // the old block (if any) becomes a hole
+       itsSupport[plane] = -1;
+       const size_t capacity = itsBuffer ? itsBuffer->itsSize : 0;
+       if (itsUsed + blockSize > capacity) {
+           // the new buffer has some spare space to make appending of planes one by one cheap
+           const size_t required = memoryUsed() / sizeof(casa::Complex) + blockSize;
+           relocate(required + required / 2);
+       }
+       makeUnique();
+       itsStart[plane] = itsUsed;
+       itsCFStride[plane] = cfStride(support);
+       itsSupport[plane] = support;
+       itsUsed += blockSize;
+   } else {
+       makeUnique();
+   }
+   casa::Complex *start = itsBuffer->itsData + itsStart[plane];
+   std::fill(start, start + blockSize, casa::Complex(0.));
+}
+
+/// @brief release CFs for the given plane
+/// @details The memory is returned on the next compaction
+/// @param[in] plane plane (before oversampling)
+void ConvFuncStore::release(const casa::uInt plane)
+{
+   ASKAPCHECK(plane < nPlanes(), "Plane "<<plane<<" is outside the CF store with "<<nPlanes()<<" planes");
+   itsSupport[plane] = -1;
+}
+
+/// @brief compact the buffer
+/// @details Holes left by released or reallocated planes are removed and the buffer
+/// is shrunk to the size taken by the allocated planes.
+void ConvFuncStore::compact()
+{
+   relocate(memoryUsed() / sizeof(casa::Complex));
+}
+
+/// @brief move allocated planes into a new buffer
+/// @details The planes are placed one after another without holes
+/// @param[in] capacity size of the new buffer (in elements)
+void ConvFuncStore::relocate(const size_t capacity)
+{
+   if (capacity == 0) {
+       itsBuffer.reset();
+       itsUsed = 0;
+       return;
+   }
+   boost::shared_ptr<Buffer> newBuffer(new Buffer(capacity));
+   const size_t nOS = size_t(itsOverSample * itsOverSample);
+   size_t used = 0;
+   for (casa::uInt plane = 0; plane < nPlanes(); ++plane) {
+        if (isDefined(plane)) {
+            const size_t blockSize = itsCFStride[plane] * nOS;
+            ASKAPDEBUGASSERT(used + blockSize <= capacity);
+            const casa::Complex *start = itsBuffer->itsData + itsStart[plane];
+            std::copy(start, start + blockSize, newBuffer->itsData + used);
+            itsStart[plane] = used;
+            used += blockSize;
+        }
+   }
+   itsBuffer = newBuffer;
+   itsUsed = used;
+}
+
+/// @brief make sure the buffer is not shared with other copies
+void ConvFuncStore::makeUnique()
+{
+   if (itsBuffer && !itsBuffer.unique()) {
+       relocate(itsBuffer->itsSize);
+   }
+}
+
+/// @brief memory taken by the given plane
+/// @param[in] plane plane (before oversampling)
+/// @return size in bytes (zero if the plane is not allocated)
+size_t ConvFuncStore::memoryUsed(const casa::uInt plane) const
+{
+   return isDefined(plane) ? itsCFStride[plane] * size_t(itsOverSample * itsOverSample) * sizeof(casa::Complex) : 0;
+}
+
+/// @brief memory taken by all allocated planes
+/// @return size in bytes (excluding holes and spare capacity of the buffer)
+size_t ConvFuncStore::memoryUsed() const
+{
+   size_t result = 0;
+   for (casa::uInt plane = 0; plane < nPlanes(); ++plane) {
+        result += memoryUsed(plane);
+   }
+   return result;
+}
+
+/// @brief matrix referencing the CF
+/// @details The matrix shares the storage with the store, so the CF can be filled
+/// through it. The storage is detached from other copies of the store first.
+/// @param[in] index flat index fracu + overSample*(fracv + overSample*plane)
+/// @return matrix sharing the storage (empty matrix if the plane is not allocated)
+casa::Matrix<casa::Complex> ConvFuncStore::matrix(const size_t index)
+{
+   ASKAPDEBUGASSERT(index < size());
+   const int nOS = itsOverSample * itsOverSample;
+   const casa::uInt plane = casa::uInt(index / nOS);
+   if (!isDefined(plane)) {
+       return casa::Matrix<casa::Complex>();
+   }
+   makeUnique();
+   const casa::uInt cSize = casa::uInt(2 * support(plane) + 1);
+   return casa::Matrix<casa::Complex>(casa::IPosition(2, cSize, cSize),
+          itsBuffer->itsData + itsStart[plane] + (index % nOS) * itsCFStride[plane], casa::SHARE);
+}
+
+/// @brief copy of the CF
+/// @param[in] index flat index fracu + overSample*(fracv + overSample*plane)
+/// @return a copy of the CF (empty matrix if the plane is not allocated)
+casa::Matrix<casa::Complex> ConvFuncStore::copyOf(const size_t index) const
+{
+   ASKAPDEBUGASSERT(index < size());
+   const int nOS = itsOverSample * itsOverSample;
+   const casa::uInt plane = casa::uInt(index / nOS);
+   if (!isDefined(plane)) {
+       return casa::Matrix<casa::Complex>();
+   }
+   const casa::uInt cSize = casa::uInt(2 * support(plane) + 1);
+   casa::Matrix<casa::Complex> result(cSize, cSize);
+   const casa::Complex *cf = data(plane, int(index % nOS));
+   std::copy(cf, cf + cSize * cSize, result.data());
+   return result;
+}
+
+/// @brief initialise offsets for a given number of planes
+/// @details The table of offsets is resized and filled with (0,0).
+/// @param[in] nPlanes number of planes
+void ConvFuncStore::initOffsets(const size_t nPlanes)
+{
+   itsOffsets.assign(nPlanes, std::pair<int,int>(0,0));
+}
+
+/// @brief assign offset to the given plane
+/// @param[in] plane plane (before oversampling)
+/// @param[in] u offset in the first coordinate
+/// @param[in] v offset in the second coordinate
+void ConvFuncStore::setOffset(const casa::uInt plane, const int u, const int v)
+{
+   ASKAPCHECK(plane < itsOffsets.size(), "An attempt to set offset for plane (before oversampling) "<<
+              plane<<" while the buffer has been initialised to handle "<<itsOffsets.size()<<" planes only");
+   itsOffsets[plane] = std::pair<int,int>(u,v);
+}
+
+} // namespace synthesis
+
+} // namespace askap
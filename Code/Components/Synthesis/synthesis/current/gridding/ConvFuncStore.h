@@ -0,0 +1,235 @@
+/// @file
+/// @brief Contiguous storage of oversampled convolution functions
+/// @details Gridders used to keep convolution functions as a vector of casa matrices,
+/// one per plane and oversampling offset. Each of them is a separate heap allocation
+/// with its own reference counting, and the whole cache had to be deep copied every
+/// time a gridder was cloned. This class keeps all convolution functions in a single
+/// aligned buffer and hands out raw pointers to the gridding kernels.
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author agent <agent@local>
+
+#ifndef ASKAP_SYNTHESIS_CONV_FUNC_STORE_H
+#define ASKAP_SYNTHESIS_CONV_FUNC_STORE_H
+
+// casa includes
+#include <casa/BasicSL/Complex.h>
+#include <casa/Arrays/Matrix.h>
+
+// boost includes
+#include <boost/shared_ptr.hpp>
+#include <boost/noncopyable.hpp>
+
+// own includes
+#include <askap/AskapError.h>
+
+// std includes
+#include <vector>
+#include <utility>
+
+namespace askap {
+
+namespace synthesis {
+
+/// @brief Contiguous storage of oversampled convolution functions
+/// @details The store holds convolution functions (CFs) for a number of planes (e.g.
+/// w-planes, feeds, fields or channels, depending on the gridder). Each plane has
+/// overSample*overSample CFs (one per fractional offset in u and v) of the same support,
+/// so the CF for the given plane and offsets fracu, fracv is (2*support+1) x (2*support+1)
+/// pixels stored column-major (u varies fastest). CFs of a plane are kept in one block
+/// ordered by fracv and then fracu, i.e. the flat index fracu + overSample*(fracv + overSample*plane)
+/// used throughout the gridders corresponds to the order of CFs in the buffer. Every CF starts
+/// at a 64-byte boundary. Support and offset of each plane are stored in separate tables.
+///
+/// Planes can be allocated in any order and with different supports. New planes are appended
+/// to the buffer (which grows geometrically), released planes leave a hole until the buffer
+/// is compacted. Copies of the store share the buffer until one of them is modified (copy-on-write),
+/// so copying gridders is cheap. Raw pointers and matrices referencing the storage
+/// (see matrix) are invalidated by any call which allocates or releases a plane.
+/// @ingroup gridding
+class ConvFuncStore {
+public:
+   /// @brief construct an empty store
+   ConvFuncStore();
+
+   /// @brief initialise the store
+   /// @details All planes and offsets are dropped, no plane is allocated after this call.
+   /// @param[in] nPlanes number of planes (before oversampling)
+   /// @param[in] overSample oversampling factor
+   void init(const casa::uInt nPlanes, const int overSample);
+
+   /// @brief number of planes (before oversampling)
+   inline casa::uInt nPlanes() const { return casa::uInt(itsSupport.size()); }
+
+   /// @brief oversampling factor
+   inline int overSample() const { return itsOverSample; }
+
+   /// @brief total number of CFs (including oversampling)
+   /// @return nPlanes()*overSample()^2, the range of the flat index
+   inline size_t size() const { return itsSupport.size() * size_t(itsOverSample * itsOverSample); }
+
+   /// @brief check whether the plane is allocated
+   /// @param[in] plane plane (before oversampling)
+   /// @return true if CFs for this plane have been allocated
+   inline bool isDefined(const casa::uInt plane) const { return support(plane) >= 0; }
+
+   /// @brief support of the plane
+   /// @param[in] plane plane (before oversampling)
+   /// @return support (negative if the plane is not allocated)
+   inline int support(const casa::uInt plane) const
+   { ASKAPDEBUGASSERT(plane < itsSupport.size()); return itsSupport[plane]; }
+
+   /// @brief largest support across all allocated planes
+   /// @return maximum support (zero if nothing is allocated)
+   int maxSupport() const;
+
+   /// @brief allocate CFs for the given plane
+   /// @details All overSample^2 CFs of the plane are sized for the given support and
+   /// set to zero. The block is reused if the plane is already allocated with the same support.
+   /// @param[in] plane plane (before oversampling)
+   /// @param[in] support support of the CFs (the size is 2*support+1)
+   void allocate(const casa::uInt plane, const int support);
+
+   /// @brief release CFs for the given plane
+   /// @details The memory is returned on the next compaction
+   /// @param[in] plane plane (before oversampling)
+   void release(const casa::uInt plane);
+
+   /// @brief compact the buffer
+   /// @details Holes left by released or reallocated planes are removed and the buffer
+   /// is shrunk to the size taken by the allocated planes.
+   void compact();
+
+   /// @brief memory taken by the given plane
+   /// @param[in] plane plane (before oversampling)
+   /// @return size in bytes (zero if the plane is not allocated)
+   size_t memoryUsed(const casa::uInt plane) const;
+
+   /// @brief memory taken by all allocated planes
+   /// @return size in bytes (excluding holes and spare capacity of the buffer)
+   size_t memoryUsed() const;
+
+   /// @brief read-only access to the CF
+   /// @details This method is intended for the gridding kernels, the CF has
+   /// 2*support(plane)+1 pixels per row.
+   /// @param[in] plane plane (before oversampling)
+   /// @param[in] overSampleOffset fractional offset given as fracu + overSample*fracv
+   /// @return pointer to the first pixel of the CF
+   inline const casa::Complex* data(const casa::uInt plane, const int overSampleOffset) const
+   {
+      ASKAPDEBUGASSERT(isDefined(plane));
+      ASKAPDEBUGASSERT((overSampleOffset >= 0) && (overSampleOffset < itsOverSample * itsOverSample));
+      return itsBuffer->itsData + itsStart[plane] + size_t(overSampleOffset) * itsCFStride[plane];
+   }
+
+   /// @brief matrix referencing the CF
+   /// @details The matrix shares the storage with the store, so the CF can be filled
+   /// through it. The storage is detached from other copies of the store first.
+   /// @param[in] index flat index fracu + overSample*(fracv + overSample*plane)
+   /// @return matrix sharing the storage (empty matrix if the plane is not allocated)
+   casa::Matrix<casa::Complex> matrix(const size_t index);
+
+   /// @brief copy of the CF
+   /// @param[in] index flat index fracu + overSample*(fracv + overSample*plane)
+   /// @return a copy of the CF (empty matrix if the plane is not allocated)
+   casa::Matrix<casa::Complex> copyOf(const size_t index) const;
+
+   /// @brief offset of the given plane
+   /// @details See TableVisGridder::getConvFuncOffset for the meaning of the offset.
+   /// @param[in] plane plane (before oversampling)
+   /// @return a pair with offsets for each axis ((0,0) if no offset is defined for the plane)
+   inline std::pair<int,int> offset(const casa::uInt plane) const
+   { return plane < itsOffsets.size() ? itsOffsets[plane] : std::pair<int,int>(0,0); }
+
+   /// @brief initialise offsets for a given number of planes
+   /// @details The table of offsets is resized and filled with (0,0).
+   /// @param[in] nPlanes number of planes
+   void initOffsets(const size_t nPlanes);
+
+   /// @brief assign offset to the given plane
+   /// @param[in] plane plane (before oversampling)
+   /// @param[in] u offset in the first coordinate
+   /// @param[in] v offset in the second coordinate
+   void setOffset(const casa::uInt plane, const int u, const int v);
+
+   /// @brief number of offsets defined
+   inline size_t nOffsets() const { return itsOffsets.size(); }
+
+private:
+   /// @brief aligned buffer with the CFs
+   struct Buffer : private boost::noncopyable {
+      /// @brief allocate the buffer
+      /// @param[in] size number of elements
+      explicit Buffer(const size_t size);
+
+      /// @brief release the memory
+      ~Buffer();
+
+      /// @brief pointer to the first element
+      casa::Complex *itsData;
+
+      /// @brief number of elements allocated
+      size_t itsSize;
+   };
+
+   /// @brief distance between adjacent CFs of a plane with the given support
+   /// @param[in] support support size
+   /// @return number of elements (a multiple of the alignment)
+   static size_t cfStride(const int support);
+
+   /// @brief move allocated planes into a new buffer
+   /// @details The planes are placed one after another without holes
+   /// @param[in] capacity size of the new buffer (in elements)
+   void relocate(const size_t capacity);
+
+   /// @brief make sure the buffer is not shared with other copies
+   void makeUnique();
+
+   /// @brief buffer shared between copies until modified
+   boost::shared_ptr<Buffer> itsBuffer;
+
+   /// @brief number of elements used at the beginning of the buffer (including holes)
+   size_t itsUsed;
+
+   /// @brief oversampling factor
+   int itsOverSample;
+
+   /// @brief support of each plane (negative if not allocated)
+   std::vector<int> itsSupport;
+
+   /// @brief offset of the first CF of each plane in the buffer (in elements)
+   std::vector<size_t> itsStart;
+
+   /// @brief distance between adjacent CFs of each plane (in elements)
+   std::vector<size_t> itsCFStride;
+
+   /// @brief offsets of the CFs for each plane
+   std::vector<std::pair<int,int> > itsOffsets;
+};
+
+} // namespace synthesis
+
+} // namespace askap
+
+#endif // #ifndef ASKAP_SYNTHESIS_CONV_FUNC_STORE_H
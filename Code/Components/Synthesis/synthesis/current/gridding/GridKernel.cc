@@ -24,108 +24,479 @@
 // Include own header file first
 #include "GridKernel.h"
 
-/// Use pointers instead of casa::Matrix operators to grid
-//#define ASKAP_GRID_WITH_POINTERS 1
+// ASKAPsoft includes
+#include <askap/AskapError.h>
 
-/// Use BLAS 
-//#define ASKAP_GRID_WITH_BLAS 1
-
-#ifdef ASKAP_GRID_WITH_BLAS
-#ifdef __APPLE_CC__
-#include <vecLib/cblas.h>
-#else
-#include <cblas.h>
+/// x86 vector kernels are compiled with function-level target attributes, so the
+/// library itself does not need to be built with -mavx2, etc. The actual kernel is
+/// chosen at run time depending on the CPU capabilities.
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__) && \
+    (defined(__clang__) || (__GNUC__ > 4) || ((__GNUC__ == 4) && (__GNUC_MINOR__ >= 9)))
+#define ASKAP_GRID_KERNEL_X86 1
+#include <immintrin.h>
+#if (defined(__clang__) && (__clang_major__ >= 5)) || (!defined(__clang__) && (__GNUC__ >= 7))
+#define ASKAP_GRID_KERNEL_AVX512 1
 #endif
 #endif
 
 namespace askap {
 namespace synthesis {
 
-std::string GridKernel::info() {
-#ifdef ASKAP_GRID_WITH_BLAS
-	return std::string("Gridding with BLAS");
-#else 
-#ifdef ASKAP_GRID_WITH_POINTERS
-	return std::string("Gridding with casa::Matrix pointers");
-#else
-	return std::string("Standard gridding/degridding with casa::Matrix");
-#endif
-#endif
+namespace {
+
+/// @brief gridding function for a whole patch
+typedef void (*GridFunc)(casa::Complex *, const int, const casa::Complex *, const int,
+                         const casa::Complex &, const int);
+
+/// @brief degridding function for a whole patch
+typedef casa::Complex (*DegridFunc)(const casa::Complex *, const int, const casa::Complex *,
+                                    const int, const int);
+
+/// @brief number of kernel versions per instruction set
+/// @details Element 0 is the version for an arbitrary support, the remaining elements
+/// are specialised for the supports handled in specialisationIndex.
+const int theNVersions = 10;
+
+/// @brief index of the kernel version specialised for the given support
+/// @param[in] support support of the convolution function
+/// @return index into KernelSet arrays (0 means no specialisation is available)
+inline int specialisationIndex(const int support)
+{
+  switch (support) {
+     case 3: return 1;
+     case 4: return 2;
+     case 5: return 3;
+     case 6: return 4;
+     case 7: return 5;
+     case 8: return 6;
+     case 10: return 7;
+     case 12: return 8;
+     case 16: return 9;
+     default: return 0;
+  }
+}
+
+} // anonymous namespace
+
+/// @brief family of kernels for one instruction set
+struct GridKernel::KernelSet {
+   /// @brief name reported by GridKernel::info and accepted by the constructor
+   const char *name;
+   /// @brief gridding functions (see specialisationIndex)
+   GridFunc grid[theNVersions];
+   /// @brief degridding functions (see specialisationIndex)
+   DegridFunc degrid[theNVersions];
+};
+
+namespace {
+
+/// @brief family of kernels for one instruction set
+typedef GridKernel::KernelSet KernelSet;
+
+/// @brief original element loop kept for verification purposes
+/// @details This is the loop which used to work with casa::Matrix, expressed with explicit
+/// strides. It is never specialised for particular supports (the template parameter is ignored).
+struct ReferenceKernel {
+   template<int Support>
+   static void grid(casa::Complex *grid, const int gridStride, const casa::Complex *convFunc,
+                    const int cfStride, const casa::Complex &cVis, const int support)
+   {
+      for (int suppv = -support; suppv < +support; ++suppv) {
+           const int voff = suppv + support;
+           for (int suppu = -support; suppu < +support; ++suppu) {
+                const int uoff = suppu + support;
+                const casa::Complex wt = convFunc[uoff + voff * cfStride];
+                grid[uoff + voff * gridStride] += cVis * wt;
+           }
+      }
+   }
+
+   template<int Support>
+   static casa::Complex degrid(const casa::Complex *grid, const int gridStride,
+                               const casa::Complex *convFunc, const int cfStride, const int support)
+   {
+      casa::Complex cVis(0., 0.);
+      for (int suppv = -support; suppv < +support; ++suppv) {
+           const int voff = suppv + support;
+           for (int suppu = -support; suppu < +support; ++suppu) {
+                const int uoff = suppu + support;
+                const casa::Complex wt = convFunc[uoff + voff * cfStride];
+                cVis += wt * conj(grid[uoff + voff * gridStride]);
+           }
+      }
+      return cVis;
+   }
+};
+
+/// @brief portable scalar kernels
+/// @details This is what used to be compiled in with ASKAP_GRID_WITH_POINTERS. It is used
+/// as a fallback if no vector instructions are available. The template parameter is
+/// the support size (0 means the run-time value is used).
+struct GenericKernel {
+   template<int Support>
+   static void grid(casa::Complex *grid, const int gridStride, const casa::Complex *convFunc,
+                    const int cfStride, const casa::Complex &cVis, const int support)
+   {
+      const int width = 2 * (Support > 0 ? Support : support);
+      for (int row = 0; row < width; ++row, grid += gridStride, convFunc += cfStride) {
+           for (int i = 0; i < width; ++i) {
+                grid[i] += cVis * convFunc[i];
+           }
+      }
+   }
+
+   template<int Support>
+   static casa::Complex degrid(const casa::Complex *grid, const int gridStride,
+                               const casa::Complex *convFunc, const int cfStride, const int support)
+   {
+      const int width = 2 * (Support > 0 ? Support : support);
+      casa::Complex cVis(0., 0.);
+      for (int row = 0; row < width; ++row, grid += gridStride, convFunc += cfStride) {
+           for (int i = 0; i < width; ++i) {
+                cVis += convFunc[i] * conj(grid[i]);
+           }
+      }
+      return cVis;
+   }
+};
+
+#ifdef ASKAP_GRID_KERNEL_X86
+
+/// @brief SSE2 kernels (2 complex values per register)
+/// @details Complex multiplication v*c is done as re(v)*c + im(v)*swap(c) with
+/// alternating signs in the second term. As the patch width is always even, no
+/// scalar tail is required.
+struct SSE2Kernel {
+   template<int Support>
+   static __attribute__((target("sse2")))
+   void grid(casa::Complex *grid, const int gridStride, const casa::Complex *convFunc,
+             const int cfStride, const casa::Complex &cVis, const int support)
+   {
+      const int width = 2 * (Support > 0 ? Support : support);
+      const __m128 visRe = _mm_set1_ps(real(cVis));
+      const __m128 visIm = _mm_setr_ps(-imag(cVis), imag(cVis), -imag(cVis), imag(cVis));
+      for (int row = 0; row < width; ++row, grid += gridStride, convFunc += cfStride) {
+           float *gPtr = reinterpret_cast<float*>(grid);
+           const float *cPtr = reinterpret_cast<const float*>(convFunc);
+           for (int i = 0; i < 2 * width; i += 4) {
+                const __m128 cf = _mm_loadu_ps(cPtr + i);
+                const __m128 cfSwapped = _mm_shuffle_ps(cf, cf, _MM_SHUFFLE(2, 3, 0, 1));
+                const __m128 prod = _mm_add_ps(_mm_mul_ps(visRe, cf), _mm_mul_ps(visIm, cfSwapped));
+                _mm_storeu_ps(gPtr + i, _mm_add_ps(_mm_loadu_ps(gPtr + i), prod));
+           }
+      }
+   }
+
+   template<int Support>
+   static __attribute__((target("sse2")))
+   casa::Complex degrid(const casa::Complex *grid, const int gridStride,
+                        const casa::Complex *convFunc, const int cfStride, const int support)
+   {
+      const int width = 2 * (Support > 0 ? Support : support);
+      // accumulates re(c)*re(g) and im(c)*im(g)
+      __m128 sumRe = _mm_setzero_ps();
+      // accumulates re(c)*im(g) and im(c)*re(g)
+      __m128 sumIm = _mm_setzero_ps();
+      for (int row = 0; row < width; ++row, grid += gridStride, convFunc += cfStride) {
+           const float *gPtr = reinterpret_cast<const float*>(grid);
+           const float *cPtr = reinterpret_cast<const float*>(convFunc);
+           for (int i = 0; i < 2 * width; i += 4) {
+                const __m128 cf = _mm_loadu_ps(cPtr + i);
+                const __m128 gr = _mm_loadu_ps(gPtr + i);
+                const __m128 grSwapped = _mm_shuffle_ps(gr, gr, _MM_SHUFFLE(2, 3, 0, 1));
+                sumRe = _mm_add_ps(sumRe, _mm_mul_ps(cf, gr));
+                sumIm = _mm_add_ps(sumIm, _mm_mul_ps(cf, grSwapped));
+           }
+      }
+      float re[4], im[4];
+      _mm_storeu_ps(re, sumRe);
+      _mm_storeu_ps(im, sumIm);
+      // c * conj(g) = (re(c)re(g) + im(c)im(g), im(c)re(g) - re(c)im(g))
+      return casa::Complex(re[0] + re[1] + re[2] + re[3], im[1] - im[0] + im[3] - im[2]);
+   }
+};
+
+/// @brief AVX2+FMA kernels (4 complex values per register)
+/// @details Odd supports leave a remainder of 2 complex values per row, which is
+/// handled with 128-bit operations.
+struct AVX2Kernel {
+   template<int Support>
+   static __attribute__((target("avx2,fma")))
+   void grid(casa::Complex *grid, const int gridStride, const casa::Complex *convFunc,
+             const int cfStride, const casa::Complex &cVis, const int support)
+   {
+      const int width = 2 * (Support > 0 ? Support : support);
+      const float re = real(cVis);
+      const float im = imag(cVis);
+      const __m256 visRe = _mm256_set1_ps(re);
+      const __m256 visIm = _mm256_setr_ps(-im, im, -im, im, -im, im, -im, im);
+      for (int row = 0; row < width; ++row, grid += gridStride, convFunc += cfStride) {
+           float *gPtr = reinterpret_cast<float*>(grid);
+           const float *cPtr = reinterpret_cast<const float*>(convFunc);
+           int i = 0;
+           for (; i + 8 <= 2 * width; i += 8) {
+                const __m256 cf = _mm256_loadu_ps(cPtr + i);
+                const __m256 cfSwapped = _mm256_permute_ps(cf, 0xB1);
+                __m256 gr = _mm256_loadu_ps(gPtr + i);
+                gr = _mm256_fmadd_ps(visRe, cf, gr);
+                gr = _mm256_fmadd_ps(visIm, cfSwapped, gr);
+                _mm256_storeu_ps(gPtr + i, gr);
+           }
+           if (i < 2 * width) {
+               const __m128 cf = _mm_loadu_ps(cPtr + i);
+               const __m128 cfSwapped = _mm_permute_ps(cf, 0xB1);
+               __m128 gr = _mm_loadu_ps(gPtr + i);
+               gr = _mm_fmadd_ps(_mm256_castps256_ps128(visRe), cf, gr);
+               gr = _mm_fmadd_ps(_mm256_castps256_ps128(visIm), cfSwapped, gr);
+               _mm_storeu_ps(gPtr + i, gr);
+           }
+      }
+   }
+
+   template<int Support>
+   static __attribute__((target("avx2,fma")))
+   casa::Complex degrid(const casa::Complex *grid, const int gridStride,
+                        const casa::Complex *convFunc, const int cfStride, const int support)
+   {
+      const int width = 2 * (Support > 0 ? Support : support);
+      __m256 sumRe = _mm256_setzero_ps();
+      __m256 sumIm = _mm256_setzero_ps();
+      __m128 tailRe = _mm_setzero_ps();
+      __m128 tailIm = _mm_setzero_ps();
+      for (int row = 0; row < width; ++row, grid += gridStride, convFunc += cfStride) {
+           const float *gPtr = reinterpret_cast<const float*>(grid);
+           const float *cPtr = reinterpret_cast<const float*>(convFunc);
+           int i = 0;
+           for (; i + 8 <= 2 * width; i += 8) {
+                const __m256 cf = _mm256_loadu_ps(cPtr + i);
+                const __m256 gr = _mm256_loadu_ps(gPtr + i);
+                sumRe = _mm256_fmadd_ps(cf, gr, sumRe);
+                sumIm = _mm256_fmadd_ps(cf, _mm256_permute_ps(gr, 0xB1), sumIm);
+           }
+           if (i < 2 * width) {
+               const __m128 cf = _mm_loadu_ps(cPtr + i);
+               const __m128 gr = _mm_loadu_ps(gPtr + i);
+               tailRe = _mm_fmadd_ps(cf, gr, tailRe);
+               tailIm = _mm_fmadd_ps(cf, _mm_permute_ps(gr, 0xB1), tailIm);
+           }
+      }
+      float re[8], im[8], tRe[4], tIm[4];
+      _mm256_storeu_ps(re, sumRe);
+      _mm256_storeu_ps(im, sumIm);
+      _mm_storeu_ps(tRe, tailRe);
+      _mm_storeu_ps(tIm, tailIm);
+      float resRe = tRe[0] + tRe[1] + tRe[2] + tRe[3];
+      float resIm = tIm[1] - tIm[0] + tIm[3] - tIm[2];
+      for (int k = 0; k < 8; k += 2) {
+           resRe += re[k] + re[k + 1];
+           resIm += im[k + 1] - im[k];
+      }
+      return casa::Complex(resRe, resIm);
+   }
+};
+
+#ifdef ASKAP_GRID_KERNEL_AVX512
+
+/// @brief AVX-512 kernels (8 complex values per register)
+/// @details The remainder of each row is handled with masked loads and stores.
+struct AVX512Kernel {
+   template<int Support>
+   static __attribute__((target("avx512f")))
+   void grid(casa::Complex *grid, const int gridStride, const casa::Complex *convFunc,
+             const int cfStride, const casa::Complex &cVis, const int support)
+   {
+      const int width = 2 * (Support > 0 ? Support : support);
+      const float re = real(cVis);
+      const float im = imag(cVis);
+      const __m512 visRe = _mm512_set1_ps(re);
+      const __m512 visIm = _mm512_setr_ps(-im, im, -im, im, -im, im, -im, im,
+                                          -im, im, -im, im, -im, im, -im, im);
+      const int nFull = (2 * width) / 16 * 16;
+      const __mmask16 tailMask = static_cast<__mmask16>((1u << (2 * width - nFull)) - 1u);
+      for (int row = 0; row < width; ++row, grid += gridStride, convFunc += cfStride) {
+           float *gPtr = reinterpret_cast<float*>(grid);
+           const float *cPtr = reinterpret_cast<const float*>(convFunc);
+           for (int i = 0; i < nFull; i += 16) {
+                const __m512 cf = _mm512_loadu_ps(cPtr + i);
+                __m512 gr = _mm512_loadu_ps(gPtr + i);
+                gr = _mm512_fmadd_ps(visRe, cf, gr);
+                gr = _mm512_fmadd_ps(visIm, _mm512_shuffle_ps(cf, cf, 0xB1), gr);
+                _mm512_storeu_ps(gPtr + i, gr);
+           }
+           if (tailMask) {
+               const __m512 cf = _mm512_maskz_loadu_ps(tailMask, cPtr + nFull);
+               __m512 gr = _mm512_maskz_loadu_ps(tailMask, gPtr + nFull);
+               gr = _mm512_fmadd_ps(visRe, cf, gr);
+               gr = _mm512_fmadd_ps(visIm, _mm512_shuffle_ps(cf, cf, 0xB1), gr);
+               _mm512_mask_storeu_ps(gPtr + nFull, tailMask, gr);
+           }
+      }
+   }
+
+   template<int Support>
+   static __attribute__((target("avx512f")))
+   casa::Complex degrid(const casa::Complex *grid, const int gridStride,
+                        const casa::Complex *convFunc, const int cfStride, const int support)
+   {
+      const int width = 2 * (Support > 0 ? Support : support);
+      const int nFull = (2 * width) / 16 * 16;
+      const __mmask16 tailMask = static_cast<__mmask16>((1u << (2 * width - nFull)) - 1u);
+      __m512 sumRe = _mm512_setzero_ps();
+      __m512 sumIm = _mm512_setzero_ps();
+      for (int row = 0; row < width; ++row, grid += gridStride, convFunc += cfStride) {
+           const float *gPtr = reinterpret_cast<const float*>(grid);
+           const float *cPtr = reinterpret_cast<const float*>(convFunc);
+           for (int i = 0; i < nFull; i += 16) {
+                const __m512 cf = _mm512_loadu_ps(cPtr + i);
+                const __m512 gr = _mm512_loadu_ps(gPtr + i);
+                sumRe = _mm512_fmadd_ps(cf, gr, sumRe);
+                sumIm = _mm512_fmadd_ps(cf, _mm512_shuffle_ps(gr, gr, 0xB1), sumIm);
+           }
+           if (tailMask) {
+               const __m512 cf = _mm512_maskz_loadu_ps(tailMask, cPtr + nFull);
+               const __m512 gr = _mm512_maskz_loadu_ps(tailMask, gPtr + nFull);
+               sumRe = _mm512_fmadd_ps(cf, gr, sumRe);
+               sumIm = _mm512_fmadd_ps(cf, _mm512_shuffle_ps(gr, gr, 0xB1), sumIm);
+           }
+      }
+      const __m512 sign = _mm512_setr_ps(-1., 1., -1., 1., -1., 1., -1., 1.,
+                                         -1., 1., -1., 1., -1., 1., -1., 1.);
+      return casa::Complex(_mm512_reduce_add_ps(sumRe),
+                           _mm512_reduce_add_ps(_mm512_mul_ps(sumIm, sign)));
+   }
+};
+
+#endif // ASKAP_GRID_KERNEL_AVX512
+
+#endif // ASKAP_GRID_KERNEL_X86
+
+/// @brief build the table of kernels for the given instruction set
+/// @param[in] name name of the kernel family
+/// @return filled KernelSet structure
+template<typename K>
+KernelSet makeKernelSet(const char *name)
+{
+   const KernelSet result = { name,
+       { &K::template grid<0>, &K::template grid<3>, &K::template grid<4>, &K::template grid<5>,
+         &K::template grid<6>, &K::template grid<7>, &K::template grid<8>, &K::template grid<10>,
+         &K::template grid<12>, &K::template grid<16> },
+       { &K::template degrid<0>, &K::template degrid<3>, &K::template degrid<4>, &K::template degrid<5>,
+         &K::template degrid<6>, &K::template degrid<7>, &K::template degrid<8>, &K::template degrid<10>,
+         &K::template degrid<12>, &K::template degrid<16> } };
+   return result;
+}
+
+/// @brief build the list of kernels supported by this CPU and build
+/// @details The kernels are ordered by preference, the last one is the fastest.
+/// The reference kernel is always the first one.
+/// @return vector with the kernel families
+std::vector<KernelSet> makeSupportedKernels()
+{
+   std::vector<KernelSet> kernels;
+   kernels.push_back(makeKernelSet<ReferenceKernel>("reference"));
+   kernels.push_back(makeKernelSet<GenericKernel>("generic"));
+   #ifdef ASKAP_GRID_KERNEL_X86
+   __builtin_cpu_init();
+   if (__builtin_cpu_supports("sse2")) {
+       kernels.push_back(makeKernelSet<SSE2Kernel>("sse2"));
+   }
+   if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+       kernels.push_back(makeKernelSet<AVX2Kernel>("avx2"));
+   }
+   #ifdef ASKAP_GRID_KERNEL_AVX512
+   if (__builtin_cpu_supports("avx512f")) {
+       kernels.push_back(makeKernelSet<AVX512Kernel>("avx512"));
+   }
+   #endif
+   #endif
+   return kernels;
+}
+
+/// @brief all kernels supported by this CPU and build
+/// @details The list is built on the first call and never changes afterwards, so it can be
+/// accessed from any thread.
+/// @return vector with the kernel families
+const std::vector<KernelSet>& supportedKernels()
+{
+   static const std::vector<KernelSet> kernels = makeSupportedKernels();
+   return kernels;
+}
+
+} // anonymous namespace
+
+/// @brief construct the kernel family with the given name
+GridKernel::GridKernel(const std::string &name) : itsKernel(NULL)
+{
+    const std::vector<KernelSet> &kernels = supportedKernels();
+    if (name == "auto") {
+        itsKernel = &kernels.back();
+        return;
+    }
+    for (std::vector<KernelSet>::const_iterator ci = kernels.begin(); ci != kernels.end(); ++ci) {
+         if (name == ci->name) {
+             itsKernel = &(*ci);
+             return;
+         }
+    }
+    ASKAPTHROW(AskapError, "Gridding kernel "<<name<<" is either unknown or not supported by this CPU");
+}
+
+std::string GridKernel::info() const {
+	return std::string("Gridding with ") + name() + " kernel";
+}
+
+/// @brief name of the kernel
+std::string GridKernel::name() const {
+    ASKAPDEBUGASSERT(itsKernel);
+    return std::string(itsKernel->name);
+}
+
+/// @brief kernels which can be used on this machine
+std::vector<std::string> GridKernel::availableKernels() {
+    std::vector<std::string> result;
+    const std::vector<KernelSet> &kernels = supportedKernels();
+    for (std::vector<KernelSet>::const_iterator ci = kernels.begin(); ci != kernels.end(); ++ci) {
+         result.push_back(ci->name);
+    }
+    return result;
 }
 
 /// Totally selfcontained gridding
 void GridKernel::grid(casa::Matrix<casa::Complex>& grid,
-		casa::Matrix<casa::Complex>& convFunc, const casa::Complex& cVis,
-		const int iu, const int iv, const int support) {
-
-#if defined ( ASKAP_GRID_WITH_POINTERS ) || defined ( ASKAP_GRID_WITH_BLAS )
-	for (int suppv = -support; suppv < +support; suppv++) {
-		const int voff = suppv + support;
-		const int uoff = -support + support;
-		casa::Complex *wtPtr = &convFunc(uoff, voff);
-		casa::Complex *gridPtr = &(grid(iu - support, iv + suppv));
-#ifdef ASKAP_GRID_WITH_BLAS
-		cblas_caxpy(2*support+1, &cVis, wtPtr, 1, gridPtr, 1);
-#else
-		for (int suppu = -support; suppu < +support; suppu++) {
-			(*gridPtr) += cVis * (*wtPtr);
-			wtPtr += 1;
-			gridPtr++;
-		}
-#endif
-	}
-#else
-	for (int suppv=-support; suppv<+support; suppv++)
-	{
-		const int voff=suppv+support;
-		for (int suppu=-support; suppu<+support; suppu++)
-		{
-			const int uoff=suppu+support;
-			casa::Complex wt=convFunc(uoff, voff);
-			grid(iu+suppu, iv+suppv)+=cVis*wt;
-		}
-	}
-#endif
+		const casa::Matrix<casa::Complex>& convFunc, const casa::Complex& cVis,
+		const int iu, const int iv, const int support) const {
+	casa::Complex *gridPtr = &grid(iu - support, iv - support);
+	const int gridStride = int(&grid(0, 1) - &grid(0, 0));
+	ASKAPDEBUGASSERT(&grid(1, 0) - &grid(0, 0) == 1);
+	this->grid(gridPtr, gridStride, convFunc.data(), int(convFunc.nrow()), cVis, support);
 }
 
 /// Totally selfcontained degridding
 void GridKernel::degrid(casa::Complex& cVis,
 		const casa::Matrix<casa::Complex>& convFunc,
 		const casa::Matrix<casa::Complex>& grid,
-        const int iu, const int iv, const int support) {
+        const int iu, const int iv, const int support) const {
 	/// Degridding from grid to visibility. Here we just take a weighted sum of the visibility
-	/// data using the convolution function as the weighting function. 
-	cVis = 0.0;
-#if defined ( ASKAP_GRID_WITH_POINTERS ) || defined ( ASKAP_GRID_WITH_BLAS )
-	for (int suppv = -support; suppv < +support; suppv++) {
-		const int voff = suppv + support;
-		const int uoff = -support + support;
-		const casa::Complex *wtPtr = &convFunc(uoff, voff);
-		const casa::Complex *gridPtr = &(grid(iu - support, iv + suppv));
-#ifdef ASKAP_GRID_WITH_BLAS
-		casa::Complex dot;
-		cblas_cdotc_sub(2*support+1, gridPtr, 1, wtPtr, 1, &dot);
-		cVis+=dot;
-#else
-		for (int suppu = -support; suppu < +support; suppu++) {
-			cVis += (*wtPtr) * conj(*gridPtr);
-			wtPtr += 1;
-			gridPtr++;
-		}
-#endif
-	}
-#else
-	for (int suppv=-support; suppv<+support; suppv++)
-	{
-		const int voff=suppv+support;
-		for (int suppu=-support; suppu<+support; suppu++)
-		{
-			const int uoff=suppu+support;
-			casa::Complex wt=convFunc(uoff, voff);
-			cVis+=wt*conj(grid(iu+suppu, iv+suppv));
-		}
-	}
-#endif
+	/// data using the convolution function as the weighting function.
+	const casa::Complex *gridPtr = &grid(iu - support, iv - support);
+	const int gridStride = int(&grid(0, 1) - &grid(0, 0));
+	ASKAPDEBUGASSERT(&grid(1, 0) - &grid(0, 0) == 1);
+	cVis = degrid(gridPtr, gridStride, convFunc.data(), int(convFunc.nrow()), support);
+}
+
+/// @brief gridding kernel working with raw pointers
+void GridKernel::grid(casa::Complex *grid, const int gridStride,
+        const casa::Complex *convFunc, const int cfStride,
+        const casa::Complex& cVis, const int support) const {
+	ASKAPDEBUGASSERT(itsKernel);
+	itsKernel->grid[specialisationIndex(support)](grid, gridStride, convFunc, cfStride, cVis, support);
+}
+
+/// @brief degridding kernel working with raw pointers
+casa::Complex GridKernel::degrid(const casa::Complex *grid, const int gridStride,
+        const casa::Complex *convFunc, const int cfStride, const int support) const {
+	ASKAPDEBUGASSERT(itsKernel);
+	return itsKernel->degrid[specialisationIndex(support)](grid, gridStride, convFunc, cfStride, support);
 }
 
 }
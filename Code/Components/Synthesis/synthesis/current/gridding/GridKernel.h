@@ -31,6 +31,7 @@
 
 // System includes
 #include <string>
+#include <vector>
 
 // ASKAPsoft includes
 #include <casa/aips.h>
@@ -40,26 +41,81 @@
 namespace askap {
     namespace synthesis {
         /// @brief Holder for gridding kernels
+        /// @details A family of kernels is available (a portable scalar fallback and
+        /// SSE2, AVX2 and AVX-512 versions on x86). The kernel is selected at run time
+        /// when this object is constructed: by default the fastest kernel supported by
+        /// the CPU is used, but another one can be requested by name (e.g. via
+        /// gridder.kernel in the parset). Each gridder holds its own instance, so gridders
+        /// configured differently can be used at the same time.
+        /// All kernels work with contiguous rows of the grid and the convolution function
+        /// and are specialised at compile time for the most common support sizes.
+        /// The original element loop is retained as the "reference" kernel
+        /// for verification purposes.
         ///
         /// @ingroup gridding
         class GridKernel {
             public:
+                /// @brief family of kernels for one instruction set
+                /// @details This is an implementation detail defined in GridKernel.cc
+                struct KernelSet;
+
+                /// @brief construct the kernel family with the given name
+                /// @details Allowed names are "auto" (the fastest kernel supported
+                /// by this CPU), "reference", "generic", "sse2", "avx2" and "avx512".
+                /// An exception is thrown if the requested kernel is unknown or not
+                /// supported by this CPU or build.
+                /// @param[in] name name of the kernel to use
+                explicit GridKernel(const std::string &name = "auto");
+
                 /// Information about gridding options
-                static std::string info();
+                std::string info() const;
+
+                /// @brief name of the kernel
+                /// @return name of the kernel used by grid and degrid
+                std::string name() const;
+
+                /// @brief kernels which can be used on this machine
+                /// @details This method is largely intended for benchmarking and testing.
+                /// @return names of all kernels supported by this CPU and build
+                static std::vector<std::string> availableKernels();
 
                 /// Gridding kernel
-                static void grid(casa::Matrix<casa::Complex>& grid,
-                        casa::Matrix<casa::Complex>& convFunc,
+                void grid(casa::Matrix<casa::Complex>& grid,
+                        const casa::Matrix<casa::Complex>& convFunc,
                         const casa::Complex& cVis, const int iu,
-                        const int iv, const int support);
+                        const int iv, const int support) const;
 
                 /// Degridding kernel
-                static void degrid(casa::Complex& cVis,
+                void degrid(casa::Complex& cVis,
                         const casa::Matrix<casa::Complex>& convFunc,
                         const casa::Matrix<casa::Complex>& grid,
                         const int iu, const int iv,
-                        const int support);
+                        const int support) const;
+
+                /// @brief gridding kernel working with raw pointers
+                /// @details The patch of 2*support x 2*support pixels is updated.
+                /// Elements along the first axis are assumed to be contiguous for both
+                /// the grid and the convolution function.
+                /// @param[in] grid pointer to the first grid pixel of the patch, i.e. (iu-support, iv-support)
+                /// @param[in] gridStride distance (in elements) between adjacent rows of the grid
+                /// @param[in] convFunc pointer to the first element of the convolution function
+                /// @param[in] cfStride distance (in elements) between adjacent rows of the convolution function
+                /// @param[in] cVis visibility to grid
+                /// @param[in] support support of the convolution function
+                void grid(casa::Complex *grid, const int gridStride,
+                        const casa::Complex *convFunc, const int cfStride,
+                        const casa::Complex& cVis, const int support) const;
+
+                /// @brief degridding kernel working with raw pointers
+                /// @details See the raw gridding kernel for the meaning of the parameters.
+                /// @return degridded visibility
+                casa::Complex degrid(const casa::Complex *grid, const int gridStride,
+                        const casa::Complex *convFunc, const int cfStride,
+                        const int support) const;
 
+            private:
+                /// @brief selected kernel family (points to a process-wide immutable table)
+                const KernelSet *itsKernel;
         };
     }
 }
@@ -0,0 +1,330 @@
+/// @file
+/// @brief Precomputed per-sample gridding information for one data chunk
+/// @details The inner loop of TableVisGridder used to recompute the scaled u and v,
+/// oversampling offsets, delay phasors, polarisation conversion of the noise and
+/// the frequency mapping for every sample, polarisation and pass over the data.
+/// This class computes all of this information for a whole accessor chunk at once
+/// and stores it in flat (structure of arrays) buffers. The plan only depends on the
+/// accessor and the geometry of the grid, but not on the convolution functions.
+/// Therefore, the same plan can be shared between a number of gridders working with
+/// the same image and the same chunk of data (e.g. model degridding, residual and PSF
+/// gridding in ImageFFTEquation).
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author agent <agent@local>
+
+#include <gridding/GriddingPlan.h>
+#include <askap/AskapError.h>
+#include <askap/AskapUtil.h>
+
+#include <casa/BasicSL/Constants.h>
+#include <casa/Arrays/ArrayLogical.h>
+#include <casa/Arrays/Cube.h>
+
+#include <cmath>
+
+namespace askap {
+
+namespace synthesis {
+
+/// @brief construct an empty (invalid) plan
+GriddingPlan::GriddingPlan() : itsValid(false), itsNRow(0), itsNChan(0), itsNPol(0),
+    itsNImagePols(0), itsNU(0), itsNV(0), itsUCellSize(0.), itsVCellSize(0.),
+    itsOverSample(0), itsMaxPointingSeparation(-1.), itsRowsRejected(0),
+    itsSamplesSkipped(0) {}
+
+/// @brief invalidate the plan
+/// @details This method has to be called every time the data accessor changes.
+/// The buffers are kept, so subsequent builds don't need to reallocate memory
+/// if the chunk size stays the same.
+void GriddingPlan::invalidate()
+{
+#ifdef _OPENMP
+   boost::unique_lock<boost::mutex> lock(itsMutex);
+#endif
+   itsValid = false;
+}
+
+/// @brief build the plan, if necessary, and check that it matches the geometry
+/// @details If the plan is not valid, it is built for the given accessor and geometry
+/// and true is returned. Otherwise, the method checks whether the geometry the plan
+/// was built for is the same as the given one. The caller should build its own plan
+/// if false is returned.
+/// @param[in] acc data accessor (should be the same since the last call to invalidate)
+/// @param[in] shape shape of the grid (at least 2 dimensions)
+/// @param[in] uvCellSize uv-cell size in wavelengths (2 elements)
+/// @param[in] overSample oversampling factor
+/// @param[in] tangentPoint tangent point of the image
+/// @param[in] imageCentre centre of the image
+/// @param[in] maxPointingSeparation maximum separation between pointing and image centre
+///            (in radians), samples further away are rejected. Negative value disables the check.
+/// @param[in] polConv converter from the accessor polarisation frame to that of the image
+/// @param[in] freqMapper frequency mapper set up for the given accessor
+/// @return true, if the plan can be used with the given geometry
+bool GriddingPlan::prepare(const accessors::IConstDataAccessor &acc, const casa::IPosition &shape,
+                const casa::Vector<double> &uvCellSize, const int overSample,
+                const casa::MVDirection &tangentPoint, const casa::MVDirection &imageCentre,
+                const double maxPointingSeparation,
+                const scimath::PolConverter &polConv,
+                const FrequencyMapper &freqMapper)
+{
+#ifdef _OPENMP
+   boost::unique_lock<boost::mutex> lock(itsMutex);
+#endif
+   fillChanMap(freqMapper, acc.nChannel(), itsChanMapBuffer);
+   if (itsValid) {
+       return matches(acc, shape, uvCellSize, overSample, tangentPoint, imageCentre,
+                      maxPointingSeparation, polConv, itsChanMapBuffer);
+   }
+   build(acc, shape, uvCellSize, overSample, tangentPoint, imageCentre,
+         maxPointingSeparation, polConv, itsChanMapBuffer);
+   return true;
+}
+
+/// @brief obtain channel mapping as a flat vector
+/// @param[in] freqMapper frequency mapper set up for the accessor
+/// @param[in] nChan number of accessor channels
+/// @param[out] chanMap image channel for every accessor channel (-1 for unmapped channels)
+void GriddingPlan::fillChanMap(const FrequencyMapper &freqMapper, const casa::uInt nChan,
+                               std::vector<int> &chanMap)
+{
+   chanMap.resize(nChan);
+   for (casa::uInt chan = 0; chan < nChan; ++chan) {
+        chanMap[chan] = freqMapper.isMapped(chan) ? int(freqMapper(chan)) : -1;
+   }
+}
+
+/// @brief check that the plan has been built for the given geometry
+/// @details Parameters are the same as for prepare
+/// @return true, if the geometry matches
+bool GriddingPlan::matches(const accessors::IConstDataAccessor &acc, const casa::IPosition &shape,
+                const casa::Vector<double> &uvCellSize, const int overSample,
+                const casa::MVDirection &tangentPoint, const casa::MVDirection &imageCentre,
+                const double maxPointingSeparation,
+                const scimath::PolConverter &polConv,
+                const std::vector<int> &chanMap) const
+{
+   ASKAPDEBUGASSERT(itsValid);
+   ASKAPCHECK((acc.nRow() == itsNRow) && (acc.nChannel() == itsNChan) && (acc.nPol() == itsNPol),
+              "Gridding plan has been built for a different chunk of data, nRow="<<itsNRow<<
+              " nChan="<<itsNChan<<" nPol="<<itsNPol<<"; it has to be invalidated when the accessor changes");
+   ASKAPDEBUGASSERT(shape.nelements() >= 2);
+   ASKAPDEBUGASSERT(uvCellSize.nelements() == 2);
+   return (shape(0) == itsNU) && (shape(1) == itsNV) && (uvCellSize(0) == itsUCellSize) &&
+          (uvCellSize(1) == itsVCellSize) && (overSample == itsOverSample) &&
+          (maxPointingSeparation == itsMaxPointingSeparation) &&
+          casa::allEQ(tangentPoint.getValue(), itsTangentPoint.getValue()) &&
+          casa::allEQ(imageCentre.getValue(), itsImageCentre.getValue()) &&
+          scimath::PolConverter::equal(polConv.inputPolFrame(), itsDataStokes) &&
+          scimath::PolConverter::equal(polConv.outputPolFrame(), itsImageStokes) &&
+          (chanMap == itsChanMap);
+}
+
+/// @brief build the plan
+/// @details Parameters are the same as for prepare
+void GriddingPlan::build(const accessors::IConstDataAccessor &acc, const casa::IPosition &shape,
+              const casa::Vector<double> &uvCellSize, const int overSample,
+              const casa::MVDirection &tangentPoint, const casa::MVDirection &imageCentre,
+              const double maxPointingSeparation,
+              const scimath::PolConverter &polConv,
+              const std::vector<int> &chanMap)
+{
+   ASKAPCHECK(uvCellSize.nelements() == 2, "UV cell sizes not yet set");
+   ASKAPCHECK(shape.nelements() >= 2, "Grid shape is expected to have at least 2 dimensions, you have "<<shape);
+   ASKAPCHECK(overSample > 0, "Oversampling must be greater than 0");
+
+   itsNRow = acc.nRow();
+   itsNChan = acc.nChannel();
+   itsNPol = acc.nPol();
+   itsNImagePols = (shape.nelements() <= 2) ? 1 : shape(2);
+   ASKAPCHECK(polConv.nOutputDim() == itsNImagePols, "Polarisation converter produces "<<
+              polConv.nOutputDim()<<" products, while the grid has "<<itsNImagePols<<" polarisation planes");
+   ASKAPCHECK(polConv.nInputDim() == itsNPol, "Polarisation converter expects "<<polConv.nInputDim()<<
+              " products, while the accessor has "<<itsNPol<<" polarisations");
+   ASKAPDEBUGASSERT(chanMap.size() == itsNChan);
+   itsNU = shape(0);
+   itsNV = shape(1);
+   itsUCellSize = uvCellSize(0);
+   itsVCellSize = uvCellSize(1);
+   itsOverSample = overSample;
+   itsTangentPoint = tangentPoint;
+   itsImageCentre = imageCentre;
+   itsMaxPointingSeparation = maxPointingSeparation;
+   itsDataStokes.assign(polConv.inputPolFrame().copy());
+   itsImageStokes.assign(polConv.outputPolFrame().copy());
+   itsChanMap = chanMap;
+   itsRowsRejected = 0;
+   itsSamplesSkipped = 0;
+
+   const casa::uInt nSamples = itsNRow * itsNChan;
+   itsRowSelected.resize(itsNRow);
+   itsImageChan.resize(nSamples);
+   itsIU.resize(nSamples);
+   itsIV.resize(nSamples);
+   itsOverSampleOffset.resize(nSamples);
+   itsPhasor.resize(nSamples);
+   itsNoiseWeight.resize(nSamples * itsNImagePols);
+
+   const casa::Vector<casa::RigidVector<double, 3> > &outUVW = acc.rotatedUVW(tangentPoint);
+   const casa::Vector<double> &delay = acc.uvwRotationDelay(tangentPoint, imageCentre);
+   const casa::Vector<casa::Double> &frequencyList = acc.frequency();
+   ASKAPDEBUGASSERT(itsNChan <= frequencyList.nelements());
+   ASKAPDEBUGASSERT(itsNRow == outUVW.nelements());
+   ASKAPDEBUGASSERT(itsNRow == delay.nelements());
+
+   // flags and noise are accessed directly via pointers to avoid creation of temporary
+   // vectors for each sample; a contiguous copy is made if necessary
+   const casa::Cube<casa::Bool> &flagCube = acc.flag();
+   const casa::Cube<casa::Complex> &noiseCube = acc.noise();
+   ASKAPDEBUGASSERT(flagCube.shape() == casa::IPosition(3, itsNRow, itsNChan, itsNPol));
+   ASKAPDEBUGASSERT(noiseCube.shape() == casa::IPosition(3, itsNRow, itsNChan, itsNPol));
+   casa::Cube<casa::Bool> flagBuffer;
+   casa::Cube<casa::Complex> noiseBuffer;
+   if (!flagCube.contiguousStorage()) {
+       flagBuffer = flagCube.copy();
+   }
+   if (!noiseCube.contiguousStorage()) {
+       noiseBuffer = noiseCube.copy();
+   }
+   const casa::Bool *flags = flagCube.contiguousStorage() ? flagCube.data() : flagBuffer.data();
+   const casa::Complex *noise = noiseCube.contiguousStorage() ? noiseCube.data() : noiseBuffer.data();
+   // distance between adjacent polarisation products in the cube
+   const casa::uInt polStride = nSamples;
+
+   bool frequenciesChecked = false;
+   casa::Complex imagePolFrameNoise[4];
+   ASKAPCHECK(itsNImagePols <= 4, "Only up to 4 image polarisations are supported, you have "<<itsNImagePols);
+
+   // all channels of a row are processed in one pass. Quantities which depend on the channel
+   // only are computed once per chunk, the per-channel scaling of uvw and delay is done
+   // in a separate loop without branches, so the compiler can vectorise it
+   std::vector<double> chanFactor(itsNChan);
+   for (casa::uInt chan = 0; chan < itsNChan; ++chan) {
+        chanFactor[chan] = frequencyList[chan] / casa::C::c;
+   }
+   std::vector<double> uScaledBuf(itsNChan), vScaledBuf(itsNChan), phaseBuf(itsNChan);
+
+   for (casa::uInt row = 0; row < itsNRow; ++row) {
+        bool selected = true;
+        if (maxPointingSeparation > 0.) {
+            // need to reject samples, if too far from the image centre
+            const casa::MVDirection thisPointing = acc.pointingDir1()(row);
+            selected = (imageCentre.separation(thisPointing) <= maxPointingSeparation);
+        }
+        itsRowSelected[row] = selected ? 1 : 0;
+        if (!selected) {
+            ++itsRowsRejected;
+            for (casa::uInt chan = 0; chan < itsNChan; ++chan) {
+                 itsImageChan[row * itsNChan + chan] = -1;
+            }
+            continue;
+        }
+        if (!frequenciesChecked && (itsNChan > 0)) {
+            // check for ridiculous frequency to pick up a possible error with input file,
+            // not essential for processing as such
+            const double reciprocalToWavelength = frequencyList[0]/casa::C::c;
+            ASKAPCHECK((reciprocalToWavelength>0.1) && (reciprocalToWavelength<30000),
+                "Check frequencies in the input file as the order of magnitude is likely to be wrong, "
+                "comment this statement in the code if you're trying something non-standard. Frequency = "<<
+                frequencyList[0]/1e9<<" GHz");
+            frequenciesChecked = true;
+        }
+        const double uFactor = outUVW(row)(0) / itsUCellSize;
+        const double vFactor = outUVW(row)(1) / itsVCellSize;
+        const double phaseFactor = 2. * casa::C::pi * delay(row);
+        for (casa::uInt chan = 0; chan < itsNChan; ++chan) {
+             uScaledBuf[chan] = uFactor * chanFactor[chan];
+             vScaledBuf[chan] = vFactor * chanFactor[chan];
+             phaseBuf[chan] = phaseFactor * chanFactor[chan];
+        }
+        for (casa::uInt chan = 0; chan < itsNChan; ++chan) {
+             const casa::uInt sample = row * itsNChan + chan;
+             // index of this sample in the cubes
+             const casa::uInt cubeIndex = row + itsNRow * chan;
+
+             bool allPolGood = true;
+             for (casa::uInt pol = 0; pol < itsNPol; ++pol) {
+                  if (flags[cubeIndex + pol * polStride]) {
+                      allPolGood = false;
+                      break;
+                  }
+             }
+             // Ensure that we only use unflagged data, incomplete polarisation vectors are
+             // ignored
+             if (!allPolGood || (chanMap[chan] < 0)) {
+                 itsImageChan[sample] = -1;
+                 ++itsSamplesSkipped;
+                 continue;
+             }
+             itsImageChan[sample] = chanMap[chan];
+
+             /// Scale U,V to integer pixels plus fractional terms
+             const double uScaled = uScaledBuf[chan];
+             int iu = askap::nint(uScaled);
+             int fracu=askap::nint(itsOverSample*(double(iu)-uScaled));
+             if (fracu<0) {
+                 iu+=1;
+                 fracu += itsOverSample;
+             } else if (fracu>=itsOverSample) {
+                 iu-=1;
+                 fracu -= itsOverSample;
+             }
+             ASKAPCHECK((fracu>-1) && (fracu<itsOverSample), "Fractional offset in u is outside the allowed range, uScaled="<<
+                        uScaled<<" iu="<<iu<<" oversample="<<itsOverSample<<" fracu="<<fracu);
+
+             const double vScaled = vScaledBuf[chan];
+             int iv = askap::nint(vScaled);
+             int fracv=askap::nint(itsOverSample*(double(iv)-vScaled));
+             if (fracv<0) {
+                 iv+=1;
+                 fracv += itsOverSample;
+             } else if (fracv>=itsOverSample) {
+                 iv-=1;
+                 fracv -= itsOverSample;
+             }
+             ASKAPCHECK((fracv>-1) && (fracv<itsOverSample), "Fractional offset in v is outside the allowed range, vScaled="<<
+                        vScaled<<" iv="<<iv<<" oversample="<<itsOverSample<<" fracv="<<fracv);
+
+             itsIU[sample] = iu + itsNU / 2;
+             itsIV[sample] = iv + itsNV / 2;
+             itsOverSampleOffset[sample] = fracu + itsOverSample * fracv;
+
+             // Calculate the delay phasor
+             const double phase = phaseBuf[chan];
+             itsPhasor[sample] = casa::Complex(cos(phase), sin(phase));
+
+             // noise weights in the image polarisation frame
+             polConv.noise(imagePolFrameNoise, noise + cubeIndex, polStride);
+             for (casa::uInt pol = 0; pol < itsNImagePols; ++pol) {
+                  const float visNoise = casa::square(casa::real(imagePolFrameNoise[pol]));
+                  itsNoiseWeight[sample * itsNImagePols + pol] = (visNoise > 0.) ? 1./visNoise : 0.;
+             }
+        }
+   }
+   itsValid = true;
+}
+
+} // namespace synthesis
+
+} // namespace askap
@@ -0,0 +1,294 @@
+/// @file
+/// @brief Precomputed per-sample gridding information for one data chunk
+/// @details The inner loop of TableVisGridder used to recompute the scaled u and v,
+/// oversampling offsets, delay phasors, polarisation conversion of the noise and
+/// the frequency mapping for every sample, polarisation and pass over the data.
+/// This class computes all of this information for a whole accessor chunk at once
+/// and stores it in flat (structure of arrays) buffers. The plan only depends on the
+/// accessor and the geometry of the grid, but not on the convolution functions.
+/// Therefore, the same plan can be shared between a number of gridders working with
+/// the same image and the same chunk of data (e.g. model degridding, residual and PSF
+/// gridding in ImageFFTEquation).
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author agent <agent@local>
+
+#ifndef ASKAP_SYNTHESIS_GRIDDING_PLAN_H
+#define ASKAP_SYNTHESIS_GRIDDING_PLAN_H
+
+// own includes
+#include <dataaccess/IConstDataAccessor.h>
+#include <gridding/FrequencyMapper.h>
+#include <utils/PolConverter.h>
+
+// casa includes
+#include <casa/BasicSL/Complex.h>
+#include <casa/Arrays/IPosition.h>
+#include <casa/Arrays/Vector.h>
+#include <casa/Quanta/MVDirection.h>
+#include <measures/Measures/Stokes.h>
+
+// boost includes
+#include <boost/shared_ptr.hpp>
+#include <boost/noncopyable.hpp>
+
+#ifdef _OPENMP
+#include <boost/thread/mutex.hpp>
+#endif
+
+// std includes
+#include <vector>
+
+namespace askap {
+
+namespace synthesis {
+
+/// @brief Precomputed per-sample gridding information for one data chunk
+/// @details The plan holds grid coordinates (including the half-size offset
+/// of the grid), the oversampling offset, the delay phasor and the image channel
+/// for every sample (i.e. row and channel of the accessor), as well as the noise
+/// weight for every sample and image polarisation. Samples which should be skipped
+/// (flagged, not mapped to the image cube or rejected due to the maximum pointing
+/// separation) have a negative image channel. Everything which depends on the
+/// convolution functions (CF plane index, CF offset, support) is handled by the gridder.
+///
+/// A plan is built on demand by the first gridder which needs it and is then
+/// reused by all gridders with the same geometry until it is invalidated, which has
+/// to be done by the code owning the plan every time the accessor changes. Building
+/// is serialised internally, so the plan can be shared between gridders running
+/// in parallel threads.
+/// @ingroup gridding
+class GriddingPlan : private boost::noncopyable {
+public:
+   /// @brief shared pointer type
+   typedef boost::shared_ptr<GriddingPlan> ShPtr;
+
+   /// @brief construct an empty (invalid) plan
+   GriddingPlan();
+
+   /// @brief invalidate the plan
+   /// @details This method has to be called every time the data accessor changes.
+   /// The buffers are kept, so subsequent builds don't need to reallocate memory
+   /// if the chunk size stays the same.
+   void invalidate();
+
+   /// @brief check whether the plan has been built
+   /// @return true, if the plan has been built for the current chunk
+   bool isValid() const { return itsValid; }
+
+   /// @brief build the plan, if necessary, and check that it matches the geometry
+   /// @details If the plan is not valid, it is built for the given accessor and geometry
+   /// and true is returned. Otherwise, the method checks whether the geometry the plan
+   /// was built for is the same as the given one. The caller should build its own plan
+   /// if false is returned.
+   /// @param[in] acc data accessor (should be the same since the last call to invalidate)
+   /// @param[in] shape shape of the grid (at least 2 dimensions)
+   /// @param[in] uvCellSize uv-cell size in wavelengths (2 elements)
+   /// @param[in] overSample oversampling factor
+   /// @param[in] tangentPoint tangent point of the image
+   /// @param[in] imageCentre centre of the image
+   /// @param[in] maxPointingSeparation maximum separation between pointing and image centre
+   ///            (in radians), samples further away are rejected. Negative value disables the check.
+   /// @param[in] polConv converter from the accessor polarisation frame to that of the image
+   /// @param[in] freqMapper frequency mapper set up for the given accessor
+   /// @return true, if the plan can be used with the given geometry
+   bool prepare(const accessors::IConstDataAccessor &acc, const casa::IPosition &shape,
+                const casa::Vector<double> &uvCellSize, const int overSample,
+                const casa::MVDirection &tangentPoint, const casa::MVDirection &imageCentre,
+                const double maxPointingSeparation,
+                const scimath::PolConverter &polConv,
+                const FrequencyMapper &freqMapper);
+
+   /// @brief number of rows the plan has been built for
+   casa::uInt nRow() const { return itsNRow; }
+
+   /// @brief number of channels the plan has been built for
+   casa::uInt nChan() const { return itsNChan; }
+
+   /// @brief number of polarisations in the accessor the plan has been built for
+   casa::uInt nPol() const { return itsNPol; }
+
+   /// @brief number of image polarisations
+   casa::uInt nImagePols() const { return itsNImagePols; }
+
+   /// @brief check whether the row passed the pointing separation test
+   /// @param[in] row accessor row
+   /// @return true, if the row is used, false if it is rejected
+   bool rowSelected(const casa::uInt row) const { return itsRowSelected[row] != 0; }
+
+   /// @brief number of rows rejected due to the maximum pointing separation
+   casa::uLong rowsRejected() const { return itsRowsRejected; }
+
+   /// @brief number of samples of the selected rows which are skipped
+   /// @details A sample is skipped if any polarisation is flagged or if the channel is not
+   /// mapped to the image cube.
+   casa::uLong samplesSkipped() const { return itsSamplesSkipped; }
+
+   /// @brief image channel for the given sample
+   /// @param[in] sample sample index (row * nChan() + chan)
+   /// @return image channel or -1 if the sample should be skipped
+   int imageChan(const casa::uInt sample) const { return itsImageChan[sample]; }
+
+   /// @brief u grid coordinate (before the CF offset is applied)
+   /// @param[in] sample sample index (row * nChan() + chan)
+   int iu(const casa::uInt sample) const { return itsIU[sample]; }
+
+   /// @brief v grid coordinate (before the CF offset is applied)
+   /// @param[in] sample sample index (row * nChan() + chan)
+   int iv(const casa::uInt sample) const { return itsIV[sample]; }
+
+   /// @brief oversampling offset
+   /// @details This is fracu + overSample * fracv, i.e. the index of the oversampled
+   /// CF within the plane
+   /// @param[in] sample sample index (row * nChan() + chan)
+   int overSampleOffset(const casa::uInt sample) const { return itsOverSampleOffset[sample]; }
+
+   /// @brief delay phasor
+   /// @param[in] sample sample index (row * nChan() + chan)
+   const casa::Complex& phasor(const casa::uInt sample) const { return itsPhasor[sample]; }
+
+   /// @brief noise weight for the given sample and image polarisation
+   /// @details The weight is the reciprocal of the noise variance of the real part
+   /// in the image polarisation frame, or zero if the noise is not positive.
+   /// @param[in] sample sample index (row * nChan() + chan)
+   /// @param[in] pol image polarisation
+   float noiseWeight(const casa::uInt sample, const casa::uInt pol) const
+      { return itsNoiseWeight[sample * itsNImagePols + pol]; }
+
+protected:
+   /// @brief build the plan
+   /// @details Parameters are the same as for prepare
+   void build(const accessors::IConstDataAccessor &acc, const casa::IPosition &shape,
+              const casa::Vector<double> &uvCellSize, const int overSample,
+              const casa::MVDirection &tangentPoint, const casa::MVDirection &imageCentre,
+              const double maxPointingSeparation,
+              const scimath::PolConverter &polConv,
+              const std::vector<int> &chanMap);
+
+   /// @brief check that the plan has been built for the given geometry
+   /// @details Parameters are the same as for prepare
+   /// @return true, if the geometry matches
+   bool matches(const accessors::IConstDataAccessor &acc, const casa::IPosition &shape,
+                const casa::Vector<double> &uvCellSize, const int overSample,
+                const casa::MVDirection &tangentPoint, const casa::MVDirection &imageCentre,
+                const double maxPointingSeparation,
+                const scimath::PolConverter &polConv,
+                const std::vector<int> &chanMap) const;
+
+   /// @brief obtain channel mapping as a flat vector
+   /// @param[in] freqMapper frequency mapper set up for the accessor
+   /// @param[in] nChan number of accessor channels
+   /// @param[out] chanMap image channel for every accessor channel (-1 for unmapped channels)
+   static void fillChanMap(const FrequencyMapper &freqMapper, const casa::uInt nChan,
+                           std::vector<int> &chanMap);
+
+private:
+   /// @brief true if the plan has been built
+   bool itsValid;
+
+   /// @brief dimensions of the chunk
+   casa::uInt itsNRow;
+   casa::uInt itsNChan;
+   casa::uInt itsNPol;
+
+   /// @brief number of image polarisations
+   casa::uInt itsNImagePols;
+
+   // geometry the plan has been built for
+
+   /// @brief grid size along u and v
+   int itsNU;
+   int itsNV;
+
+   /// @brief uv-cell size
+   double itsUCellSize;
+   double itsVCellSize;
+
+   /// @brief oversampling factor
+   int itsOverSample;
+
+   /// @brief tangent point
+   casa::MVDirection itsTangentPoint;
+
+   /// @brief image centre
+   casa::MVDirection itsImageCentre;
+
+   /// @brief maximum pointing separation
+   double itsMaxPointingSeparation;
+
+   /// @brief accessor polarisation frame
+   casa::Vector<casa::Stokes::StokesTypes> itsDataStokes;
+
+   /// @brief image polarisation frame
+   casa::Vector<casa::Stokes::StokesTypes> itsImageStokes;
+
+   /// @brief image channel for every accessor channel
+   std::vector<int> itsChanMap;
+
+   // statistics
+
+   /// @brief number of rows rejected due to the maximum pointing separation
+   casa::uLong itsRowsRejected;
+
+   /// @brief number of skipped samples in selected rows
+   casa::uLong itsSamplesSkipped;
+
+   // per-row and per-sample buffers
+
+   /// @brief non-zero for rows which passed the pointing separation test
+   std::vector<char> itsRowSelected;
+
+   /// @brief image channel for every sample (negative to skip)
+   std::vector<int> itsImageChan;
+
+   /// @brief u grid coordinate for every sample
+   std::vector<int> itsIU;
+
+   /// @brief v grid coordinate for every sample
+   std::vector<int> itsIV;
+
+   /// @brief oversampling offset for every sample
+   std::vector<int> itsOverSampleOffset;
+
+   /// @brief delay phasor for every sample
+   std::vector<casa::Complex> itsPhasor;
+
+   /// @brief noise weight for every sample and image polarisation
+   std::vector<float> itsNoiseWeight;
+
+   /// @brief buffer for the channel mapping
+   /// @details To avoid reallocation for every call to prepare
+   std::vector<int> itsChanMapBuffer;
+
+#ifdef _OPENMP
+   /// @brief synchronisation of the build between threads
+   boost::mutex itsMutex;
+#endif
+};
+
+} // namespace synthesis
+
+} // namespace askap
+
+#endif // #ifndef ASKAP_SYNTHESIS_GRIDDING_PLAN_H
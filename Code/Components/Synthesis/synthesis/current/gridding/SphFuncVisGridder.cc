@@ -85,7 +85,8 @@ namespace askap
          // a rather poor way of checking that convolution function has already been initialised 
          return;
       }
-      itsConvFunc.resize(itsOverSample*itsOverSample);
+      itsConvFunc.init(1, itsOverSample);
+      itsConvFunc.allocate(0, itsSupport);
 
       const int cSize=2*itsSupport+1; // 7;
 
@@ -95,31 +96,22 @@ namespace askap
         for (int fracu=0; fracu<itsOverSample; ++fracu) {
           const int plane=fracu+itsOverSample*fracv;
           ASKAPDEBUGASSERT(plane>=0 && plane<int(itsConvFunc.size()));
-          itsConvFunc[plane].resize(cSize, cSize);
-          itsConvFunc[plane].set(0.0);
+          casa::Matrix<casa::Complex> thisCF = itsConvFunc.matrix(plane);
           for (int ix=0; ix<cSize; ++ix) {
             double nux=std::abs(double(itsOverSample*(ix-itsSupport)+fracu))/double(itsSupport*itsOverSample);
             double fx=grdsf(nux)*(1.0-std::pow(nux, 2));
             for (int iy=0; iy<cSize; ++iy) {
               double nuy=std::abs(double(itsOverSample*(iy-itsSupport)+fracv))/double(itsSupport*itsOverSample);
               double fy=grdsf(nuy)*(1.0-std::pow(nuy, 2));
-              itsConvFunc[plane](ix, iy)=fx*fy;
+              thisCF(ix, iy)=fx*fy;
             } // for iy
           } // for ix
+          // force normalization for all fractional offsets (or planes)
+          const double norm = real(sum(casa::abs(thisCF)));
+          ASKAPDEBUGASSERT(norm>0.);
+          thisCF/=casa::Complex(norm);
         } // for fracu
       } // for fracv
-      
-      // force normalization for all fractional offsets (or planes)
-      for (size_t plane = 0; plane<itsConvFunc.size(); ++plane) {
-           if (itsConvFunc[plane].nelements() == 0) {
-               // this plane of the cache is unused
-               continue;
-           }
-           const double norm = real(sum(casa::abs(itsConvFunc[plane])));
-           ASKAPDEBUGASSERT(norm>0.);
-           itsConvFunc[plane]/=casa::Complex(norm);
-      } // for plane					        
-      
     }
 
     void SphFuncVisGridder::correctConvolution(casa::Array<double>& grid)
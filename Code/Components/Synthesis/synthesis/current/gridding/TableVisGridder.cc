@@ -45,6 +45,7 @@ ASKAP_LOGGER(logger, ".gridding.tablevisgridder");
 #include <fitting/ParamsCasaTable.h>
 
 #include <gridding/GridKernel.h>
+#include <gridding/GriddingPlan.h>
 
 #include <utils/PaddingUtils.h>
 #include <measurementequation/ImageParamsHelper.h>
@@ -59,6 +60,7 @@ using namespace askap;
 #include <ostream>
 #include <sstream>
 #include <iomanip>
+#include <algorithm>
 
 #include <casa/OS/Timer.h>
 
@@ -86,6 +88,36 @@ void deepCopyOfSTDVector(const std::vector<T> &in,
 /// @brief required to mediate thread safety issues of the casa cube
 utility::CasaSyncHelper syncHelper;
 
+namespace {
+
+/// @brief deferred gridding operation
+/// @details In the multithreaded mode, gridding operations are collected into
+/// tiles (stripes along v) first and then executed in parallel.
+struct DeferredGridding {
+   /// @brief constructor
+   /// @param[in] grid first pixel of the patch to update
+   /// @param[in] convFunc first element of the convolution function
+   /// @param[in] cfStride distance between adjacent rows of the convolution function
+   /// @param[in] support support of the convolution function
+   /// @param[in] vis visibility to grid
+   DeferredGridding(casa::Complex *grid, const casa::Complex *convFunc, const int cfStride,
+                    const int support, const casa::Complex &vis) : itsGrid(grid), itsConvFunc(convFunc),
+                    itsCFStride(cfStride), itsSupport(support), itsVis(vis) {}
+
+   /// @brief first pixel of the patch to update
+   casa::Complex *itsGrid;
+   /// @brief first element of the convolution function
+   const casa::Complex *itsConvFunc;
+   /// @brief distance between adjacent rows of the convolution function
+   int itsCFStride;
+   /// @brief support of the convolution function
+   int itsSupport;
+   /// @brief visibility to grid
+   casa::Complex itsVis;
+};
+
+} // anonymous namespace
+
 TableVisGridder::TableVisGridder() : itsSumWeights(),
         itsSupport(-1), itsOverSample(-1),
 	itsModelIsEmpty(false), itsSamplesGridded(0),
@@ -94,7 +126,8 @@ TableVisGridder::TableVisGridder() : itsSumWeights(),
 	itsTimeDegridded(0.0), itsDopsf(false),
 	itsFirstGriddedVis(true), itsFeedUsedForPSF(0), itsUseAllDataForPSF(false),
 	itsMaxPointingSeparation(-1.), itsRowsRejectedDueToMaxPointingSeparation(0),
-	itsTrackWeightPerOversamplePlane(false)
+	itsTrackWeightPerOversamplePlane(false), itsNThreads(1), itsMaxCFSupport(0), itsSortTileSize(0),
+        itsSinglePrecision(false)
 
 {}
 
@@ -107,7 +140,8 @@ TableVisGridder::TableVisGridder(const int overSample, const int support,
         itsTimeDegridded(0.0), itsDopsf(false),
         itsFirstGriddedVis(true), itsFeedUsedForPSF(0), itsUseAllDataForPSF(false), 	
         itsMaxPointingSeparation(-1.), itsRowsRejectedDueToMaxPointingSeparation(0),
-        itsTrackWeightPerOversamplePlane(false)
+        itsTrackWeightPerOversamplePlane(false), itsNThreads(1), itsMaxCFSupport(0), itsSortTileSize(0),
+        itsSinglePrecision(false)
 	{
 		
 		ASKAPCHECK(overSample>0, "Oversampling must be greater than 0");
@@ -141,10 +175,13 @@ TableVisGridder::TableVisGridder(const int overSample, const int support,
      itsFreqMapper(other.itsFreqMapper),
      itsMaxPointingSeparation(other.itsMaxPointingSeparation),
      itsRowsRejectedDueToMaxPointingSeparation(other.itsRowsRejectedDueToMaxPointingSeparation),
-     itsConvFuncOffsets(other.itsConvFuncOffsets), 
-     itsTrackWeightPerOversamplePlane(other.itsTrackWeightPerOversamplePlane)
+     itsConvFunc(other.itsConvFunc),
+     itsTrackWeightPerOversamplePlane(other.itsTrackWeightPerOversamplePlane),
+     itsNThreads(other.itsNThreads), itsMaxCFSupport(other.itsMaxCFSupport),
+     itsSortTileSize(other.itsSortTileSize), itsSinglePrecision(other.itsSinglePrecision),
+     itsKernel(other.itsKernel)
 {
-   deepCopyOfSTDVector(other.itsConvFunc,itsConvFunc);
+   // the CF store shares the buffer with the original until either of them is modified
    deepCopyOfSTDVector(other.itsGrid, itsGrid);   
    if(other.itsVisWeight) {
       itsVisWeight = other.itsVisWeight->clone();
@@ -185,7 +222,7 @@ TableVisGridder::~TableVisGridder() {
 				  << 1e6 * itsTimeCoordinates/itsSamplesGridded << " (us) per sample");
 		    ASKAPLOG_DEBUG_STR(logger, "   PSF CFs and indices      = "
 				  << 1e6 * itsTimeConvFunctions/itsSamplesGridded << " (us) per sample");
-		    ASKAPLOG_DEBUG_STR(logger, "   " << GridKernel::info());
+		    ASKAPLOG_DEBUG_STR(logger, "   " << itsKernel.info());
 		    ASKAPLOG_DEBUG_STR(logger, "   Points gridded (psf)        = "
 	              << itsNumberGridded);
 		    ASKAPLOG_DEBUG_STR(logger, "   Time per point (psf)        = " << 1e9
@@ -210,7 +247,7 @@ TableVisGridder::~TableVisGridder() {
 				  << 1e6 * itsTimeCoordinates/itsSamplesGridded << " (us) per sample");
 		    ASKAPLOG_DEBUG_STR(logger, "   CFs and indices      = "
 				  << 1e6 * itsTimeConvFunctions/itsSamplesGridded << " (us) per sample");
-		    ASKAPLOG_DEBUG_STR(logger, "   " << GridKernel::info());
+		    ASKAPLOG_DEBUG_STR(logger, "   " << itsKernel.info());
 		    ASKAPLOG_DEBUG_STR(logger, "   Points gridded        = "
 				<< itsNumberGridded);
 		    ASKAPLOG_DEBUG_STR(logger, "   Time per point        = " << 1e9
@@ -219,6 +256,9 @@ TableVisGridder::~TableVisGridder() {
 				<< 8.0 * 1e-9 * itsNumberGridded/itsTimeGridded << " GFlops");
 	    }			
 	}
+	if ((itsNThreads > 1) && ((itsNumberGridded>0) || (itsNumberDegridded>0))) {
+	    ASKAPLOG_DEBUG_STR(logger, "   Gridding/degridding used "<<itsNThreads<<" threads");
+	}
 	if (itsNumberDegridded>0) {
 		ASKAPLOG_DEBUG_STR(logger, "TableVisGridder degridding statistics");
 		ASKAPLOG_DEBUG_STR(logger, "   Samples degridded     = "
@@ -235,7 +275,7 @@ TableVisGridder::~TableVisGridder() {
 				  << 1e6 * itsTimeCoordinates/itsSamplesDegridded << " (us) per sample");
 		ASKAPLOG_DEBUG_STR(logger, "   CFs and indices      = "
 				  << 1e6 * itsTimeConvFunctions/itsSamplesDegridded << " (us) per sample");
-		ASKAPLOG_DEBUG_STR(logger, "   " << GridKernel::info());
+		ASKAPLOG_DEBUG_STR(logger, "   " << itsKernel.info());
 		ASKAPLOG_DEBUG_STR(logger, "   Points degridded      = "
 				<< itsNumberDegridded);
 		ASKAPLOG_DEBUG_STR(logger, "   Time per point        = " << 1e9
@@ -273,9 +313,9 @@ void TableVisGridder::save(const std::string& name) {
 	    askap::scimath::Params ip;
 	    ASKAPLOG_DEBUG_STR(logger, "Saving " << itsConvFunc.size() << " entries in convolution function");
 	    for (unsigned int i=0; i<itsConvFunc.size(); i++) {
-		   
-			casa::Array<double> realC(itsConvFunc[i].shape());
-			casa::convertArray<double,float>(realC,real(itsConvFunc[i]));
+		        const casa::Matrix<casa::Complex> thisCF = itsConvFunc.copyOf(i);
+			casa::Array<double> realC(thisCF.shape());
+			casa::convertArray<double,float>(realC,real(thisCF));
 			//			ASKAPLOG_DEBUG_STR(logger, "Entry[" <<  i <<  "] has shape " <<  itsConvFunc[i].shape());
 			std::ostringstream os;
 			os<<"Real.Convolution";
@@ -297,30 +337,21 @@ void TableVisGridder::save(const std::string& name) {
    
 	    const std::string imgName = name.substr(6);
 	    // number of planes before oversampling
-	    const unsigned long nPlanes = itsConvFunc.size()/itsOverSample/itsOverSample; 
+	    const unsigned long nPlanes = itsConvFunc.nPlanes(); 
 	    if (nPlanes > 0) {
 	        ASKAPLOG_DEBUG_STR(logger, "Saving convolution functions into a cube "<<imgName<<" with " << nPlanes<<
 	                              " planes (first oversampling plane only)");
 	        ASKAPDEBUGASSERT(itsConvFunc.size()>0);
-	        int support = -1;
-	        for (unsigned int plane = 0; plane<nPlanes; ++plane) {
-	             const int x = int(itsConvFunc[plane*itsOverSample*itsOverSample].nrow());
-	             const int y = int(itsConvFunc[plane*itsOverSample*itsOverSample].ncolumn());
-	             if (support < x) {
-	                 support = x;
-	             }
-	             if (support < y) {
-	                 support = y;
-	             }
-	        }
+	        // full size of the largest convolution function
+	        const int support = 2 * itsConvFunc.maxSupport() + 1;
 	        casa::Cube<casa::Float> imgBuffer(support, support, nPlanes);
 	        imgBuffer.set(0.);
 	        for (unsigned int plane = 0; plane<nPlanes; ++plane) {
 	            //unsigned int peakX = 0, peakY = 0;
 	            casa::Float peakVal = -1.;
+	            const casa::Matrix<casa::Complex> thisCF = itsConvFunc.copyOf(plane*itsOverSample*itsOverSample);
 	            for (int x = 0; x<int(imgBuffer.nrow()); ++x) {
 	                 for (int y = 0; y<int(imgBuffer.ncolumn()); ++y) {
-	                      const casa::Matrix<casa::Complex> thisCF = itsConvFunc[plane*itsOverSample*itsOverSample];
 	                      const int xOff = (support - int(thisCF.nrow()))/2;
 	                      const int yOff = (support - int(thisCF.ncolumn()))/2;
 	                      ASKAPDEBUGASSERT((xOff >= 0) && (yOff >= 0)); 
@@ -354,34 +385,20 @@ void TableVisGridder::logCFCacheStats() const
 {
    // number of planes before oversampling
    ASKAPDEBUGASSERT(itsOverSample>0);
-   const unsigned long nPlanes = itsConvFunc.size()/itsOverSample/itsOverSample; 
-   unsigned long memUsed = 0;
+   const unsigned long nPlanes = itsConvFunc.nPlanes(); 
    for (unsigned int plane = 0; plane<nPlanes; ++plane) {
-        ASKAPDEBUGASSERT(plane*itsOverSample*itsOverSample < itsConvFunc.size());
-        const casa::IPosition shape = itsConvFunc[plane*itsOverSample*itsOverSample].shape();
-        if (shape.nelements() < 2) {
-            ASKAPLOG_DEBUG_STR(logger, "CF plane="<<plane<<" (before oversampling) is malformed");
-            continue;
-        }
-        if (shape.product() == 0) {
+        if (!itsConvFunc.isDefined(plane)) {
             ASKAPLOG_DEBUG_STR(logger, "CF plane="<<plane<<" (before oversampling) is unused");
-            memUsed += sizeof(casa::Matrix<casa::Complex>);
-            continue;
-        }
-        if ((shape[0] != shape[1]) || (shape[0] % 2 != 1)) {
-            ASKAPLOG_DEBUG_STR(logger, "CF plane="<<plane<<" (before oversampling) has a rectangular support or even size");
-            memUsed += sizeof(casa::Matrix<casa::Complex>)+sizeof(casa::Complex)*shape.product()*itsOverSample*itsOverSample;
             continue;
         }
-        const int support = (shape[0] - 1) / 2;
+        const int support = itsConvFunc.support(plane);
         const std::pair<int,int> cfOffset = getConvFuncOffset(plane);
-        ASKAPLOG_DEBUG_STR(logger, "CF plane="<<plane<<" (before oversampling): support="<<support<<", size="<<shape[0]<<
+        ASKAPLOG_DEBUG_STR(logger, "CF plane="<<plane<<" (before oversampling): support="<<support<<", size="<<2 * support + 1<<
                                   " at offset ("<<cfOffset.first<<","<<cfOffset.second<<")");
-        memUsed += sizeof(casa::Matrix<casa::Complex>)+sizeof(casa::Complex)*shape[0]*shape[1]*itsOverSample*itsOverSample;
    }
    if (nPlanes > 0) {
-       float effectiveSize = (float(memUsed)-float(sizeof(casa::Matrix<casa::Complex>)*nPlanes)) / 
-                             (sizeof(casa::Complex)*itsOverSample*itsOverSample*nPlanes);
+       const size_t memUsed = itsConvFunc.memoryUsed();
+       float effectiveSize = float(memUsed) / (sizeof(casa::Complex)*itsOverSample*itsOverSample*nPlanes);
        ASKAPLOG_DEBUG_STR(logger, "Cache of convolution functions take "<<float(memUsed)/1024/1024<<" Mb of memory or "<<std::endl<<
                                  float(memUsed)/nPlanes/1024/1024<<" Mb of memory per plane (before oversampling)");
        ASKAPDEBUGASSERT(effectiveSize>=0.);
@@ -392,7 +409,171 @@ void TableVisGridder::logCFCacheStats() const
 }
 
 
+/// @brief obtain the gridding plan for the given accessor
+/// @details The shared plan is used if it has been set up and matches the geometry of this
+/// gridder, otherwise the plan owned by this gridder is rebuilt for the given accessor.
+/// @param[in] acc data accessor
+/// @param[in] gridPolConv polarisation converter from the accessor frame to the grid frame
+/// @return const reference to the plan ready to use
+const GriddingPlan& TableVisGridder::preparePlan(const accessors::IConstDataAccessor &acc,
+                                                 const scimath::PolConverter &gridPolConv)
+{
+   const casa::MVDirection imageCentre = getImageCentre();
+   const casa::MVDirection tangentPoint = getTangentPoint();
+   if (itsSharedPlan && itsSharedPlan->prepare(acc, itsShape, itsUVCellSize, itsOverSample, tangentPoint,
+                            imageCentre, itsMaxPointingSeparation, gridPolConv, itsFreqMapper)) {
+       return *itsSharedPlan;
+   }
+   if (!itsOwnPlan) {
+       itsOwnPlan.reset(new GriddingPlan);
+   }
+   itsOwnPlan->invalidate();
+   const bool planOk = itsOwnPlan->prepare(acc, itsShape, itsUVCellSize, itsOverSample, tangentPoint,
+                            imageCentre, itsMaxPointingSeparation, gridPolConv, itsFreqMapper);
+   ASKAPCHECK(planOk, "Freshly built gridding plan doesn't match the gridder - logic error");
+   return *itsOwnPlan;
+}
+
+/// @brief fill convolution function and grid indices for the current chunk
+/// @details This method evaluates cIndex and gIndex for every sample and image polarisation
+/// used by the plan and does all the bounds checks, so the main loop of generic can
+/// work without them.
+/// @param[in] plan gridding plan for the current chunk
+/// @param[in] forward true for degridding, false for gridding
+void TableVisGridder::fillPlanIndices(const GriddingPlan &plan, bool forward)
+{
+   ASKAPCHECK(itsConvFunc.overSample() == itsOverSample, "Oversampling factor of the CF store ("<<
+              itsConvFunc.overSample()<<") doesn't match that of the gridder ("<<itsOverSample<<")");
+   itsMaxCFSupport = itsConvFunc.maxSupport();
+
+   const casa::uInt nChan = plan.nChan();
+   const casa::uInt nImagePols = plan.nImagePols();
+   const int cfPlaneSize = itsOverSample * itsOverSample;
+   itsPlanCFPlane.resize(plan.nRow() * nChan * nImagePols);
+   itsPlanGridIndex.resize(itsPlanCFPlane.size());
+   for (casa::uInt row = 0; row < plan.nRow(); ++row) {
+        if (!plan.rowSelected(row)) {
+            continue;
+        }
+        for (casa::uInt chan = 0; chan < nChan; ++chan) {
+             const casa::uInt sample = row * nChan + chan;
+             const int imageChan = plan.imageChan(sample);
+             if (imageChan < 0) {
+                 continue;
+             }
+             for (casa::uInt pol = 0; pol < nImagePols; ++pol) {
+                  // Lookup the portion of grid to be
+                  // used for this row, polarisation and channel
+                  const int gInd = gIndex(row, pol, chan);
+                  ASKAPCHECK(gInd>-1,"Index into image grid is less than zero");
+                  ASKAPCHECK(gInd<int(itsGrid.size()), "Index into image grid exceeds number of planes");
+
+                  // Lookup the convolution function to be
+                  // used for this row, polarisation and channel
+                  // cIndex gives the index for this row, polarization and channel. On top of
+                  // that, we need to adjust for the oversampling since each oversampled
+                  // plane is kept as a separate matrix.
+                  const int beforeOversamplePlaneIndex = cIndex(row, pol, chan);
+                  const int cInd = plan.overSampleOffset(sample) + cfPlaneSize * beforeOversamplePlaneIndex;
+                  ASKAPCHECK(cInd>-1,"Index into convolution functions is less than zero");
+                  ASKAPCHECK(cInd<int(itsConvFunc.size()),
+                             "Index into convolution functions exceeds number of planes");
+                  // we use support size for this given plane in the CF cache; itsSupport is a maximum
+                  // support across all CFs (this allows plane-dependent support size)
+                  ASKAPCHECK(itsConvFunc.support(beforeOversamplePlaneIndex) > 0,
+                             "Expect convolution function with a positive support, CF plane "<<
+                             beforeOversamplePlaneIndex<<" has support="<<itsConvFunc.support(beforeOversamplePlaneIndex));
+                  if (!forward) {
+                      // row in itsSumWeights to work with
+                      const int sumWeightsRow = itsTrackWeightPerOversamplePlane ? cInd : beforeOversamplePlaneIndex;
+                      ASKAPDEBUGASSERT(itsSumWeights.shape().nelements() >= 3);
+                      ASKAPCHECK(sumWeightsRow < int(itsSumWeights.shape()(0)),
+                                 "Index into itsSumWeights of " << sumWeightsRow << " is greater than allowed " <<
+                                 int(itsSumWeights.shape()(0)));
+                      ASKAPDEBUGASSERT(pol < uint(itsSumWeights.shape()(1)));
+                      ASKAPDEBUGASSERT(imageChan < int(itsSumWeights.shape()(2)));
+                  }
+                  const casa::uInt index = sample * nImagePols + pol;
+                  itsPlanCFPlane[index] = beforeOversamplePlaneIndex;
+                  itsPlanGridIndex[index] = gInd;
+             }
+        }
+   }
+}
+
+/// @brief fill the order in which samples of the current chunk are processed
+/// @details Samples are bucketed by convolution function plane (of the first image
+/// polarisation) and then by uv-tile (counting sort, so the accessor order is preserved
+/// within each bucket). Only samples which are gridded are included.
+/// This method uses buffers filled by fillPlanIndices.
+/// @param[in] plan gridding plan for the current chunk
+/// @param[in] rowUsed flags for each row, false if the row is to be skipped entirely
+void TableVisGridder::fillSampleOrder(const GriddingPlan &plan, const std::vector<bool> &rowUsed)
+{
+   ASKAPDEBUGASSERT(itsSortTileSize > 0);
+   ASKAPDEBUGASSERT(rowUsed.size() == plan.nRow());
+   const casa::uInt nChan = plan.nChan();
+   const casa::uInt nImagePols = plan.nImagePols();
+   ASKAPDEBUGASSERT(itsShape.nelements() >= 2);
+   const int nTilesU = itsShape(0) / itsSortTileSize + 1;
+   const int nTilesV = itsShape(1) / itsSortTileSize + 1;
+
+   // samples to be gridded, in the accessor order and the uv-tile of each sample
+   std::vector<casa::uInt> samples;
+   std::vector<casa::uInt> tiles;
+   samples.reserve(plan.nRow() * nChan);
+   tiles.reserve(plan.nRow() * nChan);
+   for (casa::uInt row = 0; row < plan.nRow(); ++row) {
+        if (!rowUsed[row]) {
+            continue;
+        }
+        for (casa::uInt chan = 0; chan < nChan; ++chan) {
+             const casa::uInt sample = row * nChan + chan;
+             if (plan.imageChan(sample) < 0) {
+                 continue;
+             }
+             // samples close to the edge are rejected later on, just keep the tile index in range
+             const int tileU = std::min(std::max(plan.iu(sample) / itsSortTileSize, 0), nTilesU - 1);
+             const int tileV = std::min(std::max(plan.iv(sample) / itsSortTileSize, 0), nTilesV - 1);
+             samples.push_back(sample);
+             tiles.push_back(casa::uInt(tileU + nTilesU * tileV));
+        }
+   }
+
+   // two passes of a stable counting sort (least significant key first): by uv-tile and then
+   // by CF plane. This needs much less memory than a single pass with the composite key
+   std::vector<casa::uInt> byTile(samples.size());
+   std::vector<size_t> counts(size_t(nTilesU) * size_t(nTilesV) + 1, 0);
+   for (size_t item = 0; item < tiles.size(); ++item) {
+        ++counts[tiles[item] + 1];
+   }
+   for (size_t key = 1; key < counts.size(); ++key) {
+        counts[key] += counts[key - 1];
+   }
+   for (size_t item = 0; item < samples.size(); ++item) {
+        byTile[counts[tiles[item]]++] = samples[item];
+   }
+
+   itsSampleOrder.resize(byTile.size());
+   counts.assign(itsConvFunc.nPlanes() + 1, 0);
+   for (size_t item = 0; item < byTile.size(); ++item) {
+        const int plane = itsPlanCFPlane[byTile[item] * nImagePols];
+        ASKAPDEBUGASSERT((plane >= 0) && (casa::uInt(plane) < itsConvFunc.nPlanes()));
+        ++counts[plane + 1];
+   }
+   for (size_t key = 1; key < counts.size(); ++key) {
+        counts[key] += counts[key - 1];
+   }
+   for (size_t item = 0; item < byTile.size(); ++item) {
+        itsSampleOrder[counts[itsPlanCFPlane[byTile[item] * nImagePols]]++] = byTile[item];
+   }
+}
+
 /// This is a generic grid/degrid
+/// @details All per-sample bookkeeping (grid coordinates, oversampling offsets, phasors,
+/// noise weights, flagging and frequency mapping) is taken from the gridding plan,
+/// convolution function and grid indices are filled for the whole chunk in advance,
+/// so the main loop just consumes these buffers.
 void TableVisGridder::generic(accessors::IDataAccessor& acc, bool forward) {
    ASKAPDEBUGTRACE("TableVisGridder::generic");
    if (forward&&itsModelIsEmpty)
@@ -418,26 +599,6 @@ void TableVisGridder::generic(accessors::IDataAccessor& acc, bool forward) {
    // Now time the coordinate conversions, etc.
    // some conversion may have already happened during CF calculation
    timer.mark();
-   const casa::MVDirection imageCentre = getImageCentre();
-   const casa::MVDirection tangentPoint = getTangentPoint();
-   
-   // its fine to work with the reference in the openmp case because all our current use cases
-   // have the same tangent point for all gridders, otherwise we have to move this call 
-   // inside the section protected by the lock and make a copy of the returned vector
-   const casa::Vector<casa::RigidVector<double, 3> > &outUVW = acc.rotatedUVW(tangentPoint);
-
-   #ifdef _OPENMP
-   boost::unique_lock<boost::mutex> lock(itsMutex);
-   const casa::Vector<double> delay = acc.uvwRotationDelay(tangentPoint, imageCentre).copy();
-   lock.unlock();
-   #else
-   const casa::Vector<double> &delay = acc.uvwRotationDelay(tangentPoint, imageCentre);
-   #endif
-
-   itsTimeCoordinates += timer.real();
-
-   // Now time the gridding
-   timer.mark();
 
    ASKAPCHECK(itsSupport>0, "Support must be greater than 0");
    ASKAPCHECK(itsUVCellSize.size()==2, "UV cell sizes not yet set");
@@ -459,29 +620,81 @@ void TableVisGridder::generic(accessors::IDataAccessor& acc, bool forward) {
    scimath::PolConverter gridPolConv(acc.stokes(), getStokes());
    scimath::PolConverter degridPolConv(getStokes(),acc.stokes(), false);
    #endif   
-			      
+
+   const GriddingPlan &plan = preparePlan(acc, gridPolConv);
+   itsRowsRejectedDueToMaxPointingSeparation += plan.rowsRejected();
+   if (!forward) {
+       itsVectorsFlagged += plan.samplesSkipped();
+   }
+   itsTimeCoordinates += timer.real();
+
+   timer.mark();
+   fillPlanIndices(plan, forward);
+   itsTimeConvFunctions += timer.real();
+
+   // Now time the gridding
+   timer.mark();
+
+   // number of polarisation planes in the grid
+   const casa::uInt nImagePols = plan.nImagePols();
+   ASKAPCHECK(nPol <= 4, "Only up to 4 polarisation products are supported, you have "<<nPol);
    ASKAPDEBUGASSERT(itsShape.nelements()>=2);
-   const casa::IPosition onePlane4D(4, itsShape(0), itsShape(1), 1, 1);
-   const casa::IPosition onePlane(2, itsShape(0), itsShape(1));
-   
-   // Loop over all samples adding them to the grid
-   // First scale to the correct pixel location
-   // Then find the fraction of a pixel to the nearest pixel
-   // Loop over the entire itsSupport, calculating weights from
-   // the convolution function and adding the scaled
-   // visibility to the grid.
-   
+   const int nx = itsShape(0);
+   const int ny = itsShape(1);
+   const size_t gridPlaneSize = size_t(nx) * size_t(ny);
+   const int cfPlaneSize = itsOverSample * itsOverSample;
    ASKAPDEBUGASSERT(casa::uInt(nChan) <= frequencyList.nelements());
-   ASKAPDEBUGASSERT(casa::uInt(nSamples) == acc.uvw().nelements());
+
+   // visibilities are accessed directly, polarisation products are polStride elements apart
+   const casa::uInt polStride = nSamples * nChan;
+   casa::Cube<casa::Complex> visBuffer;
+   const casa::Complex *visData = 0;
+   casa::Complex *rwVisData = 0;
+   if (forward) {
+       casa::Cube<casa::Complex> &rwVis = acc.rwVisibility();
+       ASKAPDEBUGASSERT(rwVis.shape() == casa::IPosition(3, nSamples, nChan, nPol));
+       if (rwVis.contiguousStorage()) {
+           rwVisData = rwVis.data();
+       } else {
+           visBuffer = rwVis.copy();
+           rwVisData = visBuffer.data();
+       }
+   } else if (!isPSFGridder()) {
+       const casa::Cube<casa::Complex> &vis = acc.visibility();
+       ASKAPDEBUGASSERT(vis.shape() == casa::IPosition(3, nSamples, nChan, nPol));
+       if (vis.contiguousStorage()) {
+           visData = vis.data();
+       } else {
+           visBuffer = vis.copy();
+           visData = visBuffer.data();
+       }
+   }
+
+   // in the multithreaded gridding mode, gridding operations are deferred and collected into
+   // stripes along v. Stripes are 2*itsMaxCFSupport+1 pixels high, so patches belonging to
+   // stripes with the same parity never overlap and can be gridded in parallel
+   const bool tiledGridding = !forward && (itsNThreads > 1);
+   const int tileHeight = 2 * itsMaxCFSupport + 1;
+   std::vector<std::vector<DeferredGridding> > tiles;
+   if (tiledGridding) {
+       tiles.resize(ny / tileHeight + 1);
+   }
    
-   for (uint i=0; i<nSamples; ++i) {
-       if (itsMaxPointingSeparation > 0.) {
-           // need to reject samples, if too far from the image centre
-           const casa::MVDirection thisPointing  = acc.pointingDir1()(i);
-           if (imageCentre.separation(thisPointing) > itsMaxPointingSeparation) {
-               ++itsRowsRejectedDueToMaxPointingSeparation;
-               continue;
-           }
+   // read-only access to the convolution functions, the store is not modified during gridding
+   const ConvFuncStore &cfStore = itsConvFunc;
+
+   // statistics are accumulated locally to allow reduction between threads
+   double samplesProcessed = 0.;
+   double numberProcessed = 0.;
+   
+   // rows to be processed. Only the representative feed and field contribute to the PSF,
+   // they are chosen before the main loop, so the result doesn't depend on the order of samples
+   const int nRows = int(nSamples);
+   std::vector<bool> rowUsed(nSamples, false);
+   for (int i=0; i<nRows; ++i) {
+       if (!plan.rowSelected(i)) {
+           // rejected due to itsMaxPointingSeparation
+           continue;
        }
    
        if (itsFirstGriddedVis && isPSFGridder()) {
@@ -497,231 +710,196 @@ void TableVisGridder::generic(accessors::IDataAccessor& acc, bool forward) {
            }
            itsFirstGriddedVis = false;
        }
-	   
-	   for (uint chan=0; chan<nChan; ++chan) {
-		   
-		   const double reciprocalToWavelength = frequencyList[chan]/casa::C::c;
-		   if (chan == 0) {
-		      // check for ridiculous frequency to pick up a possible error with input file,
-		      // not essential for processing as such
-		      ASKAPCHECK((reciprocalToWavelength>0.1) && (reciprocalToWavelength<30000), 
-		          "Check frequencies in the input file as the order of magnitude is likely to be wrong, "
-		          "comment this statement in the code if you're trying something non-standard. Frequency = "<<
-		          frequencyList[chan]/1e9<<" GHz");
-		   }
-		   
-		   /// Scale U,V to integer pixels plus fractional terms
-		   const double uScaled=frequencyList[chan]*outUVW(i)(0)/(casa::C::c *itsUVCellSize(0));
-		   int iu = askap::nint(uScaled);
-		   int fracu=askap::nint(itsOverSample*(double(iu)-uScaled));
-		   if (fracu<0) {
-                       iu+=1;
-                       fracu += itsOverSample;
-		   } else if (fracu>=itsOverSample) {
-                       iu-=1;
-                       fracu -= itsOverSample;
-		   }
-		   ASKAPCHECK(fracu>-1, "Fractional offset in u is negative, uScaled="<<uScaled<<" iu="<<iu<<" oversample="<<itsOverSample<<" fracu="<<fracu);
-		   ASKAPCHECK(fracu<itsOverSample,
-				   "Fractional offset in u exceeds oversampling, uScaled="<<uScaled<<" iu="<<iu<<" oversample="<<itsOverSample<<" fracu="<<fracu);
-		   iu+=itsShape(0)/2;
-		   
-		   const double vScaled=frequencyList[chan]*outUVW(i)(1)/(casa::C::c *itsUVCellSize(1));
-		   int iv = askap::nint(vScaled);
-		   int fracv=askap::nint(itsOverSample*(double(iv)-vScaled));
-		   if (fracv<0) {
-                       iv+=1;
-                       fracv += itsOverSample;
-		   } else if (fracv>=itsOverSample) {
-                       iv-=1;
-                       fracv -= itsOverSample;
-		   }
-		   ASKAPCHECK(fracv>-1, "Fractional offset in v is negative, vScaled="<<vScaled<<" iv="<<iv<<" oversample="<<itsOverSample<<" fracv="<<fracv);
-		   ASKAPCHECK(fracv<itsOverSample,
-				   "Fractional offset in v exceeds oversampling, vScaled="<<vScaled<<" iv="<<iv<<" oversample="<<itsOverSample<<" fracv="<<fracv);
-		   iv+=itsShape(1)/2;
-		   
-		   // Calculate the delay phasor
-		   const double phase=2.0f*casa::C::pi*frequencyList[chan]*delay(i)/(casa::C::c);
-			          
-		   const casa::Complex phasor(cos(phase), sin(phase));
-		   
-		   bool allPolGood=true;
-		   for (uint pol=0; pol<nPol; ++pol) {
-			   if (acc.flag()(i, chan, pol))
-				   allPolGood=false;
-		   }
-  
-           /*
-           // temporary for debugging
-           if (allPolGood && !itsFreqMapper.isMapped(chan)) {
-              ASKAPLOG_DEBUG_STR(logger, "Channel "<<chan<<" is not mapped to the image cube");       
+       
+       if (isPSFGridder() && !itsUseAllDataForPSF && ((itsFeedUsedForPSF != acc.feed1()(i)) ||
+           (itsPointingUsedForPSF.separation(acc.dishPointing1()(i)) >= 1e-6))) {
+           continue;
+       }
+       rowUsed[i] = true;
+   }
+
+   // samples are either processed in the accessor order (row after row) or in the order
+   // bucketed by CF plane and uv-tile
+   const bool sortedSamples = (itsSortTileSize > 0);
+   if (sortedSamples) {
+       fillSampleOrder(plan, rowUsed);
+   }
+   const int nItems = sortedSamples ? int(itsSampleOrder.size()) : nRows * int(nChan);
+   
+   // samples are processed in batches of consecutive items, in the accessor order a batch
+   // is one row with all its channels. The convolution function lookup is shared between
+   // consecutive samples of the batch which fall on the same CF plane and oversampling offset
+   // (typical for adjacent channels of a spectral line cube)
+   const int batchSize = nChan > 0 ? int(nChan) : 1;
+   const int nBatches = (nItems + batchSize - 1) / batchSize;
+
+   // degridding is parallelised over batches, gridding (i.e. the reverse operation) is
+   // done serially here, but the actual gridding can be deferred (see above)
+   #ifdef _OPENMP
+   #pragma omp parallel for if(forward && (itsNThreads > 1)) num_threads(itsNThreads) schedule(static) \
+           reduction(+:samplesProcessed,numberProcessed)
+   #endif
+   for (int batch=0; batch<nBatches; ++batch) {
+       // convolution function used by the previous sample of the batch for each image polarisation
+       int cachedPlane[4] = {-1, -1, -1, -1};
+       int cachedOverSampleOffset[4] = {-1, -1, -1, -1};
+       const casa::Complex *cachedConvFunc[4] = {0, 0, 0, 0};
+       int cachedSupport[4] = {0, 0, 0, 0};
+       std::pair<int,int> cachedCFOffset[4];
+       const int endItem = std::min(nItems, (batch + 1) * batchSize);
+       for (int item = batch * batchSize; item < endItem; ++item) {
+           const casa::uInt sample = sortedSamples ? itsSampleOrder[item] : casa::uInt(item);
+           const int i = int(sample / nChan);
+           const casa::uInt chan = sample % nChan;
+           if (!rowUsed[i]) {
+               continue;
+           }
+           // obtain which channel of the image this accessor channel is mapped to,
+           // flagged or unmapped samples have a negative image channel
+           const int imageChan = plan.imageChan(sample);
+           if (imageChan < 0) {
+               continue;
+           }
+           const int iu = plan.iu(sample);
+           const int iv = plan.iv(sample);
+           const int overSampleOffset = plan.overSampleOffset(sample);
+           const casa::Complex phasor = plan.phasor(sample);
+
+           // buffers for the visibility vector in the polarisation frame used for the grid and for the data
+           casa::Complex imagePolFrameVis[4];
+           casa::Complex dataPolFrameVis[4];
+       
+           if (forward) {
+               for (uint pol=0; pol<nImagePols; ++pol) {
+                    imagePolFrameVis[pol] = casa::Complex(0.,0.);
+               }
+           } else if (!isPSFGridder()) {
+               gridPolConv.convert(imagePolFrameVis, visData + i + nSamples * chan, polStride);
            }
-           */
-           
-		   // Ensure that we only use unflagged data, incomplete polarisation vectors are 
-		   // ignored
-		   // @todo Be more careful about matching polarizations
-		   if (allPolGood && itsFreqMapper.isMapped(chan)) {
-		     // obtain which channel of the image this accessor channel is mapped to
-		     const int imageChan = itsFreqMapper(chan);
-
-             // number of polarisation planes in the grid
-			 const casa::uInt nImagePols = (shape().nelements()<=2) ? 1 : shape()[2];
-			 
-			 // a buffer for the visibility vector in the polarisation frame used for the grid
-			 casa::Vector<casa::Complex> imagePolFrameVis(nImagePols,casa::Complex(0.,0.));
-             casa::Vector<casa::Complex> imagePolFrameNoise(nImagePols);
-             
-             if (!forward) {
-                 if (!isPSFGridder()) {
-                     imagePolFrameVis = gridPolConv(syncHelper.zVector(acc.visibility(),i,chan));			     
-                 }
-                 // we just don't need this quantity for the forward gridder, although there would be no
-                 // harm to always compute it
-                 imagePolFrameNoise = gridPolConv.noise(syncHelper.zVector(acc.noise(),i,chan));			     
-             }		 
 		     
-            // Now loop over all image polarizations
-            for (uint pol=0; pol<nImagePols; ++pol) {
-	         // Lookup the portion of grid to be
-	         // used for this row, polarisation and channel
-                 const int gInd=gIndex(i, pol, chan);
-	         ASKAPCHECK(gInd>-1,"Index into image grid is less than zero");
-                 ASKAPCHECK(gInd<int(itsGrid.size()), "Index into image grid exceeds number of planes");
-			   			   
-                 /// Make a slicer to extract just this plane
-                 const casa::IPosition ipStart(4, 0, 0, pol, imageChan);
-                 const casa::Slicer slicer(ipStart, onePlane4D);
-			   
-                 // Lookup the convolution function to be
-                 // used for this row, polarisation and channel
-                 // cIndex gives the index for this row, polarization and channel. On top of
-                 // that, we need to adjust for the oversampling since each oversampled
-                 // plane is kept as a separate matrix.
-                 const int beforeOversamplePlaneIndex = cIndex(i,pol,chan);
-                 const int cInd=fracu+itsOverSample*(fracv+itsOverSample*beforeOversamplePlaneIndex);
-                 ASKAPCHECK(cInd>-1,"Index into convolution functions is less than zero");
-                 ASKAPCHECK(cInd<int(itsConvFunc.size()),
-                            "Index into convolution functions exceeds number of planes");
-			   
-                 casa::Matrix<casa::Complex> & convFunc(itsConvFunc[cInd]);
-
-                 // support only square convolution functions at the moment
-                 ASKAPDEBUGASSERT(convFunc.nrow() == convFunc.ncolumn());
-                 ASKAPCHECK(convFunc.nrow() % 2 == 1, 
-                            "Expect convolution function with an odd number of pixels for each axis, CF["<<cInd<<
-                            "] has shape="<<convFunc.shape());
-                 // we now use support size for this given plane in the CF cache; itsSupport is a maximum
-                 // support across all CFs (this allows plane-dependent support size)      
-                 const int support = (int(convFunc.nrow()) - 1) / 2;
-                 ASKAPCHECK(support > 0, "Support must be greater than zero, CF["<<cInd<<"] has shape="<<
-                            convFunc.shape()<<" giving a support of "<<support);
-                
-                 casa::Array<casa::Complex> aGrid(itsGrid[gInd](slicer));
-                 casa::Matrix<casa::Complex> grid(aGrid.nonDegenerate());
-  
-                 // the following accounts for a possible offset of the convolution function
-                 const std::pair<int,int> cfOffset = getConvFuncOffset(beforeOversamplePlaneIndex);
-                 const int iuOffset = iu + cfOffset.first;
-                 const int ivOffset = iv + cfOffset.second;
-
-                 
-                 
-                 /*
-                 if (isPSFGridder()) {
-                     if (i!=0) continue;
-                     std::cout<<"sample "<<i<<" iu="<<iu<<" uScaled="<<uScaled<<" fracu="<<fracu<<" "<<
-                            "iv="<<iv<<" vScaled="<<vScaled<<" fracv="<<fracv<<
-                            " wplane="<<beforeOversamplePlaneIndex<<std::endl;
-                 }
-                 */
-                 
+           // Now loop over all image polarizations
+           for (uint pol=0; pol<nImagePols; ++pol) {
+                const casa::uInt index = sample * nImagePols + pol;
+                const int gInd = itsPlanGridIndex[index];
+                const int beforeOversamplePlaneIndex = itsPlanCFPlane[index];
+                const int cInd = overSampleOffset + cfPlaneSize * beforeOversamplePlaneIndex;
+                if ((beforeOversamplePlaneIndex != cachedPlane[pol]) || (overSampleOffset != cachedOverSampleOffset[pol])) {
+                    cachedPlane[pol] = beforeOversamplePlaneIndex;
+                    cachedOverSampleOffset[pol] = overSampleOffset;
+                    cachedConvFunc[pol] = cfStore.data(beforeOversamplePlaneIndex, overSampleOffset);
+                    cachedSupport[pol] = cfStore.support(beforeOversamplePlaneIndex);
+                    // the following accounts for a possible offset of the convolution function
+                    cachedCFOffset[pol] = cfStore.offset(beforeOversamplePlaneIndex);
+                }
+                const casa::Complex *convFunc = cachedConvFunc[pol];
+                const int support = cachedSupport[pol];
+                const int cfStride = 2 * support + 1;
+                const std::pair<int,int> &cfOffset = cachedCFOffset[pol];
+                const int iuOffset = iu + cfOffset.first;
+                const int ivOffset = iv + cfOffset.second;
 			   
-                 /// Need to check if this point lies on the grid (taking into 
-                 /// account the support)
-	         if (((iuOffset-support)>0)&&((ivOffset-support)>0)&&
-	             ((iuOffset+support) <itsShape(0))&&((ivOffset+support)<itsShape(1))) {
-                     if (forward) {
-                         casa::Complex cVis(0.,0.);
-                         GridKernel::degrid(cVis, convFunc, grid, iuOffset, ivOffset, support);
-                         itsSamplesDegridded+=1.0;
-                         itsNumberDegridded+=double((2*support+1)*(2*support+1));
-                         if (itsVisWeight) {
-                             cVis *= itsVisWeight->getWeight(i,frequencyList[chan],pol);
-                         }
-                         imagePolFrameVis[pol] += cVis*phasor;
-                     } else {
-                         const casa::Complex visComplexNoise = imagePolFrameNoise[pol];
-                          
-                         const float visNoise = casa::square(casa::real(visComplexNoise));
-                         //const float visNoise = casa::norm(visComplexNoise);
-                         const float visNoiseWt = (visNoise > 0.) ? 1./visNoise : 0.;
-                         ASKAPCHECK(visNoiseWt>0., "Weight is supposed to be a positive number; visNoiseWt="<<
-                                    visNoiseWt<<" visNoise="<<visNoise<<" visComplexNoise="<<visComplexNoise);
-                         
-                         // row in itsSumWeights to work with
-                         const int sumWeightsRow = itsTrackWeightPerOversamplePlane ? cInd : beforeOversamplePlaneIndex;
-      
-                         ASKAPCHECK(itsSumWeights.nelements()>0, "Sum of weights not yet initialised");
-                         ASKAPDEBUGASSERT(itsSumWeights.shape().nelements() >= 3);
-                         ASKAPCHECK(sumWeightsRow < int(itsSumWeights.shape()(0)),
-                                    "Index into itsSumWeights of " << sumWeightsRow << " is greater than allowed " << 
-                                     int(itsSumWeights.shape()(0)));
-                         ASKAPDEBUGASSERT(pol < uint(itsSumWeights.shape()(1)));
-                         ASKAPDEBUGASSERT(imageChan < int(itsSumWeights.shape()(2)));
-                                  
-                         if (!isPSFGridder()) {
-                             /// Gridding visibility data onto grid
-                             casa::Complex rVis = phasor*conj(imagePolFrameVis[pol])*visNoiseWt;
-                             if (itsVisWeight) {
-                                 rVis *= itsVisWeight->getWeight(i,frequencyList[chan],pol);
-                             }
-				   
-                             GridKernel::grid(grid, convFunc, rVis, iuOffset, ivOffset, support);
+                /// Need to check if this point lies on the grid (taking into 
+                /// account the support)
+                if (((iuOffset-support)>0)&&((ivOffset-support)>0)&&
+                    ((iuOffset+support) <nx)&&((ivOffset+support)<ny)) {
+                    // first pixel of the patch affected by this sample
+                    casa::Complex *gridPtr = itsGrid[gInd].data() + gridPlaneSize * (pol + nImagePols * imageChan) +
+                                             (iuOffset - support) + size_t(nx) * (ivOffset - support);
+                    if (forward) {
+                        casa::Complex cVis = itsKernel.degrid(gridPtr, nx, convFunc, cfStride, support);
+                        samplesProcessed+=1.0;
+                        numberProcessed+=double((2*support+1)*(2*support+1));
+                        if (itsVisWeight) {
+                            cVis *= itsVisWeight->getWeight(i,frequencyList[chan],pol);
+                        }
+                        imagePolFrameVis[pol] += cVis*phasor;
+                    } else {
+                        const float visNoiseWt = plan.noiseWeight(sample, pol);
+                        ASKAPCHECK(visNoiseWt>0., "Weight is supposed to be a positive number; visNoiseWt="<<
+                                   visNoiseWt<<" for row="<<i<<" chan="<<chan<<" pol="<<pol);
+                    
+                        // row in itsSumWeights to work with
+                        const int sumWeightsRow = itsTrackWeightPerOversamplePlane ? cInd : beforeOversamplePlaneIndex;
+                             
+                        /// Gridding visibility data (or unit visibility for PSF) onto grid
+                        casa::Complex rVis = isPSFGridder() ? casa::Complex(visNoiseWt, 0.) :
+                                             phasor*conj(imagePolFrameVis[pol])*visNoiseWt;
+                        if (itsVisWeight) {
+                            rVis *= itsVisWeight->getWeight(i,frequencyList[chan],pol);
+                        }
+                        if (tiledGridding) {
+                            const int tile = (ivOffset - support) / tileHeight;
+                            ASKAPDEBUGASSERT(tile < int(tiles.size()));
+                            tiles[tile].push_back(DeferredGridding(gridPtr, convFunc, cfStride, support, rVis));
+                        } else {
+                            itsKernel.grid(gridPtr, nx, convFunc, cfStride, rVis, support);
+                        }
           
-                             itsSamplesGridded+=1.0;
-                             itsNumberGridded+=double((2*support+1)*(2*support+1));
+                        samplesProcessed+=1.0;
+                        numberProcessed+=double((2*support+1)*(2*support+1));
       
-                             itsSumWeights(sumWeightsRow, pol, imageChan) += visNoiseWt; //1.0;
-                         }
-                         /// Grid PSF?
-                         if (isPSFGridder() && (itsUseAllDataForPSF || ((itsFeedUsedForPSF == acc.feed1()(i)) &&
-                             (itsPointingUsedForPSF.separation(acc.dishPointing1()(i))<1e-6)))) {
-                              casa::Complex uVis(1.,0.);
-                              uVis *= visNoiseWt;
-                              if (itsVisWeight) {
-                                  uVis *= itsVisWeight->getWeight(i,frequencyList[chan],pol);
-                              }
-                              GridKernel::grid(grid, convFunc, uVis, iuOffset, ivOffset, support);
-                      
-                              itsSamplesGridded+=1.0;
-                              itsNumberGridded+=double((2*support+1)*(2*support+1));
-    
-                              itsSumWeights(sumWeightsRow, pol, imageChan) += visNoiseWt; //1.0;               
-                         } // end if psf needs to be done
-		     } // end if forward (else case, reverse operation)
-                 } // end of on-grid if statement
-            }//end of pol loop
-	    // need to write back the result for degridding
-            if (forward) {
-                casa::Vector<casa::Complex> thisPolVector = acc.rwVisibility().yzPlane(i).row(chan);
-	            thisPolVector += degridPolConv(imagePolFrameVis);
-            }		     
-         } else { 
-            if (!forward) {
-                itsVectorsFlagged+=1;
-	    } 
-         } // end of if (allPolGood), else statement
-      }//end of chan loop
-   }//end of i loop
+                        itsSumWeights(sumWeightsRow, pol, imageChan) += visNoiseWt; //1.0;
+                    } // end if forward (else case, reverse operation)
+                } // end of on-grid if statement
+           }//end of pol loop
+           // need to write back the result for degridding
+           if (forward) {
+               degridPolConv.convert(dataPolFrameVis, imagePolFrameVis);
+               casa::Complex *thisPolVector = rwVisData + i + nSamples * chan;
+               for (uint pol=0; pol<nPol; ++pol) {
+                    thisPolVector[pol * polStride] += dataPolFrameVis[pol];
+               }
+           }		     
+       }//end of sample loop
+   }//end of batch loop
+   
+   if (tiledGridding) {
+       // all even stripes first, then all odd ones. The order of samples within each stripe
+       // is preserved, so the result doesn't depend on the number of threads
+       const int nTiles = int(tiles.size());
+       for (int parity = 0; parity < 2; ++parity) {
+            #ifdef _OPENMP
+            #pragma omp parallel for num_threads(itsNThreads) schedule(dynamic)
+            #endif
+            for (int tile = parity; tile < nTiles; tile += 2) {
+                 const std::vector<DeferredGridding> &items = tiles[tile];
+                 for (std::vector<DeferredGridding>::const_iterator ci = items.begin(); ci != items.end(); ++ci) {
+                      itsKernel.grid(ci->itsGrid, nx, ci->itsConvFunc, ci->itsCFStride, ci->itsVis, ci->itsSupport);
+                 }
+            }
+       }
+   }
+   
    if (forward) {
+       if (visBuffer.nelements() > 0) {
+           // visibility cube wasn't contiguous, copy the result back
+           acc.rwVisibility() = visBuffer;
+       }
+       itsSamplesDegridded += samplesProcessed;
+       itsNumberDegridded += numberProcessed;
        itsTimeDegridded+=timer.real();
    } else {
+       itsSamplesGridded += samplesProcessed;
+       itsNumberGridded += numberProcessed;
        itsTimeGridded+=timer.real();
    }
 }
 
+/// @brief set the number of threads used for gridding and degridding
+/// @details See the header for the description of the multithreaded mode.
+/// @param[in] nThreads number of threads (should be positive)
+void TableVisGridder::setNumberOfThreads(const int nThreads)
+{
+   ASKAPCHECK(nThreads > 0, "Number of gridding threads should be positive, you have "<<nThreads);
+#ifndef _OPENMP
+   if (nThreads > 1) {
+       ASKAPLOG_WARN_STR(logger, "The code has been built without OpenMP, gridding stripes will be processed "
+                         "by a single thread instead of "<<nThreads);
+   }
+#endif
+   itsNThreads = nThreads;
+}
+
 /// @brief correct visibilities, if necessary
 /// @details This method is intended for on-the-fly correction of visibilities (i.e. 
 /// facet-based correction needed for LOFAR). This method does nothing in this class, but
@@ -817,6 +995,42 @@ void TableVisGridder::toDouble(casa::Array<double>& out,
   out = real(subImage);
 }
 
+/// @brief Conversion helper function
+/// @details Single precision version of toComplex
+/// @param[out] out complex output array
+/// @param[in] in double input array
+/// @param[in] padding padding factor
+void TableVisGridder::toComplex(casa::Array<casa::Complex>& out,
+		const casa::Array<double>& in, const float padding) {	
+    ASKAPDEBUGTRACE("TableVisGridder::toComplex");
+
+    out.resize(scimath::PaddingUtils::paddedShape(in.shape(),padding));
+    out.set(0.);
+    casa::Array<casa::Complex> subImage = scimath::PaddingUtils::extract(out,padding);
+    ASKAPDEBUGASSERT(subImage.shape() == in.shape());
+    casa::Array<double>::const_iterator inIt = in.begin();
+    for (casa::Array<casa::Complex>::iterator it = subImage.begin(); it != subImage.end(); ++it, ++inIt) {
+         *it = casa::Complex(float(*inIt), 0.);
+    }
+}
+
+/// @brief Conversion helper function
+/// @details Single precision version of toDouble
+/// @param[out] out real output array
+/// @param[in] in complex input array
+/// @param[in] padding padding factor      
+void TableVisGridder::toDouble(casa::Array<double>& out,
+		const casa::Array<casa::Complex>& in, const float padding) {
+  ASKAPDEBUGTRACE("TableVisGridder::toDouble");
+  casa::Array<casa::Complex> wrapper(in);
+  const casa::Array<casa::Complex> subImage = scimath::PaddingUtils::extract(wrapper,padding);
+  out.resize(subImage.shape());
+  casa::Array<double>::iterator outIt = out.begin();
+  for (casa::Array<casa::Complex>::const_iterator it = subImage.begin(); it != subImage.end(); ++it, ++outIt) {
+       *outIt = double(casa::real(*it));
+  }
+}
+
 /// @brief set up itsStokes using the information from itsAxes and itsShape
 void TableVisGridder::initStokes()
 {
@@ -950,6 +1164,19 @@ void TableVisGridder::finaliseGrid(casa::Array<double>& out) {
 
     /// Loop over all grids Fourier transforming and accumulating
 	for (unsigned int i=0; i<itsGrid.size(); i++) {
+	    if (itsSinglePrecision) {
+	        // the grid is transformed in its native precision, only the image is accumulated in double
+	        casa::Array<casa::Complex> scratch(itsGrid[i].copy());
+	        fft2d(scratch, false);
+	        if (i==0) {
+	            toDouble(dBuffer, scratch);
+	        } else {
+	            casa::Array<double> work(dBuffer.shape());
+	            toDouble(work, scratch);
+	            dBuffer+=work;
+	        }
+	        continue;
+	    }
 	    casa::Array<casa::DComplex> scratch(itsGrid[i].shape());
 	    casa::convertArray<casa::DComplex,casa::Complex>(scratch, itsGrid[i]);
 
@@ -1079,10 +1306,16 @@ void TableVisGridder::initialiseDegrid(const scimath::Axes& axes,
 		casa::Array<double> scratch(itsShape,0.);
 		scimath::PaddingUtils::extract(scratch, paddingFactor()) = in;
 		correctConvolution(scratch);
-		casa::Array<casa::DComplex> scratch2(itsGrid[0].shape());
-		toComplex(scratch2, scratch);
-		fft2d(scratch2, true);
-		casa::convertArray<casa::Complex,casa::DComplex>(itsGrid[0],scratch2);
+		if (itsSinglePrecision) {
+		    // no need in a double precision scratch array, the model is transformed in the grid itself
+		    toComplex(itsGrid[0], scratch);
+		    fft2d(itsGrid[0], true);
+		} else {
+		    casa::Array<casa::DComplex> scratch2(itsGrid[0].shape());
+		    toComplex(scratch2, scratch);
+		    fft2d(scratch2, true);
+		    casa::convertArray<casa::Complex,casa::DComplex>(itsGrid[0],scratch2);
+		}
 	} else {
 		ASKAPLOG_DEBUG_STR(logger, "No need to degrid: model is empty");
 		itsModelIsEmpty=true;
@@ -1194,10 +1427,7 @@ int TableVisGridder::gIndex(int /*row*/, int /*pol*/, int /*chan*/) {
 std::pair<int,int> TableVisGridder::getConvFuncOffset(int cfPlane) const
 {
   ASKAPDEBUGASSERT(cfPlane>=0);
-  if (cfPlane >= int(itsConvFuncOffsets.size())) {
-      return std::pair<int,int>(0,0);
-  }
-  return itsConvFuncOffsets[cfPlane];
+  return itsConvFunc.offset(casa::uInt(cfPlane));
 }
       
 /// @brief initialise convolution function offsets for a given number of planes
@@ -1205,11 +1435,7 @@ std::pair<int,int> TableVisGridder::getConvFuncOffset(int cfPlane) const
 /// @param[in] nPlanes number of planes in the cache 
 void TableVisGridder::initConvFuncOffsets(size_t nPlanes)
 {
-  itsConvFuncOffsets.resize(nPlanes);
-  for (std::vector<std::pair<int,int> >::iterator it = itsConvFuncOffsets.begin(); it != itsConvFuncOffsets.end(); ++it) {
-       it->first = 0;
-       it->second = 0;
-  }
+  itsConvFunc.initOffsets(nPlanes);
 }
       
 /// @brief Assign offset to a particular convolution function
@@ -1221,9 +1447,7 @@ void TableVisGridder::initConvFuncOffsets(size_t nPlanes)
 void TableVisGridder::setConvFuncOffset(int cfPlane, int x, int y)
 {
   ASKAPDEBUGASSERT(cfPlane>=0);
-  ASKAPCHECK(cfPlane < int(itsConvFuncOffsets.size()), "An attempt to set offset for plane (before oversampling) "<<
-             cfPlane<<" while the buffer has been initialised to handle "<<itsConvFuncOffsets.size()<<" planes only");
-  itsConvFuncOffsets[cfPlane] = std::pair<int,int>(x,y);
+  itsConvFunc.setOffset(casa::uInt(cfPlane), x, y);
 }
 
 /// @brief check whether the model is empty
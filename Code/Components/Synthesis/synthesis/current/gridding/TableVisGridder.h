@@ -36,18 +36,18 @@
 #include <gridding/VisGridderWithPadding.h>
 #include <dataaccess/IDataAccessor.h>
 #include <gridding/FrequencyMapper.h>
+#include <gridding/GriddingPlan.h>
+#include <gridding/ConvFuncStore.h>
+#include <gridding/GridKernel.h>
+#include <utils/PolConverter.h>
 
 // std includes
 #include <string>
+#include <vector>
 
 // casa includes
 #include <casa/BasicSL/Complex.h>
 
-#ifdef _OPENMP
-// boost includes
-#include <boost/thread/mutex.hpp>
-#endif
-
 namespace askap
 {
   namespace synthesis
@@ -185,6 +185,76 @@ namespace askap
       /// is empty (all pixels are zero). This makes sense for degridding only.
       /// @brief true, if the model is empty
       virtual bool isModelEmpty() const; 
+
+      /// @brief set the gridding plan shared with other gridders
+      /// @details The plan holds per-sample information (grid coordinates, phasors, noise
+      /// weights, etc) which depends only on the data chunk and the geometry of the grid.
+      /// A number of gridders working with the same image and the same chunk (i.e. model
+      /// degridding, residual and PSF gridding) can share a single plan, so it is computed
+      /// just once. The owner of the plan is responsible for invalidating it every time the
+      /// accessor changes. If the shared plan doesn't match this gridder (e.g. a PSF gridder
+      /// with different oversampling), the gridder silently uses its own plan instead.
+      /// @param[in] plan shared pointer to the plan, an empty pointer detaches the shared plan
+      void inline setGriddingPlan(const GriddingPlan::ShPtr &plan = GriddingPlan::ShPtr())
+          { itsSharedPlan = plan; }
+
+      /// @brief set the number of threads used for gridding and degridding
+      /// @details Degridding is parallelised over accessor rows. For gridding, the grid is
+      /// split into stripes along v which are exactly 2*maxSupport+1 pixels high, where maxSupport
+      /// is the largest support of the convolution functions. Samples are assigned to stripes by
+      /// the first row of their patch and then all even stripes followed by all odd stripes are
+      /// processed in parallel. As a patch is at most 2*maxSupport+1 pixels high, patches of a stripe
+      /// only touch this stripe and the next one. Therefore, patches of stripes with the same parity
+      /// never overlap. The order of the samples within a stripe is preserved, so the result
+      /// doesn't depend on the number of
+      /// threads (but may differ from the serial code at the level of rounding errors, because
+      /// the order of summation is different). The default of one thread means the serial code.
+      /// Without OpenMP, the stripes are still used for gridding (so the result is the same as
+      /// in the OpenMP build), but all of them are processed by the calling thread.
+      /// @param[in] nThreads number of threads (should be positive)
+      void setNumberOfThreads(const int nThreads);
+
+      /// @brief obtain the number of threads used for gridding and degridding
+      /// @return number of threads
+      int inline numberOfThreads() const { return itsNThreads; }
+
+      /// @brief set up ordering of samples before gridding
+      /// @details By default, samples are gridded in the order of the accessor, i.e. baseline after
+      /// baseline. Consecutive samples then land far apart on the grid and use different convolution
+      /// functions. If the tile size is positive, samples of each chunk are bucketed by convolution
+      /// function plane (e.g. w-plane) and then by square uv-tiles of the given size in pixels
+      /// before gridding or degridding, so each convolution function and grid tile stays in cache
+      /// while it is used. The result is the same to within rounding errors (order of summation).
+      /// @param[in] tileSize size of uv-tiles in pixels, zero or negative number disables sorting
+      void inline setSampleSortingTileSize(const int tileSize) { itsSortTileSize = tileSize > 0 ? tileSize : 0; }
+
+      /// @brief obtain tile size used for sample ordering
+      /// @return size of uv-tiles in pixels, zero if sorting is not used
+      int inline sampleSortingTileSize() const { return itsSortTileSize; }
+
+      /// @brief set precision of the image-plane part of gridding
+      /// @details Grids are always accumulated in single precision, but by default they are
+      /// converted to double precision before the FFT in finaliseGrid and the model is
+      /// transformed in double precision in initialiseDegrid. In the single precision mode,
+      /// FFTs are done on single precision arrays and only the resulting image is converted to
+      /// double. This halves the size of the scratch arrays at the expense of the accuracy
+      /// (the relative error is of the order of 1e-6 of the peak).
+      /// @param[in] single true to use single precision FFTs
+      void inline setSinglePrecision(const bool single) { itsSinglePrecision = single; }
+
+      /// @brief check whether single precision FFTs are used
+      /// @return true, if FFTs are done in single precision
+      bool inline isSinglePrecision() const { return itsSinglePrecision; }
+
+      /// @brief select gridding/degridding kernel
+      /// @details The kernel is specific to this gridder (and its clones), the default is
+      /// the fastest kernel supported by the CPU. See GridKernel for the allowed names.
+      /// @param[in] name name of the kernel
+      void inline setKernel(const std::string &name) { itsKernel = GridKernel(name); }
+
+      /// @brief obtain the gridding/degridding kernel
+      /// @return const reference to the kernel used by this gridder
+      const GridKernel& kernel() const { return itsKernel; }
       
   protected:
       /// @brief helper method to print CF cache stats in the log
@@ -315,9 +385,11 @@ namespace askap
 protected:      
 
       /// @brief Convolution function
-      /// The convolution function is stored as a vector of arrays so that we can
-      /// use any of a number of functions. The index is calculated by cIndex.
-      std::vector<casa::Matrix<casa::Complex> > itsConvFunc;
+      /// The convolution functions for all planes and oversampling offsets are kept in
+      /// one contiguous store, so that we can use any of a number of functions. The plane
+      /// is given by cIndex, the flat index of an oversampled function is
+      /// fracu + overSample*(fracv + overSample*plane). The store also holds the offsets.
+      ConvFuncStore itsConvFunc;
 
       /// @brief Obtain offset for the given convolution function
       /// @details To conserve memory and speed the gridding up, convolution functions stored in the cache
@@ -390,6 +462,22 @@ protected:
       static void toDouble(casa::Array<double>& out, const casa::Array<casa::DComplex>& in,
                     const float padding = 1.);
 
+      /// @brief Conversion helper function
+      /// @details Single precision version of toComplex
+      /// @param[out] out complex output array
+      /// @param[in] in double input array
+      /// @param[in] padding padding factor
+      static void toComplex(casa::Array<casa::Complex>& out, const casa::Array<double>& in, 
+                     const float padding = 1.);
+
+      /// @brief Conversion helper function
+      /// @details Single precision version of toDouble
+      /// @param[out] out real output array
+      /// @param[in] in complex input array      
+      /// @param[in] padding padding factor
+      static void toDouble(casa::Array<double>& out, const casa::Array<casa::Complex>& in,
+                     const float padding = 1.);
+
       /// @brief a helper method to initialize gridding of the PSF
       /// @details The PSF is calculated using the data for a
       /// representative field/feed only. By default, the first encountered
@@ -478,6 +566,32 @@ protected:
       /// constness properly.
       void generic(accessors::IDataAccessor& acc, bool forward);
 
+      /// @brief obtain the gridding plan for the given accessor
+      /// @details The shared plan is used if it has been set up and matches the geometry of this
+      /// gridder, otherwise the plan owned by this gridder is rebuilt for the given accessor.
+      /// @param[in] acc data accessor
+      /// @param[in] gridPolConv polarisation converter from the accessor frame to the grid frame
+      /// @return const reference to the plan ready to use
+      const GriddingPlan& preparePlan(const accessors::IConstDataAccessor &acc,
+                                      const scimath::PolConverter &gridPolConv);
+
+      /// @brief fill convolution function and grid indices for the current chunk
+      /// @details This method evaluates cIndex and gIndex for every sample and image polarisation
+      /// used by the plan and does all the bounds checks, so the main loop of generic can
+      /// work without them.
+      /// @param[in] plan gridding plan for the current chunk
+      /// @param[in] forward true for degridding, false for gridding
+      void fillPlanIndices(const GriddingPlan &plan, bool forward);
+
+      /// @brief fill the order in which samples of the current chunk are processed
+      /// @details Samples are bucketed by convolution function plane (of the first image
+      /// polarisation) and then by uv-tile (counting sort, so the accessor order is preserved
+      /// within each bucket). Only samples which are gridded are included.
+      /// This method uses buffers filled by fillPlanIndices.
+      /// @param[in] plan gridding plan for the current chunk
+      /// @param[in] rowUsed flags for each row, false if the row is to be skipped entirely
+      void fillSampleOrder(const GriddingPlan &plan, const std::vector<bool> &rowUsed);
+
       /// Visibility Weights
       IVisWeights::ShPtr itsVisWeight;
 
@@ -525,23 +639,43 @@ protected:
       /// @details Accumulated to get proper statistics/debugging info.
       long itsRowsRejectedDueToMaxPointingSeparation;
       
-      /// @brief offsets of convolution functions
-      /// @details To conserve memory and speed the gridding up, convolution functions stored in the cache
-      /// may have an offset (i.e. essentially each CF should be defined on a bigger support and placed at a 
-      /// pixel other than the centre of this support). This data field defines this offset, which is the
-      /// position of the peak of the given CF on a bigger support w.r.t. the centre of this support. 
-      /// The value of (0,0) means no offset from the centre (i.e. support is already centred). If the index
-      /// of CF is beyond the size of this vector, (0,0) offset is assumed. By default this vector is empty,
-      /// which means no offset. 
-      std::vector<std::pair<int,int> > itsConvFuncOffsets;
-      
       /// @brief true, if itsSumWeights tracks weights per oversampling plane
       bool itsTrackWeightPerOversamplePlane;
 
-      #ifdef _OPENMP
-      /// @brief synchronisation mutex
-      mutable boost::mutex itsMutex;
-      #endif
+      /// @brief gridding plan shared with other gridders (may be empty)
+      GriddingPlan::ShPtr itsSharedPlan;
+
+      /// @brief gridding plan owned by this gridder
+      /// @details Used if no shared plan is set or if it doesn't match this gridder. Created
+      /// on demand and reused for subsequent chunks to avoid reallocation of the buffers.
+      GriddingPlan::ShPtr itsOwnPlan;
+
+      /// @brief convolution function plane (before oversampling) for each sample and image polarisation
+      std::vector<int> itsPlanCFPlane;
+
+      /// @brief grid index for each sample and image polarisation
+      std::vector<int> itsPlanGridIndex;
+
+      /// @brief number of threads used for gridding and degridding
+      /// @details One (default) means the original serial code path.
+      int itsNThreads;
+
+      /// @brief largest support in the CF cache
+      /// @details Used to define the height of the tiles in the multithreaded gridding
+      int itsMaxCFSupport;
+
+      /// @brief size of uv-tiles used to order samples (zero if samples are not sorted)
+      int itsSortTileSize;
+
+      /// @brief true if FFTs in finaliseGrid and initialiseDegrid are done in single precision
+      bool itsSinglePrecision;
+
+      /// @brief gridding/degridding kernel
+      GridKernel itsKernel;
+
+      /// @brief samples (row*nChan+chan) of the current chunk in the order of processing
+      /// @details Only filled if samples are sorted.
+      std::vector<casa::uInt> itsSampleOrder;
     };
   }
 }
@@ -44,6 +44,7 @@ ASKAP_LOGGER(logger, ".gridding.visgridderfactory");
 #include <gridding/SnapShotImagingGridderAdapter.h>
 #include <gridding/SmearingGridderAdapter.h>
 #include <gridding/VisWeightsMultiFrequency.h>
+#include <gridding/GridKernel.h>
 #include <measurementequation/SynthesisParamsHelper.h>
 
 namespace askap {
@@ -149,6 +150,19 @@ IVisGridder::ShPtr VisGridderFactory::make(const LOFAR::ParameterSet &parset) {
                                      ", all data will be used");
     }
     
+    {
+        // the kernel is selected per gridder, other gridders are not affected
+        boost::shared_ptr<TableVisGridder> tvg = 
+            boost::dynamic_pointer_cast<TableVisGridder>(gridder);
+        if (parset.isDefined("gridder.kernel")) {
+            ASKAPCHECK(tvg, "Gridder type ("<<gridderName<<") is incompatible with the kernel option");
+            tvg->setKernel(parset.getString("gridder.kernel"));
+        }
+        if (tvg) {
+            ASKAPLOG_INFO_STR(logger, tvg->kernel().info());
+        }
+    }
+
 	if (parset.isDefined("gridder.alldatapsf")) {
 	    const bool useAll = parset.getBool("gridder.alldatapsf");
 	    if (useAll) {
@@ -181,6 +195,41 @@ IVisGridder::ShPtr VisGridderFactory::make(const LOFAR::ParameterSet &parset) {
 	              ") is incompatible with the oversampleweight option (trying to set it to "<<osWeight<<")");
 	   }
 	}	
+
+	if (parset.isDefined("gridder.nthreads")) {
+	    const int nThreads = parset.getInt32("gridder.nthreads");
+	    ASKAPLOG_INFO_STR(logger, "Gridding and degridding will use "<<nThreads<<" thread(s)");
+	    boost::shared_ptr<TableVisGridder> tvg = 
+	        boost::dynamic_pointer_cast<TableVisGridder>(gridder);
+	    ASKAPCHECK(tvg, "Gridder type ("<<parset.getString("gridder")<<
+	               ") is incompatible with the nthreads option");
+	    tvg->setNumberOfThreads(nThreads);
+	}
+
+	if (parset.isDefined("gridder.sorttile")) {
+	    const int tileSize = parset.getInt32("gridder.sorttile");
+	    if (tileSize > 0) {
+	        ASKAPLOG_INFO_STR(logger, "Samples will be ordered by CF plane and "<<tileSize<<"x"<<tileSize<<
+	                          " pixel uv-tiles before gridding");
+	    }
+	    boost::shared_ptr<TableVisGridder> tvg = 
+	        boost::dynamic_pointer_cast<TableVisGridder>(gridder);
+	    ASKAPCHECK(tvg, "Gridder type ("<<parset.getString("gridder")<<
+	               ") is incompatible with the sorttile option");
+	    tvg->setSampleSortingTileSize(tileSize);
+	}
+
+	if (parset.isDefined("gridder.precision")) {
+	    const std::string precision = parset.getString("gridder.precision");
+	    ASKAPCHECK((precision == "single") || (precision == "double"), 
+	               "gridder.precision is supposed to be either single or double, you have "<<precision);
+	    ASKAPLOG_INFO_STR(logger, "FFTs between grids and images will be done in "<<precision<<" precision");
+	    boost::shared_ptr<TableVisGridder> tvg = 
+	        boost::dynamic_pointer_cast<TableVisGridder>(gridder);
+	    ASKAPCHECK(tvg, "Gridder type ("<<parset.getString("gridder")<<
+	               ") is incompatible with the precision option");
+	    tvg->setSinglePrecision(precision == "single");
+	}
 	
 	// Initialize the Visibility Weights
 	if (parset.getString("visweights","")=="MFS")
@@ -26,6 +26,10 @@
 
 // System includes
 #include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
 
 // ASKAPsoft includes
 #include <askap/AskapLogging.h>
@@ -36,6 +40,12 @@
 #include <casa/BasicSL/Constants.h>
 #include <fft/FFTWrapper.h>
 #include <profile/AskapProfiler.h>
+#include <Blob/BlobString.h>
+#include <Blob/BlobIBufString.h>
+#include <Blob/BlobOBufString.h>
+#include <Blob/BlobIStream.h>
+#include <Blob/BlobOStream.h>
+#include <Blob/BlobArray.h>
 
 // Local package includes
 #include <gridding/WProjectVisGridder.h>
@@ -55,7 +65,9 @@ WProjectVisGridder::WProjectVisGridder(const double wmax,
                                        const std::string& name) :
         WDependentGridderBase(wmax, nwplanes),
         itsMaxSupport(maxSupport), itsCutoff(cutoff), itsLimitSupport(limitSupport),
-        itsPlaneDependentCFSupport(false), itsOffsetSupportAllowed(false), itsCutoffAbs(false)
+        itsPlaneDependentCFSupport(false), itsOffsetSupportAllowed(false), itsCutoffAbs(false),
+        itsLazyCF(false), itsCFMemoryBudget(0), itsCFUseCounter(0), itsNWPlanesGenerated(0),
+        itsNWPlanesLoaded(0), itsNWPlanesEvicted(0)
 {
     ASKAPCHECK(overSample > 0, "Oversampling must be greater than 0");
     ASKAPCHECK(maxSupport > 0, "Maximum support must be greater than 0")
@@ -63,11 +75,15 @@ WProjectVisGridder::WProjectVisGridder(const double wmax,
     itsOverSample = overSample;
     setTableName(name);
 
-    itsConvFunc.resize(nWPlanes()*itsOverSample*itsOverSample);
+    itsConvFunc.init(nWPlanes(), itsOverSample);
 }
 
 WProjectVisGridder::~WProjectVisGridder()
 {
+    if (isCFCacheLazy() && (itsNWPlanesGenerated + itsNWPlanesLoaded > 0)) {
+        ASKAPLOG_DEBUG_STR(logger, "On-demand CF cache: " << itsNWPlanesGenerated << " w-planes generated, " <<
+                           itsNWPlanesLoaded << " loaded from disk, " << itsNWPlanesEvicted << " evicted");
+    }
 }
 
 /// @brief copy constructor
@@ -80,7 +96,10 @@ WProjectVisGridder::WProjectVisGridder(const WProjectVisGridder &other) :
         itsCutoff(other.itsCutoff), itsLimitSupport(other.itsLimitSupport),
         itsPlaneDependentCFSupport(other.itsPlaneDependentCFSupport),
         itsOffsetSupportAllowed(other.itsOffsetSupportAllowed),
-        itsCutoffAbs(other.itsCutoffAbs) {}
+        itsCutoffAbs(other.itsCutoffAbs), itsLazyCF(other.itsLazyCF),
+        itsCFMemoryBudget(other.itsCFMemoryBudget), itsCFCacheDir(other.itsCFCacheDir),
+        itsWPlaneLastUse(other.itsWPlaneLastUse), itsCFUseCounter(other.itsCFUseCounter),
+        itsNWPlanesGenerated(0), itsNWPlanesLoaded(0), itsNWPlanesEvicted(0) {}
 
 
 /// Clone a copy of this Gridder
@@ -146,6 +165,10 @@ void WProjectVisGridder::initConvolutionFunction(const accessors::IConstDataAcce
     /// function
 
     if (itsSupport > 0) {
+        if (isCFCacheLazy()) {
+            // generate w-planes required for this chunk, if necessary
+            updateLazyCFCache();
+        }
         return;
     }
 
@@ -156,6 +179,52 @@ void WProjectVisGridder::initConvolutionFunction(const accessors::IConstDataAcce
         initConvFuncOffsets(nWPlanes());
     }
 
+    if (isCFCacheLazy()) {
+        itsWPlaneLastUse.assign(nWPlanes(), 0);
+        // the first plane has the largest w-term and defines the common support,
+        // therefore it is always obtained up front
+        obtainWPlane(0);
+        ASKAPCHECK(itsSupport > 0, "Support not calculated correctly");
+        ASKAPLOG_INFO_STR(logger, "Convolution functions for the remaining " << nWPlanes() - 1 <<
+                          " w-planes will be generated on demand");
+        updateLazyCFCache();
+        return;
+    }
+
+    for (int iw = 0; iw < nWPlanes(); ++iw) {
+        generateWPlane(iw);
+    } // for iw
+
+    if (isSupportPlaneDependent()) {
+        ASKAPLOG_DEBUG_STR(logger, "Convolution function cache has " << itsConvFunc.size() << " planes");
+        ASKAPLOG_DEBUG_STR(logger, "Variable support size is used:");
+        const size_t step = casa::max(itsConvFunc.size() / itsOverSample / itsOverSample / 10, 1);
+
+        for (size_t plane = 0; plane < itsConvFunc.size(); plane += step * itsOverSample * itsOverSample) {
+            ASKAPLOG_DEBUG_STR(logger, "CF cache plane " << plane << " (" << plane / itsOverSample / itsOverSample <<
+                               " prior to oversampling) support is " <<
+                               itsConvFunc.support(plane / itsOverSample / itsOverSample));
+        }
+    } else {
+        ASKAPLOG_INFO_STR(logger, "Support of convolution function = "
+                              << itsConvFunc.support(0) << " by " << itsConvFunc.size() << " planes");
+    }
+
+    ASKAPCHECK(itsSupport > 0, "Support not calculated correctly");
+    // we can free up the memory because for WProject gridder this method is called only once!
+    itsCFBuffer.reset();
+    itsConvFunc.compact();
+}
+
+/// @brief generate convolution function for one w-plane
+/// @details All oversampling planes corresponding to the given w-plane are filled and
+/// normalised. If the support is not yet known (or is plane-dependent), it is determined
+/// from this plane.
+/// @param[in] iw w-plane to generate
+void WProjectVisGridder::generateWPlane(const int iw)
+{
+    ASKAPDEBUGTRACE("WProjectVisGridder::generateWPlane");
+    ASKAPDEBUGASSERT((iw >= 0) && (iw < nWPlanes()));
 
     /// These are the actual cell sizes used
     const double cellx = 1.0 / (double(itsShape(0)) * itsUVCellSize(0));
@@ -171,7 +240,9 @@ void WProjectVisGridder::initConvolutionFunction(const accessors::IConstDataAcce
 
     // initialise the buffer for full-sized CF
     ASKAPDEBUGASSERT((nx > 0) && (ny > 0));
-    initCFBuffer(casa::uInt(nx), casa::uInt(ny));
+    if (!itsCFBuffer) {
+        initCFBuffer(casa::uInt(nx), casa::uInt(ny));
+    }
 
     /// We want nx * ccellx = overSample * itsShape(0) * cellx
 
@@ -197,170 +268,333 @@ void WProjectVisGridder::initConvolutionFunction(const accessors::IConstDataAcce
         ccfy(iy) = grdsf(nuy) / float(qny);
     }
 
-    // Now we step through the w planes, starting the furthest
-    // out. We calculate the support for that plane and use it
-    // for all the others.
-
     // We pad here to do sinc interpolation of the convolution
     // function in uv space
     casa::Matrix<casa::DComplex> thisPlane = getCFBuffer();
     ASKAPDEBUGASSERT(thisPlane.nrow() == casa::uInt(nx));
     ASKAPDEBUGASSERT(thisPlane.ncolumn() == casa::uInt(ny));
 
-    for (int iw = 0; iw < nWPlanes(); ++iw) {
-        thisPlane.set(0.0);
-
-        //const double w = isPSFGridder() ? 0. : 2.0f*casa::C::pi*getWTerm(iw);
-        const double w = 2.0f * casa::C::pi * getWTerm(iw);
-
-        // Loop over the central nx, ny region, setting it to the product
-        // of the phase screen and the spheroidal function
-        for (int iy = 0; iy < qny; iy++) {
-            double y2 = double(iy - qny / 2) * ccelly;
-            y2 *= y2;
-
-            for (int ix = 0; ix < qnx; ix++) {
-                double x2 = double(ix - qnx / 2) * ccellx;
-                x2 *= x2;
-                const float r2 = x2 + y2;
-
-                if (r2 < 1.0) {
-                    const double phase = w * (1.0 - sqrt(1.0 - r2));
-                    const float wt = ccfx(ix) * ccfy(iy);
-                    ASKAPDEBUGASSERT(ix - qnx / 2 + nx / 2 < nx);
-                    ASKAPDEBUGASSERT(iy - qny / 2 + ny / 2 < ny);
-                    ASKAPDEBUGASSERT(ix + nx / 2 >= qnx / 2);
-                    ASKAPDEBUGASSERT(iy + ny / 2 >= qny / 2);
-                    thisPlane(ix - qnx / 2 + nx / 2, iy - qny / 2 + ny / 2) = casa::DComplex(wt * cos(phase), -wt * sin(phase));
-                    //thisPlane(ix-qnx/2+nx/2, iy-qny/2+ny/2)=casa::DComplex(wt*cos(phase));
-                }
+    thisPlane.set(0.0);
+
+    //const double w = isPSFGridder() ? 0. : 2.0f*casa::C::pi*getWTerm(iw);
+    const double w = 2.0f * casa::C::pi * getWTerm(iw);
+
+    // Loop over the central nx, ny region, setting it to the product
+    // of the phase screen and the spheroidal function
+    for (int iy = 0; iy < qny; iy++) {
+        double y2 = double(iy - qny / 2) * ccelly;
+        y2 *= y2;
+
+        for (int ix = 0; ix < qnx; ix++) {
+            double x2 = double(ix - qnx / 2) * ccellx;
+            x2 *= x2;
+            const float r2 = x2 + y2;
+
+            if (r2 < 1.0) {
+                const double phase = w * (1.0 - sqrt(1.0 - r2));
+                const float wt = ccfx(ix) * ccfy(iy);
+                ASKAPDEBUGASSERT(ix - qnx / 2 + nx / 2 < nx);
+                ASKAPDEBUGASSERT(iy - qny / 2 + ny / 2 < ny);
+                ASKAPDEBUGASSERT(ix + nx / 2 >= qnx / 2);
+                ASKAPDEBUGASSERT(iy + ny / 2 >= qny / 2);
+                thisPlane(ix - qnx / 2 + nx / 2, iy - qny / 2 + ny / 2) = casa::DComplex(wt * cos(phase), -wt * sin(phase));
+                //thisPlane(ix-qnx/2+nx/2, iy-qny/2+ny/2)=casa::DComplex(wt*cos(phase));
             }
         }
+    }
 
-        // At this point, we have the phase screen multiplied by the spheroidal
-        // function, sampled on larger cellsize (itsOverSample larger) in image
-        // space. Only the inner qnx, qny pixels have a non-zero value
+    // At this point, we have the phase screen multiplied by the spheroidal
+    // function, sampled on larger cellsize (itsOverSample larger) in image
+    // space. Only the inner qnx, qny pixels have a non-zero value
 
-        // Now we have to calculate the Fourier transform to get the
-        // convolution function in uv space
-        //casa::Matrix<casa::DComplex> buffer(thisPlane.nrow(),thisPlane.ncolumn());
-        //casa::convertArray<casa::DComplex,casa::Complex>(buffer,thisPlane);
-        scimath::fft2d(thisPlane, true);
-        //scimath::fft2d(buffer, true);
-        //casa::convertArray<casa::Complex,casa::DComplex>(thisPlane,buffer);
+    // Now we have to calculate the Fourier transform to get the
+    // convolution function in uv space
+    scimath::fft2d(thisPlane, true);
 
+    // Now thisPlane is filled with convolution function
+    // sampled on a finer grid in u,v
+    //
+    // If the support is not yet set, find it and size the
+    // convolution function appropriately
 
-        /*
-            for (uint xx=0;xx<thisPlane.nrow();++xx) {
-             for (uint yy=0;yy<thisPlane.ncolumn();++yy) {
-                  ASKAPCHECK(!std::isinf(casa::abs(thisPlane(xx,yy))), "Infinite value detected for plane="<<iw<<" at "<<xx<<","<<yy<<" "<<thisPlane(xx,yy));
-                 }
-        }
-        */
+    // by default the common support without offset is used
+    CFSupport cfSupport(itsSupport);
 
-        // Now thisPlane is filled with convolution function
-        // sampled on a finer grid in u,v
-        //
-        // If the support is not yet set, find it and size the
-        // convolution function appropriately
+    if (isSupportPlaneDependent() || (itsSupport == 0)) {
+        cfSupport = extractSupport(thisPlane);
+        const int support = cfSupport.itsSize;
 
-        // by default the common support without offset is used
-        CFSupport cfSupport(itsSupport);
+        ASKAPCHECK(support*itsOverSample < nx / 2,
+                   "Overflowing convolution function for w-plane " << iw <<
+                   " - increase maxSupport or decrease overSample; support=" << support << " oversample=" << itsOverSample <<
+                   " nx=" << nx);
+        cfSupport.itsSize = limitSupportIfNecessary(support);
 
-        if (isSupportPlaneDependent() || (itsSupport == 0)) {
-            cfSupport = extractSupport(thisPlane);
-            const int support = cfSupport.itsSize;
+        if (itsSupport == 0) {
+            itsSupport = cfSupport.itsSize;
+        }
 
-            ASKAPCHECK(support*itsOverSample < nx / 2,
-                       "Overflowing convolution function for w-plane " << iw <<
-                       " - increase maxSupport or decrease overSample; support=" << support << " oversample=" << itsOverSample <<
-                       " nx=" << nx);
-            cfSupport.itsSize = limitSupportIfNecessary(support);
+        if (isOffsetSupportAllowed()) {
+            setConvFuncOffset(iw, cfSupport.itsOffsetU, cfSupport.itsOffsetV);
+        }
+    }
 
-            if (itsSupport == 0) {
-                itsSupport = cfSupport.itsSize;
+    ASKAPCHECK(itsConvFunc.size() > 0, "Convolution function not sized correctly");
+    // use either support determined for this particular plane or a generic one,
+    // determined from the first plane (largest support as we have the largest w-term)
+    const int support = isSupportPlaneDependent() ? cfSupport.itsSize : itsSupport;
+
+    itsConvFunc.allocate(iw, support);
+
+    for (int fracu = 0; fracu < itsOverSample; ++fracu) {
+        for (int fracv = 0; fracv < itsOverSample; ++fracv) {
+            const int plane = fracu + itsOverSample * (fracv + itsOverSample * iw);
+            ASKAPDEBUGASSERT(plane < int(itsConvFunc.size()));
+            casa::Matrix<casa::Complex> thisCF = itsConvFunc.matrix(plane);
+
+            // Now cut out the inner part of the convolution function and
+            // insert it into the convolution function
+            for (int iy = -support; iy < support; ++iy) {
+                for (int ix = -support; ix < support; ++ix) {
+                    ASKAPDEBUGASSERT((ix + support >= 0) && (iy + support >= 0));
+                    ASKAPDEBUGASSERT(ix + support < int(thisCF.nrow()));
+                    ASKAPDEBUGASSERT(iy + support < int(thisCF.ncolumn()));
+                    ASKAPDEBUGASSERT((ix + cfSupport.itsOffsetU)*itsOverSample + fracu + nx / 2 >= 0);
+                    ASKAPDEBUGASSERT((iy + cfSupport.itsOffsetV)*itsOverSample + fracv + ny / 2 >= 0);
+                    ASKAPDEBUGASSERT((ix + cfSupport.itsOffsetU)*itsOverSample + fracu + nx / 2 < int(thisPlane.nrow()));
+                    ASKAPDEBUGASSERT((iy + cfSupport.itsOffsetV)*itsOverSample + fracv + ny / 2 < int(thisPlane.ncolumn()));
+                    thisCF(ix + support, iy + support) =
+                        thisPlane((ix + cfSupport.itsOffsetU) * itsOverSample + fracu + nx / 2,
+                               (iy + cfSupport.itsOffsetV) * itsOverSample + fracv + ny / 2);
+                } // for ix
+            } // for iy
+
+            // force normalization for all fractional offsets
+            const double norm = sum(casa::real(thisCF));
+            ASKAPDEBUGASSERT(norm > 0.);
+
+            if (norm > 0.) {
+                const casa::Complex invNorm = casa::Complex(1.0/norm);
+                thisCF *= invNorm;
             }
+        } // for fracv
+    } // for fracu
+}
 
-            if (isOffsetSupportAllowed()) {
-                setConvFuncOffset(iw, cfSupport.itsOffsetU, cfSupport.itsOffsetV);
-            }
-        }
+/// @brief check whether convolution function for the given w-plane is in memory
+/// @param[in] iw w-plane
+/// @return true, if all oversampling planes for this w-plane are filled
+bool WProjectVisGridder::hasWPlane(const int iw) const
+{
+    ASKAPDEBUGASSERT((iw >= 0) && (iw < nWPlanes()));
+    return itsConvFunc.isDefined(iw);
+}
 
-        ASKAPCHECK(itsConvFunc.size() > 0, "Convolution function not sized correctly");
-        // use either support determined for this particular plane or a generic one,
-        // determined from the first plane (largest support as we have the largest w-term)
-        const int support = isSupportPlaneDependent() ? cfSupport.itsSize : itsSupport;
-
-        const int cSize = 2 * support + 1;
-
-        for (int fracu = 0; fracu < itsOverSample; ++fracu) {
-            for (int fracv = 0; fracv < itsOverSample; ++fracv) {
-                const int plane = fracu + itsOverSample * (fracv + itsOverSample * iw);
-                ASKAPDEBUGASSERT(plane < int(itsConvFunc.size()));
-                itsConvFunc[plane].resize(cSize, cSize);
-                itsConvFunc[plane].set(0.0);
-
-                // Now cut out the inner part of the convolution function and
-                // insert it into the convolution function
-                for (int iy = -support; iy < support; ++iy) {
-                    for (int ix = -support; ix < support; ++ix) {
-                        ASKAPDEBUGASSERT((ix + support >= 0) && (iy + support >= 0));
-                        ASKAPDEBUGASSERT(ix + support < int(itsConvFunc[plane].nrow()));
-                        ASKAPDEBUGASSERT(iy + support < int(itsConvFunc[plane].ncolumn()));
-                        ASKAPDEBUGASSERT((ix + cfSupport.itsOffsetU)*itsOverSample + fracu + nx / 2 >= 0);
-                        ASKAPDEBUGASSERT((iy + cfSupport.itsOffsetV)*itsOverSample + fracv + ny / 2 >= 0);
-                        ASKAPDEBUGASSERT((ix + cfSupport.itsOffsetU)*itsOverSample + fracu + nx / 2 < int(thisPlane.nrow()));
-                        ASKAPDEBUGASSERT((iy + cfSupport.itsOffsetV)*itsOverSample + fracv + ny / 2 < int(thisPlane.ncolumn()));
-                        //if (w < 0) {
-                        //    itsConvFunc[plane](ix + support, iy + support) =
-                        //        conj(thisPlane((ix + cfSupport.itsOffsetU) * itsOverSample + fracu + nx / 2,
-                        //              (iy + cfSupport.itsOffsetV) * itsOverSample + fracv + ny / 2));
-                        //} else {
-                        itsConvFunc[plane](ix + support, iy + support) =
-                            thisPlane((ix + cfSupport.itsOffsetU) * itsOverSample + fracu + nx / 2,
-                                   (iy + cfSupport.itsOffsetV) * itsOverSample + fracv + ny / 2);
-                        //}
-                    } // for ix
-                } // for iy
-            } // for fracv
-        } // for fracu
+/// @brief memory occupied by the convolution function for the given w-plane
+/// @param[in] iw w-plane
+/// @return size in bytes (zero if the w-plane is not in memory)
+size_t WProjectVisGridder::wPlaneMemory(const int iw) const
+{
+    return itsConvFunc.memoryUsed(iw);
+}
 
-    } // for iw
+/// @brief load or generate convolution function for the given w-plane
+/// @details If the disk cache is configured, the w-plane is loaded from disk if present,
+/// otherwise it is generated (and saved to disk if the disk cache is configured).
+/// @param[in] iw w-plane
+void WProjectVisGridder::obtainWPlane(const int iw)
+{
+    if ((itsCFCacheDir != "") && loadWPlane(iw)) {
+        ++itsNWPlanesLoaded;
+        return;
+    }
+    generateWPlane(iw);
+    ++itsNWPlanesGenerated;
+    if (itsCFCacheDir != "") {
+        saveWPlane(iw);
+    }
+}
 
-    // force normalization for all fractional offsets (or planes)
-    for (size_t plane = 0; plane < itsConvFunc.size(); ++plane) {
-        if (itsConvFunc[plane].nelements() == 0) {
-            // this plane of the cache is unused
-            continue;
+/// @brief make sure all w-planes required for the current chunk are in memory
+/// @details This method is used when convolution functions are generated on demand.
+/// All w-planes referenced by itsCMap which are not in memory are loaded or generated.
+/// Then, if the memory budget is exceeded, the least recently used w-planes not required
+/// for the current chunk are released until the budget is met (or nothing can be released).
+void WProjectVisGridder::updateLazyCFCache()
+{
+    ASKAPDEBUGTRACE("WProjectVisGridder::updateLazyCFCache");
+    ASKAPDEBUGASSERT(int(itsWPlaneLastUse.size()) == nWPlanes());
+    ++itsCFUseCounter;
+    const int *cmap = itsCMap.data();
+    for (size_t i = 0; i < itsCMap.nelements(); ++i) {
+        const int iw = cmap[i];
+        // negative values are uninitialised indices (debug mode only), they are not used
+        if ((iw >= 0) && (itsWPlaneLastUse[iw] != itsCFUseCounter)) {
+            if (!hasWPlane(iw)) {
+                obtainWPlane(iw);
+            }
+            itsWPlaneLastUse[iw] = itsCFUseCounter;
         }
+    }
 
-        const double norm = sum(casa::real(itsConvFunc[plane]));
-        // ASKAPLOG_INFO_STR(logger, "Sum of convolution function = " << norm);
-        ASKAPDEBUGASSERT(norm > 0.);
-
-        if (norm > 0.) {
-            const casa::Complex invNorm = casa::Complex(1.0/norm);
-            itsConvFunc[plane] *= invNorm;
+    if (itsCFMemoryBudget > 0) {
+        size_t memUsed = 0;
+        for (int iw = 0; iw < nWPlanes(); ++iw) {
+            memUsed += wPlaneMemory(iw);
         }
-    } // for plane
+        bool released = false;
+        while (memUsed > itsCFMemoryBudget) {
+            // find the least recently used w-plane which is not required for this chunk
+            int lru = -1;
+            for (int iw = 0; iw < nWPlanes(); ++iw) {
+                if (hasWPlane(iw) && (itsWPlaneLastUse[iw] != itsCFUseCounter) &&
+                    ((lru < 0) || (itsWPlaneLastUse[iw] < itsWPlaneLastUse[lru]))) {
+                    lru = iw;
+                }
+            }
+            if (lru < 0) {
+                // all planes in memory are required for the current chunk
+                break;
+            }
+            memUsed -= wPlaneMemory(lru);
+            itsConvFunc.release(lru);
+            itsWPlaneLastUse[lru] = 0;
+            ++itsNWPlanesEvicted;
+            released = true;
+        }
+        if (released) {
+            itsConvFunc.compact();
+        }
+    }
+}
 
-    if (isSupportPlaneDependent()) {
-        ASKAPLOG_DEBUG_STR(logger, "Convolution function cache has " << itsConvFunc.size() << " planes");
-        ASKAPLOG_DEBUG_STR(logger, "Variable support size is used:");
-        const size_t step = casa::max(itsConvFunc.size() / itsOverSample / itsOverSample / 10, 1);
+/// @brief key describing the convolution function for the given w-plane
+/// @details The key includes all parameters the convolution function depends on, so
+/// w-planes stored on disk are only reused for the same gridder configuration.
+/// @param[in] iw w-plane
+/// @return string key
+std::string WProjectVisGridder::wPlaneCacheKey(const int iw) const
+{
+    std::ostringstream os;
+    os.precision(17);
+    os << "WProject " << itsShape(0) << " " << itsShape(1) << " " << itsUVCellSize(0) << " " <<
+        itsUVCellSize(1) << " " << itsOverSample << " " << itsMaxSupport << " " << itsLimitSupport << " " <<
+        itsCutoff << " " << itsCutoffAbs << " " << itsPlaneDependentCFSupport << " " <<
+        itsOffsetSupportAllowed << " " << getWTerm(iw);
+    return os.str();
+}
 
-        for (size_t plane = 0; plane < itsConvFunc.size(); plane += step * itsOverSample * itsOverSample) {
-            ASKAPLOG_DEBUG_STR(logger, "CF cache plane " << plane << " (" << plane / itsOverSample / itsOverSample <<
-                               " prior to oversampling) shape is " << itsConvFunc[plane].shape());
-        }
-    } else {
-        ASKAPLOG_INFO_STR(logger, "Shape of convolution function = "
-                              << itsConvFunc[0].shape() << " by " << itsConvFunc.size() << " planes");
+/// @brief name of the file with convolution function for the given w-plane
+/// @details The file name contains a hash of the key, the key itself is stored in the
+/// file and checked on load to guard against collisions.
+/// @param[in] iw w-plane
+/// @return full file name
+std::string WProjectVisGridder::wPlaneFileName(const int iw) const
+{
+    // 64-bit FNV-1a hash of the key
+    const std::string key = wPlaneCacheKey(iw);
+    unsigned long long hash = 14695981039346656037ULL;
+    for (std::string::const_iterator ci = key.begin(); ci != key.end(); ++ci) {
+        hash ^= static_cast<unsigned char>(*ci);
+        hash *= 1099511628211ULL;
     }
+    std::ostringstream os;
+    os << itsCFCacheDir << "/wproject_" << std::hex << hash << ".cf";
+    return os.str();
+}
 
-    ASKAPCHECK(itsSupport > 0, "Support not calculated correctly");
-    // we can free up the memory because for WProject gridder this method is called only once!
-    itsCFBuffer.reset();
+/// @brief save convolution function for the given w-plane to disk
+/// @details The file is written under a temporary name and then renamed, so
+/// concurrent processes sharing the same directory never see a partial file.
+/// Failures are not fatal, the w-plane is just not cached on disk.
+/// @param[in] iw w-plane
+void WProjectVisGridder::saveWPlane(const int iw) const
+{
+    const int nOS = itsOverSample * itsOverSample;
+    LOFAR::BlobString bs;
+    LOFAR::BlobOBufString bob(bs);
+    LOFAR::BlobOStream out(bob);
+    out.putStart("WProjectCF", 1);
+    const std::pair<int, int> offset = isOffsetSupportAllowed() ? getConvFuncOffset(iw) : std::pair<int, int>(0, 0);
+    out << wPlaneCacheKey(iw) << itsSupport << offset.first << offset.second << nOS;
+    for (int plane = iw * nOS; plane < (iw + 1) * nOS; ++plane) {
+        out << itsConvFunc.copyOf(plane);
+    }
+    out.putEnd();
+
+    const std::string fileName = wPlaneFileName(iw);
+    std::ostringstream tmpName;
+    tmpName << fileName << ".tmp" << getpid();
+    std::ofstream os(tmpName.str().c_str(), std::ios::binary);
+    os.write(static_cast<const char*>(static_cast<const void*>(bs.data())), bs.size());
+    os.close();
+    if (!os || (std::rename(tmpName.str().c_str(), fileName.c_str()) != 0)) {
+        ASKAPLOG_WARN_STR(logger, "Unable to save convolution function for w-plane " << iw << " into " << fileName);
+        std::remove(tmpName.str().c_str());
+    }
+}
+
+/// @brief load convolution function for the given w-plane from disk
+/// @param[in] iw w-plane
+/// @return true, if the w-plane has been loaded successfully, false if the file is missing,
+/// unreadable, of an unsupported version or doesn't match the current setup
+bool WProjectVisGridder::loadWPlane(const int iw)
+{
+    const std::string fileName = wPlaneFileName(iw);
+    std::ifstream is(fileName.c_str(), std::ios::binary);
+    if (!is) {
+        return false;
+    }
+    is.seekg(0, std::ios::end);
+    const std::streamoff fileSize = is.tellg();
+    is.seekg(0, std::ios::beg);
+    LOFAR::BlobString bs;
+    bs.resize(fileSize);
+    is.read(static_cast<char*>(static_cast<void*>(bs.data())), fileSize);
+    if (!is) {
+        ASKAPLOG_WARN_STR(logger, "Unable to read " << fileName << ", w-plane " << iw << " will be regenerated");
+        return false;
+    }
+
+    LOFAR::BlobIBufString bib(bs);
+    LOFAR::BlobIStream in(bib);
+    const int version = in.getStart("WProjectCF");
+    if (version != 1) {
+        // stale file written by another version of the code, regenerate and overwrite
+        ASKAPLOG_WARN_STR(logger, "Unsupported version " << version << " of the convolution function file " <<
+                          fileName << ", w-plane " << iw << " will be regenerated");
+        return false;
+    }
+    std::string key;
+    int support = -1;
+    std::pair<int, int> offset;
+    int nOS = -1;
+    in >> key >> support >> offset.first >> offset.second >> nOS;
+    if ((key != wPlaneCacheKey(iw)) || (nOS != itsOverSample * itsOverSample) ||
+        ((itsSupport > 0) && (support != itsSupport))) {
+        // hash collision or the common support differs, regenerate
+        return false;
+    }
+    ASKAPCHECK(support > 0, "Support of " << support << " read from " << fileName << " is expected to be positive");
+    itsConvFunc.allocate(iw, support);
+    const casa::IPosition expectedShape(2, 2 * support + 1, 2 * support + 1);
+    for (int plane = 0; plane < nOS; ++plane) {
+        casa::Array<casa::Complex> buf;
+        in >> buf;
+        ASKAPCHECK(buf.shape() == expectedShape, "Convolution function read from " << fileName <<
+                   " has shape " << buf.shape() << ", expected " << expectedShape);
+        casa::Matrix<casa::Complex> thisCF = itsConvFunc.matrix(iw * nOS + plane);
+        thisCF = buf;
+    }
+    in.getEnd();
+
+    if (itsSupport == 0) {
+        itsSupport = support;
+    }
+    if (isOffsetSupportAllowed()) {
+        setConvFuncOffset(iw, offset.first, offset.second);
+    }
+    return true;
 }
 
 /// @brief search for support parameters
@@ -451,6 +685,7 @@ IVisGridder::ShPtr WProjectVisGridder::createGridder(const LOFAR::ParameterSet&
             maxSupport, limitSupport, tablename));
     gridder->configureGridder(parset);
     gridder->configureWSampling(parset);
+    gridder->configureCFCache(parset);
     return gridder;
 }
 
@@ -489,6 +724,38 @@ void WProjectVisGridder::configureGridder(const LOFAR::ParameterSet& parset)
     setAbsCutoffFlag(absCutoff);
 }
 
+/// @brief configure on-demand generation of convolution functions
+/// @details This method is supposed to be called from createGridder. It reads
+/// cfcache.lazy, cfcache.maxmemory (in MB, 0 means no limit) and cfcache.dir
+/// (directory to keep generated w-planes between runs, empty string disables disk cache).
+/// @param[in] parset input parset file
+void WProjectVisGridder::configureCFCache(const LOFAR::ParameterSet& parset)
+{
+    const bool lazy = parset.getBool("cfcache.lazy", false);
+    const int maxMemory = parset.getInt32("cfcache.maxmemory", 0);
+    ASKAPCHECK(maxMemory >= 0, "cfcache.maxmemory should be non-negative, you have " << maxMemory);
+    const std::string dir = parset.getString("cfcache.dir", "");
+    ASKAPCHECK(lazy || ((maxMemory == 0) && (dir == "")),
+               "cfcache.maxmemory and cfcache.dir options of the gridder require cfcache.lazy=true");
+    if (lazy) {
+        ASKAPLOG_INFO_STR(logger, "Convolution functions will be generated on demand" <<
+                          (maxMemory > 0 ? ", memory budget " + utility::toString<int>(maxMemory) + " MB" : std::string()) <<
+                          (dir != "" ? ", w-planes will be cached in " + dir : std::string()));
+    }
+    setCFCacheParameters(lazy, size_t(maxMemory) * 1024 * 1024, dir);
+}
+
+/// @brief set up on-demand generation of convolution functions
+/// @param[in] lazy true to generate w-planes only when a visibility maps to them
+/// @param[in] maxMemory memory budget for convolution functions in bytes (0 means no limit)
+/// @param[in] dir directory to keep generated w-planes between runs (empty string disables it)
+void WProjectVisGridder::setCFCacheParameters(const bool lazy, const size_t maxMemory, const std::string &dir)
+{
+    ASKAPCHECK(itsSupport == 0, "CF cache parameters should be set before convolution functions are calculated");
+    itsLazyCF = lazy;
+    itsCFMemoryBudget = maxMemory;
+    itsCFCacheDir = dir;
+}
 
 /// @brief obtain buffer used to create convolution functions
 /// @return a reference to the buffer held as a shared pointer
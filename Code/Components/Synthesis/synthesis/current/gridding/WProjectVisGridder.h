@@ -35,6 +35,10 @@
 // Local package includes
 #include <dataaccess/IConstDataAccessor.h>
 
+// std includes
+#include <string>
+#include <vector>
+
 namespace askap
 {
     namespace synthesis
@@ -97,6 +101,20 @@ namespace askap
                 /// @return a shared pointer to the gridder instance					 
                 static IVisGridder::ShPtr createGridder(const LOFAR::ParameterSet& parset);
 
+                /// @brief set up on-demand generation of convolution functions
+                /// @details By default, convolution functions for all w-planes are generated
+                /// up front. In the lazy mode, a w-plane is generated only when a visibility
+                /// first maps to it. If a memory budget is given, the least recently used
+                /// w-planes are released when the budget is exceeded (w-planes required for the
+                /// current chunk are always kept). If a directory is given, generated w-planes are
+                /// stored there and reused by subsequent runs with the same gridder configuration.
+                /// This method should be called before the first chunk is gridded.
+                /// @param[in] lazy true to generate w-planes only when a visibility maps to them
+                /// @param[in] maxMemory memory budget for convolution functions in bytes (0 means no limit)
+                /// @param[in] dir directory to keep generated w-planes between runs (empty string disables it)
+                void setCFCacheParameters(const bool lazy, const size_t maxMemory = 0,
+                                          const std::string &dir = "");
+
             protected:
                 /// @brief additional operations to configure gridder
                 /// @details This method is supposed to be called from createGridder and could be
@@ -105,6 +123,16 @@ namespace askap
                 /// @param[in] parset input parset file
                 void configureGridder(const LOFAR::ParameterSet& parset);
 
+                /// @brief configure on-demand generation of convolution functions
+                /// @details This method is supposed to be called from createGridder. It reads
+                /// cfcache.lazy, cfcache.maxmemory (in MB, 0 means no limit) and cfcache.dir.
+                /// @param[in] parset input parset file
+                void configureCFCache(const LOFAR::ParameterSet& parset);
+
+                /// @brief check whether convolution functions are generated on demand
+                /// @return true, if w-planes are generated only when required
+                inline bool isCFCacheLazy() const { return itsLazyCF; }
+
                 /// @brief obtain buffer used to create convolution functions
                 /// @return a reference to the buffer held as a shared pointer   
                 casa::Matrix<casa::DComplex> getCFBuffer() const; 
@@ -206,6 +234,52 @@ namespace askap
                 /// @return reference to itself
                 WProjectVisGridder& operator=(const WProjectVisGridder &other);
 
+                /// @brief generate convolution function for one w-plane
+                /// @details All oversampling planes corresponding to the given w-plane are filled and
+                /// normalised. If the support is not yet known (or is plane-dependent), it is determined
+                /// from this plane.
+                /// @param[in] iw w-plane to generate
+                void generateWPlane(const int iw);
+
+                /// @brief check whether convolution function for the given w-plane is in memory
+                /// @param[in] iw w-plane
+                /// @return true, if all oversampling planes for this w-plane are filled
+                bool hasWPlane(const int iw) const;
+
+                /// @brief memory occupied by the convolution function for the given w-plane
+                /// @param[in] iw w-plane
+                /// @return size in bytes (zero if the w-plane is not in memory)
+                size_t wPlaneMemory(const int iw) const;
+
+                /// @brief load or generate convolution function for the given w-plane
+                /// @param[in] iw w-plane
+                void obtainWPlane(const int iw);
+
+                /// @brief make sure all w-planes required for the current chunk are in memory
+                /// @details Missing w-planes are loaded or generated, least recently used w-planes
+                /// are released if the memory budget is exceeded.
+                void updateLazyCFCache();
+
+                /// @brief key describing the convolution function for the given w-plane
+                /// @param[in] iw w-plane
+                /// @return string key
+                std::string wPlaneCacheKey(const int iw) const;
+
+                /// @brief name of the file with convolution function for the given w-plane
+                /// @param[in] iw w-plane
+                /// @return full file name
+                std::string wPlaneFileName(const int iw) const;
+
+                /// @brief save convolution function for the given w-plane to disk
+                /// @param[in] iw w-plane
+                void saveWPlane(const int iw) const;
+
+                /// @brief load convolution function for the given w-plane from disk
+                /// @param[in] iw w-plane
+                /// @return true, if the w-plane has been loaded successfully, false if the file is missing,
+                /// unreadable, of an unsupported version or doesn't match the current setup
+                bool loadWPlane(const int iw);
+
                 /// Maximum support
                 int itsMaxSupport;
 
@@ -233,6 +307,30 @@ namespace askap
 
                 /// @brief itsCutoff is an absolute cutoff, rather than relative to the peak of a particular CF plane
                 bool itsCutoffAbs;       
+
+                /// @brief true if convolution functions are generated on demand
+                bool itsLazyCF;
+
+                /// @brief memory budget for convolution functions in bytes (0 means no limit)
+                size_t itsCFMemoryBudget;
+
+                /// @brief directory to keep generated w-planes between runs (empty if not used)
+                std::string itsCFCacheDir;
+
+                /// @brief value of itsCFUseCounter when the w-plane was last required
+                std::vector<unsigned long> itsWPlaneLastUse;
+
+                /// @brief counter of chunks processed in the lazy mode
+                unsigned long itsCFUseCounter;
+
+                /// @brief number of w-planes generated in the lazy mode
+                size_t itsNWPlanesGenerated;
+
+                /// @brief number of w-planes loaded from disk
+                size_t itsNWPlanesLoaded;
+
+                /// @brief number of w-planes released to stay within the memory budget
+                size_t itsNWPlanesEvicted;
         };
     }
 }
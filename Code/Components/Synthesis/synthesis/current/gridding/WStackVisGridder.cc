@@ -130,7 +130,8 @@ namespace askap
       
     }
 
-    void WStackVisGridder::multiply(casa::Array<casa::DComplex>& scratch, int i)
+    template<typename T>
+    void WStackVisGridder::multiply(casa::Array<T>& scratch, int i)
     {
       ASKAPDEBUGTRACE("WStackVisGridder::multiply");
       /// These are the actual cell sizes used
@@ -141,10 +142,10 @@ namespace askap
       const int ny=itsShape(1);
 
       const float w=2.0f*casa::C::pi*getWTerm(i);
-      casa::ArrayIterator<casa::DComplex> it(scratch, 2);
+      casa::ArrayIterator<T> it(scratch, 2);
       while (!it.pastEnd())
       {
-        casa::Matrix<casa::DComplex> mat(it.array());
+        casa::Matrix<T> mat(it.array());
 
         /// @todo Optimise multiply loop
         for (int iy=0; iy<ny; iy++)
@@ -160,7 +161,7 @@ namespace askap
               const float r2=x2+y2;
               if (r2<1.0) {
                   const float phase=w*(1.0-sqrt(1.0-r2));
-                  mat(ix, iy)*=casa::DComplex(cos(phase), -sin(phase));
+                  mat(ix, iy)*=T(cos(phase), -sin(phase));
               }
             }
           }
@@ -191,6 +192,21 @@ namespace askap
       {
         if (casa::max(casa::amplitude(itsGrid[i]))>0.0)
         {
+          if (isSinglePrecision()) {
+            casa::Array<casa::Complex> scratch(itsGrid[i].copy());
+            scimath::fft2d(scratch, false);
+            multiply(scratch, i);
+
+            if (first)  {
+              first=false;
+              toDouble(dBuffer, scratch);
+            } else {
+              casa::Array<double> work(dBuffer.shape());
+              toDouble(work, scratch);
+              dBuffer += work;
+            }
+            continue;
+          }
           casa::Array<casa::DComplex> scratch(itsGrid[i].shape());
           casa::convertArray<casa::DComplex,casa::Complex>(scratch,itsGrid[i]);
           scimath::fft2d(scratch, false);
@@ -232,6 +248,14 @@ namespace askap
         correctConvolution(scratch);
         for (int i=0; i<nWPlanes(); ++i)
         {
+          if (isSinglePrecision()) {
+            // the plane is transformed in the grid itself
+            toComplex(itsGrid[i], scratch);
+            multiply(itsGrid[i], i);
+            itsGrid[i] = casa::conj(itsGrid[i]);
+            scimath::fft2d(itsGrid[i], true);
+            continue;
+          }
           casa::Array<casa::DComplex> work(itsShape);          
           toComplex(work, scratch);
           multiply(work, i);
@@ -112,9 +112,10 @@ namespace askap
 				virtual int gIndex(int row, int pol, int chan);
 
 				/// Multiply by the phase screen
-				/// @param scratch To be multiplied
+				/// @param scratch To be multiplied (casa::Complex or casa::DComplex array)
 				/// @param i Index
-				void multiply(casa::Array<casa::DComplex>& scratch, int i);
+				template<typename T>
+				void multiply(casa::Array<T>& scratch, int i);
 				
 				/// Mapping from row, pol, and channel to planes of grid
 				casa::Cube<int> itsGMap;
@@ -40,6 +40,7 @@
 #include <askap/AskapError.h>
 #include <utils/PolConverter.h>
 #include <dataaccess/IFlagAndNoiseDataAccessor.h>
+#include <casa/Arrays/ArrayMath.h>
 
 
 #include <askap/AskapUtil.h>
@@ -49,6 +50,8 @@ ASKAP_LOGGER(logger, ".measurementequation");
 
 #include <boost/shared_ptr.hpp>
 
+#include <algorithm>
+
 namespace askap {
 
 namespace synthesis {
@@ -57,7 +60,8 @@ namespace synthesis {
 /// @details It initialises ME for a given solution source.
 /// @param[in] src calibration solution source to work with
 CalibrationApplicatorME::CalibrationApplicatorME(const boost::shared_ptr<accessors::ICalSolutionConstSource> &src) :
-     CalibrationSolutionHandler(src), itsScaleNoise(false), itsFlagAllowed(false), itsBeamIndependent(false) {}
+     CalibrationSolutionHandler(src), itsScaleNoise(false), itsFlagAllowed(false), itsBeamIndependent(false),
+     itsTableNChan(0) {}
 
 /// @brief correct model visibilities for one accessor (chunk).
 /// @details This method corrects the data in the given accessor
@@ -67,23 +71,19 @@ CalibrationApplicatorME::CalibrationApplicatorME(const boost::shared_ptr<accesso
 /// @param[in] chunk a read-write accessor to work with
 void CalibrationApplicatorME::correct(accessors::IDataAccessor &chunk) const
 {
-  casa::Cube<casa::Complex> &rwVis = chunk.rwVisibility();
-  ASKAPDEBUGASSERT(rwVis.nelements());
+  ASKAPDEBUGASSERT(chunk.rwVisibility().nelements());
   updateAccessor(chunk.time());
-  const casa::Vector<casa::uInt>& antenna1 = chunk.antenna1();
-  const casa::Vector<casa::uInt>& antenna2 = chunk.antenna2();
-  const casa::Vector<casa::uInt>& beam1 = chunk.feed1();
-  const casa::Vector<casa::uInt>& beam2 = chunk.feed2();
   const casa::Vector<casa::Stokes::StokesTypes> stokes = chunk.stokes();   
   
   const casa::uInt nPol = chunk.nPol();
   ASKAPDEBUGASSERT(nPol <= 4);
-  casa::Matrix<casa::Complex> mueller(nPol, nPol);
-  casa::Matrix<casa::Complex> reciprocal(nPol, nPol);
   
   casa::RigidVector<casa::uInt, 4> indices(0u);
+  // true if all 4 products are present in the canonical order
+  bool canonicalOrder = (nPol == 4);
   for (casa::uInt pol = 0; pol<nPol; ++pol) {
        indices(pol) = scimath::PolConverter::getIndex(stokes[pol]);
+       canonicalOrder &= (indices(pol) == pol);
   }
   
   boost::shared_ptr<accessors::IFlagAndNoiseDataAccessor> noiseAndFlagDA;
@@ -93,6 +93,126 @@ void CalibrationApplicatorME::correct(accessors::IDataAccessor &chunk) const
       ASKAPDEBUGASSERT(chunkPtr);
       noiseAndFlagDA = boost::dynamic_pointer_cast<accessors::IFlagAndNoiseDataAccessor>(chunkPtr);
   }
+  if (canonicalOrder) {
+      correctFullPol(chunk, noiseAndFlagDA);
+  } else {
+      correctGeneral(chunk, indices, noiseAndFlagDA);
+  }
+}
+
+/// @brief correct visibilities via the inverse Jones matrices (full polarisation)
+/// @details This is the fast path used for the full set of polarisation products
+/// in the canonical order.
+/// @param[in] chunk a read-write accessor to work with
+/// @param[in] noiseAndFlagDA accessor to change flags and noise (may be empty
+/// if neither flagging nor noise scaling is enabled)
+void CalibrationApplicatorME::correctFullPol(accessors::IDataAccessor &chunk,
+               const boost::shared_ptr<accessors::IFlagAndNoiseDataAccessor> &noiseAndFlagDA) const
+{
+  prepareInverseJones(chunk);
+  const casa::Vector<casa::uInt>& antenna1 = chunk.antenna1();
+  const casa::Vector<casa::uInt>& antenna2 = chunk.antenna2();
+  const casa::Vector<casa::uInt>& beam1 = chunk.feed1();
+  const casa::Vector<casa::uInt>& beam2 = chunk.feed2();
+  const casa::uInt nRow = chunk.nRow();
+  const casa::uInt nChan = chunk.nChannel();
+  if (nChan == 0) {
+      return;
+  }
+  // the same threshold as for the Mueller matrix, its determinant is det(J1)^2 * conj(det(J2))^2
+  const float detThreshold = 1e-25;
+  
+  casa::Cube<casa::Complex> &rwVis = chunk.rwVisibility();
+  ASKAPDEBUGASSERT(rwVis.nplane() == 4);
+  // the cube is nRow x nChan x nPol, so the channels of a row are nRow elements apart
+  // and polarisation products are nRow * nChan elements apart
+  const size_t polStep = size_t(nRow) * nChan;
+  casa::Bool deleteIt;
+  casa::Complex *visStorage = rwVis.getStorage(deleteIt);
+  try {
+     for (casa::uInt row = 0; row < nRow; ++row) {
+          // references to map elements are not invalidated by insertion of other elements
+          const InverseJones &jones1 = inverseJones(antenna1[row], itsBeamIndependent ? 0 : beam1[row]);
+          const InverseJones &jones2 = inverseJones(antenna2[row], itsBeamIndependent ? 0 : beam2[row]);
+          const casa::Complex *inv1 = &jones1.itsMatrices[0];
+          const casa::Complex *inv2 = &jones2.itsMatrices[0];
+          const casa::Float *detSq1 = &jones1.itsDetSquared[0];
+          const casa::Float *detSq2 = &jones2.itsDetSquared[0];
+          casa::Complex *vis = visStorage + row;
+          for (casa::uInt chan = 0; chan < nChan; ++chan, inv1 += 4, inv2 += 4, vis += nRow) {
+               if (detSq1[chan] * detSq2[chan] < detThreshold) {
+                   ASKAPCHECK(itsFlagAllowed, "Unable to apply calibration for (antenna1,beam1)=("<<antenna1[row]<<
+                          ","<<beam1[row]<<") and (antenna2,beam2)=("<<antenna2[row]<<","<<beam2[row]<<
+                          "), channel="<<chan<<", time="<<chunk.time()/86400.-55000<<
+                          " determinate is too close to 0. D="<<detSq1[chan] * detSq2[chan]<<
+                          " dir="<<askap::printDirection(chunk.pointingDir1()[row]));
+                   ASKAPCHECK(noiseAndFlagDA, "Accessor type passed to CalibrationApplicatorME does not support change of flags");
+                   noiseAndFlagDA->rwFlag().yzPlane(row).row(chan).set(true);
+                   for (casa::uInt pol = 0; pol < 4; ++pol) {
+                        vis[pol * polStep] = 0.;
+                   }
+                   continue;
+               }
+               // V' = J1^{-1} V J2^{-H}, both 2x2 matrices are stored row-major
+               const casa::Complex temp00 = inv1[0] * vis[0] + inv1[1] * vis[2 * polStep];
+               const casa::Complex temp01 = inv1[0] * vis[polStep] + inv1[1] * vis[3 * polStep];
+               const casa::Complex temp10 = inv1[2] * vis[0] + inv1[3] * vis[2 * polStep];
+               const casa::Complex temp11 = inv1[2] * vis[polStep] + inv1[3] * vis[3 * polStep];
+               const casa::Complex conj00 = conj(inv2[0]);
+               const casa::Complex conj01 = conj(inv2[1]);
+               const casa::Complex conj10 = conj(inv2[2]);
+               const casa::Complex conj11 = conj(inv2[3]);
+               vis[0] = temp00 * conj00 + temp01 * conj01;
+               vis[polStep] = temp00 * conj10 + temp01 * conj11;
+               vis[2 * polStep] = temp10 * conj00 + temp11 * conj01;
+               vis[3 * polStep] = temp10 * conj10 + temp11 * conj11;
+               if (itsScaleNoise) {
+                   ASKAPCHECK(noiseAndFlagDA, "Accessor type passed to CalibrationApplicatorME does not support change of the noise estimate");
+                   casa::Vector<casa::Complex> thisChanNoise = noiseAndFlagDA->rwNoise().yzPlane(row).row(chan);
+                   const casa::Vector<casa::Complex> origNoise = thisChanNoise.copy();
+                   ASKAPDEBUGASSERT(thisChanNoise.nelements() == 4);
+                   // propagating noise estimate through the inverse Mueller matrix, which is
+                   // the Kronecker product of J1^{-1} and conj(J2^{-1})
+                   for (casa::uInt pol = 0; pol < 4; ++pol) {
+                        float tempRe = 0., tempIm = 0.;
+                        for (casa::uInt k = 0; k < 4; ++k) {
+                             const casa::Complex reciprocal = inv1[2 * (pol / 2) + k / 2] * conj(inv2[2 * (pol % 2) + k % 2]);
+                             tempRe += casa::square(casa::real(reciprocal) * casa::real(origNoise[k])) + 
+                                       casa::square(casa::imag(reciprocal) * casa::imag(origNoise[k]));
+                             tempIm += casa::square(casa::real(reciprocal) * casa::imag(origNoise[k])) + 
+                                       casa::square(casa::imag(reciprocal) * casa::real(origNoise[k]));                                   
+                        }
+                        thisChanNoise[pol] = casa::Complex(sqrt(tempRe), sqrt(tempIm));
+                   }
+               }
+          }
+     }
+  }
+  catch (...) {
+     rwVis.putStorage(visStorage, deleteIt);
+     throw;
+  }
+  rwVis.putStorage(visStorage, deleteIt);
+}
+
+/// @brief correct visibilities via the general Mueller matrix
+/// @details This method supports an arbitrary subset of polarisation products
+/// @param[in] chunk a read-write accessor to work with
+/// @param[in] indices indices of polarisation products (see PolConverter::getIndex)
+/// @param[in] noiseAndFlagDA accessor to change flags and noise (may be empty
+/// if neither flagging nor noise scaling is enabled)
+void CalibrationApplicatorME::correctGeneral(accessors::IDataAccessor &chunk,
+               const casa::RigidVector<casa::uInt, 4> &indices,
+               const boost::shared_ptr<accessors::IFlagAndNoiseDataAccessor> &noiseAndFlagDA) const
+{
+  casa::Cube<casa::Complex> &rwVis = chunk.rwVisibility();
+  const casa::Vector<casa::uInt>& antenna1 = chunk.antenna1();
+  const casa::Vector<casa::uInt>& antenna2 = chunk.antenna2();
+  const casa::Vector<casa::uInt>& beam1 = chunk.feed1();
+  const casa::Vector<casa::uInt>& beam2 = chunk.feed2();
+  const casa::uInt nPol = chunk.nPol();
+  casa::Matrix<casa::Complex> mueller(nPol, nPol);
+  casa::Matrix<casa::Complex> reciprocal(nPol, nPol);
   
   // full 4x4 Mueller matrix
   casa::SquareMatrix<casa::Complex, 2> fullMueller(casa::SquareMatrix<casa::Complex, 2>::General);
@@ -161,6 +281,54 @@ void CalibrationApplicatorME::correct(accessors::IDataAccessor &chunk) const
   }
 }
 
+/// @brief prepare the cache of inverse Jones matrices for the given chunk
+/// @details The cache is cleared if the solution accessor has changed or the chunk
+/// has more channels than the cached entries hold. Entries are filled on demand for
+/// each antenna/beam pair, so only the pairs present in the data are allocated.
+/// @param[in] chunk accessor to work with
+void CalibrationApplicatorME::prepareInverseJones(const accessors::IConstDataAccessor &chunk) const
+{
+  if ((itsTableChangeMonitor != changeMonitor()) || (chunk.nChannel() > itsTableNChan)) {
+      // new solution interval or more channels
+      itsTableChangeMonitor = changeMonitor();
+      itsTableNChan = std::max(itsTableNChan, chunk.nChannel());
+      itsInverseJones.clear();
+  }
+}
+
+/// @brief obtain inverse Jones matrices for all channels of the given antenna and beam
+/// @details The entry is computed from the solution accessor if it is not in the cache yet.
+/// @param[in] ant antenna index
+/// @param[in] beam beam index (as used by the solution, i.e. after beamIndependent is applied)
+/// @return const reference to the cached matrices (stays valid until the cache is cleared)
+const CalibrationApplicatorME::InverseJones& CalibrationApplicatorME::inverseJones(casa::uInt ant, casa::uInt beam) const
+{
+  const std::pair<casa::uInt, casa::uInt> key(ant, beam);
+  std::map<std::pair<casa::uInt, casa::uInt>, InverseJones>::iterator it = itsInverseJones.find(key);
+  if (it != itsInverseJones.end()) {
+      return it->second;
+  }
+  InverseJones &entry = itsInverseJones[key];
+  entry.itsMatrices.resize(4 * itsTableNChan);
+  entry.itsDetSquared.resize(itsTableNChan);
+  for (casa::uInt chan = 0; chan < itsTableNChan; ++chan) {
+       const casa::SquareMatrix<casa::Complex, 2> jones = calSolution().jones(ant, beam, chan);
+       const casa::Complex det = jones(0,0) * jones(1,1) - jones(0,1) * jones(1,0);
+       const casa::Float detSquared = std::norm(det);
+       casa::Complex *inv = &entry.itsMatrices[4 * chan];
+       entry.itsDetSquared[chan] = detSquared;
+       if (detSquared > 0.) {
+           inv[0] = jones(1,1) / det;
+           inv[1] = -jones(0,1) / det;
+           inv[2] = -jones(1,0) / det;
+           inv[3] = jones(0,0) / det;
+       } else {
+           inv[0] = inv[1] = inv[2] = inv[3] = 0.;
+       }
+  }
+  return entry;
+}
+
 /// @brief determines whether to scale the noise estimate
 /// @details This is one of the configuration methods, it controlls
 /// whether the noise estimate is scaled aggording to applied calibration
@@ -42,10 +42,18 @@
 #include <calibaccess/ICalSolutionConstAccessor.h>
 #include <measurementequation/CalibrationSolutionHandler.h>
 #include <dataaccess/IDataAccessor.h>
+#include <dataaccess/IFlagAndNoiseDataAccessor.h>
+#include <utils/ChangeMonitor.h>
+#include <scimath/Mathematics/RigidVector.h>
 
 // boost includes
 #include <boost/shared_ptr.hpp>
 
+// std includes
+#include <vector>
+#include <map>
+#include <utility>
+
 namespace askap {
 
 namespace synthesis {
@@ -59,6 +67,16 @@ namespace synthesis {
 /// (essentially implemented by the solution access class returning a complete
 /// jones matrix for each antenna/beam combination). This class handles time-dependence
 /// properly provided the solution source interface supports it as well.
+///
+/// For the full set of polarisation products in the canonical order (e.g. XX,XY,YX,YY)
+/// the correction is done as V' = J1^{-1} V J2^{-H} with the inverse 2x2 Jones matrices
+/// computed once per solution interval. They are cached in a map indexed by the
+/// antenna/beam pair, which is filled on demand when a pair is first encountered in the data.
+/// Each entry holds the matrices for all channels contiguously. A dense [beam][antenna][channel]
+/// table is not used, because the number of antennas and beams is not known up front and
+/// such a table would have to be filled for pairs absent from the data (e.g. when only
+/// a subset of beams is imaged), which costs more than it saves.
+/// Other polarisation setups are handled via the general Mueller matrix per channel.
 /// @ingroup measurementequation
 class CalibrationApplicatorME : virtual public ICalibrationApplicator,
                                 protected CalibrationSolutionHandler {
@@ -99,6 +117,48 @@ public:
   virtual void beamIndependent(bool flag);
 
 private:
+  /// @brief correct visibilities via the inverse Jones matrices (full polarisation)
+  /// @details This is the fast path used for the full set of polarisation products
+  /// in the canonical order.
+  /// @param[in] chunk a read-write accessor to work with
+  /// @param[in] noiseAndFlagDA accessor to change flags and noise (may be empty
+  /// if neither flagging nor noise scaling is enabled)
+  void correctFullPol(accessors::IDataAccessor &chunk,
+               const boost::shared_ptr<accessors::IFlagAndNoiseDataAccessor> &noiseAndFlagDA) const;
+
+  /// @brief correct visibilities via the general Mueller matrix
+  /// @details This method supports an arbitrary subset of polarisation products
+  /// @param[in] chunk a read-write accessor to work with
+  /// @param[in] indices indices of polarisation products (see PolConverter::getIndex)
+  /// @param[in] noiseAndFlagDA accessor to change flags and noise (may be empty
+  /// if neither flagging nor noise scaling is enabled)
+  void correctGeneral(accessors::IDataAccessor &chunk, const casa::RigidVector<casa::uInt, 4> &indices,
+               const boost::shared_ptr<accessors::IFlagAndNoiseDataAccessor> &noiseAndFlagDA) const;
+
+  /// @brief inverse Jones matrices for all channels of one antenna/beam pair
+  struct InverseJones {
+     /// @brief inverse matrices, [channel][element]
+     /// @details Elements of each 2x2 matrix are stored in the row-major order
+     std::vector<casa::Complex> itsMatrices;
+
+     /// @brief squared amplitude of the Jones matrix determinant, [channel]
+     std::vector<casa::Float> itsDetSquared;
+  };
+
+  /// @brief prepare the cache of inverse Jones matrices for the given chunk
+  /// @details The cache is cleared if the solution accessor has changed or the chunk
+  /// has more channels than the cached entries hold. Entries are filled on demand for
+  /// each antenna/beam pair, so only the pairs present in the data are allocated.
+  /// @param[in] chunk accessor to work with
+  void prepareInverseJones(const accessors::IConstDataAccessor &chunk) const;
+
+  /// @brief obtain inverse Jones matrices for all channels of the given antenna and beam
+  /// @details The entry is computed from the solution accessor if it is not in the cache yet.
+  /// @param[in] ant antenna index
+  /// @param[in] beam beam index (as used by the solution, i.e. after beamIndependent is applied)
+  /// @return const reference to the cached matrices (stays valid until the cache is cleared)
+  const InverseJones& inverseJones(casa::uInt ant, casa::uInt beam) const;
+
   /// @brief true, if correct method is to scale the noise estimate
   bool itsScaleNoise;
   
@@ -107,6 +167,15 @@ private:
   
   /// @brief true, if beam index should be ignored and beam=0 corrections applied to all beams
   bool itsBeamIndependent;
+
+  /// @brief cache of inverse Jones matrices indexed by (antenna, beam)
+  mutable std::map<std::pair<casa::uInt, casa::uInt>, InverseJones> itsInverseJones;
+
+  /// @brief number of channels each cached entry holds
+  mutable casa::uInt itsTableNChan;
+
+  /// @brief change monitor of the solution accessor the cache corresponds to
+  mutable scimath::ChangeMonitor itsTableChangeMonitor;
 };
 
 } // namespace synthesis
@@ -0,0 +1,64 @@
+/// @file
+///
+/// @brief Interface for an object function acting on the normal equations of an image
+/// @details The imaging equation adds normal equations image by image after all data
+/// have been gridded. An object implementing this interface can act on the normal
+/// equations of an image as soon as they are final, while the remaining images are still
+/// being transformed. The main motivation was the overlap of the interrank reduction of
+/// the normal equations with computation.
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author agent <agent@local>
+
+#include <measurementequation/INormalEquationsUpdate.h>
+
+namespace askap {
+
+namespace synthesis {
+
+
+/// @brief virtual destructor (does nothing in this class)
+INormalEquationsUpdate::~INormalEquationsUpdate() {}
+
+/// @brief number of blocks the data should be split into
+/// @details The default implementation returns 1, i.e. all data are reported via parameterComplete.
+/// @return number of blocks requested
+casa::uInt INormalEquationsUpdate::nBlocks() const
+{
+  return 1;
+}
+
+/// @brief residual images for one block of data are complete
+/// @details This method is called for every block except the last one. The buffers
+/// are not modified by the equation afterwards. The default implementation does nothing.
+/// @param[in] dataVectors residual images of this block only (data vectors keyed by parameter name)
+void INormalEquationsUpdate::blockComplete(const std::map<std::string, casa::Vector<double> > &)
+{
+}
+
+
+} // namespace synthesis
+
+} // namespace askap
+
@@ -0,0 +1,91 @@
+/// @file
+///
+/// @brief Interface for an object function acting on the normal equations of an image
+/// @details The imaging equation adds normal equations image by image after all data
+/// have been gridded. An object implementing this interface can act on the normal
+/// equations of an image as soon as they are final, while the remaining images are still
+/// being transformed. The main motivation was the overlap of the interrank reduction of
+/// the normal equations with computation.
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author agent <agent@local>
+
+#ifndef I_NORMAL_EQUATIONS_UPDATE_H
+#define I_NORMAL_EQUATIONS_UPDATE_H
+
+// own includes
+#include <fitting/ImagingNormalEquations.h>
+
+// casa includes
+#include <casa/aips.h>
+#include <casa/Arrays/Vector.h>
+
+// std includes
+#include <string>
+#include <map>
+
+namespace askap {
+
+namespace synthesis {
+
+/// @brief Interface for an object function acting on the normal equations of an image
+/// @details The imaging equation calls this object for every image parameter as soon as
+/// its contribution to the normal equations is complete. The buffers of this parameter
+/// are not modified by the equation afterwards. Like IVisCubeUpdate, this interface allows
+/// to add interrank communication without a dependency of the measurement equation on MPI.
+/// Optionally, the data can be split into a number of blocks. The residual images of every block
+/// except the last one are then reported as soon as the block is gridded, so they can be processed
+/// while the following blocks are still being gridded.
+/// @ingroup measurementequation
+struct INormalEquationsUpdate {
+
+  /// @brief virtual destructor (does nothing in this class)
+  virtual ~INormalEquationsUpdate();
+
+  /// @brief normal equations for the given parameter are complete
+  /// @details If some blocks have been reported via blockComplete, the data vector of the given
+  /// normal equations contains the residual of the last block only, while the PSF and weights
+  /// always cover all data.
+  /// @param[in] ne normal equations
+  /// @param[in] name name of the parameter
+  virtual void parameterComplete(const scimath::ImagingNormalEquations &ne, const std::string &name) = 0;
+
+  /// @brief number of blocks the data should be split into
+  /// @details The default implementation returns 1, i.e. all data are reported via parameterComplete.
+  /// @return number of blocks requested
+  virtual casa::uInt nBlocks() const;
+
+  /// @brief residual images for one block of data are complete
+  /// @details This method is called for every block except the last one. The buffers
+  /// are not modified by the equation afterwards. The default implementation does nothing.
+  /// @param[in] dataVectors residual images of this block only (data vectors keyed by parameter name)
+  virtual void blockComplete(const std::map<std::string, casa::Vector<double> > &dataVectors);
+};
+
+} // namespace synthesis
+
+} // namespace askap
+
+#endif // #ifndef I_NORMAL_EQUATIONS_UPDATE_H
+
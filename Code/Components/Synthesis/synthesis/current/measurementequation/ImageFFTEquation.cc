@@ -34,6 +34,8 @@ ASKAP_LOGGER(logger, ".measurementequation.imagefftequation");
 #include <measurementequation/ImageFFTEquation.h>
 #include <measurementequation/SynthesisParamsHelper.h>
 #include <gridding/SphFuncVisGridder.h>
+#include <gridding/TableVisGridder.h>
+#include <gridding/GriddingPlan.h>
 #include <fitting/ImagingNormalEquations.h>
 #include <fitting/DesignMatrix.h>
 #include <fitting/Axes.h>
@@ -50,6 +52,8 @@ ASKAP_LOGGER(logger, ".measurementequation.imagefftequation");
 #include <casa/Arrays/ArrayMath.h>
 
 #include <stdexcept>
+#include <vector>
+#include <map>
 
 using askap::scimath::Params;
 using askap::scimath::Axes;
@@ -64,7 +68,7 @@ namespace askap
 
     ImageFFTEquation::ImageFFTEquation(const askap::scimath::Params& ip,
         IDataSharedIter& idi) : scimath::Equation(ip),
-      askap::scimath::ImagingEquation(ip), itsIdi(idi), itsSphFuncPSFGridder(false)
+      askap::scimath::ImagingEquation(ip), itsIdi(idi), itsSphFuncPSFGridder(false), itsNChunksLastPass(0)
     {
       itsGridder = IVisGridder::ShPtr(new SphFuncVisGridder());
       init();
@@ -72,7 +76,7 @@ namespace askap
     
 
     ImageFFTEquation::ImageFFTEquation(IDataSharedIter& idi) :
-      itsIdi(idi), itsSphFuncPSFGridder(false)
+      itsIdi(idi), itsSphFuncPSFGridder(false), itsNChunksLastPass(0)
     {
       itsGridder = IVisGridder::ShPtr(new SphFuncVisGridder());
       reference(defaultParameters().clone());
@@ -81,7 +85,7 @@ namespace askap
 
     ImageFFTEquation::ImageFFTEquation(const askap::scimath::Params& ip,
         IDataSharedIter& idi, IVisGridder::ShPtr gridder) : scimath::Equation(ip),
-      askap::scimath::ImagingEquation(ip), itsGridder(gridder), itsIdi(idi), itsSphFuncPSFGridder(false)
+      askap::scimath::ImagingEquation(ip), itsGridder(gridder), itsIdi(idi), itsSphFuncPSFGridder(false), itsNChunksLastPass(0)
     {
       init();
     }
@@ -89,7 +93,7 @@ namespace askap
 
     ImageFFTEquation::ImageFFTEquation(IDataSharedIter& idi,
         IVisGridder::ShPtr gridder) :
-      itsGridder(gridder), itsIdi(idi), itsSphFuncPSFGridder(false)
+      itsGridder(gridder), itsIdi(idi), itsSphFuncPSFGridder(false), itsNChunksLastPass(0)
     {
       reference(defaultParameters().clone());
       init();
@@ -139,6 +143,9 @@ namespace askap
         itsGridder = other.itsGridder;
         itsSphFuncPSFGridder = other.itsSphFuncPSFGridder;
         itsVisUpdateObject = other.itsVisUpdateObject;
+        itsPSFCache = other.itsPSFCache;
+        itsNEUpdateObject = other.itsNEUpdateObject;
+        itsNChunksLastPass = other.itsNChunksLastPass;
       }
       return *this;
     }
@@ -166,6 +173,40 @@ namespace askap
       itsVisUpdateObject = obj;
     }
     
+    /// @brief setup cache of PSF and weights between major cycles
+    /// @details Neither PSF nor weights depend on the model. If the cache is set,
+    /// PSF and weights obtained in the first call to calcImagingEquations are stored
+    /// and reused in subsequent calls, so PSF gridding and the calculation of weights
+    /// are skipped.
+    /// @param[in] cache shared pointer to the cache (or an empty shared pointer to turn this option off)
+    void ImageFFTEquation::setPSFCache(const PSFWeightsCache::ShPtr &cache)
+    {
+      itsPSFCache = cache;
+    }
+
+    /// @brief setup object function called when normal equations of an image are complete
+    /// @details Normal equations are added image by image after all data have been gridded.
+    /// If this object is set, it is called for every image as soon as its normal equations
+    /// are complete, while the remaining images are still being transformed. If the object
+    /// requests more than one block, residual images are also reported block by block.
+    /// @param[in] obj new object function (or an empty shared pointer to turn this option off)
+    void ImageFFTEquation::setNEUpdateObject(const boost::shared_ptr<INormalEquationsUpdate> &obj)
+    {
+      itsNEUpdateObject = obj;
+    }
+
+    /// @brief shared pointer to parameters
+    /// @details This method is called by the base class whenever the parameters are
+    /// replaced (setParameters or reference). The change monitors of images are reset
+    /// then, as they belong to the previous parameter object, so all images are
+    /// degridded again.
+    /// @return non-const reference to the shared pointer
+    const scimath::Params::ShPtr& ImageFFTEquation::rwParameters() const throw()
+    {
+      itsImageChangeMonitors.clear();
+      return scimath::Equation::rwParameters();
+    }
+
     /// @brief helper method to verify whether a parameter had been changed 
     /// @details This method checks whether a particular parameter is tracked. If 
     /// yes, its change monitor is used to verify the status since the last call of
@@ -260,9 +301,110 @@ namespace askap
     void ImageFFTEquation::setIterator(IDataSharedIter& idi)
     {
       itsIdi = idi;
+      // data may be different, cached PSF and weights can't be trusted
+      if (itsPSFCache) {
+          itsPSFCache->invalidate();
+      }
     }
     
 
+    /// @brief helper method to attach a gridding plan to the gridder
+    /// @details Only table-based gridders can use gridding plans, other gridders are left intact.
+    /// @param[in] gridder gridder to work with
+    /// @param[in] plan shared pointer to the plan (an empty pointer detaches the plan)
+    static void attachGriddingPlan(const IVisGridder::ShPtr &gridder, const GriddingPlan::ShPtr &plan)
+    {
+      const boost::shared_ptr<TableVisGridder> tvg = boost::dynamic_pointer_cast<TableVisGridder>(gridder);
+      if (tvg) {
+          tvg->setGriddingPlan(plan);
+      }
+    }
+
+    /// @brief helper class detaching gridding plans at the end of the scope
+    /// @details Plans are shared between gridders only for the duration of calcImagingEquations.
+    /// The destructor detaches the plan from all gridders it has been attached to via this
+    /// object, so the gridders don't keep a stale plan if an exception is thrown during gridding.
+    class GriddingPlanGuard {
+    public:
+      /// @brief empty guard
+      GriddingPlanGuard() {}
+
+      /// @brief detach plans from all gridders
+      ~GriddingPlanGuard()
+      {
+        for (std::vector<IVisGridder::ShPtr>::const_iterator ci = itsGridders.begin(); 
+             ci != itsGridders.end(); ++ci) {
+             attachGriddingPlan(*ci, GriddingPlan::ShPtr());
+        }
+      }
+
+      /// @brief attach plan to the gridder
+      /// @param[in] gridder gridder to work with
+      /// @param[in] plan shared pointer to the plan
+      void attach(const IVisGridder::ShPtr &gridder, const GriddingPlan::ShPtr &plan)
+      {
+        attachGriddingPlan(gridder, plan);
+        itsGridders.push_back(gridder);
+      }
+
+    private:
+      /// @brief gridders the plans have been attached to
+      std::vector<IVisGridder::ShPtr> itsGridders;
+
+      // no support for copy or assignment
+      GriddingPlanGuard(const GriddingPlanGuard&);
+      GriddingPlanGuard& operator=(const GriddingPlanGuard&);
+    };
+
+    /// @brief helper method to add an image of one block of data to the sum over blocks
+    /// @details The sum is a separate copy, so the block image can be passed on by reference.
+    /// @param[in] sum sum over blocks (empty before the first block)
+    /// @param[in] block image of one block
+    static void addToSum(casa::Array<double> &sum, const casa::Array<double> &block)
+    {
+      if (sum.nelements() == 0) {
+          sum.resize(block.shape());
+          sum = block;
+      } else {
+          sum += block;
+      }
+    }
+
+    /// @brief complete residual images for the block of data gridded so far
+    /// @details Residual grids are transformed and passed to the object function set by
+    /// setNEUpdateObject. Residual images and weights are also added to the given sums, then
+    /// the residual gridders are initialised again for the next block.
+    /// @param[in] completions names of images without the "image" prefix
+    /// @param[in] psfCached flags showing images with weights taken from the PSF cache
+    /// @param[in] residuals sums of residual images over blocks (by image name)
+    /// @param[in] weights sums of weights over blocks (by image name)
+    void ImageFFTEquation::completeBlock(const std::vector<std::string> &completions,
+               const std::vector<bool> &psfCached, std::map<std::string, casa::Array<double> > &residuals,
+               std::map<std::string, casa::Array<double> > &weights) const
+    {
+      ASKAPDEBUGASSERT(itsNEUpdateObject);
+      ASKAPDEBUGASSERT(completions.size() == psfCached.size());
+      std::map<std::string, casa::Vector<double> > dataVectors;
+      for (size_t i = 0; i < completions.size(); ++i) {
+           const string imageName("image"+completions[i]);
+           const casa::IPosition imageShape(parameters().value(imageName).shape());
+           const IVisGridder::ShPtr gridder = itsResidualGridders[imageName];
+           ASKAPDEBUGASSERT(gridder);
+           casa::Array<double> imageDeriv(imageShape);
+           gridder->finaliseGrid(imageDeriv);
+           addToSum(residuals[imageName], imageDeriv);
+           if (!psfCached[i]) {
+               casa::Array<double> imageWeight(imageShape);
+               gridder->finaliseWeights(imageWeight);
+               addToSum(weights[imageName], imageWeight);
+           }
+           // only the grid and weights are reset, PSF gridders carry on accumulating
+           gridder->initialiseGrid(parameters().axes(imageName), imageShape, false);
+           dataVectors[imageName].reference(imageDeriv.reform(casa::IPosition(1, imageDeriv.nelements())));
+      }
+      itsNEUpdateObject->blockComplete(dataVectors);
+    }
+
     // Calculate the residual visibility and image. We transform the model on the fly
     // so that we only have to read (and write) the data once. This uses more memory
     // but cuts down on IO
@@ -297,6 +439,11 @@ namespace askap
           }
         }
       }
+      if (itsPSFCache) {
+          itsPSFCache->setConfiguration(itsGridder, itsSphFuncPSFGridder);
+      }
+      // true for images with PSF and weights taken from the cache
+      std::vector<bool> psfCached(completions.size(), false);
       // Now we initialise appropriately
       ASKAPLOG_DEBUG_STR(logger, "Initialising for model degridding and residual gridding" );
       if (completions.size() == 0) {
@@ -309,6 +456,8 @@ namespace askap
         const Axes axes(parameters().axes(imageName));
         casa::Array<double> imagePixels(parameters().value(imageName).copy());
         const casa::IPosition imageShape(imagePixels.shape());
+        const size_t index = it - completions.begin();
+        psfCached[index] = itsPSFCache && itsPSFCache->has(imageName, axes, imageShape);
         /// First the model
         itsModelGridders[imageName]->customiseForContext(*it);
         itsModelGridders[imageName]->initialiseDegrid(axes, imagePixels);
@@ -318,14 +467,40 @@ namespace askap
         /// Now the residual images, dopsf=false
         itsResidualGridders[imageName]->customiseForContext(*it);
         itsResidualGridders[imageName]->initialiseGrid(axes, imageShape, false);
-        // and PSF gridders, dopsf=true
-        itsPSFGridders[imageName]->customiseForContext(*it);
-        itsPSFGridders[imageName]->initialiseGrid(axes, imageShape, true);        
+        // and PSF gridders, dopsf=true (unless PSF is taken from the cache)
+        if (psfCached[index]) {
+            ASKAPLOG_DEBUG_STR(logger, "PSF and weights for "<<imageName<<" will be taken from the cache");
+        } else {
+            itsPSFGridders[imageName]->customiseForContext(*it);
+            itsPSFGridders[imageName]->initialiseGrid(axes, imageShape, true);        
+        }
+      }
+      // per-sample bookkeeping depends only on the data and the geometry of the image, so
+      // model degridding, residual and PSF gridding for the same image share a single
+      // gridding plan, which is rebuilt for every chunk of data
+      // plans are not valid outside this method, the guard detaches them on exit
+      std::map<std::string, GriddingPlan::ShPtr> plans;
+      GriddingPlanGuard planGuard;
+      for (vector<string>::const_iterator it=completions.begin();it!=completions.end();it++)
+      {
+        const string imageName("image"+(*it));
+        const GriddingPlan::ShPtr plan(new GriddingPlan);
+        plans[imageName] = plan;
+        planGuard.attach(itsModelGridders[imageName], plan);
+        planGuard.attach(itsResidualGridders[imageName], plan);
+        planGuard.attach(itsPSFGridders[imageName], plan);
       }
       // synchronise emtpy flag across multiple ranks if necessary
       if (itsVisUpdateObject) {
           itsVisUpdateObject->aggregateFlag(somethingHasToBeDegridded);
       }      
+      // residual images can be completed block by block, the blocks are set up to have the
+      // same number of iterations, as counted in the previous pass over the data
+      const casa::uInt nBlocks = itsNEUpdateObject ? itsNEUpdateObject->nBlocks() : 1;
+      const size_t nChunksExpected = itsNChunksLastPass;
+      size_t nChunks = 0;
+      casa::uInt nBlocksDone = 0;
+      std::map<std::string, casa::Array<double> > blockResiduals, blockWeights;
       // Now we loop through all the data
       ASKAPLOG_DEBUG_STR(logger, "Starting degridding model and gridding residuals" );
       size_t counterGrid = 0, counterDegrid = 0;
@@ -334,6 +509,9 @@ namespace askap
         // buffer-accessor, used as a replacement for proper buffers held in the subtable
         // effectively, an array with the same shape as the visibility cube is held by this class
         MemBufferDataAccessor accBuffer(*itsIdi);
+        for (std::map<std::string, GriddingPlan::ShPtr>::const_iterator ci = plans.begin(); ci != plans.end(); ++ci) {
+             ci->second->invalidate();
+        }
          
         // Accumulate model visibility for all models
         accBuffer.rwVisibility().set(0.0);
@@ -373,10 +551,12 @@ namespace askap
                     #pragma omp task
                     #endif
                     itsResidualGridders[imageName]->grid(accBuffer);
-                    #ifdef _OPENMP
-                    #pragma omp task
-                    #endif
-                    itsPSFGridders[imageName]->grid(accBuffer);
+                    if (!psfCached[i]) {
+                        #ifdef _OPENMP
+                        #pragma omp task
+                        #endif
+                        itsPSFGridders[imageName]->grid(accBuffer);
+                    }
                     tempCounter += accBuffer.nRow();
                 }
            }
@@ -384,8 +564,20 @@ namespace askap
         }
 #endif
         counterGrid += tempCounter;
+        ++nChunks;
+        // the last block is completed after the loop together with PSF and weights
+        if ((nBlocksDone + 1 < nBlocks) && (nChunks * nBlocks >= (nBlocksDone + 1) * nChunksExpected) &&
+            (nChunksExpected > 0)) {
+            completeBlock(completions, psfCached, blockResiduals, blockWeights);
+            ++nBlocksDone;
+        }
       }
+      itsNChunksLastPass = nChunks;
       ASKAPLOG_DEBUG_STR(logger, "Finished degridding model and gridding residuals" );
+      if (nBlocksDone > 0) {
+          ASKAPLOG_DEBUG_STR(logger, "Residual images of "<<nBlocksDone<<" block(s) out of "<<nBlocks<<
+                             " have been completed while gridding");
+      }
       ASKAPLOG_DEBUG_STR(logger, "Number of accessor rows iterated through is "<<counterGrid<<" (gridding) and "<<
                         counterDegrid<<" (degridding)");
 
@@ -404,6 +596,11 @@ namespace askap
 
         itsResidualGridders[imageName]->finaliseGrid(imageDeriv);
         
+        if (psfCached[it - completions.begin()]) {
+            imagePSF = itsPSFCache->psf(imageName);
+            imageWeight = itsPSFCache->weights(imageName);
+        } else {
+        
         /*
         // for debugging/research, store grid prior to FFT
         boost::shared_ptr<TableVisGridder> tvg = boost::dynamic_pointer_cast<TableVisGridder>(itsPSFGridders[imageName]);
@@ -413,9 +610,17 @@ namespace askap
         // end debugging code
         */
 
-        itsPSFGridders[imageName]->finaliseGrid(imagePSF);
+            itsPSFGridders[imageName]->finaliseGrid(imagePSF);
 
-        itsResidualGridders[imageName]->finaliseWeights(imageWeight);
+            itsResidualGridders[imageName]->finaliseWeights(imageWeight);
+            if (nBlocksDone > 0) {
+                // weights of the blocks completed earlier
+                imageWeight += blockWeights[imageName];
+            }
+            if (itsPSFCache) {
+                itsPSFCache->add(imageName, parameters().axes(imageName), imagePSF, imageWeight);
+            }
+        }
         /*{ 
           casa::Array<double> imagePSFWeight(imageShape);
           itsPSFGridders[imageName]->finaliseWeights(imagePSFWeight);
@@ -440,9 +645,21 @@ namespace askap
           casa::Vector<double> imagePSFVec(imagePSF.reform(vecShape));
           casa::Vector<double> imageWeightVec(imageWeight.reform(vecShape));
           casa::Vector<double> imageDerivVec(imageDeriv.reform(vecShape));
+          if (nBlocksDone > 0) {
+              // residuals of the earlier blocks have been reported already, so only the last
+              // block is passed on, while the normal equations get the residual of all data
+              scimath::ImagingNormalEquations lastBlock;
+              lastBlock.addSlice(imageName, imagePSFVec, imageWeightVec, imageDerivVec,
+                  imageShape, reference);
+              itsNEUpdateObject->parameterComplete(lastBlock, imageName);
+              imageDeriv += blockResiduals[imageName];
+          }
           ne.addSlice(imageName, imagePSFVec, imageWeightVec, imageDerivVec,
               imageShape, reference);
         }
+        if (itsNEUpdateObject && (nBlocksDone == 0)) {
+            itsNEUpdateObject->parameterComplete(ne, imageName);
+        }
       }
     }
 
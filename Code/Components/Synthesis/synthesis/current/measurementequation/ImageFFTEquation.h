@@ -38,6 +38,8 @@
 #include <dataaccess/SharedIter.h>
 #include <dataaccess/IDataIterator.h>
 #include <measurementequation/IVisCubeUpdate.h>
+#include <measurementequation/INormalEquationsUpdate.h>
+#include <measurementequation/PSFWeightsCache.h>
 
 #include <casa/aips.h>
 #include <casa/Arrays/Array.h>
@@ -46,6 +48,8 @@
 #include <casa/Arrays/Cube.h>
 
 #include <map>
+#include <vector>
+#include <string>
 
 #include <boost/shared_ptr.hpp>
 
@@ -134,6 +138,36 @@ namespace askap
         /// By default, this class doesn't alter degridded visibilities.
         /// @param[in] obj new object function (or an empty shared pointer to turn this option off)
         void setVisUpdateObject(const boost::shared_ptr<IVisCubeUpdate> &obj);
+
+        /// @brief setup cache of PSF and weights between major cycles
+        /// @details Neither PSF nor weights depend on the model. If the cache is set,
+        /// PSF and weights obtained in the first call to calcImagingEquations are stored
+        /// and reused in subsequent calls, so PSF gridding and the calculation of weights
+        /// are skipped. The cache is invalidated if the gridder, the PSF gridder type, the
+        /// image geometry or the iterator changes. The same cache can be given to the
+        /// equation created for the same data in the next major cycle.
+        /// @param[in] cache shared pointer to the cache (or an empty shared pointer to turn this option off)
+        void setPSFCache(const PSFWeightsCache::ShPtr &cache);
+
+        /// @brief setup object function called when normal equations of an image are complete
+        /// @details Normal equations are added image by image after all data have been gridded.
+        /// If this object is set, it is called for every image as soon as its normal equations
+        /// are complete, while the remaining images are still being transformed. This is used
+        /// to start the reduction of normal equations across ranks early. If the object requests
+        /// more than one block, the data are split into blocks of roughly the same number of
+        /// iterations (as counted in the previous pass over the same data) and the residual images
+        /// of every block except the last one are passed to the object as soon as the block is
+        /// gridded. PSF and weights are only reported with the last block.
+        /// @param[in] obj new object function (or an empty shared pointer to turn this option off)
+        void setNEUpdateObject(const boost::shared_ptr<INormalEquationsUpdate> &obj);
+
+        /// @brief shared pointer to parameters
+        /// @details This method is called by the base class whenever the parameters are
+        /// replaced (setParameters or reference). The change monitors of images are reset
+        /// then, as they belong to the previous parameter object, so all images are
+        /// degridded again.
+        /// @return non-const reference to the shared pointer
+        virtual const scimath::Params::ShPtr& rwParameters() const throw();
         
       private:
       
@@ -182,6 +216,28 @@ namespace askap
         /// equation and the MPI one can use polymorphic object function to sum degridded visibilities 
         /// across all required ranks in the distributed case and do nothing otherwise.
         boost::shared_ptr<IVisCubeUpdate> itsVisUpdateObject;
+
+        /// @brief optional cache of PSF and weights between major cycles
+        PSFWeightsCache::ShPtr itsPSFCache;
+
+        /// @brief if set, this object is called for every image when its normal equations are complete
+        boost::shared_ptr<INormalEquationsUpdate> itsNEUpdateObject;
+
+        /// @brief number of iterations over the data done in the previous pass (zero if unknown)
+        /// @details This is used to split the data into blocks of roughly the same size
+        mutable size_t itsNChunksLastPass;
+
+        /// @brief complete residual images for the block of data gridded so far
+        /// @details Residual grids are transformed and passed to the object function set by
+        /// setNEUpdateObject. Residual images and weights are also added to the given sums, then
+        /// the residual gridders are initialised again for the next block.
+        /// @param[in] completions names of images without the "image" prefix
+        /// @param[in] psfCached flags showing images with weights taken from the PSF cache
+        /// @param[in] residuals sums of residual images over blocks (by image name)
+        /// @param[in] weights sums of weights over blocks (by image name)
+        void completeBlock(const std::vector<std::string> &completions, const std::vector<bool> &psfCached,
+                           std::map<std::string, casa::Array<double> > &residuals,
+                           std::map<std::string, casa::Array<double> > &weights) const;
     };
 
   }
@@ -0,0 +1,257 @@
+/// @file
+///
+/// ImageHogbomSolver: This solver cleans all parameters called image* with
+/// the Hogbom CLEAN, optionally done for spatial patches in parallel
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author agent <agent@local>
+///
+
+#include <askap_synthesis.h>
+#include <askap/AskapLogging.h>
+#include <boost/shared_ptr.hpp>
+
+ASKAP_LOGGER(logger, ".measurementequation.imagehogbomsolver");
+
+#include <askap/AskapError.h>
+
+// need it just for null deleter
+#include <askap/AskapUtil.h>
+
+#include <utils/MultiDimArrayPlaneIter.h>
+#include <profile/AskapProfiler.h>
+
+#include <casa/aips.h>
+#include <casa/Arrays/Array.h>
+#include <casa/Arrays/ArrayMath.h>
+#include <casa/Arrays/Vector.h>
+
+#include <measurementequation/ImageHogbomSolver.h>
+#include <deconvolution/DeconvolverHogbom.h>
+
+using namespace casa;
+using namespace askap;
+using namespace askap::scimath;
+
+#include <map>
+#include <vector>
+#include <string>
+
+using std::map;
+using std::vector;
+using std::string;
+
+namespace askap
+{
+  namespace synthesis
+  {
+    ImageHogbomSolver::ImageHogbomSolver() : itsNPatchesX(1), itsNPatchesY(1), itsPatchFraction(0.8)
+    {
+      // Now set up controller
+      itsControl = boost::shared_ptr<DeconvolverControl<Float> >(new DeconvolverControl<Float>());
+      // Now set up monitor
+      itsMonitor = boost::shared_ptr<DeconvolverMonitor<Float> >(new DeconvolverMonitor<Float>());
+    }
+
+    void ImageHogbomSolver::configure(const LOFAR::ParameterSet &parset) {
+
+      ImageCleaningSolver::configure(parset);
+
+      ASKAPASSERT(this->itsMonitor);
+      this->itsMonitor->configure(parset);
+      ASKAPASSERT(this->itsControl);
+      this->itsControl->configure(parset);
+
+      const std::vector<int> patches = parset.getInt32Vector("patches", std::vector<int>(2, 1));
+      ASKAPCHECK(patches.size() == 2, "patches parameter should have exactly 2 elements, you have "
+                 << patches.size());
+      ASKAPCHECK((patches[0] > 0) && (patches[1] > 0), "Number of patches should be positive, you have "
+                 << patches[0] << "x" << patches[1]);
+      itsNPatchesX = casa::uInt(patches[0]);
+      itsNPatchesY = casa::uInt(patches[1]);
+      itsPatchFraction = parset.getFloat("patches.fraction", 0.8);
+      ASKAPCHECK((itsPatchFraction > 0.) && (itsPatchFraction <= 1.),
+                 "patches.fraction should be within (0,1], you have " << itsPatchFraction);
+      if (hasPatches()) {
+          ASKAPLOG_INFO_STR(logger, "Minor cycles will be done for " << itsNPatchesX << "x" << itsNPatchesY
+                            << " patches in parallel, synchronised at " << itsPatchFraction
+                            << " of the peak residual");
+      }
+    }
+
+    void ImageHogbomSolver::setPatchComms(const boost::shared_ptr<IPatchComms> &comms)
+    {
+      itsPatchComms = comms;
+    }
+
+    void ImageHogbomSolver::init()
+    {
+      resetNormalEquations();
+    }
+
+    /// @brief Solve for parameters, updating the values kept internally
+    /// The solution is constructed from the normal equations. The parameters named
+    /// image* are interpreted as images and solved for.
+    /// @param[in] ip current model (to be updated)
+    /// @param[in] quality Solution quality information
+    bool ImageHogbomSolver::solveNormalEquations(askap::scimath::Params& ip, askap::scimath::Quality& quality)
+    {
+      ASKAPTRACE("ImageHogbomSolver::solveNormalEquations");
+
+      // Solving A^T Q^-1 V = (A^T Q^-1 A) P
+      uint nParameters=0;
+
+      // Find all the free parameters beginning with image
+      vector<string> names(ip.completions("image"));
+      map<string, uint> indices;
+
+      for (vector<string>::const_iterator  it=names.begin();it!=names.end();it++)
+	{
+	  const std::string name="image"+*it;
+	  if(ip.isFree(name)) {
+	    indices[name]=nParameters;
+	    nParameters+=ip.value(name).nelements();
+	  }
+	}
+      ASKAPCHECK(nParameters>0, "No free parameters in ImageHogbomSolver");
+
+      // the gain and the number of iterations are set up by the factory
+      ASKAPDEBUGASSERT(itsControl);
+      itsControl->setGain(gain());
+      itsControl->setTargetIter(niter());
+
+      for (map<string, uint>::const_iterator indit=indices.begin();indit!=indices.end();++indit)
+	{
+	  for (scimath::MultiDimArrayPlaneIter planeIter(ip.value(indit->first).shape());
+	       planeIter.hasMore(); planeIter.next()) {
+
+	    ASKAPCHECK(normalEquations().normalMatrixDiagonal().count(indit->first)>0, "Diagonal not present for "<<
+		       indit->first);
+	    casa::Vector<double> diag(normalEquations().normalMatrixDiagonal().find(indit->first)->second);
+	    ASKAPCHECK(normalEquations().dataVector(indit->first).size()>0, "Data vector not present for "<<
+		       indit->first);
+	    casa::Vector<double> dv = normalEquations().dataVector(indit->first);
+	    ASKAPCHECK(normalEquations().normalMatrixSlice().count(indit->first)>0, "PSF Slice not present for "<<
+		       indit->first);
+	    casa::Vector<double> slice(normalEquations().normalMatrixSlice().find(indit->first)->second);
+
+	    if (planeIter.tag()!="") {
+	      // it is not a single plane case, there is something to report
+	      ASKAPLOG_INFO_STR(logger, "Processing plane "<<planeIter.sequenceNumber()<<
+				" tagged as "<<planeIter.tag());
+	    }
+
+	    casa::Array<float> dirtyArray = padImage(planeIter.getPlane(dv));
+	    casa::Array<float> psfArray = padImage(planeIter.getPlane(slice));
+	    casa::Array<float> cleanArray = padImage(planeIter.getPlane(ip.value(indit->first)));
+	    casa::Array<float> maskArray(dirtyArray.shape());
+	    ASKAPLOG_INFO_STR(logger, "Plane shape "<<planeIter.planeShape()<<" becomes "<<
+			      dirtyArray.shape()<<" after padding");
+
+	    if(doPreconditioning(psfArray,dirtyArray)) {
+	      // Normalize
+	      doNormalization(padDiagonal(planeIter.getPlane(diag)),tol(),psfArray,dirtyArray,
+			      boost::shared_ptr<casa::Array<float> >(&maskArray, utility::NullDeleter()));
+	      // Store the new PSF in parameter class to be saved to disk later
+	      saveArrayIntoParameter(ip, indit->first, planeIter.shape(), "psf.image", unpadImage(psfArray),
+				     planeIter.position());
+	    }
+	    else {
+	      // Normalize
+	      doNormalization(padDiagonal(planeIter.getPlane(diag)),tol(),psfArray,dirtyArray,
+			      boost::shared_ptr<casa::Array<float> >(&maskArray, utility::NullDeleter()));
+	    }
+
+	    // optionally clip the image and psf if there was padding
+	    ASKAPLOG_INFO_STR(logger, "Peak data vector flux (derivative) before clipping "<<max(dirtyArray));
+	    clipImage(dirtyArray);
+	    clipImage(psfArray);
+	    ASKAPLOG_INFO_STR(logger, "Peak data vector flux (derivative) after clipping "<<max(dirtyArray));
+
+	    saveArrayIntoParameter(ip, indit->first, planeIter.shape(), "residual",
+				   unpadImage(dirtyArray), planeIter.position());
+	    saveArrayIntoParameter(ip, indit->first, planeIter.shape(), "mask", unpadImage(maskArray),
+				   planeIter.position());
+
+	    // Startup costs so little it's better to create a new
+	    // deconvolver each time we need it
+	    boost::shared_ptr<DeconvolverHogbom<float, casa::Complex> >
+	      hogbomDec(new DeconvolverHogbom<float, casa::Complex>(dirtyArray, psfArray));
+	    ASKAPDEBUGASSERT(hogbomDec);
+	    hogbomDec->setMonitor(itsMonitor);
+	    hogbomDec->setControl(itsControl);
+	    hogbomDec->setWeight(maskArray);
+	    hogbomDec->setModel(cleanArray);
+	    hogbomDec->setPatches(itsNPatchesX, itsNPatchesY, itsPatchFraction);
+	    if (hasPatches()) {
+	      hogbomDec->setPatchComms(itsPatchComms);
+	    }
+
+	    // We have to reset the initial objective function
+	    // so that the fractional threshold mechanism will work.
+	    hogbomDec->state()->resetInitialObjectiveFunction();
+	    // By convention, iterations are counted from scratch each
+	    // major cycle
+	    hogbomDec->state()->setCurrentIter(0);
+
+	    hogbomDec->control()->setTargetObjectiveFunction(threshold().getValue("Jy"));
+	    hogbomDec->control()->setFractionalThreshold(fractionalThreshold());
+
+	    ASKAPLOG_INFO_STR(logger, "Starting Hogbom deconvolution");
+	    hogbomDec->deconvolve();
+	    ASKAPLOG_INFO_STR(logger, "Peak flux of the Hogbom image "
+			      << max(hogbomDec->model()));
+	    ASKAPLOG_INFO_STR(logger, "Peak residual of Hogbom image "
+			      << max(abs(hogbomDec->dirty())));
+
+	    const std::string peakResParam = std::string("peak_residual.") + indit->first;
+	    if (ip.has(peakResParam)) {
+	      ip.update(peakResParam, hogbomDec->state()->peakResidual());
+	    } else {
+	      ip.add(peakResParam, hogbomDec->state()->peakResidual());
+	    }
+	    ip.fix(peakResParam);
+	    planeIter.getPlane(ip.value(indit->first)).nonDegenerate()=unpadImage(hogbomDec->model());
+	  } // loop over all planes of the image cube
+	} // loop over map of indices
+
+      quality.setDOF(nParameters);
+      quality.setRank(0);
+      quality.setCond(0.0);
+      quality.setInfo("Hogbom deconvolver");
+
+      /// Save the PSF and Weight
+      saveWeights(ip);
+      savePSF(ip);
+
+      return true;
+    };
+
+    Solver::ShPtr ImageHogbomSolver::clone() const
+    {
+      return Solver::ShPtr(new ImageHogbomSolver(*this));
+    }
+
+  }
+}
@@ -0,0 +1,109 @@
+/// @file
+///
+/// ImageHogbomSolver: This solver cleans all parameters called image* with
+/// the Hogbom CLEAN, optionally done for spatial patches in parallel
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author agent <agent@local>
+///
+#ifndef SYNIMAGEHOGBOMSOLVER_H_
+#define SYNIMAGEHOGBOMSOLVER_H_
+
+#include <measurementequation/ImageCleaningSolver.h>
+
+#include <deconvolution/DeconvolverHogbom.h>
+#include <deconvolution/IPatchComms.h>
+
+#include <boost/shared_ptr.hpp>
+
+namespace askap {
+    namespace synthesis {
+        /// @brief Hogbom CLEAN solver for images.
+        /// @details Unlike ImageMultiScaleSolver set up for the Hogbom algorithm, this solver uses
+        /// DeconvolverHogbom, which can split the minor cycles into spatial patches cleaned in
+        /// parallel (see DeconvolverHogbom::setPatches). The patches can also be shared with
+        /// other ranks via the communicator given by setPatchComms.
+        ///
+        /// @ingroup measurementequation
+        class ImageHogbomSolver : public ImageCleaningSolver {
+            public:
+
+                /// @brief default constructor
+                ImageHogbomSolver();
+
+                /// @brief Initialize this solver
+                virtual void init();
+
+                /// @brief Solve for parameters, updating the values kept internally
+                /// The solution is constructed from the normal equations. The parameters named
+                /// image* are interpreted as images and solved for.
+                /// @param[in] ip current model (to be updated)
+                /// @param[in] quality Solution quality information
+                virtual bool solveNormalEquations(askap::scimath::Params& ip, askap::scimath::Quality& quality);
+
+                /// @brief Clone this object
+                /// @return a shared pointer to the clone
+                virtual askap::scimath::Solver::ShPtr clone() const;
+
+                /// @brief configure basic parameters of the solver
+                /// @details This method encapsulates extraction of basic solver parameters from the parset.
+                /// In addition to the parameters of ImageCleaningSolver, patches and patches.fraction
+                /// are understood.
+                /// @param[in] parset parset's subset (should have solver.Clean or solver.Dirty removed)
+                virtual void configure(const LOFAR::ParameterSet &parset);
+
+                /// @brief share the patches with other ranks
+                /// @details The communicator is passed to the deconvolver of every plane (see
+                /// DeconvolverHogbom::setPatchComms). It is only used if there is more than one patch.
+                /// @param[in] comms communicator to use (an empty pointer switches the sharing off)
+                void setPatchComms(const boost::shared_ptr<IPatchComms> &comms);
+
+                /// @brief check whether the patches are cleaned in parallel
+                /// @return true if there is more than one patch
+                inline bool hasPatches() const { return itsNPatchesX * itsNPatchesY > 1; }
+
+            protected:
+
+                boost::shared_ptr<DeconvolverControl<Float> > itsControl;
+
+                boost::shared_ptr<DeconvolverMonitor<Float> > itsMonitor;
+
+            private:
+
+                /// @brief number of patches along the first axis
+                casa::uInt itsNPatchesX;
+
+                /// @brief number of patches along the second axis
+                casa::uInt itsNPatchesY;
+
+                /// @brief fraction of the peak residual to clean down to in each round
+                casa::Float itsPatchFraction;
+
+                /// @brief communicator to share the patches with other ranks (may be empty)
+                boost::shared_ptr<IPatchComms> itsPatchComms;
+        };
+
+    }
+}
+#endif
@@ -33,6 +33,7 @@ ASKAP_LOGGER(logger, ".measurementequation.imagesolverfactory");
 #include <measurementequation/ImageMultiScaleSolver.h>
 #include <measurementequation/ImageBasisFunctionSolver.h>
 #include <measurementequation/ImageFistaSolver.h>
+#include <measurementequation/ImageHogbomSolver.h>
 #include <measurementequation/ImageMSMFSolver.h>
 #include <measurementequation/ImageAMSMFSolver.h>
 #include <measurementequation/IImagePreconditioner.h>
@@ -233,8 +234,14 @@ namespace askap
 	  solver.reset(new ImageBasisFunctionSolver(scales));
 	}
 	else if(algorithm=="Hogbom") {
-	  ASKAPLOG_INFO_STR(logger, "Constructing Hogbom Clean solver");
-	  solver.reset(new ImageMultiScaleSolver());
+	  if (parset.isDefined("solver.Clean.patches")) {
+	    // only this solver can clean spatial patches in parallel
+	    ASKAPLOG_INFO_STR(logger, "Constructing Hogbom Clean solver (ASKAP version)");
+	    solver.reset(new ImageHogbomSolver());
+	  } else {
+	    ASKAPLOG_INFO_STR(logger, "Constructing Hogbom Clean solver");
+	    solver.reset(new ImageMultiScaleSolver());
+	  }
 	}
 	else if ((algorithm=="MSMFS")||(algorithm=="MultiScaleMFS")) {
 	  ASKAPCHECK(!parset.isDefined("solver.nterms"), "Specify nterms for each image instead of using solver.nterms");
@@ -0,0 +1,142 @@
+/// @file
+///
+/// @brief Cache of PSF and weights images between major cycles
+/// @details Neither the PSF nor the weights depend on the model, therefore they
+/// are the same in every major cycle as long as the data selection, the image
+/// geometry and the gridder are not changed. This class holds PSF and weights
+/// images obtained in the first major cycle, so the subsequent major cycles can
+/// skip PSF gridding and the calculation of weights.
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author agent <agent@local>
+
+#include <measurementequation/PSFWeightsCache.h>
+#include <askap/AskapError.h>
+
+namespace askap {
+
+namespace synthesis {
+
+/// @brief construct an empty cache
+PSFWeightsCache::PSFWeightsCache() : itsSphFuncPSF(false) {}
+
+/// @brief bind the cache to the given configuration
+/// @details All cached images are dropped if the configuration differs from
+/// that used to fill the cache.
+/// @param[in] gridder prototype gridder
+/// @param[in] sphFuncPSF true, if spheroidal function gridder is used for PSF
+void PSFWeightsCache::setConfiguration(const IVisGridder::ShPtr &gridder, const bool sphFuncPSF)
+{
+   if ((gridder != itsGridder) || (sphFuncPSF != itsSphFuncPSF)) {
+       invalidate();
+       itsGridder = gridder;
+       itsSphFuncPSF = sphFuncPSF;
+   }
+}
+
+/// @brief check whether two sets of axes describe the same image
+/// @param[in] first first set of axes
+/// @param[in] second second set of axes
+/// @return true, if the axes are the same
+bool PSFWeightsCache::sameAxes(const scimath::Axes &first, const scimath::Axes &second)
+{
+   if ((first.names() != second.names()) || (first.start() != second.start()) ||
+       (first.end() != second.end())) {
+       return false;
+   }
+   if (first.hasDirection() != second.hasDirection()) {
+       return false;
+   }
+   if (first.hasDirection()) {
+       return first.directionAxis().near(second.directionAxis());
+   }
+   return true;
+}
+
+/// @brief check whether the PSF and weights are cached for the given image
+/// @param[in] name name of the image parameter
+/// @param[in] axes axes of the image
+/// @param[in] shape shape of the image
+/// @return true, if the cached images can be used
+bool PSFWeightsCache::has(const std::string &name, const scimath::Axes &axes, const casa::IPosition &shape) const
+{
+   const std::map<std::string, Entry>::const_iterator ci = itsEntries.find(name);
+   if (ci == itsEntries.end()) {
+       return false;
+   }
+   return (ci->second.itsPSF.shape() == shape) && sameAxes(ci->second.itsAxes, axes);
+}
+
+/// @brief add PSF and weights for the given image
+/// @details The arrays are copied.
+/// @param[in] name name of the image parameter
+/// @param[in] axes axes of the image
+/// @param[in] psf PSF image
+/// @param[in] weights weights image
+void PSFWeightsCache::add(const std::string &name, const scimath::Axes &axes, const casa::Array<double> &psf,
+                          const casa::Array<double> &weights)
+{
+   ASKAPCHECK(psf.shape() == weights.shape(), "Shapes of PSF ("<<psf.shape()<<") and weights ("<<
+              weights.shape()<<") are supposed to be the same");
+   Entry &newEntry = itsEntries[name];
+   newEntry.itsAxes = axes;
+   newEntry.itsPSF = psf.copy();
+   newEntry.itsWeights = weights.copy();
+}
+
+/// @brief obtain the entry for the given image
+/// @param[in] name name of the image parameter
+/// @return const reference to the entry (exception is thrown if not found)
+const PSFWeightsCache::Entry& PSFWeightsCache::entry(const std::string &name) const
+{
+   const std::map<std::string, Entry>::const_iterator ci = itsEntries.find(name);
+   ASKAPCHECK(ci != itsEntries.end(), "PSF and weights for "<<name<<" are not cached");
+   return ci->second;
+}
+
+/// @brief obtain cached PSF image
+/// @param[in] name name of the image parameter
+/// @return const reference to PSF image
+const casa::Array<double>& PSFWeightsCache::psf(const std::string &name) const
+{
+   return entry(name).itsPSF;
+}
+
+/// @brief obtain cached weights image
+/// @param[in] name name of the image parameter
+/// @return const reference to weights image
+const casa::Array<double>& PSFWeightsCache::weights(const std::string &name) const
+{
+   return entry(name).itsWeights;
+}
+
+/// @brief drop all cached images
+void PSFWeightsCache::invalidate()
+{
+   itsEntries.clear();
+}
+
+} // namespace synthesis
+
+} // namespace askap
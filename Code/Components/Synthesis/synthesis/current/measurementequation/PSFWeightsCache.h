@@ -0,0 +1,151 @@
+/// @file
+///
+/// @brief Cache of PSF and weights images between major cycles
+/// @details Neither the PSF nor the weights depend on the model, therefore they
+/// are the same in every major cycle as long as the data selection, the image
+/// geometry and the gridder are not changed. This class holds PSF and weights
+/// images obtained in the first major cycle, so the subsequent major cycles can
+/// skip PSF gridding and the calculation of weights.
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author agent <agent@local>
+
+#ifndef PSF_WEIGHTS_CACHE_H
+#define PSF_WEIGHTS_CACHE_H
+
+// own includes
+#include <fitting/Axes.h>
+#include <gridding/IVisGridder.h>
+
+// casa includes
+#include <casa/Arrays/Array.h>
+
+// boost includes
+#include <boost/shared_ptr.hpp>
+
+// std includes
+#include <map>
+#include <string>
+
+namespace askap {
+
+namespace synthesis {
+
+/// @brief Cache of PSF and weights images between major cycles
+/// @details Neither the PSF nor the weights depend on the model, therefore they
+/// are the same in every major cycle as long as the data selection, the image
+/// geometry and the gridder are not changed. This class holds PSF and weights
+/// images per image parameter. Each entry is tagged with the image shape and axes,
+/// an entry is ignored if they don't match. The whole cache is bound to the
+/// prototype gridder it has been filled with and is invalidated when a different
+/// gridder is used. The code setting up the cache is responsible for having separate
+/// caches for different data selections (e.g. per measurement set).
+/// @note The cached weights are only valid if the data weights do not change between
+/// major cycles (e.g. no calibration solution updated in between)
+/// @ingroup measurementequation
+class PSFWeightsCache {
+public:
+   /// @brief shared pointer type
+   typedef boost::shared_ptr<PSFWeightsCache> ShPtr;
+
+   /// @brief construct an empty cache
+   PSFWeightsCache();
+
+   /// @brief bind the cache to the given configuration
+   /// @details All cached images are dropped if the configuration differs from
+   /// that used to fill the cache.
+   /// @param[in] gridder prototype gridder
+   /// @param[in] sphFuncPSF true, if spheroidal function gridder is used for PSF
+   void setConfiguration(const IVisGridder::ShPtr &gridder, const bool sphFuncPSF);
+
+   /// @brief check whether the PSF and weights are cached for the given image
+   /// @param[in] name name of the image parameter
+   /// @param[in] axes axes of the image
+   /// @param[in] shape shape of the image
+   /// @return true, if the cached images can be used
+   bool has(const std::string &name, const scimath::Axes &axes, const casa::IPosition &shape) const;
+
+   /// @brief add PSF and weights for the given image
+   /// @details The arrays are copied.
+   /// @param[in] name name of the image parameter
+   /// @param[in] axes axes of the image
+   /// @param[in] psf PSF image
+   /// @param[in] weights weights image
+   void add(const std::string &name, const scimath::Axes &axes, const casa::Array<double> &psf,
+            const casa::Array<double> &weights);
+
+   /// @brief obtain cached PSF image
+   /// @param[in] name name of the image parameter
+   /// @return const reference to PSF image
+   const casa::Array<double>& psf(const std::string &name) const;
+
+   /// @brief obtain cached weights image
+   /// @param[in] name name of the image parameter
+   /// @return const reference to weights image
+   const casa::Array<double>& weights(const std::string &name) const;
+
+   /// @brief drop all cached images
+   void invalidate();
+
+   /// @brief number of cached images
+   size_t size() const { return itsEntries.size(); }
+
+protected:
+   /// @brief check whether two sets of axes describe the same image
+   /// @param[in] first first set of axes
+   /// @param[in] second second set of axes
+   /// @return true, if the axes are the same
+   static bool sameAxes(const scimath::Axes &first, const scimath::Axes &second);
+
+private:
+   /// @brief cached images and the geometry they correspond to
+   struct Entry {
+      /// @brief axes of the image
+      scimath::Axes itsAxes;
+      /// @brief PSF image
+      casa::Array<double> itsPSF;
+      /// @brief weights image
+      casa::Array<double> itsWeights;
+   };
+
+   /// @brief obtain the entry for the given image
+   /// @param[in] name name of the image parameter
+   /// @return const reference to the entry (exception is thrown if not found)
+   const Entry& entry(const std::string &name) const;
+
+   /// @brief cached images per image parameter
+   std::map<std::string, Entry> itsEntries;
+
+   /// @brief prototype gridder the cache has been filled with
+   IVisGridder::ShPtr itsGridder;
+
+   /// @brief true if spheroidal function gridder was used for PSF
+   bool itsSphFuncPSF;
+};
+
+} // namespace synthesis
+
+} // namespace askap
+
+#endif // #ifndef PSF_WEIGHTS_CACHE_H
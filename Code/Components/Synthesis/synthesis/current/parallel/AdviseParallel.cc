@@ -259,6 +259,7 @@ void AdviseParallel::calcOne(const std::string &ms)
    
    accessors::TableDataSource ds(ms, accessors::TableDataSource::MEMORY_BUFFERS, dataColumn());
    ds.configureUVWMachineCache(uvwMachineCacheSize(),uvwMachineCacheTolerance());      
+   ds.configureReadAhead(readAheadChunks());
    accessors::IDataSelectorPtr sel=ds.createSelector();
    sel << parset();
    accessors::IDataConverterPtr conv=ds.createConverter();
@@ -286,7 +287,11 @@ void AdviseParallel::calcNE()
    if (itsComms.isWorker()) {
        ASKAPCHECK(itsNe, "Statistics estimator (stored as NormalEquations) is not defined");
        if (itsComms.isParallel()) {
-           calcOne(measurementSets()[itsComms.rank()-1]);
+           // datasets are distributed round-robin, so this also works if the number of
+           // datasets doesn't match the number of workers (e.g. with dynamic scheduling in the imager)
+           for (size_t iMs = itsComms.rank() - 1; iMs < measurementSets().size(); iMs += itsComms.nProcs() - 1) {
+                calcOne(measurementSets()[iMs]);
+           }
            sendNE();
        } else {
           for (size_t iMs=0; iMs<measurementSets().size(); ++iMs) {
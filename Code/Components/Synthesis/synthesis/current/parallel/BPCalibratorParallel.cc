@@ -483,6 +483,7 @@ void BPCalibratorParallel::calcOne(const std::string& ms, const casa::uInt chan,
       ASKAPLOG_INFO_STR(logger, "Creating measurement equation" );
       accessors::TableDataSource ds(ms, accessors::TableDataSource::DEFAULT, dataColumn());
       ds.configureUVWMachineCache(uvwMachineCacheSize(),uvwMachineCacheTolerance());      
+      ds.configureReadAhead(readAheadChunks());
       accessors::IDataSelectorPtr sel=ds.createSelector();
       sel << parset();
       sel->chooseChannels(1,chan);
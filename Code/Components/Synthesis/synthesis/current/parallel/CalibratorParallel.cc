@@ -247,6 +247,7 @@ void CalibratorParallel::calcOne(const std::string& ms, bool discard)
           ASKAPLOG_INFO_STR(logger, "Creating iterator over data" );
           TableDataSource ds(ms, TableDataSource::DEFAULT, dataColumn());
           ds.configureUVWMachineCache(uvwMachineCacheSize(),uvwMachineCacheTolerance());      
+          ds.configureReadAhead(readAheadChunks());
           IDataSelectorPtr sel=ds.createSelector();
           if (itsChannelsPerWorker > 0) {
               ASKAPLOG_INFO_STR(logger, "Setting up selector for "<<itsChannelsPerWorker<<" channels starting from "<<itsStartChan);
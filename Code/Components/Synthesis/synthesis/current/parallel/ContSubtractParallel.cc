@@ -185,6 +185,7 @@ void ContSubtractParallel::calcOne(const std::string &ms)
  
    TableDataSource ds(ms, TableDataSource::WRITE_PERMITTED, dataColumn());
    ds.configureUVWMachineCache(uvwMachineCacheSize(),uvwMachineCacheTolerance());      
+   ds.configureReadAhead(readAheadChunks());
    IDataSelectorPtr sel=ds.createSelector();
    sel << parset();
    IDataConverterPtr conv=ds.createConverter();
@@ -47,6 +47,8 @@ ASKAP_LOGGER(logger, ".parallel");
 #include <dataaccess/DataAccessError.h>
 #include <dataaccess/TableDataSource.h>
 #include <dataaccess/ParsetInterface.h>
+#include <dataaccess/CachingIteratorAdapter.h>
+#include <dataaccess/AveragingIteratorAdapter.h>
 
 #include <measurementequation/ImageFFTEquation.h>
 #include <measurementequation/SynthesisParamsHelper.h>
@@ -56,24 +58,32 @@ ASKAP_LOGGER(logger, ".parallel");
 #include <measurementequation/NoXPolGain.h>
 #include <measurementequation/ImageParamsHelper.h>
 #include <fitting/Params.h>
+#include <fitting/Axes.h>
 #include <utils/MultiDimArrayPlaneIter.h>
 
 #include <measurementequation/ImageSolverFactory.h>
+#include <measurementequation/ImageHogbomSolver.h>
+#include <deconvolution/DeconvolverHogbom.h>
 #include <calibaccess/CalibAccessFactory.h>
 #include <measurementequation/CalibrationApplicatorME.h>
 #include <profile/AskapProfiler.h>
 #include <parallel/GroupVisAggregator.h>
+#include <parallel/MPIPatchComms.h>
 #include <parallel/AdviseParallel.h>
 
 #include <casa/aips.h>
 #include <casa/OS/Timer.h>
 
+#include <boost/bind.hpp>
+
 #include <Common/ParameterSet.h>
 
 #include <stdexcept>
 #include <iostream>
 #include <vector>
 #include <string>
+#include <algorithm>
+#include <cmath>
 
 using namespace askap;
 using namespace askap::scimath;
@@ -89,9 +99,80 @@ namespace askap
 
     ImagerParallel::ImagerParallel(askap::askapparallel::AskapParallel& comms,
         const LOFAR::ParameterSet& parset) :
-      MEParallelApp(comms,parset),
-      itsExportSensitivityImage(false), itsExpSensitivityCutoff(0.)
+      MEParallelApp(comms,parset,true),
+      itsExportSensitivityImage(false), itsExpSensitivityCutoff(0.), itsSinglePrecisionNE(false),
+      itsUseVisCache(false), itsVisCacheLimit(0), itsPreAverage(false), itsPreAverageTime(-1.),
+      itsPreAverageNChan(1), itsPreAverageTolerance(0.),
+      itsPreAveragePointingTolerance(1e-6), itsUseThreads(false)
     {
+      const std::string nePrecision = parset.getString("normalequations.precision", "double");
+      ASKAPCHECK((nePrecision == "single") || (nePrecision == "double"), 
+                 "normalequations.precision is supposed to be either single or double, you have "<<nePrecision);
+      itsSinglePrecisionNE = (nePrecision == "single");
+      if (itsSinglePrecisionNE && itsComms.isWorker()) {
+          ASKAPLOG_INFO_STR(logger, "Normal equations will be sent to the master in single precision");
+      }
+      const std::string scheduling = parset.getString("scheduling", "static");
+      ASKAPCHECK((scheduling == "static") || (scheduling == "dynamic"),
+                 "scheduling is supposed to be either static or dynamic, you have "<<scheduling);
+      if ((scheduling == "dynamic") && itsComms.isParallel()) {
+          ASKAPCHECK(itsComms.nGroups() == 1, "Dynamic scheduling can't be combined with nworkergroups > 1");
+          itsScheduler.reset(new WorkUnitScheduler(parset));
+      }
+      // each thread of the pool processes a block of channels with its own equation,
+      // MPI calls are only made from the main thread, so there is no interrank
+      // communication during gridding
+      if (threadPool() && itsComms.isWorker()) {
+          if (itsScheduler) {
+              ASKAPLOG_WARN_STR(logger, "Thread pool is not used with dynamic scheduling, work units are processed one by one");
+          } else if (itsComms.nGroups() > 1) {
+              ASKAPLOG_WARN_STR(logger, "Thread pool is not used with nworkergroups > 1");
+          } else {
+              itsUseThreads = true;
+          }
+      }
+      itsUseVisCache = parset.getBool("visibilitycache", false);
+      itsVisCacheLimit = size_t(parset.getUint32("visibilitycache.maxmemory", 2048)) * 1048576;
+      if (itsUseVisCache && itsComms.isWorker()) {
+          if (itsVisCacheLimit > 0) {
+              ASKAPLOG_INFO_STR(logger, "Visibilities will be cached in memory between major cycles, up to "<<
+                                itsVisCacheLimit / 1048576<<" MB per rank");
+          } else {
+              ASKAPLOG_INFO_STR(logger, "Visibilities will be cached in memory between major cycles, no memory limit");
+          }
+      }
+      itsPreAverage = parset.getBool("preaverage", false);
+      if (itsPreAverage) {
+          // calibration is applied on top of the iterator, i.e. after the averaging which mixes
+          // visibilities with different gains (e.g. time-dependent or per channel)
+          ASKAPCHECK(!parset.getBool("calibrate", false) && !parset.isDefined("gainsfile"),
+                     "Pre-averaging of visibilities is not supported together with calibration, set preaverage = false");
+          itsPreAverageTime = parset.getDouble("preaverage.time", -1.);
+          itsPreAverageNChan = parset.getUint32("preaverage.nchan", 1);
+          ASKAPCHECK(itsPreAverageNChan > 0, "preaverage.nchan is supposed to be positive");
+          itsPreAverageTolerance = parset.getDouble("preaverage.tolerance", 0.01);
+          ASKAPCHECK((itsPreAverageTolerance >= 0.) && (itsPreAverageTolerance < 1.),
+                     "preaverage.tolerance is supposed to be between 0 and 1, you have "<<itsPreAverageTolerance);
+          ASKAPCHECK((itsPreAverageTime >= 0.) || (itsPreAverageTolerance > 0.),
+                     "preaverage.time should be given if the smearing limit is switched off (preaverage.tolerance = 0)");
+          itsPreAveragePointingTolerance = parset.getDouble("preaverage.pointingtol", 1e-6);
+          ASKAPCHECK(itsPreAveragePointingTolerance >= 0.,
+                     "preaverage.pointingtol should not be negative, you have "<<itsPreAveragePointingTolerance);
+      }
+      // patches of the Hogbom CLEAN can be shared between all ranks, the decision is taken
+      // on the basis of the parset only, so all ranks agree on it
+      if (itsComms.isParallel() && (parset.getString("solver", "") == "Clean") &&
+          (parset.getString("solver.Clean.algorithm", "MultiScale") == "Hogbom") &&
+          parset.isDefined("solver.Clean.patches")) {
+          const std::vector<int> patches = parset.getInt32Vector("solver.Clean.patches");
+          if ((patches.size() == 2) && (patches[0] * patches[1] > 1)) {
+              itsPatchComms.reset(new MPIPatchComms(itsComms));
+              if (itsComms.isMaster()) {
+                  ASKAPLOG_INFO_STR(logger, "Minor cycle patches will be shared between "<<itsComms.nProcs()<<" ranks");
+              }
+          }
+      }
+
       if (itsComms.isMaster())
       {      
         itsRestore=parset.getBool("restore", false);
@@ -128,6 +209,11 @@ namespace askap
         /// Create the solver from the parameterset definition
         itsSolver = ImageSolverFactory::make(parset);
         ASKAPCHECK(itsSolver, "Solver not defined correctly");
+        if (itsPatchComms) {
+            boost::shared_ptr<ImageHogbomSolver> hogbomSolver = boost::dynamic_pointer_cast<ImageHogbomSolver>(itsSolver);
+            ASKAPCHECK(hogbomSolver, "Sharing of the minor cycle patches requires the Hogbom solver");
+            hogbomSolver->setPatchComms(itsPatchComms);
+        }
       }
       if (itsComms.isWorker())
       {
@@ -135,6 +221,7 @@ namespace askap
         if (doCalib) {
             ASKAPCHECK(!parset.isDefined("gainsfile"), "Deprecated 'gainsfile' keyword is found together with calibrate=true, please remove it");
             // setup solution source from the parset directly using the factory
+            itsSolutionSourceParset = parset;
             itsSolutionSource = CalibAccessFactory::roCalSolutionSource(parset);            
             ASKAPASSERT(itsSolutionSource);
         } else if (parset.isDefined("gainsfile")) {
@@ -148,6 +235,7 @@ namespace askap
             tmpParset.add("calibaccess.parset", gainsFile);
             tmpParset.add("calibaccess", "parset");
             // setup solution source from the temporary parset
+            itsSolutionSourceParset = tmpParset;
             itsSolutionSource = CalibAccessFactory::roCalSolutionSource(tmpParset);
             ASKAPASSERT(itsSolutionSource);            
         }
@@ -446,81 +534,382 @@ namespace askap
 
     }
 
+    /// @brief obtain the cache of PSF and weights for the given dataset
+    /// @details The cache is created on the first call for the given dataset
+    /// @param[in] ms name of the dataset
+    /// @return shared pointer to the cache
+    PSFWeightsCache::ShPtr ImagerParallel::psfCache(const std::string &ms)
+    {
+      PSFWeightsCache::ShPtr &cache = itsPSFCaches[ms];
+      if (!cache) {
+          ASKAPLOG_INFO_STR(logger, "PSF and weights for "<<ms<<
+                 " will be calculated in the first major cycle and reused afterwards");
+          cache.reset(new PSFWeightsCache);
+      }
+      return cache;
+    }
+
+    /// @brief obtain the visibility cache for the given work unit
+    /// @details The cache is created on the first call for the given unit. The memory
+    /// limit of a cache which has not been filled yet is set to the part of the total
+    /// limit not used by other caches.
+    /// @param[in] name name of the work unit
+    /// @return shared pointer to the cache
+    VisChunkCache::ShPtr ImagerParallel::visCache(const std::string &name)
+    {
+      VisChunkCache::ShPtr &cache = itsVisCaches[name];
+      if (!cache) {
+          cache.reset(new VisChunkCache(name));
+      }
+      if (!cache->isFilled() && (itsVisCacheLimit > 0)) {
+          size_t used = 0;
+          for (std::map<std::string, VisChunkCache::ShPtr>::const_iterator ci = itsVisCaches.begin();
+               ci != itsVisCaches.end(); ++ci) {
+               if (ci->second != cache) {
+                   used += ci->second->memoryUsed();
+               }
+          }
+          // zero would mean no limit, use one byte to cache nothing when the budget is exhausted
+          cache->setMemoryLimit(used < itsVisCacheLimit ? itsVisCacheLimit - used : 1);
+      }
+      return cache;
+    }
+
+    /// @brief largest angular distance from the tangent point covered by the model images
+    /// @details Used to derive the smearing limit for pre-averaging of visibilities. All image
+    /// parameters (including facets) are taken into account.
+    /// @return field radius in radians (zero if there are no images in the model)
+    double ImagerParallel::fieldRadius() const
+    {
+      ASKAPDEBUGASSERT(itsModel);
+      double radius = 0.;
+      const std::vector<std::string> names = itsModel->names();
+      for (std::vector<std::string>::const_iterator ci=names.begin(); ci!=names.end(); ++ci) {
+           if (ci->find("image") != 0) {
+               continue;
+           }
+           const scimath::Axes &axes = itsModel->axes(*ci);
+           if (!axes.hasDirection()) {
+               continue;
+           }
+           // the reference pixel is the tangent point, which may be offset from the
+           // image centre (e.g. for facets), so check all corners
+           const casa::Vector<casa::Double> refPix = axes.directionAxis().referencePixel();
+           const casa::Vector<casa::Double> increment = axes.directionAxis().increment();
+           const casa::IPosition shape = itsModel->value(*ci).shape();
+           ASKAPDEBUGASSERT((shape.nelements() >= 2) && (refPix.nelements() == 2) && (increment.nelements() == 2));
+           for (int corner = 0; corner < 4; ++corner) {
+                const double dx = ((corner % 2 == 0 ? 0. : double(shape[0])) - refPix[0]) * increment[0];
+                const double dy = ((corner / 2 == 0 ? 0. : double(shape[1])) - refPix[1]) * increment[1];
+                radius = std::max(radius, std::sqrt(dx * dx + dy * dy));
+           }
+      }
+      return radius;
+    }
+
     void ImagerParallel::calcOne(const string& ms, bool discard)
+    {
+      calcOne(ImagingWorkUnit(ms), discard);
+    }
+
+    /// @brief calculate normal equations for one work unit
+    /// @details This is the same as calcOne for a dataset, but the selection of the
+    /// work unit (beam, channels) is applied on top of the selection given in the parset
+    /// @param[in] unit work unit
+    /// @param[in] discard if true, the measurement equation is created from scratch
+    void ImagerParallel::calcOne(const ImagingWorkUnit &unit, bool discard)
     {
       ASKAPDEBUGTRACE("ImagerParallel::calcOne");
       casa::Timer timer;
       timer.mark();
-      ASKAPLOG_INFO_STR(logger, "Calculating normal equations for " << ms );
+      ASKAPLOG_INFO_STR(logger, "Calculating normal equations for " << unit.name() );
       // First time around we need to generate the equation 
       if ((!itsEquation)||discard)
       {
-        ASKAPLOG_INFO_STR(logger, "Creating measurement equation" );
-
-        // just to print the current mode to the log
-        if (itsUseMemoryBuffers) {
-            ASKAPLOG_INFO_STR(logger, "Scratch data will be held in memory" );
-        } else {
-            ASKAPLOG_INFO_STR(logger, "Scratch data will be written to the subtable of the original dataset" );
-        }
-        
-        TableDataSource ds(ms, (itsUseMemoryBuffers ? TableDataSource::MEMORY_BUFFERS : TableDataSource::DEFAULT), 
-                           dataColumn());
-        ds.configureUVWMachineCache(uvwMachineCacheSize(),uvwMachineCacheTolerance());                   
-        IDataSelectorPtr sel=ds.createSelector();
-        sel->chooseCrossCorrelations();
-        sel << parset();
-        IDataConverterPtr conv=ds.createConverter();
-        conv->setFrequencyFrame(getFreqRefFrame(), "Hz");
-        conv->setDirectionFrame(casa::MDirection::Ref(casa::MDirection::J2000));
-        // ensure that time is counted in seconds since 0 MJD
-        conv->setEpochFrame();
-        
-        IDataSharedIter it=ds.createIterator(sel, conv);
-        ASKAPCHECK(itsModel, "Model not defined");
-        ASKAPCHECK(gridder(), "Gridder not defined");
-        if (!itsSolutionSource) {
-            ASKAPLOG_INFO_STR(logger, "No calibration is applied" );
-            boost::shared_ptr<ImageFFTEquation> fftEquation(new ImageFFTEquation (*itsModel, it, gridder()));
-            ASKAPDEBUGASSERT(fftEquation);
-            fftEquation->useSphFuncForPSF(parset().getBool("sphfuncforpsf", false));
-            fftEquation->setVisUpdateObject(GroupVisAggregator::create(itsComms));
-            itsEquation = fftEquation;
-        } else {
-            ASKAPLOG_INFO_STR(logger, "Calibration will be performed using solution source");
-            boost::shared_ptr<ICalibrationApplicator> calME(new CalibrationApplicatorME(itsSolutionSource));
-            // fine tune parameters
-            ASKAPDEBUGASSERT(calME);
-            calME->scaleNoise(parset().getBool("calibrate.scalenoise",false));
-            calME->allowFlag(parset().getBool("calibrate.allowflag",false));
-            calME->beamIndependent(parset().getBool("calibrate.ignorebeam", false));
-            //
-            IDataSharedIter calIter(new CalibrationIterator(it,calME));
-            boost::shared_ptr<ImageFFTEquation> fftEquation(
-                          new ImageFFTEquation (*itsModel, calIter, gridder()));
-            ASKAPDEBUGASSERT(fftEquation);
-            fftEquation->useSphFuncForPSF(parset().getBool("sphfuncforpsf", false));
-            fftEquation->setVisUpdateObject(GroupVisAggregator::create(itsComms));
-            itsEquation = fftEquation;
-        }
+        itsEquation = createEquation(unit);
       }
       else {
         ASKAPLOG_INFO_STR(logger, "Reusing measurement equation and updating with latest model images" );
-        itsEquation->setParameters(*itsModel);
+        updateEquationModel(*itsEquation);
       }
       ASKAPCHECK(itsEquation, "Equation not defined");
       ASKAPCHECK(itsNe, "NormalEquations not defined");
+      // the equation may be reused from the previous major cycle when streaming wasn't possible
+      const boost::shared_ptr<ImageFFTEquation> fftEquation = boost::dynamic_pointer_cast<ImageFFTEquation>(itsEquation);
+      if (fftEquation) {
+          fftEquation->setNEUpdateObject(itsNEStreamer);
+      }
       itsEquation->calcEquations(*itsNe);
-      ASKAPLOG_INFO_STR(logger, "Calculated normal equations for "<< ms << " in "<< timer.real()
+      ASKAPLOG_INFO_STR(logger, "Calculated normal equations for "<< unit.name() << " in "<< timer.real()
                          << " seconds ");
     }
 
+    /// @brief create measurement equation for one work unit
+    /// @param[in] unit work unit
+    /// @param[in] ownSolutionSource if true, the equation gets its own calibration
+    /// solution source (used for equations processed concurrently)
+    /// @return shared pointer to the new equation
+    scimath::Equation::ShPtr ImagerParallel::createEquation(const ImagingWorkUnit &unit, const bool ownSolutionSource)
+    {
+      const std::string &ms = unit.itsDataset;
+      ASKAPLOG_INFO_STR(logger, "Creating measurement equation" );
+
+      // just to print the current mode to the log
+      if (itsUseMemoryBuffers) {
+          ASKAPLOG_INFO_STR(logger, "Scratch data will be held in memory" );
+      } else {
+          ASKAPLOG_INFO_STR(logger, "Scratch data will be written to the subtable of the original dataset" );
+      }
+      
+      TableDataSource ds(ms, (itsUseMemoryBuffers ? TableDataSource::MEMORY_BUFFERS : TableDataSource::DEFAULT), 
+                         dataColumn());
+      ds.configureUVWMachineCache(uvwMachineCacheSize(),uvwMachineCacheTolerance());                   
+      ds.configureReadAhead(readAheadChunks());
+      IDataSelectorPtr sel=ds.createSelector();
+      sel->chooseCrossCorrelations();
+      sel << parset();
+      unit.select(*sel);
+      IDataConverterPtr conv=ds.createConverter();
+      conv->setFrequencyFrame(getFreqRefFrame(), "Hz");
+      conv->setDirectionFrame(casa::MDirection::Ref(casa::MDirection::J2000));
+      // ensure that time is counted in seconds since 0 MJD
+      conv->setEpochFrame();
+      
+      IDataSharedIter it=ds.createIterator(sel, conv);
+      if (itsPreAverage) {
+          // averaging is done before caching, so the cache holds fewer visibilities
+          const boost::shared_ptr<IDataIterator> tableIt = it;
+          boost::shared_ptr<AveragingIteratorAdapter> avgIt(new AveragingIteratorAdapter(tableIt,
+                               itsPreAverageTime, itsPreAverageNChan));
+          avgIt->configureUVWMachineCache(uvwMachineCacheSize(), uvwMachineCacheTolerance());
+          avgIt->setPointingTolerance(itsPreAveragePointingTolerance);
+          if (itsPreAverageTolerance > 0.) {
+              ASKAPCHECK(itsModel, "Model not defined");
+              const double radius = fieldRadius();
+              ASKAPCHECK(radius > 0., "Unable to determine the field size for the smearing limit, set preaverage.tolerance = 0");
+              avgIt->setSmearingLimit(radius, itsPreAverageTolerance);
+          }
+          it = IDataSharedIter(boost::shared_ptr<IDataIterator>(avgIt));
+      }
+      if (itsUseVisCache) {
+          // the first pass fills the cache, the following major cycles are served from memory
+          const boost::shared_ptr<IDataIterator> tableIt = it;
+          it = IDataSharedIter(boost::shared_ptr<IDataIterator>(new CachingIteratorAdapter(tableIt,
+                               visCache(unit.name()))));
+      }
+      ASKAPCHECK(itsModel, "Model not defined");
+      ASKAPCHECK(gridder(), "Gridder not defined");
+      if (!itsSolutionSource) {
+          ASKAPLOG_INFO_STR(logger, "No calibration is applied" );
+          boost::shared_ptr<ImageFFTEquation> fftEquation(new ImageFFTEquation (it, gridder()));
+          ASKAPDEBUGASSERT(fftEquation);
+          updateEquationModel(*fftEquation);
+          fftEquation->useSphFuncForPSF(parset().getBool("sphfuncforpsf", false));
+          fftEquation->setVisUpdateObject(GroupVisAggregator::create(itsComms));
+          if (parset().getBool("cachepsf", false)) {
+              fftEquation->setPSFCache(psfCache(unit.name()));
+          }
+          return fftEquation;
+      } else {
+          ASKAPLOG_INFO_STR(logger, "Calibration will be performed using solution source");
+          // solution sources cache the current solution and are not safe to share between threads
+          const boost::shared_ptr<accessors::ICalSolutionConstSource> solutionSource = ownSolutionSource ?
+                      CalibAccessFactory::roCalSolutionSource(itsSolutionSourceParset) : itsSolutionSource;
+          ASKAPDEBUGASSERT(solutionSource);
+          boost::shared_ptr<ICalibrationApplicator> calME(new CalibrationApplicatorME(solutionSource));
+          // fine tune parameters
+          ASKAPDEBUGASSERT(calME);
+          calME->scaleNoise(parset().getBool("calibrate.scalenoise",false));
+          calME->allowFlag(parset().getBool("calibrate.allowflag",false));
+          calME->beamIndependent(parset().getBool("calibrate.ignorebeam", false));
+          //
+          IDataSharedIter calIter(new CalibrationIterator(it,calME));
+          boost::shared_ptr<ImageFFTEquation> fftEquation(
+                        new ImageFFTEquation (calIter, gridder()));
+          ASKAPDEBUGASSERT(fftEquation);
+          updateEquationModel(*fftEquation);
+          fftEquation->useSphFuncForPSF(parset().getBool("sphfuncforpsf", false));
+          fftEquation->setVisUpdateObject(GroupVisAggregator::create(itsComms));
+          if (parset().getBool("cachepsf", false)) {
+              fftEquation->setPSFCache(psfCache(unit.name()));
+          }
+          return fftEquation;
+      }
+    }
+
+    /// @brief pass the current model to the measurement equation
+    /// @details If the model has been received via node-local shared memory, the equation
+    /// references its arrays. Otherwise (or if the model has facets), the equation gets
+    /// a copy of the model.
+    /// @param[in] equation measurement equation to update
+    void ImagerParallel::updateEquationModel(scimath::Equation &equation) const
+    {
+      ASKAPCHECK(itsModel, "Model not defined");
+      if (!sharedModel() || !referenceModel(equation, *itsModel)) {
+          equation.setParameters(*itsModel);
+      }
+    }
+
+    /// @brief calculate normal equations for one work unit in a thread of the pool
+    /// @param[in] equation measurement equation of the unit
+    /// @param[in] ne normal equations to fill
+    static void calcUnit(const scimath::Equation::ShPtr &equation, const ImagingNormalEquations::ShPtr &ne)
+    {
+      ASKAPDEBUGASSERT(equation);
+      ASKAPDEBUGASSERT(ne);
+      equation->calcEquations(*ne);
+    }
+
+    /// @brief obtain the work units processed by this rank
+    /// @details Each dataset of this rank is split into a block of channels per thread,
+    /// unless the channel selection is given explicitly in the parset. Calibrated data are not
+    /// split either, because calibration solutions are looked up by the channel number within
+    /// the chunk, so the blocks other than the first would get wrong bandpass corrections. The number of
+    /// channels is found from the first chunk of data, so this method is only called once
+    /// and the result is kept for the following major cycles.
+    /// @return const reference to the vector with work units
+    const std::vector<ImagingWorkUnit>& ImagerParallel::localUnits()
+    {
+      if (itsLocalUnits.size() > 0) {
+          return itsLocalUnits;
+      }
+      ASKAPDEBUGASSERT(threadPool());
+      std::vector<std::string> datasets;
+      if (itsComms.isParallel()) {
+          datasets.push_back(measurementSets()[itsComms.rank() - 1]);
+      } else {
+          datasets = measurementSets();
+      }
+      const bool split = !parset().isDefined("Channels") && !itsSolutionSource;
+      if (parset().isDefined("Channels")) {
+          ASKAPLOG_WARN_STR(logger, "Channels are selected explicitly, datasets are not split between threads");
+      } else if (itsSolutionSource) {
+          ASKAPLOG_WARN_STR(logger, "Data are calibrated, datasets are not split between threads");
+      }
+      for (std::vector<std::string>::const_iterator ci = datasets.begin(); ci != datasets.end(); ++ci) {
+           casa::uInt nChan = 0;
+           if (split) {
+               TableDataSource ds(*ci, TableDataSource::MEMORY_BUFFERS, dataColumn());
+               IDataSelectorPtr sel = ds.createSelector();
+               sel->chooseCrossCorrelations();
+               sel << parset();
+               IDataConverterPtr conv = ds.createConverter();
+               conv->setFrequencyFrame(getFreqRefFrame(), "Hz");
+               IDataSharedIter it = ds.createIterator(sel, conv);
+               if (it.hasMore()) {
+                   nChan = it->nChannel();
+               }
+           }
+           const casa::uInt nBlocks = std::min(casa::uInt(threadPool()->nThreads()), nChan);
+           if (nBlocks < 2) {
+               itsLocalUnits.push_back(ImagingWorkUnit(*ci));
+               continue;
+           }
+           const casa::uInt chanPerBlock = (nChan + nBlocks - 1) / nBlocks;
+           for (casa::uInt start = 0; start < nChan; start += chanPerBlock) {
+                ImagingWorkUnit unit(*ci);
+                unit.itsStartChan = start;
+                unit.itsNChan = std::min(chanPerBlock, nChan - start);
+                itsLocalUnits.push_back(unit);
+           }
+      }
+      ASKAPLOG_INFO_STR(logger, "Data of this rank are split into "<<itsLocalUnits.size()<<
+                        " work unit(s) for "<<threadPool()->nThreads()<<" threads");
+      return itsLocalUnits;
+    }
+
+    /// @brief calculate normal equations for work units of this rank using the thread pool
+    /// @details Every unit has its own measurement equation and normal equations, which are
+    /// merged into itsNe at the end in the order of units, so the result doesn't depend on
+    /// the scheduling of threads. Casacore tables can't be read from several threads at once,
+    /// so units are only processed concurrently when all of them are served from the visibility
+    /// cache (i.e. from the second major cycle with visibilitycache=true). Otherwise, they are
+    /// processed one by one in the main thread. Each unit has its own calibration solution
+    /// source, the solution tables are read under the process-wide casacore lock.
+    /// @param[in] units work units to process
+    void ImagerParallel::calcUnitsInThreads(const std::vector<ImagingWorkUnit> &units)
+    {
+      ASKAPDEBUGTRACE("ImagerParallel::calcUnitsInThreads");
+      ASKAPDEBUGASSERT(threadPool());
+      ASKAPCHECK(itsNe, "NormalEquations not defined");
+      casa::Timer timer;
+      timer.mark();
+      bool concurrent = itsUseVisCache;
+      std::vector<scimath::Equation::ShPtr> equations(units.size());
+      std::vector<ImagingNormalEquations::ShPtr> nes(units.size());
+      for (size_t unit = 0; unit < units.size(); ++unit) {
+           scimath::Equation::ShPtr &equation = itsUnitEquations[units[unit].name()];
+           if (!equation) {
+               equation = createEquation(units[unit], true);
+               concurrent = false;
+           } else {
+               updateEquationModel(*equation);
+               if (concurrent) {
+                   const VisChunkCache::ShPtr cache = visCache(units[unit].name());
+                   concurrent = cache->isFilled() && !cache->isTruncated();
+               }
+           }
+           equations[unit] = equation;
+           nes[unit].reset(new ImagingNormalEquations(*itsModel));
+      }
+      for (size_t unit = 0; unit < units.size(); ++unit) {
+           const ThreadPool::Task task = boost::bind(&calcUnit, equations[unit], nes[unit]);
+           if (concurrent) {
+               threadPool()->submit(task);
+           } else {
+               task();
+           }
+      }
+      if (concurrent) {
+          threadPool()->wait();
+      }
+      for (size_t unit = 0; unit < units.size(); ++unit) {
+           itsNe->merge(*nes[unit]);
+      }
+      ASKAPLOG_INFO_STR(logger, "Calculated normal equations for "<<units.size()<<" work unit(s) "<<
+                        (concurrent ? "concurrently" : "one by one")<<" in "<<timer.real()<<" seconds");
+    }
+
+    /// @brief calculate normal equations for work units received from the master
+    /// @details Used in the dynamic scheduling mode. The worker keeps requesting units
+    /// until the master reports that there is no more work in this major cycle. All
+    /// units are accumulated into the same normal equations.
+    void ImagerParallel::calcScheduledUnits()
+    {
+      ASKAPDEBUGASSERT(itsScheduler);
+      casa::Timer timer;
+      timer.mark();
+      int nProcessed = 0;
+      for (int index = WorkUnitScheduler::requestUnit(itsComms); index >= 0;
+           index = WorkUnitScheduler::requestUnit(itsComms), ++nProcessed) {
+           const ImagingWorkUnit &unit = itsScheduler->unit(index);
+           // the equation can only be reused if it has been set up for the same unit
+           calcOne(unit, unit.name() != itsEquationUnit);
+           itsEquationUnit = unit.name();
+      }
+      ASKAPLOG_INFO_STR(logger, "Processed "<<nProcessed<<" work unit(s) in "<<timer.real()<<" seconds");
+    }
+
     /// Calculate the normal equations for a given measurement set
     void ImagerParallel::calcNE()
     {
       ASKAPTRACE("ImagerParallel::calcNE");
       /// Now we need to recreate the normal equations
-      itsNe=ImagingNormalEquations::ShPtr(new ImagingNormalEquations(*itsModel));
+      boost::shared_ptr<ImagingNormalEquations> ne(new ImagingNormalEquations(*itsModel));
+      ne->setSinglePrecisionTransport(itsSinglePrecisionNE);
+      itsNe = ne;
+
+      // the reduction can only be overlapped with the calculation if each worker
+      // gets its normal equations from a single call to calcOne
+      itsNEStreamer.reset();
+      if (!itsScheduler && !itsUseThreads) {
+          itsNEStreamer = startStreamedReduction();
+      }
+
+      if (itsScheduler && itsComms.isMaster()) {
+          // hand out work units until all workers are told that there is no more work
+          itsScheduler->serve(itsComms);
+      }
 
       if (itsComms.isWorker())
       {
@@ -532,17 +921,28 @@ namespace askap
 
         if (itsComms.isParallel())
         {
-          calcOne(measurementSets()[itsComms.rank()-1]);
+          if (itsScheduler) {
+              calcScheduledUnits();
+          } else if (itsUseThreads) {
+              calcUnitsInThreads(localUnits());
+          } else {
+              calcOne(measurementSets()[itsComms.rank()-1]);
+          }
           sendNE();
         }
         else
         {
           ASKAPCHECK(itsSolver, "Solver not defined correctly");
           itsSolver->init();
-          for (size_t iMs=0; iMs<measurementSets().size(); ++iMs)
-          {
-            calcOne(measurementSets()[iMs],true);
-            itsSolver->addNormalEquations(*itsNe);
+          if (itsUseThreads) {
+              calcUnitsInThreads(localUnits());
+              itsSolver->addNormalEquations(*itsNe);
+          } else {
+              for (size_t iMs=0; iMs<measurementSets().size(); ++iMs)
+              {
+                calcOne(measurementSets()[iMs],true);
+                itsSolver->addNormalEquations(*itsNe);
+              }
           }
         }
       }
@@ -588,6 +988,10 @@ namespace askap
         Quality q;
         ASKAPDEBUGASSERT(itsModel);
         itsSolver->solveNormalEquations(*itsModel,q);
+        if (itsPatchComms) {
+            // release the workers serving patches of the minor cycle
+            DeconvolverHogbom<float, casa::Complex>::stopPatchServers(*itsPatchComms);
+        }
         ASKAPLOG_INFO_STR(logger, "Solved normal equations in "<< timer.real() << " seconds "
                            );
         
@@ -611,6 +1015,13 @@ namespace askap
             itsModel->add("peak_residual",peak);
         }
         itsModel->fix("peak_residual");
+      } else if (itsPatchComms) {
+        // workers share the minor cycles of the master until all planes are done
+        ASKAPLOG_INFO_STR(logger, "Serving minor cycle patches for the master");
+        casa::Timer timer;
+        timer.mark();
+        while (DeconvolverHogbom<float, casa::Complex>::servePatches(*itsPatchComms)) {}
+        ASKAPLOG_INFO_STR(logger, "Served minor cycle patches in "<< timer.real() << " seconds");
       }
     }
     
@@ -35,11 +35,18 @@
 #include <fitting/Solver.h>
 #include <Common/ParameterSet.h>
 
+#include <map>
+#include <string>
+
 // Local package includes
 #include <parallel/AdviseParallel.h>
 #include <parallel/MEParallelApp.h>
 #include <measurementequation/IMeasurementEquation.h>
 #include <calibaccess/ICalSolutionConstSource.h>
+#include <measurementequation/PSFWeightsCache.h>
+#include <parallel/WorkUnitScheduler.h>
+#include <dataaccess/VisChunkCache.h>
+#include <deconvolution/IPatchComms.h>
 
 namespace askap
 {
@@ -124,6 +131,8 @@ namespace askap
       /// @brief Solve the normal equations (runs in the solver)
       /// @details Either a dirty image can be constructed or the 
       /// multiscale clean can be used, as specified in the parset file.
+      /// If the patches of the Hogbom CLEAN are shared between ranks, workers
+      /// serve them here until the master has solved the normal equations.
       virtual void solveNE();
 
       /// @brief Write the results (runs in the solver)
@@ -199,6 +208,66 @@ namespace askap
       /// @param discard Discard old equation?
       void calcOne(const string& dataset, bool discard=false);
 
+      /// @brief calculate normal equations for one work unit
+      /// @details This is the same as calcOne for a dataset, but the selection of the
+      /// work unit (beam, channels) is applied on top of the selection given in the parset
+      /// @param[in] unit work unit
+      /// @param[in] discard if true, the measurement equation is created from scratch
+      void calcOne(const ImagingWorkUnit &unit, bool discard);
+
+      /// @brief calculate normal equations for work units received from the master
+      /// @details Used in the dynamic scheduling mode. The worker keeps requesting units
+      /// until the master reports that there is no more work in this major cycle. All
+      /// units are accumulated into the same normal equations.
+      void calcScheduledUnits();
+
+      /// @brief create measurement equation for one work unit
+      /// @param[in] unit work unit
+      /// @param[in] ownSolutionSource if true, the equation gets its own calibration
+      /// solution source (used for equations processed concurrently)
+      /// @return shared pointer to the new equation
+      scimath::Equation::ShPtr createEquation(const ImagingWorkUnit &unit, const bool ownSolutionSource = false);
+
+      /// @brief pass the current model to the measurement equation
+      /// @details If the model has been received via node-local shared memory, the equation
+      /// references its arrays. Otherwise (or if the model has facets), the equation gets
+      /// a copy of the model.
+      /// @param[in] equation measurement equation to update
+      void updateEquationModel(scimath::Equation &equation) const;
+
+      /// @brief obtain the work units processed by this rank
+      /// @details Used with the thread pool. Each dataset of this rank is split into a block
+      /// of channels per thread, unless the channel selection is given explicitly in the parset
+      /// or the data are calibrated.
+      /// @return const reference to the vector with work units
+      const std::vector<ImagingWorkUnit>& localUnits();
+
+      /// @brief calculate normal equations for work units of this rank using the thread pool
+      /// @details Every unit has its own measurement equation and normal equations, which are
+      /// merged into itsNe at the end.
+      /// @param[in] units work units to process
+      void calcUnitsInThreads(const std::vector<ImagingWorkUnit> &units);
+
+      /// @brief obtain the cache of PSF and weights for the given dataset
+      /// @details The cache is created on the first call for the given dataset
+      /// @param[in] ms name of the dataset
+      /// @return shared pointer to the cache
+      PSFWeightsCache::ShPtr psfCache(const std::string &ms);
+
+      /// @brief obtain the visibility cache for the given work unit
+      /// @details The cache is created on the first call for the given unit. The memory
+      /// limit of a cache which has not been filled yet is set to the part of the total
+      /// limit not used by other caches.
+      /// @param[in] name name of the work unit
+      /// @return shared pointer to the cache
+      accessors::VisChunkCache::ShPtr visCache(const std::string &name);
+
+      /// @brief largest angular distance from the tangent point covered by the model images
+      /// @details Used to derive the smearing limit for pre-averaging of visibilities. All image
+      /// parameters (including facets) are taken into account.
+      /// @return field radius in radians (zero if there are no images in the model)
+      double fieldRadius() const;
+
       /// Do we want a restored image?
       bool itsRestore;
       
@@ -212,6 +281,11 @@ namespace askap
       /// Uninitialised shared pointer means that no calibration is done and the data are
       /// imaged as they are.
       boost::shared_ptr<accessors::ICalSolutionConstSource> itsSolutionSource;
+
+      /// @brief parset describing the calibration solution source
+      /// @details It is used to create a separate solution source for each equation
+      /// processed by the thread pool.
+      LOFAR::ParameterSet itsSolutionSourceParset;
             
       /// @brief void measurement equation
       /// @details Does nothing, just returns calls to predict and 
@@ -230,6 +304,73 @@ namespace askap
       /// sensitivity images. This field gives the fraction of the maximum weight
       /// below which the sensitivity image will be set to 0.
       double itsExpSensitivityCutoff;
+
+      /// @brief true if normal equations are sent to the master in single precision
+      /// @details Set by the normalequations.precision option
+      bool itsSinglePrecisionNE;
+
+      /// @brief caches of PSF and weights between major cycles per dataset
+      /// @details Used only if cachepsf option is true. The measurement equation may be
+      /// recreated for every major cycle (e.g. in the serial mode), so caches are kept here.
+      std::map<std::string, PSFWeightsCache::ShPtr> itsPSFCaches;
+
+      /// @brief true if visibilities are kept in memory between major cycles
+      /// @details Set by the visibilitycache option
+      bool itsUseVisCache;
+
+      /// @brief total memory limit for visibility caches of this rank in bytes
+      /// @details Zero means no limit
+      size_t itsVisCacheLimit;
+
+      /// @brief caches of visibilities between major cycles per work unit
+      /// @details Used only if visibilitycache option is true.
+      std::map<std::string, accessors::VisChunkCache::ShPtr> itsVisCaches;
+
+      /// @brief true if visibilities are averaged in time and frequency before gridding
+      /// @details Set by the preaverage option
+      bool itsPreAverage;
+
+      /// @brief maximum time span of the pre-averaging bin in seconds
+      /// @details Negative value means that the bin is limited by smearing only
+      double itsPreAverageTime;
+
+      /// @brief number of channels to average before gridding
+      casa::uInt itsPreAverageNChan;
+
+      /// @brief acceptable fractional amplitude loss due to pre-averaging
+      /// @details Zero means no smearing limit
+      double itsPreAverageTolerance;
+
+      /// @brief maximum change of the pointing direction within the pre-averaging bin (radians)
+      double itsPreAveragePointingTolerance;
+
+      /// @brief scheduler of work units
+      /// @details Only set up in the parallel mode if scheduling=dynamic, otherwise each
+      /// worker processes its own dataset
+      boost::shared_ptr<WorkUnitScheduler> itsScheduler;
+
+      /// @brief name of the work unit the current measurement equation has been created for
+      /// @details The equation is reused if the worker gets the same unit in the next major cycle
+      std::string itsEquationUnit;
+
+      /// @brief object function starting the reduction of normal equations for each image
+      /// @details Set up for the current major cycle if the normal equations can be reduced
+      /// while the remaining images are still being transformed (empty pointer otherwise)
+      boost::shared_ptr<INormalEquationsUpdate> itsNEStreamer;
+
+      /// @brief true if the work of this rank is shared between threads of the pool
+      bool itsUseThreads;
+
+      /// @brief work units of this rank (only used with the thread pool)
+      std::vector<ImagingWorkUnit> itsLocalUnits;
+
+      /// @brief measurement equations for work units of this rank (only used with the thread pool)
+      std::map<std::string, scimath::Equation::ShPtr> itsUnitEquations;
+
+      /// @brief communicator to share the patches of the Hogbom CLEAN between ranks
+      /// @details Set up on all ranks in the parallel mode if the Hogbom solver is used with
+      /// more than one patch (empty pointer otherwise). Workers serve patches in solveNE.
+      boost::shared_ptr<IPatchComms> itsPatchComms;
     };
 
   }
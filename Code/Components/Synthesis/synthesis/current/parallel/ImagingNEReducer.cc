@@ -0,0 +1,654 @@
+/// @file
+///
+/// @brief Collective reduction of imaging normal equations
+/// @details Imaging normal equations are essentially a set of flat buffers (data vector,
+/// diagonal and slice of the normal matrix) for each image parameter. If all ranks agree on
+/// the names and sizes of these buffers (the layout), the buffers can be summed directly
+/// with MPI_Reduce without serialising the whole object through blobs at every step of
+/// the reduction tree. This class agrees the layout between ranks and does the reduction.
+/// Once the layout is agreed, the reduction can also be streamed: the buffers of each
+/// parameter are reduced with non-blocking MPI as soon as they are complete, while the
+/// normal equations for other parameters are still being computed.
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author agent <agent@local>
+
+// Include package level header file
+#include <askap_synthesis.h>
+
+#include <parallel/ImagingNEReducer.h>
+
+// ASKAPsoft includes
+#include <askap/AskapError.h>
+#include <askap/AskapLogging.h>
+#include <profile/AskapProfiler.h>
+#include <casa/OS/Timer.h>
+#include <Blob/BlobArray.h>
+#include <Blob/BlobOStream.h>
+#include <Blob/BlobIStream.h>
+#include <Blob/BlobOBufVector.h>
+#include <Blob/BlobIBufVector.h>
+
+// std includes
+#include <vector>
+#include <set>
+#include <stdint.h>
+
+ASKAP_LOGGER(logger, ".parallel");
+
+namespace askap {
+
+namespace synthesis {
+
+/// @brief construct the reducer without the agreed layout
+ImagingNEReducer::ImagingNEReducer() : itsLayoutAgreed(false), itsStreaming(false), itsStreamFailed(false),
+          itsNBlocks(1), itsBlocksDone(0), itsBlockData(false) {}
+
+/// @brief forget the agreed layout
+/// @details The layout will be agreed again during the next reduction
+void ImagingNEReducer::invalidate()
+{
+   ASKAPCHECK(!itsStreaming, "Unable to invalidate the layout while the streamed reduction is in progress");
+   itsLayout.clear();
+   itsLayoutAgreed = false;
+}
+
+/// @brief helper method to get the size of the buffer for the given parameter
+/// @param[in] buffers map with buffers for all parameters
+/// @param[in] name parameter name
+/// @return number of elements (zero if the parameter is not present)
+static casa::uInt bufferSize(const std::map<std::string, casa::Vector<double> > &buffers, const std::string &name)
+{
+   const std::map<std::string, casa::Vector<double> >::const_iterator ci = buffers.find(name);
+   return ci != buffers.end() ? ci->second.nelements() : 0;
+}
+
+/// @brief helper method to find the buffer for the given parameter
+/// @param[in] buffers map with buffers for all parameters
+/// @param[in] name parameter name
+/// @return pointer to the buffer (NULL if the parameter is not present)
+static const casa::Vector<double>* findBuffer(const std::map<std::string, casa::Vector<double> > &buffers,
+                                              const std::string &name)
+{
+   const std::map<std::string, casa::Vector<double> >::const_iterator ci = buffers.find(name);
+   return ci != buffers.end() ? &(ci->second) : NULL;
+}
+
+/// @brief obtain the layout entry for one parameter
+/// @param[in] ne normal equations
+/// @param[in] name parameter name
+/// @param[out] entry layout entry
+/// @return true, if the parameter has data in the given normal equations
+bool ImagingNEReducer::entryOf(const scimath::ImagingNormalEquations &ne, const std::string &name, LayoutEntry &entry)
+{
+   entry.itsDataSize = bufferSize(ne.dataVector(), name);
+   entry.itsDiagonalSize = bufferSize(ne.normalMatrixDiagonal(), name);
+   entry.itsSliceSize = bufferSize(ne.normalMatrixSlice(), name);
+   if ((entry.itsDataSize == 0) && (entry.itsDiagonalSize == 0) && (entry.itsSliceSize == 0)) {
+       return false;
+   }
+   const std::map<std::string, casa::IPosition>::const_iterator shapeIt = ne.shape().find(name);
+   const std::map<std::string, casa::IPosition>::const_iterator refIt = ne.reference().find(name);
+   ASKAPCHECK(shapeIt != ne.shape().end(), "Shape is missing for parameter "<<name);
+   entry.itsShape = shapeIt->second;
+   entry.itsReference = refIt != ne.reference().end() ? refIt->second : casa::IPosition();
+   return true;
+}
+
+/// @brief check that two layout entries describe the same geometry
+/// @param[in] entry1 first entry
+/// @param[in] entry2 second entry
+/// @return true, if the entries are the same
+bool ImagingNEReducer::sameEntry(const LayoutEntry &entry1, const LayoutEntry &entry2)
+{
+   return (entry1.itsDataSize == entry2.itsDataSize) && (entry1.itsDiagonalSize == entry2.itsDiagonalSize) &&
+          (entry1.itsSliceSize == entry2.itsSliceSize) && (entry1.itsShape == entry2.itsShape) &&
+          (entry1.itsReference == entry2.itsReference);
+}
+
+/// @brief obtain the layout of the given normal equations
+/// @details Parameters without data are not included.
+/// @param[in] ne normal equations
+/// @return layout
+ImagingNEReducer::Layout ImagingNEReducer::layoutOf(const scimath::ImagingNormalEquations &ne)
+{
+   Layout result;
+   const std::map<std::string, casa::Vector<double> > &dataVectors = ne.dataVector();
+   for (std::map<std::string, casa::Vector<double> >::const_iterator ci = dataVectors.begin();
+        ci != dataVectors.end(); ++ci) {
+        LayoutEntry entry;
+        if (entryOf(ne, ci->first, entry)) {
+            result[ci->first] = entry;
+        }
+   }
+   return result;
+}
+
+/// @brief check that normal equations conform to the layout
+/// @details Every parameter with data should be present in the layout with exactly the
+/// same geometry. Parameters of the layout which are missing in the normal equations
+/// are treated as zeros.
+/// @param[in] ne normal equations
+/// @param[in] layout layout to check against
+/// @return true, if the normal equations conform to the layout
+bool ImagingNEReducer::conforms(const scimath::ImagingNormalEquations &ne, const Layout &layout)
+{
+   const Layout thisLayout = layoutOf(ne);
+   for (Layout::const_iterator ci = thisLayout.begin(); ci != thisLayout.end(); ++ci) {
+        const Layout::const_iterator agreed = layout.find(ci->first);
+        if ((agreed == layout.end()) || !sameEntry(ci->second, agreed->second)) {
+            return false;
+        }
+   }
+   return true;
+}
+
+/// @brief broadcast layout of the normal equations from the given rank to all ranks
+/// @param[in] comms communication object
+/// @param[in] ne normal equations of this rank (can be NULL if the type doesn't match)
+/// @param[in] source rank describing the layout
+/// @return layout of the source rank (empty, if it can't take part in the collective reduction)
+ImagingNEReducer::Layout ImagingNEReducer::broadcastLayout(askapparallel::AskapParallel &comms,
+                                       const scimath::ImagingNormalEquations *ne, const int source)
+{
+   Layout layout;
+   std::vector<int8_t> buf;
+   if (comms.rank() == source) {
+       // empty layout means that the collective reduction can't be used
+       if (ne != NULL) {
+           layout = layoutOf(*ne);
+       }
+       LOFAR::BlobOBufVector<int8_t> bv(buf);
+       LOFAR::BlobOStream out(bv);
+       out.putStart("NELayout", 1);
+       out << static_cast<casa::uInt>(layout.size());
+       for (Layout::const_iterator ci = layout.begin(); ci != layout.end(); ++ci) {
+            out << ci->first << ci->second.itsShape << ci->second.itsReference << ci->second.itsDataSize <<
+                   ci->second.itsDiagonalSize << ci->second.itsSliceSize;
+       }
+       out.putEnd();
+   }
+   unsigned long size = buf.size();
+   comms.broadcast(&size, sizeof(size), source);
+   buf.resize(size);
+   ASKAPDEBUGASSERT(size > 0);
+   comms.broadcast(&buf[0], size * sizeof(int8_t), source);
+   if (comms.rank() != source) {
+       LOFAR::BlobIBufVector<int8_t> bv(buf);
+       LOFAR::BlobIStream in(bv);
+       const int version = in.getStart("NELayout");
+       ASKAPCHECK(version == 1, "Attempting to read normal equation layout of the wrong version: expect version 1, found version "<<version);
+       casa::uInt nEntries = 0;
+       in >> nEntries;
+       for (casa::uInt item = 0; item < nEntries; ++item) {
+            std::string name;
+            LayoutEntry entry;
+            in >> name >> entry.itsShape >> entry.itsReference >> entry.itsDataSize >>
+                  entry.itsDiagonalSize >> entry.itsSliceSize;
+            layout[name] = entry;
+       }
+       in.getEnd();
+   }
+   return layout;
+}
+
+/// @brief obtain normal equations which can be reduced collectively
+/// @details Only imaging normal equations can be reduced by this class. Normal equations
+/// with the single precision transport requested are left to the blob-based reduction.
+/// @param[in] ne normal equations
+/// @return pointer to the imaging normal equations or NULL, if this rank has to fall back
+/// to the blob-based reduction
+scimath::ImagingNormalEquations* ImagingNEReducer::reducible(const scimath::INormalEquations::ShPtr &ne)
+{
+   scimath::ImagingNormalEquations *ine = dynamic_cast<scimath::ImagingNormalEquations*>(ne.get());
+   // single precision transport has been explicitly requested for the blob-based reduction
+   if ((ine != NULL) && ine->singlePrecisionTransport()) {
+       return NULL;
+   }
+   return ine;
+}
+
+/// @brief check whether this rank can use the given layout
+/// @details An empty layout means that the first worker can't take part in the collective reduction.
+/// @param[in] ne normal equations of this rank (NULL if they can't be reduced collectively)
+/// @param[in] layout layout to check against
+/// @return true, if this rank can take part in the collective reduction with this layout
+bool ImagingNEReducer::canUseLayout(const scimath::ImagingNormalEquations *ne, const Layout &layout)
+{
+   return (ne != NULL) && !layout.empty() && conforms(*ne, layout);
+}
+
+/// @brief check whether the layout has to be agreed again
+/// @details This is the decision of this rank, the layout is agreed again if any rank
+/// returns true here.
+/// @param[in] ne normal equations of this rank (NULL if they can't be reduced collectively)
+/// @return true, if the current layout can't be used by this rank
+bool ImagingNEReducer::layoutChanged(const scimath::ImagingNormalEquations *ne) const
+{
+   return !itsLayoutAgreed || !canUseLayout(ne, itsLayout);
+}
+
+/// @brief set the layout agreed by all ranks
+/// @details This is the final step of the agreement done by reduce. The layout is only
+/// kept if all ranks can use it, otherwise it is cleared.
+/// @param[in] layout layout to set
+/// @param[in] agreed true, if all ranks can use this layout
+void ImagingNEReducer::setLayout(const Layout &layout, const bool agreed)
+{
+   ASKAPCHECK(!itsStreaming, "Unable to change the layout while the streamed reduction is in progress");
+   itsLayoutAgreed = agreed && !layout.empty();
+   if (itsLayoutAgreed) {
+       itsLayout = layout;
+   } else {
+       itsLayout.clear();
+   }
+}
+
+/// @brief sum one buffer across all ranks
+/// @param[in] comms communication object
+/// @param[in] buffers map with buffers of this rank for all parameters
+/// @param[in] name parameter name
+/// @param[in] size number of elements (as given by the layout)
+/// @param[in] root rank receiving the result
+/// @return the sum on the root rank, an empty vector on other ranks
+casa::Vector<double> ImagingNEReducer::reduceBuffer(askapparallel::AskapParallel &comms,
+               const std::map<std::string, casa::Vector<double> > &buffers, const std::string &name,
+               const casa::uInt size, const int root)
+{
+   if (size == 0) {
+       return casa::Vector<double>();
+   }
+   const std::map<std::string, casa::Vector<double> >::const_iterator ci = buffers.find(name);
+   const bool hasData = (ci != buffers.end()) && (ci->second.nelements() > 0);
+   ASKAPDEBUGASSERT(!hasData || (ci->second.nelements() == size));
+   if ((comms.rank() != root) && hasData && ci->second.contiguousStorage()) {
+       // the buffer is sent as is, MPI doesn't modify send buffers of non-root ranks
+       comms.sumToRoot(const_cast<double*>(ci->second.data()), size, root);
+       return casa::Vector<double>();
+   }
+   casa::Vector<double> result(size, 0.);
+   if (hasData) {
+       result = ci->second;
+   }
+   comms.sumToRoot(result.data(), size, root);
+   return comms.rank() == root ? result : casa::Vector<double>();
+}
+
+/// @brief reduce normal equations to the root rank
+/// @details This is a collective operation. On the root rank, the normal equations are
+/// replaced by the sum across all ranks. Normal equations on other ranks are not changed.
+/// @param[in] comms communication object
+/// @param[in] ne normal equations to reduce
+/// @param[in] root rank receiving the result
+/// @return true, if the reduction has been done, false if the collective reduction can't
+/// be used for these normal equations (nothing is changed in this case)
+bool ImagingNEReducer::reduce(askapparallel::AskapParallel &comms, const scimath::INormalEquations::ShPtr &ne,
+                              const int root)
+{
+   ASKAPTRACE("ImagingNEReducer::reduce");
+   scimath::ImagingNormalEquations *ine = reducible(ne);
+
+   if (itsStreaming) {
+       if (finishStream(comms, ine, root)) {
+           return true;
+       }
+       // the layout is agreed again below
+       ASKAPLOG_DEBUG_STR(logger, "Normal equations don't conform to the layout used for the streamed reduction, repeating the reduction");
+       itsLayoutAgreed = false;
+   }
+
+   // the layout is checked every time, but only agreed again if something has changed
+   bool disagree = layoutChanged(ine);
+   comms.aggregateFlag(disagree, 0);
+   if (disagree) {
+       const int source = comms.nProcs() > 1 ? 1 : 0;
+       const Layout layout = broadcastLayout(comms, ine, source);
+       disagree = !canUseLayout(ine, layout);
+       comms.aggregateFlag(disagree, 0);
+       setLayout(layout, !disagree);
+       if (disagree) {
+           ASKAPLOG_DEBUG_STR(logger, "Normal equations can't be reduced collectively");
+           return false;
+       }
+       ASKAPLOG_DEBUG_STR(logger, "Agreed layout of normal equations with "<<itsLayout.size()<<" parameter(s)");
+   }
+
+   casa::Timer timer;
+   timer.mark();
+   // buffers are reduced in the order of the layout, which is the same on all ranks
+   const bool isRoot = (comms.rank() == root);
+   std::map<std::string, casa::Vector<double> > dataVectors, diagonals, slices;
+   for (Layout::const_iterator ci = itsLayout.begin(); ci != itsLayout.end(); ++ci) {
+        dataVectors[ci->first] = reduceBuffer(comms, ine->dataVector(), ci->first, ci->second.itsDataSize, root);
+        diagonals[ci->first] = reduceBuffer(comms, ine->normalMatrixDiagonal(), ci->first,
+                                            ci->second.itsDiagonalSize, root);
+        slices[ci->first] = reduceBuffer(comms, ine->normalMatrixSlice(), ci->first, ci->second.itsSliceSize, root);
+   }
+   if (isRoot) {
+       // contribution of the root rank is already in the sum
+       ine->reset();
+       for (Layout::const_iterator ci = itsLayout.begin(); ci != itsLayout.end(); ++ci) {
+            if (ci->second.itsSliceSize > 0) {
+                ine->addSlice(ci->first, slices[ci->first], diagonals[ci->first], dataVectors[ci->first],
+                              ci->second.itsShape, ci->second.itsReference);
+            } else {
+                ine->addDiagonal(ci->first, diagonals[ci->first], dataVectors[ci->first], ci->second.itsShape);
+            }
+       }
+   }
+   ASKAPLOG_DEBUG_STR(logger, "Collective reduction of normal equations took "<<timer.real()<<" seconds");
+   return true;
+}
+
+/// @brief prepare for the streamed reduction of the next normal equations
+/// @details The streamed reduction is only possible if the layout has been agreed in one
+/// of the previous reductions. As this state is the same on all ranks, the decision doesn't
+/// need any communication. All ranks should call this method before they start computing
+/// the normal equations.
+/// @param[in] nBlocks number of blocks, should be the same on all ranks
+/// @return true, if the reduction will be streamed
+bool ImagingNEReducer::startStream(const casa::uInt nBlocks)
+{
+   ASKAPCHECK(!itsStreaming, "Streamed reduction of normal equations is already in progress");
+   ASKAPCHECK(nBlocks > 0, "Number of blocks is supposed to be positive");
+   ASKAPDEBUGASSERT(itsRequests.empty() && itsBlockRequests.empty());
+   itsStreamFailed = false;
+   itsZeroFilled.clear();
+   itsNBlocks = nBlocks;
+   itsBlocksDone = 0;
+   itsBlockData = false;
+   itsStreaming = itsLayoutAgreed && !itsLayout.empty();
+   itsNextEntry = itsLayout.begin();
+   return itsStreaming;
+}
+
+/// @brief start non-blocking reduction of one buffer
+/// @details The buffer of the normal equations is used directly on non-root ranks, if possible
+/// (a reference is kept in the given map, so it stays valid after the normal equations are gone).
+/// Otherwise, the buffer with this rank's contribution is created in the given map (and holds
+/// the sum on the root rank after the reduction is complete).
+/// @param[in] comms communication object
+/// @param[in] buffer buffer of the normal equations (NULL if there are no data on this rank)
+/// @param[in] name parameter name
+/// @param[in] size number of elements (as given by the layout)
+/// @param[in] root rank receiving the result
+/// @param[in] result map to store the buffer of this rank
+/// @param[in] requests vector to add the request of this reduction to
+void ImagingNEReducer::startBufferReduction(askapparallel::AskapParallel &comms, const casa::Vector<double> *buffer,
+               const std::string &name, const casa::uInt size, const int root,
+               std::map<std::string, casa::Vector<double> > &result, std::vector<size_t> &requests)
+{
+   if (size == 0) {
+       return;
+   }
+   const bool hasData = (buffer != NULL) && (buffer->nelements() > 0);
+   ASKAPDEBUGASSERT(!hasData || (buffer->nelements() == size));
+   if ((comms.rank() != root) && hasData && buffer->contiguousStorage()) {
+       // the buffer is not modified by the equation after the parameter is complete,
+       // copy constructor of casa arrays has reference semantics
+       const casa::Vector<double> sent(*buffer);
+       result[name].reference(sent);
+       requests.push_back(comms.startSumToRoot(const_cast<double*>(sent.data()), size, root));
+       return;
+   }
+   casa::Vector<double> contribution(size, 0.);
+   if (hasData) {
+       contribution = *buffer;
+   }
+   result[name].reference(contribution);
+   requests.push_back(comms.startSumToRoot(result[name].data(), size, root));
+}
+
+/// @brief wait for the given non-blocking requests
+/// @param[in] comms communication object
+/// @param[in] requests requests to wait for (cleared on exit)
+void ImagingNEReducer::waitRequests(askapparallel::AskapParallel &comms, std::vector<size_t> &requests)
+{
+   for (std::vector<size_t>::const_iterator ci = requests.begin(); ci != requests.end(); ++ci) {
+        comms.waitRequest(*ci);
+   }
+   requests.clear();
+}
+
+/// @brief reduce data vectors of the next block
+/// @details On the root rank the reduction is complete on exit and the result is added to
+/// the sum over blocks. On other ranks the reduction continues in the background.
+/// @param[in] comms communication object
+/// @param[in] dataVectors data vectors of this block (NULL to reduce zeros)
+/// @param[in] root rank receiving the result
+void ImagingNEReducer::reduceBlock(askapparallel::AskapParallel &comms,
+                 const std::map<std::string, casa::Vector<double> > *dataVectors, const int root)
+{
+   ASKAPDEBUGASSERT(itsBlocksDone + 1 < itsNBlocks);
+   // only one block is in flight, so it is normally complete by the time the next one is gridded
+   waitRequests(comms, itsBlockRequests);
+   itsBlockBuffers.clear();
+   for (Layout::const_iterator ci = itsLayout.begin(); ci != itsLayout.end(); ++ci) {
+        const casa::Vector<double> *buffer = dataVectors != NULL ? findBuffer(*dataVectors, ci->first) : NULL;
+        if ((buffer != NULL) && (buffer->nelements() != ci->second.itsDataSize)) {
+            // geometry has changed, the layout has to be agreed again
+            itsStreamFailed = true;
+            buffer = NULL;
+        }
+        startBufferReduction(comms, buffer, ci->first, ci->second.itsDataSize, root, itsBlockBuffers,
+                             itsBlockRequests);
+   }
+   ++itsBlocksDone;
+   if (comms.rank() == root) {
+       waitRequests(comms, itsBlockRequests);
+       for (std::map<std::string, casa::Vector<double> >::const_iterator ci = itsBlockBuffers.begin();
+            ci != itsBlockBuffers.end(); ++ci) {
+            casa::Vector<double> &sum = itsBlockSums[ci->first];
+            if (sum.nelements() == 0) {
+                sum.reference(ci->second);
+            } else {
+                sum += ci->second;
+            }
+       }
+       itsBlockBuffers.clear();
+   }
+}
+
+/// @brief reduce zeros for all blocks which haven't been reported
+/// @details This is done before the last block, so all ranks do the same number of block reductions.
+/// @param[in] comms communication object
+/// @param[in] root rank receiving the result
+void ImagingNEReducer::padBlocks(askapparallel::AskapParallel &comms, const int root)
+{
+   while (itsBlocksDone + 1 < itsNBlocks) {
+          reduceBlock(comms, NULL, root);
+   }
+}
+
+/// @brief start the reduction of data vectors of one block
+/// @details This method is called (on ranks other than the root) as soon as the data vectors
+/// for a block of data (except the last one) are complete. Parameters of the layout which
+/// are not present are reduced as zeros. The reduction of the previous block is waited for,
+/// so at most one block is in flight.
+/// @param[in] comms communication object
+/// @param[in] dataVectors data vectors of this block keyed by parameter name
+/// @param[in] root rank receiving the result
+void ImagingNEReducer::streamBlock(askapparallel::AskapParallel &comms,
+                 const std::map<std::string, casa::Vector<double> > &dataVectors, const int root)
+{
+   if (!itsStreaming) {
+       return;
+   }
+   ASKAPCHECK((itsBlocksDone + 1 < itsNBlocks) && (itsNextEntry == itsLayout.begin()),
+              "Only "<<itsNBlocks<<" block(s) are expected in the streamed reduction, the last one is reported with parameters");
+   reduceBlock(comms, &dataVectors, root);
+   itsBlockData = true;
+}
+
+/// @brief start the reduction of all layout entries up to the given one
+/// @details The data for each entry are taken from the normal equations, if conform,
+/// or zeros are used otherwise (the streamed reduction is then marked as failed
+/// if this rank has some data for this parameter).
+/// @param[in] comms communication object
+/// @param[in] ne normal equations (can be NULL)
+/// @param[in] end layout iterator to stop at (this entry is not processed)
+/// @param[in] root rank receiving the result
+void ImagingNEReducer::streamUpTo(askapparallel::AskapParallel &comms, const scimath::ImagingNormalEquations *ne,
+                                  const Layout::const_iterator &end, const int root)
+{
+   for (; itsNextEntry != end; ++itsNextEntry) {
+        const std::string &name = itsNextEntry->first;
+        const LayoutEntry &agreed = itsNextEntry->second;
+        LayoutEntry entry;
+        const bool hasData = (ne != NULL) && entryOf(*ne, name, entry);
+        const bool useData = hasData && sameEntry(entry, agreed);
+        if (!hasData) {
+            // data may still appear later, this is checked when the reduction is finished
+            itsZeroFilled.insert(name);
+        } else if (!useData) {
+            itsStreamFailed = true;
+        }
+        // buffers are reduced in the same order as in the ordinary collective reduction
+        startBufferReduction(comms, useData ? findBuffer(ne->dataVector(), name) : NULL, name,
+                             agreed.itsDataSize, root, itsStreamData, itsRequests);
+        startBufferReduction(comms, useData ? findBuffer(ne->normalMatrixDiagonal(), name) : NULL, name,
+                             agreed.itsDiagonalSize, root, itsStreamDiagonals, itsRequests);
+        startBufferReduction(comms, useData ? findBuffer(ne->normalMatrixSlice(), name) : NULL, name,
+                             agreed.itsSliceSize, root, itsStreamSlices, itsRequests);
+   }
+}
+
+/// @brief start the reduction of buffers of one parameter
+/// @details This method is called (on ranks other than the root) as soon as the normal
+/// equations for the given parameter are complete. The reduction of all preceding parameters
+/// of the layout, which haven't been reported, is started too.
+/// @param[in] comms communication object
+/// @param[in] ne normal equations
+/// @param[in] name name of the parameter
+/// @param[in] root rank receiving the result
+void ImagingNEReducer::streamParameter(askapparallel::AskapParallel &comms, const scimath::ImagingNormalEquations &ne,
+                                       const std::string &name, const int root)
+{
+   if (!itsStreaming) {
+       return;
+   }
+   Layout::const_iterator it = itsLayout.find(name);
+   if (it == itsLayout.end()) {
+       // new parameter, the layout has to be agreed again
+       itsStreamFailed = true;
+       return;
+   }
+   if ((itsNextEntry == itsLayout.end()) || (name < itsNextEntry->first)) {
+       // already started (zeros have been sent if the parameter came out of order)
+       return;
+   }
+   // this is the last block, the blocks this rank didn't have are reduced first
+   padBlocks(comms, root);
+   streamUpTo(comms, &ne, ++it, root);
+}
+
+/// @brief complete the streamed reduction
+/// @details All outstanding buffers are reduced and the normal equations are updated on the
+/// root rank, if all ranks conform to the layout.
+/// @param[in] comms communication object
+/// @param[in] ne normal equations (can be NULL if of an incompatible type)
+/// @param[in] root rank receiving the result
+/// @return true, if the reduction has been done, false if it has to be repeated without streaming
+bool ImagingNEReducer::finishStream(askapparallel::AskapParallel &comms, scimath::ImagingNormalEquations *ne,
+                                    const int root)
+{
+   ASKAPDEBUGASSERT(itsStreaming);
+   casa::Timer timer;
+   timer.mark();
+   padBlocks(comms, root);
+   // if earlier blocks have been reduced, ne includes their data and can't be used for the
+   // parameters which haven't been reported with the last block
+   streamUpTo(comms, itsBlockData ? NULL : ne, itsLayout.end(), root);
+   waitRequests(comms, itsBlockRequests);
+   waitRequests(comms, itsRequests);
+   itsStreaming = false;
+
+   bool failed = itsStreamFailed || (ne == NULL) || !conforms(*ne, itsLayout);
+   for (std::set<std::string>::const_iterator ci = itsZeroFilled.begin(); !failed && (ci != itsZeroFilled.end()); ++ci) {
+        LayoutEntry entry;
+        failed = entryOf(*ne, *ci, entry);
+   }
+   comms.aggregateFlag(failed, 0);
+   if (!failed && (comms.rank() == root)) {
+       // contribution of the root rank is already in the sum
+       ne->reset();
+       for (Layout::const_iterator ci = itsLayout.begin(); ci != itsLayout.end(); ++ci) {
+            const std::map<std::string, casa::Vector<double> >::const_iterator blockSum = itsBlockSums.find(ci->first);
+            if (blockSum != itsBlockSums.end()) {
+                // residuals of the blocks reduced before the last one
+                itsStreamData[ci->first] += blockSum->second;
+            }
+            if (ci->second.itsSliceSize > 0) {
+                ne->addSlice(ci->first, itsStreamSlices[ci->first], itsStreamDiagonals[ci->first],
+                             itsStreamData[ci->first], ci->second.itsShape, ci->second.itsReference);
+            } else {
+                ne->addDiagonal(ci->first, itsStreamDiagonals[ci->first], itsStreamData[ci->first], ci->second.itsShape);
+            }
+       }
+   }
+   itsStreamData.clear();
+   itsStreamDiagonals.clear();
+   itsStreamSlices.clear();
+   itsZeroFilled.clear();
+   itsBlockBuffers.clear();
+   itsBlockSums.clear();
+   if (!failed) {
+       ASKAPLOG_DEBUG_STR(logger, "Streamed reduction of normal equations completed "<<timer.real()<<
+                          " seconds after the last parameter");
+   }
+   return !failed;
+}
+
+/// @brief set up the adapter
+/// @param[in] comms communication object
+/// @param[in] reducer reducer doing the work (startStream should have been called)
+/// @param[in] root rank receiving the result
+ImagingNEStreamer::ImagingNEStreamer(askapparallel::AskapParallel &comms, ImagingNEReducer &reducer,
+                                     const int root) : itsComms(comms), itsReducer(reducer), itsRoot(root) {}
+
+/// @brief normal equations for the given parameter are complete
+/// @param[in] ne normal equations
+/// @param[in] name name of the parameter
+void ImagingNEStreamer::parameterComplete(const scimath::ImagingNormalEquations &ne, const std::string &name)
+{
+   itsReducer.streamParameter(itsComms, ne, name, itsRoot);
+}
+
+/// @brief number of blocks the data should be split into
+/// @return number of blocks of the streamed reduction
+casa::uInt ImagingNEStreamer::nBlocks() const
+{
+   return itsReducer.nBlocks();
+}
+
+/// @brief residual images for one block of data are complete
+/// @param[in] dataVectors residual images of this block only (data vectors keyed by parameter name)
+void ImagingNEStreamer::blockComplete(const std::map<std::string, casa::Vector<double> > &dataVectors)
+{
+   itsReducer.streamBlock(itsComms, dataVectors, itsRoot);
+}
+
+} // namespace synthesis
+
+} // namespace askap
@@ -0,0 +1,380 @@
+/// @file
+///
+/// @brief Collective reduction of imaging normal equations
+/// @details Imaging normal equations are essentially a set of flat buffers (data vector,
+/// diagonal and slice of the normal matrix) for each image parameter. If all ranks agree on
+/// the names and sizes of these buffers (the layout), the buffers can be summed directly
+/// with MPI_Reduce without serialising the whole object through blobs at every step of
+/// the reduction tree. This class agrees the layout between ranks and does the reduction.
+/// Once the layout is agreed, the reduction can also be streamed: the buffers of each
+/// parameter are reduced with non-blocking MPI as soon as they are complete, while the
+/// normal equations for other parameters are still being computed.
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author agent <agent@local>
+
+#ifndef ASKAP_SYNTHESIS_IMAGING_NE_REDUCER_H
+#define ASKAP_SYNTHESIS_IMAGING_NE_REDUCER_H
+
+// ASKAPsoft includes
+#include <askapparallel/AskapParallel.h>
+#include <fitting/INormalEquations.h>
+#include <fitting/ImagingNormalEquations.h>
+#include <measurementequation/INormalEquationsUpdate.h>
+
+// casa includes
+#include <casa/Arrays/IPosition.h>
+#include <casa/Arrays/Vector.h>
+
+// std includes
+#include <string>
+#include <map>
+#include <set>
+#include <vector>
+
+namespace askap {
+
+namespace synthesis {
+
+/// @brief Collective reduction of imaging normal equations
+/// @details The layout (names, shapes, references and sizes of all buffers) is described
+/// by the first worker (rank 1, or rank 0 in the serial case) and broadcast to all ranks once.
+/// In the subsequent reductions each rank only checks that its normal equations still
+/// conform to the agreed layout, and the layout is agreed again if any rank disagrees.
+/// Ranks which don't have any data for some parameter (e.g. the master) contribute zeros.
+/// If the normal equations are of a different type or their layout can't be agreed
+/// (e.g. workers image different parameters), the reduction is not done and the caller is
+/// expected to fall back to the blob-based reduction. The same happens if the single precision
+/// transport is requested for the normal equations on any rank. All ranks of the world communicator
+/// should call reduce at the same time, because the decision is taken collectively.
+/// Summation is always done in double precision.
+/// @ingroup parallel
+class ImagingNEReducer {
+public:
+   /// @brief construct the reducer without the agreed layout
+   ImagingNEReducer();
+
+   /// @brief reduce normal equations to the root rank
+   /// @details This is a collective operation. On the root rank, the normal equations are
+   /// replaced by the sum across all ranks. Normal equations on other ranks are not changed.
+   /// @param[in] comms communication object
+   /// @param[in] ne normal equations to reduce
+   /// @param[in] root rank receiving the result
+   /// @return true, if the reduction has been done, false if the collective reduction can't
+   /// be used for these normal equations (nothing is changed in this case)
+   bool reduce(askapparallel::AskapParallel &comms, const scimath::INormalEquations::ShPtr &ne,
+               const int root = 0);
+
+   /// @brief forget the agreed layout
+   /// @details The layout will be agreed again during the next reduction
+   void invalidate();
+
+   /// @brief prepare for the streamed reduction of the next normal equations
+   /// @details The streamed reduction is only possible if the layout has been agreed in one
+   /// of the previous reductions. As this state is the same on all ranks, the decision doesn't
+   /// need any communication. All ranks should call this method before they start computing
+   /// the normal equations. Buffers are then reduced in the order of the layout as parameters
+   /// are reported by streamParameter, the rest is done by the next call to reduce. If any rank
+   /// finds that its normal equations don't conform to the layout, the result of the streamed
+   /// reduction is discarded and reduce falls back to the ordinary collective reduction.
+   /// With more than one block, data vectors of all blocks but the last are reduced first,
+   /// one collective reduction per block and layout entry. The last block is reduced as above
+   /// together with the other buffers. Every rank does the same number of block reductions,
+   /// missing blocks (e.g. on the master) are reduced as zeros.
+   /// @param[in] nBlocks number of blocks, should be the same on all ranks
+   /// @return true, if the reduction will be streamed
+   bool startStream(const casa::uInt nBlocks = 1);
+
+   /// @return number of blocks of the current streamed reduction
+   inline casa::uInt nBlocks() const { return itsNBlocks; }
+
+   /// @brief start the reduction of data vectors of one block
+   /// @details This method is called (on ranks other than the root) as soon as the data vectors
+   /// for a block of data (except the last one) are complete. Parameters of the layout which
+   /// are not present are reduced as zeros. The buffers should not be modified until the reduction
+   /// is complete. The reduction of the previous block is waited for, so at most one block is
+   /// in flight. Reports beyond the requested number of blocks are not allowed.
+   /// @param[in] comms communication object
+   /// @param[in] dataVectors data vectors of this block keyed by parameter name
+   /// @param[in] root rank receiving the result
+   void streamBlock(askapparallel::AskapParallel &comms, const std::map<std::string, casa::Vector<double> > &dataVectors,
+                    const int root);
+
+   /// @brief start the reduction of buffers of one parameter
+   /// @details This method is called (on ranks other than the root) as soon as the normal
+   /// equations for the given parameter are complete. Parameters are expected to be reported
+   /// in the order of their names (which is the order of the layout). The reduction of all
+   /// preceding parameters of the layout, which haven't been reported, is started too with the
+   /// data which are available at this stage (zeros if the parameter is not present). The buffers
+   /// of the given parameter should not be modified until the reduction is complete.
+   /// @param[in] comms communication object
+   /// @param[in] ne normal equations
+   /// @param[in] name name of the parameter
+   /// @param[in] root rank receiving the result
+   void streamParameter(askapparallel::AskapParallel &comms, const scimath::ImagingNormalEquations &ne,
+                        const std::string &name, const int root);
+
+   /// @brief description of buffers for one parameter
+   struct LayoutEntry {
+      /// @brief shape of the parameter
+      casa::IPosition itsShape;
+      /// @brief reference point of the slice
+      casa::IPosition itsReference;
+      /// @brief number of elements in the data vector
+      casa::uInt itsDataSize;
+      /// @brief number of elements in the diagonal of the normal matrix
+      casa::uInt itsDiagonalSize;
+      /// @brief number of elements in the slice of the normal matrix
+      casa::uInt itsSliceSize;
+   };
+
+   /// @brief type of the layout (entries are sorted by parameter name)
+   typedef std::map<std::string, LayoutEntry> Layout;
+
+   /// @brief obtain the layout of the given normal equations
+   /// @details Parameters without data are not included.
+   /// @param[in] ne normal equations
+   /// @return layout
+   static Layout layoutOf(const scimath::ImagingNormalEquations &ne);
+
+   /// @brief check that normal equations conform to the layout
+   /// @details Every parameter with data should be present in the layout with exactly the
+   /// same geometry. Parameters of the layout which are missing in the normal equations
+   /// are treated as zeros.
+   /// @param[in] ne normal equations
+   /// @param[in] layout layout to check against
+   /// @return true, if the normal equations conform to the layout
+   static bool conforms(const scimath::ImagingNormalEquations &ne, const Layout &layout);
+
+   /// @brief obtain normal equations which can be reduced collectively
+   /// @details Only imaging normal equations can be reduced by this class. Normal equations
+   /// with the single precision transport requested are left to the blob-based reduction.
+   /// @param[in] ne normal equations
+   /// @return pointer to the imaging normal equations or NULL, if this rank has to fall back
+   /// to the blob-based reduction
+   static scimath::ImagingNormalEquations* reducible(const scimath::INormalEquations::ShPtr &ne);
+
+   /// @brief check whether this rank can use the given layout
+   /// @details An empty layout means that the first worker can't take part in the collective reduction.
+   /// @param[in] ne normal equations of this rank (NULL if they can't be reduced collectively)
+   /// @param[in] layout layout to check against
+   /// @return true, if this rank can take part in the collective reduction with this layout
+   static bool canUseLayout(const scimath::ImagingNormalEquations *ne, const Layout &layout);
+
+   /// @brief check whether the layout has to be agreed again
+   /// @details This is the decision of this rank, the layout is agreed again if any rank
+   /// returns true here.
+   /// @param[in] ne normal equations of this rank (NULL if they can't be reduced collectively)
+   /// @return true, if the current layout can't be used by this rank
+   bool layoutChanged(const scimath::ImagingNormalEquations *ne) const;
+
+   /// @brief set the layout agreed by all ranks
+   /// @details This is the final step of the agreement done by reduce. The layout is only
+   /// kept if all ranks can use it, otherwise it is cleared.
+   /// @param[in] layout layout to set
+   /// @param[in] agreed true, if all ranks can use this layout
+   void setLayout(const Layout &layout, const bool agreed);
+
+   /// @return true, if the layout has been agreed by all ranks
+   inline bool layoutAgreed() const { return itsLayoutAgreed; }
+
+private:
+   /// @brief obtain the layout entry for one parameter
+   /// @param[in] ne normal equations
+   /// @param[in] name parameter name
+   /// @param[out] entry layout entry
+   /// @return true, if the parameter has data in the given normal equations
+   static bool entryOf(const scimath::ImagingNormalEquations &ne, const std::string &name, LayoutEntry &entry);
+
+   /// @brief check that two layout entries describe the same geometry
+   /// @param[in] entry1 first entry
+   /// @param[in] entry2 second entry
+   /// @return true, if the entries are the same
+   static bool sameEntry(const LayoutEntry &entry1, const LayoutEntry &entry2);
+
+   /// @brief start non-blocking reduction of one buffer
+   /// @details The buffer of the normal equations is used directly on non-root ranks, if possible
+   /// (a reference is kept in the given map, so it stays valid after the normal equations are gone).
+   /// Otherwise, the buffer with this rank's contribution is created in the given map (and holds
+   /// the sum on the root rank after the reduction is complete).
+   /// @param[in] comms communication object
+   /// @param[in] buffer buffer of the normal equations (NULL if there are no data on this rank)
+   /// @param[in] name parameter name
+   /// @param[in] size number of elements (as given by the layout)
+   /// @param[in] root rank receiving the result
+   /// @param[in] result map to store the buffer of this rank
+   /// @param[in] requests vector to add the request of this reduction to
+   static void startBufferReduction(askapparallel::AskapParallel &comms, const casa::Vector<double> *buffer,
+               const std::string &name, const casa::uInt size, const int root,
+               std::map<std::string, casa::Vector<double> > &result, std::vector<size_t> &requests);
+
+   /// @brief wait for the given non-blocking requests
+   /// @param[in] comms communication object
+   /// @param[in] requests requests to wait for (cleared on exit)
+   static void waitRequests(askapparallel::AskapParallel &comms, std::vector<size_t> &requests);
+
+   /// @brief reduce data vectors of the next block
+   /// @details On the root rank the reduction is complete on exit and the result is added to
+   /// the sum over blocks. On other ranks the reduction continues in the background.
+   /// @param[in] comms communication object
+   /// @param[in] dataVectors data vectors of this block (NULL to reduce zeros)
+   /// @param[in] root rank receiving the result
+   void reduceBlock(askapparallel::AskapParallel &comms,
+                    const std::map<std::string, casa::Vector<double> > *dataVectors, const int root);
+
+   /// @brief reduce zeros for all blocks which haven't been reported
+   /// @details This is done before the last block, so all ranks do the same number of block reductions.
+   /// @param[in] comms communication object
+   /// @param[in] root rank receiving the result
+   void padBlocks(askapparallel::AskapParallel &comms, const int root);
+
+   /// @brief start the reduction of all layout entries up to the given one
+   /// @details The data for each entry are taken from the normal equations, if conform,
+   /// or zeros are used otherwise (the streamed reduction is then marked as failed
+   /// if this rank has some data for this parameter).
+   /// @param[in] comms communication object
+   /// @param[in] ne normal equations (can be NULL)
+   /// @param[in] end layout iterator to stop at (this entry is not processed)
+   /// @param[in] root rank receiving the result
+   void streamUpTo(askapparallel::AskapParallel &comms, const scimath::ImagingNormalEquations *ne,
+                   const Layout::const_iterator &end, const int root);
+
+   /// @brief complete the streamed reduction
+   /// @details All outstanding buffers are reduced and the normal equations are updated on the
+   /// root rank, if all ranks conform to the layout.
+   /// @param[in] comms communication object
+   /// @param[in] ne normal equations (can be NULL if of an incompatible type)
+   /// @param[in] root rank receiving the result
+   /// @return true, if the reduction has been done, false if it has to be repeated without streaming
+   bool finishStream(askapparallel::AskapParallel &comms, scimath::ImagingNormalEquations *ne, const int root);
+
+   /// @brief broadcast layout of the normal equations from the given rank to all ranks
+   /// @param[in] comms communication object
+   /// @param[in] ne normal equations of this rank (can be NULL if the type doesn't match)
+   /// @param[in] source rank describing the layout
+   /// @return layout of the source rank (empty, if it can't take part in the collective reduction)
+   static Layout broadcastLayout(askapparallel::AskapParallel &comms, const scimath::ImagingNormalEquations *ne,
+                                 const int source);
+
+   /// @brief sum one buffer across all ranks
+   /// @param[in] comms communication object
+   /// @param[in] buffers map with buffers of this rank for all parameters
+   /// @param[in] name parameter name
+   /// @param[in] size number of elements (as given by the layout)
+   /// @param[in] root rank receiving the result
+   /// @return the sum on the root rank, an empty vector on other ranks
+   static casa::Vector<double> reduceBuffer(askapparallel::AskapParallel &comms,
+               const std::map<std::string, casa::Vector<double> > &buffers, const std::string &name,
+               const casa::uInt size, const int root);
+
+   /// @brief agreed layout
+   Layout itsLayout;
+
+   /// @brief true if the layout has been agreed by all ranks
+   bool itsLayoutAgreed;
+
+   /// @brief true if the streamed reduction is in progress
+   bool itsStreaming;
+
+   /// @brief true if this rank has found that the normal equations don't conform to the layout
+   /// during the streamed reduction
+   bool itsStreamFailed;
+
+   /// @brief next layout entry to be reduced in the streamed mode
+   Layout::const_iterator itsNextEntry;
+
+   /// @brief outstanding non-blocking requests of the last block
+   std::vector<size_t> itsRequests;
+
+   /// @brief buffers owned by the streamed reduction (data vectors, diagonals and slices)
+   /// @details On the root rank these buffers hold the result of the reduction
+   std::map<std::string, casa::Vector<double> > itsStreamData, itsStreamDiagonals, itsStreamSlices;
+
+   /// @brief parameters of the layout reduced with zeros because this rank had no data at that stage
+   /// @details If data appear later (i.e. parameters came out of order), the streamed reduction fails
+   std::set<std::string> itsZeroFilled;
+
+   /// @brief number of blocks of the current streamed reduction
+   casa::uInt itsNBlocks;
+
+   /// @brief number of blocks reduced before the last one
+   casa::uInt itsBlocksDone;
+
+   /// @brief true if this rank has reported data for some block before the last one
+   /// @details The normal equations given to reduce then include these data, so they can't
+   /// be used for the parameters not reported with the last block
+   bool itsBlockData;
+
+   /// @brief outstanding non-blocking requests of the previous block
+   std::vector<size_t> itsBlockRequests;
+
+   /// @brief data vectors of the previous block (kept until its reduction is complete)
+   std::map<std::string, casa::Vector<double> > itsBlockBuffers;
+
+   /// @brief data vectors summed over blocks before the last one (only on the root rank)
+   std::map<std::string, casa::Vector<double> > itsBlockSums;
+};
+
+/// @brief Adapter passing the complete normal equations of each image to the reducer
+/// @details An instance of this class is given to the imaging equation, so the streamed
+/// reduction is started for every image as soon as its normal equations are complete and,
+/// if more than one block is requested, for residual images of each block of data.
+/// @ingroup parallel
+class ImagingNEStreamer : public INormalEquationsUpdate {
+public:
+   /// @brief set up the adapter
+   /// @param[in] comms communication object
+   /// @param[in] reducer reducer doing the work (startStream should have been called)
+   /// @param[in] root rank receiving the result
+   ImagingNEStreamer(askapparallel::AskapParallel &comms, ImagingNEReducer &reducer, const int root = 0);
+
+   /// @brief normal equations for the given parameter are complete
+   /// @param[in] ne normal equations
+   /// @param[in] name name of the parameter
+   virtual void parameterComplete(const scimath::ImagingNormalEquations &ne, const std::string &name);
+
+   /// @brief number of blocks the data should be split into
+   /// @return number of blocks of the streamed reduction
+   virtual casa::uInt nBlocks() const;
+
+   /// @brief residual images for one block of data are complete
+   /// @param[in] dataVectors residual images of this block only (data vectors keyed by parameter name)
+   virtual void blockComplete(const std::map<std::string, casa::Vector<double> > &dataVectors);
+
+private:
+   /// @brief communication object
+   askapparallel::AskapParallel &itsComms;
+
+   /// @brief reducer doing the work
+   ImagingNEReducer &itsReducer;
+
+   /// @brief rank receiving the result
+   int itsRoot;
+};
+
+} // namespace synthesis
+
+} // namespace askap
+
+#endif // #ifndef ASKAP_SYNTHESIS_IMAGING_NE_REDUCER_H
@@ -54,6 +54,7 @@
 #include <fitting/INormalEquations.h>
 #include <fitting/ImagingNormalEquations.h>
 #include <fitting/GenericNormalEquations.h>
+#include <fitting/ISegmentedSerializable.h>
 #include <profile/AskapProfiler.h>
 #include <casa/OS/Timer.h>
 
@@ -67,10 +68,16 @@ namespace askap {
 namespace synthesis {
 
 MEParallel::MEParallel(askap::askapparallel::AskapParallel& comms, const LOFAR::ParameterSet& parset) :
-        SynParallel(comms, parset)
+        SynParallel(comms, parset), itsCollectiveNEReduction(true), itsNEBlocks(1)
 {
     itsSolver = Solver::ShPtr(new Solver);
     itsNe = ImagingNormalEquations::ShPtr(new ImagingNormalEquations(*itsModel));
+    const std::string reduction = parset.getString("normalequations.reduction", "collective");
+    ASKAPCHECK((reduction == "collective") || (reduction == "tree"),
+               "normalequations.reduction is supposed to be either collective or tree, you have "<<reduction);
+    itsCollectiveNEReduction = (reduction == "collective");
+    itsNEBlocks = parset.getUint32("normalequations.blocks", 1);
+    ASKAPCHECK(itsNEBlocks > 0, "normalequations.blocks is supposed to be positive, you have "<<itsNEBlocks);
 }
 
 MEParallel::~MEParallel()
@@ -115,6 +122,22 @@ void MEParallel::receiveNE()
     }
 }
 
+// Prepare the streamed reduction of the normal equations for this major cycle
+boost::shared_ptr<INormalEquationsUpdate> MEParallel::startStreamedReduction()
+{
+    boost::shared_ptr<INormalEquationsUpdate> result;
+    const boost::shared_ptr<ImagingNormalEquations> ine = boost::dynamic_pointer_cast<ImagingNormalEquations>(itsNe);
+    // the decision has to be the same on all ranks, it only depends on the parset and
+    // the state of the reducer after the previous reduction
+    if (itsComms.isParallel() && itsCollectiveNEReduction && ine && !ine->singlePrecisionTransport() &&
+        itsNEReducer.startStream(itsNEBlocks)) {
+        ASKAPLOG_DEBUG_STR(logger, "Normal equations will be reduced while they are being calculated, residuals in "<<
+                           itsNEBlocks<<" block(s)");
+        result.reset(new ImagingNEStreamer(itsComms, itsNEReducer, 0));
+    }
+    return result;
+}
+
 /*
  * This method performs a graph reduction (using a binary tree topology)
  * from all processes to rank zero. The sequence of workers is mapped to
@@ -141,6 +164,12 @@ void MEParallel::receiveNE()
  */ 
 void MEParallel::reduceNE(askap::scimath::INormalEquations::ShPtr ne)
 {
+    // imaging normal equations with the same layout on all ranks are just
+    // summed buffer by buffer, the tree below is the fall back for everything else
+    if (itsCollectiveNEReduction && itsNEReducer.reduce(itsComms, ne, 0)) {
+        return;
+    }
+
     // Number of processes in the reduction
     const int nProcs = itsComms.nProcs();
 
@@ -201,12 +230,23 @@ void MEParallel::sendNormalEquations(const askap::scimath::INormalEquations::ShP
     timer.mark();
     ASKAPLOG_DEBUG_STR(logger, "Sending normal equations to rank " << dest);
 
+    // large buffers of the normal equations supporting this are sent directly
+    // from their storage after the blob stream
+    const ISegmentedSerializable* segmentedNE = dynamic_cast<const ISegmentedSerializable*>(ne.get());
+    askapparallel::AskapParallel::MemorySegments segments;
+
     BlobOBufMW bobmw(itsComms, dest);
     LOFAR::BlobOStream out(bobmw);
-    out.putStart("ne", 1);
-    out << itsComms.rank() << *ne;
+    out.putStart("ne", 2);
+    out << itsComms.rank() << (segmentedNE != 0);
+    if (segmentedNE != 0) {
+        segmentedNE->writeToBlob(out, segments);
+    } else {
+        out << *ne;
+    }
     out.putEnd();
     bobmw.flush();
+    itsComms.sendSegments(segments, dest);
     ASKAPLOG_DEBUG_STR(logger, "Sent normal equations to rank " << dest << " in "
             << timer.real() << " seconds ");
 }
@@ -239,10 +279,20 @@ askap::scimath::INormalEquations::ShPtr MEParallel::receiveNormalEquations(int s
     BlobIBufMW bibmw(itsComms, source);
     LOFAR::BlobIStream in(bibmw);
     const int version = in.getStart("ne");
-    ASKAPASSERT(version == 1);
+    ASKAPASSERT(version == 2);
     int rank;
-    in >> rank >> *ne;
+    bool segmented = false;
+    in >> rank >> segmented;
+    askapparallel::AskapParallel::MemorySegments segments;
+    if (segmented) {
+        ISegmentedSerializable* segmentedNE = dynamic_cast<ISegmentedSerializable*>(ne.get());
+        ASKAPCHECK(segmentedNE != 0, "Received normal equations in the segmented form, but the local type doesn't support it");
+        segmentedNE->readFromBlob(in, segments);
+    } else {
+        in >> *ne;
+    }
     in.getEnd();
+    itsComms.receiveSegments(segments, source);
     ASKAPCHECK(rank == source, "Received normal equations are from an unexpected source");
     ASKAPLOG_DEBUG_STR(logger, "Received normal equations from rank " << source
             << " after " << timer.real() << " seconds");
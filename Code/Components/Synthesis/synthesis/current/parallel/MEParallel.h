@@ -41,6 +41,7 @@
 
 // Loacl package includes
 #include <parallel/SynParallel.h>
+#include <parallel/ImagingNEReducer.h>
 
 namespace askap
 {
@@ -114,9 +115,23 @@ namespace askap
 
                 /// @brief Perform a reduction for normal equations from all
                 /// workers to the master.
+                /// @details Imaging normal equations are summed with MPI collectives
+                /// if all ranks agree on their layout (unless normalequations.reduction
+                /// is set to tree), otherwise the blob-based binary tree is used.
                 void reduceNE(askap::scimath::INormalEquations::ShPtr ne);
 
 			protected:
+
+                /// @brief prepare the streamed reduction of the normal equations
+                /// @details If the collective reduction is used and the layout of the normal equations
+                /// has been agreed in the previous major cycle, the buffers of each image can be reduced
+                /// in the background as soon as they are complete. With normalequations.blocks > 1,
+                /// residual images are also reduced block by block while later blocks of data are
+                /// being gridded. This method should be called by all ranks before the normal equations
+                /// are calculated (and reduced with reduceNE).
+                /// @return object function to be given to the imaging equation or an empty shared
+                /// pointer if the reduction can't be streamed
+                boost::shared_ptr<INormalEquationsUpdate> startStreamedReduction();
 		
                 // Point-to-point send normal equations
                 // @param[in] ne    pointer to normal equations to send
@@ -137,6 +152,16 @@ namespace askap
 				
 				/// Holder for the equation
 				askap::scimath::Equation::ShPtr itsEquation;
+
+			private:
+				/// @brief true if the collective reduction of normal equations is allowed
+				bool itsCollectiveNEReduction;
+
+				/// @brief helper doing the collective reduction (caches the agreed layout)
+				ImagingNEReducer itsNEReducer;
+
+				/// @brief number of blocks the residuals are reduced in when the reduction is streamed
+				casa::uInt itsNEBlocks;
 		};
 
 	}
@@ -42,6 +42,23 @@ ASKAP_LOGGER(logger, ".parallel");
 #include <measurementequation/SynthesisParamsHelper.h>
 #include <gridding/VisGridderFactory.h>
 #include <gridding/TableVisGridder.h>
+#include <fft/FFTWrapper.h>
+#include <Blob/BlobOBufString.h>
+#include <Blob/BlobIBufString.h>
+#include <Blob/BlobOStream.h>
+#include <Blob/BlobIStream.h>
+
+// boost includes
+#include <boost/bind.hpp>
+
+// std includes
+#include <cstdio>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
+#include <fcntl.h>
 
 
 using namespace askap;
@@ -51,9 +68,13 @@ using namespace askap::synthesis;
 /// @details sets communication object and parameter set
 /// @param[in] comms communication object
 /// @param[in] parset parameter set
-MEParallelApp::MEParallelApp(askap::askapparallel::AskapParallel& comms, const LOFAR::ParameterSet& parset) : 
+/// @param[in] dynamicScheduling true if the application hands out the datasets via
+/// WorkUnitScheduler when scheduling=dynamic is given in the parset
+MEParallelApp::MEParallelApp(askap::askapparallel::AskapParallel& comms, const LOFAR::ParameterSet& parset,
+                             const bool dynamicScheduling) : 
    MEParallel(comms,parset),   
-   itsUVWMachineCacheSize(1), itsUVWMachineCacheTolerance(1e-6)   
+   itsCheckpointInterval(1), itsCheckpointResume(false), itsCheckpointDerived(false),
+   itsUVWMachineCacheSize(1), itsUVWMachineCacheTolerance(1e-6), itsReadAheadChunks(0)
 {
    // set up image handler, needed for both master and worker
    SynthesisParamsHelper::setUpImageHandler(parset);
@@ -61,6 +82,38 @@ MEParallelApp::MEParallelApp(askap::askapparallel::AskapParallel& comms, const L
    // set up default reference frame
    SynthesisParamsHelper::setDefaultFreqFrame(getFreqRefFrame());
 
+   // configure FFTW plans shared by all FFTs in this process, needed for both master and worker
+   {
+       const int nThreads = parset.getInt32("fft.nthreads", 1);
+       const std::string planner = parset.getString("fft.planner", "estimate");
+       // all ranks import the wisdom, but only the first rank saves it at the end. Names expanded
+       // via %w are not unique (e.g. they repeat in every worker group), so ranks could
+       // otherwise overwrite each other's files
+       const std::string wisdomFile = substitute(parset.getString("fft.wisdom", ""));
+       const bool saveWisdom = (itsComms.rank() == 0);
+       ASKAPLOG_INFO_STR(logger, "FFTW will use "<<nThreads<<" thread(s) per transform, planner effort: "<<planner<<
+                         (wisdomFile != "" ? ", wisdom file: " + wisdomFile : std::string(", no wisdom")));
+       if (!scimath::configureFFT(nThreads, planner, wisdomFile, saveWisdom)) {
+           ASKAPLOG_WARN_STR(logger, "Unable to import FFTW wisdom from "<<wisdomFile<<
+                             ".single or .double, the wisdom will be accumulated from scratch");
+       }
+   }
+
+   // checkpoint/restart of the major cycle loop, the master writes the files, but
+   // all ranks need to know whether to expect the cycle to resume from
+   itsCheckpointName = parset.getString("checkpoint", "");
+   itsCheckpointInterval = parset.getInt32("checkpoint.interval", 1);
+   ASKAPCHECK(itsCheckpointInterval > 0, "checkpoint.interval is supposed to be positive, you have "<<
+              itsCheckpointInterval);
+   itsCheckpointResume = parset.getBool("checkpoint.resume", false);
+   itsCheckpointDerived = parset.getBool("checkpoint.derived", false);
+   ASKAPCHECK(!itsCheckpointResume || (itsCheckpointName != ""),
+              "checkpoint.resume requires the name of the checkpoint file to be given by the checkpoint parameter");
+   if (itsComms.isMaster() && (itsCheckpointName != "")) {
+       ASKAPLOG_INFO_STR(logger, "Model will be checkpointed into "<<itsCheckpointName<<" every "<<
+                         itsCheckpointInterval<<" major cycle(s)"<<(itsCheckpointDerived ? " including derived images" : ""));
+   }
+
    if (itsComms.isWorker()) {
        /// Get the list of measurement sets and the column to use.
        itsDataColName = parset.getString("datacolumn", "DATA");
@@ -68,8 +121,17 @@ MEParallelApp::MEParallelApp(askap::askapparallel::AskapParallel& comms, const L
         
        ASKAPCHECK(itsMs.size()>0, "Need dataset specification");
        const int nProcs = itsComms.nProcs();
+       // with dynamic scheduling datasets are split into work units and handed out by the master,
+       // only applications using WorkUnitScheduler can do it
+       const bool dynamicRequested = (parset.getString("scheduling", "static") == "dynamic");
+       if (dynamicRequested && !dynamicScheduling) {
+           ASKAPLOG_WARN_STR(logger, "scheduling=dynamic is not supported by this application, ignored");
+       }
+       const bool useScheduler = dynamicRequested && dynamicScheduling && itsComms.isParallel();
        
-       if (itsMs.size() == 1) {
+       if (useScheduler) {
+           ASKAPLOG_INFO_STR(logger, "Datasets will be distributed dynamically: "<<itsMs);
+       } else if (itsMs.size() == 1) {
            const string tmpl=itsMs[0];
            if (nProcs>2) {
                itsMs.resize(nProcs-1);
@@ -83,7 +145,7 @@ MEParallelApp::MEParallelApp(askap::askapparallel::AskapParallel& comms, const L
        } else {
           ASKAPLOG_INFO_STR(logger, "Skip measurment set substitution, names are given explicitly: "<<itsMs);
        }
-       if (nProcs>1) {
+       if ((nProcs>1) && !useScheduler) {
            ASKAPCHECK(int(itsMs.size()) == (nProcs-1),
               "When running in parallel, need one data set per node");
        } 
@@ -98,10 +160,220 @@ MEParallelApp::MEParallelApp(askap::askapparallel::AskapParallel& comms, const L
          
        ASKAPLOG_DEBUG_STR(logger, "UVWMachine cache will store "<<itsUVWMachineCacheSize<<" machines");
        ASKAPLOG_DEBUG_STR(logger, "Tolerance on the directions is "<<itsUVWMachineCacheTolerance/casa::C::pi*180.*3600.<<" arcsec");
+
+       // optional read ahead of the data in a background thread (to be set up via Data Source)
+       const int readAhead = parset.getInt32("readahead", 0);
+       ASKAPCHECK(readAhead >= 0, "readahead is supposed to be a non-negative number, you have "<<readAhead);
+       itsReadAheadChunks = casa::uInt(readAhead);
+       if (itsReadAheadChunks > 0) {
+           ASKAPLOG_INFO_STR(logger, "Up to "<<itsReadAheadChunks<<" chunks of data will be read ahead in a background thread");
+       }
         
        // Create the gridder using a factory acting on a parameterset
        itsGridder = createGridder(comms, parset);
        ASKAPCHECK(itsGridder, "Gridder is not defined correctly");              
+
+       // optional pool of threads sharing the work of this rank
+       itsThreadPool = ThreadPool::create(parset, itsComms.rank());
    }
 }
 
+
+/// @brief destructor
+/// @details Waits until the checkpoint being written in the background (if any) is complete
+MEParallelApp::~MEParallelApp()
+{
+   try {
+      waitForCheckpoint();
+   }
+   catch (const AskapError &ex) {
+      ASKAPLOG_WARN_STR(logger, ex.what());
+   }
+}
+
+/// @brief find the major cycle to start from
+/// @details If resuming is requested (checkpoint.resume) and the checkpoint file exists,
+/// the master replaces the current model with the one stored in the checkpoint. The cycle
+/// number is then distributed to all ranks, so this method has to be called by every rank.
+/// @return number of the first major cycle to do (0, if there is nothing to resume from)
+int MEParallelApp::resumeFromCheckpoint()
+{
+   int cycle = 0;
+   if (itsCheckpointResume) {
+       if (itsComms.isMaster()) {
+           cycle = readCheckpoint();
+       }
+       if (itsComms.isParallel()) {
+           itsComms.broadcast(&cycle, sizeof(cycle), 0);
+       }
+   }
+   return cycle;
+}
+
+/// @brief write a checkpoint after the given major cycle, if due
+/// @details Nothing is done unless the checkpoint file name is configured and the number of
+/// completed cycles is a multiple of checkpoint.interval. The master serialises the model in
+/// memory and the file is written in a background thread, so the next major cycle is not held
+/// up by the file system. Only the master does anything, it is safe to call it on every rank.
+/// @param[in] cycle major cycle just completed (counted from 0)
+void MEParallelApp::checkpoint(int cycle)
+{
+   if (!itsComms.isMaster() || (itsCheckpointName == "") || ((cycle + 1) % itsCheckpointInterval != 0)) {
+       return;
+   }
+   ASKAPDEBUGASSERT(itsModel);
+   // images derived by the solver are recomputed in the next major cycle
+   std::vector<std::string> names = itsModel->names();
+   if (!itsCheckpointDerived) {
+       std::vector<std::string> selected;
+       for (std::vector<std::string>::const_iterator ci = names.begin(); ci != names.end(); ++ci) {
+            if ((ci->find("psf.") != 0) && (ci->find("weights.") != 0) && (ci->find("residual.") != 0) &&
+                (ci->find("mask.") != 0) && (ci->find("sensitivity.") != 0)) {
+                selected.push_back(*ci);
+            }
+       }
+       names.swap(selected);
+   }
+   scimath::Params model;
+   model.makeSlice(*itsModel, names);
+   const boost::shared_ptr<LOFAR::BlobString> bs = encodeCheckpoint(cycle, model);
+
+   // only one checkpoint is written at a time, normally the previous one is long complete
+   waitForCheckpoint();
+   ASKAPLOG_INFO_STR(logger, "Writing checkpoint for major cycle "<<cycle<<" ("<<names.size()<<
+                     " parameters, "<<bs->size()<<" bytes) into "<<itsCheckpointName<<" in background");
+   itsCheckpointThread.reset(new boost::thread(boost::bind(&MEParallelApp::backgroundWriteCheckpoint, this, bs,
+                             itsCheckpointName, cycle)));
+}
+
+/// @brief wait until the checkpoint written in the background is complete
+/// @details If writing of the checkpoint has failed, the error is rethrown here, i.e. in the
+/// thread which requested the checkpoint.
+void MEParallelApp::waitForCheckpoint()
+{
+   if (itsCheckpointThread) {
+       itsCheckpointThread->join();
+       itsCheckpointThread.reset();
+   }
+   if (itsCheckpointError != "") {
+       const std::string error = itsCheckpointError;
+       itsCheckpointError = "";
+       ASKAPTHROW(AskapError, error);
+   }
+}
+
+/// @brief read the checkpoint file and replace the model
+/// @return number of the first major cycle to do (0, if the checkpoint is not available)
+int MEParallelApp::readCheckpoint()
+{
+   ASKAPDEBUGASSERT(itsModel);
+   scimath::Params model;
+   const int cycle = readCheckpointFile(itsCheckpointName, model);
+   if (cycle < 0) {
+       ASKAPLOG_WARN_STR(logger, "Checkpoint "<<itsCheckpointName<<" is not available, starting from scratch");
+       return 0;
+   }
+   *itsModel = model;
+   ASKAPLOG_INFO_STR(logger, "Resuming after major cycle "<<cycle<<" with the model read from "<<itsCheckpointName<<
+                     " ("<<model.size()<<" parameters)");
+   return cycle + 1;
+}
+
+/// @brief serialise the checkpoint
+/// @param[in] cycle major cycle just completed
+/// @param[in] model model to store
+/// @return shared pointer to the buffer with the serialised checkpoint
+boost::shared_ptr<LOFAR::BlobString> MEParallelApp::encodeCheckpoint(int cycle, const scimath::Params &model)
+{
+   boost::shared_ptr<LOFAR::BlobString> bs(new LOFAR::BlobString);
+   LOFAR::BlobOBufString bob(*bs);
+   LOFAR::BlobOStream out(bob);
+   out.putStart("MajorCycleCheckpoint", 1);
+   out << cycle << model;
+   out.putEnd();
+   return bs;
+}
+
+/// @brief read the checkpoint file
+/// @param[in] fileName name of the checkpoint file
+/// @param[out] model model stored in the checkpoint
+/// @return major cycle stored in the checkpoint, -1 if the file is not available
+int MEParallelApp::readCheckpointFile(const std::string &fileName, scimath::Params &model)
+{
+   std::ifstream is(fileName.c_str(), std::ios::binary);
+   if (!is) {
+       return -1;
+   }
+   is.seekg(0, std::ios::end);
+   const std::streamoff fileSize = is.tellg();
+   is.seekg(0, std::ios::beg);
+   LOFAR::BlobString bs;
+   bs.resize(fileSize);
+   is.read(static_cast<char*>(static_cast<void*>(bs.data())), fileSize);
+   ASKAPCHECK(is, "Unable to read checkpoint "<<fileName);
+
+   LOFAR::BlobIBufString bib(bs);
+   LOFAR::BlobIStream in(bib);
+   const int version = in.getStart("MajorCycleCheckpoint");
+   ASKAPCHECK(version == 1, "Unsupported version "<<version<<" of the checkpoint "<<fileName);
+   int cycle = -1;
+   in >> cycle >> model;
+   in.getEnd();
+   ASKAPCHECK(cycle >= 0, "Major cycle "<<cycle<<" read from "<<fileName<<" is expected to be non-negative");
+   return cycle;
+}
+
+/// @brief write serialised checkpoint into the file
+/// @details The file is written under a temporary name, flushed to disk and then renamed,
+/// so an interrupted write or a crash of the node never destroys the previous checkpoint.
+/// An exception is thrown if the checkpoint cannot be written.
+/// @param[in] buf serialised checkpoint
+/// @param[in] fileName name of the checkpoint file
+void MEParallelApp::writeCheckpointFile(const boost::shared_ptr<LOFAR::BlobString> &buf,
+                                        const std::string &fileName)
+{
+   ASKAPDEBUGASSERT(buf);
+   std::ostringstream tmpName;
+   tmpName << fileName << ".tmp" << getpid();
+   const int fd = ::open(tmpName.str().c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+   ASKAPCHECK(fd >= 0, "Unable to create "<<tmpName.str()<<": "<<strerror(errno));
+   const char *data = static_cast<const char*>(static_cast<const void*>(buf->data()));
+   size_t written = 0;
+   while (written < buf->size()) {
+      const ssize_t result = ::write(fd, data + written, buf->size() - written);
+      if (result <= 0) {
+          if ((result < 0) && (errno == EINTR)) {
+              continue;
+          }
+          break;
+      }
+      written += size_t(result);
+   }
+   // the data have to be on disk before the rename, otherwise a crash may leave an empty file
+   const bool success = (written == buf->size()) && (::fsync(fd) == 0);
+   const int savedErrno = errno;
+   if ((::close(fd) != 0) || !success || (std::rename(tmpName.str().c_str(), fileName.c_str()) != 0)) {
+       const std::string reason = strerror(success ? errno : savedErrno);
+       std::remove(tmpName.str().c_str());
+       ASKAPTHROW(AskapError, "Unable to write checkpoint into "<<fileName<<": "<<reason);
+   }
+}
+
+/// @brief write serialised checkpoint into the file in the background
+/// @details This method is executed in a separate thread. The error (if any) is stored
+/// and rethrown by waitForCheckpoint.
+/// @param[in] buf serialised checkpoint
+/// @param[in] fileName name of the checkpoint file
+/// @param[in] cycle major cycle stored in the checkpoint (for logging)
+void MEParallelApp::backgroundWriteCheckpoint(const boost::shared_ptr<LOFAR::BlobString> &buf,
+                                              const std::string &fileName, int cycle)
+{
+   try {
+      writeCheckpointFile(buf, fileName);
+      ASKAPLOG_INFO_STR(logger, "Checkpoint for major cycle "<<cycle<<" has been written into "<<fileName);
+   }
+   catch (const AskapError &ex) {
+      itsCheckpointError = ex.what();
+   }
+}
+}
@@ -36,9 +36,14 @@
 // ASKAPsoft includes
 #include <askapparallel/AskapParallel.h>
 #include <Common/ParameterSet.h>
+#include <Blob/BlobString.h>
 #include <parallel/MEParallel.h>
+#include <parallel/ThreadPool.h>
 #include <gridding/IVisGridder.h>
 
+// boost includes
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/thread.hpp>
 
 // std includes
 #include <string>
@@ -60,7 +65,57 @@ public:
    /// @details sets communication object and parameter set
    /// @param[in] comms communication object
    /// @param[in] parset parameter set
-   MEParallelApp(askap::askapparallel::AskapParallel& comms, const LOFAR::ParameterSet& parset);
+   /// @param[in] dynamicScheduling true if the application hands out the datasets via
+   /// WorkUnitScheduler when scheduling=dynamic is given in the parset. In this case, the datasets
+   /// are not substituted per rank and their number doesn't need to match the number of workers.
+   /// For other applications the scheduling parameter is ignored.
+   MEParallelApp(askap::askapparallel::AskapParallel& comms, const LOFAR::ParameterSet& parset,
+                 const bool dynamicScheduling = false);
+
+   /// @brief destructor
+   /// @details Waits until the checkpoint being written in the background (if any) is complete
+   virtual ~MEParallelApp();
+
+   /// @brief find the major cycle to start from
+   /// @details If resuming is requested (checkpoint.resume) and the checkpoint file exists,
+   /// the master replaces the current model with the one stored in the checkpoint. The cycle
+   /// number is then distributed to all ranks, so this method has to be called by every rank.
+   /// @return number of the first major cycle to do (0, if there is nothing to resume from)
+   int resumeFromCheckpoint();
+
+   /// @brief write a checkpoint after the given major cycle, if due
+   /// @details Nothing is done unless the checkpoint file name is configured and the number of
+   /// completed cycles is a multiple of checkpoint.interval. The master serialises the model in
+   /// memory and the file is written in a background thread, so the next major cycle is not held
+   /// up by the file system. Only the master does anything, it is safe to call it on every rank.
+   /// @param[in] cycle major cycle just completed (counted from 0)
+   void checkpoint(int cycle);
+
+   /// @brief wait until the checkpoint written in the background is complete
+   /// @details If writing of the checkpoint has failed, the error is rethrown here, i.e. in the
+   /// thread which requested the checkpoint.
+   void waitForCheckpoint();
+
+   /// @brief serialise the checkpoint
+   /// @param[in] cycle major cycle just completed
+   /// @param[in] model model to store
+   /// @return shared pointer to the buffer with the serialised checkpoint
+   static boost::shared_ptr<LOFAR::BlobString> encodeCheckpoint(int cycle, const scimath::Params &model);
+
+   /// @brief write serialised checkpoint into the file
+   /// @details The file is written under a temporary name, flushed to disk and then renamed,
+   /// so an interrupted write or a crash of the node never destroys the previous checkpoint.
+   /// An exception is thrown if the checkpoint cannot be written.
+   /// @param[in] buf serialised checkpoint
+   /// @param[in] fileName name of the checkpoint file
+   static void writeCheckpointFile(const boost::shared_ptr<LOFAR::BlobString> &buf,
+                                   const std::string &fileName);
+
+   /// @brief read the checkpoint file
+   /// @param[in] fileName name of the checkpoint file
+   /// @param[out] model model stored in the checkpoint
+   /// @return major cycle stored in the checkpoint, -1 if the file is not available
+   static int readCheckpointFile(const std::string &fileName, scimath::Params &model);
 
 protected:
    
@@ -83,11 +138,23 @@ protected:
    /// @details to be used in derived classes
    /// @return direction tolerance (in radians) for uvw machine cache
    inline double uvwMachineCacheTolerance() const { return itsUVWMachineCacheTolerance; }
+
+   /// @brief obtain the number of chunks read ahead
+   /// @details to be used in derived classes to configure data sources
+   /// @return maximum number of chunks read ahead in a background thread (0 means no read ahead)
+   inline casa::uInt readAheadChunks() const { return itsReadAheadChunks; }
    
    /// @brief obtain gridder
    /// @details to be used in derived classes
    /// @return shared pointer to the gridder template
    inline IVisGridder::ShPtr gridder() const { return itsGridder; }
+
+   /// @brief obtain the thread pool of this rank
+   /// @details The pool is set up in workers from the nthreads and threads.* parameters of the
+   /// parset. It can be used by derived classes to process independent pieces of data
+   /// concurrently (with their own equations and normal equations merged at the end).
+   /// @return shared pointer to the pool, empty if only one thread per rank is requested
+   inline const ThreadPool::ShPtr& threadPool() const { return itsThreadPool; }
    
 
 protected:
@@ -101,6 +168,38 @@ protected:
    
 private:   
 
+   /// @brief read the checkpoint file and replace the model
+   /// @return number of the first major cycle to do (0, if the checkpoint is not available)
+   int readCheckpoint();
+
+   /// @brief write serialised checkpoint into the file in the background
+   /// @details This method is executed in a separate thread. The error (if any) is stored
+   /// and rethrown by waitForCheckpoint.
+   /// @param[in] buf serialised checkpoint
+   /// @param[in] fileName name of the checkpoint file
+   /// @param[in] cycle major cycle stored in the checkpoint (for logging)
+   void backgroundWriteCheckpoint(const boost::shared_ptr<LOFAR::BlobString> &buf,
+                                  const std::string &fileName, int cycle);
+
+   /// @brief name of the checkpoint file (empty string means no checkpointing)
+   std::string itsCheckpointName;
+
+   /// @brief number of major cycles between checkpoints
+   int itsCheckpointInterval;
+
+   /// @brief true, if the run should resume from the checkpoint
+   bool itsCheckpointResume;
+
+   /// @brief true, if derived images (psf, residual, weights, etc) are included into the checkpoint
+   bool itsCheckpointDerived;
+
+   /// @brief thread writing the checkpoint file
+   boost::shared_ptr<boost::thread> itsCheckpointThread;
+
+   /// @brief error message of the failed background write, empty if there was no error
+   /// @details Only accessed by the writing thread while it runs, the join synchronises it
+   std::string itsCheckpointError;
+
    /// @brief name of the data column to use.
    std::string itsDataColName;
 
@@ -113,8 +212,14 @@ private:
    /// @brief direction tolerance (in radians) for uvw machine cache
    double itsUVWMachineCacheTolerance;
 
+   /// @brief maximum number of chunks read ahead in a background thread (0 means no read ahead)
+   casa::uInt itsReadAheadChunks;
+
    /// @brief gridder to be used
    IVisGridder::ShPtr itsGridder;		    			  	
+
+   /// @brief pool of threads of this rank (empty for one thread per rank)
+   ThreadPool::ShPtr itsThreadPool;
 }; 
 
 } // namespace synthesis
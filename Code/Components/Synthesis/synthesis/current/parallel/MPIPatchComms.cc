@@ -0,0 +1,74 @@
+/// @file
+///
+/// @brief MPI-based communication for the patch-based Hogbom CLEAN
+/// @details This class implements the IPatchComms interface on top of the world
+/// communicator of AskapParallel, so the patches of the minor cycle can be shared
+/// between the master and the workers of cimager.
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author agent <agent@local>
+
+#include <parallel/MPIPatchComms.h>
+
+namespace askap {
+
+namespace synthesis {
+
+/// @brief construct the adapter
+/// @param[in] comms communication object
+MPIPatchComms::MPIPatchComms(askapparallel::AskapParallel &comms) : itsComms(comms) {}
+
+/// @brief rank of this process
+/// @return rank in the world communicator
+int MPIPatchComms::rank() const
+{
+  return itsComms.rank();
+}
+
+/// @brief number of ranks sharing the patches
+/// @return number of ranks in the world communicator
+int MPIPatchComms::nProcs() const
+{
+  return itsComms.nProcs();
+}
+
+/// @brief broadcast a buffer from the master to all other ranks
+/// @param[in] buf pointer to the buffer (input on the master, output on other ranks)
+/// @param[in] size size of the buffer in bytes
+void MPIPatchComms::broadcast(void* buf, size_t size)
+{
+  itsComms.broadcast(buf, size, 0);
+}
+
+/// @brief sum a buffer across all ranks, the result is received by the master
+/// @param[in] buf pointer to the buffer (in/out)
+/// @param[in] n number of elements in the buffer
+void MPIPatchComms::sumToMaster(double* buf, size_t n)
+{
+  itsComms.sumToRoot(buf, n, 0);
+}
+
+} // namespace synthesis
+
+} // namespace askap
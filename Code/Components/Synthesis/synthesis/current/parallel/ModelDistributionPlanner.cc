@@ -0,0 +1,124 @@
+/// @file
+///
+/// @brief Size-aware distribution of model parameters between groups of workers
+/// @details When workers are partitioned into groups, each group deals with a subset
+/// of image parameters. The planner estimates the cost of every parameter and assigns
+/// parameters to groups so the total cost of all groups is as even as possible. The plan
+/// is computed once and reused in the following major cycles as long as the list of
+/// parameters to distribute doesn't change, so every group keeps the same parameters.
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author agent <agent@local>
+
+// Include package level header file
+#include <askap_synthesis.h>
+
+#include <parallel/ModelDistributionPlanner.h>
+
+// ASKAPsoft includes
+#include <askap/AskapError.h>
+#include <askap/AskapLogging.h>
+#include <askap/AskapUtil.h>
+
+// std includes
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+ASKAP_LOGGER(logger, ".parallel");
+
+namespace askap {
+
+namespace synthesis {
+
+/// @brief construct the planner
+/// @param[in] parset parset (imager subset)
+ModelDistributionPlanner::ModelDistributionPlanner(const LOFAR::ParameterSet &parset) :
+      itsGridCost(parset.getDouble("modeldistribution.gridcost", 0.))
+{
+   ASKAPCHECK(itsGridCost >= 0., "modeldistribution.gridcost is supposed to be non-negative, you have "<<itsGridCost);
+}
+
+/// @brief estimate the cost of the given parameter
+/// @param[in] model model containing the parameter
+/// @param[in] name parameter name
+/// @return estimated cost in arbitrary units
+double ModelDistributionPlanner::cost(const scimath::Params &model, const std::string &name) const
+{
+   const double nPixels = std::max(double(model.value(name).nelements()), 2.);
+   return itsGridCost + nPixels * std::log(nPixels) / std::log(2.);
+}
+
+/// @brief obtain the assignment of parameters to groups
+/// @details The plan is only recomputed if the number of groups or the list of
+/// parameters has changed since the last call.
+/// @param[in] model model containing all parameters to distribute
+/// @param[in] names names of the parameters to distribute
+/// @param[in] nGroups number of groups of workers
+/// @return vector with the parameter names for each group
+const std::vector<std::vector<std::string> >& ModelDistributionPlanner::plan(const scimath::Params &model,
+                  const std::vector<std::string> &names, size_t nGroups)
+{
+   ASKAPDEBUGASSERT(nGroups > 0);
+   std::vector<std::string> sortedNames(names);
+   std::sort(sortedNames.begin(), sortedNames.end());
+   if ((itsPlan.size() == nGroups) && (sortedNames == itsNames)) {
+       return itsPlan;
+   }
+   ASKAPCHECK(names.size() >= nGroups, "The model has too few parameters ("<<
+              names.size()<<") to distribute between "<< nGroups<<" groups");
+
+   // parameters in the order of decreasing cost, ties are resolved by name to get
+   // the same plan for the same model
+   std::vector<std::pair<double, std::string> > costs;
+   costs.reserve(sortedNames.size());
+   for (std::vector<std::string>::const_iterator ci = sortedNames.begin(); ci != sortedNames.end(); ++ci) {
+        costs.push_back(std::make_pair(-cost(model, *ci), *ci));
+   }
+   std::sort(costs.begin(), costs.end());
+
+   std::vector<double> groupCosts(nGroups, 0.);
+   itsPlan.assign(nGroups, std::vector<std::string>());
+   for (std::vector<std::pair<double, std::string> >::const_iterator ci = costs.begin(); ci != costs.end(); ++ci) {
+        const size_t group = std::min_element(groupCosts.begin(), groupCosts.end()) - groupCosts.begin();
+        itsPlan[group].push_back(ci->second);
+        groupCosts[group] -= ci->first;
+   }
+   itsNames = sortedNames;
+
+   const double maxCost = *std::max_element(groupCosts.begin(), groupCosts.end());
+   const double minCost = *std::min_element(groupCosts.begin(), groupCosts.end());
+   ASKAPLOG_INFO_STR(logger, "Distribution plan for "<<names.size()<<" model parameters between "<<
+                     nGroups<<" groups of workers, the ratio of the largest to the smallest estimated cost is "<<
+                     (minCost > 0. ? maxCost / minCost : 1.));
+   for (size_t group = 0; group < nGroups; ++group) {
+        ASKAPLOG_INFO_STR(logger, "  group "<<group<<": estimated cost "<<groupCosts[group]<<
+                          ", parameters "<<itsPlan[group]);
+   }
+   return itsPlan;
+}
+
+} // namespace synthesis
+
+} // namespace askap
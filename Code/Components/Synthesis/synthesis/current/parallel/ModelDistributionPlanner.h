@@ -0,0 +1,98 @@
+/// @file
+///
+/// @brief Size-aware distribution of model parameters between groups of workers
+/// @details When workers are partitioned into groups, each group deals with a subset
+/// of image parameters. The planner estimates the cost of every parameter and assigns
+/// parameters to groups so the total cost of all groups is as even as possible. The plan
+/// is computed once and reused in the following major cycles as long as the list of
+/// parameters to distribute doesn't change, so every group keeps the same parameters.
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author agent <agent@local>
+
+#ifndef ASKAP_SYNTHESIS_MODEL_DISTRIBUTION_PLANNER_H
+#define ASKAP_SYNTHESIS_MODEL_DISTRIBUTION_PLANNER_H
+
+// ASKAPsoft includes
+#include <fitting/Params.h>
+#include <Common/ParameterSet.h>
+
+// std includes
+#include <string>
+#include <vector>
+
+namespace askap {
+
+namespace synthesis {
+
+/// @brief size-aware distribution of model parameters between groups of workers
+/// @details The cost of a parameter is estimated as
+/// @code
+/// cost = gridcost + nPixels * log2(nPixels)
+/// @endcode
+/// i.e. the fixed cost of gridding all visibilities (expressed in the same units) plus
+/// the cost of FFTs and other image-based operations. The parameters are assigned in
+/// the order of decreasing cost to the group with the smallest total cost so far (the
+/// longest processing time first rule). The following parameter is recognised:
+/// @li modeldistribution.gridcost - cost of gridding per parameter (default 0, i.e.
+/// parameters are weighted by size only)
+/// @ingroup parallel
+class ModelDistributionPlanner {
+public:
+   /// @brief construct the planner
+   /// @param[in] parset parset (imager subset)
+   explicit ModelDistributionPlanner(const LOFAR::ParameterSet &parset);
+
+   /// @brief obtain the assignment of parameters to groups
+   /// @details The plan is only recomputed if the number of groups or the list of
+   /// parameters has changed since the last call.
+   /// @param[in] model model containing all parameters to distribute
+   /// @param[in] names names of the parameters to distribute
+   /// @param[in] nGroups number of groups of workers
+   /// @return vector with the parameter names for each group
+   const std::vector<std::vector<std::string> >& plan(const scimath::Params &model,
+                  const std::vector<std::string> &names, size_t nGroups);
+
+   /// @brief estimate the cost of the given parameter
+   /// @param[in] model model containing the parameter
+   /// @param[in] name parameter name
+   /// @return estimated cost in arbitrary units
+   double cost(const scimath::Params &model, const std::string &name) const;
+
+private:
+   /// @brief fixed cost of gridding per parameter
+   double itsGridCost;
+
+   /// @brief sorted names of the parameters of the current plan
+   std::vector<std::string> itsNames;
+
+   /// @brief current plan
+   std::vector<std::vector<std::string> > itsPlan;
+};
+
+} // namespace synthesis
+
+} // namespace askap
+
+#endif // #ifndef ASKAP_SYNTHESIS_MODEL_DISTRIBUTION_PLANNER_H
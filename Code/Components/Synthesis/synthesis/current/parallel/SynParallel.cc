@@ -40,6 +40,8 @@
 #include <gridding/TableVisGridder.h>
 #include <gridding/IVisGridder.h>
 #include <profile/AskapProfiler.h>
+#include <fitting/ISegmentedSerializable.h>
+#include <fitting/Axes.h>
 
 
 #include <sstream>
@@ -47,12 +49,14 @@
 #include <vector>
 #include <string>
 #include <algorithm>
+#include <cstring>
 
 #include <Blob/BlobString.h>
 #include <Blob/BlobIBufString.h>
 #include <Blob/BlobOBufString.h>
 #include <Blob/BlobIStream.h>
 #include <Blob/BlobOStream.h>
+#include <Blob/BlobArray.h>
 
 #include <casa/OS/Timer.h>
 #include <casa/Utilities/Regex.h>
@@ -77,11 +81,24 @@ namespace askap
   {
 
     SynParallel::SynParallel(askap::askapparallel::AskapParallel& comms, const LOFAR::ParameterSet& parset) : 
-                         itsComms(comms), itsParset(parset)
+                         itsComms(comms), itsSharedModel(false), itsSharedModelBuffer(0),
+                         itsSharedModelBufferSize(0), itsParset(parset)
     {
       itsModel.reset(new Params());
       ASKAPCHECK(itsModel, "Model not defined correctly");
 
+      const std::string distribution = parset.getString("modeldistribution", "balanced");
+      ASKAPCHECK((distribution == "balanced") || (distribution == "contiguous"), 
+                 "modeldistribution is supposed to be either balanced or contiguous, you have "<<distribution);
+      if ((distribution == "balanced") && itsComms.isMaster()) {
+          itsDistributionPlanner.reset(new ModelDistributionPlanner(parset));
+      }
+
+      itsSharedModel = itsComms.isParallel() && parset.getBool("sharedmodel", false);
+      if (itsSharedModel) {
+          ASKAPLOG_INFO_STR(logger, "Model will be shared between all ranks on the same node");
+      }
+
       // setup frequency frame
       const std::string freqFrame = parset.getString("freqframe","topo");
       if (freqFrame == "topo") {
@@ -156,36 +173,42 @@ namespace askap
             }
             //
             ASKAPDEBUGASSERT(itsComms.nGroups() > 1);
-            // number of parameters per group (note the last group can have more)
-            const size_t nPerGroup = names2distribute.size() / itsComms.nGroups();
             // this check is not relevant if all parameters are in names2keep
-            if (names2distribute.size() > 0) {
-                ASKAPCHECK(nPerGroup > 0, "The model has too few parameters ("<<
-                      names2distribute.size()<<") to distribute between "<< itsComms.nGroups()<<" groups");
-            } else {
+            if (names2distribute.size() == 0) {
                 ASKAPCHECK(names2keep.size() > 0, "The model has too few parameters ("<<
                       names2keep.size()<<")");
             }
+            std::vector<std::vector<std::string> > assignment;
+            if (itsDistributionPlanner && (names2distribute.size() > 0)) {
+                assignment = itsDistributionPlanner->plan(*itsModel, names2distribute, itsComms.nGroups());
+            } else {
+                // number of parameters per group (note the last group can have more)
+                const size_t nPerGroup = names2distribute.size() / itsComms.nGroups();
+                if (names2distribute.size() > 0) {
+                    ASKAPCHECK(nPerGroup > 0, "The model has too few parameters ("<<
+                          names2distribute.size()<<") to distribute between "<< itsComms.nGroups()<<" groups");
+                }
+                assignment.resize(itsComms.nGroups());
+                for (size_t group = 0, index = 0; group<itsComms.nGroups(); ++group, index+=nPerGroup) {
+                     const size_t nPerCurrentGroup = (group + 1 < itsComms.nGroups()) ? 
+                              nPerGroup : names2distribute.size() - index; 
+                     ASKAPDEBUGASSERT((names2distribute.size() > index) || (names2distribute.size() == 0));
+                     if (nPerCurrentGroup != nPerGroup) {
+                         ASKAPLOG_WARN_STR(logger, "An unbalanced distribution of the model has been detected. "
+                                           " the last group ("<<group<<") will have "<<nPerCurrentGroup<<
+                                           " parameters vs. "<<nPerGroup<<" for other groups");
+                     }
+                     assignment[group].assign(names2distribute.begin() + index, 
+                                              names2distribute.begin() + index + nPerCurrentGroup);
+                }
+            }
+            ASKAPDEBUGASSERT(assignment.size() == itsComms.nGroups());
             
             std::vector<std::string> currentNames;
-            currentNames.reserve(itsComms.nGroups() + nPerGroup - 1 + names2keep.size());
             scimath::Params buffer;
-            for (size_t group = 0, index = 0; group<itsComms.nGroups(); ++group, index+=nPerGroup) {
-                 const size_t nPerCurrentGroup = (group + 1 < itsComms.nGroups()) ? 
-                          nPerGroup : names2distribute.size() - index; 
-                 ASKAPDEBUGASSERT((names2distribute.size() > index) || (names2distribute.size() == 0));
-                 if (nPerCurrentGroup != nPerGroup) {
-                     ASKAPLOG_WARN_STR(logger, "An unbalanced distribution of the model has been detected. "
-                                       " the last group ("<<group<<") will have "<<nPerCurrentGroup<<
-                                       " parameters vs. "<<nPerGroup<<" for other groups");
-                 }
-                 currentNames.resize(nPerCurrentGroup + names2keep.size());
-                 for (size_t i = 0; i<nPerCurrentGroup; ++i) {
-                      currentNames[i] = names2distribute[index + i];
-                 }
-                 for (size_t i = 0; i<names2keep.size(); ++i) {
-                      currentNames[nPerCurrentGroup + i] = names2keep[i];
-                 }
+            for (size_t group = 0; group<itsComms.nGroups(); ++group) {
+                 currentNames = assignment[group];
+                 currentNames.insert(currentNames.end(), names2keep.begin(), names2keep.end());
                  ASKAPLOG_INFO_STR(logger, "Group "<<group<<
                         " will get the following parameters: "<<currentNames);
                  buffer.makeSlice(*itsModel, currentNames);
@@ -262,14 +285,21 @@ namespace askap
         ASKAPDEBUGTRACE("SynParallel::broadcastModelImpl");
 
         ASKAPDEBUGASSERT(itsComms.isParallel() && itsComms.isMaster());
+        if (itsSharedModel) {
+            broadcastSharedModel(model);
+            return;
+        }
         LOFAR::BlobString bs;
         bs.resize(0);
         LOFAR::BlobOBufString bob(bs);
         LOFAR::BlobOStream out(bob);
-        out.putStart("model", 1);
-        out << model;
+        // large arrays are broadcast directly from the model storage after the blob
+        askapparallel::AskapParallel::MemorySegments segments;
+        out.putStart("model", 2);
+        model.writeToBlob(out, segments);
         out.putEnd();
         itsComms.broadcastBlob(bs ,0);
+        itsComms.broadcastSegments(segments, 0);
     }
 
     /// @brief actual implementation of the model receive
@@ -282,15 +312,247 @@ namespace askap
         ASKAPDEBUGTRACE("SynParallel::receiveModelImpl");
 
         ASKAPDEBUGASSERT(itsComms.isParallel() && itsComms.isWorker());
+        if (itsSharedModel) {
+            receiveSharedModel(model);
+            return;
+        }
         LOFAR::BlobString bs;
         bs.resize(0);
         itsComms.broadcastBlob(bs, 0);
         LOFAR::BlobIBufString bib(bs);
         LOFAR::BlobIStream in(bib);
         int version=in.getStart("model");
-        ASKAPASSERT(version==1);
-        in >> model;
+        ASKAPASSERT(version==2);
+        askapparallel::AskapParallel::MemorySegments segments;
+        model.readFromBlob(in, segments);
         in.getEnd();
+        itsComms.broadcastSegments(segments, 0);
+    }
+    
+    /// @brief model broadcast via node-local shared memory
+    /// @details The master sends the model to one rank per node (node leader), which
+    /// receives large arrays directly into a buffer shared by all ranks on the node. 
+    /// Other ranks reference this buffer instead of holding their own copy of the model.
+    /// This method is only supposed to be called from the master.
+    /// @param[in] model the model to send
+    void SynParallel::broadcastSharedModel(const scimath::Params &model)
+    {
+        ASKAPDEBUGTRACE("SynParallel::broadcastSharedModel");
+        ASKAPCHECK(itsComms.nGroups() == 1, "Shared model can't be combined with nworkergroups > 1");
+        itsComms.defineNodeComms();
+        // the master is always the leader on its node and has rank 0 amongst the leaders
+        ASKAPDEBUGASSERT(itsComms.isNodeLeader());
+        LOFAR::BlobString bs;
+        bs.resize(0);
+        LOFAR::BlobOBufString bob(bs);
+        LOFAR::BlobOStream out(bob);
+        askapparallel::AskapParallel::MemorySegments segments;
+        out.putStart("model", 2);
+        model.writeToBlob(out, segments);
+        out.putEnd();
+        try {
+           itsComms.useNodeLeaders();
+           itsComms.broadcastBlob(bs, 0);
+           // workers on the same node as the master get the model via the shared buffer
+           itsComms.useNode();
+           const std::map<std::string, size_t> offsets = shareModelWithNode(model);
+           for (std::map<std::string, size_t>::const_iterator ci = offsets.begin(); ci != offsets.end(); ++ci) {
+                const casa::Array<double> &value = model.value(ci->first);
+                ASKAPDEBUGASSERT(value.contiguousStorage());
+                memcpy(static_cast<char*>(itsSharedModelBuffer) + ci->second, value.data(), 
+                       value.nelements() * sizeof(double));
+           }
+           itsComms.useNodeLeaders();
+           itsComms.broadcastSegments(segments, 0);
+        }
+        catch (const std::exception &) {
+           itsComms.useAllWorkers();
+           throw;
+        }
+        itsComms.useAllWorkers();
+        itsComms.nodeBarrier();
+    }
+
+    /// @brief give the equation a shallow copy of the model
+    /// @details The equation references the arrays of the given model instead of holding
+    /// its own copy, i.e. neither Params::clone nor Params::operator= is involved. This is
+    /// how workers avoid duplicating the model received via node-local shared memory.
+    /// Facet images are clipped in place by the imaging equation, so a model with facets
+    /// is not referenced and the equation is left unchanged.
+    /// @param[in] equation equation to update
+    /// @param[in] model model to reference
+    /// @return true if the model has been referenced, false if a copy is required
+    bool SynParallel::referenceModel(scimath::Equation &equation, const scimath::Params &model)
+    {
+        const std::vector<std::string> names = model.names();
+        for (std::vector<std::string>::const_iterator ci = names.begin(); ci != names.end(); ++ci) {
+             if (model.axes(*ci).has("FACETSTEP")) {
+                 return false;
+             }
+        }
+        // makeSlice has reference semantics for the arrays
+        scimath::Params::ShPtr slice(new scimath::Params);
+        slice->makeSlice(model, names);
+        equation.reference(slice);
+        return true;
+    }
+
+    /// @brief receive the model via node-local shared memory
+    /// @details This method is only supposed to be called from workers, it is
+    /// a counterpart of broadcastSharedModel. Large arrays of the model reference the
+    /// shared buffer. They must not be modified in place (replacing the value via
+    /// Params::update is fine). Measurement equations reference these arrays
+    /// too, see referenceModel.
+    /// @param[in] model the model to fill
+    void SynParallel::receiveSharedModel(scimath::Params &model)
+    {
+        ASKAPDEBUGTRACE("SynParallel::receiveSharedModel");
+        ASKAPCHECK(itsComms.nGroups() == 1, "Shared model can't be combined with nworkergroups > 1");
+        itsComms.defineNodeComms();
+        LOFAR::BlobString bs;
+        bs.resize(0);
+        if (itsComms.isNodeLeader()) {
+            try {
+               itsComms.useNodeLeaders();
+               itsComms.broadcastBlob(bs, 0);
+               LOFAR::BlobIBufString bib(bs);
+               LOFAR::BlobIStream in(bib);
+               const int version = in.getStart("model");
+               ASKAPASSERT(version == 2);
+               // storage allocated here for large arrays is replaced by the shared buffer 
+               // before the data are received, so it is never used
+               askapparallel::AskapParallel::MemorySegments segments;
+               model.readFromBlob(in, segments);
+               in.getEnd();
+               itsComms.useNode();
+               const std::map<std::string, size_t> offsets = shareModelWithNode(model);
+               for (std::map<std::string, size_t>::const_iterator ci = offsets.begin(); ci != offsets.end(); ++ci) {
+                    casa::Array<double> &value = model.value(ci->first);
+                    value.reference(casa::Array<double>(value.shape(), reinterpret_cast<double*>(
+                                    static_cast<char*>(itsSharedModelBuffer) + ci->second), casa::SHARE));
+               }
+               // the same segments, but pointing to the shared buffer now
+               LOFAR::BlobString dummy;
+               LOFAR::BlobOBufString dummyBuf(dummy);
+               LOFAR::BlobOStream dummyOut(dummyBuf);
+               askapparallel::AskapParallel::MemorySegments sharedSegments;
+               model.writeToBlob(dummyOut, sharedSegments);
+               ASKAPCHECK(sharedSegments.size() == segments.size(), "Number of segments changed after moving the model to the shared buffer");
+               for (size_t seg = 0; seg < segments.size(); ++seg) {
+                    ASKAPCHECK(sharedSegments[seg].second == segments[seg].second, 
+                           "Size of segment "<<seg<<" changed after moving the model to the shared buffer");
+               }
+               itsComms.useNodeLeaders();
+               itsComms.broadcastSegments(sharedSegments, 0);
+            }
+            catch (const std::exception &) {
+               itsComms.useAllWorkers();
+               throw;
+            }
+            itsComms.useAllWorkers();
+            itsComms.nodeBarrier();
+        } else {
+            itsComms.useNode();
+            try {
+               itsComms.broadcastBlob(bs, 0);
+            }
+            catch (const std::exception &) {
+               itsComms.useAllWorkers();
+               throw;
+            }
+            itsComms.useAllWorkers();
+            LOFAR::BlobIBufString bib(bs);
+            LOFAR::BlobIStream in(bib);
+            const int version = in.getStart("nodemodel");
+            ASKAPASSERT(version == 1);
+            LOFAR::uint64 totalSize = 0;
+            in >> totalSize;
+            reserveSharedModelBuffer(totalSize);
+            // wait until the leader has filled the buffer
+            itsComms.nodeBarrier();
+            casa::uInt nShared = 0;
+            in >> model >> nShared;
+            for (casa::uInt item = 0; item < nShared; ++item) {
+                 std::string name;
+                 casa::IPosition shape;
+                 scimath::Axes axes;
+                 bool isFree = true;
+                 LOFAR::uint64 offset = 0;
+                 in >> name >> shape >> axes >> isFree >> offset;
+                 ASKAPDEBUGASSERT(offset + shape.product() * sizeof(double) <= itsSharedModelBufferSize);
+                 model.add(name, casa::Array<double>(), axes);
+                 model.value(name).reference(casa::Array<double>(shape, reinterpret_cast<double*>(
+                             static_cast<char*>(itsSharedModelBuffer) + offset), casa::SHARE));
+                 if (!isFree) {
+                     model.fix(name);
+                 }
+            }
+            in.getEnd();
+        }
+    }
+
+    /// @brief send the description of the model to all ranks on this node
+    /// @details This method is only supposed to be called from the node leader.
+    /// Large arrays are assigned consecutive parts of the node-local shared buffer
+    /// (allocated or enlarged as necessary), other parameters are sent as they are.
+    /// @param[in] model the model to describe
+    /// @return offsets in the shared buffer for all parameters placed there
+    std::map<std::string, size_t> SynParallel::shareModelWithNode(const scimath::Params &model)
+    {
+        ASKAPDEBUGASSERT(itsComms.isNodeLeader());
+        // parts of the buffer are aligned to the cache line
+        const size_t alignment = 64;
+        std::map<std::string, size_t> offsets;
+        std::vector<std::string> otherNames;
+        size_t totalSize = 0;
+        const std::vector<std::string> names = model.names();
+        for (std::vector<std::string>::const_iterator ci = names.begin(); ci != names.end(); ++ci) {
+             const casa::Array<double> &value = model.value(*ci);
+             const size_t nBytes = value.nelements() * sizeof(double);
+             // the same criterion as used for transport of large arrays
+             if ((nBytes >= ISegmentedSerializable::theMinSegmentSize) && value.contiguousStorage()) {
+                 offsets[*ci] = totalSize;
+                 totalSize += (nBytes + alignment - 1) / alignment * alignment;
+             } else {
+                 otherNames.push_back(*ci);
+             }
+        }
+        scimath::Params otherParams;
+        otherParams.makeSlice(model, otherNames);
+
+        LOFAR::BlobString bs;
+        bs.resize(0);
+        LOFAR::BlobOBufString bob(bs);
+        LOFAR::BlobOStream out(bob);
+        out.putStart("nodemodel", 1);
+        out << static_cast<LOFAR::uint64>(totalSize) << otherParams << static_cast<casa::uInt>(offsets.size());
+        for (std::map<std::string, size_t>::const_iterator ci = offsets.begin(); ci != offsets.end(); ++ci) {
+             out << ci->first << model.value(ci->first).shape() << model.axes(ci->first) << 
+                    model.isFree(ci->first) << static_cast<LOFAR::uint64>(ci->second);
+        }
+        out.putEnd();
+        itsComms.broadcastBlob(bs, 0);
+        reserveSharedModelBuffer(totalSize);
+        return offsets;
+    }
+
+    /// @brief ensure the node-local shared buffer is large enough
+    /// @details This is a collective call for all ranks on the node.
+    /// @param[in] size required size in bytes
+    void SynParallel::reserveSharedModelBuffer(size_t size)
+    {
+        // all ranks on the node make the same decision as the size is the same
+        if ((itsSharedModelBuffer != 0) && (size <= itsSharedModelBufferSize)) {
+            return;
+        }
+        if (itsSharedModelBuffer != 0) {
+            // arrays referencing the old buffer are replaced before they're used again
+            itsComms.freeShared(itsSharedModelBuffer);
+            itsSharedModelBuffer = 0;
+        }
+        itsSharedModelBuffer = itsComms.allocateNodeShared(size);
+        itsSharedModelBufferSize = size;
+        ASKAPLOG_INFO_STR(logger, "Allocated "<<size / 1048576<<" MB of node-local shared memory for the model");
     }
     
     /// @brief helper method to identify model parameters to broadcast
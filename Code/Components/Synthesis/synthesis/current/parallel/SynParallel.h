@@ -38,8 +38,14 @@
 
 
 #include <askapparallel/AskapParallel.h>
+#include <parallel/ModelDistributionPlanner.h>
 #include <measures/Measures/MFrequency.h>
 
+#include <boost/shared_ptr.hpp>
+
+#include <map>
+#include <string>
+
 namespace askap
 {
   namespace synthesis
@@ -83,6 +89,17 @@ namespace askap
       // through to the AskapParallel version of substitute()
       std::string substitute(const std::string& s) const;
 
+      /// @brief give the equation a shallow copy of the model
+      /// @details The equation references the arrays of the given model instead of holding
+      /// its own copy, i.e. neither Params::clone nor Params::operator= is involved. This is
+      /// how workers avoid duplicating the model received via node-local shared memory.
+      /// Facet images are clipped in place by the imaging equation, so a model with facets
+      /// is not referenced and the equation is left unchanged.
+      /// @param[in] equation equation to update
+      /// @param[in] model model to reference
+      /// @return true if the model has been referenced, false if a copy is required
+      static bool referenceModel(scimath::Equation &equation, const scimath::Params &model);
+
   protected:
       /// @brief helper method to indentify model parameters to broadcast
       /// @details We use itsModel to buffer some derived images like psf, weights, etc
@@ -113,6 +130,10 @@ namespace askap
       /// @return reference to the parameter set object
       inline const LOFAR::ParameterSet& parset() const { return itsParset;}
 
+      /// @brief check whether the model is distributed via node-local shared memory
+      /// @return true if large arrays of the model received by workers reference the shared buffer
+      inline bool sharedModel() const { return itsSharedModel;}
+
       /// @brief read the models from parset file to the given params object
       /// @details The model can be composed from both images and components. This
       /// method populates Params object by adding model data read from the parset file.
@@ -138,6 +159,49 @@ namespace askap
       static IVisGridder::ShPtr createGridder(const askap::askapparallel::AskapParallel& comms, 
                            const LOFAR::ParameterSet& parset);
   private:
+      /// @brief model broadcast via node-local shared memory
+      /// @details The master sends the model to one rank per node (node leader), which
+      /// receives large arrays directly into a buffer shared by all ranks on the node. 
+      /// Other ranks reference this buffer instead of holding their own copy of the model.
+      /// This method is only supposed to be called from the master.
+      /// @param[in] model the model to send
+      void broadcastSharedModel(const scimath::Params &model);
+
+      /// @brief receive the model via node-local shared memory
+      /// @details This method is only supposed to be called from workers, it is
+      /// a counterpart of broadcastSharedModel. Large arrays of the model reference the
+      /// shared buffer. They must not be modified in place (replacing the value via
+      /// Params::update is fine). Measurement equations reference these arrays
+      /// too, see referenceModel.
+      /// @param[in] model the model to fill
+      void receiveSharedModel(scimath::Params &model);
+
+      /// @brief send the description of the model to all ranks on this node
+      /// @details This method is only supposed to be called from the node leader.
+      /// Large arrays are assigned consecutive parts of the node-local shared buffer
+      /// (allocated or enlarged as necessary), other parameters are sent as they are.
+      /// @param[in] model the model to describe
+      /// @return offsets in the shared buffer for all parameters placed there
+      std::map<std::string, size_t> shareModelWithNode(const scimath::Params &model);
+
+      /// @brief ensure the node-local shared buffer is large enough
+      /// @details This is a collective call for all ranks on the node.
+      /// @param[in] size required size in bytes
+      void reserveSharedModelBuffer(size_t size);
+
+      /// @brief planner of the model distribution between groups of workers
+      /// @details Only used in the master, empty if parameters are distributed by count
+      boost::shared_ptr<ModelDistributionPlanner> itsDistributionPlanner;
+
+      /// @brief true if the model is distributed via node-local shared memory
+      bool itsSharedModel;
+
+      /// @brief node-local buffer for large model arrays (0, if not allocated)
+      void* itsSharedModelBuffer;
+
+      /// @brief size of the node-local buffer in bytes
+      size_t itsSharedModelBufferSize;
+
       /// @brief parameter set to get the parameters from
       LOFAR::ParameterSet itsParset;
  
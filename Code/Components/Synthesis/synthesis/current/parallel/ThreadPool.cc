@@ -0,0 +1,206 @@
+/// @file
+///
+/// @brief Pool of threads owned by each rank of a parallel application
+/// @details Running fewer ranks with several threads each reduces the memory duplicated
+/// between ranks (models, gridders, caches) and the number of MPI messages on many-core
+/// nodes. This class provides a fixed set of threads (optionally pinned to cores)
+/// executing independent tasks submitted by the rank's main thread.
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author agent <agent@local>
+
+// Include package level header file
+#include <askap_synthesis.h>
+
+#include <parallel/ThreadPool.h>
+
+// ASKAPsoft includes
+#include <askap/AskapError.h>
+#include <askap/AskapLogging.h>
+#include <askap/AskapUtil.h>
+
+// boost includes
+#include <boost/bind.hpp>
+
+// std includes
+#include <exception>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+ASKAP_LOGGER(logger, ".parallel");
+
+namespace askap {
+
+namespace synthesis {
+
+/// @brief start the threads
+/// @param[in] nThreads number of threads (should be positive)
+/// @param[in] cores cores to pin the threads to (cyclically), empty vector means no pinning
+ThreadPool::ThreadPool(size_t nThreads, const std::vector<int> &cores) : itsNPending(0), itsStop(false)
+{
+   ASKAPCHECK(nThreads > 0, "Number of threads in the pool should be positive");
+   for (size_t thread = 0; thread < nThreads; ++thread) {
+        const int core = cores.size() > 0 ? cores[thread % cores.size()] : -1;
+        itsThreads.create_thread(boost::bind(&ThreadPool::run, this, core));
+   }
+}
+
+/// @brief stop the threads
+/// @details Tasks still in the queue are executed before the threads finish
+ThreadPool::~ThreadPool()
+{
+   {
+      boost::lock_guard<boost::mutex> lock(itsMutex);
+      itsStop = true;
+   }
+   itsTaskAdded.notify_all();
+   itsThreads.join_all();
+}
+
+/// @brief create the pool from the parset
+/// @param[in] parset parset
+/// @param[in] rank rank of this process (used for the default choice of cores)
+/// @return shared pointer to the pool, or an empty pointer if only one thread is requested
+ThreadPool::ShPtr ThreadPool::create(const LOFAR::ParameterSet &parset, int rank)
+{
+   const int nThreads = parset.getInt32("nthreads", 1);
+   ASKAPCHECK(nThreads > 0, "nthreads is supposed to be positive, you have "<<nThreads);
+   if (nThreads == 1) {
+       return ShPtr();
+   }
+   std::vector<int> cores;
+   if (parset.getBool("threads.pin", false)) {
+       if (parset.isDefined("threads.cores")) {
+           cores = parset.getInt32Vector("threads.cores");
+           ASKAPCHECK(cores.size() > 0, "threads.cores should list at least one core");
+       } else {
+           const int nCores = int(boost::thread::hardware_concurrency());
+           ASKAPCHECK(nCores > 0, "Unable to determine the number of cores, use threads.cores to pin threads");
+           for (int thread = 0; thread < nThreads; ++thread) {
+                cores.push_back((rank * nThreads + thread) % nCores);
+           }
+       }
+   }
+   if (cores.size() > 0) {
+       ASKAPLOG_INFO_STR(logger, "Rank "<<rank<<" will use a pool of "<<nThreads<<" threads pinned to cores "<<cores);
+   } else {
+       ASKAPLOG_INFO_STR(logger, "Rank "<<rank<<" will use a pool of "<<nThreads<<" threads, not pinned");
+   }
+   return ShPtr(new ThreadPool(size_t(nThreads), cores));
+}
+
+/// @brief add task to the queue
+/// @param[in] task task to execute
+void ThreadPool::submit(const Task &task)
+{
+   {
+      boost::lock_guard<boost::mutex> lock(itsMutex);
+      ASKAPDEBUGASSERT(!itsStop);
+      itsQueue.push_back(task);
+      ++itsNPending;
+   }
+   itsTaskAdded.notify_one();
+}
+
+/// @brief wait until all submitted tasks are complete
+/// @details The first error reported by tasks (if any) is rethrown here
+void ThreadPool::wait()
+{
+   boost::unique_lock<boost::mutex> lock(itsMutex);
+   while (itsNPending > 0) {
+          itsTaskDone.wait(lock);
+   }
+   if (itsError != "") {
+       const std::string error = itsError;
+       itsError = "";
+       ASKAPTHROW(AskapError, "Task executed by the thread pool has failed: "<<error);
+   }
+}
+
+/// @brief main loop of each thread
+/// @param[in] core core to pin this thread to (negative value means no pinning)
+void ThreadPool::run(int core)
+{
+   if (core >= 0) {
+       pinToCore(core);
+   }
+   for (;;) {
+        Task task;
+        {
+           boost::unique_lock<boost::mutex> lock(itsMutex);
+           while (itsQueue.empty() && !itsStop) {
+                  itsTaskAdded.wait(lock);
+           }
+           if (itsQueue.empty()) {
+               // stop has been requested and there is nothing left to do
+               return;
+           }
+           task = itsQueue.front();
+           itsQueue.pop_front();
+        }
+        std::string error;
+        try {
+           task();
+        }
+        catch (const std::exception &ex) {
+           error = ex.what();
+        }
+        catch (...) {
+           error = "unknown exception";
+        }
+        {
+           boost::lock_guard<boost::mutex> lock(itsMutex);
+           if ((error != "") && (itsError == "")) {
+               itsError = error;
+           }
+           ASKAPDEBUGASSERT(itsNPending > 0);
+           --itsNPending;
+        }
+        itsTaskDone.notify_all();
+   }
+}
+
+/// @brief pin the calling thread to the given core
+/// @details Only supported on linux, a warning is given otherwise
+/// @param[in] core core number
+void ThreadPool::pinToCore(int core)
+{
+#ifdef __linux__
+   cpu_set_t cpuSet;
+   CPU_ZERO(&cpuSet);
+   CPU_SET(core, &cpuSet);
+   if (pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet) != 0) {
+       ASKAPLOG_WARN_STR(logger, "Unable to pin thread to core "<<core);
+   }
+#else
+   ASKAPLOG_WARN_STR(logger, "Pinning threads to cores is not supported on this platform, ignoring core "<<core);
+#endif
+}
+
+} // namespace synthesis
+
+} // namespace askap
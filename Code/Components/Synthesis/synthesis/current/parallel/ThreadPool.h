@@ -0,0 +1,145 @@
+/// @file
+///
+/// @brief Pool of threads owned by each rank of a parallel application
+/// @details Running fewer ranks with several threads each reduces the memory duplicated
+/// between ranks (models, gridders, caches) and the number of MPI messages on many-core
+/// nodes. This class provides a fixed set of threads (optionally pinned to cores)
+/// executing independent tasks submitted by the rank's main thread.
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author agent <agent@local>
+
+#ifndef ASKAP_SYNTHESIS_THREAD_POOL_H
+#define ASKAP_SYNTHESIS_THREAD_POOL_H
+
+// ASKAPsoft includes
+#include <Common/ParameterSet.h>
+
+// boost includes
+#include <boost/shared_ptr.hpp>
+#include <boost/function.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+// std includes
+#include <deque>
+#include <string>
+#include <vector>
+
+namespace askap {
+
+namespace synthesis {
+
+/// @brief Pool of threads executing independent tasks
+/// @details Tasks are executed in the order of submission by the first available thread.
+/// The main thread submits a batch of tasks and then waits for all of them with wait().
+/// Tasks should not do any MPI communication, as the MPI library is not initialised for
+/// multiple threads. An exception thrown by a task is caught in the pool thread and rethrown
+/// (as AskapError with the same message) by wait(), after all tasks of the batch are finished.
+/// @ingroup parallel
+class ThreadPool {
+public:
+   /// @brief shared pointer type
+   typedef boost::shared_ptr<ThreadPool> ShPtr;
+
+   /// @brief type of the task
+   typedef boost::function0<void> Task;
+
+   /// @brief start the threads
+   /// @param[in] nThreads number of threads (should be positive)
+   /// @param[in] cores cores to pin the threads to (cyclically), empty vector means no pinning
+   explicit ThreadPool(size_t nThreads, const std::vector<int> &cores = std::vector<int>());
+
+   /// @brief stop the threads
+   /// @details Tasks still in the queue are executed before the threads finish
+   ~ThreadPool();
+
+   /// @brief create the pool from the parset
+   /// @details The following parameters are recognised:
+   /// @li nthreads - number of threads per rank (default is 1, which means no pool)
+   /// @li threads.pin - if true, threads are pinned to cores (default is false)
+   /// @li threads.cores - cores to pin to, the default is nthreads consecutive cores
+   /// starting from rank * nthreads (modulo the number of cores on the node), which is
+   /// suitable for ranks packed on a node in order
+   /// @param[in] parset parset
+   /// @param[in] rank rank of this process (used for the default choice of cores)
+   /// @return shared pointer to the pool, or an empty pointer if only one thread is requested
+   static ShPtr create(const LOFAR::ParameterSet &parset, int rank);
+
+   /// @return number of threads in the pool
+   inline size_t nThreads() const { return itsThreads.size(); }
+
+   /// @brief add task to the queue
+   /// @param[in] task task to execute
+   void submit(const Task &task);
+
+   /// @brief wait until all submitted tasks are complete
+   /// @details The first error reported by tasks (if any) is rethrown here
+   void wait();
+
+private:
+   /// @brief main loop of each thread
+   /// @param[in] core core to pin this thread to (negative value means no pinning)
+   void run(int core);
+
+   /// @brief pin the calling thread to the given core
+   /// @details Only supported on linux, a warning is given otherwise
+   /// @param[in] core core number
+   static void pinToCore(int core);
+
+   /// @brief threads of the pool
+   boost::thread_group itsThreads;
+
+   /// @brief tasks waiting to be executed
+   std::deque<Task> itsQueue;
+
+   /// @brief number of tasks submitted, but not yet complete
+   size_t itsNPending;
+
+   /// @brief true if the threads should finish when the queue is empty
+   bool itsStop;
+
+   /// @brief error message of the first failed task (empty if there were no errors)
+   std::string itsError;
+
+   /// @brief mutex protecting the queue and the state
+   boost::mutex itsMutex;
+
+   /// @brief signalled when a new task is added or the pool is stopped
+   boost::condition_variable itsTaskAdded;
+
+   /// @brief signalled when a task is complete
+   boost::condition_variable itsTaskDone;
+
+   // no support for copy or assignment
+   ThreadPool(const ThreadPool&);
+   ThreadPool& operator=(const ThreadPool&);
+};
+
+} // namespace synthesis
+
+} // namespace askap
+
+#endif // #ifndef ASKAP_SYNTHESIS_THREAD_POOL_H
@@ -0,0 +1,238 @@
+/// @file
+///
+/// @brief Dynamic distribution of imaging work between workers
+/// @details The input data are split into work units (dataset, optionally a beam and
+/// a block of channels). The master hands out units to workers on request, so a worker
+/// which finishes early just pulls the next unit instead of waiting for the slowest one.
+/// The number of ranks is decoupled from the number of datasets this way.
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author agent <agent@local>
+
+// Include package level header file
+#include <askap_synthesis.h>
+
+#include <parallel/WorkUnitScheduler.h>
+
+// ASKAPsoft includes
+#include <askap/AskapError.h>
+#include <askap/AskapLogging.h>
+#include <askap/AskapUtil.h>
+
+// std includes
+#include <sstream>
+#include <map>
+#include <algorithm>
+
+ASKAP_LOGGER(logger, ".parallel");
+
+// tag used for replies of the master to work requests, should differ from the tags
+// used for data and notifications
+#define WORKUNIT_SCHEDULER_MSG_TAG 3
+
+namespace askap {
+
+namespace synthesis {
+
+/// @brief construct a unit covering the whole dataset
+/// @param[in] dataset name of the dataset
+ImagingWorkUnit::ImagingWorkUnit(const std::string &dataset) : itsDataset(dataset), itsBeam(-1),
+          itsStartChan(0), itsNChan(0) {}
+
+/// @brief apply selection of this unit
+/// @param[in] sel selector to update
+void ImagingWorkUnit::select(accessors::IDataSelector &sel) const
+{
+   if (itsBeam >= 0) {
+       sel.chooseFeed(static_cast<casa::uInt>(itsBeam));
+   }
+   if (itsNChan > 0) {
+       sel.chooseChannels(itsNChan, itsStartChan);
+   }
+}
+
+/// @brief short description of the unit
+/// @details Used in the log and as a key for caches associated with the unit
+/// @return a string with the dataset name and the selection
+std::string ImagingWorkUnit::name() const
+{
+   std::ostringstream os;
+   os<<itsDataset;
+   if (itsBeam >= 0) {
+       os<<" beam "<<itsBeam;
+   }
+   if (itsNChan > 0) {
+       os<<" channels "<<itsStartChan<<"-"<<itsStartChan + itsNChan - 1;
+   }
+   return os.str();
+}
+
+/// @brief construct the list of units from the parset
+/// @param[in] parset parset (imager subset)
+WorkUnitScheduler::WorkUnitScheduler(const LOFAR::ParameterSet &parset)
+{
+   const std::vector<std::string> datasets = parset.getStringVector("dataset");
+   ASKAPCHECK(datasets.size() > 0, "Need dataset specification");
+   const std::vector<int> beams = parset.getInt32Vector("scheduling.beams", std::vector<int>());
+   const std::vector<LOFAR::uint32> chanBlocks = parset.getUint32Vector("scheduling.chanblocks",
+                                                   std::vector<LOFAR::uint32>());
+   ASKAPCHECK((chanBlocks.size() == 0) || (chanBlocks.size() == 2),
+              "scheduling.chanblocks is expected to have two elements: number of channels per block and number of blocks");
+   ASKAPCHECK((chanBlocks.size() == 0) || ((chanBlocks[0] > 0) && (chanBlocks[1] > 0)),
+              "scheduling.chanblocks should have positive elements, you have "<<chanBlocks);
+   ASKAPCHECK((chanBlocks.size() == 0) || !parset.isDefined("Channels"),
+              "Channels selection can't be combined with scheduling.chanblocks");
+   ASKAPCHECK((beams.size() == 0) || !parset.isDefined("Feed"),
+              "Feed selection can't be combined with scheduling.beams");
+   const int nBeamUnits = beams.size() > 0 ? int(beams.size()) : 1;
+   const casa::uInt nChanUnits = chanBlocks.size() > 0 ? chanBlocks[1] : 1;
+
+   for (std::vector<std::string>::const_iterator ci = datasets.begin(); ci != datasets.end(); ++ci) {
+        for (int beam = 0; beam < nBeamUnits; ++beam) {
+             for (casa::uInt block = 0; block < nChanUnits; ++block) {
+                  ImagingWorkUnit unit(*ci);
+                  if (beams.size() > 0) {
+                      ASKAPCHECK(beams[beam] >= 0, "Beam indices are expected to be non-negative, you have "<<beams);
+                      unit.itsBeam = beams[beam];
+                  }
+                  if (chanBlocks.size() > 0) {
+                      unit.itsNChan = chanBlocks[0];
+                      unit.itsStartChan = block * chanBlocks[0];
+                  }
+                  itsUnits.push_back(unit);
+             }
+        }
+   }
+   itsLastWorker.resize(itsUnits.size(), -1);
+   itsGivenOut.resize(itsUnits.size(), false);
+   ASKAPLOG_INFO_STR(logger, "Data are split into "<<itsUnits.size()<<" work unit(s) for dynamic scheduling");
+}
+
+/// @brief obtain the work unit
+/// @param[in] index unit index (0..nUnits()-1)
+/// @return const reference to the work unit
+const ImagingWorkUnit& WorkUnitScheduler::unit(const int index) const
+{
+   ASKAPCHECK((index >= 0) && (index < int(itsUnits.size())), "Work unit index "<<index<<" is out of range");
+   return itsUnits[index];
+}
+
+/// @brief mark all units as not yet done
+/// @details Called at the start of each major cycle in the master. Affinity information
+/// is preserved.
+void WorkUnitScheduler::startCycle()
+{
+   std::fill(itsGivenOut.begin(), itsGivenOut.end(), false);
+}
+
+/// @brief choose the next unit for the worker
+/// @details The choice is made in the following order: a unit processed by this worker
+/// before, a unit never processed by anybody, a unit of the worker which has the largest
+/// number of units still waiting (stealing).
+/// @param[in] worker rank of the worker requesting work
+/// @return unit index or -1 if all units of the current cycle have been given out
+int WorkUnitScheduler::nextUnit(const int worker)
+{
+   int result = -1;
+   int unowned = -1;
+   // number of units waiting for each of the other workers
+   std::map<int, int> waiting;
+   for (size_t index = 0; index < itsUnits.size(); ++index) {
+        if (itsGivenOut[index]) {
+            continue;
+        }
+        if (itsLastWorker[index] == worker) {
+            result = int(index);
+            break;
+        }
+        if (itsLastWorker[index] < 0) {
+            if (unowned < 0) {
+                unowned = int(index);
+            }
+        } else {
+            ++waiting[itsLastWorker[index]];
+        }
+   }
+   if (result < 0) {
+       result = unowned;
+   }
+   if ((result < 0) && (waiting.size() > 0)) {
+       // steal from the busiest worker, take its last unit as it would be processed last anyway
+       int victim = waiting.begin()->first;
+       for (std::map<int, int>::const_iterator ci = waiting.begin(); ci != waiting.end(); ++ci) {
+            if (ci->second > waiting[victim]) {
+                victim = ci->first;
+            }
+       }
+       for (size_t index = itsUnits.size(); index > 0; --index) {
+            if (!itsGivenOut[index - 1] && (itsLastWorker[index - 1] == victim)) {
+                result = int(index - 1);
+                break;
+            }
+       }
+       ASKAPDEBUGASSERT(result >= 0);
+       ASKAPLOG_DEBUG_STR(logger, "Work unit "<<itsUnits[result].name()<<" moves from rank "<<victim<<
+                          " to rank "<<worker);
+   }
+   if (result >= 0) {
+       itsGivenOut[result] = true;
+       itsLastWorker[result] = worker;
+   }
+   return result;
+}
+
+/// @brief serve work requests of all workers for one major cycle (master)
+/// @details This method returns when every worker has been told that there is no more work.
+/// @param[in] comms communication object
+void WorkUnitScheduler::serve(askapparallel::AskapParallel &comms)
+{
+   ASKAPCHECK(comms.isMaster() && comms.isParallel(), "Work units are only served by the master in the parallel mode");
+   startCycle();
+   const int nWorkers = comms.nProcs() - 1;
+   for (int finished = 0; finished < nWorkers;) {
+        const int worker = comms.waitForNotification().first;
+        const int index = nextUnit(worker);
+        if (index < 0) {
+            ++finished;
+        } else {
+            ASKAPLOG_DEBUG_STR(logger, "Work unit "<<itsUnits[index].name()<<" is given to rank "<<worker);
+        }
+        comms.send(&index, sizeof(int), worker, WORKUNIT_SCHEDULER_MSG_TAG, 0);
+   }
+}
+
+/// @brief request the next unit from the master (worker)
+/// @param[in] comms communication object
+/// @return unit index or -1 if there is no more work in this major cycle
+int WorkUnitScheduler::requestUnit(askapparallel::AskapParallel &comms)
+{
+   comms.notifyMaster();
+   int index = -1;
+   comms.receive(&index, sizeof(int), 0, WORKUNIT_SCHEDULER_MSG_TAG, 0);
+   return index;
+}
+
+} // namespace synthesis
+
+} // namespace askap
@@ -0,0 +1,150 @@
+/// @file
+///
+/// @brief Dynamic distribution of imaging work between workers
+/// @details The input data are split into work units (dataset, optionally a beam and
+/// a block of channels). The master hands out units to workers on request, so a worker
+/// which finishes early just pulls the next unit instead of waiting for the slowest one.
+/// The number of ranks is decoupled from the number of datasets this way.
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author agent <agent@local>
+
+#ifndef ASKAP_SYNTHESIS_WORK_UNIT_SCHEDULER_H
+#define ASKAP_SYNTHESIS_WORK_UNIT_SCHEDULER_H
+
+// ASKAPsoft includes
+#include <askapparallel/AskapParallel.h>
+#include <Common/ParameterSet.h>
+#include <dataaccess/IDataSelector.h>
+
+// casa includes
+#include <casa/aips.h>
+
+// std includes
+#include <string>
+#include <vector>
+
+namespace askap {
+
+namespace synthesis {
+
+/// @brief description of a piece of imaging work
+/// @details A work unit is a dataset with an optional beam and channel selection
+/// applied on top of the selection given in the parset.
+/// @ingroup parallel
+struct ImagingWorkUnit {
+   /// @brief construct a unit covering the whole dataset
+   /// @param[in] dataset name of the dataset
+   explicit ImagingWorkUnit(const std::string &dataset = std::string());
+
+   /// @brief apply selection of this unit
+   /// @param[in] sel selector to update
+   void select(accessors::IDataSelector &sel) const;
+
+   /// @brief short description of the unit
+   /// @details Used in the log and as a key for caches associated with the unit
+   /// @return a string with the dataset name and the selection
+   std::string name() const;
+
+   /// @brief name of the dataset
+   std::string itsDataset;
+
+   /// @brief beam (feed) to select, negative value means all beams
+   int itsBeam;
+
+   /// @brief first channel of the block
+   casa::uInt itsStartChan;
+
+   /// @brief number of channels in the block, zero means all channels
+   casa::uInt itsNChan;
+};
+
+/// @brief dynamic distribution of work units between workers
+/// @details All ranks construct the same list of units from the parset, so only
+/// the unit index is sent around. The following parameters are recognised:
+/// @li dataset - the list of datasets (one or more, no substitution of %w is done)
+/// @li scheduling.beams - optional list of beams, each dataset is split by beam
+/// @li scheduling.chanblocks - optional [nChan, nBlocks], each dataset is split into
+/// nBlocks blocks of nChan channels each
+///
+/// Workers request units via AskapParallel::notifyMaster and the master replies with the
+/// unit index (or -1 when there is no more work in this major cycle). The master remembers
+/// which worker processed which unit and prefers to give the same units to the same worker
+/// in the following major cycles, so any per-unit state cached by the worker remains useful.
+/// Units of other workers are only given away when there is nothing else left to do.
+/// @ingroup parallel
+class WorkUnitScheduler {
+public:
+   /// @brief construct the list of units from the parset
+   /// @param[in] parset parset (imager subset)
+   explicit WorkUnitScheduler(const LOFAR::ParameterSet &parset);
+
+   /// @brief number of work units
+   /// @return total number of work units per major cycle
+   inline size_t nUnits() const { return itsUnits.size(); }
+
+   /// @brief obtain the work unit
+   /// @param[in] index unit index (0..nUnits()-1)
+   /// @return const reference to the work unit
+   const ImagingWorkUnit& unit(const int index) const;
+
+   /// @brief mark all units as not yet done
+   /// @details Called at the start of each major cycle in the master. Affinity information
+   /// is preserved.
+   void startCycle();
+
+   /// @brief choose the next unit for the worker
+   /// @details The choice is made in the following order: a unit processed by this worker
+   /// before, a unit never processed by anybody, a unit of the worker which has the largest
+   /// number of units still waiting (stealing).
+   /// @param[in] worker rank of the worker requesting work
+   /// @return unit index or -1 if all units of the current cycle have been given out
+   int nextUnit(const int worker);
+
+   /// @brief serve work requests of all workers for one major cycle (master)
+   /// @details This method returns when every worker has been told that there is no more work.
+   /// @param[in] comms communication object
+   void serve(askapparallel::AskapParallel &comms);
+
+   /// @brief request the next unit from the master (worker)
+   /// @param[in] comms communication object
+   /// @return unit index or -1 if there is no more work in this major cycle
+   static int requestUnit(askapparallel::AskapParallel &comms);
+
+private:
+   /// @brief all work units
+   std::vector<ImagingWorkUnit> itsUnits;
+
+   /// @brief rank of the worker which processed the unit last time, -1 if none
+   std::vector<int> itsLastWorker;
+
+   /// @brief true for units already given out in the current cycle
+   std::vector<bool> itsGivenOut;
+};
+
+} // namespace synthesis
+
+} // namespace askap
+
+#endif // #ifndef ASKAP_SYNTHESIS_WORK_UNIT_SCHEDULER_H
@@ -31,8 +31,17 @@
 #include <cppunit/extensions/HelperMacros.h>
 
 #include <casa/BasicSL/Complex.h>
+#include <casa/Arrays/ArrayMath.h>
 
 #include <boost/shared_ptr.hpp>
+#include <boost/bind.hpp>
+#include <boost/ref.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/barrier.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/locks.hpp>
+#include <algorithm>
+#include <vector>
 
 using namespace casa;
 
@@ -40,6 +49,61 @@ namespace askap {
 
 namespace synthesis {
 
+/// @brief buffers shared by the threads emulating ranks in the patch sharing test
+struct PatchExchange {
+  explicit PatchExchange(int nProcs) : itsBarrier(nProcs) {}
+  boost::barrier itsBarrier;
+  boost::mutex itsMutex;
+  std::vector<char> itsBuffer;
+  std::vector<double> itsSum;
+};
+
+/// @brief communicator between threads emulating ranks
+struct ThreadPatchComms : public IPatchComms {
+  ThreadPatchComms(PatchExchange &exchange, int rank, int nProcs) :
+        itsExchange(exchange), itsRank(rank), itsNProcs(nProcs) {}
+
+  virtual int rank() const { return itsRank; }
+
+  virtual int nProcs() const { return itsNProcs; }
+
+  virtual void broadcast(void* buf, size_t size) {
+    char* bytes = static_cast<char*>(buf);
+    if (itsRank == 0) {
+        itsExchange.itsBuffer.assign(bytes, bytes + size);
+    }
+    itsExchange.itsBarrier.wait();
+    if (itsRank != 0) {
+        ASKAPASSERT(itsExchange.itsBuffer.size() == size);
+        std::copy(itsExchange.itsBuffer.begin(), itsExchange.itsBuffer.end(), bytes);
+    }
+    itsExchange.itsBarrier.wait();
+  }
+
+  virtual void sumToMaster(double* buf, size_t n) {
+    if (itsRank == 0) {
+        itsExchange.itsSum.assign(buf, buf + n);
+    }
+    itsExchange.itsBarrier.wait();
+    if (itsRank != 0) {
+        boost::lock_guard<boost::mutex> lock(itsExchange.itsMutex);
+        ASKAPASSERT(itsExchange.itsSum.size() == n);
+        for (size_t i = 0; i < n; ++i) {
+             itsExchange.itsSum[i] += buf[i];
+        }
+    }
+    itsExchange.itsBarrier.wait();
+    if (itsRank == 0) {
+        std::copy(itsExchange.itsSum.begin(), itsExchange.itsSum.end(), buf);
+    }
+  }
+
+private:
+  PatchExchange &itsExchange;
+  int itsRank;
+  int itsNProcs;
+};
+
 class DeconvolverHogbomTest : public CppUnit::TestFixture
 {
   CPPUNIT_TEST_SUITE(DeconvolverHogbomTest);
@@ -48,6 +112,8 @@ class DeconvolverHogbomTest : public CppUnit::TestFixture
   CPPUNIT_TEST(testDeconvolveCenter);
   CPPUNIT_TEST(testDeconvolveCorner);
   CPPUNIT_TEST(testDeconvolveZero);
+  CPPUNIT_TEST(testDeconvolvePatches);
+  CPPUNIT_TEST(testDeconvolveSharedPatches);
   CPPUNIT_TEST_EXCEPTION(testWrongShape, casa::ArrayShapeError);
   CPPUNIT_TEST_EXCEPTION(testDeconvolveOffsetPSF, AskapError);
   CPPUNIT_TEST_SUITE_END();
@@ -121,7 +187,120 @@ public:
     CPPUNIT_ASSERT(itsDB->deconvolve());
     CPPUNIT_ASSERT(itsDB->control()->terminationCause()==DeconvolverControl<Float>::CONVERGED);
   }
-   
+  void testDeconvolvePatches() {
+    // Gaussian PSF and a few point sources, one of them at the patch boundary
+    const IPosition dimensions(2,100,100);
+    Array<Float> psf(dimensions);
+    Array<Float> dirty(dimensions);
+    dirty.set(0.0);
+    const Int xPos[4] = {30, 49, 75, 20};
+    const Int yPos[4] = {20, 50, 80, 70};
+    const Float flux[4] = {1.0, 0.7, -0.5, 0.4};
+    for (Int y = 0; y < dimensions(1); ++y) {
+         for (Int x = 0; x < dimensions(0); ++x) {
+              const IPosition pos(2, x, y);
+              psf(pos) = exp(-Float((x - 50) * (x - 50) + (y - 50) * (y - 50)) / 8.);
+              for (uInt src = 0; src < 4; ++src) {
+                   dirty(pos) += flux[src] * exp(-Float((x - xPos[src]) * (x - xPos[src]) +
+                                 (y - yPos[src]) * (y - yPos[src])) / 8.);
+              }
+         }
+    }
+    // serial and patch-based deconvolution with the same settings
+    std::vector<boost::shared_ptr<DeconvolverHogbom<Float, Complex> > > deconvolvers(2);
+    for (uInt mode = 0; mode < deconvolvers.size(); ++mode) {
+         Array<Float> dirtyCopy(dirty.copy());
+         Array<Float> psfCopy(psf.copy());
+         deconvolvers[mode].reset(new DeconvolverHogbom<Float, Complex>(dirtyCopy, psfCopy));
+         deconvolvers[mode]->setWeight(*itsWeight);
+         deconvolvers[mode]->state()->setCurrentIter(0);
+         deconvolvers[mode]->control()->setTargetIter(2000);
+         deconvolvers[mode]->control()->setGain(0.1);
+         deconvolvers[mode]->control()->setTargetObjectiveFunction(0.001);
+         deconvolvers[mode]->control()->setPSFWidth(20);
+         if (mode == 1) {
+             deconvolvers[mode]->setPatches(2, 2, 0.5);
+         }
+         CPPUNIT_ASSERT(deconvolvers[mode]->deconvolve());
+         CPPUNIT_ASSERT(deconvolvers[mode]->control()->terminationCause()==DeconvolverControl<Float>::CONVERGED);
+    }
+    // both should reach the threshold and recover the same sources
+    const Array<Float> residualDiff = deconvolvers[0]->dirty() - deconvolvers[1]->dirty();
+    CPPUNIT_ASSERT(max(abs(residualDiff)) < 0.002);
+    for (uInt src = 0; src < 4; ++src) {
+         const IPosition pos(2, xPos[src], yPos[src]);
+         CPPUNIT_ASSERT_DOUBLES_EQUAL(deconvolvers[0]->model()(pos), deconvolvers[1]->model()(pos), 0.01);
+    }
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(sum(deconvolvers[0]->model()), sum(deconvolvers[1]->model()), 0.01);
+  }
+  void testDeconvolveSharedPatches() {
+    // the same patches cleaned by the master alone and shared with two other ranks
+    const IPosition dimensions(2,64,64);
+    Array<Float> psf(dimensions);
+    Array<Float> dirty(dimensions);
+    for (Int y = 0; y < dimensions(1); ++y) {
+         for (Int x = 0; x < dimensions(0); ++x) {
+              const IPosition pos(2, x, y);
+              psf(pos) = exp(-Float((x - 32) * (x - 32) + (y - 32) * (y - 32)) / 8.);
+              dirty(pos) = exp(-Float((x - 20) * (x - 20) + (y - 12) * (y - 12)) / 8.) -
+                           0.6 * exp(-Float((x - 33) * (x - 33) + (y - 40) * (y - 40)) / 8.);
+         }
+    }
+    Array<Float> weight(dimensions, 1.0f);
+    std::vector<boost::shared_ptr<DeconvolverHogbom<Float, Complex> > > deconvolvers(2);
+    for (uInt mode = 0; mode < deconvolvers.size(); ++mode) {
+         Array<Float> dirtyCopy(dirty.copy());
+         Array<Float> psfCopy(psf.copy());
+         deconvolvers[mode].reset(new DeconvolverHogbom<Float, Complex>(dirtyCopy, psfCopy));
+         deconvolvers[mode]->setWeight(weight);
+         deconvolvers[mode]->state()->setCurrentIter(0);
+         deconvolvers[mode]->control()->setTargetIter(2000);
+         deconvolvers[mode]->control()->setGain(0.1);
+         deconvolvers[mode]->control()->setTargetObjectiveFunction(0.001);
+         deconvolvers[mode]->control()->setPSFWidth(16);
+         deconvolvers[mode]->setPatches(3, 2, 0.5);
+    }
+    CPPUNIT_ASSERT(deconvolvers[0]->deconvolve());
+
+    const int nProcs = 3;
+    PatchExchange exchange(nProcs);
+    std::vector<boost::shared_ptr<ThreadPatchComms> > comms(nProcs);
+    for (int rank = 0; rank < nProcs; ++rank) {
+         comms[rank].reset(new ThreadPatchComms(exchange, rank, nProcs));
+    }
+    std::vector<int> nPlanes(nProcs, 0);
+    boost::thread_group workers;
+    for (int rank = 1; rank < nProcs; ++rank) {
+         workers.create_thread(boost::bind(&DeconvolverHogbomTest::servePatches,
+                               boost::ref(*comms[rank]), boost::ref(nPlanes[rank])));
+    }
+    deconvolvers[1]->setPatchComms(comms[0]);
+    CPPUNIT_ASSERT(deconvolvers[1]->deconvolve());
+    DeconvolverHogbom<Float, Complex>::stopPatchServers(*comms[0]);
+    workers.join_all();
+
+    for (int rank = 1; rank < nProcs; ++rank) {
+         CPPUNIT_ASSERT_EQUAL(1, nPlanes[rank]);
+    }
+    // sharing patches should give exactly the same result
+    CPPUNIT_ASSERT_EQUAL(deconvolvers[0]->state()->currentIter(), deconvolvers[1]->state()->currentIter());
+    CPPUNIT_ASSERT(allEQ(deconvolvers[0]->dirty(), deconvolvers[1]->dirty()));
+    CPPUNIT_ASSERT(allEQ(deconvolvers[0]->model(), deconvolvers[1]->model()));
+  }
+
+  /// @brief loop of a rank serving patches
+  /// @param[in] comms communicator of this rank
+  /// @param[out] nPlanes number of planes served (-1 if an exception is thrown)
+  static void servePatches(ThreadPatchComms &comms, int &nPlanes) {
+    try {
+      while (DeconvolverHogbom<Float, Complex>::servePatches(comms)) {
+         ++nPlanes;
+      }
+    } catch (const AskapError &) {
+      nPlanes = -1;
+    }
+  }
+
 private:
 
   boost::shared_ptr< Array<Float> > itsDirty;
@@ -0,0 +1,190 @@
+/// @file
+///
+/// Unit test for the contiguous storage of convolution functions
+///
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author agent <agent@local>
+
+#include <gridding/ConvFuncStore.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <casa/Arrays/Matrix.h>
+#include <casa/BasicSL/Complex.h>
+
+namespace askap {
+
+namespace synthesis {
+
+class ConvFuncStoreTest : public CppUnit::TestFixture
+{
+   CPPUNIT_TEST_SUITE(ConvFuncStoreTest);
+   CPPUNIT_TEST(testAllocate);
+   CPPUNIT_TEST(testLayout);
+   CPPUNIT_TEST(testCopyOnWrite);
+   CPPUNIT_TEST(testReleaseAndCompact);
+   CPPUNIT_TEST(testOffsets);
+   CPPUNIT_TEST_SUITE_END();
+public:
+
+   void setUp() {
+       itsStore.init(4, 2);
+   }
+
+   /// @brief fill all CFs of the plane with unique values
+   void fillPlane(ConvFuncStore &store, const casa::uInt plane) {
+       const int nOS = store.overSample() * store.overSample();
+       for (int os = 0; os < nOS; ++os) {
+            casa::Matrix<casa::Complex> cf = store.matrix(plane * nOS + os);
+            for (casa::uInt x = 0; x < cf.nrow(); ++x) {
+                 for (casa::uInt y = 0; y < cf.ncolumn(); ++y) {
+                      cf(x, y) = casa::Complex(float(plane), float(os * 1000 + x * 10 + y));
+                 }
+            }
+       }
+   }
+
+   /// @brief check that all CFs of the plane have the values set by fillPlane
+   void checkPlane(const ConvFuncStore &store, const casa::uInt plane) {
+       const int nOS = store.overSample() * store.overSample();
+       const int cSize = 2 * store.support(plane) + 1;
+       for (int os = 0; os < nOS; ++os) {
+            const casa::Complex *cf = store.data(plane, os);
+            for (int y = 0; y < cSize; ++y) {
+                 for (int x = 0; x < cSize; ++x) {
+                      CPPUNIT_ASSERT_DOUBLES_EQUAL(double(plane), double(casa::real(cf[x + cSize * y])), 1e-6);
+                      CPPUNIT_ASSERT_DOUBLES_EQUAL(double(os * 1000 + x * 10 + y), double(casa::imag(cf[x + cSize * y])), 1e-6);
+                 }
+            }
+       }
+   }
+
+   void testAllocate() {
+       CPPUNIT_ASSERT_EQUAL(4u, itsStore.nPlanes());
+       CPPUNIT_ASSERT_EQUAL(size_t(16), itsStore.size());
+       CPPUNIT_ASSERT_EQUAL(0, itsStore.maxSupport());
+       CPPUNIT_ASSERT_EQUAL(size_t(0), itsStore.memoryUsed());
+       for (casa::uInt plane = 0; plane < itsStore.nPlanes(); ++plane) {
+            CPPUNIT_ASSERT(!itsStore.isDefined(plane));
+            CPPUNIT_ASSERT(itsStore.copyOf(plane * 4).nelements() == 0);
+       }
+       itsStore.allocate(2, 3);
+       CPPUNIT_ASSERT(itsStore.isDefined(2));
+       CPPUNIT_ASSERT(!itsStore.isDefined(1));
+       CPPUNIT_ASSERT_EQUAL(3, itsStore.support(2));
+       CPPUNIT_ASSERT_EQUAL(3, itsStore.maxSupport());
+       // 7x7 CF padded to 56 elements for the alignment, 4 oversampling planes
+       CPPUNIT_ASSERT_EQUAL(size_t(4 * 56 * sizeof(casa::Complex)), itsStore.memoryUsed());
+       const casa::Matrix<casa::Complex> cf = itsStore.copyOf(9);
+       CPPUNIT_ASSERT_EQUAL(7u, cf.nrow());
+       CPPUNIT_ASSERT_EQUAL(7u, cf.ncolumn());
+       for (casa::uInt x = 0; x < cf.nrow(); ++x) {
+            for (casa::uInt y = 0; y < cf.ncolumn(); ++y) {
+                 CPPUNIT_ASSERT_DOUBLES_EQUAL(0., double(casa::abs(cf(x, y))), 1e-10);
+            }
+       }
+   }
+
+   void testLayout() {
+       itsStore.allocate(0, 1);
+       itsStore.allocate(3, 2);
+       itsStore.allocate(1, 5);
+       for (casa::uInt plane = 0; plane < itsStore.nPlanes(); ++plane) {
+            if (itsStore.isDefined(plane)) {
+                fillPlane(itsStore, plane);
+            }
+       }
+       // growth of the buffer must preserve the content
+       itsStore.allocate(2, 4);
+       fillPlane(itsStore, 2);
+       for (casa::uInt plane = 0; plane < itsStore.nPlanes(); ++plane) {
+            checkPlane(itsStore, plane);
+            for (int os = 0; os < 4; ++os) {
+                 // every CF is aligned
+                 CPPUNIT_ASSERT_EQUAL(size_t(0), size_t(itsStore.data(plane, os)) % 64);
+                 // flat index and the raw pointer refer to the same CF
+                 const casa::Matrix<casa::Complex> cf = itsStore.copyOf(plane * 4 + os);
+                 CPPUNIT_ASSERT(cf(0, 0) == *itsStore.data(plane, os));
+            }
+       }
+   }
+
+   void testCopyOnWrite() {
+       itsStore.allocate(0, 2);
+       itsStore.allocate(1, 2);
+       fillPlane(itsStore, 0);
+       fillPlane(itsStore, 1);
+       ConvFuncStore copy(itsStore);
+       // the buffer is shared until modified
+       CPPUNIT_ASSERT(copy.data(0, 0) == itsStore.data(0, 0));
+       copy.matrix(0)(1, 1) = casa::Complex(-1., -1.);
+       CPPUNIT_ASSERT(copy.data(0, 0) != itsStore.data(0, 0));
+       checkPlane(itsStore, 0);
+       checkPlane(itsStore, 1);
+       checkPlane(copy, 1);
+       CPPUNIT_ASSERT(copy.copyOf(0)(1, 1) == casa::Complex(-1., -1.));
+   }
+
+   void testReleaseAndCompact() {
+       itsStore.allocate(0, 2);
+       itsStore.allocate(1, 3);
+       itsStore.allocate(2, 2);
+       for (casa::uInt plane = 0; plane < 3; ++plane) {
+            fillPlane(itsStore, plane);
+       }
+       const size_t memUsed = itsStore.memoryUsed();
+       CPPUNIT_ASSERT_EQUAL(itsStore.memoryUsed(0) + itsStore.memoryUsed(1) + itsStore.memoryUsed(2), memUsed);
+       itsStore.release(1);
+       CPPUNIT_ASSERT(!itsStore.isDefined(1));
+       CPPUNIT_ASSERT_EQUAL(size_t(0), itsStore.memoryUsed(1));
+       CPPUNIT_ASSERT_EQUAL(2, itsStore.maxSupport());
+       itsStore.compact();
+       checkPlane(itsStore, 0);
+       checkPlane(itsStore, 2);
+       // reallocation with the same support reuses the block and zeroes it
+       const casa::Complex *ptr = itsStore.data(2, 0);
+       itsStore.allocate(2, 2);
+       CPPUNIT_ASSERT(ptr == itsStore.data(2, 0));
+       CPPUNIT_ASSERT_DOUBLES_EQUAL(0., double(casa::abs(*ptr)), 1e-10);
+       checkPlane(itsStore, 0);
+   }
+
+   void testOffsets() {
+       CPPUNIT_ASSERT_EQUAL(size_t(0), itsStore.nOffsets());
+       CPPUNIT_ASSERT(itsStore.offset(1) == std::make_pair(0, 0));
+       itsStore.initOffsets(4);
+       itsStore.setOffset(1, 2, -3);
+       CPPUNIT_ASSERT(itsStore.offset(1) == std::make_pair(2, -3));
+       CPPUNIT_ASSERT(itsStore.offset(0) == std::make_pair(0, 0));
+       itsStore.init(4, 2);
+       CPPUNIT_ASSERT(itsStore.offset(1) == std::make_pair(0, 0));
+   }
+
+private:
+   ConvFuncStore itsStore;
+};
+
+} // namespace synthesis
+
+} // namespace askap
@@ -0,0 +1,148 @@
+/// @file
+///
+/// Unit test for the gridding kernels
+///
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author agent <agent@local>
+
+#include <gridding/GridKernel.h>
+#include <askap/AskapError.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <casa/Arrays/Matrix.h>
+#include <casa/BasicSL/Complex.h>
+
+#include <vector>
+#include <string>
+#include <cstdlib>
+
+namespace askap {
+
+namespace synthesis {
+
+class GridKernelTest : public CppUnit::TestFixture
+{
+   CPPUNIT_TEST_SUITE(GridKernelTest);
+   CPPUNIT_TEST(testAvailableKernels);
+   CPPUNIT_TEST(testKernelEquivalence);
+   CPPUNIT_TEST(testRawReferenceKernel);
+   CPPUNIT_TEST_EXCEPTION(testUnknownKernel, AskapError);
+   CPPUNIT_TEST_SUITE_END();
+public:
+
+   void testAvailableKernels() {
+       const std::vector<std::string> kernels = GridKernel::availableKernels();
+       CPPUNIT_ASSERT(kernels.size() >= 2);
+       CPPUNIT_ASSERT_EQUAL(std::string("reference"), kernels[0]);
+       CPPUNIT_ASSERT_EQUAL(std::string("generic"), kernels[1]);
+       const GridKernel autoKernel;
+       CPPUNIT_ASSERT_EQUAL(kernels.back(), autoKernel.name());
+       // instances are independent of each other
+       const GridKernel generic("generic");
+       CPPUNIT_ASSERT_EQUAL(std::string("generic"), generic.name());
+       CPPUNIT_ASSERT_EQUAL(kernels.back(), autoKernel.name());
+   }
+
+   void testKernelEquivalence() {
+       const std::vector<std::string> kernels = GridKernel::availableKernels();
+       // a mix of specialised and generic supports, including odd ones
+       // which require special treatment of the remainder in vector kernels
+       const int supports[] = {1, 2, 3, 5, 6, 7, 9, 12, 13};
+       for (size_t s = 0; s < sizeof(supports) / sizeof(int); ++s) {
+            const int support = supports[s];
+            casa::Matrix<casa::Complex> convFunc(2 * support + 1, 2 * support + 1);
+            fillRandom(convFunc);
+            casa::Matrix<casa::Complex> refGrid(64, 64);
+            fillRandom(refGrid);
+            const casa::Matrix<casa::Complex> startGrid = refGrid.copy();
+            const casa::Complex vis(0.3, -0.7);
+            const GridKernel refKernel("reference");
+            refKernel.grid(refGrid, convFunc, vis, 30, 33, support);
+            casa::Complex refVis;
+            refKernel.degrid(refVis, convFunc, refGrid, 30, 33, support);
+            for (size_t k = 1; k < kernels.size(); ++k) {
+                 const GridKernel kernel(kernels[k]);
+                 casa::Matrix<casa::Complex> grid = startGrid.copy();
+                 kernel.grid(grid, convFunc, vis, 30, 33, support);
+                 for (casa::uInt x = 0; x < grid.nrow(); ++x) {
+                      for (casa::uInt y = 0; y < grid.ncolumn(); ++y) {
+                           CPPUNIT_ASSERT_DOUBLES_EQUAL(0., casa::abs(grid(x, y) - refGrid(x, y)), 1e-5);
+                      }
+                 }
+                 casa::Complex cVis;
+                 kernel.degrid(cVis, convFunc, grid, 30, 33, support);
+                 CPPUNIT_ASSERT_DOUBLES_EQUAL(0., casa::abs(cVis - refVis) / casa::abs(refVis), 1e-5);
+            }
+       }
+   }
+
+   void testRawReferenceKernel() {
+       // the raw pointer interface honours the reference kernel as well
+       const int support = 3;
+       casa::Matrix<casa::Complex> convFunc(2 * support + 1, 2 * support + 1);
+       fillRandom(convFunc);
+       casa::Matrix<casa::Complex> grid(32, 32, casa::Complex(0., 0.));
+       const GridKernel kernel("reference");
+       CPPUNIT_ASSERT_EQUAL(std::string("reference"), kernel.name());
+       const casa::Complex vis(1., 0.);
+       kernel.grid(&grid(10 - support, 12 - support), int(grid.nrow()), convFunc.data(),
+                   int(convFunc.nrow()), vis, support);
+       for (casa::uInt x = 0; x < grid.nrow(); ++x) {
+            for (casa::uInt y = 0; y < grid.ncolumn(); ++y) {
+                 const int u = int(x) - 10 + support;
+                 const int v = int(y) - 12 + support;
+                 const casa::Complex expected = (u >= 0) && (u < 2 * support) && (v >= 0) && (v < 2 * support) ?
+                       convFunc(u, v) : casa::Complex(0., 0.);
+                 CPPUNIT_ASSERT_DOUBLES_EQUAL(0., casa::abs(grid(x, y) - expected), 1e-7);
+            }
+       }
+       casa::Complex matrixVis;
+       kernel.degrid(matrixVis, convFunc, grid, 10, 12, support);
+       const casa::Complex rawVis = kernel.degrid(&grid(10 - support, 12 - support), int(grid.nrow()),
+                   convFunc.data(), int(convFunc.nrow()), support);
+       CPPUNIT_ASSERT_DOUBLES_EQUAL(0., casa::abs(matrixVis - rawVis), 1e-7);
+   }
+
+   void testUnknownKernel() {
+       const GridKernel kernel("nonexistent");
+   }
+
+protected:
+   /// @brief fill matrix with random numbers in [-0.5,0.5] range
+   /// @param[in] mtr matrix to fill
+   static void fillRandom(casa::Matrix<casa::Complex> &mtr) {
+       for (casa::uInt x = 0; x < mtr.nrow(); ++x) {
+            for (casa::uInt y = 0; y < mtr.ncolumn(); ++y) {
+                 mtr(x, y) = casa::Complex(float(rand()) / float(RAND_MAX) - 0.5,
+                                           float(rand()) / float(RAND_MAX) - 0.5);
+            }
+       }
+   }
+};
+
+} // namespace synthesis
+
+} // namespace askap
+
@@ -41,12 +41,19 @@
 #include <casa/BasicSL/Constants.h>
 #include <askap/AskapError.h>
 #include <gridding/VisGridderFactory.h>
+#include <gridding/GriddingPlan.h>
+#include <casa/Arrays/ArrayLogical.h>
+#include <casa/Arrays/ArrayMath.h>
 
 #include <cppunit/extensions/HelperMacros.h>
 
 #include <stdexcept>
 #include <boost/shared_ptr.hpp>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 using namespace askap::scimath;
 
 namespace askap
@@ -76,6 +83,14 @@ namespace askap
       CPPUNIT_TEST(testReverseAProjectWStack);
       CPPUNIT_TEST(testForwardATCAIllumination);
       CPPUNIT_TEST(testReverseATCAIllumination);
+      CPPUNIT_TEST(testSharedGriddingPlan);
+      CPPUNIT_TEST(testTiledGridding);
+#ifdef _OPENMP
+      CPPUNIT_TEST(testMultithreadedGridding);
+#endif
+      CPPUNIT_TEST(testLazyCFCache);
+      CPPUNIT_TEST(testSortedSamples);
+      CPPUNIT_TEST(testSinglePrecision);
       CPPUNIT_TEST_SUITE_END();
 
   private:
@@ -268,6 +283,210 @@ namespace askap
         itsAProjectWStack->initialiseDegrid(*itsAxes, *itsModel);
         itsAProjectWStack->degrid(*idi);
       }
+      void testSharedGriddingPlan()
+      {
+        // reference result obtained with the plan owned by the gridder
+        itsWProject->initialiseGrid(*itsAxes, itsModel->shape(), false);
+        itsWProject->grid(*idi);
+        itsWProject->finaliseGrid(*itsModel);
+        // now share the plan between two gridders with different oversampling,
+        // the second one has to fall back to its own plan
+        const GriddingPlan::ShPtr plan(new GriddingPlan);
+        boost::shared_ptr<WProjectVisGridder> wProject(new WProjectVisGridder(10000.0, 9, 1e-3, 1, 128, 0, ""));
+        wProject->setGriddingPlan(plan);
+        itsSphFunc->setGriddingPlan(plan);
+        wProject->initialiseGrid(*itsAxes, itsModel->shape(), false);
+        itsSphFunc->initialiseGrid(*itsAxes, itsModel->shape(), true);
+        CPPUNIT_ASSERT(!plan->isValid());
+        wProject->grid(*idi);
+        CPPUNIT_ASSERT(plan->isValid());
+        CPPUNIT_ASSERT_EQUAL(idi->nRow(), plan->nRow());
+        CPPUNIT_ASSERT_EQUAL(idi->nChannel(), plan->nChan());
+        CPPUNIT_ASSERT_EQUAL(casa::uLong(0), plan->rowsRejected());
+        itsSphFunc->grid(*idi);
+        itsSphFunc->finaliseGrid(*itsModelPSF);
+        casa::Array<double> result(itsModel->shape());
+        wProject->finaliseGrid(result);
+        CPPUNIT_ASSERT(casa::allNearAbs(result, *itsModel, 1e-10));
+        // the plan can be reused for degridding of the same chunk
+        wProject->initialiseDegrid(*itsAxes, *itsModel);
+        wProject->degrid(*idi);
+        plan->invalidate();
+        CPPUNIT_ASSERT(!plan->isValid());
+      }
+
+      void testTiledGridding()
+      {
+        // more than one thread switches gridding to the stripe-tiled mode, which is used
+        // even without OpenMP (all stripes are gridded by one thread then)
+        // reference result obtained with the serial code
+        itsWProject->initialiseGrid(*itsAxes, itsModel->shape(), false);
+        itsWProject->grid(*idi);
+        itsWProject->finaliseGrid(*itsModel);
+        const double peak = casa::max(casa::abs(*itsModel));
+        CPPUNIT_ASSERT(peak > 0.);
+        // the order of summation is different in the multithreaded mode, so the result
+        // is only expected to be the same to within rounding errors
+        boost::shared_ptr<WProjectVisGridder> wProject(new WProjectVisGridder(10000.0, 9, 1e-3, 1, 128, 0, ""));
+        wProject->setNumberOfThreads(4);
+        wProject->initialiseGrid(*itsAxes, itsModel->shape(), false);
+        wProject->grid(*idi);
+        casa::Array<double> result4(itsModel->shape());
+        wProject->finaliseGrid(result4);
+        CPPUNIT_ASSERT(casa::max(casa::abs(result4 - *itsModel)) < 1e-5 * peak);
+        // however, the result must not depend on the number of threads
+        wProject.reset(new WProjectVisGridder(10000.0, 9, 1e-3, 1, 128, 0, ""));
+        wProject->setNumberOfThreads(2);
+        wProject->initialiseGrid(*itsAxes, itsModel->shape(), false);
+        wProject->grid(*idi);
+        casa::Array<double> result2(itsModel->shape());
+        wProject->finaliseGrid(result2);
+        CPPUNIT_ASSERT(casa::allEQ(result2, result4));
+        // degridding is parallelised over rows and should give exactly the same result
+        itsWProject->initialiseDegrid(*itsAxes, *itsModel);
+        idi->rwVisibility().set(0.);
+        itsWProject->degrid(*idi);
+        const casa::Cube<casa::Complex> serialVis = idi->visibility().copy();
+        wProject->initialiseDegrid(*itsAxes, *itsModel);
+        idi->rwVisibility().set(0.);
+        wProject->degrid(*idi);
+        CPPUNIT_ASSERT(casa::allEQ(serialVis, idi->visibility()));
+      }
+
+#ifdef _OPENMP
+      void testMultithreadedGridding()
+      {
+        // stripes and rows are processed by several threads concurrently here. Overlapping
+        // updates of the grid would make the result differ between the runs
+        omp_set_dynamic(0);
+        boost::shared_ptr<WProjectVisGridder> wProject(new WProjectVisGridder(10000.0, 9, 1e-3, 1, 128, 0, ""));
+        wProject->setNumberOfThreads(4);
+        CPPUNIT_ASSERT_EQUAL(4, wProject->numberOfThreads());
+        wProject->initialiseGrid(*itsAxes, itsModel->shape(), false);
+        wProject->grid(*idi);
+        wProject->finaliseGrid(*itsModel);
+        CPPUNIT_ASSERT(casa::max(casa::abs(*itsModel)) > 0.);
+        for (int run = 0; run < 5; ++run) {
+             wProject->initialiseGrid(*itsAxes, itsModel->shape(), false);
+             wProject->grid(*idi);
+             casa::Array<double> result(itsModel->shape());
+             wProject->finaliseGrid(result);
+             CPPUNIT_ASSERT(casa::allEQ(result, *itsModel));
+        }
+        // the same for degridding
+        wProject->initialiseDegrid(*itsAxes, *itsModel);
+        idi->rwVisibility().set(0.);
+        wProject->degrid(*idi);
+        const casa::Cube<casa::Complex> firstVis = idi->visibility().copy();
+        for (int run = 0; run < 5; ++run) {
+             wProject->initialiseDegrid(*itsAxes, *itsModel);
+             idi->rwVisibility().set(0.);
+             wProject->degrid(*idi);
+             CPPUNIT_ASSERT(casa::allEQ(firstVis, idi->visibility()));
+        }
+      }
+#endif
+
+      void testSortedSamples()
+      {
+        // reference result obtained in the accessor order
+        itsWProject->initialiseGrid(*itsAxes, itsModel->shape(), false);
+        itsWProject->grid(*idi);
+        itsWProject->finaliseGrid(*itsModel);
+        const double peak = casa::max(casa::abs(*itsModel));
+        CPPUNIT_ASSERT(peak > 0.);
+        // samples bucketed by w-plane and uv-tile are summed in a different order
+        boost::shared_ptr<WProjectVisGridder> wProject(new WProjectVisGridder(10000.0, 9, 1e-3, 1, 128, 0, ""));
+        wProject->setSampleSortingTileSize(16);
+        CPPUNIT_ASSERT_EQUAL(16, wProject->sampleSortingTileSize());
+        wProject->initialiseGrid(*itsAxes, itsModel->shape(), false);
+        wProject->grid(*idi);
+        casa::Array<double> result(itsModel->shape());
+        wProject->finaliseGrid(result);
+        CPPUNIT_ASSERT(casa::max(casa::abs(result - *itsModel)) < 1e-5 * peak);
+        // each visibility is degridded independently, so the order doesn't matter at all
+        itsWProject->initialiseDegrid(*itsAxes, *itsModel);
+        idi->rwVisibility().set(0.);
+        itsWProject->degrid(*idi);
+        const casa::Cube<casa::Complex> unsortedVis = idi->visibility().copy();
+        wProject->initialiseDegrid(*itsAxes, *itsModel);
+        idi->rwVisibility().set(0.);
+        wProject->degrid(*idi);
+        CPPUNIT_ASSERT(casa::allEQ(unsortedVis, idi->visibility()));
+        // sorting can be switched off again
+        wProject->setSampleSortingTileSize(0);
+        CPPUNIT_ASSERT_EQUAL(0, wProject->sampleSortingTileSize());
+      }
+
+      void testSinglePrecision()
+      {
+        // reference images obtained with double precision FFTs
+        itsSphFunc->initialiseGrid(*itsAxes, itsModel->shape(), false);
+        itsSphFunc->grid(*idi);
+        itsSphFunc->finaliseGrid(*itsModel);
+        itsWStack->initialiseGrid(*itsAxes, itsModel->shape(), false);
+        itsWStack->grid(*idi);
+        casa::Array<double> wStackRef(itsModel->shape());
+        itsWStack->finaliseGrid(wStackRef);
+        // the same in single precision, the error is expected to be at the level of float mantissa
+        boost::shared_ptr<SphFuncVisGridder> sphFunc(new SphFuncVisGridder());
+        sphFunc->setSinglePrecision(true);
+        CPPUNIT_ASSERT(sphFunc->isSinglePrecision());
+        sphFunc->initialiseGrid(*itsAxes, itsModel->shape(), false);
+        sphFunc->grid(*idi);
+        casa::Array<double> result(itsModel->shape());
+        sphFunc->finaliseGrid(result);
+        const double peak = casa::max(casa::abs(*itsModel));
+        CPPUNIT_ASSERT(peak > 0.);
+        CPPUNIT_ASSERT(casa::max(casa::abs(result - *itsModel)) < 1e-5 * peak);
+        boost::shared_ptr<WStackVisGridder> wStack(new WStackVisGridder(10000.0, 9));
+        wStack->setSinglePrecision(true);
+        wStack->initialiseGrid(*itsAxes, itsModel->shape(), false);
+        wStack->grid(*idi);
+        wStack->finaliseGrid(result);
+        const double wStackPeak = casa::max(casa::abs(wStackRef));
+        CPPUNIT_ASSERT(wStackPeak > 0.);
+        CPPUNIT_ASSERT(casa::max(casa::abs(result - wStackRef)) < 1e-5 * wStackPeak);
+        // degridding of the model
+        itsSphFunc->initialiseDegrid(*itsAxes, *itsModel);
+        idi->rwVisibility().set(0.);
+        itsSphFunc->degrid(*idi);
+        const casa::Cube<casa::Complex> refVis = idi->visibility().copy();
+        const float visPeak = casa::max(casa::amplitude(refVis));
+        CPPUNIT_ASSERT(visPeak > 0.);
+        sphFunc->initialiseDegrid(*itsAxes, *itsModel);
+        idi->rwVisibility().set(0.);
+        sphFunc->degrid(*idi);
+        CPPUNIT_ASSERT(casa::max(casa::amplitude(idi->visibility() - refVis)) < 1e-5 * visPeak);
+      }
+
+      void testLazyCFCache()
+      {
+        // reference result obtained with all w-planes generated up front
+        itsWProject->initialiseGrid(*itsAxes, itsModel->shape(), false);
+        itsWProject->grid(*idi);
+        itsWProject->finaliseGrid(*itsModel);
+        // w-planes generated on demand with the smallest possible memory budget,
+        // i.e. only the w-planes required for the current chunk are kept
+        boost::shared_ptr<WProjectVisGridder> wProject(new WProjectVisGridder(10000.0, 9, 1e-3, 1, 128, 0, ""));
+        wProject->setCFCacheParameters(true, 1);
+        wProject->initialiseGrid(*itsAxes, itsModel->shape(), false);
+        wProject->grid(*idi);
+        // second pass over the same data reuses the w-planes kept in memory
+        wProject->grid(*idi);
+        casa::Array<double> result(itsModel->shape());
+        wProject->finaliseGrid(result);
+        CPPUNIT_ASSERT(casa::allNearAbs(result, 2. * (*itsModel), 1e-10));
+        // degridding gives the same visibilities
+        itsWProject->initialiseDegrid(*itsAxes, *itsModel);
+        idi->rwVisibility().set(0.);
+        itsWProject->degrid(*idi);
+        const casa::Cube<casa::Complex> eagerVis = idi->visibility().copy();
+        wProject->initialiseDegrid(*itsAxes, *itsModel);
+        idi->rwVisibility().set(0.);
+        wProject->degrid(*idi);
+        CPPUNIT_ASSERT(casa::allEQ(eagerVis, idi->visibility()));
+      }
     };
 
   }
@@ -34,6 +34,8 @@
 #include <casa/aips.h>
 #include <casa/Arrays/Matrix.h>
 #include <casa/Arrays/Cube.h>
+#include <casa/Arrays/ArrayLogical.h>
+#include <casa/Arrays/ArrayMath.h>
 #include <measures/Measures/MPosition.h>
 #include <casa/Quanta/Quantum.h>
 #include <casa/Quanta/MVPosition.h>
@@ -47,6 +49,9 @@
 //#include <casa/Arrays/ArrayMath.h>
 
 #include <stdexcept>
+#include <vector>
+#include <map>
+#include <string>
 
 #include <boost/shared_ptr.hpp>
 
@@ -58,6 +63,31 @@ namespace askap
   namespace synthesis
   {
 
+    /// @brief object function recording residuals reported by the equation
+    struct BlockRecorder : public INormalEquationsUpdate
+    {
+      explicit BlockRecorder(const casa::uInt nBlocks) : itsNBlocks(nBlocks), itsNParameters(0) {}
+
+      virtual void parameterComplete(const ImagingNormalEquations &ne, const std::string &name)
+      {
+        itsLastBlock = ne.dataVector(name).copy();
+        ++itsNParameters;
+      }
+
+      virtual casa::uInt nBlocks() const { return itsNBlocks; }
+
+      virtual void blockComplete(const std::map<std::string, casa::Vector<double> > &dataVectors)
+      {
+        CPPUNIT_ASSERT_EQUAL(size_t(1), dataVectors.size());
+        itsBlocks.push_back(dataVectors.begin()->second.copy());
+      }
+
+      casa::uInt itsNBlocks;
+      int itsNParameters;
+      casa::Vector<double> itsLastBlock;
+      std::vector<casa::Vector<double> > itsBlocks;
+    };
+
     class ImageFFTEquationTest : public CppUnit::TestFixture
     {
 
@@ -67,6 +97,8 @@ namespace askap
       CPPUNIT_TEST(testSolveAntIllum);
       CPPUNIT_TEST_EXCEPTION(testFixed, CheckError);
       CPPUNIT_TEST(testFullPol);
+      CPPUNIT_TEST(testPSFCache);
+      CPPUNIT_TEST(testBlocks);
       CPPUNIT_TEST_SUITE_END();
 
   private:
@@ -229,6 +261,66 @@ namespace askap
             0))-0.700)<0.005);
       }
 
+      void testPSFCache()
+      {
+        p1->predict();
+        // reference normal equations without the cache
+        ImagingNormalEquations refNE(*params2);
+        p2->calcEquations(refNE);
+        // first call fills the cache, the second one uses it
+        const PSFWeightsCache::ShPtr cache(new PSFWeightsCache);
+        p2->setPSFCache(cache);
+        for (int cycle = 0; cycle < 2; ++cycle) {
+             ImagingNormalEquations ne(*params2);
+             p2->calcEquations(ne);
+             CPPUNIT_ASSERT_EQUAL(size_t(1), cache->size());
+             const std::string name = "image.i.cena";
+             CPPUNIT_ASSERT(casa::allEQ(refNE.normalMatrixSlice().find(name)->second,
+                                        ne.normalMatrixSlice().find(name)->second));
+             CPPUNIT_ASSERT(casa::allEQ(refNE.normalMatrixDiagonal().find(name)->second,
+                                        ne.normalMatrixDiagonal().find(name)->second));
+             CPPUNIT_ASSERT(casa::allEQ(refNE.dataVector(name), ne.dataVector(name)));
+        }
+        // a change of the image geometry invalidates the cached entry
+        const Axes axes(params2->axes("image.i.cena"));
+        CPPUNIT_ASSERT(cache->has("image.i.cena", axes, params2->value("image.i.cena").shape()));
+        CPPUNIT_ASSERT(!cache->has("image.i.cena", axes, casa::IPosition(4, npix/2, npix/2, 1, 1)));
+        // as well as a different gridder
+        cache->setConfiguration(IVisGridder::ShPtr(new SphFuncVisGridder), false);
+        CPPUNIT_ASSERT_EQUAL(size_t(0), cache->size());
+      }
+
+      void testBlocks()
+      {
+        const std::string name = "image.i.cena";
+        accessors::IDataSharedIter idi4(new accessors::DataIteratorStub(4));
+        ImageFFTEquation eq(*params2, idi4);
+        const boost::shared_ptr<BlockRecorder> recorder(new BlockRecorder(2));
+        eq.setNEUpdateObject(recorder);
+        // the number of iterations is not known in the first pass, so everything is reported at the end
+        ImagingNormalEquations refNE(*params2);
+        eq.calcEquations(refNE);
+        CPPUNIT_ASSERT_EQUAL(size_t(0), recorder->itsBlocks.size());
+        CPPUNIT_ASSERT_EQUAL(1, recorder->itsNParameters);
+        CPPUNIT_ASSERT(casa::allEQ(refNE.dataVector(name), recorder->itsLastBlock));
+        // the second pass is split into two blocks of two iterations
+        ImagingNormalEquations ne(*params2);
+        eq.calcEquations(ne);
+        CPPUNIT_ASSERT_EQUAL(size_t(1), recorder->itsBlocks.size());
+        CPPUNIT_ASSERT_EQUAL(2, recorder->itsNParameters);
+        const casa::Vector<double> &refData = refNE.dataVector(name);
+        const double tolerance = 1e-6 * casa::max(casa::abs(refData));
+        CPPUNIT_ASSERT(tolerance > 0.);
+        CPPUNIT_ASSERT(casa::allNearAbs(refData, recorder->itsBlocks[0] + recorder->itsLastBlock, tolerance));
+        // normal equations have all data, PSF is not affected by blocks
+        CPPUNIT_ASSERT(casa::allNearAbs(refData, ne.dataVector(name), tolerance));
+        CPPUNIT_ASSERT(casa::allEQ(refNE.normalMatrixSlice().find(name)->second,
+                                   ne.normalMatrixSlice().find(name)->second));
+        const casa::Vector<double> &refWeights = refNE.normalMatrixDiagonal().find(name)->second;
+        CPPUNIT_ASSERT(casa::allNearAbs(refWeights, ne.normalMatrixDiagonal().find(name)->second,
+                                        1e-6 * casa::max(refWeights)));
+      }
+
       void testFixed()
       {
         ImagingNormalEquations ne(*params1);
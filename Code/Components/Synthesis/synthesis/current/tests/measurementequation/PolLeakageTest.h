@@ -67,6 +67,7 @@ namespace askap
       CPPUNIT_TEST(testSolve);
       CPPUNIT_TEST(testSolvePreAvg);
       CPPUNIT_TEST(testApplication);
+      CPPUNIT_TEST(testApplicationPolOrder);
       CPPUNIT_TEST(testSimulation);            
       CPPUNIT_TEST_SUITE_END();
      
@@ -335,6 +336,50 @@ namespace askap
           }
         }
         
+        void testApplicationPolOrder() {        
+          // the same as testApplication, but with polarisation products in a non-canonical
+          // order, which is handled via the general Mueller matrix rather than the inverse Jones table
+          CPPUNIT_ASSERT(itsIter);
+          accessors::DataAccessorStub &da = dynamic_cast<accessors::DataAccessorStub&>(*itsIter);          
+          CPPUNIT_ASSERT(da.itsStokes.nelements() == 4);
+          da.rwVisibility().set(0.);          
+          
+          fillGainsAndLeakages();
+          CPPUNIT_ASSERT(itsParams1);
+          
+          itsCE1.reset(new ComponentEquation(*itsParams1, itsIter));
+          typedef CalibrationME<Product<NoXPolGain,LeakageTerm> > METype2;
+          
+          boost::shared_ptr<METype2> eq1(new METype2(*itsParams1,itsIter,itsCE1));
+          eq1->predict();
+          
+          // reorder products to XX,YY,XY,YX
+          const casa::uInt order[4] = {0, 3, 1, 2};
+          const casa::Cube<casa::Complex> origVis = da.visibility().copy();
+          casa::Vector<casa::Stokes::StokesTypes> stokes(4);
+          for (casa::uInt pol = 0; pol < 4; ++pol) {
+               stokes[pol] = da.itsStokes[order[pol]];
+               da.rwVisibility().xyPlane(pol) = origVis.xyPlane(order[pol]);
+          }
+          da.itsStokes.assign(stokes.copy());
+          
+          accessors::CachedCalSolutionAccessor acc(itsParams1);                    
+          accessors::CalSolutionSourceStub src(boost::shared_ptr<accessors::CachedCalSolutionAccessor>(&acc,utility::NullDeleter()));
+          CalibrationApplicatorME calME(boost::shared_ptr<accessors::CalSolutionSourceStub>(&src,utility::NullDeleter()));
+          calME.correct(da);
+
+          // check visibilities after calibration application
+          const casa::Cube<casa::Complex>& vis = da.visibility();
+          for (casa::uInt row = 0; row < da.nRow(); ++row) {
+               for (casa::uInt chan = 0; chan < da.nChannel(); ++chan) {
+                    for (casa::uInt pol = 0; pol < da.nPol(); ++pol) {
+                         CPPUNIT_ASSERT_DOUBLES_EQUAL(pol < 2 ? 0.5 : 0., real(vis(row,chan,pol)),1e-6);
+                         CPPUNIT_ASSERT_DOUBLES_EQUAL(0., imag(vis(row,chan,pol)),1e-6);                         
+                    }
+               }
+          }
+        }
+        
         void checkTwoParamsClasses(const scimath::Params &param1, const scimath::Params &param2) {
             const std::vector<string> names = param1.names();
             CPPUNIT_ASSERT_EQUAL(names.size(), param2.names().size());
@@ -0,0 +1,103 @@
+/// @file
+///
+/// Unit test for the checkpoint files of the major cycle loop
+///
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author agent <agent@local>
+
+
+#ifndef ASKAP_SYNTHESIS_CHECKPOINT_TEST_H
+#define ASKAP_SYNTHESIS_CHECKPOINT_TEST_H
+
+#include <parallel/MEParallelApp.h>
+#include <fitting/Params.h>
+#include <askap/AskapError.h>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <casa/Arrays/Array.h>
+#include <casa/Arrays/ArrayMath.h>
+#include <casa/Arrays/ArrayLogical.h>
+
+#include <cstdio>
+#include <string>
+
+namespace askap {
+
+namespace synthesis {
+
+class CheckpointTest : public CppUnit::TestFixture 
+{
+   CPPUNIT_TEST_SUITE(CheckpointTest);
+   CPPUNIT_TEST(testRoundTrip);
+   CPPUNIT_TEST(testMissingFile);
+   CPPUNIT_TEST_EXCEPTION(testWriteFailure, AskapError);
+   CPPUNIT_TEST_SUITE_END();
+public:
+
+   void testRoundTrip() {
+      const std::string fileName("tparallel_checkpoint.tmp");
+      scimath::Params model;
+      model.add("flux.i.src", 1.5);
+      casa::Array<double> image(casa::IPosition(2, 4, 3));
+      casa::indgen(image);
+      model.add("image.i.test", image);
+      MEParallelApp::writeCheckpointFile(MEParallelApp::encodeCheckpoint(3, model), fileName);
+      // overwriting the file replaces the previous checkpoint
+      model.update("flux.i.src", 2.5);
+      MEParallelApp::writeCheckpointFile(MEParallelApp::encodeCheckpoint(4, model), fileName);
+
+      scimath::Params restored;
+      const int cycle = MEParallelApp::readCheckpointFile(fileName, restored);
+      std::remove(fileName.c_str());
+      CPPUNIT_ASSERT_EQUAL(4, cycle);
+      CPPUNIT_ASSERT_EQUAL(model.size(), restored.size());
+      CPPUNIT_ASSERT(restored.has("flux.i.src"));
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(2.5, restored.scalarValue("flux.i.src"), 1e-10);
+      CPPUNIT_ASSERT(restored.has("image.i.test"));
+      CPPUNIT_ASSERT(restored.value("image.i.test").shape() == image.shape());
+      CPPUNIT_ASSERT(casa::allEQ(restored.value("image.i.test"), image));
+   }
+
+   void testMissingFile() {
+      scimath::Params model;
+      CPPUNIT_ASSERT_EQUAL(-1, MEParallelApp::readCheckpointFile("tparallel_nonexistent.tmp", model));
+      CPPUNIT_ASSERT_EQUAL(0u, model.size());
+   }
+
+   void testWriteFailure() {
+      scimath::Params model;
+      model.add("flux.i.src", 1.);
+      // the directory doesn't exist, an exception is expected
+      MEParallelApp::writeCheckpointFile(MEParallelApp::encodeCheckpoint(0, model),
+                                         "tparallel_nonexistent_dir/checkpoint");
+   }
+};
+
+} // namespace synthesis
+
+} // namespace askap
+
+#endif // #ifndef ASKAP_SYNTHESIS_CHECKPOINT_TEST_H
@@ -0,0 +1,222 @@
+/// @file
+///
+/// Unit test for the collective reduction of imaging normal equations (parts which
+/// don't require communication)
+///
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author agent <agent@local>
+
+
+#ifndef ASKAP_SYNTHESIS_IMAGING_NE_REDUCER_TEST_H
+#define ASKAP_SYNTHESIS_IMAGING_NE_REDUCER_TEST_H
+
+#include <parallel/ImagingNEReducer.h>
+#include <fitting/ImagingNormalEquations.h>
+#include <fitting/GenericNormalEquations.h>
+#include <askap/AskapError.h>
+
+#include <casa/Arrays/Vector.h>
+#include <casa/Arrays/IPosition.h>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <boost/shared_ptr.hpp>
+
+#include <string>
+
+namespace askap {
+
+namespace synthesis {
+
+class ImagingNEReducerTest : public CppUnit::TestFixture 
+{
+   CPPUNIT_TEST_SUITE(ImagingNEReducerTest);
+   CPPUNIT_TEST(testReducible);
+   CPPUNIT_TEST(testLayout);
+   CPPUNIT_TEST(testConforms);
+   CPPUNIT_TEST(testFallback);
+   CPPUNIT_TEST(testAgreement);
+   CPPUNIT_TEST(testStreamDecision);
+   CPPUNIT_TEST(testStreamBlocks);
+   CPPUNIT_TEST_EXCEPTION(testChangeWhileStreaming, AskapError);
+   CPPUNIT_TEST_SUITE_END();
+public:
+
+   void testReducible() {
+      boost::shared_ptr<scimath::ImagingNormalEquations> ne = makeNE("image.a", false);
+      CPPUNIT_ASSERT(ImagingNEReducer::reducible(ne) == ne.get());
+      // single precision transport is only implemented by the blob-based reduction
+      ne->setSinglePrecisionTransport(true);
+      CPPUNIT_ASSERT(ImagingNEReducer::reducible(ne) == NULL);
+      // as are other types of normal equations
+      const scimath::INormalEquations::ShPtr gne(new scimath::GenericNormalEquations);
+      CPPUNIT_ASSERT(ImagingNEReducer::reducible(gne) == NULL);
+      CPPUNIT_ASSERT(ImagingNEReducer::reducible(scimath::INormalEquations::ShPtr()) == NULL);
+   }
+
+   void testLayout() {
+      boost::shared_ptr<scimath::ImagingNormalEquations> ne = makeNE("image.b", true);
+      addParameter(*ne, "image.a", false);
+      const ImagingNEReducer::Layout layout = ImagingNEReducer::layoutOf(*ne);
+      CPPUNIT_ASSERT_EQUAL(size_t(2), layout.size());
+      // entries are sorted by name
+      CPPUNIT_ASSERT_EQUAL(std::string("image.a"), layout.begin()->first);
+      const ImagingNEReducer::LayoutEntry &entryA = layout.find("image.a")->second;
+      CPPUNIT_ASSERT_EQUAL(casa::uInt(16), entryA.itsDataSize);
+      CPPUNIT_ASSERT_EQUAL(casa::uInt(16), entryA.itsDiagonalSize);
+      CPPUNIT_ASSERT_EQUAL(casa::uInt(0), entryA.itsSliceSize);
+      CPPUNIT_ASSERT(entryA.itsShape == casa::IPosition(2, 4, 4));
+      const ImagingNEReducer::LayoutEntry &entryB = layout.find("image.b")->second;
+      CPPUNIT_ASSERT_EQUAL(casa::uInt(16), entryB.itsSliceSize);
+      CPPUNIT_ASSERT(entryB.itsReference == casa::IPosition(2, 2, 2));
+      // empty normal equations (e.g. master) have an empty layout
+      CPPUNIT_ASSERT(ImagingNEReducer::layoutOf(scimath::ImagingNormalEquations()).empty());
+   }
+
+   void testConforms() {
+      boost::shared_ptr<scimath::ImagingNormalEquations> ne = makeNE("image.a", false);
+      addParameter(*ne, "image.b", true);
+      const ImagingNEReducer::Layout layout = ImagingNEReducer::layoutOf(*ne);
+      CPPUNIT_ASSERT(ImagingNEReducer::conforms(*ne, layout));
+      // ranks without data for some or all parameters contribute zeros
+      CPPUNIT_ASSERT(ImagingNEReducer::conforms(scimath::ImagingNormalEquations(), layout));
+      CPPUNIT_ASSERT(ImagingNEReducer::conforms(*makeNE("image.b", true), layout));
+      // a parameter which is not in the layout
+      boost::shared_ptr<scimath::ImagingNormalEquations> ne2 = makeNE("image.a", false);
+      addParameter(*ne2, "image.c", false);
+      CPPUNIT_ASSERT(!ImagingNEReducer::conforms(*ne2, layout));
+      // different geometry of the same parameter
+      CPPUNIT_ASSERT(!ImagingNEReducer::conforms(*makeNE("image.b", false), layout));
+      scimath::ImagingNormalEquations ne3;
+      ne3.addSlice("image.b", casa::Vector<double>(16, 1.), casa::Vector<double>(16, 1.), 
+                   casa::Vector<double>(16, 1.), casa::IPosition(2, 4, 4), casa::IPosition(2, 1, 1));
+      CPPUNIT_ASSERT(!ImagingNEReducer::conforms(ne3, layout));
+      scimath::ImagingNormalEquations ne4;
+      ne4.addDiagonal("image.a", casa::Vector<double>(16, 1.), casa::Vector<double>(16, 1.), casa::IPosition(2, 2, 8));
+      CPPUNIT_ASSERT(!ImagingNEReducer::conforms(ne4, layout));
+   }
+
+   void testFallback() {
+      boost::shared_ptr<scimath::ImagingNormalEquations> ne = makeNE("image.a", false);
+      const ImagingNEReducer::Layout layout = ImagingNEReducer::layoutOf(*ne);
+      CPPUNIT_ASSERT(ImagingNEReducer::canUseLayout(ne.get(), layout));
+      // this rank has to use the blob-based reduction
+      CPPUNIT_ASSERT(!ImagingNEReducer::canUseLayout(NULL, layout));
+      // the first worker can't take part in the collective reduction
+      CPPUNIT_ASSERT(!ImagingNEReducer::canUseLayout(ne.get(), ImagingNEReducer::Layout()));
+      // workers image different parameters
+      CPPUNIT_ASSERT(!ImagingNEReducer::canUseLayout(makeNE("image.b", false).get(), layout));
+   }
+
+   void testAgreement() {
+      ImagingNEReducer reducer;
+      boost::shared_ptr<scimath::ImagingNormalEquations> ne = makeNE("image.a", false);
+      // initially there is no layout, it has to be agreed
+      CPPUNIT_ASSERT(!reducer.layoutAgreed());
+      CPPUNIT_ASSERT(reducer.layoutChanged(ne.get()));
+      reducer.setLayout(ImagingNEReducer::layoutOf(*ne), true);
+      CPPUNIT_ASSERT(reducer.layoutAgreed());
+      // the same layout in the following cycles doesn't need to be agreed again
+      CPPUNIT_ASSERT(!reducer.layoutChanged(ne.get()));
+      CPPUNIT_ASSERT(!reducer.layoutChanged(makeNE("image.a", false).get()));
+      CPPUNIT_ASSERT(!reducer.layoutChanged(ImagingNEReducer::reducible(scimath::INormalEquations::ShPtr(
+                                            new scimath::ImagingNormalEquations))));
+      // but a new parameter or a fallback of this rank requires a new agreement
+      CPPUNIT_ASSERT(reducer.layoutChanged(makeNE("image.b", false).get()));
+      CPPUNIT_ASSERT(reducer.layoutChanged(NULL));
+      // the layout which is not agreed by all ranks is not kept
+      reducer.setLayout(ImagingNEReducer::layoutOf(*ne), false);
+      CPPUNIT_ASSERT(!reducer.layoutAgreed());
+      CPPUNIT_ASSERT(reducer.layoutChanged(ne.get()));
+      // as is an empty layout
+      reducer.setLayout(ImagingNEReducer::Layout(), true);
+      CPPUNIT_ASSERT(!reducer.layoutAgreed());
+      reducer.setLayout(ImagingNEReducer::layoutOf(*ne), true);
+      reducer.invalidate();
+      CPPUNIT_ASSERT(!reducer.layoutAgreed());
+      CPPUNIT_ASSERT(reducer.layoutChanged(ne.get()));
+   }
+
+   void testStreamDecision() {
+      ImagingNEReducer reducer;
+      // nothing is streamed until the layout is agreed by the first reduction
+      CPPUNIT_ASSERT(!reducer.startStream());
+      CPPUNIT_ASSERT(!reducer.startStream());
+      boost::shared_ptr<scimath::ImagingNormalEquations> ne = makeNE("image.a", false);
+      reducer.setLayout(ImagingNEReducer::layoutOf(*ne), false);
+      CPPUNIT_ASSERT(!reducer.startStream());
+      reducer.setLayout(ImagingNEReducer::layoutOf(*ne), true);
+      CPPUNIT_ASSERT(reducer.startStream());
+   }
+
+   void testStreamBlocks() {
+      ImagingNEReducer reducer;
+      CPPUNIT_ASSERT_EQUAL(casa::uInt(1), reducer.nBlocks());
+      boost::shared_ptr<scimath::ImagingNormalEquations> ne = makeNE("image.a", false);
+      reducer.setLayout(ImagingNEReducer::layoutOf(*ne), true);
+      // the number of blocks is given to the imaging equation via the streamer
+      CPPUNIT_ASSERT(reducer.startStream(3));
+      CPPUNIT_ASSERT_EQUAL(casa::uInt(3), reducer.nBlocks());
+   }
+
+   void testChangeWhileStreaming() {
+      ImagingNEReducer reducer;
+      boost::shared_ptr<scimath::ImagingNormalEquations> ne = makeNE("image.a", false);
+      reducer.setLayout(ImagingNEReducer::layoutOf(*ne), true);
+      CPPUNIT_ASSERT(reducer.startStream());
+      // the layout can't change until the streamed reduction is finished by reduce
+      reducer.invalidate();
+   }
+
+private:
+   /// @brief add parameter with 4x4 pixels to the normal equations
+   /// @param[in] ne normal equations
+   /// @param[in] name parameter name
+   /// @param[in] slice true to add a slice of the normal matrix, false to add the diagonal only
+   static void addParameter(scimath::ImagingNormalEquations &ne, const std::string &name, const bool slice) {
+      const casa::Vector<double> buf(16, 1.);
+      if (slice) {
+          ne.addSlice(name, buf, buf, buf, casa::IPosition(2, 4, 4), casa::IPosition(2, 2, 2));
+      } else {
+          ne.addDiagonal(name, buf, buf, casa::IPosition(2, 4, 4));
+      }
+   }
+
+   /// @brief make normal equations with one parameter
+   /// @param[in] name parameter name
+   /// @param[in] slice true to add a slice of the normal matrix, false to add the diagonal only
+   /// @return shared pointer to the new normal equations
+   static boost::shared_ptr<scimath::ImagingNormalEquations> makeNE(const std::string &name, const bool slice) {
+      boost::shared_ptr<scimath::ImagingNormalEquations> ne(new scimath::ImagingNormalEquations);
+      addParameter(*ne, name, slice);
+      return ne;
+   }
+};
+
+} // namespace synthesis
+
+} // namespace askap
+
+#endif // #ifndef ASKAP_SYNTHESIS_IMAGING_NE_REDUCER_TEST_H
@@ -0,0 +1,180 @@
+/// @file
+///
+/// Unit test for the size-aware distribution of model parameters between worker groups
+///
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author agent <agent@local>
+
+
+#ifndef ASKAP_SYNTHESIS_MODEL_DISTRIBUTION_PLANNER_TEST_H
+#define ASKAP_SYNTHESIS_MODEL_DISTRIBUTION_PLANNER_TEST_H
+
+#include <parallel/ModelDistributionPlanner.h>
+#include <fitting/Params.h>
+#include <askap/AskapError.h>
+#include <Common/ParameterSet.h>
+
+#include <casa/Arrays/Array.h>
+#include <casa/Arrays/IPosition.h>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <string>
+#include <vector>
+
+namespace askap {
+
+namespace synthesis {
+
+class ModelDistributionPlannerTest : public CppUnit::TestFixture 
+{
+   CPPUNIT_TEST_SUITE(ModelDistributionPlannerTest);
+   CPPUNIT_TEST(testCost);
+   CPPUNIT_TEST(testUnevenSplit);
+   CPPUNIT_TEST(testGridCost);
+   CPPUNIT_TEST(testOneParameterPerGroup);
+   CPPUNIT_TEST(testPlanReuse);
+   CPPUNIT_TEST_EXCEPTION(testTooManyGroups, AskapError);
+   CPPUNIT_TEST_EXCEPTION(testNegativeGridCost, AskapError);
+   CPPUNIT_TEST_SUITE_END();
+public:
+
+   void setUp() {
+      // one large facet and four small ones
+      itsModel.add("image.a", casa::Array<double>(casa::IPosition(2, 64, 64), 0.));
+      const std::string small[4] = {"image.e", "image.c", "image.d", "image.b"};
+      itsNames.assign(1, "image.a");
+      for (size_t i = 0; i < 4; ++i) {
+           itsModel.add(small[i], casa::Array<double>(casa::IPosition(2, 32, 32), 0.));
+           itsNames.push_back(small[i]);
+      }
+   }
+
+   void testCost() {
+      LOFAR::ParameterSet parset;
+      ModelDistributionPlanner planner(parset);
+      // N log2 N
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(49152., planner.cost(itsModel, "image.a"), 1e-6);
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(10240., planner.cost(itsModel, "image.b"), 1e-6);
+      parset.add("modeldistribution.gridcost", "1000");
+      ModelDistributionPlanner planner2(parset);
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(11240., planner2.cost(itsModel, "image.b"), 1e-6);
+   }
+
+   void testUnevenSplit() {
+      LOFAR::ParameterSet parset;
+      ModelDistributionPlanner planner(parset);
+      const std::vector<std::vector<std::string> > &plan = planner.plan(itsModel, itsNames, 2);
+      CPPUNIT_ASSERT_EQUAL(size_t(2), plan.size());
+      // the large facet costs more than all the small ones together, so it gets a group of its own
+      CPPUNIT_ASSERT_EQUAL(size_t(1), plan[0].size());
+      CPPUNIT_ASSERT_EQUAL(std::string("image.a"), plan[0][0]);
+      // parameters of the same cost are assigned in the order of their names
+      CPPUNIT_ASSERT_EQUAL(size_t(4), plan[1].size());
+      CPPUNIT_ASSERT_EQUAL(std::string("image.b"), plan[1][0]);
+      CPPUNIT_ASSERT_EQUAL(std::string("image.c"), plan[1][1]);
+      CPPUNIT_ASSERT_EQUAL(std::string("image.d"), plan[1][2]);
+      CPPUNIT_ASSERT_EQUAL(std::string("image.e"), plan[1][3]);
+   }
+
+   void testGridCost() {
+      // a large fixed cost makes all parameters nearly equal, the split is close to even
+      LOFAR::ParameterSet parset;
+      parset.add("modeldistribution.gridcost", "1e6");
+      ModelDistributionPlanner planner(parset);
+      const std::vector<std::vector<std::string> > &plan = planner.plan(itsModel, itsNames, 2);
+      CPPUNIT_ASSERT_EQUAL(size_t(2), plan.size());
+      CPPUNIT_ASSERT_EQUAL(size_t(2), plan[0].size());
+      CPPUNIT_ASSERT_EQUAL(std::string("image.a"), plan[0][0]);
+      CPPUNIT_ASSERT_EQUAL(std::string("image.d"), plan[0][1]);
+      CPPUNIT_ASSERT_EQUAL(size_t(3), plan[1].size());
+      CPPUNIT_ASSERT_EQUAL(std::string("image.b"), plan[1][0]);
+      CPPUNIT_ASSERT_EQUAL(std::string("image.c"), plan[1][1]);
+      CPPUNIT_ASSERT_EQUAL(std::string("image.e"), plan[1][2]);
+   }
+
+   void testOneParameterPerGroup() {
+      LOFAR::ParameterSet parset;
+      ModelDistributionPlanner planner(parset);
+      const std::vector<std::vector<std::string> > &plan = planner.plan(itsModel, itsNames, itsNames.size());
+      CPPUNIT_ASSERT_EQUAL(itsNames.size(), plan.size());
+      for (size_t group = 0; group < plan.size(); ++group) {
+           CPPUNIT_ASSERT_EQUAL(size_t(1), plan[group].size());
+      }
+      CPPUNIT_ASSERT_EQUAL(std::string("image.a"), plan[0][0]);
+      CPPUNIT_ASSERT_EQUAL(std::string("image.e"), plan[4][0]);
+   }
+
+   void testPlanReuse() {
+      LOFAR::ParameterSet parset;
+      ModelDistributionPlanner planner(parset);
+      const std::vector<std::vector<std::string> > plan = planner.plan(itsModel, itsNames, 2);
+      // the same parameters in a different order give the same plan
+      std::vector<std::string> names(itsNames.rbegin(), itsNames.rend());
+      CPPUNIT_ASSERT(plan == planner.plan(itsModel, names, 2));
+      // a different number of groups gives a new plan
+      const std::vector<std::vector<std::string> > &plan3 = planner.plan(itsModel, names, 3);
+      CPPUNIT_ASSERT_EQUAL(size_t(3), plan3.size());
+      CPPUNIT_ASSERT_EQUAL(size_t(1), plan3[0].size());
+      CPPUNIT_ASSERT_EQUAL(size_t(2), plan3[1].size());
+      CPPUNIT_ASSERT_EQUAL(size_t(2), plan3[2].size());
+      // as does a different list of parameters
+      names.pop_back();
+      const std::vector<std::vector<std::string> > &plan4 = planner.plan(itsModel, names, 3);
+      CPPUNIT_ASSERT_EQUAL(size_t(3), plan4.size());
+      CPPUNIT_ASSERT_EQUAL(size_t(2), plan4[0].size());
+      CPPUNIT_ASSERT_EQUAL(std::string("image.b"), plan4[0][0]);
+      CPPUNIT_ASSERT_EQUAL(std::string("image.e"), plan4[0][1]);
+   }
+
+   void testTooManyGroups() {
+      // more groups of workers than facets or Taylor terms
+      LOFAR::ParameterSet parset;
+      ModelDistributionPlanner planner(parset);
+      const std::vector<std::string> names(itsNames.begin(), itsNames.begin() + 2);
+      // this should throw an exception
+      planner.plan(itsModel, names, 3);
+   }
+
+   void testNegativeGridCost() {
+      LOFAR::ParameterSet parset;
+      parset.add("modeldistribution.gridcost", "-1");
+      // this should throw an exception
+      ModelDistributionPlanner planner(parset);
+   }
+
+private:
+   /// @brief model with facets of different size
+   scimath::Params itsModel;
+
+   /// @brief names of the parameters to distribute
+   std::vector<std::string> itsNames;
+};
+
+} // namespace synthesis
+
+} // namespace askap
+
+#endif // #ifndef ASKAP_SYNTHESIS_MODEL_DISTRIBUTION_PLANNER_TEST_H
@@ -0,0 +1,129 @@
+/// @file
+///
+/// Unit test for the shallow copy of the model passed to measurement equations
+///
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author agent <agent@local>
+
+#ifndef ASKAP_SYNTHESIS_SHARED_MODEL_TEST_H
+#define ASKAP_SYNTHESIS_SHARED_MODEL_TEST_H
+
+#include <parallel/SynParallel.h>
+#include <measurementequation/ImageFFTEquation.h>
+#include <dataaccess/DataIteratorStub.h>
+#include <fitting/Params.h>
+#include <fitting/Axes.h>
+
+#include <casa/Arrays/Array.h>
+#include <casa/Arrays/IPosition.h>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <vector>
+
+namespace askap {
+
+namespace synthesis {
+
+class SharedModelTest : public CppUnit::TestFixture 
+{
+   CPPUNIT_TEST_SUITE(SharedModelTest);
+   CPPUNIT_TEST(testReference);
+   CPPUNIT_TEST(testUpdate);
+   CPPUNIT_TEST(testFacets);
+   CPPUNIT_TEST_SUITE_END();
+public:
+
+   void setUp() {
+      // this buffer stands in for the node-local shared window
+      itsWindow.assign(2 * theirShape.product(), 0.);
+      itsModel.reset();
+      itsModel.add("image.i.test", casa::Array<double>(theirShape, 0.));
+      itsModel.add("image.q.test", casa::Array<double>(theirShape, 0.));
+      // this is what receiveSharedModel does with large arrays
+      itsModel.value("image.i.test").reference(casa::Array<double>(theirShape, &itsWindow[0], casa::SHARE));
+      itsModel.value("image.q.test").reference(casa::Array<double>(theirShape,
+                     &itsWindow[theirShape.product()], casa::SHARE));
+      itsModel.add("peak", 1.);
+   }
+
+   void testReference() {
+      accessors::IDataSharedIter idi(new accessors::DataIteratorStub(1));
+      ImageFFTEquation equation(idi);
+      CPPUNIT_ASSERT(SynParallel::referenceModel(equation, itsModel));
+      const scimath::Params &params = equation.parameters();
+      CPPUNIT_ASSERT_EQUAL(size_t(3), params.names().size());
+      CPPUNIT_ASSERT(params.value("image.i.test").data() == &itsWindow[0]);
+      CPPUNIT_ASSERT(params.value("image.q.test").data() == &itsWindow[theirShape.product()]);
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(1., params.scalarValue("peak"), 1e-15);
+      // changes in the window are seen by the equation
+      itsWindow[3] = 2.;
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(2., params.value("image.i.test").data()[3], 1e-15);
+   }
+
+   void testUpdate() {
+      // an equation which got a copy of the model can be switched to references later on
+      accessors::IDataSharedIter idi(new accessors::DataIteratorStub(1));
+      ImageFFTEquation equation(itsModel, idi);
+      CPPUNIT_ASSERT(equation.parameters().value("image.i.test").data() != &itsWindow[0]);
+      CPPUNIT_ASSERT(SynParallel::referenceModel(equation, itsModel));
+      CPPUNIT_ASSERT(equation.parameters().value("image.i.test").data() == &itsWindow[0]);
+      // the next major cycle
+      itsWindow[0] = 1.;
+      CPPUNIT_ASSERT(SynParallel::referenceModel(equation, itsModel));
+      CPPUNIT_ASSERT(equation.parameters().value("image.i.test").data() == &itsWindow[0]);
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(1., equation.parameters().value("image.i.test").data()[0], 1e-15);
+   }
+
+   void testFacets() {
+      // facets are clipped in place by the equation, they are never referenced
+      scimath::Axes axes;
+      axes.add("FACETSTEP", 8., 8.);
+      itsModel.add("image.i.test.facet.0.0", casa::Array<double>(theirShape, 0.), axes);
+      accessors::IDataSharedIter idi(new accessors::DataIteratorStub(1));
+      ImageFFTEquation equation(idi);
+      const scimath::Params::ShPtr before = equation.rwParameters();
+      CPPUNIT_ASSERT(!SynParallel::referenceModel(equation, itsModel));
+      CPPUNIT_ASSERT(equation.rwParameters() == before);
+   }
+
+private:
+   /// @brief model with large arrays in the window
+   scimath::Params itsModel;
+
+   /// @brief buffer used instead of the shared window
+   std::vector<double> itsWindow;
+
+   /// @brief shape of the test images
+   static const casa::IPosition theirShape;
+};
+
+const casa::IPosition SharedModelTest::theirShape(4, 16, 16, 1, 1);
+
+} // namespace synthesis
+
+} // namespace askap
+
+#endif // #ifndef ASKAP_SYNTHESIS_SHARED_MODEL_TEST_H
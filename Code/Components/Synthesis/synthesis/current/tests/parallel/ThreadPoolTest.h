@@ -0,0 +1,168 @@
+/// @file
+///
+/// Unit test for the pool of threads used by the imager
+///
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author agent <agent@local>
+
+
+#ifndef ASKAP_SYNTHESIS_THREAD_POOL_TEST_H
+#define ASKAP_SYNTHESIS_THREAD_POOL_TEST_H
+
+#include <parallel/ThreadPool.h>
+#include <askap/AskapError.h>
+#include <Common/ParameterSet.h>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <boost/bind.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/locks.hpp>
+
+#include <vector>
+
+namespace askap {
+
+namespace synthesis {
+
+class ThreadPoolTest : public CppUnit::TestFixture 
+{
+   CPPUNIT_TEST_SUITE(ThreadPoolTest);
+   CPPUNIT_TEST(testTasks);
+   CPPUNIT_TEST(testError);
+   CPPUNIT_TEST(testCreate);
+   CPPUNIT_TEST_EXCEPTION(testBadNThreads, AskapError);
+   CPPUNIT_TEST(testPinned);
+   CPPUNIT_TEST_SUITE_END();
+public:
+
+   void testTasks() {
+      ThreadPool pool(3);
+      CPPUNIT_ASSERT_EQUAL(size_t(3), pool.nThreads());
+      // several batches, each task writes its own element
+      for (int batch = 0; batch < 3; ++batch) {
+           std::vector<int> results(20, -1);
+           for (size_t task = 0; task < results.size(); ++task) {
+                pool.submit(boost::bind(&ThreadPoolTest::square, static_cast<int>(task), &results[task]));
+           }
+           pool.wait();
+           for (size_t task = 0; task < results.size(); ++task) {
+                CPPUNIT_ASSERT_EQUAL(static_cast<int>(task * task), results[task]);
+           }
+      }
+      // waiting without tasks returns immediately
+      pool.wait();
+   }
+
+   void testError() {
+      ThreadPool pool(2);
+      int counter = 0;
+      boost::mutex mutex;
+      for (int task = 0; task < 10; ++task) {
+           if (task == 3) {
+               pool.submit(&ThreadPoolTest::fail);
+           } else {
+               pool.submit(boost::bind(&ThreadPoolTest::increment, &counter, &mutex));
+           }
+      }
+      bool thrown = false;
+      try {
+         pool.wait();
+      }
+      catch (const AskapError &) {
+         thrown = true;
+      }
+      CPPUNIT_ASSERT(thrown);
+      // other tasks of the batch are still complete when the error is reported
+      CPPUNIT_ASSERT_EQUAL(9, counter);
+      // the error is reported once, the pool can be used further
+      pool.submit(boost::bind(&ThreadPoolTest::increment, &counter, &mutex));
+      pool.wait();
+      CPPUNIT_ASSERT_EQUAL(10, counter);
+   }
+
+   void testCreate() {
+      LOFAR::ParameterSet parset;
+      // one thread (the default) means no pool
+      CPPUNIT_ASSERT(!ThreadPool::create(parset, 1));
+      parset.add("nthreads", "1");
+      CPPUNIT_ASSERT(!ThreadPool::create(parset, 1));
+      LOFAR::ParameterSet parset4;
+      parset4.add("nthreads", "4");
+      const ThreadPool::ShPtr pool = ThreadPool::create(parset4, 1);
+      CPPUNIT_ASSERT(pool);
+      CPPUNIT_ASSERT_EQUAL(size_t(4), pool->nThreads());
+   }
+
+   void testBadNThreads() {
+      LOFAR::ParameterSet parset;
+      parset.add("nthreads", "0");
+      ThreadPool::create(parset, 0);
+   }
+
+   void testPinned() {
+      LOFAR::ParameterSet parset;
+      parset.add("nthreads", "2");
+      parset.add("threads.pin", "true");
+      parset.add("threads.cores", "[0]");
+      const ThreadPool::ShPtr pool = ThreadPool::create(parset, 0);
+      CPPUNIT_ASSERT(pool);
+      std::vector<int> results(5, -1);
+      for (size_t task = 0; task < results.size(); ++task) {
+           pool->submit(boost::bind(&ThreadPoolTest::square, static_cast<int>(task), &results[task]));
+      }
+      pool->wait();
+      for (size_t task = 0; task < results.size(); ++task) {
+           CPPUNIT_ASSERT_EQUAL(static_cast<int>(task * task), results[task]);
+      }
+   }
+
+private:
+   /// @brief task computing a square of the number
+   /// @param[in] value input number
+   /// @param[out] result pointer to the result
+   static void square(int value, int *result) {
+      *result = value * value;
+   }
+
+   /// @brief task incrementing the shared counter
+   /// @param[in] counter pointer to the counter
+   /// @param[in] mutex mutex protecting the counter
+   static void increment(int *counter, boost::mutex *mutex) {
+      boost::lock_guard<boost::mutex> lock(*mutex);
+      ++(*counter);
+   }
+
+   /// @brief task which always fails
+   static void fail() {
+      ASKAPTHROW(AskapError, "Test failure");
+   }
+};
+
+} // namespace synthesis
+
+} // namespace askap
+
+#endif // #ifndef ASKAP_SYNTHESIS_THREAD_POOL_TEST_H
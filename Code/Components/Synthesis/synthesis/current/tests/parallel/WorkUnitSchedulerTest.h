@@ -0,0 +1,177 @@
+/// @file
+///
+/// Unit test for the dynamic distribution of imaging work units
+///
+///
+/// @copyright (c) 2026 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author agent <agent@local>
+
+#ifndef ASKAP_SYNTHESIS_WORK_UNIT_SCHEDULER_TEST_H
+#define ASKAP_SYNTHESIS_WORK_UNIT_SCHEDULER_TEST_H
+
+#include <parallel/WorkUnitScheduler.h>
+#include <askap/AskapError.h>
+#include <Common/ParameterSet.h>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+namespace askap {
+
+namespace synthesis {
+
+class WorkUnitSchedulerTest : public CppUnit::TestFixture 
+{
+   CPPUNIT_TEST_SUITE(WorkUnitSchedulerTest);
+   CPPUNIT_TEST(testUnits);
+   CPPUNIT_TEST_EXCEPTION(testBadIndex, AskapError);
+   CPPUNIT_TEST_EXCEPTION(testChanBlocksWithChannels, AskapError);
+   CPPUNIT_TEST(testTermination);
+   CPPUNIT_TEST(testAffinity);
+   CPPUNIT_TEST(testStealing);
+   CPPUNIT_TEST_SUITE_END();
+public:
+   
+   void testUnits() {
+      LOFAR::ParameterSet parset;
+      parset.add("dataset", "[first.ms, second.ms]");
+      parset.add("scheduling.beams", "[0, 3]");
+      parset.add("scheduling.chanblocks", "[16, 2]");
+      WorkUnitScheduler scheduler(parset);
+      CPPUNIT_ASSERT_EQUAL(size_t(8), scheduler.nUnits());
+      // channel blocks vary fastest, then beams, then datasets
+      for (int index = 0; index < 8; ++index) {
+           const ImagingWorkUnit &unit = scheduler.unit(index);
+           CPPUNIT_ASSERT_EQUAL(std::string(index < 4 ? "first.ms" : "second.ms"), unit.itsDataset);
+           CPPUNIT_ASSERT_EQUAL((index / 2) % 2 == 0 ? 0 : 3, unit.itsBeam);
+           CPPUNIT_ASSERT_EQUAL(casa::uInt(16), unit.itsNChan);
+           CPPUNIT_ASSERT_EQUAL(casa::uInt(index % 2 == 0 ? 0 : 16), unit.itsStartChan);
+      }
+      CPPUNIT_ASSERT_EQUAL(std::string("second.ms beam 3 channels 16-31"), scheduler.unit(7).name());
+      // without splitting, there is one unit covering each dataset
+      LOFAR::ParameterSet parset2;
+      parset2.add("dataset", "[first.ms, second.ms]");
+      WorkUnitScheduler scheduler2(parset2);
+      CPPUNIT_ASSERT_EQUAL(size_t(2), scheduler2.nUnits());
+      CPPUNIT_ASSERT_EQUAL(-1, scheduler2.unit(1).itsBeam);
+      CPPUNIT_ASSERT_EQUAL(casa::uInt(0), scheduler2.unit(1).itsNChan);
+      CPPUNIT_ASSERT_EQUAL(std::string("second.ms"), scheduler2.unit(1).name());
+   }
+
+   void testBadIndex() {
+      LOFAR::ParameterSet parset;
+      parset.add("dataset", "[first.ms]");
+      WorkUnitScheduler scheduler(parset);
+      // this should throw an exception
+      scheduler.unit(1);
+   }
+
+   void testChanBlocksWithChannels() {
+      LOFAR::ParameterSet parset;
+      parset.add("dataset", "[first.ms]");
+      parset.add("scheduling.chanblocks", "[16, 2]");
+      parset.add("Channels", "[16, 0]");
+      // this should throw an exception, the selections are incompatible
+      WorkUnitScheduler scheduler(parset);
+   }
+
+   void testTermination() {
+      LOFAR::ParameterSet parset;
+      parset.add("dataset", "[first.ms, second.ms]");
+      WorkUnitScheduler scheduler(parset);
+      scheduler.startCycle();
+      CPPUNIT_ASSERT_EQUAL(0, scheduler.nextUnit(1));
+      CPPUNIT_ASSERT_EQUAL(1, scheduler.nextUnit(2));
+      // all units are given out, every worker is told there is no more work
+      CPPUNIT_ASSERT_EQUAL(-1, scheduler.nextUnit(1));
+      CPPUNIT_ASSERT_EQUAL(-1, scheduler.nextUnit(2));
+      CPPUNIT_ASSERT_EQUAL(-1, scheduler.nextUnit(3));
+      CPPUNIT_ASSERT_EQUAL(-1, scheduler.nextUnit(1));
+      // the next cycle has all units again
+      scheduler.startCycle();
+      CPPUNIT_ASSERT(scheduler.nextUnit(1) >= 0);
+      CPPUNIT_ASSERT(scheduler.nextUnit(2) >= 0);
+      CPPUNIT_ASSERT_EQUAL(-1, scheduler.nextUnit(1));
+   }
+
+   void testAffinity() {
+      LOFAR::ParameterSet parset;
+      parset.add("dataset", "[a.ms, b.ms, c.ms]");
+      WorkUnitScheduler scheduler(parset);
+      scheduler.startCycle();
+      CPPUNIT_ASSERT_EQUAL(0, scheduler.nextUnit(1));
+      CPPUNIT_ASSERT_EQUAL(1, scheduler.nextUnit(2));
+      CPPUNIT_ASSERT_EQUAL(2, scheduler.nextUnit(1));
+      CPPUNIT_ASSERT_EQUAL(-1, scheduler.nextUnit(2));
+      CPPUNIT_ASSERT_EQUAL(-1, scheduler.nextUnit(1));
+      // in the next cycle each worker gets back its own units, regardless of the order of requests
+      scheduler.startCycle();
+      CPPUNIT_ASSERT_EQUAL(1, scheduler.nextUnit(2));
+      CPPUNIT_ASSERT_EQUAL(0, scheduler.nextUnit(1));
+      CPPUNIT_ASSERT_EQUAL(2, scheduler.nextUnit(1));
+      CPPUNIT_ASSERT_EQUAL(-1, scheduler.nextUnit(2));
+      CPPUNIT_ASSERT_EQUAL(-1, scheduler.nextUnit(1));
+   }
+
+   void testStealing() {
+      LOFAR::ParameterSet parset;
+      parset.add("dataset", "[a.ms, b.ms, c.ms, d.ms, e.ms]");
+      WorkUnitScheduler scheduler(parset);
+      // first cycle: worker 1 gets three units, worker 2 two units
+      scheduler.startCycle();
+      CPPUNIT_ASSERT_EQUAL(0, scheduler.nextUnit(1));
+      CPPUNIT_ASSERT_EQUAL(1, scheduler.nextUnit(1));
+      CPPUNIT_ASSERT_EQUAL(2, scheduler.nextUnit(1));
+      CPPUNIT_ASSERT_EQUAL(3, scheduler.nextUnit(2));
+      CPPUNIT_ASSERT_EQUAL(4, scheduler.nextUnit(2));
+      CPPUNIT_ASSERT_EQUAL(-1, scheduler.nextUnit(1));
+      CPPUNIT_ASSERT_EQUAL(-1, scheduler.nextUnit(2));
+      // second cycle: worker 3 joins and has to steal from the busiest worker (1),
+      // taking its last unit
+      scheduler.startCycle();
+      CPPUNIT_ASSERT_EQUAL(2, scheduler.nextUnit(3));
+      // worker 2 finishes its own units first, then steals from worker 1 which has more waiting
+      CPPUNIT_ASSERT_EQUAL(3, scheduler.nextUnit(2));
+      CPPUNIT_ASSERT_EQUAL(4, scheduler.nextUnit(2));
+      CPPUNIT_ASSERT_EQUAL(1, scheduler.nextUnit(2));
+      CPPUNIT_ASSERT_EQUAL(0, scheduler.nextUnit(1));
+      CPPUNIT_ASSERT_EQUAL(-1, scheduler.nextUnit(1));
+      CPPUNIT_ASSERT_EQUAL(-1, scheduler.nextUnit(2));
+      CPPUNIT_ASSERT_EQUAL(-1, scheduler.nextUnit(3));
+      // stolen units stay with the new worker in the following cycle
+      scheduler.startCycle();
+      CPPUNIT_ASSERT_EQUAL(2, scheduler.nextUnit(3));
+      CPPUNIT_ASSERT_EQUAL(1, scheduler.nextUnit(2));
+      CPPUNIT_ASSERT_EQUAL(0, scheduler.nextUnit(1));
+      // worker 1 has nothing of its own left and steals the last unit of worker 2
+      CPPUNIT_ASSERT_EQUAL(4, scheduler.nextUnit(1));
+      CPPUNIT_ASSERT_EQUAL(3, scheduler.nextUnit(2));
+      CPPUNIT_ASSERT_EQUAL(-1, scheduler.nextUnit(3));
+   }
+};
+
+} // namespace synthesis
+
+} // namespace askap
+
+#endif // #ifndef ASKAP_SYNTHESIS_WORK_UNIT_SCHEDULER_TEST_H
@@ -75,10 +75,9 @@ namespace askap
       itsOverSample=1;
       const int cSize=2*(itsSupport+1)*itsOverSample+1; // 3
       const int cCenter=(cSize-1)/2; // 1
-      itsConvFunc.resize(1);
-      itsConvFunc[0].resize(cSize, cSize); // 3, 3, 1
-      itsConvFunc[0].set(0.0);
-      itsConvFunc[0](cCenter,cCenter)=1.0; // 1,1,0 = 1
+      itsConvFunc.init(1, itsOverSample);
+      itsConvFunc.allocate(0, cCenter); // 3, 3, 1
+      itsConvFunc.matrix(0)(cCenter,cCenter)=1.0; // 1,1,0 = 1
     }
     
     void TestLoadGridder::correctConvolution(casa::Array<double>& image)